@@ -56,3 +56,58 @@ function(mac_get_linker_id)
 
 	set(${_MGLI_OUTPUT} "${_MGLI_LINK}" PARENT_SCOPE)
 endfunction()
+
+# Generate one technique for every combination of compile-time options of an effect.
+#
+# Every technique is named <FUNCTION>_<index> and draws FUNCTION(<INPUT> vtx, <values...>) with literal values, so the
+# shader compiler can remove every branch that depends on them. The index counts through the combinations with the first
+# option changing the fastest, which turns options of "false,true" into a bitmask.
+#
+# Usage: generate_effect_permutations(OUTPUT <file> FUNCTION <name> INPUT <struct> VERTEX <shader> OPTIONS "a,b" "c,d,e")
+function(generate_effect_permutations)
+	cmake_parse_arguments(
+		_GEP "" "OUTPUT;FUNCTION;INPUT;VERTEX" "OPTIONS" ${ARGN}
+	)
+
+	set(_GEP_TOTAL 1)
+	foreach(_GEP_OPTION IN LISTS _GEP_OPTIONS)
+		string(REPLACE "," ";" _GEP_VALUES "${_GEP_OPTION}")
+		list(LENGTH _GEP_VALUES _GEP_COUNT)
+		math(EXPR _GEP_TOTAL "${_GEP_TOTAL} * ${_GEP_COUNT}")
+	endforeach()
+	math(EXPR _GEP_LAST "${_GEP_TOTAL} - 1")
+
+	set(_GEP_CONTENT "// Generated by generate_effect_permutations() in cmake/util.cmake, do not edit.\n")
+	foreach(_GEP_INDEX RANGE ${_GEP_LAST})
+		# Split the index into one value per option.
+		set(_GEP_ARGS "")
+		set(_GEP_REST ${_GEP_INDEX})
+		foreach(_GEP_OPTION IN LISTS _GEP_OPTIONS)
+			string(REPLACE "," ";" _GEP_VALUES "${_GEP_OPTION}")
+			list(LENGTH _GEP_VALUES _GEP_COUNT)
+			math(EXPR _GEP_VALUE "${_GEP_REST} % ${_GEP_COUNT}")
+			math(EXPR _GEP_REST "${_GEP_REST} / ${_GEP_COUNT}")
+			list(GET _GEP_VALUES ${_GEP_VALUE} _GEP_VALUE)
+			string(APPEND _GEP_ARGS ", ${_GEP_VALUE}")
+		endforeach()
+
+		string(APPEND _GEP_CONTENT
+			"\n"
+			"float4 PS${_GEP_FUNCTION}_${_GEP_INDEX}(${_GEP_INPUT} vtx) : TARGET {\n"
+			"\treturn ${_GEP_FUNCTION}(vtx${_GEP_ARGS});\n"
+			"};\n"
+			"\n"
+			"technique ${_GEP_FUNCTION}_${_GEP_INDEX}\n"
+			"{\n"
+			"\tpass\n"
+			"\t{\n"
+			"\t\tvertex_shader = ${_GEP_VERTEX}(vtx);\n"
+			"\t\tpixel_shader = PS${_GEP_FUNCTION}_${_GEP_INDEX}(vtx);\n"
+			"\t};\n"
+			"};\n"
+		)
+	endforeach()
+
+	# Only touch the file if it changed, so that it does not look modified to anything watching the data directory.
+	file(CONFIGURE OUTPUT "${_GEP_OUTPUT}" CONTENT "${_GEP_CONTENT}" @ONLY)
+endfunction()
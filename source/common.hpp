@@ -39,6 +39,7 @@
 #include "version.hpp"
 #include "util/util-bitmask.hpp"
 #include "util/util-library.hpp"
+#include "util/util-logging.hpp"
 #include "util/util-profiler.hpp"
 #include "util/util-threadpool.hpp"
 #include "util/utility.hpp"
@@ -72,11 +73,11 @@ extern "C" {
 
 // Common Global defines
 /// Logging
-#define DLOG_(level, ...) blog(level, "[" S_PLUGIN_NAME "] " __VA_ARGS__)
-#define DLOG_ERROR(...) DLOG_(LOG_ERROR, __VA_ARGS__)
-#define DLOG_WARNING(...) DLOG_(LOG_WARNING, __VA_ARGS__)
-#define DLOG_INFO(...) DLOG_(LOG_INFO, __VA_ARGS__)
-#define DLOG_DEBUG(...) DLOG_(LOG_DEBUG, __VA_ARGS__)
+#define DLOG_(lvl, ...) ::streamfx::util::logging::log(::streamfx::util::logging::level::lvl, __VA_ARGS__)
+#define DLOG_ERROR(...) DLOG_(LEVEL_ERROR, __VA_ARGS__)
+#define DLOG_WARNING(...) DLOG_(LEVEL_WARN, __VA_ARGS__)
+#define DLOG_INFO(...) DLOG_(LEVEL_INFO, __VA_ARGS__)
+#define DLOG_DEBUG(...) DLOG_(LEVEL_DEBUG, __VA_ARGS__)
 /// Currrent function name (as const char*)
 #ifdef _MSC_VER
 // Microsoft Visual Studio
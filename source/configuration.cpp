@@ -7,6 +7,10 @@
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
 
+#include "warning-disable.hpp"
+#include <algorithm>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -21,20 +25,37 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
-constexpr std::string_view version_tag_name = "Version";
-constexpr std::string_view path_backup_ext  = ".bk";
+constexpr std::string_view version_tag_name      = "Version";
+constexpr std::string_view availability_tag_name = "Availability";
+constexpr std::string_view measurement_tag_name  = "Measurements";
+constexpr std::string_view path_backup_ext       = ".bk";
+
+// Changes made within this time of each other are written to disk together.
+constexpr std::chrono::milliseconds save_delay{100};
+
+// Minimum time between two writes to disk.
+constexpr std::chrono::seconds save_interval{2};
 
 streamfx::configuration::~configuration()
 {
 	try {
-		save();
-		_save_task->wait();
+		std::shared_ptr<streamfx::util::threadpool::task> task;
+		{
+			std::lock_guard<std::mutex> lg(_task_lock);
+			_save_now = true;
+			task      = _save_task;
+		}
+		_task_cv.notify_all();
+		if (task) {
+			task->wait();
+		}
 	} catch (std::exception const& ex) {
 		DLOG_ERROR("Failed to save configuration: %s", ex.what());
 	}
 }
 
-streamfx::configuration::configuration() : _config_path(), _data(), _task_lock(), _save_task()
+streamfx::configuration::configuration()
+	: _config_path(), _data(), _task_lock(), _task_cv(), _save_task(), _save_pending(false), _save_now(false), _dirty(false), _last_save()
 {
 	// Retrieve global configuration path.
 	_config_path = streamfx::config_file_path("config.json");
@@ -55,24 +76,48 @@ streamfx::configuration::configuration() : _config_path(), _data(), _task_lock()
 	}
 }
 
-void streamfx::configuration::save()
+void streamfx::configuration::save_task(streamfx::util::threadpool::task_data_t)
 {
-	std::lock_guard<std::mutex> lg(_task_lock);
-	if (!_save_task || _save_task->is_completed()) {
-		_save_task = streamfx::threadpool()->push([this](streamfx::util::threadpool::task_data_t) {
-			// ToDo: Implement delayed tasks in ::threadpool.
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	std::unique_lock<std::mutex> ul(_task_lock);
+	while (_dirty) {
+		// Wait for further changes to arrive, unless this is the last chance to write at all.
+		auto deadline = std::max(std::chrono::steady_clock::now() + save_delay, _last_save + save_interval);
+		_task_cv.wait_until(ul, deadline, [this]() { return _save_now; });
+
+		_dirty = false;
+		ul.unlock();
 
-			// Update version tag.
-			obs_data_set_int(_data.get(), version_tag_name.data(), STREAMFX_VERSION);
+		// Update version tag.
+		obs_data_set_int(_data.get(), version_tag_name.data(), STREAMFX_VERSION);
 
+		try {
 			if (_config_path.has_parent_path()) {
 				std::filesystem::create_directories(_config_path.parent_path());
 			}
+
+			// Written to a temporary file first, which then replaces the original at once.
 			if (!obs_data_save_json_safe(_data.get(), _config_path.u8string().c_str(), ".tmp", path_backup_ext.data())) {
 				D_LOG_ERROR("Failed to save configuration file.", nullptr);
 			}
-		});
+		} catch (std::exception const& ex) {
+			D_LOG_ERROR("Failed to save configuration file: %s", ex.what());
+		}
+
+		ul.lock();
+		_last_save = std::chrono::steady_clock::now();
+	}
+
+	// Changes made from here on need a new task, which save() knows about as long as it checks under the same lock.
+	_save_pending = false;
+}
+
+void streamfx::configuration::save()
+{
+	std::lock_guard<std::mutex> lg(_task_lock);
+	_dirty = true;
+	if (!_save_pending) {
+		_save_pending = true;
+		_save_task    = streamfx::threadpool()->push<&configuration::save_task>(this, nullptr, streamfx::util::threadpool::priority::BACKGROUND);
 	}
 }
 
@@ -92,6 +137,78 @@ bool streamfx::configuration::is_different_version()
 	return (version() & STREAMFX_MASK_COMPAT) != (STREAMFX_VERSION & STREAMFX_MASK_COMPAT);
 }
 
+std::shared_ptr<obs_data_t> streamfx::configuration::get_versioned(std::string_view tag, bool create)
+{
+	std::string                 name{tag};
+	std::shared_ptr<obs_data_t> object{obs_data_get_obj(_data.get(), name.c_str()), obs::obs_data_deleter};
+
+	// Drivers and SDKs are likely to have changed along with StreamFX, so older results are not trusted.
+	auto found = object ? static_cast<uint64_t>(obs_data_get_int(object.get(), version_tag_name.data())) : 0;
+	if (object && ((found & STREAMFX_MASK_COMPAT) == (STREAMFX_VERSION & STREAMFX_MASK_COMPAT))) {
+		return object;
+	}
+
+	if (!create) {
+		return nullptr;
+	}
+	object = std::shared_ptr<obs_data_t>(obs_data_create(), obs::obs_data_deleter);
+	obs_data_set_int(object.get(), version_tag_name.data(), STREAMFX_VERSION);
+	obs_data_set_obj(_data.get(), name.c_str(), object.get());
+	return object;
+}
+
+std::optional<bool> streamfx::configuration::get_availability(std::string_view feature)
+{
+	auto availability = get_versioned(availability_tag_name, false);
+	if (!availability) {
+		return std::nullopt;
+	}
+
+	std::string key{feature};
+	if (!obs_data_has_user_value(availability.get(), key.c_str())) {
+		return std::nullopt;
+	}
+	return obs_data_get_bool(availability.get(), key.c_str());
+}
+
+void streamfx::configuration::set_availability(std::string_view feature, bool available)
+{
+	auto availability = get_versioned(availability_tag_name, true);
+
+	std::string key{feature};
+	if (obs_data_has_user_value(availability.get(), key.c_str()) && (obs_data_get_bool(availability.get(), key.c_str()) == available)) {
+		return;
+	}
+	obs_data_set_bool(availability.get(), key.c_str(), available);
+	save();
+}
+
+std::optional<int64_t> streamfx::configuration::get_measurement(std::string_view name)
+{
+	auto measurements = get_versioned(measurement_tag_name, false);
+	if (!measurements) {
+		return std::nullopt;
+	}
+
+	std::string key{name};
+	if (!obs_data_has_user_value(measurements.get(), key.c_str())) {
+		return std::nullopt;
+	}
+	return obs_data_get_int(measurements.get(), key.c_str());
+}
+
+void streamfx::configuration::set_measurement(std::string_view name, int64_t value)
+{
+	auto measurements = get_versioned(measurement_tag_name, true);
+
+	std::string key{name};
+	if (obs_data_has_user_value(measurements.get(), key.c_str()) && (obs_data_get_int(measurements.get(), key.c_str()) == value)) {
+		return;
+	}
+	obs_data_set_int(measurements.get(), key.c_str(), value);
+	save();
+}
+
 std::shared_ptr<streamfx::configuration> streamfx::configuration::instance()
 {
 	static std::weak_ptr<streamfx::configuration> winst;
@@ -6,9 +6,13 @@
 #include "common.hpp"
 
 #include "warning-disable.hpp"
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <memory>
 #include <new>
+#include <optional>
+#include <string_view>
 #include "warning-enable.hpp"
 
 namespace streamfx {
@@ -22,7 +26,12 @@ namespace streamfx {
 #endif
 			std::mutex _task_lock;
 
+		std::condition_variable                           _task_cv;
 		std::shared_ptr<streamfx::util::threadpool::task> _save_task;
+		bool                                              _save_pending;
+		bool                                              _save_now;
+		bool                                              _dirty;
+		std::chrono::steady_clock::time_point             _last_save;
 
 		public:
 		~configuration();
@@ -30,7 +39,18 @@ namespace streamfx {
 		private:
 		configuration();
 
+		private:
+		void save_task(streamfx::util::threadpool::task_data_t);
+
+		/** Child object that is discarded whenever the compatible version of StreamFX changes. */
+		std::shared_ptr<obs_data_t> get_versioned(std::string_view tag, bool create);
+
 		public:
+		/** Mark the configuration as changed and schedule writing it to disk.
+		 *
+		 * Changes are coalesced, so that the file is written at most once per few seconds no matter how often this is
+		 * called. Anything still unwritten is written when the configuration is destroyed.
+		 */
 		void save();
 
 		public:
@@ -40,6 +60,14 @@ namespace streamfx {
 
 		bool is_different_version();
 
+		/** Availability of an optional feature as found by an earlier session of this version, if known. */
+		std::optional<bool> get_availability(std::string_view feature);
+		void                set_availability(std::string_view feature, bool available);
+
+		/** Result of a measurement made by an earlier session of this version, like a benchmark, if known. */
+		std::optional<int64_t> get_measurement(std::string_view name);
+		void                   set_measurement(std::string_view name, int64_t value);
+
 		public /* Singleton */:
 		static std::shared_ptr<streamfx::configuration> instance();
 	};
@@ -7,6 +7,11 @@
 
 #define S_CODEC_AV1 "Codec.AV1"
 #define S_CODEC_AV1_PROFILE "Codec.AV1.Profile"
+#define S_CODEC_AV1_TIER "Codec.AV1.Tier"
+#define S_CODEC_AV1_LEVEL "Codec.AV1.Level"
+#define S_CODEC_AV1_TILES "Codec.AV1.Tiles"
+#define S_CODEC_AV1_TILES_ROWS "Codec.AV1.Tiles.Rows"
+#define S_CODEC_AV1_TILES_COLUMNS "Codec.AV1.Tiles.Columns"
 
 namespace streamfx::encoder::codec::av1 {
 	enum class profile {
@@ -16,5 +21,33 @@ namespace streamfx::encoder::codec::av1 {
 		UNKNOWN      = -1,
 	};
 
+	enum class level {
+		L2_0 = 20,
+		L2_1,
+		L2_2,
+		L2_3,
+		L3_0 = 30,
+		L3_1,
+		L3_2,
+		L3_3,
+		L4_0 = 40,
+		L4_1,
+		L4_2,
+		L4_3,
+		L5_0 = 50,
+		L5_1,
+		L5_2,
+		L5_3,
+		L6_0 = 60,
+		L6_1,
+		L6_2,
+		L6_3,
+		L7_0 = 70,
+		L7_1,
+		L7_2,
+		L7_3,
+		UNKNOWN = -1,
+	};
+
 	const char* profile_to_string(profile p);
 } // namespace streamfx::encoder::codec::av1
@@ -3,43 +3,14 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "h264.hpp"
-
-uint8_t* is_nal_start(uint8_t* ptr, uint8_t* end_ptr, size_t& size)
-{
-	// Ensure that the remaining space actually can contain a prefix and NAL header.
-	if ((ptr + (3 + 1)) >= end_ptr)
-		return nullptr;
-
-	if (*ptr != 0x0)
-		return nullptr;
-	if (*(ptr + 1) != 0x0)
-		return nullptr;
-
-	// 3-Byte NAL prefix.
-	if (*(ptr + 2) == 0x1) {
-		size = 3;
-		return ptr + 3;
-	}
-
-	// 4-Byte NAL Prefix
-	if ((ptr + (4 + 1)) >= end_ptr)
-		return nullptr;
-	if (*(ptr + 2) != 0x0)
-		return nullptr;
-	if (*(ptr + 3) != 0x01)
-		return nullptr;
-
-	size = 4;
-	return ptr + 4;
-}
+#include "nal.hpp"
 
 uint8_t* streamfx::encoder::codec::h264::find_closest_nal(uint8_t* ptr, uint8_t* end_ptr, size_t& size)
 {
-	for (uint8_t* seek_ptr = ptr; seek_ptr < end_ptr; seek_ptr++) {
-		if (auto nal_ptr = is_nal_start(seek_ptr, end_ptr, size); nal_ptr != nullptr)
-			return nal_ptr;
-	}
-	return nullptr;
+	const uint8_t* code = nal::find_start_code(ptr, end_ptr, size);
+	if (code == nullptr)
+		return nullptr;
+	return ptr + (code - ptr) + size;
 }
 
 uint32_t streamfx::encoder::codec::h264::get_packet_reference_count(uint8_t* ptr, uint8_t* end_ptr)
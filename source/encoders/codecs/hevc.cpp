@@ -80,54 +80,7 @@ struct hevc_nal_unit_header {
 	uint8_t       temporal_id_plus1 : 3;
 };
 
-struct hevc_nal {
-	hevc_nal_unit_header* header;
-	std::size_t           size = 0;
-	uint8_t*              data = nullptr;
-};
-
-bool is_nal(uint8_t* data, uint8_t* end)
-{
-	std::size_t s = static_cast<size_t>(end - data);
-	if (s < 4)
-		return false;
-
-	if (*data != 0x0)
-		return false;
-	if (*(data + 1) != 0x0)
-		return false;
-	if (*(data + 2) != 0x0)
-		return false;
-	if (*(data + 3) != 0x1)
-		return false;
-
-	return true;
-}
-
-bool seek_to_nal(uint8_t*& data, uint8_t* end)
-{
-	if (data > end)
-		return false;
-
-	for (; data <= end; data++) {
-		if (is_nal(data, end)) {
-			return true;
-		}
-	}
-
-	return false;
-}
-
-std::size_t get_nal_size(uint8_t* data, uint8_t* end)
-{
-	uint8_t* ptr = data + 4;
-	if (!seek_to_nal(ptr, end)) {
-		return static_cast<size_t>(end - data);
-	}
-	return static_cast<size_t>(ptr - data);
-}
-
-bool is_discard_marker(uint8_t* data, uint8_t* end)
+bool is_discard_marker(const uint8_t* data, const uint8_t* end)
 {
 	std::size_t s = static_cast<size_t>(end - data);
 	if (s < 4)
@@ -162,7 +115,7 @@ bool is_discard_marker(uint8_t* data, uint8_t* end)
 	}
 }
 
-bool should_discard_nal(uint8_t* data, uint8_t* end)
+bool should_discard_nal(const uint8_t* data, const uint8_t* end)
 {
 	if (data > end)
 		return true;
@@ -175,44 +128,27 @@ bool should_discard_nal(uint8_t* data, uint8_t* end)
 	return false;
 }
 
-void progress_parse(uint8_t*& ptr, uint8_t* end, size_t& sz)
-{
-	ptr += sz;
-	sz = get_nal_size(ptr, end);
-}
-
-void hevc::extract_header_sei(uint8_t* data, std::size_t sz_data, std::vector<uint8_t>& header, std::vector<uint8_t>& sei)
+void hevc::find_header_sei(const uint8_t* data, std::size_t sz_data, std::vector<nal::unit>& header, std::vector<nal::unit>& sei)
 {
-	uint8_t* ptr = data;
-	uint8_t* end = data + sz_data;
+	const uint8_t* end = data + sz_data;
 
-	// Reserve enough memory to store the entire packet data if necessary.
-	header.reserve(sz_data);
-	sei.reserve(sz_data);
-
-	if (!seek_to_nal(ptr, end)) {
-		return;
-	}
-
-	for (std::size_t nal_sz = get_nal_size(ptr, end); nal_sz > 0; progress_parse(ptr, end, nal_sz)) {
-		if (should_discard_nal(ptr + 4, ptr + nal_sz)) {
+	header.clear();
+	sei.clear();
+	for (nal::unit unit; nal::next_unit(data, end, unit); data = unit.data + unit.size) {
+		const uint8_t* payload = unit.data + unit.prefix;
+		if (should_discard_nal(payload, unit.data + unit.size)) {
 			continue;
 		}
 
-		hevc_nal nal;
-		nal.header = reinterpret_cast<hevc_nal_unit_header*>(ptr + 4);
-		nal.size   = nal_sz - 4 - 2;
-		nal.data   = ptr + 4 + 2;
-
-		switch (nal.header->nut) {
+		switch (reinterpret_cast<const hevc_nal_unit_header*>(payload)->nut) {
 		case nal_unit_type::VPS:
 		case nal_unit_type::SPS:
 		case nal_unit_type::PPS:
-			header.insert(header.end(), ptr, ptr + nal_sz);
+			header.push_back(unit);
 			break;
 		case nal_unit_type::PREFIX_SEI:
 		case nal_unit_type::SUFFIX_SEI:
-			sei.insert(sei.end(), ptr, ptr + nal_sz);
+			sei.push_back(unit);
 			break;
 		default:
 			break;
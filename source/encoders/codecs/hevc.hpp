@@ -4,6 +4,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "nal.hpp"
 
 // Codec: HEVC
 #define S_CODEC_HEVC "Codec.HEVC"
@@ -42,5 +43,10 @@ namespace streamfx::encoder::codec::hevc {
 		UNKNOWN = -1,
 	};
 
-	void extract_header_sei(uint8_t* data, std::size_t sz_data, std::vector<uint8_t>& header, std::vector<uint8_t>& sei);
+	/** Find the parameter sets and SEI in a packet, without copying any of them.
+	 *
+	 * \param header Receives the VPS, SPS and PPS units, in the order they appear.
+	 * \param sei Receives the prefix and suffix SEI units, in the order they appear.
+	 */
+	void find_header_sei(const uint8_t* data, std::size_t sz_data, std::vector<nal::unit>& header, std::vector<nal::unit>& sei);
 } // namespace streamfx::encoder::codec::hevc
@@ -0,0 +1,197 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nal.hpp"
+#include "util/util-cpu.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(D_PLATFORM_INSTR_ARM)
+#include <arm_neon.h>
+#endif
+#include "warning-enable.hpp"
+
+// Each kernel returns the first 00 00 01 in the range, or 'end' if there is none.
+typedef const uint8_t* (*kernel_t)(const uint8_t* ptr, const uint8_t* end);
+
+static const uint8_t* scan_generic(const uint8_t* ptr, const uint8_t* end)
+{
+	// Look at the last byte of each candidate first, which lets most positions skip ahead by three.
+	while ((end - ptr) >= 3) {
+		if (ptr[2] > 0x1) {
+			ptr += 3;
+		} else if (ptr[2] == 0x0) {
+			ptr += 1;
+		} else if ((ptr[1] != 0x0) || (ptr[0] != 0x0)) {
+			ptr += 3;
+		} else {
+			return ptr;
+		}
+	}
+	return end;
+}
+
+#if defined(D_PLATFORM_INSTR_X86)
+static inline uint32_t first_bit(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<uint32_t>(index);
+#else
+	return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+static const uint8_t* scan_sse2(const uint8_t* ptr, const uint8_t* end)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one  = _mm_set1_epi8(1);
+
+	// The third load reads two bytes past the block, so stop while that is still inside the range.
+	for (; (end - ptr) >= (16 + 2); ptr += 16) {
+		__m128i  a    = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)), zero);
+		__m128i  b    = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 1)), zero);
+		__m128i  c    = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 2)), one);
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(a, b), c)));
+		if (mask != 0) {
+			return ptr + first_bit(mask);
+		}
+	}
+	return scan_generic(ptr, end);
+}
+
+P_CPU_TARGET("avx2")
+static const uint8_t* scan_avx2(const uint8_t* ptr, const uint8_t* end)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one  = _mm256_set1_epi8(1);
+
+	for (; (end - ptr) >= (32 + 2); ptr += 32) {
+		__m256i  a    = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)), zero);
+		__m256i  b    = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 1)), zero);
+		__m256i  c    = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 2)), one);
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(a, b), c)));
+		if (mask != 0) {
+			return ptr + first_bit(mask);
+		}
+	}
+	return scan_sse2(ptr, end);
+}
+#elif defined(D_PLATFORM_INSTR_ARM)
+static const uint8_t* scan_neon(const uint8_t* ptr, const uint8_t* end)
+{
+	const uint8x16_t zero = vdupq_n_u8(0);
+	const uint8x16_t one  = vdupq_n_u8(1);
+
+	for (; (end - ptr) >= (16 + 2); ptr += 16) {
+		uint8x16_t a = vceqq_u8(vld1q_u8(ptr), zero);
+		uint8x16_t b = vceqq_u8(vld1q_u8(ptr + 1), zero);
+		uint8x16_t c = vceqq_u8(vld1q_u8(ptr + 2), one);
+
+		// NEON has no movemask, so narrow each byte of the result down to four bits of a 64-bit lane instead.
+		uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(vandq_u8(vandq_u8(a, b), c)), 4);
+		uint64_t  mask   = vget_lane_u64(vreinterpret_u64_u8(narrow), 0);
+		if (mask != 0) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, mask);
+			return ptr + (index >> 2);
+#else
+			return ptr + (__builtin_ctzll(mask) >> 2);
+#endif
+		}
+	}
+	return scan_generic(ptr, end);
+}
+#endif
+
+static kernel_t select_kernel()
+{
+	using namespace streamfx::util::cpu;
+#if defined(D_PLATFORM_INSTR_X86)
+	return select<kernel_t>({{feature::AVX2, scan_avx2}}, scan_sse2);
+#elif defined(D_PLATFORM_INSTR_ARM)
+	return select<kernel_t>({{feature::NEON, scan_neon}}, scan_generic);
+#else
+	return scan_generic;
+#endif
+}
+
+const uint8_t* streamfx::encoder::codec::nal::find_start_code(const uint8_t* ptr, const uint8_t* end, size_t& size)
+{
+	static const kernel_t kernel = select_kernel();
+
+	if ((ptr == nullptr) || (ptr >= end)) {
+		return nullptr;
+	}
+
+	// Ensure that there is space for the NAL header behind the start code.
+	const uint8_t* code = kernel(ptr, end);
+	if ((end - code) < (3 + 1)) {
+		return nullptr;
+	}
+
+	// A zero in front of the 3-byte prefix makes it a 4-byte prefix.
+	if ((code > ptr) && (*(code - 1) == 0x0)) {
+		size = 4;
+		return code - 1;
+	}
+
+	size = 3;
+	return code;
+}
+
+bool streamfx::encoder::codec::nal::next_unit(const uint8_t* ptr, const uint8_t* end, unit& result)
+{
+	size_t         prefix = 0;
+	const uint8_t* code   = find_start_code(ptr, end, prefix);
+	if (code == nullptr) {
+		return false;
+	}
+
+	size_t         next_prefix = 0;
+	const uint8_t* next        = find_start_code(code + prefix, end, next_prefix);
+
+	result.data   = code;
+	result.size   = static_cast<size_t>((next ? next : end) - code);
+	result.prefix = prefix;
+	return true;
+}
+
+bool streamfx::encoder::codec::nal::update(std::vector<uint8_t>& buffer, std::vector<unit> const& units)
+{
+	// Compare in place first, as the units rarely change between packets.
+	size_t size = 0;
+	for (auto const& v : units) {
+		size += v.size;
+	}
+	if (size == buffer.size()) {
+		size_t offset = 0;
+		bool   equal  = true;
+		for (auto const& v : units) {
+			if (std::memcmp(buffer.data() + offset, v.data, v.size) != 0) {
+				equal = false;
+				break;
+			}
+			offset += v.size;
+		}
+		if (equal) {
+			return false;
+		}
+	}
+
+	buffer.resize(size);
+	size_t offset = 0;
+	for (auto const& v : units) {
+		std::memcpy(buffer.data() + offset, v.data, v.size);
+		offset += v.size;
+	}
+	return true;
+}
@@ -0,0 +1,49 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::encoder::codec::nal {
+	/** Search for the closest Annex B start code, shared by H.264 and HEVC.
+	 *
+	 * Picks the fastest kernel the CPU supports at runtime. A start code is only returned if there is room for at least
+	 * one byte of NAL header behind it.
+	 *
+	 * \param ptr Beginning of the search range.
+	 * \param end End of the search range (exclusive).
+	 * \param size Size of the start code that was found, either 3 or 4.
+	 *
+	 * \return Pointer to the first byte of the start code, or \ref nullptr if there is none.
+	 */
+	const uint8_t* find_start_code(const uint8_t* ptr, const uint8_t* end, size_t& size);
+
+	/** View of a single NAL unit inside of a packet, including its start code.
+	 */
+	struct unit {
+		const uint8_t* data   = nullptr;
+		size_t         size   = 0;
+		size_t         prefix = 0;
+	};
+
+	/** Find the closest NAL unit, which reaches up to the next start code or the end of the range.
+	 *
+	 * Nothing is copied, so the view is only valid for as long as the packet is.
+	 *
+	 * eturn true if a NAL unit was found, otherwise false.
+	 */
+	bool next_unit(const uint8_t* ptr, const uint8_t* end, unit& result);
+
+	/** Replace the contents of a buffer with a list of NAL units, but only if they differ from what it already holds.
+	 *
+	 * eturn true if the buffer was changed, otherwise false.
+	 */
+	bool update(std::vector<uint8_t>& buffer, std::vector<unit> const& units);
+} // namespace streamfx::encoder::codec::nal
@@ -8,10 +8,14 @@
 
 #include "encoder-ffmpeg.hpp"
 #include "strings.hpp"
+#include "configuration.hpp"
 #include "codecs/hevc.hpp"
+#include "ffmpeg/sample-convert.hpp"
 #include "ffmpeg/tools.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
+#include "util/util-copy.hpp"
+#include "util/util-hash.hpp"
 
 #include "warning-disable.hpp"
 #include <sstream>
@@ -24,10 +28,13 @@ extern "C" {
 
 #include "warning-disable.hpp"
 #include <libavcodec/avcodec.h>
+#include <libavutil/channel_layout.h>
 #include <libavutil/dict.h>
 #include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
 #include <libavutil/pixdesc.h>
+#include <libavutil/version.h>
 #include "warning-enable.hpp"
 }
 
@@ -35,6 +42,22 @@ extern "C" {
 #include "ffmpeg/hwapi/d3d11.hpp"
 #endif
 
+#ifdef ENABLE_NVIDIA_CUDA
+#include "nvidia/cuda/nvidia-cuda-obs.hpp"
+#endif
+
+#ifdef ENABLE_ENCODER_FFMPEG_AMF
+#include "encoders/ffmpeg/amf.hpp"
+#endif
+
+#ifdef ENABLE_ENCODER_FFMPEG_NVENC
+#include "encoders/ffmpeg/nvenc.hpp"
+#endif
+
+#ifdef ENABLE_ENCODER_FFMPEG_QSV
+#include "encoders/ffmpeg/qsv.hpp"
+#endif
+
 // FFmpeg
 #define ST_I18N_FFMPEG "Encoder.FFmpeg"
 #define ST_I18N_FFMPEG_SUFFIX ST_I18N_FFMPEG ".Suffix"
@@ -42,10 +65,30 @@ extern "C" {
 #define ST_KEY_FFMPEG_CUSTOMSETTINGS "FFmpeg.CustomSettings"
 #define ST_I18N_FFMPEG_THREADS ST_I18N_FFMPEG ".Threads"
 #define ST_KEY_FFMPEG_THREADS "FFmpeg.Threads"
+#define ST_I18N_FFMPEG_THREADS_ADAPTIVE ST_I18N_FFMPEG_THREADS ".Adaptive"
+#define ST_KEY_FFMPEG_THREADS_ADAPTIVE "FFmpeg.Threads.Adaptive"
 #define ST_I18N_FFMPEG_FRAMERATE ST_I18N_FFMPEG ".Framerate"
 #define ST_KEY_FFMPEG_FRAMERATE "FFmpeg.Framerate"
 #define ST_I18N_FFMPEG_GPU ST_I18N_FFMPEG ".GPU"
 #define ST_KEY_FFMPEG_GPU "FFmpeg.GPU"
+#define ST_I18N_FFMPEG_BALANCE ST_I18N_FFMPEG ".Balance"
+#define ST_KEY_FFMPEG_BALANCE "FFmpeg.Balance"
+#define ST_I18N_FFMPEG_REGIONSOFINTEREST ST_I18N_FFMPEG ".RegionsOfInterest"
+#define ST_KEY_FFMPEG_REGIONSOFINTEREST "FFmpeg.RegionsOfInterest"
+#define ST_I18N_FFMPEG_UPLOAD ST_I18N_FFMPEG ".Upload"
+#define ST_KEY_FFMPEG_UPLOAD "FFmpeg.Upload"
+#define ST_I18N_FFMPEG_PIPELINE ST_I18N_FFMPEG ".Pipeline"
+#define ST_KEY_FFMPEG_PIPELINE "FFmpeg.Pipeline"
+#define ST_I18N_FFMPEG_PARALLEL ST_I18N_FFMPEG ".Parallel"
+#define ST_KEY_FFMPEG_PARALLEL "FFmpeg.Parallel"
+#define ST_I18N_FFMPEG_SKIPUNCHANGED ST_I18N_FFMPEG ".SkipUnchanged"
+#define ST_KEY_FFMPEG_SKIPUNCHANGED "FFmpeg.SkipUnchanged"
+#define ST_I18N_FFMPEG_SCENECUT ST_I18N_FFMPEG ".SceneCut"
+#define ST_KEY_FFMPEG_SCENECUT "FFmpeg.SceneCut"
+#define ST_I18N_FFMPEG_SCALETHREADS ST_I18N_FFMPEG ".ScaleThreads"
+#define ST_KEY_FFMPEG_SCALETHREADS "FFmpeg.ScaleThreads"
+#define ST_I18N_FFMPEG_BITRATE ST_I18N_FFMPEG ".Bitrate"
+#define ST_KEY_FFMPEG_BITRATE "bitrate" // Same key as OBS Studio's own audio encoders, so outputs can set it.
 
 #define ST_I18N_KEYFRAMES ST_I18N_FFMPEG ".KeyFrames"
 #define ST_I18N_KEYFRAMES_INTERVALTYPE ST_I18N_KEYFRAMES ".IntervalType"
@@ -55,11 +98,50 @@ extern "C" {
 #define ST_KEY_KEYFRAMES_INTERVAL_SECONDS "KeyFrames.Interval.Seconds"
 #define ST_KEY_KEYFRAMES_INTERVAL_FRAMES "KeyFrames.Interval.Frames"
 
+// Maximum number of frames waiting for the pipeline thread before the encode thread waits.
+constexpr std::size_t pipeline_depth = 16;
+
+// Maximum number of frames waiting for each parallel context before the encode thread waits.
+constexpr std::size_t parallel_depth = 2;
+
 using namespace streamfx::encoder::ffmpeg;
 using namespace streamfx::encoder::codec;
 
 enum class keyframe_type { SECONDS, FRAMES };
 
+// Encoders that take any number of samples per frame still need OBS Studio to pick one.
+constexpr int default_audio_frame_size = 1024;
+
+static int get_channel_count(AVCodecContext* context)
+{
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+	return context->ch_layout.nb_channels;
+#else
+	return context->channels;
+#endif
+}
+
+#ifdef ENABLE_PROFILING
+// How often each encoder writes its telemetry to the log.
+constexpr std::chrono::seconds telemetry_interval{10};
+
+// Frames that never produce a packet are forgotten once this many are waiting.
+constexpr std::size_t telemetry_max_submitted = 256;
+
+namespace {
+	struct registry {
+		std::mutex                 lock;
+		std::set<ffmpeg_instance*> instances;
+	};
+
+	registry& get_registry()
+	{
+		static registry instance;
+		return instance;
+	}
+} // namespace
+#endif
+
 ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw)
 	: encoder_instance(settings, self, is_hw),
 
@@ -67,18 +149,40 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 
 	  _codec(_factory->get_avcodec()), _context(nullptr), _handler(ffmpeg_manager::instance()->get_handler(_codec->name)),
 
-	  _scaler(), _packet(),
+	  _scaler(), _packet_pool(), _packet(),
+
+	  _hwapi(), _hwinst(), _upload(false), _upload_device(), _gpu_session(),
+
+	  _roi_strength(0), _roi(),
+
+	  _lag_in_frames(0), _sent_frames(0), _have_first_frame(false), _extra_data(), _sei_data(), _header_units(), _sei_units(),
 
-	  _hwapi(), _hwinst(),
+	  _free_frames(), _used_frames(),
 
-	  _lag_in_frames(0), _sent_frames(0), _have_first_frame(false), _extra_data(), _sei_data(),
+	  _pipeline(false), _pipeline_thread(), _pipeline_lock(), _pipeline_cv(), _pipeline_frames(), _pipeline_packets(), _pipeline_delivered(0), _pipeline_stop(false),
 
-	  _free_frames(), _used_frames(), _free_frames_last_used()
+	  _parallel(), _parallel_next(0), _parallel_lock(), _parallel_cv(), _parallel_order(), _parallel_done(),
+
+	  _skip(false), _skip_valid(false), _skip_hash(0), _skip_frames(0), _skip_limit(0),
+
+	  _scenecut()
 {
+	// Spread sessions over all GPUs if the user did not pick one.
+	if ((obs_data_get_int(settings, ST_KEY_FFMPEG_GPU) == -1) && obs_data_get_bool(settings, ST_KEY_FFMPEG_BALANCE)) {
+		_gpu_session = acquire_balanced_gpu();
+	}
+
+	// Follow regions of interest published by other parts of StreamFX, like face tracking.
+	_roi_strength = obs_data_get_int(settings, ST_KEY_FFMPEG_REGIONSOFINTEREST);
+	if (_roi_strength > 0) {
+		_roi = ::streamfx::util::roi::channel::instance();
+	}
+
 	// Initialize GPU Stuff
 	if (is_hw) {
 		// Abort if user specified manual override.
-		if ((obs_data_get_int(settings, ST_KEY_FFMPEG_GPU) != -1) || (obs_encoder_scaling_enabled(_self)) || (video_output_get_info(obs_encoder_video(_self))->format != VIDEO_FORMAT_NV12)) {
+		// Scaling is fine, as the textures are scaled on the GPU on their way into the encoder.
+		if ((obs_data_get_int(settings, ST_KEY_FFMPEG_GPU) != -1) || _gpu_session || (video_output_get_info(obs_encoder_video(_self))->format != VIDEO_FORMAT_NV12)) {
 			throw std::runtime_error("Selected settings prevent the use of hardware encoding, falling back to software.");
 		}
 
@@ -102,18 +206,22 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 		throw std::runtime_error("Failed to create encoder context.");
 	}
 
-	// Allocate a small packet for later use.
-	_packet = {av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); }};
-	av_new_packet(_packet.get(), 8 * 1024 * 1024); // 8 MiB is usually enough for compressed data.
+	// Let the encoder write packets into pooled memory instead of allocating per packet.
+	_packet_pool.attach(_context);
+	_packet = _packet_pool.pop();
 
 	// Initialize
-	if (is_hw) {
+	if (_codec->type == AVMEDIA_TYPE_AUDIO) {
+		initialize_audio(settings);
+	} else if (is_hw) {
 		initialize_hw(settings);
 	} else {
 		initialize_sw(settings);
 	}
 
-	{ // Set up framerate division.
+	if (_codec->type == AVMEDIA_TYPE_AUDIO) {
+		_framerate_divisor = 1;
+	} else { // Set up framerate division.
 		_framerate_divisor = obs_data_get_int(settings, ST_KEY_FFMPEG_FRAMERATE);
 
 		_context->ticks_per_frame = 1;
@@ -124,20 +232,126 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 	// Update settings
 	update(settings);
 
-	// Initialize Encoder
-	auto gctx = streamfx::obs::gs::context();
-	int  res  = avcodec_open2(_context, _codec, NULL);
-	if (res < 0) {
-		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	// Measure which threading sustains the framerate with the least lag, instead of trusting the user.
+	if (obs_data_get_bool(settings, ST_KEY_FFMPEG_THREADS_ADAPTIVE)) {
+		initialize_threading();
 	}
+
+	// Place key frames on scene cuts, but never closer than half a second to each other.
+	if (int64_t sensitivity = obs_data_get_int(settings, ST_KEY_FFMPEG_SCENECUT); (sensitivity > 0) && !_hwinst) {
+		double      threshold = std::max(1. - static_cast<double>(sensitivity) / 100., 0.05);
+		std::size_t distance  = 1;
+		if (_context->framerate.den > 0) {
+			distance = static_cast<std::size_t>(std::max(av_q2d(_context->framerate) / 2., 1.));
+		}
+		_scenecut = std::make_shared<::streamfx::ffmpeg::scene_detector>(threshold, distance);
+
+		// Some encoders only turn forced I-Frames into IDR-Frames when asked to.
+		if (::streamfx::ffmpeg::tools::avoption_exists(_context->priv_data, "forced-idr")) {
+			av_opt_set_int(_context->priv_data, "forced-idr", 1, 0);
+		}
+	}
+
+	// Split frames across several contexts, if the codec allows it.
+	initialize_parallel(settings);
+
+	{ // Initialize Encoder
+		auto gctx = streamfx::obs::gs::context();
+		int  res  = avcodec_open2(_context, _codec, NULL);
+		if (res < 0) {
+			if (_handler && _handler->is_hardware(_factory)) {
+				// The driver may have changed since the capabilities were probed.
+				capabilities::instance()->invalidate();
+			}
+			throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+		}
+	}
+
+	// Audio encoders write their headers while opening, and muxers want them before the first packet.
+	if ((_codec->type == AVMEDIA_TYPE_AUDIO) && _context->extradata) {
+		_extra_data.assign(_context->extradata, _context->extradata + _context->extradata_size);
+	}
+
+	// Move sending and receiving to a dedicated thread if requested, parallel encoding already does so.
+	_pipeline = obs_data_get_bool(settings, ST_KEY_FFMPEG_PIPELINE) && _parallel.empty();
+
+	// Skip frames identical to the previous one, but still encode at least one frame per second.
+	_skip = obs_data_get_bool(settings, ST_KEY_FFMPEG_SKIPUNCHANGED);
+	if (_context->framerate.den > 0) {
+		_skip_limit = static_cast<std::size_t>(std::max(av_q2d(_context->framerate), 1.));
+	}
+
+	// Allocate all frames now, so that encoding itself doesn't have to.
+	initialize_frames();
+
+	if (_pipeline) {
+		_pipeline_thread = std::thread([this]() { pipeline_main(); });
+	}
+
+#ifdef ENABLE_PROFILING
+	_profile_latency        = ::streamfx::util::profiler::create();
+	_profile_convert        = ::streamfx::util::profiler::create();
+	_profile_copy           = ::streamfx::util::profiler::create();
+	_profile_prepare        = ::streamfx::util::profiler::create();
+	_profile_queue          = ::streamfx::util::profiler::create();
+	_profile_encode         = ::streamfx::util::profiler::create();
+	_profile_dropped        = 0;
+	_profile_bytes          = 0;
+	_profile_reported       = std::chrono::steady_clock::now();
+	_profile_reported_bytes = 0;
+	{
+		auto&                       reg = get_registry();
+		std::lock_guard<std::mutex> lock(reg.lock);
+		reg.instances.insert(this);
+	}
+#endif
 }
 
 ffmpeg_instance::~ffmpeg_instance()
 {
+#ifdef ENABLE_PROFILING
+	{
+		auto&                       reg = get_registry();
+		std::lock_guard<std::mutex> lock(reg.lock);
+		reg.instances.erase(this);
+	}
+#endif
+
+	// Wait for the threadpool to let go of every parallel context, then close all but the main one.
+	if (!_parallel.empty()) {
+		{
+			std::unique_lock<std::mutex> lock(_parallel_lock);
+			_parallel_cv.wait(lock, [this]() { return std::none_of(_parallel.begin(), _parallel.end(), [](const std::shared_ptr<parallel_lane>& lane) { return lane->busy; }); });
+		}
+		for (auto& lane : _parallel) {
+			if (lane->context == _context) {
+				continue;
+			}
+			if ((_codec->capabilities & AV_CODEC_CAP_DELAY) != 0) {
+				avcodec_send_frame(lane->context, nullptr);
+				while (avcodec_receive_packet(lane->context, _packet.get()) >= 0) {
+					av_packet_unref(_packet.get());
+				}
+			}
+			avcodec_free_context(&lane->context);
+		}
+		_parallel_done.clear();
+	}
+
+	// Stop the pipeline first, it needs the graphics context to finish.
+	if (_pipeline_thread.joinable()) {
+		{
+			std::unique_lock<std::mutex> lock(_pipeline_lock);
+			_pipeline_stop = true;
+		}
+		_pipeline_cv.notify_all();
+		_pipeline_thread.join();
+	}
+
 	auto gctx = streamfx::obs::gs::context();
 	if (_context) {
-		// Flush encoders that require it.
-		if ((_codec->capabilities & AV_CODEC_CAP_DELAY) != 0) {
+		// Flush encoders that require it, the pipeline thread already did so.
+		if (!_pipeline && ((_codec->capabilities & AV_CODEC_CAP_DELAY) != 0)) {
 			avcodec_send_frame(_context, nullptr);
 			while (avcodec_receive_packet(_context, _packet.get()) >= 0) {
 				avcodec_send_frame(_context, nullptr);
@@ -164,7 +378,16 @@ void ffmpeg_instance::get_properties(obs_properties_t* props)
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_KEYFRAMES_INTERVAL_FRAMES), false);
 
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_THREADS), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_THREADS_ADAPTIVE), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_GPU), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_BALANCE), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_REGIONSOFINTEREST), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_UPLOAD), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_PIPELINE), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_PARALLEL), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_SKIPUNCHANGED), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_SCENECUT), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_SCALETHREADS), false);
 }
 
 void ffmpeg_instance::migrate(obs_data_t* settings, uint64_t version)
@@ -200,7 +423,7 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 				_context->thread_type |= FF_THREAD_SLICE;
 			}
 			if (_context->thread_type != 0) {
-				int64_t threads = obs_data_get_int(settings, ST_I18N_FFMPEG_THREADS);
+				int64_t threads = obs_data_get_int(settings, ST_KEY_FFMPEG_THREADS);
 				if (threads > 0) {
 					_context->thread_count = static_cast<int>(threads);
 				} else {
@@ -219,8 +442,8 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 
 	if (!_context->internal || (support_reconfig && support_reconfig_gpu)) {
 		// Apply GPU Selection
-		if (!_hwinst && ::streamfx::ffmpeg::tools::can_hardware_encode(_codec)) {
-			av_opt_set_int(_context, "gpu", (int)obs_data_get_int(settings, ST_KEY_FFMPEG_GPU), AV_OPT_SEARCH_CHILDREN);
+		if (!_hwinst && !_upload && ::streamfx::ffmpeg::tools::can_hardware_encode(_codec)) {
+			av_opt_set_int(_context, "gpu", (int)get_gpu(settings), AV_OPT_SEARCH_CHILDREN);
 		}
 	}
 
@@ -247,6 +470,10 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 	}
 
 	if (!_context->internal || support_reconfig) {
+		if (_codec->type == AVMEDIA_TYPE_AUDIO) { // Bitrate
+			_context->bit_rate = obs_data_get_int(settings, ST_KEY_FFMPEG_BITRATE) * 1000;
+		}
+
 		// Handler Options
 		if (_handler)
 			_handler->update(this->_factory, this, settings);
@@ -271,23 +498,36 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 		DLOG_INFO("[%s]     Standard Compliance: %s", _codec->name, ::streamfx::ffmpeg::tools::get_std_compliance_name(_context->strict_std_compliance));
 		DLOG_INFO("[%s]     Threading: %s (with %i threads)", _codec->name, ::streamfx::ffmpeg::tools::get_thread_type_name(_context->thread_type), _context->thread_count);
 
-		DLOG_INFO("[%s]   Video:", _codec->name);
-		if (_hwinst) {
-			DLOG_INFO("[%s]     Texture: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _context->width, _context->height, ::streamfx::ffmpeg::tools::get_pixel_format_name(_context->sw_pix_fmt), ::streamfx::ffmpeg::tools::get_color_space_name(_context->colorspace), av_color_range_name(_context->color_range));
+		if (_codec->type == AVMEDIA_TYPE_AUDIO) {
+			DLOG_INFO("[%s]   Audio:", _codec->name);
+			DLOG_INFO("[%s]     Format: %s, %" PRId32 " Hz, %" PRId32 " Channels", _codec->name, av_get_sample_fmt_name(_context->sample_fmt), _context->sample_rate, get_channel_count(_context));
+			DLOG_INFO("[%s]     Bitrate: %" PRId64 " kbit/s", _codec->name, static_cast<int64_t>(_context->bit_rate / 1000));
 		} else {
-			DLOG_INFO("[%s]     Input: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _scaler.get_source_width(), _scaler.get_source_height(), ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_source_format()), ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_source_colorspace()), _scaler.is_source_full_range() ? "Full" : "Partial");
-			DLOG_INFO("[%s]     Output: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _scaler.get_target_width(), _scaler.get_target_height(), ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_target_format()), ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_target_colorspace()), _scaler.is_target_full_range() ? "Full" : "Partial");
-			if (!_hwinst)
-				DLOG_INFO("[%s]     On GPU Index: %lli", _codec->name, obs_data_get_int(settings, ST_KEY_FFMPEG_GPU));
-		}
-		DLOG_INFO("[%s]     Framerate: %" PRId32 "/%" PRId32 " (%f FPS)", _codec->name, _context->time_base.den, _context->time_base.num, static_cast<double_t>(_context->time_base.den) / static_cast<double_t>(_context->time_base.num));
+			DLOG_INFO("[%s]   Video:", _codec->name);
+			if (_hwinst) {
+				DLOG_INFO("[%s]     Texture: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _context->width, _context->height, ::streamfx::ffmpeg::tools::get_pixel_format_name(_context->sw_pix_fmt), ::streamfx::ffmpeg::tools::get_color_space_name(_context->colorspace), av_color_range_name(_context->color_range));
+				if (obs_encoder_scaling_enabled(_self)) {
+					const video_output_info* voi = video_output_get_info(obs_encoder_video(_self));
+					DLOG_INFO("[%s]     Scaled on GPU from: %" PRIu32 "x%" PRIu32, _codec->name, voi->width, voi->height);
+				}
+			} else if (_upload) {
+				DLOG_INFO("[%s]     Upload: %" PRId32 "x%" PRId32 " %s to %s %s %s", _codec->name, _context->width, _context->height, ::streamfx::ffmpeg::tools::get_pixel_format_name(_context->sw_pix_fmt), ::streamfx::ffmpeg::tools::get_pixel_format_name(_context->pix_fmt), ::streamfx::ffmpeg::tools::get_color_space_name(_context->colorspace), av_color_range_name(_context->color_range));
+			} else {
+				DLOG_INFO("[%s]     Input: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _scaler.get_source_width(), _scaler.get_source_height(), ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_source_format()), ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_source_colorspace()), _scaler.is_source_full_range() ? "Full" : "Partial");
+				DLOG_INFO("[%s]     Output: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _scaler.get_target_width(), _scaler.get_target_height(), ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_target_format()), ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_target_colorspace()), _scaler.is_target_full_range() ? "Full" : "Partial");
+				DLOG_INFO("[%s]     Conversion Threads: %zu", _codec->name, _scaler.get_threads());
+				if (!_hwinst)
+					DLOG_INFO("[%s]     On GPU Index: %" PRId64 "%s", _codec->name, get_gpu(settings), _gpu_session ? " (Balanced)" : "");
+			}
+			DLOG_INFO("[%s]     Framerate: %" PRId32 "/%" PRId32 " (%f FPS)", _codec->name, _context->time_base.den, _context->time_base.num, static_cast<double_t>(_context->time_base.den) / static_cast<double_t>(_context->time_base.num));
 
-		DLOG_INFO("[%s]   Keyframes: ", _codec->name);
-		if (_context->keyint_min != _context->gop_size) {
-			DLOG_INFO("[%s]     Minimum: %i frames", _codec->name, _context->keyint_min);
-			DLOG_INFO("[%s]     Maximum: %i frames", _codec->name, _context->gop_size);
-		} else {
-			DLOG_INFO("[%s]     Distance: %i frames", _codec->name, _context->gop_size);
+			DLOG_INFO("[%s]   Keyframes: ", _codec->name);
+			if (_context->keyint_min != _context->gop_size) {
+				DLOG_INFO("[%s]     Minimum: %i frames", _codec->name, _context->keyint_min);
+				DLOG_INFO("[%s]     Maximum: %i frames", _codec->name, _context->gop_size);
+			} else {
+				DLOG_INFO("[%s]     Distance: %i frames", _codec->name, _context->gop_size);
+			}
 		}
 
 		if (_handler) {
@@ -308,29 +548,32 @@ static inline void copy_data(encoder_frame* frame, AVFrame* vframe)
 			continue;
 
 		std::size_t plane_height = static_cast<size_t>(vframe->height) >> (idx ? v_chroma_shift : 0);
+		std::size_t ls_in        = static_cast<size_t>(frame->linesize[idx]);
+		std::size_t ls_out       = static_cast<size_t>(vframe->linesize[idx]);
+		std::size_t bytes        = ls_in < ls_out ? ls_in : ls_out;
 
-		if (static_cast<uint32_t>(vframe->linesize[idx]) == frame->linesize[idx]) {
-			std::memcpy(vframe->data[idx], frame->data[idx], frame->linesize[idx] * plane_height);
-		} else {
-			std::size_t ls_in  = static_cast<size_t>(frame->linesize[idx]);
-			std::size_t ls_out = static_cast<size_t>(vframe->linesize[idx]);
-			std::size_t bytes  = ls_in < ls_out ? ls_in : ls_out;
-
-			uint8_t* to   = vframe->data[idx];
-			uint8_t* from = frame->data[idx];
-
-			for (std::size_t y = 0; y < plane_height; y++) {
-				std::memcpy(to, from, bytes);
-				to += ls_out;
-				from += ls_in;
-			}
-		}
+		::streamfx::util::copy::plane_parallel(vframe->data[idx], ls_out, frame->data[idx], ls_in, bytes, plane_height);
 	}
 }
 
 bool ffmpeg_instance::encode_audio(struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet)
 {
-	throw std::logic_error("The method or operation is not implemented.");
+	telemetry_capture();
+
+	std::shared_ptr<AVFrame> aframe = pop_free_frame(); // Retrieve an empty frame.
+
+	// Convert straight from OBS's planar float into the pooled frame, instead of resampling.
+	{
+#ifdef ENABLE_PROFILING
+		::streamfx::util::profiler::instance profile(_profile_convert);
+#endif
+		std::size_t samples = std::min<size_t>(frame->frames, static_cast<size_t>(aframe->nb_samples));
+		::streamfx::ffmpeg::sample_convert::convert(aframe.get(), frame->data, static_cast<size_t>(get_channel_count(_context)), samples);
+		aframe->nb_samples = static_cast<int>(samples);
+	}
+	aframe->pts = frame->pts;
+
+	return encode_avframe(aframe, packet, received_packet);
 }
 
 bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet)
@@ -339,8 +582,55 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 		return true;
 	}
 
+	telemetry_capture();
+
+	if (_skip && is_unchanged_frame(frame)) {
+		return skip_frame(packet, received_packet);
+	}
+
 	std::shared_ptr<AVFrame> vframe = pop_free_frame(); // Retrieve an empty frame.
 
+	// Pool frames may still carry the decision of a previous frame.
+	vframe->pict_type = AV_PICTURE_TYPE_NONE;
+	if (_scenecut) {
+		AVPixelFormat format = _upload ? _context->sw_pix_fmt : _scaler.get_source_format();
+		if (_scenecut->is_cut(format, frame->data[0], frame->linesize[0], _context->width, _context->height)) {
+			vframe->pict_type = AV_PICTURE_TYPE_I;
+		}
+	}
+
+	if (_upload) {
+		// Upload the frame straight from OBS's memory into the hardware frame, skipping the intermediate copy.
+		AVFrame source = {};
+		source.width   = _context->width;
+		source.height  = _context->height;
+		source.format  = _context->sw_pix_fmt;
+		for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+			source.data[idx]     = frame->data[idx];
+			source.linesize[idx] = static_cast<int>(frame->linesize[idx]);
+		}
+
+		{
+#ifdef ENABLE_PROFILING
+			::streamfx::util::profiler::instance profile(_profile_copy);
+#endif
+			if (int res = av_hwframe_transfer_data(vframe.get(), &source, 0); res < 0) {
+				DLOG_ERROR("Failed to upload frame: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+				push_free_frame(vframe);
+				telemetry_drop(frame->pts);
+				return false;
+			}
+		}
+
+		vframe->color_range     = _context->color_range;
+		vframe->colorspace      = _context->colorspace;
+		vframe->color_primaries = _context->color_primaries;
+		vframe->color_trc       = _context->color_trc;
+		vframe->pts             = frame->pts;
+
+		return encode_avframe(vframe, packet, received_packet);
+	}
+
 	// Convert frame.
 	{
 		vframe->height          = _context->height;
@@ -351,12 +641,16 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 		vframe->color_trc       = _context->color_trc;
 		vframe->pts             = frame->pts;
 
+#ifdef ENABLE_PROFILING
+		::streamfx::util::profiler::instance profile(_profile_convert);
+#endif
 		if ((_scaler.is_source_full_range() == _scaler.is_target_full_range()) && (_scaler.get_source_colorspace() == _scaler.get_target_colorspace()) && (_scaler.get_source_format() == _scaler.get_target_format())) {
 			copy_data(frame, vframe.get());
 		} else {
 			int res = _scaler.convert(reinterpret_cast<uint8_t**>(frame->data), reinterpret_cast<int*>(frame->linesize), 0, _context->height, vframe->data, vframe->linesize);
 			if (res <= 0) {
 				DLOG_ERROR("Failed to convert frame: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+				telemetry_drop(frame->pts);
 				return false;
 			}
 		}
@@ -382,8 +676,15 @@ bool ffmpeg_instance::encode_video(uint32_t handle, int64_t pts, uint64_t lock_k
 		return false;
 	}
 
+	telemetry_capture();
+
 	std::shared_ptr<AVFrame> vframe = pop_free_frame();
-	_hwinst->copy_from_obs(_context->hw_frames_ctx, handle, lock_key, next_key, vframe);
+	{
+#ifdef ENABLE_PROFILING
+		::streamfx::util::profiler::instance profile(_profile_copy);
+#endif
+		_hwinst->copy_from_obs(_context->hw_frames_ctx, handle, lock_key, next_key, vframe);
+	}
 
 	vframe->color_range     = _context->color_range;
 	vframe->colorspace      = _context->colorspace;
@@ -437,7 +738,13 @@ void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 	_scaler.set_target_color(_context->color_range == AVCOL_RANGE_JPEG, _context->colorspace);
 	_scaler.set_target_format(pix_fmt_target);
 
+	// Upload directly to the GPU if possible, which makes the scaler unnecessary.
+	if (obs_data_get_bool(settings, ST_KEY_FFMPEG_UPLOAD) && initialize_upload(settings, pix_fmt_source)) {
+		return;
+	}
+
 	// Create Scaler
+	_scaler.set_threads(static_cast<size_t>(std::max<int64_t>(obs_data_get_int(settings, ST_KEY_FFMPEG_SCALETHREADS), 1)));
 	if (!_scaler.initialize(SWS_SINC | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND | SWS_BITEXACT)) {
 		std::stringstream sstr;
 		sstr << "Initializing scaler failed for conversion from '" << ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_source_format()) << "' to '" << ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_target_format()) << "' with color space '" << ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_source_colorspace()) << "' and " << (_scaler.is_source_full_range() ? "full" : "partial") << " range.";
@@ -445,18 +752,59 @@ void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 	}
 }
 
-void ffmpeg_instance::initialize_hw(obs_data_t*)
+void ffmpeg_instance::initialize_audio(obs_data_t*)
 {
-#ifndef D_PLATFORM_WINDOWS
-	throw std::runtime_error("OBS Studio currently does not support zero copy encoding for this platform.");
+	auto aoi = audio_output_get_info(obs_encoder_audio(_self));
+
+	// Without swresample there is no way to reach other formats or rates, so encoders must take what OBS has.
+	_context->sample_fmt = ::streamfx::ffmpeg::sample_convert::get_best_format(_codec->sample_fmts);
+	if (_context->sample_fmt == AV_SAMPLE_FMT_NONE) {
+		throw std::runtime_error("Encoder supports none of the sample formats that can be converted to.");
+	}
+
+	_context->sample_rate = static_cast<int>(aoi->samples_per_sec);
+	if (_codec->supported_samplerates) {
+		bool supported = false;
+		for (auto rate = _codec->supported_samplerates; *rate != 0; rate++) {
+			supported |= (*rate == _context->sample_rate);
+		}
+		if (!supported) {
+			throw std::runtime_error("Encoder does not support the sample rate of OBS Studio.");
+		}
+	}
+
+	int channels = static_cast<int>(get_audio_channels(aoi->speakers));
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+	av_channel_layout_default(&_context->ch_layout, channels);
 #else
+	_context->channels       = channels;
+	_context->channel_layout = static_cast<uint64_t>(av_get_default_channel_layout(channels));
+#endif
+
+	// OBS Studio counts audio timestamps in samples.
+	_context->time_base = {1, _context->sample_rate};
+
+	// Muxers expect the headers in the extra data instead of repeated in the stream.
+	_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+}
+
+void ffmpeg_instance::initialize_hw(obs_data_t*)
+{
+	if (!_hwinst) {
+		throw std::runtime_error("OBS Studio currently does not support zero copy encoding for this platform.");
+	}
+
 	// Initialize Video Encoding
 	const video_output_info* voi = video_output_get_info(obs_encoder_video(_self));
 
 	// Apply pixel format settings.
 	::streamfx::ffmpeg::tools::context_setup_from_obs(voi, _context);
 	_context->sw_pix_fmt = _context->pix_fmt;
-	_context->pix_fmt    = AV_PIX_FMT_D3D11;
+	_context->pix_fmt    = _hwinst->get_pixel_format();
+
+	// The textures always have the size of the video output, the encoder may want a different size.
+	_context->width  = static_cast<int>(obs_encoder_get_width(_self));
+	_context->height = static_cast<int>(obs_encoder_get_height(_self));
 
 	// Try to create a hardware context.
 	_context->hw_device_ctx = _hwinst->create_device_context();
@@ -471,56 +819,503 @@ void ffmpeg_instance::initialize_hw(obs_data_t*)
 	ctx->height            = _context->height;
 	ctx->format            = _context->pix_fmt;
 	ctx->sw_format         = _context->sw_pix_fmt;
+	_hwinst->prepare_frames(_context->hw_frames_ctx, voi->width, voi->height);
 	if (int32_t res = av_hwframe_ctx_init(_context->hw_frames_ctx); res < 0) {
 		std::array<char, 4096> buffer;
 
-		int len = snprintf(buffer.data(), buffer.size(), "Failed initialize hardware context: %s (%" PRIu32 ")", ::streamfx::ffmpeg::tools::get_error_description(res), res);
-		throw std::runtime_error(std::string(buffer.data(), buffer.data() + len));
+		int len = snprintf(buffer.data(), buffer.size(), "Failed initialize hardware context: %s (%" PRIu32 ")", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+		throw std::runtime_error(std::string(buffer.data(), buffer.data() + len));
+	}
+}
+
+std::shared_ptr<AVBufferRef> ffmpeg_instance::acquire_hwdevice(AVHWDeviceType type, std::string const& name)
+{
+	// Encoders on the same device share it, which for example puts all NVENC sessions into one CUDA context.
+	static std::mutex                                                                   lock;
+	static std::map<std::pair<AVHWDeviceType, std::string>, std::weak_ptr<AVBufferRef>> devices;
+
+	std::unique_lock<std::mutex> ulock(lock);
+	auto                         key = std::make_pair(type, name);
+	if (auto iter = devices.find(key); iter != devices.end()) {
+		if (auto device = iter->second.lock(); device) {
+			return device;
+		}
+	}
+
+	AVBufferRef* device = nullptr;
+	if (av_hwdevice_ctx_create(&device, type, name.empty() ? nullptr : name.c_str(), nullptr, 0) < 0) {
+		return nullptr;
+	}
+
+	auto shared  = std::shared_ptr<AVBufferRef>(device, [](AVBufferRef* ptr) { av_buffer_unref(&ptr); });
+	devices[key] = shared;
+	return shared;
+}
+
+std::shared_ptr<int64_t> ffmpeg_instance::acquire_balanced_gpu()
+{
+	// Sessions per GPU index, counted over every FFmpeg encoder.
+	static std::mutex                     lock;
+	static std::map<int64_t, std::size_t> sessions;
+
+	int32_t count   = 0;
+	int64_t obs_gpu = -1;
+#ifdef ENABLE_NVIDIA_CUDA
+	try {
+		// The "gpu" option and device names of NVENC and CUDA both use CUDA device ordinals.
+		if (::streamfx::nvidia::cuda::cuda::get()->cuDeviceGetCount(&count) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+			count = 0;
+		}
+		obs_gpu = ::streamfx::nvidia::cuda::obs::get()->get_context()->get_device();
+	} catch (...) {
+	}
+#endif
+	if (count <= 1) {
+		return nullptr;
+	}
+
+	std::unique_lock<std::mutex> ul(lock);
+	int64_t                      best      = 0;
+	std::size_t                  best_load = std::numeric_limits<std::size_t>::max();
+	for (int64_t idx = 0; idx < count; idx++) {
+		// Compositing in libOBS counts as one session, which moves ties away from its GPU.
+		std::size_t load = sessions[idx] + ((idx == obs_gpu) ? 1 : 0);
+		if (load < best_load) {
+			best      = idx;
+			best_load = load;
+		}
+	}
+	sessions[best]++;
+
+	return std::shared_ptr<int64_t>(new int64_t(best), [](int64_t* ptr) {
+		std::unique_lock<std::mutex> ul(lock);
+		sessions[*ptr]--;
+		delete ptr;
+	});
+}
+
+int64_t ffmpeg_instance::get_gpu(obs_data_t* settings)
+{
+	if (_gpu_session) {
+		return *_gpu_session;
+	}
+	return obs_data_get_int(settings, ST_KEY_FFMPEG_GPU);
+}
+
+void ffmpeg_instance::apply_regions_of_interest(std::shared_ptr<AVFrame> frame)
+{
+	// Frames are pooled, so regions from a previous use must not carry over.
+	av_frame_remove_side_data(frame.get(), AV_FRAME_DATA_REGIONS_OF_INTEREST);
+
+	if (!_roi) {
+		return;
+	}
+
+	auto regions = _roi->collect();
+	if (regions.empty()) {
+		return;
+	}
+
+	// One extra region covers the entire frame, so that bits are taken from the background.
+	auto* sd = av_frame_new_side_data(frame.get(), AV_FRAME_DATA_REGIONS_OF_INTEREST, sizeof(AVRegionOfInterest) * (regions.size() + 1));
+	if (!sd) {
+		return;
+	}
+	auto* rois = reinterpret_cast<AVRegionOfInterest*>(sd->data);
+
+	// Encoders use the first region that contains a block, so the background has to be last.
+	float width  = static_cast<float>(frame->width);
+	float height = static_cast<float>(frame->height);
+	for (std::size_t idx = 0; idx < regions.size(); idx++) {
+		rois[idx].self_size = sizeof(AVRegionOfInterest);
+		rois[idx].left      = static_cast<int>(std::floor(regions[idx].left * width));
+		rois[idx].top       = static_cast<int>(std::floor(regions[idx].top * height));
+		rois[idx].right     = static_cast<int>(std::ceil(regions[idx].right * width));
+		rois[idx].bottom    = static_cast<int>(std::ceil(regions[idx].bottom * height));
+		rois[idx].qoffset   = {-static_cast<int>(_roi_strength), 200};
+	}
+	{
+		auto& bg     = rois[regions.size()];
+		bg.self_size = sizeof(AVRegionOfInterest);
+		bg.left      = 0;
+		bg.top       = 0;
+		bg.right     = frame->width;
+		bg.bottom    = frame->height;
+		bg.qoffset   = {static_cast<int>(_roi_strength), 400};
+	}
+}
+
+bool ffmpeg_instance::initialize_upload(obs_data_t* settings, AVPixelFormat format)
+{
+	// Only formats that hardware encoders consume natively avoid a conversion.
+	if ((format != AV_PIX_FMT_NV12) && (format != AV_PIX_FMT_P010)) {
+		DLOG_WARNING("[%s] Direct upload is not possible for '%s', using software conversion.", _codec->name, ::streamfx::ffmpeg::tools::get_pixel_format_name(format));
+		return false;
+	}
+
+	// Use the GPU selected by the user, if any.
+	std::string device_name;
+	if (int64_t gpu = get_gpu(settings); gpu >= 0) {
+		device_name = std::to_string(gpu);
+	}
+
+	for (int idx = 0;; idx++) {
+		const AVCodecHWConfig* config = avcodec_get_hw_config(_codec, idx);
+		if (!config) {
+			break;
+		}
+		if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_FRAMES_CTX) == 0) {
+			continue;
+		}
+
+		std::shared_ptr<AVBufferRef> shared_device = acquire_hwdevice(config->device_type, device_name);
+		if (!shared_device) {
+			continue;
+		}
+		AVBufferRef* device = av_buffer_ref(shared_device.get());
+		if (!device) {
+			continue;
+		}
+
+		// Check if the device can store the format OBS gives us.
+		bool supported = false;
+		if (AVHWFramesConstraints* constraints = av_hwdevice_get_hwframe_constraints(device, nullptr); constraints) {
+			for (const AVPixelFormat* fmt = constraints->valid_sw_formats; fmt && (*fmt != AV_PIX_FMT_NONE); fmt++) {
+				if (*fmt == format) {
+					supported = true;
+					break;
+				}
+			}
+			av_hwframe_constraints_free(&constraints);
+		}
+		if (!supported) {
+			av_buffer_unref(&device);
+			continue;
+		}
+
+		AVBufferRef* frames = av_hwframe_ctx_alloc(device);
+		if (!frames) {
+			av_buffer_unref(&device);
+			continue;
+		}
+
+		AVHWFramesContext* ctx = reinterpret_cast<AVHWFramesContext*>(frames->data);
+		ctx->width             = _context->width;
+		ctx->height            = _context->height;
+		ctx->format            = config->pix_fmt;
+		ctx->sw_format         = format;
+		if (int res = av_hwframe_ctx_init(frames); res < 0) {
+			DLOG_WARNING("[%s] Failed to initialize '%s' frames: %s (%" PRId32 ").", _codec->name, av_hwdevice_get_type_name(config->device_type), ::streamfx::ffmpeg::tools::get_error_description(res), res);
+			av_buffer_unref(&frames);
+			av_buffer_unref(&device);
+			continue;
+		}
+
+		_context->hw_device_ctx = device;
+		_context->hw_frames_ctx = frames;
+		_context->sw_pix_fmt    = format;
+		_context->pix_fmt       = config->pix_fmt;
+		_upload                 = true;
+		_upload_device          = shared_device;
+		return true;
+	}
+
+	DLOG_WARNING("[%s] No hardware device supports direct upload, using software conversion.", _codec->name);
+	return false;
+}
+
+void ffmpeg_instance::push_free_frame(std::shared_ptr<AVFrame> frame)
+{
+	_free_frames.push(frame);
+}
+
+std::shared_ptr<AVFrame> ffmpeg_instance::pop_free_frame()
+{
+	return _free_frames.pop();
+}
+
+// Advanced placement of the memory of software frames, for systems with more than one NUMA node.
+#define ST_CFG_FRAMES_NUMANODE "Encoder.FFmpeg.Frames.NUMANode"
+#define ST_CFG_FRAMES_HUGEPAGES "Encoder.FFmpeg.Frames.HugePages"
+
+static std::pair<int32_t, bool> frame_memory_options()
+{
+	static std::pair<int32_t, bool> options = []() {
+		std::pair<int32_t, bool> result{-1, true};
+		if (auto config = streamfx::configuration::instance(); config) {
+			auto dataptr = config->get();
+			if (obs_data_has_user_value(dataptr.get(), ST_CFG_FRAMES_NUMANODE)) {
+				result.first = static_cast<int32_t>(std::max<long long>(obs_data_get_int(dataptr.get(), ST_CFG_FRAMES_NUMANODE), -1));
+			}
+			if (obs_data_has_user_value(dataptr.get(), ST_CFG_FRAMES_HUGEPAGES)) {
+				result.second = obs_data_get_bool(dataptr.get(), ST_CFG_FRAMES_HUGEPAGES);
+			}
+		}
+		return result;
+	}();
+	return options;
+}
+
+void ffmpeg_instance::initialize_frames()
+{
+	_free_frames.set_resolution(_context->width, _context->height);
+	_free_frames.set_pixel_format(_context->pix_fmt);
+	if (_codec->type == AVMEDIA_TYPE_AUDIO) {
+		_free_frames.set_audio(static_cast<int32_t>(get_frame_size()), get_channel_count(_context), _context->sample_fmt);
+	} else if (_hwinst) {
+		_free_frames.set_allocator([this]() { return _hwinst->allocate_frame(_context->hw_frames_ctx); });
+	} else if (_upload) {
+		_free_frames.set_allocator([this]() {
+			auto frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) {
+				av_frame_unref(frame);
+				av_frame_free(&frame);
+			});
+
+			int res = av_hwframe_get_buffer(_context->hw_frames_ctx, frame.get(), 0);
+			if (res < 0) {
+				throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+			}
+			return frame;
+		});
+	} else {
+		auto [numa_node, huge_pages] = frame_memory_options();
+		_free_frames.set_numa_node(numa_node);
+		_free_frames.set_huge_pages(huge_pages);
+	}
+
+	// Every frame the encoder may hold on to at once, plus the one being filled and the one being sent.
+	std::size_t count = static_cast<size_t>(std::max(_context->thread_count, 1)) + static_cast<size_t>(std::max(_context->delay, _context->max_b_frames)) + 2;
+	if (_pipeline) {
+		count += pipeline_depth;
+	}
+	if (!_parallel.empty()) {
+		count = (count + parallel_depth) * _parallel.size();
+	}
+	_free_frames.precache(count);
+}
+
+void ffmpeg_instance::initialize_threading()
+{
+	// Hardware encoders and frames living on the GPU don't use CPU threads for encoding.
+	if (_hwinst || _upload || (_context->thread_type == 0)) {
+		return;
+	}
+
+	// Frames to encode per candidate, and how long a candidate may take at most.
+	constexpr std::size_t               benchmark_frames = 16;
+	constexpr std::chrono::milliseconds benchmark_limit{500};
+
+	struct candidate {
+		int                      thread_type;
+		int                      thread_count;
+		std::chrono::nanoseconds frame_time;
+		std::size_t              lag;
+	};
+
+	// Leave one core for the OBS compositor and render threads.
+	int max_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+
+	std::vector<int> counts;
+	for (int count = 1; count < max_threads; count *= 2) {
+		counts.push_back(count);
+	}
+	counts.push_back(max_threads);
+
+	std::vector<candidate> candidates;
+	for (int type : {FF_THREAD_SLICE, FF_THREAD_FRAME}) {
+		if ((_context->thread_type & type) == 0) {
+			continue;
+		}
+		for (int count : counts) {
+			// A single thread is the same for both modes.
+			if ((count == 1) && !candidates.empty() && (candidates.front().thread_count == 1)) {
+				continue;
+			}
+			candidates.push_back({type, count, std::chrono::nanoseconds::max(), 0});
+		}
+	}
+
+	// A representative frame, noise is the worst case for intra-only codecs.
+	std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame* ptr) { av_frame_free(&ptr); }};
+	frame->width  = _context->width;
+	frame->height = _context->height;
+	frame->format = _context->pix_fmt;
+	if (av_frame_get_buffer(frame.get(), 0) < 0) {
+		return;
+	}
+	{
+		uint32_t state = 0x9E3779B9;
+		for (std::size_t plane = 0; (plane < AV_NUM_DATA_POINTERS) && frame->buf[plane]; plane++) {
+			for (std::size_t idx = 0; idx < frame->buf[plane]->size; idx++) {
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				frame->buf[plane]->data[idx] = static_cast<uint8_t>(state);
+			}
+		}
+	}
+
+	std::shared_ptr<AVPacket> packet = _packet_pool.pop();
+	for (auto& entry : candidates) {
+		AVCodecContext* context = avcodec_alloc_context3(_codec);
+		if (!context) {
+			continue;
+		}
+
+		// Copy all options, including the ones set by the handler, then the fields that aren't options.
+		av_opt_copy(context, _context);
+		if (context->priv_data && _context->priv_data) {
+			av_opt_copy(context->priv_data, _context->priv_data);
+		}
+		context->width                  = _context->width;
+		context->height                 = _context->height;
+		context->pix_fmt                = _context->pix_fmt;
+		context->time_base              = _context->time_base;
+		context->framerate              = _context->framerate;
+		context->sample_aspect_ratio    = _context->sample_aspect_ratio;
+		context->color_range            = _context->color_range;
+		context->colorspace             = _context->colorspace;
+		context->color_primaries        = _context->color_primaries;
+		context->color_trc              = _context->color_trc;
+		context->thread_type            = entry.thread_type;
+		context->thread_count           = entry.thread_count;
+		context->delay                  = (entry.thread_type == FF_THREAD_FRAME) ? entry.thread_count : 0;
+
+		if (avcodec_open2(context, _codec, NULL) >= 0) {
+			std::size_t sent     = 0;
+			std::size_t received = 0;
+			auto        start    = std::chrono::high_resolution_clock::now();
+			auto        end      = start;
+			while ((sent < benchmark_frames) && ((end - start) < benchmark_limit)) {
+				frame->pts = static_cast<int64_t>(sent);
+				if (avcodec_send_frame(context, frame.get()) < 0) {
+					break;
+				}
+				sent++;
+
+				while (avcodec_receive_packet(context, packet.get()) == 0) {
+					if (received == 0) {
+						entry.lag = sent - 1;
+					}
+					received++;
+					av_packet_unref(packet.get());
+				}
+				end = std::chrono::high_resolution_clock::now();
+			}
+
+			if (received > 0) {
+				entry.frame_time = (end - start) / sent;
+			}
+		}
+
+		avcodec_free_context(&context);
+		DLOG_DEBUG("[%s] Threading candidate %s with %i threads: %.2fms per frame, %zu frames of lag.", _codec->name, ::streamfx::ffmpeg::tools::get_thread_type_name(entry.thread_type), entry.thread_count, static_cast<double>(entry.frame_time.count()) / 1000000., entry.lag);
+	}
+	_packet_pool.push(packet);
+
+	// Keep some headroom, as the benchmark doesn't compete with the rest of OBS.
+	auto target = std::chrono::nanoseconds::max();
+	if (_context->framerate.num > 0) {
+		target = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(av_q2d(av_inv_q(_context->framerate)) * 0.8));
 	}
-#endif
-}
 
-void ffmpeg_instance::push_free_frame(std::shared_ptr<AVFrame> frame)
-{
-	auto now = std::chrono::high_resolution_clock::now();
-	if (_free_frames.size() > 0) {
-		if ((now - _free_frames_last_used) < std::chrono::seconds(1)) {
-			_free_frames.push(frame);
+	// Prefer the least lag, then the fewest threads, among the candidates that keep up. If none does, take the fastest.
+	candidate const* best = nullptr;
+	for (auto& entry : candidates) {
+		if (entry.frame_time == std::chrono::nanoseconds::max()) {
+			continue;
+		}
+
+		if (!best) {
+			best = &entry;
+			continue;
+		}
+
+		bool entry_fast = entry.frame_time <= target;
+		bool best_fast  = best->frame_time <= target;
+		if (entry_fast != best_fast) {
+			if (entry_fast) {
+				best = &entry;
+			}
+		} else if (entry_fast) {
+			if ((entry.lag < best->lag) || ((entry.lag == best->lag) && (entry.thread_count < best->thread_count))) {
+				best = &entry;
+			}
+		} else if (entry.frame_time < best->frame_time) {
+			best = &entry;
 		}
-	} else {
-		_free_frames.push(frame);
-		_free_frames_last_used = std::chrono::high_resolution_clock::now();
 	}
+	if (!best) {
+		DLOG_WARNING("[%s] Unable to measure threading performance, keeping the configured threading.", _codec->name);
+		return;
+	}
+
+	_context->thread_type  = best->thread_type;
+	_context->thread_count = best->thread_count;
+	_context->delay        = (best->thread_type == FF_THREAD_FRAME) ? best->thread_count : 0;
+	DLOG_INFO("[%s] Picked %s threading with %i threads (%.2fms per frame).", _codec->name, ::streamfx::ffmpeg::tools::get_thread_type_name(best->thread_type), best->thread_count, static_cast<double>(best->frame_time.count()) / 1000000.);
 }
 
-std::shared_ptr<AVFrame> ffmpeg_instance::pop_free_frame()
+void ffmpeg_instance::initialize_parallel(obs_data_t* settings)
 {
-	std::shared_ptr<AVFrame> frame;
-	if (_free_frames.size() > 0) {
-		// Re-use existing frames first.
-		frame = _free_frames.top();
-		_free_frames.pop();
-	} else {
-		if (_hwinst) {
-			frame = _hwinst->allocate_frame(_context->hw_frames_ctx);
-		} else {
-			frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) {
-				av_frame_unref(frame);
-				av_frame_free(&frame);
-			});
+	int64_t count = obs_data_get_int(settings, ST_KEY_FFMPEG_PARALLEL);
+	if (count <= 1) {
+		return;
+	}
 
-			frame->width  = _context->width;
-			frame->height = _context->height;
-			frame->format = _context->pix_fmt;
+	// Only codecs without any dependencies between frames can be split up, and only if the frames live in memory.
+	const AVCodecDescriptor* desc = avcodec_descriptor_get(_codec->id);
+	if (_hwinst || _upload || (_codec->type != AVMEDIA_TYPE_VIDEO) || !desc || ((desc->props & AV_CODEC_PROP_INTRA_ONLY) == 0)) {
+		DLOG_WARNING("Ignoring parallel encoding, '%s' is not an intra-only software encoder.", _codec->name);
+		return;
+	}
 
-			int res = av_frame_get_buffer(frame.get(), 32);
-			if (res < 0) {
-				throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	// Share the threads between all contexts, instead of each context taking all of them.
+	_context->thread_count = std::max(_context->thread_count / static_cast<int>(count), 1);
+	_context->delay        = (_context->thread_type != 0) ? _context->thread_count : 0;
+
+	_parallel.reserve(static_cast<size_t>(count));
+	_parallel.push_back(std::make_shared<parallel_lane>(parallel_lane{_context, {}, {}, false}));
+	for (int64_t idx = 1; idx < count; idx++) {
+		AVCodecContext* context = avcodec_alloc_context3(_codec);
+		if (context) {
+			// Copies everything set through options, including the custom ones, and then the rest by hand.
+			if ((av_opt_copy(context, _context) < 0) || (av_opt_copy(context->priv_data, _context->priv_data) < 0)) {
+				avcodec_free_context(&context);
+			}
+		}
+		if (context) {
+			context->width           = _context->width;
+			context->height          = _context->height;
+			context->pix_fmt         = _context->pix_fmt;
+			context->sw_pix_fmt      = _context->sw_pix_fmt;
+			context->time_base       = _context->time_base;
+			context->framerate       = _context->framerate;
+			context->ticks_per_frame = _context->ticks_per_frame;
+			context->thread_type     = _context->thread_type;
+			context->thread_count    = _context->thread_count;
+			context->delay           = _context->delay;
+			_packet_pool.attach(context);
+
+			if (int res = avcodec_open2(context, _codec, NULL); res < 0) {
+				DLOG_ERROR("Failed to open parallel context: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+				avcodec_free_context(&context);
+			}
+		}
+		if (!context) {
+			for (auto& lane : _parallel) {
+				if (lane->context != _context) {
+					avcodec_free_context(&lane->context);
+				}
 			}
+			_parallel.clear();
+			throw std::runtime_error("Failed to create parallel encoder context.");
 		}
+
+		_parallel.push_back(std::make_shared<parallel_lane>(parallel_lane{context, {}, {}, false}));
 	}
 
-	return frame;
+	DLOG_INFO("[%s] Encoding with %zu parallel contexts of %" PRId32 " threads each.", _codec->name, _parallel.size(), _context->thread_count);
 }
 
 void ffmpeg_instance::push_used_frame(std::shared_ptr<AVFrame> frame)
@@ -555,6 +1350,20 @@ bool ffmpeg_instance::get_sei_data(uint8_t** data, size_t* size)
 	return true;
 }
 
+size_t ffmpeg_instance::get_frame_size()
+{
+	if (_context->frame_size <= 0) {
+		return default_audio_frame_size;
+	}
+	return static_cast<size_t>(_context->frame_size);
+}
+
+void ffmpeg_instance::get_audio_info(struct audio_convert_info* info)
+{
+	// Conversion to the encoder's format happens in encode_audio(), which is cheaper than having OBS resample it.
+	info->format = AUDIO_FORMAT_FLOAT_PLANAR;
+}
+
 void ffmpeg_instance::get_video_info(struct video_scale_info* info)
 {
 	if (!is_hardware_encode()) {
@@ -577,7 +1386,29 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 		return res;
 	}
 
-	if (!_have_first_frame) {
+	process_packet(received_packet, packet);
+
+	// Push free frame back into pool.
+	push_free_frame(pop_used_frame());
+
+	return res;
+}
+
+void ffmpeg_instance::process_packet(bool* received_packet, struct encoder_packet* packet)
+{
+	if (_codec->id == AV_CODEC_ID_HEVC) {
+		// Parameter sets can be repeated on any keyframe, but are only copied again if they actually changed.
+		if (!_have_first_frame || (_packet->flags & AV_PKT_FLAG_KEY)) {
+			hevc::find_header_sei(_packet->data, static_cast<size_t>(_packet->size), _header_units, _sei_units);
+			if (!_header_units.empty()) {
+				nal::update(_extra_data, _header_units);
+			}
+			if (!_sei_units.empty()) {
+				nal::update(_sei_data, _sei_units);
+			}
+		}
+		_have_first_frame = true;
+	} else if (!_have_first_frame) {
 		if (_codec->id == AV_CODEC_ID_H264) {
 			uint8_t*    tmp_packet;
 			uint8_t*    tmp_header;
@@ -603,8 +1434,6 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 			bfree(tmp_packet);
 			bfree(tmp_header);
 			bfree(tmp_sei);
-		} else if (_codec->id == AV_CODEC_ID_HEVC) {
-			hevc::extract_header_sei(_packet->data, static_cast<size_t>(_packet->size), _extra_data, _sei_data);
 		} else if (_context->extradata != nullptr) {
 			_extra_data.resize(static_cast<size_t>(_context->extradata_size));
 			std::memcpy(_extra_data.data(), _context->extradata, static_cast<size_t>(_context->extradata_size));
@@ -617,13 +1446,18 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 	//if (_handler)
 	//	_handler->process_avpacket(_packet, _codec, _context);
 
+	telemetry_packet(_packet.get());
+
 	// Build packet for use in OBS.
-	packet->type     = OBS_ENCODER_VIDEO;
+	packet->type     = (_codec->type == AVMEDIA_TYPE_AUDIO) ? OBS_ENCODER_AUDIO : OBS_ENCODER_VIDEO;
 	packet->pts      = _packet->pts;
 	packet->dts      = _packet->dts;
 	packet->data     = _packet->data;
 	packet->size     = static_cast<size_t>(_packet->size);
 	packet->keyframe = !!(_packet->flags & AV_PKT_FLAG_KEY);
+	if (packet->keyframe && _scenecut) {
+		_scenecut->reset();
+	}
 	*received_packet = true;
 
 	// Figure out priority and drop_priority.
@@ -633,8 +1467,10 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 	for (size_t idx = 0, edx = static_cast<size_t>(_packet->side_data_elems); idx < edx; idx++) {
 		auto& side_data = _packet->side_data[idx];
 		if (side_data.type == AV_PKT_DATA_NEW_EXTRADATA) {
-			_extra_data.resize(side_data.size);
-			std::memcpy(_extra_data.data(), side_data.data, side_data.size);
+			// Only replace the cached extra data if it actually changed.
+			if ((_extra_data.size() != side_data.size) || (std::memcmp(_extra_data.data(), side_data.data, side_data.size) != 0)) {
+				_extra_data.assign(side_data.data, side_data.data + side_data.size);
+			}
 		} else if (side_data.type == AV_PKT_DATA_QUALITY_STATS) {
 			// Decisions based on picture type, if present.
 			switch (side_data.data[sizeof(uint32_t)]) {
@@ -674,11 +1510,6 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 			}
 		}
 	}
-
-	// Push free frame back into pool.
-	push_free_frame(pop_used_frame());
-
-	return res;
 }
 
 int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
@@ -689,6 +1520,7 @@ int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
 		res       = avcodec_send_frame(_context, frame.get());
 	}
 	if (res == 0) {
+		telemetry_send(frame->pts);
 		push_used_frame(frame);
 	}
 
@@ -697,6 +1529,15 @@ int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
 
 bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_packet* packet, bool* received_packet)
 {
+	apply_regions_of_interest(frame);
+	telemetry_submit(frame->pts);
+
+	if (_pipeline) {
+		return encode_avframe_pipelined(frame, packet, received_packet);
+	} else if (!_parallel.empty()) {
+		return encode_avframe_parallel(frame, packet, received_packet);
+	}
+
 	bool sent_frame  = false;
 	bool recv_packet = false;
 	bool should_lag  = (_sent_frames >= _lag_in_frames);
@@ -719,16 +1560,19 @@ bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_pac
 				// Why can't we queue on both? Do I really have to implement threading for this stuff?
 				if (*received_packet == true) {
 					DLOG_WARNING("Skipped frame due to EAGAIN when a packet was already returned.");
+					telemetry_drop(frame->pts);
 					sent_frame = true;
 				}
 				eagain_is_stupid = true;
 				break;
 			case AVERROR(EOF):
 				DLOG_ERROR("Skipped frame due to end of stream.");
+				telemetry_drop(frame->pts);
 				sent_frame = true;
 				break;
 			default:
 				DLOG_ERROR("Failed to encode frame: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+				telemetry_drop(frame->pts);
 				return false;
 			}
 		}
@@ -763,12 +1607,434 @@ bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_pac
 		}
 	}
 
-	if (!sent_frame)
+	if (!sent_frame) {
+		telemetry_drop(frame->pts);
 		push_free_frame(frame);
+	}
+
+	return true;
+}
+
+bool ffmpeg_instance::is_unchanged_frame(struct encoder_frame* frame)
+{
+	AVPixelFormat             format = _upload ? _context->sw_pix_fmt : _scaler.get_source_format();
+	const AVPixFmtDescriptor* desc   = av_pix_fmt_desc_get(format);
+	if (!desc) {
+		return false;
+	}
+
+	// Only hash the visible bytes of each row, the padding may contain anything.
+	uint64_t hash = 0;
+	for (int plane = 0, planes = av_pix_fmt_count_planes(format); plane < planes; plane++) {
+		int bytes = av_image_get_linesize(format, _context->width, plane);
+		int rows  = _context->height;
+		if ((plane == 1) || (plane == 2)) {
+			rows = AV_CEIL_RSHIFT(rows, desc->log2_chroma_h);
+		}
+		if ((bytes <= 0) || !frame->data[plane]) {
+			return false;
+		}
+
+		hash = ::streamfx::util::hash::plane(frame->data[plane], frame->linesize[plane], static_cast<size_t>(bytes), static_cast<size_t>(rows), hash);
+	}
+
+	bool unchanged = _skip_valid && (hash == _skip_hash) && (_skip_frames < _skip_limit);
+	if (unchanged) {
+		_skip_frames++;
+	} else {
+		_skip_frames = 0;
+	}
+	_skip_valid = true;
+	_skip_hash  = hash;
+	return unchanged;
+}
+
+bool ffmpeg_instance::skip_frame(struct encoder_packet* packet, bool* received_packet)
+{
+	if (_pipeline) {
+		// Collect whatever the pipeline finished, without giving it new work.
+		return encode_avframe_pipelined(nullptr, packet, received_packet);
+	} else if (!_parallel.empty()) {
+		return encode_avframe_parallel(nullptr, packet, received_packet);
+	}
+
+	// The encoder may still hold frames, so keep collecting packets as if a frame had been sent.
+	int res = receive_packet(received_packet, packet);
+	if ((res == 0) || (res == AVERROR(EAGAIN)) || (res == AVERROR_EOF)) {
+		return true;
+	}
+
+	DLOG_ERROR("Failed to receive packet: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+	return false;
+}
+
+bool ffmpeg_instance::encode_avframe_pipelined(std::shared_ptr<AVFrame> frame, encoder_packet* packet, bool* received_packet)
+{
+	std::shared_ptr<AVPacket> ready;
+	{
+		std::unique_lock<std::mutex> lock(_pipeline_lock);
+
+		if (frame) {
+			// Only wait if the pipeline thread is hopelessly behind, so that memory usage stays bounded.
+			_pipeline_cv.wait(lock, [this]() { return _pipeline_frames.size() < pipeline_depth; });
+			_pipeline_frames.push(frame);
+			_sent_frames++;
+		}
+
+		if (!_pipeline_packets.empty()) {
+			ready = _pipeline_packets.front();
+			_pipeline_packets.pop();
+			_pipeline_delivered++;
+		}
+
+		_lag_in_frames = _sent_frames - _pipeline_delivered;
+	}
+	_pipeline_cv.notify_all();
+
+	if (ready) {
+		// Keep the packet alive in _packet until the next call, as OBS expects.
+		av_packet_unref(_packet.get());
+		av_packet_move_ref(_packet.get(), ready.get());
+		_packet_pool.push(ready);
+		process_packet(received_packet, packet);
+	}
+
+	return true;
+}
+
+void ffmpeg_instance::pipeline_main()
+{
+	// Frames currently held by the encoder, only ever touched by this thread.
+	std::queue<std::shared_ptr<AVFrame>> used_frames;
+
+	std::unique_lock<std::mutex> lock(_pipeline_lock);
+	while (true) {
+		_pipeline_cv.wait(lock, [this]() { return _pipeline_stop || !_pipeline_frames.empty(); });
+		if (_pipeline_frames.empty()) {
+			break;
+		}
+
+		auto frame = _pipeline_frames.front();
+		_pipeline_frames.pop();
+		lock.unlock();
+		_pipeline_cv.notify_all();
+
+		while (true) {
+			int res = 0;
+			{
+				auto gctx = streamfx::obs::gs::context();
+				res       = avcodec_send_frame(_context, frame.get());
+			}
+			if (res == 0) {
+				telemetry_send(frame->pts);
+				used_frames.push(frame);
+				pipeline_drain(used_frames);
+				break;
+			} else if (res == AVERROR(EAGAIN)) {
+				// The encoder wants packets taken out first.
+				std::size_t before = used_frames.size();
+				pipeline_drain(used_frames);
+				if (used_frames.size() == before) {
+					DLOG_ERROR("Both send and recieve returned EAGAIN, encoder is broken.");
+					telemetry_drop(frame->pts);
+					push_free_frame(frame);
+					break;
+				}
+			} else {
+				DLOG_ERROR("Failed to encode frame: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+				telemetry_drop(frame->pts);
+				push_free_frame(frame);
+				break;
+			}
+		}
+
+		lock.lock();
+	}
+	lock.unlock();
+
+	// Flush encoders that require it, nobody is left to pick up the packets.
+	if ((_codec->capabilities & AV_CODEC_CAP_DELAY) != 0) {
+		auto gctx = streamfx::obs::gs::context();
+		avcodec_send_frame(_context, nullptr);
+		while (avcodec_receive_packet(_context, _packet.get()) >= 0) {
+			av_packet_unref(_packet.get());
+		}
+	}
+}
+
+void ffmpeg_instance::pipeline_drain(std::queue<std::shared_ptr<AVFrame>>& used_frames)
+{
+	while (true) {
+		std::shared_ptr<AVPacket> pkt = _packet_pool.pop();
+
+		int res = 0;
+		{
+			auto gctx = streamfx::obs::gs::context();
+			res       = avcodec_receive_packet(_context, pkt.get());
+		}
+		if (res != 0) {
+			if ((res != AVERROR(EAGAIN)) && (res != AVERROR(EOF))) {
+				DLOG_ERROR("Failed to receive packet: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+			}
+			_packet_pool.push(pkt);
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(_pipeline_lock);
+			_pipeline_packets.push(pkt);
+		}
+
+		// Same as the synchronous path, a packet out means a frame is no longer needed.
+		if (!used_frames.empty()) {
+			push_free_frame(used_frames.front());
+			used_frames.pop();
+		}
+	}
+}
+
+bool ffmpeg_instance::encode_avframe_parallel(std::shared_ptr<AVFrame> frame, encoder_packet* packet, bool* received_packet)
+{
+	std::shared_ptr<parallel_lane> schedule;
+	std::shared_ptr<AVPacket>      ready;
+	{
+		std::unique_lock<std::mutex> lock(_parallel_lock);
+
+		if (frame) {
+			// Frames go to the contexts in turn, so each one encodes every N-th frame.
+			auto lane      = _parallel[_parallel_next];
+			_parallel_next = (_parallel_next + 1) % _parallel.size();
+
+			// Only wait if the context is hopelessly behind, so that memory usage stays bounded.
+			_parallel_cv.wait(lock, [&lane]() { return lane->frames.size() < parallel_depth; });
+			lane->frames.push(frame);
+			_parallel_order.push_back(frame->pts);
+			_sent_frames++;
+
+			if (!lane->busy) {
+				lane->busy = true;
+				schedule   = lane;
+			}
+		}
+
+		// Hand out packets in the order their frames came in, skipping frames that failed to encode.
+		while (!_parallel_order.empty()) {
+			auto iter = _parallel_done.find(_parallel_order.front());
+			if (iter == _parallel_done.end()) {
+				break;
+			}
+
+			ready = iter->second;
+			_parallel_done.erase(iter);
+			_parallel_order.pop_front();
+			if (ready) {
+				break;
+			}
+		}
+
+		_lag_in_frames = _parallel_order.size();
+	}
+
+	if (schedule) {
+		streamfx::threadpool()->push<&ffmpeg_instance::parallel_main>(this, schedule, ::streamfx::util::threadpool::priority::REALTIME);
+	}
+
+	if (ready) {
+		// Keep the packet alive in _packet until the next call, as OBS expects.
+		av_packet_unref(_packet.get());
+		av_packet_move_ref(_packet.get(), ready.get());
+		_packet_pool.push(ready);
+		process_packet(received_packet, packet);
+	}
 
 	return true;
 }
 
+void ffmpeg_instance::parallel_main(::streamfx::util::threadpool::task_data_t data)
+{
+	auto lane = std::static_pointer_cast<parallel_lane>(data);
+
+	std::unique_lock<std::mutex> lock(_parallel_lock);
+	while (!lane->frames.empty()) {
+		auto frame = lane->frames.front();
+		lane->frames.pop();
+		_parallel_cv.notify_all();
+		lock.unlock();
+
+		// No graphics context here, these encoders never touch the GPU and would otherwise run one at a time.
+		int64_t pts = frame->pts;
+		int     res = avcodec_send_frame(lane->context, frame.get());
+		if (res == AVERROR(EAGAIN)) {
+			// The encoder wants packets taken out first.
+			parallel_drain(*lane);
+			res = avcodec_send_frame(lane->context, frame.get());
+		}
+		if (res == 0) {
+			telemetry_send(pts);
+			lane->used.push(frame);
+			parallel_drain(*lane);
+		} else {
+			DLOG_ERROR("Failed to encode frame: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+			telemetry_drop(pts);
+			push_free_frame(frame);
+
+			// Let the frames after this one through.
+			std::unique_lock<std::mutex> dlock(_parallel_lock);
+			_parallel_done.emplace(pts, nullptr);
+		}
+
+		lock.lock();
+	}
+
+	lane->busy = false;
+	_parallel_cv.notify_all();
+}
+
+void ffmpeg_instance::parallel_drain(parallel_lane& lane)
+{
+	while (true) {
+		std::shared_ptr<AVPacket> pkt = _packet_pool.pop();
+
+		int res = avcodec_receive_packet(lane.context, pkt.get());
+		if (res != 0) {
+			if ((res != AVERROR(EAGAIN)) && (res != AVERROR(EOF))) {
+				DLOG_ERROR("Failed to receive packet: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
+			}
+			_packet_pool.push(pkt);
+			return;
+		}
+
+		{
+			// Intra-only packets keep the timestamp of their frame, which is all the reordering needs.
+			std::unique_lock<std::mutex> lock(_parallel_lock);
+			_parallel_done.emplace(pkt->pts, pkt);
+		}
+
+		if (!lane.used.empty()) {
+			push_free_frame(lane.used.front());
+			lane.used.pop();
+		}
+	}
+}
+
+void ffmpeg_instance::telemetry_capture()
+{
+#ifdef ENABLE_PROFILING
+	// OBS calls the encoder from a single thread, so the frame being captured is always the next one submitted.
+	_profile_captured = std::chrono::steady_clock::now();
+#endif
+}
+
+void ffmpeg_instance::telemetry_submit(int64_t pts)
+{
+#ifdef ENABLE_PROFILING
+	auto now = std::chrono::steady_clock::now();
+	_profile_prepare->track(now - _profile_captured);
+
+	std::unique_lock<std::mutex> lock(_profile_lock);
+	if (_profile_submitted.size() >= telemetry_max_submitted) {
+		_profile_submitted.erase(_profile_submitted.begin());
+	}
+	_profile_submitted[pts] = telemetry_stamps{_profile_captured, now, now};
+#endif
+}
+
+void ffmpeg_instance::telemetry_send(int64_t pts)
+{
+#ifdef ENABLE_PROFILING
+	auto now = std::chrono::steady_clock::now();
+
+	std::unique_lock<std::mutex> lock(_profile_lock);
+	if (auto iter = _profile_submitted.find(pts); iter != _profile_submitted.end()) {
+		iter->second.sent = now;
+		_profile_queue->track(now - iter->second.prepared);
+	}
+#endif
+}
+
+void ffmpeg_instance::telemetry_drop(int64_t pts)
+{
+#ifdef ENABLE_PROFILING
+	_profile_dropped.fetch_add(1, std::memory_order_relaxed);
+
+	std::unique_lock<std::mutex> lock(_profile_lock);
+	_profile_submitted.erase(pts);
+#endif
+}
+
+void ffmpeg_instance::telemetry_packet(AVPacket* packet)
+{
+#ifdef ENABLE_PROFILING
+	_profile_bytes.fetch_add(static_cast<uint64_t>(packet->size), std::memory_order_relaxed);
+	{
+		// Packets keep the timestamp of their frame, even when reordered.
+		std::unique_lock<std::mutex> lock(_profile_lock);
+		if (auto iter = _profile_submitted.find(packet->pts); iter != _profile_submitted.end()) {
+			auto now = std::chrono::steady_clock::now();
+			_profile_latency->track(now - iter->second.captured);
+			_profile_encode->track(now - iter->second.sent);
+			_profile_submitted.erase(iter);
+		}
+	}
+
+	if ((std::chrono::steady_clock::now() - _profile_reported) >= telemetry_interval) {
+		telemetry_report();
+	}
+#endif
+}
+
+#ifdef ENABLE_PROFILING
+ffmpeg_instance::telemetry_info ffmpeg_instance::telemetry()
+{
+	telemetry_info info;
+	if (const char* name = obs_encoder_get_name(_self); name) {
+		info.name = name;
+	}
+	info.codec   = _codec->name;
+	info.latency = _profile_latency;
+	info.convert = _profile_convert;
+	info.copy    = _profile_copy;
+	info.prepare = _profile_prepare;
+	info.queue   = _profile_queue;
+	info.encode  = _profile_encode;
+	{
+		std::unique_lock<std::mutex> lock(_profile_lock);
+		info.queue_depth = _profile_submitted.size();
+	}
+	info.dropped = _profile_dropped.load(std::memory_order_relaxed);
+	info.bytes   = _profile_bytes.load(std::memory_order_relaxed);
+	return info;
+}
+
+std::vector<ffmpeg_instance::telemetry_info> ffmpeg_instance::telemetry_all()
+{
+	auto&                       reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.lock);
+
+	std::vector<telemetry_info> result;
+	result.reserve(reg.instances.size());
+	for (auto instance : reg.instances) {
+		result.push_back(instance->telemetry());
+	}
+	return result;
+}
+
+void ffmpeg_instance::telemetry_report()
+{
+	auto   now     = std::chrono::steady_clock::now();
+	auto   info    = telemetry();
+	double seconds = std::chrono::duration<double>(now - _profile_reported).count();
+	double kbits   = static_cast<double>(info.bytes - _profile_reported_bytes) * 8. / 1000. / seconds;
+
+	_profile_reported       = now;
+	_profile_reported_bytes = info.bytes;
+
+	auto ms = [](std::chrono::nanoseconds v) { return static_cast<double>(v.count()) / 1000000.; };
+	DLOG_INFO("[%s] Latency: %.2fms/%.2fms/%.2fms (50th/95th/99th), Queue: %zu frames, Dropped: %" PRIu64 " frames, Bitrate: %.0f kbit/s, Conversion: %.2fms, Copy: %.2fms", info.codec.c_str(), ms(info.latency->percentile(.50)), ms(info.latency->percentile(.95)), ms(info.latency->percentile(.99)), info.queue_depth, info.dropped, kbits, info.convert->average_duration() / 1000000., info.copy->average_duration() / 1000000.);
+	DLOG_INFO("[%s] Stages (50th/99th): Prepare %.2fms/%.2fms, Queue %.2fms/%.2fms, Encode %.2fms/%.2fms", info.codec.c_str(), ms(info.prepare->percentile(.50)), ms(info.prepare->percentile(.99)), ms(info.queue->percentile(.50)), ms(info.queue->percentile(.99)), ms(info.encode->percentile(.50)), ms(info.encode->percentile(.99)));
+}
+#endif
+
 bool ffmpeg_instance::is_hardware_encode()
 {
 	return _hwinst != nullptr;
@@ -946,8 +2212,8 @@ ffmpeg_factory::ffmpeg_factory(ffmpeg_manager* manager, const AVCodec* codec) :
 		if (_handler->is_hardware(this)) {
 			_info.caps |= OBS_ENCODER_CAP_PASS_TEXTURE;
 		}
-	} else {
-		// If there are no handlers, default to mark it deprecated.
+	} else if (_avcodec->type != AVMediaType::AVMEDIA_TYPE_AUDIO) {
+		// If there are no handlers, default to mark it deprecated. Audio encoders get by without one.
 		_info.caps |= OBS_ENCODER_CAP_DEPRECATED;
 	}
 
@@ -1000,7 +2266,17 @@ void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 		// FFmpeg
 		obs_data_set_default_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS, "");
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_THREADS, 0);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_THREADS_ADAPTIVE, false);
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_GPU, -1);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_BALANCE, false);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_REGIONSOFINTEREST, 0);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_UPLOAD, false);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_PIPELINE, false);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_PARALLEL, 0);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_SKIPUNCHANGED, false);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_SCENECUT, 0);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_SCALETHREADS, 1);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_BITRATE, 160);
 	}
 }
 
@@ -1079,12 +2355,64 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 			auto p = obs_properties_add_text(grp, ST_KEY_FFMPEG_CUSTOMSETTINGS, D_TRANSLATE(ST_I18N_FFMPEG_CUSTOMSETTINGS), obs_text_type::OBS_TEXT_DEFAULT);
 		}
 
+		if (_avcodec->type == AVMediaType::AVMEDIA_TYPE_AUDIO) {
+			{ // Bitrate
+				auto p = obs_properties_add_int(grp, ST_KEY_FFMPEG_BITRATE, D_TRANSLATE(ST_I18N_FFMPEG_BITRATE), 0, 10000, 1);
+				obs_property_int_set_suffix(p, " kbit/s");
+			}
+			{ // Pipelined Encoding
+				auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_PIPELINE, D_TRANSLATE(ST_I18N_FFMPEG_PIPELINE));
+			}
+
+			// Everything else is about video.
+			return props;
+		}
+
 		if (_handler && _handler->is_hardware(this)) {
 			auto p = obs_properties_add_int(grp, ST_KEY_FFMPEG_GPU, D_TRANSLATE(ST_I18N_FFMPEG_GPU), -1, std::numeric_limits<uint8_t>::max(), 1);
 		}
 
+		if (_handler && _handler->is_hardware(this)) {
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_BALANCE, D_TRANSLATE(ST_I18N_FFMPEG_BALANCE));
+		}
+
+		{ // Regions of Interest
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_REGIONSOFINTEREST, D_TRANSLATE(ST_I18N_FFMPEG_REGIONSOFINTEREST), 0, 100, 1);
+			obs_property_int_set_suffix(p, " %");
+		}
+
+		if (avcodec_get_hw_config(_avcodec, 0) != nullptr) {
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_UPLOAD, D_TRANSLATE(ST_I18N_FFMPEG_UPLOAD));
+		}
+
+		{ // Pipelined Encoding
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_PIPELINE, D_TRANSLATE(ST_I18N_FFMPEG_PIPELINE));
+		}
+
+		if (const AVCodecDescriptor* desc = avcodec_descriptor_get(_avcodec->id); desc && (desc->props & AV_CODEC_PROP_INTRA_ONLY) && !(_handler && _handler->is_hardware(this))) { // Parallel Encoding
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_PARALLEL, D_TRANSLATE(ST_I18N_FFMPEG_PARALLEL), 0, static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
+		}
+
+		{ // Unchanged Frame Skipping
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_SKIPUNCHANGED, D_TRANSLATE(ST_I18N_FFMPEG_SKIPUNCHANGED));
+		}
+
+		if (_handler && _handler->has_keyframes(this)) { // Scene Cut Detection
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_SCENECUT, D_TRANSLATE(ST_I18N_FFMPEG_SCENECUT), 0, 100, 1);
+			obs_property_int_set_suffix(p, " %");
+		}
+
 		if (_handler && _handler->has_threading(this)) {
-			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_THREADS, D_TRANSLATE(ST_I18N_FFMPEG_THREADS), 0, static_cast<int64_t>(std::thread::hardware_concurrency()) * 2, 1);
+			{
+				auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_THREADS, D_TRANSLATE(ST_I18N_FFMPEG_THREADS), 0, static_cast<int64_t>(std::thread::hardware_concurrency()) * 2, 1);
+			}
+			{
+				auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_THREADS_ADAPTIVE, D_TRANSLATE(ST_I18N_FFMPEG_THREADS_ADAPTIVE));
+			}
+		}
+
+		{ // Color Conversion Threads
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_SCALETHREADS, D_TRANSLATE(ST_I18N_FFMPEG_SCALETHREADS), 1, static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
 		}
 
 		{ // Frame Skipping
@@ -1112,7 +2440,9 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 bool ffmpeg_factory::on_manual_open(obs_properties_t* props, obs_property_t* property, void* data)
 {
 	ffmpeg_factory* ptr = static_cast<ffmpeg_factory*>(data);
-	streamfx::open_url(ptr->_handler->help(ptr));
+	if (ptr->_handler) {
+		streamfx::open_url(ptr->_handler->help(ptr));
+	}
 	return false;
 }
 #endif
@@ -1127,7 +2457,7 @@ obs_encoder_info* streamfx::encoder::ffmpeg::ffmpeg_factory::get_info()
 	return &_info;
 }
 
-ffmpeg_manager::ffmpeg_manager() : _factories()
+ffmpeg_manager::ffmpeg_manager() : _capabilities(capabilities::instance()), _factories()
 {
 	// Encoders
 	void* iterator = nullptr;
@@ -1136,7 +2466,10 @@ ffmpeg_manager::ffmpeg_manager() : _factories()
 		if (!av_codec_is_encoder(codec))
 			continue;
 
-		if (codec->type == AVMediaType::AVMEDIA_TYPE_VIDEO) {
+		// Audio is only supported in formats that can be converted to without swresample.
+		bool is_video = (codec->type == AVMediaType::AVMEDIA_TYPE_VIDEO);
+		bool is_audio = (codec->type == AVMediaType::AVMEDIA_TYPE_AUDIO) && (::streamfx::ffmpeg::sample_convert::get_best_format(codec->sample_fmts) != AV_SAMPLE_FMT_NONE);
+		if (is_video || is_audio) {
 			try {
 				_factories.emplace(codec, std::make_shared<ffmpeg_factory>(this, codec));
 			} catch (const std::exception& ex) {
@@ -1144,6 +2477,9 @@ ffmpeg_manager::ffmpeg_manager() : _factories()
 			}
 		}
 	}
+
+	// Remember what the handlers probed, so that the next start is faster.
+	_capabilities->save();
 }
 
 ffmpeg_manager::~ffmpeg_manager()
@@ -1190,10 +2526,25 @@ bool ffmpeg_manager::has_handler(std::string_view codec)
 }
 
 static std::shared_ptr<ffmpeg_manager> loader_instance;
+static std::shared_ptr<capabilities>   loader_capabilities;
 
 static auto loader = streamfx::loader(
+	[]() { // Preparer
+		// Probing loads the driver libraries, so do it before the factories ask for the results.
+		loader_capabilities = capabilities::instance();
+#ifdef ENABLE_ENCODER_FFMPEG_AMF
+		amf::is_available();
+#endif
+#ifdef ENABLE_ENCODER_FFMPEG_NVENC
+		nvenc::is_available();
+#endif
+#ifdef ENABLE_ENCODER_FFMPEG_QSV
+		qsv::is_available();
+#endif
+	},
 	[]() { // Initalizer
 		loader_instance = ffmpeg_manager::instance();
+		loader_capabilities.reset();
 	},
 	[]() { // Finalizer
 		loader_instance.reset();
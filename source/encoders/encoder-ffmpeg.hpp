@@ -5,14 +5,21 @@
 
 #pragma once
 #include "common.hpp"
+#include "encoders/codecs/nal.hpp"
+#include "encoders/ffmpeg/capabilities.hpp"
 #include "encoders/ffmpeg/handler.hpp"
 #include "ffmpeg/avframe-queue.hpp"
+#include "ffmpeg/avpacket-pool.hpp"
 #include "ffmpeg/hwapi/base.hpp"
+#include "ffmpeg/scene-detector.hpp"
 #include "ffmpeg/swscale.hpp"
 #include "obs/obs-encoder-factory.hpp"
+#include "util/util-roi.hpp"
+#include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <mutex>
 #include <queue>
@@ -24,9 +31,19 @@
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
 }
 #include "warning-enable.hpp"
 
+#ifdef ENABLE_PROFILING
+#include "util/util-profiler.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <chrono>
+#include "warning-enable.hpp"
+#endif
+
 namespace streamfx::encoder::ffmpeg {
 	class ffmpeg_instance;
 	class ffmpeg_factory;
@@ -39,25 +56,90 @@ namespace streamfx::encoder::ffmpeg {
 
 		streamfx::encoder::ffmpeg::handler* _handler;
 
-		::streamfx::ffmpeg::swscale _scaler;
-		std::shared_ptr<AVPacket>   _packet;
+		::streamfx::ffmpeg::swscale       _scaler;
+		::streamfx::ffmpeg::avpacket_pool _packet_pool;
+		std::shared_ptr<AVPacket>         _packet;
 
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::base>     _hwapi;
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::instance> _hwinst;
+		bool                                                 _upload;
+		std::shared_ptr<AVBufferRef>                         _upload_device;
+		std::shared_ptr<int64_t>                             _gpu_session;
+
+		// Regions of Interest
+		int64_t                                         _roi_strength;
+		std::shared_ptr<::streamfx::util::roi::channel> _roi;
 
 		std::size_t _lag_in_frames;
 		std::size_t _sent_frames;
 		std::size_t _framerate_divisor;
 
 		// Extra Data
-		bool                 _have_first_frame;
-		std::vector<uint8_t> _extra_data;
-		std::vector<uint8_t> _sei_data;
-
-		// Frame Stack and Queue
-		std::stack<std::shared_ptr<AVFrame>>           _free_frames;
-		std::queue<std::shared_ptr<AVFrame>>           _used_frames;
-		std::chrono::high_resolution_clock::time_point _free_frames_last_used;
+		bool                                               _have_first_frame;
+		std::vector<uint8_t>                               _extra_data;
+		std::vector<uint8_t>                               _sei_data;
+		std::vector<::streamfx::encoder::codec::nal::unit> _header_units;
+		std::vector<::streamfx::encoder::codec::nal::unit> _sei_units;
+
+		// Frame Pool and Queue
+		::streamfx::ffmpeg::avframe_queue    _free_frames;
+		std::queue<std::shared_ptr<AVFrame>> _used_frames;
+
+		// Pipelined Encoding
+		bool                                  _pipeline;
+		std::thread                           _pipeline_thread;
+		std::mutex                            _pipeline_lock;
+		std::condition_variable               _pipeline_cv;
+		std::queue<std::shared_ptr<AVFrame>>  _pipeline_frames;
+		std::queue<std::shared_ptr<AVPacket>> _pipeline_packets;
+		std::size_t                           _pipeline_delivered;
+		bool                                  _pipeline_stop;
+
+		// Parallel Encoding, for codecs without dependencies between frames.
+		struct parallel_lane {
+			AVCodecContext*                      context;
+			std::queue<std::shared_ptr<AVFrame>> frames; // Waiting for this context, guarded by _parallel_lock.
+			std::queue<std::shared_ptr<AVFrame>> used;   // Held by the context, only touched by the task working on it.
+			bool                                 busy;   // A task is working on this context, guarded by _parallel_lock.
+		};
+		std::vector<std::shared_ptr<parallel_lane>>  _parallel;
+		std::size_t                                  _parallel_next;
+		std::mutex                                   _parallel_lock;
+		std::condition_variable                      _parallel_cv;
+		std::deque<int64_t>                          _parallel_order;
+		std::map<int64_t, std::shared_ptr<AVPacket>> _parallel_done;
+
+		// Unchanged Frame Skipping
+		bool        _skip;
+		bool        _skip_valid;
+		uint64_t    _skip_hash;
+		std::size_t _skip_frames;
+		std::size_t _skip_limit;
+
+		// Scene Cut Detection
+		std::shared_ptr<::streamfx::ffmpeg::scene_detector> _scenecut;
+
+#ifdef ENABLE_PROFILING
+		// Telemetry
+		struct telemetry_stamps {
+			std::chrono::steady_clock::time_point captured; // Handed to us by OBS.
+			std::chrono::steady_clock::time_point prepared; // Copied or converted into a pooled frame.
+			std::chrono::steady_clock::time_point sent;     // Accepted by the codec.
+		};
+		std::shared_ptr<::streamfx::util::profiler> _profile_latency;
+		std::shared_ptr<::streamfx::util::profiler> _profile_convert;
+		std::shared_ptr<::streamfx::util::profiler> _profile_copy;
+		std::shared_ptr<::streamfx::util::profiler> _profile_prepare;
+		std::shared_ptr<::streamfx::util::profiler> _profile_queue;
+		std::shared_ptr<::streamfx::util::profiler> _profile_encode;
+		std::mutex                                  _profile_lock;
+		std::map<int64_t, telemetry_stamps>         _profile_submitted;
+		std::chrono::steady_clock::time_point       _profile_captured;
+		std::atomic<uint64_t>                       _profile_dropped;
+		std::atomic<uint64_t>                       _profile_bytes;
+		std::chrono::steady_clock::time_point       _profile_reported;
+		uint64_t                                    _profile_reported_bytes;
+#endif
 
 		public:
 		ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw);
@@ -80,11 +162,28 @@ namespace streamfx::encoder::ffmpeg {
 
 		bool get_sei_data(uint8_t** sei_data, size_t* size) override;
 
+		size_t get_frame_size() override;
+
+		void get_audio_info(struct audio_convert_info* info) override;
+
 		void get_video_info(struct video_scale_info* info) override;
 
 		public:
+		void initialize_audio(obs_data_t* settings);
 		void initialize_sw(obs_data_t* settings);
 		void initialize_hw(obs_data_t* settings);
+		bool initialize_upload(obs_data_t* settings, AVPixelFormat format);
+		void initialize_frames();
+		void initialize_threading();
+		void initialize_parallel(obs_data_t* settings);
+
+		static std::shared_ptr<AVBufferRef> acquire_hwdevice(AVHWDeviceType type, std::string const& name);
+
+		static std::shared_ptr<int64_t> acquire_balanced_gpu();
+
+		int64_t get_gpu(obs_data_t* settings);
+
+		void apply_regions_of_interest(std::shared_ptr<AVFrame> frame);
 
 		void                     push_free_frame(std::shared_ptr<AVFrame> frame);
 		std::shared_ptr<AVFrame> pop_free_frame();
@@ -94,10 +193,65 @@ namespace streamfx::encoder::ffmpeg {
 
 		int receive_packet(bool* received_packet, struct encoder_packet* packet);
 
+		void process_packet(bool* received_packet, struct encoder_packet* packet);
+
 		int send_frame(std::shared_ptr<AVFrame> frame);
 
 		bool encode_avframe(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
 
+		bool is_unchanged_frame(struct encoder_frame* frame);
+
+		bool skip_frame(struct encoder_packet* packet, bool* received_packet);
+
+		private:
+		bool encode_avframe_pipelined(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
+
+		void pipeline_main();
+
+		void pipeline_drain(std::queue<std::shared_ptr<AVFrame>>& used_frames);
+
+		bool encode_avframe_parallel(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
+
+		void parallel_main(::streamfx::util::threadpool::task_data_t data);
+
+		void parallel_drain(parallel_lane& lane);
+
+		void telemetry_capture();
+		void telemetry_submit(int64_t pts);
+		void telemetry_send(int64_t pts);
+		void telemetry_drop(int64_t pts);
+		void telemetry_packet(AVPacket* packet);
+
+#ifdef ENABLE_PROFILING
+		public /* Telemetry */:
+		struct telemetry_info {
+			std::string                                 name;
+			std::string                                 codec;
+			std::shared_ptr<::streamfx::util::profiler> latency; // Frame captured to packet received.
+			std::shared_ptr<::streamfx::util::profiler> convert; // Color conversion in software.
+			std::shared_ptr<::streamfx::util::profiler> copy;    // Transfer into hardware frames.
+			std::shared_ptr<::streamfx::util::profiler> prepare; // Frame captured to frame prepared, covers copy or convert.
+			std::shared_ptr<::streamfx::util::profiler> queue;   // Frame prepared to frame accepted by the codec.
+			std::shared_ptr<::streamfx::util::profiler> encode;  // Frame accepted by the codec to packet received.
+			std::size_t                                 queue_depth;
+			uint64_t                                    dropped;
+			uint64_t                                    bytes;
+		};
+
+		telemetry_info telemetry();
+
+		/** Take a snapshot of every live FFmpeg encoder.
+		 *
+		 * The profilers are shared, so the returned data remains valid after the encoder is gone.
+		 */
+		static std::vector<telemetry_info> telemetry_all();
+
+		private:
+		void telemetry_report();
+#endif
+
+		public:
+
 		public: // Handler API
 		bool is_hardware_encode();
 
@@ -140,6 +294,7 @@ namespace streamfx::encoder::ffmpeg {
 	};
 
 	class ffmpeg_manager {
+		std::shared_ptr<capabilities>                             _capabilities;
 		std::map<const AVCodec*, std::shared_ptr<ffmpeg_factory>> _factories;
 
 		public:
@@ -3,13 +3,10 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 // Copyright (C) 2020-2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
 
-//--------------------------------------------------------------------------------//
-// THIS FEATURE IS DEPRECATED. SUBMITTED PATCHES WILL BE REJECTED.
-//--------------------------------------------------------------------------------//
-
 #include "amf.hpp"
 #include "common.hpp"
 #include "strings.hpp"
+#include "encoders/codecs/av1.hpp"
 #include "encoders/codecs/h264.hpp"
 #include "encoders/codecs/hevc.hpp"
 #include "encoders/encoder-ffmpeg.hpp"
@@ -24,7 +21,6 @@ extern "C" {
 
 // Translation
 #define ST_I18N "Encoder.FFmpeg.AMF"
-#define ST_I18N_DEPRECATED ST_I18N ".Deprecated"
 #define ST_I18N_PRESET ST_I18N ".Preset"
 #define ST_I18N_PRESET_(x) ST_I18N_PRESET "." x
 #define ST_I18N_RATECONTROL "Encoder.FFmpeg.AMF.RateControl"
@@ -41,6 +37,17 @@ extern "C" {
 #define ST_I18N_RATECONTROL_QP_I ST_I18N_RATECONTROL_QP ".I"
 #define ST_I18N_RATECONTROL_QP_P ST_I18N_RATECONTROL_QP ".P"
 #define ST_I18N_RATECONTROL_QP_B ST_I18N_RATECONTROL_QP ".B"
+#define ST_I18N_PREANALYSIS ST_I18N ".PreAnalysis"
+#define ST_I18N_PREANALYSIS_DEPTH ST_I18N_PREANALYSIS ".Depth"
+#define ST_I18N_PREANALYSIS_SCENECHANGE ST_I18N_PREANALYSIS ".SceneChange"
+#define ST_I18N_PREANALYSIS_SCENECHANGE_SENSITIVITY ST_I18N_PREANALYSIS_SCENECHANGE ".Sensitivity"
+#define ST_I18N_PREANALYSIS_STATICSCENE ST_I18N_PREANALYSIS ".StaticScene"
+#define ST_I18N_PREANALYSIS_ACTIVITY ST_I18N_PREANALYSIS ".Activity"
+#define ST_I18N_PREANALYSIS_ACTIVITY_(x) ST_I18N_PREANALYSIS_ACTIVITY "." x
+#define ST_I18N_PREANALYSIS_CAQ ST_I18N_PREANALYSIS ".CAQ"
+#define ST_I18N_PREANALYSIS_TAQ ST_I18N_PREANALYSIS ".TAQ"
+#define ST_I18N_PREANALYSIS_TAQ_(x) ST_I18N_PREANALYSIS_TAQ "." x
+#define ST_I18N_PREANALYSIS_LEVEL_(x) ST_I18N_PREANALYSIS ".Level." x
 #define ST_I18N_OTHER ST_I18N ".Other"
 #define ST_I18N_OTHER_BFRAMES ST_I18N_OTHER ".BFrames"
 #define ST_I18N_OTHER_BFRAMEREFERENCES ST_I18N_OTHER ".BFrameReferences"
@@ -48,6 +55,7 @@ extern "C" {
 #define ST_I18N_OTHER_ENFORCEHRD ST_I18N_OTHER ".EnforceHRD"
 #define ST_I18N_OTHER_VBAQ ST_I18N_OTHER ".VBAQ"
 #define ST_I18N_OTHER_ACCESSUNITDELIMITER ST_I18N_OTHER ".AccessUnitDelimiter"
+#define ST_I18N_OTHER_ASYNCDEPTH ST_I18N_OTHER ".AsyncDepth"
 
 // Settings
 #define ST_KEY_PRESET "Preset"
@@ -60,12 +68,20 @@ extern "C" {
 #define ST_KEY_RATECONTROL_QP_I "RateControl.QP.I"
 #define ST_KEY_RATECONTROL_QP_P "RateControl.QP.P"
 #define ST_KEY_RATECONTROL_QP_B "RateControl.QP.B"
+#define ST_KEY_PREANALYSIS_DEPTH "PreAnalysis.Depth"
+#define ST_KEY_PREANALYSIS_SCENECHANGE "PreAnalysis.SceneChange"
+#define ST_KEY_PREANALYSIS_SCENECHANGE_SENSITIVITY "PreAnalysis.SceneChange.Sensitivity"
+#define ST_KEY_PREANALYSIS_STATICSCENE "PreAnalysis.StaticScene"
+#define ST_KEY_PREANALYSIS_ACTIVITY "PreAnalysis.Activity"
+#define ST_KEY_PREANALYSIS_CAQ "PreAnalysis.CAQ"
+#define ST_KEY_PREANALYSIS_TAQ "PreAnalysis.TAQ"
 #define ST_KEY_OTHER_BFRAMES "Other.BFrames"
 #define ST_KEY_OTHER_BFRAMEREFERENCES "Other.BFrameReferences"
 #define ST_KEY_OTHER_REFERENCEFRAMES "Other.ReferenceFrames"
 #define ST_KEY_OTHER_ENFORCEHRD "Other.EnforceHRD"
 #define ST_KEY_OTHER_VBAQ "Other.VBAQ"
 #define ST_KEY_OTHER_ACCESSUNITDELIMITER "Other.AccessUnitDelimiter"
+#define ST_KEY_OTHER_ASYNCDEPTH "Other.AsyncDepth"
 
 // Settings
 #define ST_KEY_H264_PROFILE "H264.Profile"
@@ -76,6 +92,10 @@ extern "C" {
 #define ST_KEY_HEVC_TIER "H265.Tier"
 #define ST_KEY_HEVC_LEVEL "H265.Level"
 
+// Settings
+#define ST_KEY_AV1_PROFILE "AV1.Profile"
+#define ST_KEY_AV1_LEVEL "AV1.Level"
+
 using namespace streamfx::encoder::ffmpeg;
 using namespace streamfx::encoder::codec;
 
@@ -105,6 +125,24 @@ std::map<amf::ratecontrolmode, std::string> amf::ratecontrolmode_to_opt{
 	{amf::ratecontrolmode::VBR_LATENCY, "vbr_latency"},
 };
 
+// Shared by the scene change sensitivity and the CAQ strength.
+static std::map<int64_t, std::pair<std::string, std::string>> preanalysis_levels{
+	{0, {ST_I18N_PREANALYSIS_LEVEL_("Low"), "low"}},
+	{1, {ST_I18N_PREANALYSIS_LEVEL_("Medium"), "medium"}},
+	{2, {ST_I18N_PREANALYSIS_LEVEL_("High"), "high"}},
+};
+
+static std::map<int64_t, std::pair<std::string, std::string>> preanalysis_activities{
+	{0, {ST_I18N_PREANALYSIS_ACTIVITY_("Luma"), "y"}},
+	{1, {ST_I18N_PREANALYSIS_ACTIVITY_("LumaChroma"), "yuv"}},
+};
+
+static std::map<int64_t, std::pair<std::string, std::string>> preanalysis_taq_modes{
+	{0, {S_STATE_DISABLED, "none"}},
+	{1, {ST_I18N_PREANALYSIS_TAQ_("Mode1"), "1"}},
+	{2, {ST_I18N_PREANALYSIS_TAQ_("Mode2"), "2"}},
+};
+
 static std::map<h264::profile, std::string> h264_profiles{
 	{h264::profile::CONSTRAINED_BASELINE, "constrained_baseline"},
 	{h264::profile::MAIN, "main"},
@@ -128,6 +166,14 @@ static std::map<hevc::level, std::string> hevc_levels{
 	{hevc::level::L1_0, "1.0"}, {hevc::level::L2_0, "2.0"}, {hevc::level::L2_1, "2.1"}, {hevc::level::L3_0, "3.0"}, {hevc::level::L3_1, "3.1"}, {hevc::level::L4_0, "4.0"}, {hevc::level::L4_1, "4.1"}, {hevc::level::L5_0, "5.0"}, {hevc::level::L5_1, "5.1"}, {hevc::level::L5_2, "5.2"}, {hevc::level::L6_0, "6.0"}, {hevc::level::L6_1, "6.1"}, {hevc::level::L6_2, "6.2"},
 };
 
+static std::map<av1::profile, std::string> av1_profiles{
+	{av1::profile::MAIN, "main"},
+};
+
+static std::map<av1::level, std::string> av1_levels{
+	{av1::level::L2_0, "2.0"}, {av1::level::L2_1, "2.1"}, {av1::level::L2_2, "2.2"}, {av1::level::L2_3, "2.3"}, {av1::level::L3_0, "3.0"}, {av1::level::L3_1, "3.1"}, {av1::level::L3_2, "3.2"}, {av1::level::L3_3, "3.3"}, {av1::level::L4_0, "4.0"}, {av1::level::L4_1, "4.1"}, {av1::level::L4_2, "4.2"}, {av1::level::L4_3, "4.3"}, {av1::level::L5_0, "5.0"}, {av1::level::L5_1, "5.1"}, {av1::level::L5_2, "5.2"}, {av1::level::L5_3, "5.3"}, {av1::level::L6_0, "6.0"}, {av1::level::L6_1, "6.1"}, {av1::level::L6_2, "6.2"}, {av1::level::L6_3, "6.3"}, {av1::level::L7_0, "7.0"}, {av1::level::L7_1, "7.1"}, {av1::level::L7_2, "7.2"}, {av1::level::L7_3, "7.3"},
+};
+
 bool streamfx::encoder::ffmpeg::amf::is_available()
 {
 #if defined(D_PLATFORM_WINDOWS)
@@ -143,12 +189,14 @@ bool streamfx::encoder::ffmpeg::amf::is_available()
 	std::filesystem::path lib_name = std::filesystem::u8path("libamfrt32.so.1");
 #endif
 #endif
-	try {
-		streamfx::util::library::load(lib_name);
-		return true;
-	} catch (...) {
-		return false;
-	}
+	return capabilities::instance()->probe(lib_name.u8string(), [&lib_name]() {
+		try {
+			streamfx::util::library::load(lib_name);
+			return true;
+		} catch (...) {
+			return false;
+		}
+	});
 }
 
 void amf::defaults(ffmpeg_factory* factory, obs_data_t* settings)
@@ -167,12 +215,21 @@ void amf::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_QP_P, -1);
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_QP_B, -1);
 
+	obs_data_set_default_int(settings, ST_KEY_PREANALYSIS_DEPTH, -1);
+	obs_data_set_default_int(settings, ST_KEY_PREANALYSIS_SCENECHANGE, -1);
+	obs_data_set_default_int(settings, ST_KEY_PREANALYSIS_SCENECHANGE_SENSITIVITY, -1);
+	obs_data_set_default_int(settings, ST_KEY_PREANALYSIS_STATICSCENE, -1);
+	obs_data_set_default_int(settings, ST_KEY_PREANALYSIS_ACTIVITY, -1);
+	obs_data_set_default_int(settings, ST_KEY_PREANALYSIS_CAQ, -1);
+	obs_data_set_default_int(settings, ST_KEY_PREANALYSIS_TAQ, -1);
+
 	obs_data_set_default_int(settings, ST_KEY_OTHER_BFRAMES, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_BFRAMEREFERENCES, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_REFERENCEFRAMES, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_ENFORCEHRD, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_VBAQ, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_ACCESSUNITDELIMITER, -1);
+	obs_data_set_default_int(settings, ST_KEY_OTHER_ASYNCDEPTH, -1);
 
 	// Replay Buffer
 	obs_data_set_default_int(settings, "bitrate", 0);
@@ -213,14 +270,32 @@ static bool modified_ratecontrol(obs_properties_t* props, obs_property_t*, obs_d
 	return true;
 }
 
-void amf::properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+static bool modified_lookahead(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
 {
-	{
-		auto p = obs_properties_add_text(props, "[[deprecated]]", D_TRANSLATE(ST_I18N_DEPRECATED), OBS_TEXT_INFO);
-		obs_property_text_set_info_type(p, OBS_TEXT_INFO_WARNING);
-		obs_property_text_set_info_word_wrap(p, true);
+	// Pre-Analysis options do nothing unless Pre-Analysis itself runs.
+	bool have_preanalysis = !streamfx::util::is_tristate_disabled(obs_data_get_int(settings, ST_KEY_RATECONTROL_LOOKAHEAD));
+	obs_property_set_visible(obs_properties_get(props, ST_I18N_PREANALYSIS), have_preanalysis);
+	return true;
+}
+
+static void add_preanalysis_list(obs_properties_t* props, const char* key, const char* name, std::map<int64_t, std::pair<std::string, std::string>> const& values)
+{
+	auto p = obs_properties_add_list(props, key, D_TRANSLATE(name), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(p, D_TRANSLATE(S_STATE_DEFAULT), -1);
+	for (auto const& kv : values) {
+		obs_property_list_add_int(p, D_TRANSLATE(kv.second.first.c_str()), kv.first);
+	}
+}
+
+static void set_preanalysis_list(void* priv_data, obs_data_t* settings, const char* key, const char* option, std::map<int64_t, std::pair<std::string, std::string>> const& values)
+{
+	if (auto found = values.find(obs_data_get_int(settings, key)); found != values.end()) {
+		av_opt_set(priv_data, option, found->second.second.c_str(), AV_OPT_SEARCH_CHILDREN);
 	}
+}
 
+void amf::properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
 	auto p = obs_properties_add_list(props, ST_KEY_PRESET, D_TRANSLATE(ST_I18N_PRESET), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
 	for (auto kv : presets) {
 		obs_property_list_add_int(p, D_TRANSLATE(kv.second.c_str()), static_cast<int64_t>(kv.first));
@@ -243,10 +318,29 @@ void amf::properties_after(ffmpeg_factory* factory, ffmpeg_instance* instance, o
 			}
 		}
 
-		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_RATECONTROL_LOOKAHEAD, D_TRANSLATE(ST_I18N_RATECONTROL_LOOKAHEAD));
+		{
+			auto p = streamfx::util::obs_properties_add_tristate(grp, ST_KEY_RATECONTROL_LOOKAHEAD, D_TRANSLATE(ST_I18N_RATECONTROL_LOOKAHEAD));
+			obs_property_set_modified_callback(p, modified_lookahead);
+		}
 		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_RATECONTROL_FRAMESKIPPING, D_TRANSLATE(ST_I18N_RATECONTROL_FRAMESKIPPING));
 	}
 
+	{ // Pre-Analysis
+		obs_properties_t* grp = obs_properties_create();
+		obs_properties_add_group(props, ST_I18N_PREANALYSIS, D_TRANSLATE(ST_I18N_PREANALYSIS), OBS_GROUP_NORMAL, grp);
+
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_PREANALYSIS_DEPTH, D_TRANSLATE(ST_I18N_PREANALYSIS_DEPTH), -1, 41, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
+		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_PREANALYSIS_SCENECHANGE, D_TRANSLATE(ST_I18N_PREANALYSIS_SCENECHANGE));
+		add_preanalysis_list(grp, ST_KEY_PREANALYSIS_SCENECHANGE_SENSITIVITY, ST_I18N_PREANALYSIS_SCENECHANGE_SENSITIVITY, preanalysis_levels);
+		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_PREANALYSIS_STATICSCENE, D_TRANSLATE(ST_I18N_PREANALYSIS_STATICSCENE));
+		add_preanalysis_list(grp, ST_KEY_PREANALYSIS_ACTIVITY, ST_I18N_PREANALYSIS_ACTIVITY, preanalysis_activities);
+		add_preanalysis_list(grp, ST_KEY_PREANALYSIS_CAQ, ST_I18N_PREANALYSIS_CAQ, preanalysis_levels);
+		add_preanalysis_list(grp, ST_KEY_PREANALYSIS_TAQ, ST_I18N_PREANALYSIS_TAQ, preanalysis_taq_modes);
+	}
+
 	{
 		obs_properties_t* grp = obs_properties_create();
 		obs_properties_add_group(props, ST_I18N_RATECONTROL_LIMITS, D_TRANSLATE(ST_I18N_RATECONTROL_LIMITS), OBS_GROUP_NORMAL, grp);
@@ -296,6 +390,10 @@ void amf::properties_after(ffmpeg_factory* factory, ffmpeg_instance* instance, o
 		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_OTHER_ENFORCEHRD, D_TRANSLATE(ST_I18N_OTHER_ENFORCEHRD));
 		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_OTHER_VBAQ, D_TRANSLATE(ST_I18N_OTHER_VBAQ));
 		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_OTHER_ACCESSUNITDELIMITER, D_TRANSLATE(ST_I18N_OTHER_ACCESSUNITDELIMITER));
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_ASYNCDEPTH, D_TRANSLATE(ST_I18N_OTHER_ASYNCDEPTH), -1, 16, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
 	}
 }
 
@@ -360,6 +458,24 @@ void amf::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 			av_opt_set_int(context->priv_data, "preanalysis", la, AV_OPT_SEARCH_CHILDREN);
 		}
 
+		// Pre-Analysis
+		if (!streamfx::util::is_tristate_disabled(obs_data_get_int(settings, ST_KEY_RATECONTROL_LOOKAHEAD))) {
+			if (int64_t v = obs_data_get_int(settings, ST_KEY_PREANALYSIS_DEPTH); v > -1) {
+				// A buffer deeper than a single frame is what turns this into an actual look-ahead.
+				av_opt_set_int(context->priv_data, "pa_lookahead_buffer_depth", v, AV_OPT_SEARCH_CHILDREN);
+			}
+			if (int64_t v = obs_data_get_int(settings, ST_KEY_PREANALYSIS_SCENECHANGE); !streamfx::util::is_tristate_default(v)) {
+				av_opt_set_int(context->priv_data, "pa_scene_change_detection_enable", v, AV_OPT_SEARCH_CHILDREN);
+			}
+			set_preanalysis_list(context->priv_data, settings, ST_KEY_PREANALYSIS_SCENECHANGE_SENSITIVITY, "pa_scene_change_detection_sensitivity", preanalysis_levels);
+			if (int64_t v = obs_data_get_int(settings, ST_KEY_PREANALYSIS_STATICSCENE); !streamfx::util::is_tristate_default(v)) {
+				av_opt_set_int(context->priv_data, "pa_static_scene_detection_enable", v, AV_OPT_SEARCH_CHILDREN);
+			}
+			set_preanalysis_list(context->priv_data, settings, ST_KEY_PREANALYSIS_ACTIVITY, "pa_activity_type", preanalysis_activities);
+			set_preanalysis_list(context->priv_data, settings, ST_KEY_PREANALYSIS_CAQ, "pa_caq_strength", preanalysis_levels);
+			set_preanalysis_list(context->priv_data, settings, ST_KEY_PREANALYSIS_TAQ, "pa_taq_mode", preanalysis_taq_modes);
+		}
+
 		// Frame Skipping (Drop frames to maintain bitrate limits)
 		if (int la = static_cast<int>(obs_data_get_int(settings, ST_KEY_RATECONTROL_FRAMESKIPPING)); !streamfx::util::is_tristate_default(la)) {
 			if (std::string_view("amf_h264") == codec->name) {
@@ -378,7 +494,7 @@ void amf::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 				// Support for Replay Buffer
 				obs_data_set_int(settings, "bitrate", v);
 			} else {
-				obs_data_set_int(settings, "bitrate", context->bit_rate);
+				obs_data_set_int(settings, "bitrate", context->bit_rate / 1000);
 			}
 		} else {
 			context->bit_rate = 0;
@@ -433,19 +549,45 @@ void amf::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 		}
 
 		if (int64_t v = obs_data_get_int(settings, ST_KEY_OTHER_VBAQ); !streamfx::util::is_tristate_default(v)) {
-			av_opt_set_int(context->priv_data, "vbaq", v, AV_OPT_SEARCH_CHILDREN);
+			if (std::string_view("av1_amf") == codec->name) {
+				// AV1 calls it content adaptive quantization instead.
+				av_opt_set(context->priv_data, "aq_mode", streamfx::util::is_tristate_enabled(v) ? "caq" : "none", AV_OPT_SEARCH_CHILDREN);
+			} else {
+				av_opt_set_int(context->priv_data, "vbaq", v, AV_OPT_SEARCH_CHILDREN);
+			}
 		}
 
 		if (int64_t v = obs_data_get_int(settings, ST_KEY_OTHER_ACCESSUNITDELIMITER); !streamfx::util::is_tristate_default(v)) {
 			av_opt_set_int(context->priv_data, "aud", v, AV_OPT_SEARCH_CHILDREN);
 		}
 
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_OTHER_ASYNCDEPTH); v > -1) {
+			av_opt_set_int(context->priv_data, "async_depth", v, AV_OPT_SEARCH_CHILDREN);
+		}
+
 		av_opt_set_int(context->priv_data, "me_half_pel", 1, AV_OPT_SEARCH_CHILDREN);
 		av_opt_set_int(context->priv_data, "me_quarter_pel", 1, AV_OPT_SEARCH_CHILDREN);
 	}
 }
 
-void amf::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) {}
+void amf::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	AVCodecContext* context = const_cast<AVCodecContext*>(instance->get_avcodeccontext());
+
+	// The submission queue is fixed once the encoder is open.
+	if (context->internal) {
+		return;
+	}
+
+	int64_t async_depth = 0;
+	int64_t pa_depth    = 0;
+	av_opt_get_int(context, "async_depth", AV_OPT_SEARCH_CHILDREN, &async_depth);
+	av_opt_get_int(context, "pa_lookahead_buffer_depth", AV_OPT_SEARCH_CHILDREN, &pa_depth);
+
+	// AMF holds on to every submitted surface until its packet comes out, so the frame pool has to cover all of
+	// them plus whatever is sitting in the pre-analysis buffer.
+	context->delay = static_cast<int>(std::max<int64_t>(async_depth, 1ll) + std::max<int64_t>(pa_depth, 0ll) + std::max<int64_t>(context->max_b_frames, 0ll));
+}
 
 void amf::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
 {
@@ -459,6 +601,13 @@ void amf::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* se
 	tools::print_av_option_string2(context, "quality", "    Preset", [](int64_t v, std::string_view o) { return std::string(o); });
 	tools::print_av_option_string2(context, "rc", "    Rate Control", [](int64_t v, std::string_view o) { return std::string(o); });
 	tools::print_av_option_bool(context, "preanalysis", "      Look-Ahead");
+	tools::print_av_option_int(context, "pa_lookahead_buffer_depth", "        Depth", "Frames");
+	tools::print_av_option_bool(context, "pa_scene_change_detection_enable", "        Scene Change Detection");
+	tools::print_av_option_string2(context, "pa_scene_change_detection_sensitivity", "          Sensitivity", [](int64_t v, std::string_view o) { return std::string(o); });
+	tools::print_av_option_bool(context, "pa_static_scene_detection_enable", "        Static Scene Detection");
+	tools::print_av_option_string2(context, "pa_activity_type", "        Activity Type", [](int64_t v, std::string_view o) { return std::string(o); });
+	tools::print_av_option_string2(context, "pa_caq_strength", "        CAQ Strength", [](int64_t v, std::string_view o) { return std::string(o); });
+	tools::print_av_option_string2(context, "pa_taq_mode", "        TAQ Mode", [](int64_t v, std::string_view o) { return std::string(o); });
 	if (std::string_view("amf_h264") == codec->name) {
 		tools::print_av_option_bool(context, "frame_skipping", "      Frame Skipping");
 	} else {
@@ -485,11 +634,17 @@ void amf::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* se
 	DLOG_INFO("[%s]     Other:", codec->name);
 	tools::print_av_option_int(context, "refs", "      Reference Frames", "Frames");
 	tools::print_av_option_bool(context, "enforce_hrd", "      Enforce HRD");
-	tools::print_av_option_bool(context, "vbaq", "      VBAQ");
+	if (std::string_view("av1_amf") == codec->name) {
+		tools::print_av_option_string2(context, "aq_mode", "      Adaptive Quantization", [](int64_t v, std::string_view o) { return std::string(o); });
+	} else {
+		tools::print_av_option_bool(context, "vbaq", "      VBAQ");
+	}
 	tools::print_av_option_bool(context, "aud", "      Access Unit Delimiter");
 	tools::print_av_option_int(context, "max_au_size", "        Maximum Size", "");
 	tools::print_av_option_bool(context, "me_half_pel", "      Half-Pel Motion Estimation");
 	tools::print_av_option_bool(context, "me_quarter_pel", "      Quarter-Pel Motion Estimation");
+	tools::print_av_option_int(context, "async_depth", "      Asynchronous Depth", "Frames");
+	DLOG_INFO("[%s]       Delay: %d frames", codec->name, context->delay);
 }
 
 // H264 Handler
@@ -519,7 +674,6 @@ void streamfx::encoder::ffmpeg::amf_h264::adjust_info(ffmpeg_factory* factory, s
 	name = "AMD AMF H.264/AVC (via FFmpeg)";
 	if (!amf::is_available())
 		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
-	factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
 }
 
 void amf_h264::defaults(ffmpeg_factory* factory, obs_data_t* settings)
@@ -652,7 +806,6 @@ void streamfx::encoder::ffmpeg::amf_hevc::adjust_info(ffmpeg_factory* factory, s
 	name = "AMD AMF H.265/HEVC (via FFmpeg)";
 	if (!amf::is_available())
 		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
-	factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
 }
 
 void amf_hevc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
@@ -767,3 +920,128 @@ void amf_hevc::get_runtime_properties(ffmpeg_factory* factory, ffmpeg_instance*
 }
 
 static auto inst_hevc = amf_hevc();
+
+// AV1 Handler
+//-------------------
+
+amf_av1::amf_av1() : handler("av1_amf") {}
+
+amf_av1::~amf_av1(){};
+
+bool amf_av1::has_keyframes(ffmpeg_factory* instance)
+{
+	return true;
+}
+
+bool amf_av1::is_hardware(ffmpeg_factory* instance)
+{
+	return true;
+}
+
+bool amf_av1::has_threading(ffmpeg_factory* instance)
+{
+	return false;
+}
+
+void streamfx::encoder::ffmpeg::amf_av1::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
+{
+	name = "AMD AMF AV1 (via FFmpeg)";
+	if (!amf::is_available())
+		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
+}
+
+void amf_av1::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	amf::defaults(factory, settings);
+
+	obs_data_set_default_int(settings, ST_KEY_AV1_PROFILE, static_cast<int64_t>(av1::profile::MAIN));
+	obs_data_set_default_int(settings, ST_KEY_AV1_LEVEL, static_cast<int64_t>(av1::level::UNKNOWN));
+}
+
+void amf_av1::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	if (!instance) {
+		this->get_encoder_properties(factory, instance, props);
+	} else {
+		this->get_runtime_properties(factory, instance, props);
+	}
+}
+
+void amf_av1::migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version)
+{
+	amf::migrate(factory, instance, settings, version);
+}
+
+void amf_av1::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	auto codec   = factory->get_avcodec();
+	auto context = instance->get_avcodeccontext();
+
+	amf::update(factory, instance, settings);
+
+	{ // AV1 Options
+		auto found = av1_profiles.find(static_cast<av1::profile>(obs_data_get_int(settings, ST_KEY_AV1_PROFILE)));
+		if (found != av1_profiles.end()) {
+			av_opt_set(context->priv_data, "profile", found->second.c_str(), 0);
+		}
+	}
+	{
+		auto found = av1_levels.find(static_cast<av1::level>(obs_data_get_int(settings, ST_KEY_AV1_LEVEL)));
+		if (found != av1_levels.end()) {
+			av_opt_set(context->priv_data, "level", found->second.c_str(), 0);
+		} else {
+			av_opt_set(context->priv_data, "level", "auto", 0);
+		}
+	}
+}
+
+void amf_av1::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	amf::override_update(factory, instance, settings);
+}
+
+void amf_av1::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	auto codec   = factory->get_avcodec();
+	auto context = instance->get_avcodeccontext();
+
+	amf::log(factory, instance, settings);
+
+	DLOG_INFO("[%s]     AV1:", codec->name);
+	::streamfx::ffmpeg::tools::print_av_option_string2(context, "profile", "      Profile", [](int64_t v, std::string_view o) { return std::string(o); });
+	::streamfx::ffmpeg::tools::print_av_option_string2(context, "level", "      Level", [](int64_t v, std::string_view o) { return std::string(o); });
+}
+
+void amf_av1::get_encoder_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	amf::properties_before(factory, instance, props);
+
+	{
+		obs_properties_t* grp = obs_properties_create();
+		obs_properties_add_group(props, S_CODEC_AV1, D_TRANSLATE(S_CODEC_AV1), OBS_GROUP_NORMAL, grp);
+
+		{
+			auto p = obs_properties_add_list(grp, ST_KEY_AV1_PROFILE, D_TRANSLATE(S_CODEC_AV1_PROFILE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_DEFAULT), static_cast<int64_t>(av1::profile::UNKNOWN));
+			for (auto const kv : av1_profiles) {
+				obs_property_list_add_int(p, av1::profile_to_string(kv.first), static_cast<int64_t>(kv.first));
+			}
+		}
+		{
+			auto p = obs_properties_add_list(grp, ST_KEY_AV1_LEVEL, D_TRANSLATE(S_CODEC_AV1_LEVEL), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(av1::level::UNKNOWN));
+			for (auto const kv : av1_levels) {
+				obs_property_list_add_int(p, kv.second.c_str(), static_cast<int64_t>(kv.first));
+			}
+		}
+	}
+
+	amf::properties_after(factory, instance, props);
+}
+
+void amf_av1::get_runtime_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	amf::properties_runtime(factory, instance, props);
+}
+
+static auto inst_av1 = amf_av1();
@@ -3,8 +3,6 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 // Copyright (C) 2020-2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
 
-// THIS FEATURE IS DEPRECATED. SUBMITTED PATCHES WILL BE REJECTED.
-
 #pragma once
 #include "encoders/encoder-ffmpeg.hpp"
 #include "encoders/ffmpeg/handler.hpp"
@@ -161,4 +159,32 @@ namespace streamfx::encoder::ffmpeg {
 		void get_encoder_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
 		void get_runtime_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
 	};
+
+	class amf_av1 : public handler {
+		public:
+		amf_av1();
+		virtual ~amf_av1();
+
+		bool has_keyframes(ffmpeg_factory* instance) override;
+		bool is_hardware(ffmpeg_factory* instance) override;
+		bool has_threading(ffmpeg_factory* instance) override;
+
+		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
+
+		std::string help(ffmpeg_factory* factory) override
+		{
+			return "https://github.com/Xaymar/obs-StreamFX/wiki/Encoder-FFmpeg-AMF";
+		};
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+
+		private:
+		void get_encoder_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
+		void get_runtime_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
+	};
 } // namespace streamfx::encoder::ffmpeg
@@ -0,0 +1,130 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "capabilities.hpp"
+#include "obs/obs-tools.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <sstream>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+#include "warning-enable.hpp"
+}
+
+constexpr std::string_view cache_file_name  = "encoder-ffmpeg-capabilities.json";
+constexpr std::string_view cache_backup_ext = ".bk";
+constexpr std::string_view key_signature    = "Signature";
+constexpr std::string_view key_results      = "Results";
+
+streamfx::encoder::ffmpeg::capabilities::~capabilities()
+{
+	save();
+}
+
+streamfx::encoder::ffmpeg::capabilities::capabilities() : _lock(), _path(), _data(), _results(), _changed(false)
+{
+	_path = streamfx::config_file_path(cache_file_name);
+
+	// Only trust the cache if it was written by the same FFmpeg and StreamFX.
+	std::string sig = signature();
+	if (std::filesystem::exists(_path) && std::filesystem::is_regular_file(_path)) {
+		if (obs_data_t* data = obs_data_create_from_json_file_safe(_path.u8string().c_str(), cache_backup_ext.data()); data) {
+			_data = std::shared_ptr<obs_data_t>(data, obs::obs_data_deleter);
+		}
+	}
+	if (!_data || (sig != obs_data_get_string(_data.get(), key_signature.data()))) {
+		_data    = std::shared_ptr<obs_data_t>(obs_data_create(), obs::obs_data_deleter);
+		_changed = true;
+		obs_data_set_string(_data.get(), key_signature.data(), sig.c_str());
+	}
+
+	std::shared_ptr<obs_data_t> results{obs_data_get_obj(_data.get(), key_results.data()), obs::obs_data_deleter};
+	if (results) {
+		for (obs_data_item_t* item = obs_data_first(results.get()); item; obs_data_item_next(&item)) {
+			if (obs_data_item_gettype(item) == OBS_DATA_BOOLEAN) {
+				_results.emplace(obs_data_item_get_name(item), obs_data_item_get_bool(item));
+			}
+		}
+	}
+}
+
+bool streamfx::encoder::ffmpeg::capabilities::probe(std::string_view name, std::function<bool()> probe)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	std::string key{name};
+	if (auto kv = _results.find(key); kv != _results.end()) {
+		return kv->second;
+	}
+
+	// Probing may load libraries, which can take a while. Nothing else should probe the same thing at the same time.
+	bool result = probe();
+	_results.emplace(key, result);
+	if (result) {
+		_changed = true;
+	}
+	return result;
+}
+
+void streamfx::encoder::ffmpeg::capabilities::invalidate()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	_results.clear();
+	_changed = true;
+}
+
+void streamfx::encoder::ffmpeg::capabilities::save()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	if (!_changed) {
+		return;
+	}
+
+	// Failed probes are intentionally not stored, see header.
+	std::shared_ptr<obs_data_t> results{obs_data_create(), obs::obs_data_deleter};
+	for (auto const& kv : _results) {
+		if (kv.second) {
+			obs_data_set_bool(results.get(), kv.first.c_str(), true);
+		}
+	}
+	obs_data_set_obj(_data.get(), key_results.data(), results.get());
+
+	try {
+		if (_path.has_parent_path()) {
+			std::filesystem::create_directories(_path.parent_path());
+		}
+		if (!obs_data_save_json_safe(_data.get(), _path.u8string().c_str(), ".tmp", cache_backup_ext.data())) {
+			DLOG_WARNING("Failed to save FFmpeg encoder capabilities.");
+		}
+	} catch (std::exception const& ex) {
+		DLOG_WARNING("Failed to save FFmpeg encoder capabilities: %s", ex.what());
+	}
+	_changed = false;
+}
+
+std::string streamfx::encoder::ffmpeg::capabilities::signature()
+{
+	std::stringstream sstr;
+	sstr << "StreamFX " << STREAMFX_VERSION << ", libavcodec " << avcodec_version() << ", libavutil " << avutil_version();
+	return sstr.str();
+}
+
+std::shared_ptr<streamfx::encoder::ffmpeg::capabilities> streamfx::encoder::ffmpeg::capabilities::instance()
+{
+	static std::weak_ptr<capabilities> winst;
+	static std::mutex                  mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<capabilities>(new capabilities());
+		winst    = instance;
+	}
+	return instance;
+}
@@ -0,0 +1,59 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "warning-enable.hpp"
+
+namespace streamfx::encoder::ffmpeg {
+	/** Remembers the result of expensive capability probes, such as loading a driver library.
+	 *
+	 * Results are kept in memory for the lifetime of the process. Successful probes are also written to disk, keyed
+	 * by the FFmpeg and StreamFX version, so that the next start can skip them. Failed probes are never written to
+	 * disk, so that newly installed drivers show up on the next start.
+	 */
+	class capabilities {
+		std::mutex                  _lock;
+		std::filesystem::path       _path;
+		std::shared_ptr<obs_data_t> _data;
+		std::map<std::string, bool> _results;
+		bool                        _changed;
+
+		public:
+		~capabilities();
+
+		private:
+		capabilities();
+
+		public:
+		/** Run a probe, unless its result is already known.
+		 *
+		 * @param name Unique name of the probe, for example the driver library it loads.
+		 */
+		bool probe(std::string_view name, std::function<bool()> probe);
+
+		/** Forget every cached result, for example after a hardware encoder unexpectedly failed to start.
+		 */
+		void invalidate();
+
+		/** Write changed results to disk.
+		 */
+		void save();
+
+		private:
+		static std::string signature();
+
+		public: // Singleton
+		static std::shared_ptr<capabilities> instance();
+	};
+} // namespace streamfx::encoder::ffmpeg
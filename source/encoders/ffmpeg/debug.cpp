@@ -9,6 +9,12 @@
 #include "../encoder-ffmpeg.hpp"
 #include "handler.hpp"
 #include "plugin.hpp"
+#include "strings.hpp"
+
+#ifdef ENABLE_PROFILING
+#include "ffmpeg/tools.hpp"
+#include "util/util-profiler.hpp"
+#endif
 
 #include "warning-disable.hpp"
 #include <map>
@@ -18,6 +24,19 @@
 extern "C" {
 #include <libavutil/opt.h>
 }
+#ifdef ENABLE_PROFILING
+#include <ctime>
+#include <fstream>
+#include <thread>
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <sys/resource.h>
+#endif
+#endif
 #include "warning-enable.hpp"
 
 template<typename T>
@@ -163,3 +182,172 @@ void debug::properties(ffmpeg_instance* instance, obs_properties_t* props)
 }
 
 static debug handler();
+
+#ifdef ENABLE_PROFILING
+// Generated sequences cycle through this many different frames.
+constexpr std::size_t benchmark_unique_frames = 8;
+
+static std::chrono::nanoseconds process_cpu_time()
+{
+#ifdef WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+		return std::chrono::nanoseconds(0);
+	}
+	uint64_t ticks = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime) + (static_cast<uint64_t>(user.dwHighDateTime) << 32 | user.dwLowDateTime);
+	return std::chrono::nanoseconds(ticks * 100);
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return std::chrono::nanoseconds(0);
+	}
+	return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#endif
+}
+
+benchmark::result benchmark::run(std::string_view id, obs_data_t* settings, std::size_t frames, std::filesystem::path const& recording)
+{
+	result res = {std::string{id}, 0, 0., std::chrono::nanoseconds(-1), std::chrono::nanoseconds(-1), std::chrono::nanoseconds(-1), 0., 0., 0.};
+
+	std::shared_ptr<obs_encoder_t> encoder{obs_video_encoder_create(res.encoder.c_str(), "StreamFX Benchmark", settings, nullptr), [](obs_encoder_t* v) { obs_encoder_release(v); }};
+	if (!encoder) {
+		throw std::runtime_error("Failed to create encoder.");
+	}
+	obs_encoder_set_video(encoder.get(), obs_get_video());
+
+	// Encoder settings as OBS would pass them, including the defaults.
+	std::shared_ptr<obs_data_t> data{obs_encoder_get_settings(encoder.get()), [](obs_data_t* v) { obs_data_release(v); }};
+
+	// Prepare the frames in the format of the OBS video output.
+	auto          voi    = video_output_get_info(obs_encoder_video(encoder.get()));
+	AVPixelFormat format = ::streamfx::ffmpeg::tools::obs_videoformat_to_avpixelformat(voi->format);
+	int32_t       width  = static_cast<int32_t>(voi->width);
+	int32_t       height = static_cast<int32_t>(voi->height);
+	int32_t       size   = av_image_get_buffer_size(format, width, height, 1);
+	if (size <= 0) {
+		throw std::runtime_error("Unsupported video format.");
+	}
+
+	std::vector<std::vector<uint8_t>> buffers;
+	if (!recording.empty()) {
+		std::ifstream file(recording, std::ios::binary);
+		while (file && (buffers.size() < frames)) {
+			std::vector<uint8_t> buffer(static_cast<size_t>(size));
+			if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
+				break;
+			}
+			buffers.push_back(std::move(buffer));
+		}
+		if (buffers.empty()) {
+			throw std::runtime_error("Recording contains no complete frame.");
+		}
+	} else {
+		// Noise on top of a moving gradient, so that neither intra nor inter prediction have it too easy.
+		uint32_t state = 0x9E3779B9;
+		for (std::size_t idx = 0; idx < benchmark_unique_frames; idx++) {
+			std::vector<uint8_t> buffer(static_cast<size_t>(size));
+			for (std::size_t pos = 0; pos < buffer.size(); pos++) {
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				buffer[pos] = static_cast<uint8_t>(((pos + idx * 16) & 0xFF) / 2 + (state & 0x3F));
+			}
+			buffers.push_back(std::move(buffer));
+		}
+	}
+
+	auto latency = ::streamfx::util::profiler::create();
+	{
+		ffmpeg_instance instance(data.get(), encoder.get(), false);
+
+		std::map<int64_t, std::chrono::high_resolution_clock::time_point> submitted;
+		auto                                                              cpu_start  = process_cpu_time();
+		auto                                                              wall_start = std::chrono::high_resolution_clock::now();
+		for (std::size_t idx = 0; idx < frames; idx++) {
+			auto& buffer = buffers[idx % buffers.size()];
+
+			uint8_t* planes[4];
+			int      linesizes[4];
+			av_image_fill_arrays(planes, linesizes, buffer.data(), format, width, height, 1);
+
+			encoder_frame frame = {};
+			for (std::size_t plane = 0; plane < 4; plane++) {
+				frame.data[plane]     = planes[plane];
+				frame.linesize[plane] = static_cast<uint32_t>(linesizes[plane]);
+			}
+			frame.pts = static_cast<int64_t>(idx);
+
+			encoder_packet packet   = {};
+			bool           received = false;
+			submitted.emplace(frame.pts, std::chrono::high_resolution_clock::now());
+			if (!instance.encode_video(&frame, &packet, &received)) {
+				throw std::runtime_error("Encoder failed to encode a frame.");
+			}
+			if (received) {
+				if (auto kv = submitted.find(packet.pts); kv != submitted.end()) {
+					latency->track(std::chrono::high_resolution_clock::now() - kv->second);
+					submitted.erase(kv);
+				}
+			}
+		}
+		auto wall = std::chrono::high_resolution_clock::now() - wall_start;
+		auto cpu  = process_cpu_time() - cpu_start;
+
+		auto   info    = instance.telemetry();
+		double seconds = std::chrono::duration<double>(wall).count();
+		res.frames     = frames;
+		res.fps        = static_cast<double>(frames) / seconds;
+		res.cpu        = std::chrono::duration<double>(cpu).count() / seconds / std::max(std::thread::hardware_concurrency(), 1u) * 100.;
+		res.convert    = info.convert->average_duration() / 1000000.;
+		res.copy       = info.copy->average_duration() / 1000000.;
+	}
+	res.latency_50 = latency->percentile(.50);
+	res.latency_95 = latency->percentile(.95);
+	res.latency_99 = latency->percentile(.99);
+
+	return res;
+}
+
+std::vector<benchmark::result> benchmark::run_all(std::size_t frames)
+{
+	std::vector<result> results;
+	for (auto const& kv : handler::handlers()) {
+		if (kv.first.empty()) {
+			continue;
+		}
+
+		std::string id = S_PREFIX + kv.first;
+		if (!obs_get_encoder_codec(id.c_str())) {
+			continue;
+		}
+
+		try {
+			auto res = run(id, nullptr, frames);
+			DLOG_INFO("[Benchmark] %s: %.2f fps, latency %.2fms/%.2fms/%.2fms (50th/95th/99th), CPU %.1f%%, conversion %.2fms, copy %.2fms", res.encoder.c_str(), res.fps, static_cast<double>(res.latency_50.count()) / 1000000., static_cast<double>(res.latency_95.count()) / 1000000., static_cast<double>(res.latency_99.count()) / 1000000., res.cpu, res.convert, res.copy);
+			results.push_back(res);
+		} catch (std::exception const& ex) {
+			DLOG_WARNING("[Benchmark] %s: %s", id.c_str(), ex.what());
+		}
+	}
+
+	// Keep a copy for comparing against other releases.
+	try {
+		std::time_t now = std::time(nullptr);
+		char        name[64];
+		std::strftime(name, sizeof(name), "benchmarks/%Y%m%d-%H%M%S.csv", std::localtime(&now));
+
+		auto path = streamfx::config_file_path(name);
+		std::filesystem::create_directories(path.parent_path());
+
+		std::ofstream file(path);
+		file << "version,encoder,frames,fps,latency_50_ms,latency_95_ms,latency_99_ms,cpu_percent,convert_ms,copy_ms\n";
+		for (auto const& res : results) {
+			file << STREAMFX_VERSION_STRING << "," << res.encoder << "," << res.frames << "," << res.fps << "," << static_cast<double>(res.latency_50.count()) / 1000000. << "," << static_cast<double>(res.latency_95.count()) / 1000000. << "," << static_cast<double>(res.latency_99.count()) / 1000000. << "," << res.cpu << "," << res.convert << "," << res.copy << "\n";
+		}
+	} catch (std::exception const& ex) {
+		DLOG_WARNING("[Benchmark] Failed to save results: %s", ex.what());
+	}
+
+	return results;
+}
+#endif
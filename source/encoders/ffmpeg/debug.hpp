@@ -5,6 +5,16 @@
 #pragma once
 #include "handler.hpp"
 
+#ifdef ENABLE_PROFILING
+#include "warning-disable.hpp"
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+#endif
+
 namespace streamfx::encoder::ffmpeg {
 	class debug : public handler {
 		public:
@@ -13,4 +23,37 @@ namespace streamfx::encoder::ffmpeg {
 
 		virtual void properties(ffmpeg_instance* instance, obs_properties_t* props);
 	};
+
+#ifdef ENABLE_PROFILING
+	namespace benchmark {
+		struct result {
+			std::string              encoder;
+			std::size_t              frames;
+			double                   fps;
+			std::chrono::nanoseconds latency_50;
+			std::chrono::nanoseconds latency_95;
+			std::chrono::nanoseconds latency_99;
+			double                   cpu;     // Percent of all cores.
+			double                   convert; // Average milliseconds of color conversion per frame.
+			double                   copy;    // Average milliseconds of copying into hardware frames per frame.
+		};
+
+		/** Push frames through an FFmpeg encoder as fast as it accepts them, without the rest of OBS.
+		 *
+		 * Frames come from 'recording' if given, which must hold raw frames in the format and size of the OBS video
+		 * output, and are otherwise generated. Frames are fed from memory, so only the encoder itself is measured.
+		 *
+		 * @param id Id of the encoder, for example "streamfx-prores_aw".
+		 * @param settings Settings to create the encoder with, or nullptr for the defaults.
+		 */
+		result run(std::string_view id, obs_data_t* settings, std::size_t frames, std::filesystem::path const& recording = {});
+
+		/** Benchmark every encoder that has a handler with its default settings.
+		 *
+		 * Results are logged and written to 'benchmarks/' in the configuration directory, so that releases can be
+		 * compared with each other.
+		 */
+		std::vector<result> run_all(std::size_t frames);
+	} // namespace benchmark
+#endif
 } // namespace streamfx::encoder::ffmpeg
@@ -7,6 +7,7 @@
 #include "nvenc.hpp"
 #include "common.hpp"
 #include "strings.hpp"
+#include "encoders/codecs/av1.hpp"
 #include "encoders/codecs/h264.hpp"
 #include "encoders/codecs/hevc.hpp"
 #include "encoders/encoder-ffmpeg.hpp"
@@ -19,6 +20,11 @@ extern "C" {
 }
 #include "warning-enable.hpp"
 
+#ifdef ENABLE_NVIDIA_CUDA
+#include "nvidia/cuda/nvidia-cuda-obs.hpp"
+#include "nvidia/cuda/nvidia-cuda.hpp"
+#endif
+
 #define ST_I18N_PRESET "Encoder.FFmpeg.NVENC.Preset"
 #define ST_I18N_PRESET_(x) ST_I18N_PRESET "." D_VSTR(x)
 #define ST_KEY_PRESET "Preset"
@@ -82,6 +88,13 @@ extern "C" {
 #define ST_KEY_OTHER_REFERENCEFRAMES "Other.ReferenceFrames"
 #define ST_I18N_OTHER_LOWDELAYKEYFRAMESCALE ST_I18N_OTHER ".LowDelayKeyFrameScale"
 #define ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE "Other.LowDelayKeyFrameScale"
+#define ST_I18N_OTHER_SPLITENCODE ST_I18N_OTHER ".SplitEncode"
+#define ST_KEY_OTHER_SPLITENCODE "Other.SplitEncode"
+#define ST_I18N_LATENCY "Encoder.FFmpeg.NVENC.Latency"
+#define ST_KEY_LATENCY "Latency"
+#define ST_I18N_LATENCY_ESTIMATE ST_I18N_LATENCY ".Estimate"
+#define ST_I18N_LATENCY_MEASURED ST_I18N_LATENCY ".Measured"
+#define ST_KEY_LATENCY_MEASURED "Latency.Measured"
 
 #define ST_KEY_H264_PROFILE "H264.Profile"
 #define ST_KEY_H264_LEVEL "H264.Level"
@@ -90,6 +103,12 @@ extern "C" {
 #define ST_KEY_H265_TIER "H265.Tier"
 #define ST_KEY_H264_LEVEL "H265.Level"
 
+#define ST_KEY_AV1_PROFILE "AV1.Profile"
+#define ST_KEY_AV1_TIER "AV1.Tier"
+#define ST_KEY_AV1_LEVEL "AV1.Level"
+#define ST_KEY_AV1_TILES_ROWS "AV1.Tiles.Rows"
+#define ST_KEY_AV1_TILES_COLUMNS "AV1.Tiles.Columns"
+
 using namespace streamfx::encoder::ffmpeg;
 using namespace streamfx::encoder::codec;
 
@@ -108,6 +127,44 @@ inline bool is_vbr(std::string_view rc)
 	return std::string_view("vbr") == rc;
 }
 
+inline bool is_split_forced(std::string_view mode)
+{
+	return (std::string_view("disabled") != mode) && (std::string_view("auto") != mode);
+}
+
+// Split-frame encoding spreads one frame over several NVENC engines, and only Ada (8.9) and newer have more than one.
+static bool has_multiple_engines(int64_t gpu)
+{
+#ifdef ENABLE_NVIDIA_CUDA
+	try {
+		namespace nvcuda = ::streamfx::nvidia::cuda;
+		auto cuda        = nvcuda::cuda::get();
+
+		nvcuda::device_t device = 0;
+		if (gpu >= 0) {
+			if (cuda->cuDeviceGet(&device, static_cast<int32_t>(gpu)) != nvcuda::result::SUCCESS) {
+				return false;
+			}
+		} else {
+			// Without an explicit GPU, NVENC encodes on the GPU that libOBS renders with.
+			device = nvcuda::obs::get()->get_context()->get_device();
+		}
+
+		int32_t major = 0;
+		int32_t minor = 0;
+		if ((cuda->cuDeviceGetAttribute(&major, nvcuda::device_attribute::COMPUTE_CAPABILITY_MAJOR, device) != nvcuda::result::SUCCESS) || (cuda->cuDeviceGetAttribute(&minor, nvcuda::device_attribute::COMPUTE_CAPABILITY_MINOR, device) != nvcuda::result::SUCCESS)) {
+			return false;
+		}
+		return (major > 8) || ((major == 8) && (minor >= 9));
+	} catch (...) {
+		return false;
+	}
+#else
+	// Let the driver decide.
+	return true;
+#endif
+}
+
 bool nvenc::is_available()
 {
 #if defined(D_PLATFORM_WINDOWS)
@@ -119,12 +176,14 @@ bool nvenc::is_available()
 #else
 	std::filesystem::path lib_name = "libnvidia-encode.so.1";
 #endif
-	try {
-		streamfx::util::library::load(lib_name);
-		return true;
-	} catch (...) {
-		return false;
-	}
+	return capabilities::instance()->probe(lib_name.u8string(), [&lib_name]() {
+		try {
+			streamfx::util::library::load(lib_name);
+			return true;
+		} catch (...) {
+			return false;
+		}
+	});
 }
 
 void nvenc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
@@ -161,6 +220,7 @@ void nvenc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 	obs_data_set_default_int(settings, ST_KEY_OTHER_NONREFERENCEPFRAMES, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_REFERENCEFRAMES, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE, -1);
+	obs_data_set_default_string(settings, ST_KEY_OTHER_SPLITENCODE, "");
 
 	// Replay Buffer
 	obs_data_set_default_int(settings, "bitrate", 0);
@@ -216,6 +276,51 @@ static bool modified_aq(obs_properties_t* props, obs_property_t*, obs_data_t* se
 	return true;
 }
 
+// Number of frames that go in before the first packet comes out.
+static int64_t estimate_delay(int64_t bframes, int64_t lookahead, bool zerolatency, int64_t async_depth)
+{
+	int64_t frames = std::max<int64_t>(lookahead, 0) + std::max<int64_t>(async_depth, 0);
+
+	// Without zero latency, every B-Frame holds back the frame that follows it.
+	if (!zerolatency) {
+		frames += std::max<int64_t>(bframes, 0);
+	}
+
+	return frames;
+}
+
+static std::string describe_delay(int64_t frames, double framerate)
+{
+	char buffer[256];
+	snprintf(buffer, sizeof(buffer), D_TRANSLATE(ST_I18N_LATENCY_ESTIMATE), static_cast<int>(frames), (framerate > 0.) ? (static_cast<double>(frames) * 1000. / framerate) : 0.);
+	return buffer;
+}
+
+static bool modified_latency(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
+{
+	int64_t bframes   = obs_data_get_int(settings, ST_KEY_OTHER_BFRAMES);
+	int64_t lookahead = obs_data_get_int(settings, ST_KEY_RATECONTROL_LOOKAHEAD);
+	bool    zerolat   = streamfx::util::is_tristate_enabled(obs_data_get_int(settings, ST_KEY_OTHER_ZEROLATENCY));
+
+	// FFmpeg waits until all but one of the surfaces override_update() allocates are in flight.
+	int64_t surfaces = 4;
+	if (lookahead > 0) {
+		surfaces = std::max<int64_t>((std::max<int64_t>(bframes, 0) + 1) * 4, lookahead + std::max<int64_t>(bframes, 0) + 5);
+	} else if (bframes > 0) {
+		surfaces = (bframes + 1) * 4;
+	}
+
+	obs_video_info ovi;
+	double         framerate = 0.;
+	if (obs_get_video_info(&ovi) && (ovi.fps_den > 0)) {
+		framerate = static_cast<double>(ovi.fps_num) / static_cast<double>(ovi.fps_den);
+	}
+
+	auto text = describe_delay(estimate_delay(bframes, lookahead, zerolat, surfaces - 1), framerate);
+	obs_property_set_description(obs_properties_get(props, ST_KEY_LATENCY), text.c_str());
+	return true;
+}
+
 void nvenc::properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context)
 {
 	auto codec = factory->get_avcodec();
@@ -281,6 +386,7 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_RATECONTROL_LOOKAHEAD, D_TRANSLATE(ST_I18N_RATECONTROL_LOOKAHEAD), -1, 32, 1);
 			obs_property_int_set_suffix(p, " frames");
 			//obs_property_set_modified_callback(p, modified_lookahead);
+			obs_property_set_modified_callback(p, modified_latency);
 		}
 
 		{
@@ -373,6 +479,7 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 		{
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_BFRAMES, D_TRANSLATE(ST_I18N_OTHER_BFRAMES), -1, 4, 1);
 			obs_property_int_set_suffix(p, " frames");
+			obs_property_set_modified_callback(p, modified_latency);
 		}
 
 		{
@@ -387,6 +494,7 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 
 		{
 			auto p = streamfx::util::obs_properties_add_tristate(grp, ST_KEY_OTHER_ZEROLATENCY, D_TRANSLATE(ST_I18N_OTHER_ZEROLATENCY));
+			obs_property_set_modified_callback(p, modified_latency);
 		}
 
 		{
@@ -405,6 +513,20 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "ldkfs")) {
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE, D_TRANSLATE(ST_I18N_OTHER_LOWDELAYKEYFRAMESCALE), -1, 255, 1);
 		}
+
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "split_encode_mode")) {
+			auto p = obs_properties_add_list(grp, ST_KEY_OTHER_SPLITENCODE, D_TRANSLATE(ST_I18N_OTHER_SPLITENCODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
+			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "split_encode_mode", [&p](const AVOption* opt) {
+				char buffer[1024];
+				snprintf(buffer, sizeof(buffer), "%s.%s", ST_I18N_OTHER_SPLITENCODE, opt->name);
+				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
+			});
+		}
+	}
+
+	{ // Filled in by modified_latency() as soon as the settings are known.
+		auto p = obs_properties_add_text(props, ST_KEY_LATENCY, D_TRANSLATE(ST_I18N_LATENCY), OBS_TEXT_INFO);
 	}
 }
 
@@ -442,6 +564,39 @@ void nvenc::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instanc
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_NONREFERENCEPFRAMES), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_REFERENCEFRAMES), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_SPLITENCODE), false);
+
+	if (!instance) {
+		return;
+	}
+
+	// The estimate for what the encoder actually ended up with, which may differ from the settings due to presets.
+	if (!obs_properties_get(props, ST_KEY_LATENCY)) {
+		AVCodecContext* context     = const_cast<AVCodecContext*>(instance->get_avcodeccontext());
+		int64_t         lookahead   = 0;
+		int64_t         zerolatency = 0;
+		int64_t         surfaces    = 0;
+		int64_t         async_depth = 0;
+		av_opt_get_int(context, "rc-lookahead", AV_OPT_SEARCH_CHILDREN, &lookahead);
+		av_opt_get_int(context, "zerolatency", AV_OPT_SEARCH_CHILDREN, &zerolatency);
+		av_opt_get_int(context, "surfaces", AV_OPT_SEARCH_CHILDREN, &surfaces);
+		av_opt_get_int(context, "delay", AV_OPT_SEARCH_CHILDREN, &async_depth);
+		async_depth = std::min<int64_t>(async_depth, std::max<int64_t>(surfaces - 1, 0));
+
+		auto text = describe_delay(estimate_delay(context->max_b_frames, lookahead, zerolatency != 0, async_depth), av_q2d(context->framerate));
+		obs_properties_add_text(props, ST_KEY_LATENCY, text.c_str(), OBS_TEXT_INFO);
+
+#ifdef ENABLE_PROFILING
+		// And what it has been measured at so far, where encode time per frame is the limit on throughput.
+		if (auto info = instance->telemetry(); info.latency->count() > 0) {
+			auto ms = [](std::chrono::nanoseconds v) { return static_cast<double>(v.count()) / 1000000.; };
+
+			char buffer[256];
+			snprintf(buffer, sizeof(buffer), D_TRANSLATE(ST_I18N_LATENCY_MEASURED), ms(info.latency->percentile(.50)), ms(info.latency->percentile(.99)), info.encode->average_duration() / 1000000.);
+			obs_properties_add_text(props, ST_KEY_LATENCY_MEASURED, buffer, OBS_TEXT_INFO);
+		}
+#endif
+	}
 }
 
 void nvenc::migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version)
@@ -621,13 +776,17 @@ void nvenc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_
 			}
 		}
 
+		// Allow OBS to specify a maximum allowed bitrate, which it also uses to adapt to the available bandwidth.
+		// obs_data_has_user_value(X, Y) is also true if obs_data_set_Z(X, Y, obs_data_get_Z(X, Y))
+		int64_t obs_bitrate = -1;
+		if (obs_data_get_int(settings, "bitrate") != obs_data_get_default_int(settings, "bitrate")) {
+			obs_bitrate = obs_data_get_int(settings, "bitrate");
+		}
+
 		if (have_bitrate) {
 			int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET);
-
-			// Allow OBS to specify a maximum allowed bitrate.
-			if (obs_data_get_int(settings, "bitrate") != obs_data_get_default_int(settings, "bitrate")) {
-				// obs_data_has_user_value(X, Y) is also true if obs_data_set_Z(X, Y, obs_data_get_Z(X, Y))
-				v = std::clamp<int64_t>(v, -1, obs_data_get_int(settings, "bitrate"));
+			if (obs_bitrate > -1) {
+				v = std::clamp<int64_t>(v, -1, obs_bitrate);
 			}
 
 			if (v > -1) {
@@ -638,6 +797,9 @@ void nvenc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_
 		}
 		if (have_bitrate_range) {
 			if (int64_t max = obs_data_get_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM); max > -1) {
+				if (obs_bitrate > -1) {
+					max = std::clamp<int64_t>(max, context->bit_rate / 1000, obs_bitrate);
+				}
 				context->rc_max_rate = static_cast<int>(max * 1000);
 			} else {
 				context->rc_max_rate = context->bit_rate;
@@ -647,8 +809,8 @@ void nvenc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_
 			context->rc_min_rate = context->bit_rate;
 			context->rc_max_rate = context->bit_rate;
 		}
-		{ // Support for OBS Studio
-			obs_data_set_int(settings, "bitrate", context->rc_max_rate);
+		{ // Support for OBS Studio, which expects kbit/s here.
+			obs_data_set_int(settings, "bitrate", context->rc_max_rate / 1000);
 		}
 
 		// Buffer Size
@@ -696,7 +858,7 @@ void nvenc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_
 		int64_t saq = obs_data_get_int(settings, ST_KEY_AQ_SPATIAL);
 		int64_t taq = obs_data_get_int(settings, ST_KEY_AQ_TEMPORAL);
 
-		if (strcmp(codec->name, "h264_nvenc") == 0) {
+		if (strcmp(codec->name, "hevc_nvenc") != 0) {
 			if (!streamfx::util::is_tristate_default(saq))
 				av_opt_set_int(context->priv_data, "spatial-aq", saq, AV_OPT_SEARCH_CHILDREN);
 			if (!streamfx::util::is_tristate_default(taq))
@@ -738,6 +900,20 @@ void nvenc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_
 		if (auto v = obs_data_get_int(settings, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE); v > -1) {
 			av_opt_set_int(context->priv_data, "ldkfs", v, AV_OPT_SEARCH_CHILDREN);
 		}
+
+		if (const char* v = obs_data_get_string(settings, ST_KEY_OTHER_SPLITENCODE); (v != nullptr) && (v[0] != '\0')) {
+			if (is_split_forced(v)) {
+				if (!has_multiple_engines(instance->get_gpu(settings))) {
+					DLOG_WARNING("[%s] Split-Frame Encoding disabled, as the GPU only has a single NVENC engine.", codec->name);
+					v = "disabled";
+				} else if (streamfx::util::is_tristate_enabled(wp)) {
+					// NVENC does not split frames while weighted prediction is enabled.
+					DLOG_WARNING("[%s] Weighted Prediction disabled because of Split-Frame Encoding being used.", codec->name);
+					av_opt_set_int(context->priv_data, "weighted_pred", 0, AV_OPT_SEARCH_CHILDREN);
+				}
+			}
+			av_opt_set(context->priv_data, "split_encode_mode", v, AV_OPT_SEARCH_CHILDREN);
+		}
 	}
 }
 
@@ -745,6 +921,11 @@ void nvenc::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance,
 {
 	AVCodecContext* context = const_cast<AVCodecContext*>(instance->get_avcodeccontext());
 
+	// Surfaces and delay are fixed once the encoder is open, only rate control changes on the fly.
+	if (context->internal) {
+		return;
+	}
+
 	int64_t rclookahead = 0;
 	int64_t surfaces    = 0;
 	int64_t async_depth = 0;
@@ -808,7 +989,7 @@ void nvenc::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 	tools::print_av_option_string2(context, "b_ref_mode", "      Reference Mode", [](int64_t v, std::string_view o) { return std::string(o); });
 
 	DLOG_INFO("[%s]     Adaptive Quantization:", codec->name);
-	if (strcmp(codec->name, "h264_nvenc") == 0) {
+	if (strcmp(codec->name, "hevc_nvenc") != 0) {
 		tools::print_av_option_bool(context, "spatial-aq", "      Spatial AQ");
 		tools::print_av_option_int(context, "aq-strength", "        Strength", "");
 		tools::print_av_option_bool(context, "temporal-aq", "      Temporal AQ");
@@ -829,6 +1010,7 @@ void nvenc::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 	tools::print_av_option_bool(context, "a53cc", "      A53 Closed Captions");
 	tools::print_av_option_int(context, "dpb_size", "      DPB Size", "Frames");
 	tools::print_av_option_int(context, "ldkfs", "      DPB Size", "Frames");
+	tools::print_av_option_string2(context, "split_encode_mode", "      Split-Frame Encoding", [](int64_t v, std::string_view o) { return std::string(o); });
 	tools::print_av_option_bool(context, "extra_sei", "      Extra SEI Data");
 	tools::print_av_option_bool(context, "udu_sei", "      User SEI Data");
 	tools::print_av_option_bool(context, "intra-refresh", "      Intra-Refresh");
@@ -1197,3 +1379,185 @@ void nvenc_hevc::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* in
 }
 
 static auto inst_hevc = nvenc_hevc();
+
+// AV1 Handler
+//-------------------
+
+nvenc_av1::nvenc_av1() : handler("av1_nvenc"){};
+
+nvenc_av1::~nvenc_av1(){};
+
+bool nvenc_av1::has_keyframes(ffmpeg_factory*)
+{
+	return true;
+}
+
+bool nvenc_av1::has_threading(ffmpeg_factory* instance)
+{
+	return false;
+}
+
+bool nvenc_av1::is_hardware(ffmpeg_factory* instance)
+{
+	return true;
+}
+
+bool nvenc_av1::is_reconfigurable(ffmpeg_factory* instance, bool& threads, bool& gpu, bool& keyframes)
+{
+	threads   = false;
+	gpu       = false;
+	keyframes = false;
+	return true;
+}
+
+void nvenc_av1::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
+{
+	name = "NVIDIA NVENC AV1 (via FFmpeg)";
+	if (!nvenc::is_available())
+		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL;
+}
+
+void nvenc_av1::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	nvenc::defaults(factory, settings);
+
+	obs_data_set_default_string(settings, ST_KEY_AV1_PROFILE, "");
+	obs_data_set_default_string(settings, ST_KEY_AV1_TIER, "");
+	obs_data_set_default_string(settings, ST_KEY_AV1_LEVEL, "auto");
+	obs_data_set_default_int(settings, ST_KEY_AV1_TILES_ROWS, -1);
+	obs_data_set_default_int(settings, ST_KEY_AV1_TILES_COLUMNS, -1);
+}
+
+void nvenc_av1::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	if (!instance) {
+		this->properties_encoder(factory, instance, props);
+	} else {
+		this->properties_runtime(factory, instance, props);
+	}
+}
+
+void nvenc_av1::migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version)
+{
+	nvenc::migrate(factory, instance, settings, version);
+}
+
+void nvenc_av1::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	auto codec   = factory->get_avcodec();
+	auto context = instance->get_avcodeccontext();
+
+	nvenc::update(factory, instance, settings);
+
+	if (!context->internal) {
+		if (const char* v = obs_data_get_string(settings, ST_KEY_AV1_PROFILE); v && (v[0] != '\0')) {
+			av_opt_set(context->priv_data, "profile", v, AV_OPT_SEARCH_CHILDREN);
+		}
+		if (const char* v = obs_data_get_string(settings, ST_KEY_AV1_TIER); v && (v[0] != '\0')) {
+			av_opt_set(context->priv_data, "tier", v, AV_OPT_SEARCH_CHILDREN);
+		}
+		if (const char* v = obs_data_get_string(settings, ST_KEY_AV1_LEVEL); v && (v[0] != '\0')) {
+			av_opt_set(context->priv_data, "level", v, AV_OPT_SEARCH_CHILDREN);
+		}
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_AV1_TILES_ROWS); v > -1) {
+			av_opt_set_int(context->priv_data, "tile-rows", v, AV_OPT_SEARCH_CHILDREN);
+		}
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_AV1_TILES_COLUMNS); v > -1) {
+			av_opt_set_int(context->priv_data, "tile-columns", v, AV_OPT_SEARCH_CHILDREN);
+		}
+	}
+}
+
+void nvenc_av1::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	nvenc::override_update(factory, instance, settings);
+}
+
+void nvenc_av1::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	auto codec   = factory->get_avcodec();
+	auto context = instance->get_avcodeccontext();
+
+	nvenc::log(factory, instance, settings);
+
+	DLOG_INFO("[%s]     AV1:", codec->name);
+	::streamfx::ffmpeg::tools::print_av_option_string2(context, "profile", "      Profile", [](int64_t v, std::string_view o) { return std::string(o); });
+	::streamfx::ffmpeg::tools::print_av_option_string2(context, "level", "      Level", [](int64_t v, std::string_view o) { return std::string(o); });
+	::streamfx::ffmpeg::tools::print_av_option_string2(context, "tier", "      Tier", [](int64_t v, std::string_view o) { return std::string(o); });
+	::streamfx::ffmpeg::tools::print_av_option_int(context, "tile-rows", "      Tile Rows", "");
+	::streamfx::ffmpeg::tools::print_av_option_int(context, "tile-columns", "      Tile Columns", "");
+}
+
+void nvenc_av1::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	auto codec = factory->get_avcodec();
+
+	AVCodecContext* context = avcodec_alloc_context3(codec);
+	if (!context->priv_data) {
+		avcodec_free_context(&context);
+		return;
+	}
+
+	nvenc::properties_before(factory, instance, props, context);
+
+	{
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, S_CODEC_AV1, D_TRANSLATE(S_CODEC_AV1), OBS_GROUP_NORMAL, grp);
+		}
+
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "profile")) {
+			auto p = obs_properties_add_list(grp, ST_KEY_AV1_PROFILE, D_TRANSLATE(S_CODEC_AV1_PROFILE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
+			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "profile", [&p](const AVOption* opt) {
+				char buffer[1024];
+				snprintf(buffer, sizeof(buffer), "%s.%s", S_CODEC_AV1_PROFILE, opt->name);
+				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
+			});
+		}
+		{
+			auto p = obs_properties_add_list(grp, ST_KEY_AV1_TIER, D_TRANSLATE(S_CODEC_AV1_TIER), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
+			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "tier", [&p](const AVOption* opt) {
+				char buffer[1024];
+				snprintf(buffer, sizeof(buffer), "%s.%s", S_CODEC_AV1_TIER, opt->name);
+				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
+			});
+		}
+		{
+			auto p = obs_properties_add_list(grp, ST_KEY_AV1_LEVEL, D_TRANSLATE(S_CODEC_AV1_LEVEL), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+
+			// The automatic level is not zero for AV1, so look for it by name.
+			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "level", [&p](const AVOption* opt) {
+				if (std::string_view("auto") == opt->name) {
+					obs_property_list_add_string(p, D_TRANSLATE(S_STATE_AUTOMATIC), "auto");
+				} else {
+					obs_property_list_add_string(p, opt->name, opt->name);
+				}
+			});
+		}
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "tile-rows")) {
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_AV1_TILES_ROWS, D_TRANSLATE(S_CODEC_AV1_TILES_ROWS), -1, 64, 1);
+		}
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "tile-columns")) {
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_AV1_TILES_COLUMNS, D_TRANSLATE(S_CODEC_AV1_TILES_COLUMNS), -1, 64, 1);
+		}
+	}
+
+	nvenc::properies_after(factory, instance, props, context);
+
+	if (context) {
+		avcodec_free_context(&context);
+	}
+}
+
+void nvenc_av1::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	nvenc::properties_runtime(factory, instance, props);
+
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_AV1_TILES_ROWS), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_AV1_TILES_COLUMNS), false);
+}
+
+static auto inst_av1 = nvenc_av1();
@@ -93,4 +93,33 @@ namespace streamfx::encoder::ffmpeg {
 		void properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
 		void properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
 	};
+
+	class nvenc_av1 : public handler {
+		public:
+		nvenc_av1();
+		virtual ~nvenc_av1();
+
+		bool has_keyframes(ffmpeg_factory* factory) override;
+		bool has_threading(ffmpeg_factory* factory) override;
+		bool is_hardware(ffmpeg_factory* factory) override;
+		bool is_reconfigurable(ffmpeg_factory* factory, bool& threads, bool& gpu, bool& keyframes) override;
+
+		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
+
+		std::string help(ffmpeg_factory* factory) override
+		{
+			return "https://github.com/Xaymar/obs-StreamFX/wiki/Encoder-FFmpeg-NVENC";
+		};
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+
+		private:
+		void properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
+		void properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
+	};
 } // namespace streamfx::encoder::ffmpeg
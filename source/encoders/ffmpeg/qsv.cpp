@@ -0,0 +1,612 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "qsv.hpp"
+#include "common.hpp"
+#include "strings.hpp"
+#include "encoders/codecs/av1.hpp"
+#include "encoders/codecs/h264.hpp"
+#include "encoders/codecs/hevc.hpp"
+#include "encoders/encoder-ffmpeg.hpp"
+#include "ffmpeg/tools.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+extern "C" {
+#include <libavutil/avutil.h>
+#include <libavutil/opt.h>
+}
+#include "warning-enable.hpp"
+
+#define ST_I18N "Encoder.FFmpeg.QSV"
+#define ST_I18N_PRESET ST_I18N ".Preset"
+#define ST_KEY_PRESET "Preset"
+#define ST_I18N_RATECONTROL ST_I18N ".RateControl"
+#define ST_I18N_RATECONTROL_MODE ST_I18N_RATECONTROL ".Mode"
+#define ST_I18N_RATECONTROL_MODE_(x) ST_I18N_RATECONTROL_MODE "." D_VSTR(x)
+#define ST_KEY_RATECONTROL_MODE "RateControl.Mode"
+#define ST_I18N_RATECONTROL_LOOKAHEAD ST_I18N_RATECONTROL ".LookAhead"
+#define ST_KEY_RATECONTROL_LOOKAHEAD "RateControl.LookAhead"
+#define ST_I18N_RATECONTROL_LIMITS ST_I18N_RATECONTROL ".Limits"
+#define ST_I18N_RATECONTROL_LIMITS_BUFFERSIZE ST_I18N_RATECONTROL_LIMITS ".BufferSize"
+#define ST_KEY_RATECONTROL_LIMITS_BUFFERSIZE "RateControl.Limits.BufferSize"
+#define ST_I18N_RATECONTROL_LIMITS_QUALITY ST_I18N_RATECONTROL_LIMITS ".Quality"
+#define ST_KEY_RATECONTROL_LIMITS_QUALITY "RateControl.Limits.Quality"
+#define ST_I18N_RATECONTROL_LIMITS_BITRATE_TARGET ST_I18N_RATECONTROL_LIMITS ".Bitrate.Target"
+#define ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET "RateControl.Limits.Bitrate.Target"
+#define ST_I18N_RATECONTROL_LIMITS_BITRATE_MAXIMUM ST_I18N_RATECONTROL_LIMITS ".Bitrate.Maximum"
+#define ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM "RateControl.Limits.Bitrate.Maximum"
+#define ST_I18N_RATECONTROL_QP ST_I18N_RATECONTROL ".QP"
+#define ST_KEY_RATECONTROL_QP "RateControl.QP"
+#define ST_I18N_OTHER ST_I18N ".Other"
+#define ST_I18N_OTHER_LOWPOWER ST_I18N_OTHER ".LowPower"
+#define ST_KEY_OTHER_LOWPOWER "Other.LowPower"
+#define ST_I18N_OTHER_BFRAMES ST_I18N_OTHER ".BFrames"
+#define ST_KEY_OTHER_BFRAMES "Other.BFrames"
+#define ST_I18N_OTHER_REFERENCEFRAMES ST_I18N_OTHER ".ReferenceFrames"
+#define ST_KEY_OTHER_REFERENCEFRAMES "Other.ReferenceFrames"
+#define ST_I18N_OTHER_ASYNCDEPTH ST_I18N_OTHER ".AsyncDepth"
+#define ST_KEY_OTHER_ASYNCDEPTH "Other.AsyncDepth"
+
+#define ST_KEY_H264_PROFILE "H264.Profile"
+#define ST_KEY_H265_PROFILE "H265.Profile"
+#define ST_KEY_AV1_PROFILE "AV1.Profile"
+
+using namespace streamfx::encoder::ffmpeg;
+using namespace streamfx::encoder::codec;
+
+// The runtime matching the GPU is picked by FFmpeg, so having either of them is enough.
+static const char* runtime_libraries[] = {
+#if defined(D_PLATFORM_WINDOWS)
+#if defined(D_PLATFORM_64BIT)
+	"libmfx64-gen.dll", // oneVPL, Tiger Lake and newer.
+	"libmfxhw64.dll",   // Media SDK, older GPUs.
+#else
+	"libmfx32-gen.dll",
+	"libmfxhw32.dll",
+#endif
+#elif defined(D_PLATFORM_LINUX)
+	"libmfx-gen.so.1.2",
+	"libmfxhw64.so.1",
+#endif
+};
+
+inline bool is_cqp(std::string_view rc)
+{
+	return std::string_view("cqp") == rc;
+}
+
+inline bool is_icq(std::string_view rc)
+{
+	return std::string_view("icq") == rc;
+}
+
+inline bool is_cbr(std::string_view rc)
+{
+	return std::string_view("cbr") == rc;
+}
+
+inline bool is_vbr(std::string_view rc)
+{
+	return std::string_view("vbr") == rc;
+}
+
+bool qsv::is_available()
+{
+	for (auto name : runtime_libraries) {
+		std::filesystem::path lib_name = std::filesystem::u8path(name);
+		if (capabilities::instance()->probe(lib_name.u8string(), [&lib_name]() {
+				try {
+					streamfx::util::library::load(lib_name);
+					return true;
+				} catch (...) {
+					return false;
+				}
+			})) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void qsv::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	obs_data_set_default_string(settings, ST_KEY_PRESET, "");
+
+	obs_data_set_default_string(settings, ST_KEY_RATECONTROL_MODE, "cbr");
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LOOKAHEAD, -1);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET, 6000);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM, 0);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_BUFFERSIZE, 12000);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_QUALITY, 23);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_QP, 23);
+
+	obs_data_set_default_int(settings, ST_KEY_OTHER_LOWPOWER, -1);
+	obs_data_set_default_int(settings, ST_KEY_OTHER_BFRAMES, -1);
+	obs_data_set_default_int(settings, ST_KEY_OTHER_REFERENCEFRAMES, -1);
+	obs_data_set_default_int(settings, ST_KEY_OTHER_ASYNCDEPTH, -1);
+
+	// Replay Buffer
+	obs_data_set_default_int(settings, "bitrate", 0);
+}
+
+static bool modified_ratecontrol(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
+{
+	std::string_view rc = obs_data_get_string(settings, ST_KEY_RATECONTROL_MODE);
+
+	bool have_bitrate       = is_cbr(rc) || is_vbr(rc);
+	bool have_bitrate_range = is_vbr(rc);
+	bool have_quality       = is_icq(rc);
+	bool have_qp            = is_cqp(rc);
+
+	obs_property_set_visible(obs_properties_get(props, ST_I18N_RATECONTROL_LIMITS), have_bitrate || have_quality);
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_RATECONTROL_LIMITS_BUFFERSIZE), have_bitrate);
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET), have_bitrate);
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM), have_bitrate_range);
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_RATECONTROL_LIMITS_QUALITY), have_quality);
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_RATECONTROL_QP), have_qp);
+
+	return true;
+}
+
+void qsv::properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context)
+{
+	{
+		auto p = obs_properties_add_list(props, ST_KEY_PRESET, D_TRANSLATE(ST_I18N_PRESET), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+		obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
+		streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "preset", [&p](const AVOption* opt) {
+			char buffer[1024];
+			snprintf(buffer, sizeof(buffer), "%s.%s", ST_I18N_PRESET, opt->name);
+			obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
+		});
+	}
+}
+
+void qsv::properties_after(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context)
+{
+	{ // Rate Control
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, ST_I18N_RATECONTROL, D_TRANSLATE(ST_I18N_RATECONTROL), OBS_GROUP_NORMAL, grp);
+		}
+
+		{
+			auto p = obs_properties_add_list(grp, ST_KEY_RATECONTROL_MODE, D_TRANSLATE(ST_I18N_RATECONTROL_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+			obs_property_set_modified_callback(p, modified_ratecontrol);
+			obs_property_list_add_string(p, D_TRANSLATE(ST_I18N_RATECONTROL_MODE_(cbr)), "cbr");
+			obs_property_list_add_string(p, D_TRANSLATE(ST_I18N_RATECONTROL_MODE_(vbr)), "vbr");
+			obs_property_list_add_string(p, D_TRANSLATE(ST_I18N_RATECONTROL_MODE_(icq)), "icq");
+			obs_property_list_add_string(p, D_TRANSLATE(ST_I18N_RATECONTROL_MODE_(cqp)), "cqp");
+		}
+
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "look_ahead_depth")) {
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_RATECONTROL_LOOKAHEAD, D_TRANSLATE(ST_I18N_RATECONTROL_LOOKAHEAD), -1, 100, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
+	}
+
+	{
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, ST_I18N_RATECONTROL_LIMITS, D_TRANSLATE(ST_I18N_RATECONTROL_LIMITS), OBS_GROUP_NORMAL, grp);
+		}
+
+		{
+			auto p = obs_properties_add_int(grp, ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET, D_TRANSLATE(ST_I18N_RATECONTROL_LIMITS_BITRATE_TARGET), -1, std::numeric_limits<int32_t>::max(), 1);
+			obs_property_int_set_suffix(p, " kbit/s");
+		}
+		{
+			auto p = obs_properties_add_int(grp, ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM, D_TRANSLATE(ST_I18N_RATECONTROL_LIMITS_BITRATE_MAXIMUM), -1, std::numeric_limits<int32_t>::max(), 1);
+			obs_property_int_set_suffix(p, " kbit/s");
+		}
+		{
+			auto p = obs_properties_add_int(grp, ST_KEY_RATECONTROL_LIMITS_BUFFERSIZE, D_TRANSLATE(ST_I18N_RATECONTROL_LIMITS_BUFFERSIZE), 0, std::numeric_limits<int32_t>::max(), 1);
+			obs_property_int_set_suffix(p, " kbit");
+		}
+		obs_properties_add_int_slider(grp, ST_KEY_RATECONTROL_LIMITS_QUALITY, D_TRANSLATE(ST_I18N_RATECONTROL_LIMITS_QUALITY), 1, 51, 1);
+	}
+
+	{
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, ST_I18N_RATECONTROL_QP, D_TRANSLATE(ST_I18N_RATECONTROL_QP), OBS_GROUP_NORMAL, grp);
+		}
+
+		obs_properties_add_int_slider(grp, ST_KEY_RATECONTROL_QP, D_TRANSLATE(ST_I18N_RATECONTROL_QP), 0, 51, 1);
+	}
+
+	{
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, ST_I18N_OTHER, D_TRANSLATE(ST_I18N_OTHER), OBS_GROUP_NORMAL, grp);
+		}
+
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "low_power")) {
+			streamfx::util::obs_properties_add_tristate(grp, ST_KEY_OTHER_LOWPOWER, D_TRANSLATE(ST_I18N_OTHER_LOWPOWER));
+		}
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_BFRAMES, D_TRANSLATE(ST_I18N_OTHER_BFRAMES), -1, 16, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_REFERENCEFRAMES, D_TRANSLATE(ST_I18N_OTHER_REFERENCEFRAMES), -1, 16, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_ASYNCDEPTH, D_TRANSLATE(ST_I18N_OTHER_ASYNCDEPTH), -1, 64, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
+	}
+}
+
+void qsv::properties_codec(obs_properties_t* props, AVCodecContext* context, const char* group, const char* key, const char* profile)
+{
+	obs_properties_t* grp = props;
+	if (!streamfx::util::are_property_groups_broken()) {
+		grp = obs_properties_create();
+		obs_properties_add_group(props, group, D_TRANSLATE(group), OBS_GROUP_NORMAL, grp);
+	}
+
+	auto p = obs_properties_add_list(grp, key, D_TRANSLATE(profile), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
+	streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "profile", [&p, profile](const AVOption* opt) {
+		// "unknown" lets the runtime decide, which is what the default entry is for.
+		if (opt->default_val.i64 == 0) {
+			return;
+		}
+
+		char buffer[1024];
+		snprintf(buffer, sizeof(buffer), "%s.%s", profile, opt->name);
+		obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
+	});
+}
+
+void qsv::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_PRESET), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_MODE), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_LOOKAHEAD), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_LOWPOWER), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_BFRAMES), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_REFERENCEFRAMES), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_ASYNCDEPTH), false);
+}
+
+void qsv::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	AVCodecContext* context = const_cast<AVCodecContext*>(instance->get_avcodeccontext());
+
+	if (!context->internal) {
+		if (const char* v = obs_data_get_string(settings, ST_KEY_PRESET); v && (v[0] != '\0')) {
+			av_opt_set(context->priv_data, "preset", v, AV_OPT_SEARCH_CHILDREN);
+		}
+
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_OTHER_LOWPOWER); !streamfx::util::is_tristate_default(v)) {
+			av_opt_set_int(context->priv_data, "low_power", v, AV_OPT_SEARCH_CHILDREN);
+		}
+
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_LOOKAHEAD); v > -1) {
+			av_opt_set_int(context->priv_data, "look_ahead_depth", v, AV_OPT_SEARCH_CHILDREN);
+			if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "look_ahead")) {
+				// H.264 switches to its look-ahead rate control instead.
+				av_opt_set_int(context->priv_data, "look_ahead", (v > 0) ? 1 : 0, AV_OPT_SEARCH_CHILDREN);
+			} else if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "extbrc")) {
+				// Everything else only looks ahead through the extended bitrate control.
+				av_opt_set_int(context->priv_data, "extbrc", (v > 0) ? 1 : 0, AV_OPT_SEARCH_CHILDREN);
+			}
+		}
+
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_OTHER_BFRAMES); v > -1) {
+			context->max_b_frames = static_cast<int>(v);
+		}
+
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_OTHER_REFERENCEFRAMES); v > -1) {
+			context->refs = static_cast<int>(v);
+		}
+
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_OTHER_ASYNCDEPTH); v > -1) {
+			av_opt_set_int(context->priv_data, "async_depth", v, AV_OPT_SEARCH_CHILDREN);
+		}
+	}
+
+	{ // Rate Control
+		std::string_view rc = obs_data_get_string(settings, ST_KEY_RATECONTROL_MODE);
+
+		context->flags &= ~AV_CODEC_FLAG_QSCALE;
+		context->global_quality = 0;
+		context->bit_rate       = 0;
+		context->rc_max_rate    = 0;
+		context->rc_buffer_size = 0;
+
+		if (is_cqp(rc)) {
+			context->flags |= AV_CODEC_FLAG_QSCALE;
+			context->global_quality = static_cast<int>(obs_data_get_int(settings, ST_KEY_RATECONTROL_QP)) * FF_QP2LAMBDA;
+		} else if (is_icq(rc)) {
+			context->global_quality = static_cast<int>(obs_data_get_int(settings, ST_KEY_RATECONTROL_LIMITS_QUALITY));
+		} else {
+			if (int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET); v > -1) {
+				context->bit_rate = static_cast<int>(v * 1000);
+
+				// Support for Replay Buffer
+				obs_data_set_int(settings, "bitrate", v);
+			}
+
+			// Equal rates is what makes Quick Sync pick CBR.
+			context->rc_max_rate = context->bit_rate;
+			if (is_vbr(rc)) {
+				if (int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM); v > -1) {
+					context->rc_max_rate = std::max<int64_t>(static_cast<int64_t>(v * 1000), context->bit_rate + 1);
+				}
+			}
+
+			if (int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_LIMITS_BUFFERSIZE); v > -1) {
+				context->rc_buffer_size = static_cast<int>(v * 1000);
+			}
+		}
+	}
+}
+
+void qsv::update_codec(ffmpeg_instance* instance, obs_data_t* settings, const char* key)
+{
+	AVCodecContext* context = const_cast<AVCodecContext*>(instance->get_avcodeccontext());
+	if (context->internal) {
+		return;
+	}
+
+	if (const char* v = obs_data_get_string(settings, key); v && (v[0] != '\0')) {
+		av_opt_set(context->priv_data, "profile", v, AV_OPT_SEARCH_CHILDREN);
+	}
+}
+
+void qsv::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	AVCodecContext* context = const_cast<AVCodecContext*>(instance->get_avcodeccontext());
+
+	// The surface pool is fixed once the encoder is open.
+	if (context->internal) {
+		return;
+	}
+
+	int64_t async_depth = 0;
+	int64_t lookahead   = 0;
+	av_opt_get_int(context, "async_depth", AV_OPT_SEARCH_CHILDREN, &async_depth);
+	av_opt_get_int(context, "look_ahead_depth", AV_OPT_SEARCH_CHILDREN, &lookahead);
+
+	// Every asynchronous task holds on to its input surface, as does every frame in the look-ahead queue, so the
+	// frame pool has to cover all of them or encoding stalls on the next free frame.
+	context->delay = static_cast<int>(std::max<int64_t>(async_depth, 1ll) + std::max<int64_t>(lookahead, 0ll) + std::max<int64_t>(context->max_b_frames, 0ll));
+}
+
+void qsv::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	using namespace ::streamfx::ffmpeg;
+
+	auto codec   = factory->get_avcodec();
+	auto context = instance->get_avcodeccontext();
+
+	DLOG_INFO("[%s]   Intel Quick Sync Video:", codec->name);
+	tools::print_av_option_string2(context, "preset", "    Preset", [](int64_t v, std::string_view o) { return std::string(o); });
+	tools::print_av_option_string2(context, "profile", "    Profile", [](int64_t v, std::string_view o) { return std::string(o); });
+	tools::print_av_option_bool(context, "low_power", "    Low Power");
+	DLOG_INFO("[%s]     Rate Control: %s", codec->name, obs_data_get_string(settings, ST_KEY_RATECONTROL_MODE));
+	tools::print_av_option_int(context, "look_ahead_depth", "      Look-Ahead", "Frames");
+	tools::print_av_option_int(context, "b", "      Target Bitrate", "bits/sec");
+	tools::print_av_option_int(context, "maxrate", "      Maximum Bitrate", "bits/sec");
+	tools::print_av_option_int(context, "bufsize", "      Buffer Size", "bits");
+	tools::print_av_option_int(context, "global_quality", "      Quality", "");
+	DLOG_INFO("[%s]     Other:", codec->name);
+	tools::print_av_option_int(context, "bf", "      B-Frames", "Frames");
+	tools::print_av_option_int(context, "refs", "      Reference Frames", "Frames");
+	tools::print_av_option_int(context, "async_depth", "      Asynchronous Depth", "Frames");
+	DLOG_INFO("[%s]       Delay: %d frames", codec->name, context->delay);
+}
+
+static void properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, const char* group, const char* key, const char* profile)
+{
+	AVCodecContext* context = avcodec_alloc_context3(factory->get_avcodec());
+	if (!context->priv_data) {
+		avcodec_free_context(&context);
+		return;
+	}
+
+	qsv::properties_before(factory, instance, props, context);
+	qsv::properties_codec(props, context, group, key, profile);
+	qsv::properties_after(factory, instance, props, context);
+
+	avcodec_free_context(&context);
+}
+
+// H264 Handler
+//--------------
+
+qsv_h264::qsv_h264() : handler("h264_qsv") {}
+
+qsv_h264::~qsv_h264() {}
+
+bool qsv_h264::has_keyframes(ffmpeg_factory*)
+{
+	return true;
+}
+
+bool qsv_h264::has_threading(ffmpeg_factory*)
+{
+	return false;
+}
+
+bool qsv_h264::is_hardware(ffmpeg_factory*)
+{
+	return true;
+}
+
+void qsv_h264::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
+{
+	name = "Intel Quick Sync H.264/AVC (via FFmpeg)";
+	if (!qsv::is_available()) // If we don't have a runtime, don't even allow listing it.
+		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL;
+}
+
+void qsv_h264::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	qsv::defaults(factory, settings);
+
+	obs_data_set_default_string(settings, ST_KEY_H264_PROFILE, "");
+}
+
+void qsv_h264::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	if (!instance) {
+		properties_encoder(factory, instance, props, S_CODEC_H264, ST_KEY_H264_PROFILE, S_CODEC_H264_PROFILE);
+	} else {
+		qsv::properties_runtime(factory, instance, props);
+	}
+}
+
+void qsv_h264::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::update(factory, instance, settings);
+	qsv::update_codec(instance, settings, ST_KEY_H264_PROFILE);
+}
+
+void qsv_h264::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::override_update(factory, instance, settings);
+}
+
+void qsv_h264::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::log(factory, instance, settings);
+}
+
+static auto inst_h264 = qsv_h264();
+
+// H265/HEVC Handler
+//-------------------
+
+qsv_hevc::qsv_hevc() : handler("hevc_qsv") {}
+
+qsv_hevc::~qsv_hevc() {}
+
+bool qsv_hevc::has_keyframes(ffmpeg_factory*)
+{
+	return true;
+}
+
+bool qsv_hevc::has_threading(ffmpeg_factory*)
+{
+	return false;
+}
+
+bool qsv_hevc::is_hardware(ffmpeg_factory*)
+{
+	return true;
+}
+
+void qsv_hevc::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
+{
+	name = "Intel Quick Sync H.265/HEVC (via FFmpeg)";
+	if (!qsv::is_available())
+		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL;
+}
+
+void qsv_hevc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	qsv::defaults(factory, settings);
+
+	obs_data_set_default_string(settings, ST_KEY_H265_PROFILE, "");
+}
+
+void qsv_hevc::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	if (!instance) {
+		properties_encoder(factory, instance, props, S_CODEC_HEVC, ST_KEY_H265_PROFILE, S_CODEC_HEVC_PROFILE);
+	} else {
+		qsv::properties_runtime(factory, instance, props);
+	}
+}
+
+void qsv_hevc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::update(factory, instance, settings);
+	qsv::update_codec(instance, settings, ST_KEY_H265_PROFILE);
+}
+
+void qsv_hevc::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::override_update(factory, instance, settings);
+}
+
+void qsv_hevc::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::log(factory, instance, settings);
+}
+
+static auto inst_hevc = qsv_hevc();
+
+// AV1 Handler
+//-------------
+
+qsv_av1::qsv_av1() : handler("av1_qsv") {}
+
+qsv_av1::~qsv_av1() {}
+
+bool qsv_av1::has_keyframes(ffmpeg_factory*)
+{
+	return true;
+}
+
+bool qsv_av1::has_threading(ffmpeg_factory*)
+{
+	return false;
+}
+
+bool qsv_av1::is_hardware(ffmpeg_factory*)
+{
+	return true;
+}
+
+void qsv_av1::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
+{
+	name = "Intel Quick Sync AV1 (via FFmpeg)";
+	if (!qsv::is_available())
+		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL;
+}
+
+void qsv_av1::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	qsv::defaults(factory, settings);
+
+	obs_data_set_default_string(settings, ST_KEY_AV1_PROFILE, "");
+}
+
+void qsv_av1::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	if (!instance) {
+		properties_encoder(factory, instance, props, S_CODEC_AV1, ST_KEY_AV1_PROFILE, S_CODEC_AV1_PROFILE);
+	} else {
+		qsv::properties_runtime(factory, instance, props);
+	}
+}
+
+void qsv_av1::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::update(factory, instance, settings);
+	qsv::update_codec(instance, settings, ST_KEY_AV1_PROFILE);
+}
+
+void qsv_av1::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::override_update(factory, instance, settings);
+}
+
+void qsv_av1::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	qsv::log(factory, instance, settings);
+}
+
+static auto inst_av1 = qsv_av1();
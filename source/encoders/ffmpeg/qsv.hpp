@@ -0,0 +1,92 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "encoders/encoder-ffmpeg.hpp"
+#include "encoders/ffmpeg/handler.hpp"
+
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <string>
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+#include "warning-enable.hpp"
+
+/* Quick Sync picks the rate control method from the context instead of an option:
+- CQP: Constant QP (flags |= AV_CODEC_FLAG_QSCALE, global_quality = qp * FF_QP2LAMBDA)
+- ICQ: Intelligent Constant Quality (global_quality = quality, no bitrate), this is basically CRF in X264.
+- CBR: Constant Bitrate (b = maxrate)
+- VBR: Variable Bitrate (b < maxrate)
+*/
+
+namespace streamfx::encoder::ffmpeg {
+	namespace qsv {
+		bool is_available();
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings);
+		void properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context);
+		void properties_after(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context);
+		void properties_codec(obs_properties_t* props, AVCodecContext* context, const char* group, const char* key, const char* profile);
+		void properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
+		void update_codec(ffmpeg_instance* instance, obs_data_t* settings, const char* key);
+		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
+	} // namespace qsv
+
+	class qsv_h264 : public handler {
+		public:
+		qsv_h264();
+		virtual ~qsv_h264();
+
+		bool has_keyframes(ffmpeg_factory* factory) override;
+		bool has_threading(ffmpeg_factory* factory) override;
+		bool is_hardware(ffmpeg_factory* factory) override;
+
+		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+	};
+
+	class qsv_hevc : public handler {
+		public:
+		qsv_hevc();
+		virtual ~qsv_hevc();
+
+		bool has_keyframes(ffmpeg_factory* factory) override;
+		bool has_threading(ffmpeg_factory* factory) override;
+		bool is_hardware(ffmpeg_factory* factory) override;
+
+		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+	};
+
+	class qsv_av1 : public handler {
+		public:
+		qsv_av1();
+		virtual ~qsv_av1();
+
+		bool has_keyframes(ffmpeg_factory* factory) override;
+		bool has_threading(ffmpeg_factory* factory) override;
+		bool is_hardware(ffmpeg_factory* factory) override;
+
+		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+	};
+} // namespace streamfx::encoder::ffmpeg
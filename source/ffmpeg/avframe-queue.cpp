@@ -6,31 +6,201 @@
 #include "avframe-queue.hpp"
 #include "tools.hpp"
 
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/channel_layout.h>
+#include <libavutil/error.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/version.h>
+#include "warning-enable.hpp"
+}
+
+#if defined(D_PLATFORM_WINDOWS)
+#include "warning-disable.hpp"
+#include <Windows.h>
+#include "warning-enable.hpp"
+#else
+#include "warning-disable.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(D_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#endif
+#include "warning-enable.hpp"
+#endif
+
+// Enough for every SIMD copy and conversion FFmpeg has.
+#define ST_ALIGNMENT 64
+
+// Below this, huge pages would mostly be wasted.
+#define ST_HUGE_PAGE_SIZE (2ull * 1024ull * 1024ull)
+
 using namespace streamfx::ffmpeg;
 
+namespace {
+	struct pool_options {
+		int32_t numa_node;
+		bool    huge_pages;
+	};
+
+	/** Allocate whole pages directly from the system, so that their placement can be controlled.
+	 *
+	 * The pages are not touched here, so without a NUMA node they end up local to whoever writes them first.
+	 */
+	void* allocate_pages(size_t size, pool_options const& options)
+	{
+#if defined(D_PLATFORM_WINDOWS)
+		DWORD type = MEM_RESERVE | MEM_COMMIT;
+		if (options.huge_pages && (size >= ST_HUGE_PAGE_SIZE)) {
+			// Requires the 'Lock pages in memory' privilege, which most users don't have.
+			if (SIZE_T large = GetLargePageMinimum(); large > 0) {
+				size_t large_size = ((size + large - 1) / large) * large;
+				if (void* ptr = (options.numa_node >= 0) ? VirtualAllocExNuma(GetCurrentProcess(), nullptr, large_size, type | MEM_LARGE_PAGES, PAGE_READWRITE, static_cast<DWORD>(options.numa_node)) : VirtualAlloc(nullptr, large_size, type | MEM_LARGE_PAGES, PAGE_READWRITE); ptr) {
+					return ptr;
+				}
+			}
+		}
+		if (options.numa_node >= 0) {
+			return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, type, PAGE_READWRITE, static_cast<DWORD>(options.numa_node));
+		}
+		return VirtualAlloc(nullptr, size, type, PAGE_READWRITE);
+#else
+		void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (ptr == MAP_FAILED) {
+			return nullptr;
+		}
+#if defined(MADV_HUGEPAGE)
+		if (options.huge_pages && (size >= ST_HUGE_PAGE_SIZE)) {
+			madvise(ptr, size, MADV_HUGEPAGE);
+		}
+#endif
+#if defined(D_PLATFORM_LINUX) && defined(SYS_mbind)
+		if ((options.numa_node >= 0) && (options.numa_node < 64)) {
+			// MPOL_PREFERRED, so that a full node falls back to another one instead of failing.
+			unsigned long mask = 1ul << options.numa_node;
+			syscall(SYS_mbind, ptr, size, 1, &mask, sizeof(mask) * 8, 0);
+		}
+#endif
+		return ptr;
+#endif
+	}
+
+	void free_pages(void* opaque, uint8_t* data)
+	{
+#if defined(D_PLATFORM_WINDOWS)
+		(void)opaque;
+		VirtualFree(data, 0, MEM_RELEASE);
+#else
+		munmap(data, reinterpret_cast<size_t>(opaque));
+#endif
+	}
+
+#if LIBAVUTIL_VERSION_MAJOR >= 57
+	AVBufferRef* allocate_buffer(void* opaque, size_t size)
+#else
+	AVBufferRef* allocate_buffer(void* opaque, int size)
+#endif
+	{
+		auto  options = static_cast<pool_options*>(opaque);
+		void* data    = allocate_pages(static_cast<size_t>(size), *options);
+		if (!data) {
+			return nullptr;
+		}
+
+		AVBufferRef* buffer = av_buffer_create(static_cast<uint8_t*>(data), size, &free_pages, reinterpret_cast<void*>(static_cast<size_t>(size)), 0);
+		if (!buffer) {
+			free_pages(reinterpret_cast<void*>(static_cast<size_t>(size)), static_cast<uint8_t*>(data));
+		}
+		return buffer;
+	}
+
+	void free_pool(void* opaque)
+	{
+		delete static_cast<pool_options*>(opaque);
+	}
+} // namespace
+
 std::shared_ptr<AVFrame> avframe_queue::create_frame()
 {
+	if (_allocator) {
+		return _allocator();
+	}
+
+	bool audio = (_sample_format != AV_SAMPLE_FMT_NONE);
+	int  size  = 0;
+	if (audio) {
+		size = av_samples_get_buffer_size(nullptr, _channels, _samples, _sample_format, ST_ALIGNMENT);
+	} else {
+		size = av_image_get_buffer_size(this->_format, this->_resolution.first, this->_resolution.second, ST_ALIGNMENT);
+	}
+	if (size < 0) {
+		throw std::runtime_error(tools::get_error_description(size));
+	}
+
+	// Frames of one size share a pool, so a buffer freed by the encoder goes straight to the next frame.
+	if (!_pool || (_pool_size != static_cast<size_t>(size))) {
+		if (_pool) {
+			av_buffer_pool_uninit(&_pool);
+		}
+		_pool_size = static_cast<size_t>(size);
+		_pool      = av_buffer_pool_init2(size, new pool_options{_numa_node, _huge_pages}, &allocate_buffer, &free_pool);
+		if (!_pool) {
+			throw std::bad_alloc();
+		}
+	}
+
 	std::shared_ptr<AVFrame> frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) {
 		av_frame_unref(frame);
 		av_frame_free(&frame);
 	});
-	frame->width                   = this->_resolution.first;
-	frame->height                  = this->_resolution.second;
-	frame->format                  = this->_format;
 
-	int res = av_frame_get_buffer(frame.get(), 32);
+	frame->buf[0] = av_buffer_pool_get(_pool);
+	if (!frame->buf[0]) {
+		throw std::runtime_error(tools::get_error_description(AVERROR(ENOMEM)));
+	}
+
+	if (audio) {
+		frame->nb_samples = _samples;
+		frame->format     = _sample_format;
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+		av_channel_layout_default(&frame->ch_layout, _channels);
+#else
+		frame->channels       = _channels;
+		frame->channel_layout = static_cast<uint64_t>(av_get_default_channel_layout(_channels));
+#endif
+
+		int res = av_samples_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data, _channels, _samples, _sample_format, ST_ALIGNMENT);
+		if (res < 0) {
+			throw std::runtime_error(tools::get_error_description(res));
+		}
+		frame->extended_data = frame->data;
+
+		return frame;
+	}
+
+	frame->width  = this->_resolution.first;
+	frame->height = this->_resolution.second;
+	frame->format = this->_format;
+
+	int res = av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data, this->_format, this->_resolution.first, this->_resolution.second, ST_ALIGNMENT);
 	if (res < 0) {
 		throw std::runtime_error(tools::get_error_description(res));
 	}
+	frame->extended_data = frame->data;
 
 	return frame;
 }
 
-avframe_queue::avframe_queue() = default;
+avframe_queue::avframe_queue() : _frames(), _lock(), _resolution(), _format(AV_PIX_FMT_NONE), _sample_format(AV_SAMPLE_FMT_NONE), _samples(0), _channels(0), _allocator(), _pool(nullptr), _pool_size(0), _numa_node(-1), _huge_pages(false) {}
 
 avframe_queue::~avframe_queue()
 {
 	clear();
+
+	// Buffers still in use keep the pool alive until they are freed.
+	if (_pool) {
+		av_buffer_pool_uninit(&_pool);
+	}
 }
 
 void avframe_queue::set_resolution(int32_t const width, int32_t const height)
@@ -65,10 +235,42 @@ AVPixelFormat avframe_queue::get_pixel_format()
 	return this->_format;
 }
 
+void avframe_queue::set_audio(int32_t samples, int32_t channels, AVSampleFormat format)
+{
+	this->_samples       = samples;
+	this->_channels      = channels;
+	this->_sample_format = format;
+}
+
+void avframe_queue::set_allocator(std::function<std::shared_ptr<AVFrame>()> allocator)
+{
+	std::unique_lock<std::mutex> ulock(this->_lock);
+	_allocator = allocator;
+}
+
+void avframe_queue::set_numa_node(int32_t node)
+{
+	std::unique_lock<std::mutex> ulock(this->_lock);
+	if (_numa_node != node) {
+		_numa_node = node;
+		_pool_size = 0; // Recreate the pool with the new options.
+	}
+}
+
+void avframe_queue::set_huge_pages(bool enabled)
+{
+	std::unique_lock<std::mutex> ulock(this->_lock);
+	if (_huge_pages != enabled) {
+		_huge_pages = enabled;
+		_pool_size  = 0;
+	}
+}
+
 void avframe_queue::precache(std::size_t count)
 {
+	std::unique_lock<std::mutex> ulock(this->_lock);
 	for (std::size_t n = 0; n < count; n++) {
-		push(create_frame());
+		_frames.push_back(create_frame());
 	}
 }
 
@@ -97,7 +299,11 @@ std::shared_ptr<AVFrame> avframe_queue::pop()
 				ret = create_frame();
 			} else {
 				_frames.pop_front();
-				if ((static_cast<int32_t>(ret->width) != this->_resolution.first) || (static_cast<int32_t>(ret->height) != this->_resolution.second) || (ret->format != this->_format)) {
+				if (_sample_format != AV_SAMPLE_FMT_NONE) {
+					if ((ret->nb_samples != this->_samples) || (ret->format != this->_sample_format)) {
+						ret = nullptr;
+					}
+				} else if ((static_cast<int32_t>(ret->width) != this->_resolution.first) || (static_cast<int32_t>(ret->height) != this->_resolution.second) || (ret->format != this->_format)) {
 					ret = nullptr;
 				}
 			}
@@ -122,10 +328,12 @@ std::shared_ptr<AVFrame> avframe_queue::pop_only()
 
 bool avframe_queue::empty()
 {
+	std::unique_lock<std::mutex> ulock(this->_lock);
 	return _frames.empty();
 }
 
 std::size_t avframe_queue::size()
 {
+	std::unique_lock<std::mutex> ulock(this->_lock);
 	return _frames.size();
 }
@@ -7,12 +7,15 @@
 
 #include "warning-disable.hpp"
 #include <deque>
+#include <functional>
 #include <mutex>
 #include "warning-enable.hpp"
 
 extern "C" {
 #include "warning-disable.hpp"
+#include <libavutil/buffer.h>
 #include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
 #include "warning-enable.hpp"
 }
 
@@ -24,6 +27,19 @@ namespace streamfx::ffmpeg {
 		std::pair<int32_t, int32_t> _resolution;
 		AVPixelFormat               _format = AV_PIX_FMT_NONE;
 
+		// Audio frames instead of video frames, as long as a sample format is set.
+		AVSampleFormat _sample_format = AV_SAMPLE_FMT_NONE;
+		int32_t        _samples;
+		int32_t        _channels;
+
+		std::function<std::shared_ptr<AVFrame>()> _allocator;
+
+		// Buffers of software frames, kept around and handed out again once a frame is freed.
+		AVBufferPool* _pool;
+		std::size_t   _pool_size;
+		int32_t       _numa_node;
+		bool          _huge_pages;
+
 		std::shared_ptr<AVFrame> create_frame();
 
 		public:
@@ -38,6 +54,27 @@ namespace streamfx::ffmpeg {
 		void          set_pixel_format(AVPixelFormat format);
 		AVPixelFormat get_pixel_format();
 
+		/** Hand out audio frames of 'samples' samples per channel instead of video frames.
+		 *
+		 * The frames carry the default layout for the number of channels, so the encoder should use the same.
+		 */
+		void set_audio(int32_t samples, int32_t channels, AVSampleFormat format);
+
+		/** Replace how new frames are created, for example to allocate them from a hardware frames context.
+		 *
+		 * The allocated frames must still match the configured resolution and pixel format.
+		 */
+		void set_allocator(std::function<std::shared_ptr<AVFrame>()> allocator);
+
+		/** Place the memory of software frames on a specific NUMA node, or let the system decide with -1.
+		 *
+		 * Without a node, memory ends up wherever it is first written to, which usually is the thread copying into it.
+		 */
+		void set_numa_node(int32_t node);
+
+		/** Back large software frames with huge pages where the system allows it. */
+		void set_huge_pages(bool enabled);
+
 		void precache(std::size_t count);
 
 		void clear();
@@ -0,0 +1,105 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "avpacket-pool.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+avpacket_pool::avpacket_pool() : _packets(), _lock(), _buffers(), _buffer_size(0), _buffers_lock() {}
+
+avpacket_pool::~avpacket_pool()
+{
+	clear();
+}
+
+void avpacket_pool::attach(AVCodecContext* context)
+{
+	if ((context->codec == nullptr) || ((context->codec->capabilities & AV_CODEC_CAP_DR1) == 0)) {
+		// The encoder manages its own packet memory.
+		return;
+	}
+
+	context->opaque            = this;
+	context->get_encode_buffer = &avpacket_pool::get_encode_buffer;
+}
+
+void avpacket_pool::clear()
+{
+	{
+		std::unique_lock<std::mutex> ulock(_lock);
+		_packets.clear();
+	}
+	{
+		std::unique_lock<std::mutex> ulock(_buffers_lock);
+		_buffers.reset();
+		_buffer_size = 0;
+	}
+}
+
+void avpacket_pool::push(std::shared_ptr<AVPacket> packet)
+{
+	av_packet_unref(packet.get());
+
+	std::unique_lock<std::mutex> ulock(_lock);
+	_packets.push_back(packet);
+}
+
+std::shared_ptr<AVPacket> avpacket_pool::pop()
+{
+	{
+		std::unique_lock<std::mutex> ulock(_lock);
+		if (!_packets.empty()) {
+			auto packet = _packets.front();
+			_packets.pop_front();
+			return packet;
+		}
+	}
+
+	return {av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); }};
+}
+
+AVBufferRef* avpacket_pool::get_buffer(std::size_t size)
+{
+	std::unique_lock<std::mutex> ulock(_buffers_lock);
+
+	if (!_buffers || (_buffer_size < size)) {
+		// Grow in powers of two so that slowly increasing packet sizes don't keep replacing the pool. Buffers still
+		// held by the old pool are released once their packets are unreferenced.
+		std::size_t buffer_size = 64 * 1024;
+		while (buffer_size < size) {
+			buffer_size <<= 1;
+		}
+
+		_buffers     = std::shared_ptr<AVBufferPool>(av_buffer_pool_init(buffer_size, nullptr), [](AVBufferPool* ptr) { av_buffer_pool_uninit(&ptr); });
+		_buffer_size = buffer_size;
+		if (!_buffers) {
+			_buffer_size = 0;
+			return nullptr;
+		}
+	}
+
+	return av_buffer_pool_get(_buffers.get());
+}
+
+int avpacket_pool::get_encode_buffer(AVCodecContext* context, AVPacket* packet, int flags)
+{
+	auto self = reinterpret_cast<avpacket_pool*>(context->opaque);
+	if ((packet->size < 0) || !self) {
+		return avcodec_default_get_encode_buffer(context, packet, flags);
+	}
+
+	std::size_t size = static_cast<std::size_t>(packet->size);
+	packet->buf      = self->get_buffer(size + AV_INPUT_BUFFER_PADDING_SIZE);
+	if (!packet->buf) {
+		return AVERROR(ENOMEM);
+	}
+
+	packet->data = packet->buf->data;
+	std::memset(packet->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+	return 0;
+}
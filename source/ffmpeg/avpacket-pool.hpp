@@ -0,0 +1,56 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <deque>
+#include <mutex>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	/** Recycles packets and the memory backing their data.
+	 *
+	 * Encoders that support custom buffers (AV_CODEC_CAP_DR1) write directly into memory taken from the pool, which
+	 * then stays valid until the packet is unreferenced. Buffers are sized for the largest packet seen so far, so
+	 * intra-only codecs with multi-megabyte packets stop allocating after the first few frames.
+	 */
+	class avpacket_pool {
+		std::deque<std::shared_ptr<AVPacket>> _packets;
+		std::mutex                            _lock;
+
+		std::shared_ptr<AVBufferPool> _buffers;
+		std::size_t                   _buffer_size;
+		std::mutex                    _buffers_lock;
+
+		public:
+		avpacket_pool();
+		~avpacket_pool();
+
+		/** Route packet allocations of the context through this pool.
+		 *
+		 * Must be called before the context is opened, and the pool must outlive the context.
+		 */
+		void attach(AVCodecContext* context);
+
+		void clear();
+
+		void push(std::shared_ptr<AVPacket> packet);
+
+		std::shared_ptr<AVPacket> pop();
+
+		private:
+		AVBufferRef* get_buffer(std::size_t size);
+
+		static int get_encode_buffer(AVCodecContext* context, AVPacket* packet, int flags);
+	};
+} // namespace streamfx::ffmpeg
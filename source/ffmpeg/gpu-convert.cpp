@@ -0,0 +1,299 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gpu-convert.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+streamfx::ffmpeg::gpu_convert::~gpu_convert()
+{
+	auto gctx = streamfx::obs::gs::context();
+	for (auto& stage : _stages) {
+		if (stage) {
+			gs_stagesurface_destroy(stage);
+			stage = nullptr;
+		}
+	}
+	_luma.reset();
+	_chroma.reset();
+	_chroma_v.reset();
+	_effect.reset();
+}
+
+streamfx::ffmpeg::gpu_convert::gpu_convert() : _effect(), _gfx_util(::streamfx::gfx::util::get()), _luma(), _chroma(), _chroma_v(), _stages(), _staged(0), _format(AV_PIX_FMT_NONE), _full_range(false), _colorspace(AVCOL_SPC_UNSPECIFIED), _coefficients()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	auto file = streamfx::data_file_path("effects/yuv-convert.effect");
+	try {
+		_effect = streamfx::obs::gs::effect::create(file);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+		throw;
+	}
+}
+
+void streamfx::ffmpeg::gpu_convert::set_target(AVPixelFormat format, bool full_range, AVColorSpace space)
+{
+	uint32_t        bits;
+	float_t         storage;
+	gs_color_format luma_format;
+	gs_color_format chroma_format;
+	bool            planar = false;
+	switch (format) {
+	case AV_PIX_FMT_NV12:
+		bits          = 8;
+		storage       = 1.;
+		luma_format   = GS_R8;
+		chroma_format = GS_R8G8;
+		break;
+	case AV_PIX_FMT_P010:
+		// 10 bits stored in the upper bits of a 16-bit value.
+		bits          = 10;
+		storage       = 65472.f / 65535.f;
+		luma_format   = GS_R16;
+		chroma_format = GS_RG16;
+		break;
+	case AV_PIX_FMT_P016:
+		bits          = 16;
+		storage       = 1.;
+		luma_format   = GS_R16;
+		chroma_format = GS_RG16;
+		break;
+	case AV_PIX_FMT_YUV444P:
+		bits          = 8;
+		storage       = 1.;
+		luma_format   = GS_R8;
+		chroma_format = GS_R8;
+		planar        = true;
+		break;
+	default:
+		throw std::invalid_argument("format");
+	}
+
+	// Luma weights for the color space.
+	float_t kr, kb;
+	switch (space) {
+	case AVCOL_SPC_BT470BG:
+	case AVCOL_SPC_SMPTE170M:
+		kr = .299f;
+		kb = .114f;
+		break;
+	case AVCOL_SPC_BT2020_NCL:
+	case AVCOL_SPC_BT2020_CL:
+		kr = .2627f;
+		kb = .0593f;
+		break;
+	default:
+		kr = .2126f;
+		kb = .0722f;
+		break;
+	}
+	float_t kg = 1.f - kr - kb;
+
+	// Scale and offset for the selected range, in normalized units of the target bit depth.
+	float_t max     = static_cast<float_t>((1u << bits) - 1);
+	float_t y_scale = full_range ? 1.f : static_cast<float_t>(219u << (bits - 8)) / max;
+	float_t y_off   = full_range ? 0.f : static_cast<float_t>(16u << (bits - 8)) / max;
+	float_t c_scale = full_range ? 1.f : static_cast<float_t>(224u << (bits - 8)) / max;
+	float_t c_off   = static_cast<float_t>(128u << (bits - 8)) / max;
+
+	_coefficients[0] = {kr * y_scale, kg * y_scale, kb * y_scale, y_off};
+	_coefficients[1] = {-kr / (2.f * (1.f - kb)) * c_scale, -kg / (2.f * (1.f - kb)) * c_scale, .5f * c_scale, c_off};
+	_coefficients[2] = {.5f * c_scale, -kg / (2.f * (1.f - kr)) * c_scale, -kb / (2.f * (1.f - kr)) * c_scale, c_off};
+	for (auto& row : _coefficients) {
+		for (auto& v : row) {
+			v *= storage;
+		}
+	}
+
+	// Recreate render targets only if the formats changed.
+	auto gctx = streamfx::obs::gs::context();
+	if (!_luma || (_luma->get_color_format() != luma_format) || (_chroma->get_color_format() != chroma_format) || (static_cast<bool>(_chroma_v) != planar)) {
+		_luma   = std::make_unique<streamfx::obs::gs::rendertarget>(luma_format, GS_ZS_NONE);
+		_chroma = std::make_unique<streamfx::obs::gs::rendertarget>(chroma_format, GS_ZS_NONE);
+		if (planar) {
+			_chroma_v = std::make_unique<streamfx::obs::gs::rendertarget>(chroma_format, GS_ZS_NONE);
+		} else {
+			_chroma_v.reset();
+		}
+		_staged = 0;
+	}
+
+	_format     = format;
+	_full_range = full_range;
+	_colorspace = space;
+}
+
+AVPixelFormat streamfx::ffmpeg::gpu_convert::get_target_format()
+{
+	return _format;
+}
+
+std::vector<std::shared_ptr<streamfx::obs::gs::texture>> streamfx::ffmpeg::gpu_convert::convert(std::shared_ptr<streamfx::obs::gs::texture> source)
+{
+	if (!source) {
+		throw std::invalid_argument("source");
+	}
+	if (!_luma || !_chroma) {
+		throw std::runtime_error("No target format set.");
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_convert, "GPU Convert");
+#endif
+
+	uint32_t width  = source->get_width();
+	uint32_t height = source->get_height();
+
+	// Set up rendering state.
+	gs_blend_state_push();
+	gs_reset_blend_state();
+	gs_enable_blending(false);
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	gs_enable_color(true, true, true, true);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_enable_stencil_write(false);
+	gs_set_cull_mode(GS_NEITHER);
+
+	// The matrices work on the encoded values, so keep the hardware from linearizing them.
+	bool old_srgb = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(false);
+
+	_effect.get_parameter("image").set_texture(source, false);
+	_effect.get_parameter("imageTexel").set_float2(1.f / static_cast<float_t>(width), 1.f / static_cast<float_t>(height));
+	_effect.get_parameter("coeffY").set_float4(_coefficients[0][0], _coefficients[0][1], _coefficients[0][2], _coefficients[0][3]);
+	_effect.get_parameter("coeffU").set_float4(_coefficients[1][0], _coefficients[1][1], _coefficients[1][2], _coefficients[1][3]);
+	_effect.get_parameter("coeffV").set_float4(_coefficients[2][0], _coefficients[2][1], _coefficients[2][2], _coefficients[2][3]);
+
+	{
+		auto op = _luma->render(width, height);
+		gs_ortho(0, 1, 0, 1, 0, 1);
+		while (gs_effect_loop(_effect.get_object(), "Luma")) {
+			_gfx_util->draw_fullscreen_triangle();
+		}
+	}
+
+	if (_chroma_v) {
+		{
+			auto op = _chroma->render(width, height);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+			while (gs_effect_loop(_effect.get_object(), "ChromaU444")) {
+				_gfx_util->draw_fullscreen_triangle();
+			}
+		}
+		{
+			auto op = _chroma_v->render(width, height);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+			while (gs_effect_loop(_effect.get_object(), "ChromaV444")) {
+				_gfx_util->draw_fullscreen_triangle();
+			}
+		}
+	} else {
+		auto op = _chroma->render((width + 1) / 2, (height + 1) / 2);
+		gs_ortho(0, 1, 0, 1, 0, 1);
+		while (gs_effect_loop(_effect.get_object(), "Chroma420")) {
+			_gfx_util->draw_fullscreen_triangle();
+		}
+	}
+
+	// Clean up rendering state.
+	gs_enable_framebuffer_srgb(old_srgb);
+	gs_blend_state_pop();
+
+	if (_chroma_v) {
+		return {_luma->get_texture(), _chroma->get_texture(), _chroma_v->get_texture()};
+	}
+	return {_luma->get_texture(), _chroma->get_texture()};
+}
+
+void streamfx::ffmpeg::gpu_convert::stage()
+{
+	if (!_luma || !_chroma) {
+		throw std::runtime_error("No target format set.");
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+
+	std::array<streamfx::obs::gs::rendertarget*, 3> planes = {_luma.get(), _chroma.get(), _chroma_v.get()};
+	_staged                                                = 0;
+	for (size_t idx = 0; idx < planes.size(); idx++) {
+		if (!planes[idx]) {
+			break;
+		}
+
+		auto     texture = planes[idx]->get_texture();
+		uint32_t width   = texture->get_width();
+		uint32_t height  = texture->get_height();
+		auto     format  = texture->get_color_format();
+
+		// Surfaces are fixed in size and format, so only recreate them when either changes.
+		auto& stage = _stages[idx];
+		if (stage && ((gs_stagesurface_get_width(stage) != width) || (gs_stagesurface_get_height(stage) != height) || (gs_stagesurface_get_color_format(stage) != format))) {
+			gs_stagesurface_destroy(stage);
+			stage = nullptr;
+		}
+		if (!stage) {
+			stage = gs_stagesurface_create(width, height, format);
+			if (!stage) {
+				throw std::runtime_error("Failed to create staging surface.");
+			}
+		}
+
+		gs_stage_texture(stage, texture->get_object());
+		_staged++;
+	}
+}
+
+bool streamfx::ffmpeg::gpu_convert::download(AVFrame* frame)
+{
+	if (!frame) {
+		throw std::invalid_argument("frame");
+	}
+	if (_staged == 0) {
+		return false;
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+
+	for (size_t idx = 0; idx < _staged; idx++) {
+		uint8_t* data     = nullptr;
+		uint32_t linesize = 0;
+		if (!gs_stagesurface_map(_stages[idx], &data, &linesize)) {
+			return false;
+		}
+
+		// Rows of the surface are padded to whatever the driver prefers, so copy only what the frame can hold.
+		size_t   row    = std::min<size_t>(linesize, static_cast<size_t>(frame->linesize[idx]));
+		uint32_t height = gs_stagesurface_get_height(_stages[idx]);
+		for (uint32_t y = 0; y < height; y++) {
+			memcpy(frame->data[idx] + static_cast<size_t>(frame->linesize[idx]) * y, data + static_cast<size_t>(linesize) * y, row);
+		}
+
+		gs_stagesurface_unmap(_stages[idx]);
+	}
+
+	return true;
+}
+
+bool streamfx::ffmpeg::gpu_convert::is_supported(AVPixelFormat format)
+{
+	switch (format) {
+	case AV_PIX_FMT_NV12:
+	case AV_PIX_FMT_P010:
+	case AV_PIX_FMT_P016:
+	case AV_PIX_FMT_YUV444P:
+		return true;
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,77 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <memory>
+#include <vector>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	/** GPU counterpart to swscale for RGB(A) to semi-planar YUV 4:2:0 and planar YUV 4:4:4.
+	 *
+	 * Renders one texture per plane, which hwapi instances can then copy into hardware frames. Software encoders can
+	 * instead read the planes back into an AVFrame with download(), which replaces the swscale pass entirely.
+	 */
+	class gpu_convert {
+		streamfx::obs::gs::effect            _effect;
+		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+
+		std::unique_ptr<streamfx::obs::gs::rendertarget> _luma;
+		std::unique_ptr<streamfx::obs::gs::rendertarget> _chroma;
+		std::unique_ptr<streamfx::obs::gs::rendertarget> _chroma_v;
+
+		std::array<gs_stagesurf_t*, 3> _stages;
+		size_t                         _staged;
+
+		AVPixelFormat _format;
+		bool          _full_range;
+		AVColorSpace  _colorspace;
+
+		std::array<std::array<float_t, 4>, 3> _coefficients;
+
+		public:
+		~gpu_convert();
+		gpu_convert();
+
+		void          set_target(AVPixelFormat format, bool full_range, AVColorSpace space);
+		AVPixelFormat get_target_format();
+
+		/** Convert an RGB(A) texture, returns the luma and chroma plane textures.
+		 *
+		 * The textures are owned by the converter and overwritten by the next call. Planar formats return a texture
+		 * for each of U and V instead of a single chroma texture.
+		 */
+		std::vector<std::shared_ptr<streamfx::obs::gs::texture>> convert(std::shared_ptr<streamfx::obs::gs::texture> source);
+
+		/** Copy the planes of the last convert() into the staging surfaces.
+		 *
+		 * Call this right after convert(), and download() as late as possible so the GPU is not stalled.
+		 */
+		void stage();
+
+		/** Read the staged planes into a software frame of the target format.
+		 *
+		 * Returns false if nothing was staged or the surfaces could not be mapped.
+		 */
+		bool download(AVFrame* frame);
+
+		public:
+		static bool is_supported(AVPixelFormat format);
+	};
+} // namespace streamfx::ffmpeg
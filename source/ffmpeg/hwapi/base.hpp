@@ -30,8 +30,16 @@ namespace streamfx::ffmpeg::hwapi {
 
 		virtual AVBufferRef* create_device_context() = 0;
 
+		virtual AVPixelFormat get_pixel_format() = 0;
+
 		virtual std::shared_ptr<AVFrame> allocate_frame(AVBufferRef* frames) = 0;
 
+		/** Prepare a frames context before it is initialized, for textures from libOBS of the given size.
+		 *
+		 * If the size differs from the one of the frames, copy_from_obs() scales the textures on the GPU.
+		 */
+		virtual void prepare_frames(AVBufferRef* frames, uint32_t input_width, uint32_t input_height) = 0;
+
 		virtual void copy_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame) = 0;
 
 		virtual std::shared_ptr<AVFrame> avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key) = 0;
@@ -0,0 +1,202 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "cuda.hpp"
+#include "nvidia/cuda/nvidia-cuda-obs.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include <string>
+#include "warning-enable.hpp"
+
+// FFmpeg only needs the opaque handle types from the CUDA SDK, which we load dynamically instead.
+#ifndef CUDA_VERSION
+#define CUDA_VERSION 0
+typedef struct CUctx_st*    CUcontext;
+typedef struct CUstream_st* CUstream;
+#endif
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/hwcontext_cuda.h>
+#include "warning-enable.hpp"
+}
+
+using namespace streamfx::ffmpeg::hwapi;
+
+cuda::cuda() : _cuda(::streamfx::nvidia::cuda::cuda::get()) {}
+
+cuda::~cuda() {}
+
+std::list<device> cuda::enumerate_adapters()
+{
+	std::list<device> adapters;
+
+	int32_t count = 0;
+	if (_cuda->cuDeviceGetCount(&count) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		return adapters;
+	}
+
+	for (int32_t idx = 0; idx < count; idx++) {
+		::streamfx::nvidia::cuda::device_t cu_device;
+		if (_cuda->cuDeviceGet(&cu_device, idx) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+			continue;
+		}
+
+		std::vector<char> buf(256, 0);
+		_cuda->cuDeviceGetName(buf.data(), static_cast<int32_t>(buf.size() - 1), cu_device);
+
+		device dev;
+		dev.name      = std::string(buf.data());
+		dev.id.first  = 0;
+		dev.id.second = idx;
+
+		adapters.push_back(dev);
+	}
+
+	return adapters;
+}
+
+std::shared_ptr<instance> cuda::create(const device& target)
+{
+	::streamfx::nvidia::cuda::device_t cu_device;
+	if (_cuda->cuDeviceGet(&cu_device, static_cast<int32_t>(target.id.second)) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw std::runtime_error("Failed to find CUDA device for target.");
+	}
+
+	auto context = std::make_shared<::streamfx::nvidia::cuda::context>(cu_device);
+	auto stack   = context->enter();
+	auto stream  = std::make_shared<::streamfx::nvidia::cuda::stream>();
+
+	return std::make_shared<cuda_instance>(context, stream);
+}
+
+std::shared_ptr<instance> cuda::create_from_obs()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	if (GS_DEVICE_OPENGL != gs_get_device_type()) {
+		throw std::runtime_error("OBS Device is not an OpenGL Device.");
+	}
+
+	// Sharing the context libOBS renders with is what allows textures to be mapped directly.
+	auto cobs = ::streamfx::nvidia::cuda::obs::get();
+	return std::make_shared<cuda_instance>(cobs->get_context(), cobs->get_stream());
+}
+
+cuda_instance::cuda_instance(std::shared_ptr<::streamfx::nvidia::cuda::context> context, std::shared_ptr<::streamfx::nvidia::cuda::stream> stream) : _cuda(::streamfx::nvidia::cuda::cuda::get()), _context(context), _stream(stream), _textures() {}
+
+cuda_instance::~cuda_instance()
+{
+	auto gctx  = streamfx::obs::gs::context();
+	auto stack = _context->enter();
+	_textures.clear();
+}
+
+AVBufferRef* cuda_instance::create_device_context()
+{
+	AVBufferRef* dctx_ref = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_CUDA);
+	if (!dctx_ref)
+		throw std::runtime_error("Failed to allocate AVHWDeviceContext.");
+
+	AVHWDeviceContext*   hwdev        = reinterpret_cast<AVHWDeviceContext*>(dctx_ref->data);
+	AVCUDADeviceContext* device_hwctx = reinterpret_cast<AVCUDADeviceContext*>(hwdev->hwctx);
+
+	// Provide the existing context and stream, FFmpeg does not take ownership of either.
+	device_hwctx->cuda_ctx = reinterpret_cast<CUcontext>(_context->get());
+	device_hwctx->stream   = reinterpret_cast<CUstream>(_stream->get());
+
+	// Then let FFmpeg do the rest for us.
+	int ret = av_hwdevice_ctx_init(dctx_ref);
+	if (ret < 0) {
+		av_buffer_unref(&dctx_ref);
+		throw std::runtime_error("Failed to initialize AVHWDeviceContext.");
+	}
+
+	return dctx_ref;
+}
+
+AVPixelFormat cuda_instance::get_pixel_format()
+{
+	return AV_PIX_FMT_CUDA;
+}
+
+std::shared_ptr<AVFrame> cuda_instance::allocate_frame(AVBufferRef* frames)
+{
+	auto stack = _context->enter();
+
+	// Allocate a frame.
+	auto frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) { av_frame_free(&frame); });
+
+	// Create the necessary buffers.
+	if (av_hwframe_get_buffer(frames, frame.get(), 0) < 0) {
+		throw std::runtime_error("Failed to create AVFrame.");
+	}
+
+	return frame;
+}
+
+void cuda_instance::prepare_frames(AVBufferRef*, uint32_t, uint32_t)
+{
+	// Frames are only ever filled by copy_from_textures(), which needs textures of the same size.
+}
+
+void cuda_instance::copy_from_obs(AVBufferRef*, uint32_t, uint64_t, uint64_t*, std::shared_ptr<AVFrame>)
+{
+	// libOBS only hands out shared texture handles for Direct3D 11.
+	throw std::runtime_error("Shared texture handles are not supported by OpenGL, use copy_from_textures instead.");
+}
+
+std::shared_ptr<AVFrame> cuda_instance::avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key)
+{
+	auto frame = this->allocate_frame(frames);
+	this->copy_from_obs(frames, handle, lock_key, next_lock_key, frame);
+	return frame;
+}
+
+void cuda_instance::copy_from_textures(std::vector<std::shared_ptr<::streamfx::obs::gs::texture>> const& planes, std::shared_ptr<AVFrame> frame)
+{
+	auto gctx  = streamfx::obs::gs::context();
+	auto stack = _context->enter();
+
+	// Registering is expensive, so only do it the first time a texture is seen.
+	std::vector<std::shared_ptr<::streamfx::nvidia::cuda::gstexture>> textures;
+	for (std::size_t idx = 0; (idx < planes.size()) && (idx < AV_NUM_DATA_POINTERS) && frame->data[idx]; idx++) {
+		auto& plane = planes[idx];
+		auto  iter  = _textures.find(plane->get_object());
+		if (iter == _textures.end()) {
+			iter = _textures.emplace(plane->get_object(), std::make_shared<::streamfx::nvidia::cuda::gstexture>(plane)).first;
+		}
+		textures.push_back(iter->second);
+	}
+
+	// libOBS renders into these textures every frame, so they can't stay mapped. Map all planes at once instead, which
+	// only synchronizes with the graphics API a single time.
+	::streamfx::nvidia::cuda::gstexture::map_all(textures, _stream);
+
+	::streamfx::nvidia::cuda::result res = ::streamfx::nvidia::cuda::result::SUCCESS;
+	for (std::size_t idx = 0; (idx < textures.size()) && (res == ::streamfx::nvidia::cuda::result::SUCCESS); idx++) {
+		auto& plane = planes[idx];
+
+		::streamfx::nvidia::cuda::memcpy2d_v2_t mc = {};
+		mc.src_memory_type                         = ::streamfx::nvidia::cuda::memory_type::ARRAY;
+		mc.src_array                               = textures[idx]->map(_stream);
+		mc.dst_memory_type                         = ::streamfx::nvidia::cuda::memory_type::DEVICE;
+		mc.dst_device                              = static_cast<::streamfx::nvidia::cuda::device_ptr_t>(reinterpret_cast<uintptr_t>(frame->data[idx]));
+		mc.dst_pitch                               = static_cast<std::size_t>(frame->linesize[idx]);
+		mc.width_in_bytes                          = static_cast<std::size_t>(plane->get_width()) * gs_get_format_bpp(plane->get_color_format()) / 8;
+		mc.height                                  = plane->get_height();
+
+		res = _cuda->cuMemcpy2DAsync(&mc, _stream->get());
+	}
+
+	::streamfx::nvidia::cuda::gstexture::unmap_all(textures);
+	if (res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+
+	// The encoder may read the frame from a different stream, so wait for the copies to finish.
+	_stream->synchronize();
+}
@@ -0,0 +1,63 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "base.hpp"
+#include "nvidia/cuda/nvidia-cuda-context.hpp"
+#include "nvidia/cuda/nvidia-cuda-gs-texture.hpp"
+#include "nvidia/cuda/nvidia-cuda-stream.hpp"
+#include "nvidia/cuda/nvidia-cuda.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <memory>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::ffmpeg::hwapi {
+	class cuda : public streamfx::ffmpeg::hwapi::base {
+		std::shared_ptr<::streamfx::nvidia::cuda::cuda> _cuda;
+
+		public:
+		cuda();
+		virtual ~cuda();
+
+		virtual std::list<hwapi::device> enumerate_adapters() override;
+
+		virtual std::shared_ptr<hwapi::instance> create(const hwapi::device& target) override;
+
+		virtual std::shared_ptr<hwapi::instance> create_from_obs() override;
+	};
+
+	class cuda_instance : public streamfx::ffmpeg::hwapi::instance {
+		std::shared_ptr<::streamfx::nvidia::cuda::cuda>    _cuda;
+		std::shared_ptr<::streamfx::nvidia::cuda::context> _context;
+		std::shared_ptr<::streamfx::nvidia::cuda::stream>  _stream;
+
+		std::map<gs_texture_t*, std::shared_ptr<::streamfx::nvidia::cuda::gstexture>> _textures;
+
+		public:
+		cuda_instance(std::shared_ptr<::streamfx::nvidia::cuda::context> context, std::shared_ptr<::streamfx::nvidia::cuda::stream> stream);
+		virtual ~cuda_instance();
+
+		virtual AVBufferRef* create_device_context() override;
+
+		virtual AVPixelFormat get_pixel_format() override;
+
+		virtual std::shared_ptr<AVFrame> allocate_frame(AVBufferRef* frames) override;
+
+		virtual void prepare_frames(AVBufferRef* frames, uint32_t input_width, uint32_t input_height) override;
+
+		virtual void copy_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame) override;
+
+		virtual std::shared_ptr<AVFrame> avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key) override;
+
+		/** Copy one texture per plane from libOBS into a CUDA frame without leaving the GPU.
+		 *
+		 * Textures stay registered with CUDA until the instance is destroyed, as libOBS reuses them every frame.
+		 */
+		void copy_from_textures(std::vector<std::shared_ptr<::streamfx::obs::gs::texture>> const& planes, std::shared_ptr<AVFrame> frame);
+	};
+} // namespace streamfx::ffmpeg::hwapi
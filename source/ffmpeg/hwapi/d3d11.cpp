@@ -10,6 +10,7 @@
 
 #include "warning-disable.hpp"
 #include <sstream>
+#include <utility>
 #include <vector>
 #include "warning-enable.hpp"
 
@@ -21,6 +22,12 @@ extern "C" {
 
 using namespace streamfx::ffmpeg::hwapi;
 
+// libOBS cycles through a few shared textures per encoder, this leaves room for a video reset.
+constexpr std::size_t max_shared_textures = 8;
+
+// FFmpeg pools a few dozen frames at most, anything beyond that is left over from an older pool.
+constexpr std::size_t max_output_views = 64;
+
 d3d11::d3d11() : _dxgi_module(0), _d3d11_module(0)
 {
 	_dxgi_module = LoadLibraryW(L"dxgi.dll");
@@ -128,7 +135,7 @@ struct D3D11AVFrame {
 	ATL::CComPtr<ID3D11Texture2D> handle;
 };
 
-d3d11_instance::d3d11_instance(ATL::CComPtr<ID3D11Device> device) : _device(device)
+d3d11_instance::d3d11_instance(ATL::CComPtr<ID3D11Device> device) : _device(device), _processor_input(), _processor_output()
 {
 	// Acquire immediate rendering context.
 	device->GetImmediateContext(&_context);
@@ -136,6 +143,8 @@ d3d11_instance::d3d11_instance(ATL::CComPtr<ID3D11Device> device) : _device(devi
 
 d3d11_instance::~d3d11_instance()
 {
+	_processor_views.clear();
+	_shared.clear();
 	//_context.Release(); // Automatically performed by ATL::CComPtr.
 }
 
@@ -164,6 +173,11 @@ AVBufferRef* d3d11_instance::create_device_context()
 	return dctx_ref;
 }
 
+AVPixelFormat d3d11_instance::get_pixel_format()
+{
+	return AV_PIX_FMT_D3D11;
+}
+
 std::shared_ptr<AVFrame> d3d11_instance::allocate_frame(AVBufferRef* frames)
 {
 	auto gctx = streamfx::obs::gs::context();
@@ -182,45 +196,176 @@ std::shared_ptr<AVFrame> d3d11_instance::allocate_frame(AVBufferRef* frames)
 	return frame;
 }
 
-void d3d11_instance::copy_from_obs(AVBufferRef*, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame)
+void d3d11_instance::prepare_frames(AVBufferRef* frames, uint32_t input_width, uint32_t input_height)
 {
-	auto gctx = streamfx::obs::gs::context();
+	AVHWFramesContext* ctx = reinterpret_cast<AVHWFramesContext*>(frames->data);
+	if ((static_cast<uint32_t>(ctx->width) == input_width) && (static_cast<uint32_t>(ctx->height) == input_height)) {
+		return;
+	}
+
+	// The video processor can only write into frames it may render to.
+	AVD3D11VAFramesContext* frames_hwctx = reinterpret_cast<AVD3D11VAFramesContext*>(ctx->hwctx);
+	frames_hwctx->BindFlags |= D3D11_BIND_RENDER_TARGET;
+}
+
+d3d11_instance::shared_texture& d3d11_instance::open_shared(uint32_t handle)
+{
+	if (auto iter = _shared.find(handle); iter != _shared.end()) {
+		return iter->second;
+	}
+
+	// libOBS rotates through a handful of textures, so anything beyond that is left over from a video reset.
+	if (_shared.size() >= max_shared_textures) {
+		_shared.clear();
+	}
 
 	// Attempt to acquire shared texture.
-	ATL::CComPtr<ID3D11Texture2D> input;
-	if (FAILED(_device->OpenSharedResource(reinterpret_cast<HANDLE>(static_cast<uintptr_t>(handle)), __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&input)))) {
+	shared_texture entry;
+	if (FAILED(_device->OpenSharedResource(reinterpret_cast<HANDLE>(static_cast<uintptr_t>(handle)), __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&entry.texture)))) {
 		throw std::runtime_error("Failed to open shared texture resource.");
 	}
 
 	// Attempt to acquire texture mutex.
-	ATL::CComPtr<IDXGIKeyedMutex> mutex;
-	if (FAILED(input->QueryInterface(__uuidof(IDXGIKeyedMutex), reinterpret_cast<void**>(&mutex)))) {
+	if (FAILED(entry.texture->QueryInterface(__uuidof(IDXGIKeyedMutex), reinterpret_cast<void**>(&entry.mutex)))) {
 		throw std::runtime_error("Failed to retrieve mutex for texture resource.");
 	}
 
+	// The texture is only ever copied from, so keep it resident for as long as it is cached.
+	entry.texture->SetEvictionPriority(DXGI_RESOURCE_PRIORITY_MAXIMUM);
+
+	return _shared.emplace(handle, std::move(entry)).first->second;
+}
+
+void d3d11_instance::copy_from_obs(AVBufferRef*, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	auto& input = open_shared(handle);
+
 	// Attempt to acquire texture lock.
-	if (FAILED(mutex->AcquireSync(lock_key, 1000))) {
+	if (HRESULT hr = input.mutex->AcquireSync(lock_key, 1000); hr != S_OK) {
+		// The cached texture may have been replaced, so open it again next time.
+		_shared.erase(handle);
 		throw std::runtime_error("Failed to acquire lock on input texture.");
 	}
 
-	// Set some parameters on the input texture, and get its description.
-	UINT evict = input->GetEvictionPriority();
-	input->SetEvictionPriority(DXGI_RESOURCE_PRIORITY_MAXIMUM);
-
-	// Clone the content of the input texture.
-	_context->CopyResource(reinterpret_cast<ID3D11Texture2D*>(frame->data[0]), input);
-
-	// Restore original parameters on input.
-	input->SetEvictionPriority(evict);
+	// Queue a copy of the input texture, which the GPU runs while the encoder works on older frames. If the encoder
+	// wants a different size, it is scaled on the way instead, so the frame never has to leave the GPU.
+	auto                 output = reinterpret_cast<ID3D11Texture2D*>(frame->data[0]);
+	D3D11_TEXTURE2D_DESC input_desc;
+	D3D11_TEXTURE2D_DESC output_desc;
+	input.texture->GetDesc(&input_desc);
+	output->GetDesc(&output_desc);
+	if ((input_desc.Width == output_desc.Width) && (input_desc.Height == output_desc.Height)) {
+		_context->CopyResource(output, input.texture);
+	} else {
+		try {
+			scale(input, output, static_cast<UINT>(reinterpret_cast<intptr_t>(frame->data[1])));
+		} catch (...) {
+			input.mutex->ReleaseSync(lock_key);
+			throw;
+		}
+	}
 
 	// Release the acquired lock.
-	if (FAILED(mutex->ReleaseSync(lock_key))) {
+	if (FAILED(input.mutex->ReleaseSync(lock_key))) {
 		throw std::runtime_error("Failed to release lock on input texture.");
 	}
 
 	// Release the lock on the next texture.
 	// TODO: Determine if this is necessary.
-	mutex->ReleaseSync(*next_lock_key);
+	input.mutex->ReleaseSync(*next_lock_key);
+}
+
+void d3d11_instance::scale(shared_texture& input, ID3D11Texture2D* output, UINT index)
+{
+	D3D11_TEXTURE2D_DESC input_desc;
+	D3D11_TEXTURE2D_DESC output_desc;
+	input.texture->GetDesc(&input_desc);
+	output->GetDesc(&output_desc);
+
+	if (!_video_device) {
+		if (FAILED(_device->QueryInterface(__uuidof(ID3D11VideoDevice), reinterpret_cast<void**>(&_video_device))) || FAILED(_context->QueryInterface(__uuidof(ID3D11VideoContext), reinterpret_cast<void**>(&_video_context)))) {
+			_video_device.Release();
+			throw std::runtime_error("Device does not support video processing, which is required for scaling.");
+		}
+	}
+
+	// Only recreated if the video output or the encoder size changed.
+	std::pair<UINT, UINT> input_size{input_desc.Width, input_desc.Height};
+	std::pair<UINT, UINT> output_size{output_desc.Width, output_desc.Height};
+	if (!_processor || (_processor_input != input_size) || (_processor_output != output_size)) {
+		_processor_views.clear();
+		for (auto& kv : _shared) {
+			kv.second.view.Release();
+		}
+		_processor.Release();
+		_processor_enum.Release();
+
+		D3D11_VIDEO_PROCESSOR_CONTENT_DESC content = {};
+		content.InputFrameFormat                   = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+		content.InputWidth                         = input_desc.Width;
+		content.InputHeight                        = input_desc.Height;
+		content.OutputWidth                        = output_desc.Width;
+		content.OutputHeight                       = output_desc.Height;
+		content.Usage                              = D3D11_VIDEO_USAGE_OPTIMAL_QUALITY;
+		if (FAILED(_video_device->CreateVideoProcessorEnumerator(&content, &_processor_enum))) {
+			throw std::runtime_error("Failed to create video processor enumerator.");
+		}
+		if (FAILED(_video_device->CreateVideoProcessor(_processor_enum, 0, &_processor))) {
+			throw std::runtime_error("Failed to create video processor.");
+		}
+
+		// Input and output share the format and color space, so this only ever scales.
+		RECT input_rect  = {0, 0, static_cast<LONG>(input_desc.Width), static_cast<LONG>(input_desc.Height)};
+		RECT output_rect = {0, 0, static_cast<LONG>(output_desc.Width), static_cast<LONG>(output_desc.Height)};
+		_video_context->VideoProcessorSetStreamFrameFormat(_processor, 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+		_video_context->VideoProcessorSetStreamAutoProcessingMode(_processor, 0, FALSE);
+		_video_context->VideoProcessorSetStreamSourceRect(_processor, 0, TRUE, &input_rect);
+		_video_context->VideoProcessorSetStreamDestRect(_processor, 0, TRUE, &output_rect);
+		_video_context->VideoProcessorSetOutputTargetRect(_processor, TRUE, &output_rect);
+
+		_processor_input  = input_size;
+		_processor_output = output_size;
+	}
+
+	if (!input.view) {
+		D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC desc = {};
+		desc.ViewDimension                         = D3D11_VPIV_DIMENSION_TEXTURE2D;
+		if (FAILED(_video_device->CreateVideoProcessorInputView(input.texture, _processor_enum, &desc, &input.view))) {
+			throw std::runtime_error("Failed to create video processor input view.");
+		}
+	}
+
+	auto key  = std::make_pair(output, index);
+	auto view = _processor_views.find(key);
+	if (view == _processor_views.end()) {
+		if (_processor_views.size() >= max_output_views) {
+			_processor_views.clear();
+		}
+
+		D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC desc = {};
+		if (output_desc.ArraySize > 1) {
+			desc.ViewDimension                  = D3D11_VPOV_DIMENSION_TEXTURE2DARRAY;
+			desc.Texture2DArray.FirstArraySlice = index;
+			desc.Texture2DArray.ArraySize       = 1;
+		} else {
+			desc.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+		}
+
+		ATL::CComPtr<ID3D11VideoProcessorOutputView> output_view;
+		if (FAILED(_video_device->CreateVideoProcessorOutputView(output, _processor_enum, &desc, &output_view))) {
+			throw std::runtime_error("Failed to create video processor output view.");
+		}
+		view = _processor_views.emplace(key, output_view).first;
+	}
+
+	D3D11_VIDEO_PROCESSOR_STREAM stream = {};
+	stream.Enable                       = TRUE;
+	stream.pInputSurface                = input.view;
+	if (FAILED(_video_context->VideoProcessorBlt(_processor, view->second, 0, 1, &stream))) {
+		throw std::runtime_error("Failed to scale input texture.");
+	}
 }
 
 std::shared_ptr<AVFrame> d3d11_instance::avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key)
@@ -11,6 +11,7 @@
 #include <d3d11.h>
 #include <d3d11_1.h>
 #include <dxgi.h>
+#include <map>
 #include "warning-enable.hpp"
 
 namespace streamfx::ffmpeg::hwapi {
@@ -40,17 +41,42 @@ namespace streamfx::ffmpeg::hwapi {
 	};
 
 	class d3d11_instance : public streamfx::ffmpeg::hwapi::instance {
+		struct shared_texture {
+			ATL::CComPtr<ID3D11Texture2D>                texture;
+			ATL::CComPtr<IDXGIKeyedMutex>                mutex;
+			ATL::CComPtr<ID3D11VideoProcessorInputView> view; // Only created once it has to be scaled.
+		};
+
 		ATL::CComPtr<ID3D11Device>        _device;
 		ATL::CComPtr<ID3D11DeviceContext> _context;
 
+		std::map<uint32_t, shared_texture> _shared;
+
+		// Scaling with the video processor of the driver, for encoders with a different size than the video output.
+		ATL::CComPtr<ID3D11VideoDevice>                                                           _video_device;
+		ATL::CComPtr<ID3D11VideoContext>                                                          _video_context;
+		ATL::CComPtr<ID3D11VideoProcessorEnumerator>                                              _processor_enum;
+		ATL::CComPtr<ID3D11VideoProcessor>                                                        _processor;
+		std::pair<UINT, UINT>                                                                     _processor_input;
+		std::pair<UINT, UINT>                                                                     _processor_output;
+		std::map<std::pair<ID3D11Texture2D*, UINT>, ATL::CComPtr<ID3D11VideoProcessorOutputView>> _processor_views;
+
+		shared_texture& open_shared(uint32_t handle);
+
+		void scale(shared_texture& input, ID3D11Texture2D* output, UINT index);
+
 		public:
 		d3d11_instance(ATL::CComPtr<ID3D11Device> device);
 		virtual ~d3d11_instance();
 
 		virtual AVBufferRef* create_device_context() override;
 
+		virtual AVPixelFormat get_pixel_format() override;
+
 		virtual std::shared_ptr<AVFrame> allocate_frame(AVBufferRef* frames) override;
 
+		virtual void prepare_frames(AVBufferRef* frames, uint32_t input_width, uint32_t input_height) override;
+
 		virtual void copy_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame) override;
 
 		virtual std::shared_ptr<AVFrame> avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key) override;
@@ -0,0 +1,266 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "sample-convert.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <emmintrin.h>
+#elif defined(D_PLATFORM_INSTR_ARM)
+#include <arm_neon.h>
+#endif
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+// Least lossy first, and planar before interleaved as that is what OBS hands us.
+static constexpr AVSampleFormat preferred_formats[] = {
+	AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S32, AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S16,
+};
+
+// 2^31 itself does not fit into a 32-bit integer, this is the largest float below it.
+static constexpr float s32_max = 2147483520.f;
+
+static inline int16_t quantize_s16(float v)
+{
+	return static_cast<int16_t>(std::min(std::lrint(std::clamp(v, -1.f, 1.f) * 32768.f), 32767l));
+}
+
+static inline int32_t quantize_s32(float v)
+{
+	return static_cast<int32_t>(std::lrint(std::min(std::max(v, -1.f) * 2147483648.f, s32_max)));
+}
+
+#if defined(D_PLATFORM_INSTR_X86)
+static inline __m128i quantize_s32x4(__m128 v)
+{
+	return _mm_cvtps_epi32(_mm_min_ps(_mm_mul_ps(_mm_max_ps(v, _mm_set1_ps(-1.f)), _mm_set1_ps(2147483648.f)), _mm_set1_ps(s32_max)));
+}
+
+static inline __m128i quantize_s16x8(const float* from)
+{
+	// Packing saturates, so scaling by 2^15 is safe once the input is within [-1, 1].
+	__m128 lo = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(from), _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+	__m128 hi = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(from + 4), _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+	return _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(lo, _mm_set1_ps(32768.f))), _mm_cvtps_epi32(_mm_mul_ps(hi, _mm_set1_ps(32768.f))));
+}
+#elif defined(D_PLATFORM_INSTR_ARM)
+static inline int32x4_t round_s32x4(float32x4_t v)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return vcvtnq_s32_f32(v);
+#else
+	// ARMv7 only truncates, so round half away from zero instead of to even.
+	return vcvtq_s32_f32(vaddq_f32(v, vbslq_f32(vdupq_n_u32(0x80000000), v, vdupq_n_f32(.5f))));
+#endif
+}
+
+static inline int32x4_t quantize_s32x4(float32x4_t v)
+{
+	// Conversion saturates on ARM, so only the lower bound needs clamping.
+	return round_s32x4(vmulq_f32(vmaxq_f32(v, vdupq_n_f32(-1.f)), vdupq_n_f32(2147483648.f)));
+}
+
+static inline int16x8_t quantize_s16x8(const float* from)
+{
+	float32x4_t lo = vmaxq_f32(vminq_f32(vld1q_f32(from), vdupq_n_f32(1.f)), vdupq_n_f32(-1.f));
+	float32x4_t hi = vmaxq_f32(vminq_f32(vld1q_f32(from + 4), vdupq_n_f32(1.f)), vdupq_n_f32(-1.f));
+	return vcombine_s16(vqmovn_s32(round_s32x4(vmulq_f32(lo, vdupq_n_f32(32768.f)))), vqmovn_s32(round_s32x4(vmulq_f32(hi, vdupq_n_f32(32768.f)))));
+}
+#endif
+
+static void planar_s16(int16_t* to, const float* from, size_t samples)
+{
+	size_t idx = 0;
+#if defined(D_PLATFORM_INSTR_X86)
+	for (; (idx + 8) <= samples; idx += 8) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(to + idx), quantize_s16x8(from + idx));
+	}
+#elif defined(D_PLATFORM_INSTR_ARM)
+	for (; (idx + 8) <= samples; idx += 8) {
+		vst1q_s16(to + idx, quantize_s16x8(from + idx));
+	}
+#endif
+	for (; idx < samples; idx++) {
+		to[idx] = quantize_s16(from[idx]);
+	}
+}
+
+static void planar_s32(int32_t* to, const float* from, size_t samples)
+{
+	size_t idx = 0;
+#if defined(D_PLATFORM_INSTR_X86)
+	for (; (idx + 4) <= samples; idx += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(to + idx), quantize_s32x4(_mm_loadu_ps(from + idx)));
+	}
+#elif defined(D_PLATFORM_INSTR_ARM)
+	for (; (idx + 4) <= samples; idx += 4) {
+		vst1q_s32(to + idx, quantize_s32x4(vld1q_f32(from + idx)));
+	}
+#endif
+	for (; idx < samples; idx++) {
+		to[idx] = quantize_s32(from[idx]);
+	}
+}
+
+static void stereo_flt(float* to, const float* left, const float* right, size_t samples)
+{
+	size_t idx = 0;
+#if defined(D_PLATFORM_INSTR_X86)
+	for (; (idx + 4) <= samples; idx += 4) {
+		__m128 l = _mm_loadu_ps(left + idx);
+		__m128 r = _mm_loadu_ps(right + idx);
+		_mm_storeu_ps(to + idx * 2, _mm_unpacklo_ps(l, r));
+		_mm_storeu_ps(to + idx * 2 + 4, _mm_unpackhi_ps(l, r));
+	}
+#elif defined(D_PLATFORM_INSTR_ARM)
+	for (; (idx + 4) <= samples; idx += 4) {
+		vst2q_f32(to + idx * 2, float32x4x2_t{{vld1q_f32(left + idx), vld1q_f32(right + idx)}});
+	}
+#endif
+	for (; idx < samples; idx++) {
+		to[idx * 2]     = left[idx];
+		to[idx * 2 + 1] = right[idx];
+	}
+}
+
+static void stereo_s16(int16_t* to, const float* left, const float* right, size_t samples)
+{
+	size_t idx = 0;
+#if defined(D_PLATFORM_INSTR_X86)
+	for (; (idx + 8) <= samples; idx += 8) {
+		__m128i l = quantize_s16x8(left + idx);
+		__m128i r = quantize_s16x8(right + idx);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(to + idx * 2), _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(to + idx * 2 + 8), _mm_unpackhi_epi16(l, r));
+	}
+#elif defined(D_PLATFORM_INSTR_ARM)
+	for (; (idx + 8) <= samples; idx += 8) {
+		vst2q_s16(to + idx * 2, int16x8x2_t{{quantize_s16x8(left + idx), quantize_s16x8(right + idx)}});
+	}
+#endif
+	for (; idx < samples; idx++) {
+		to[idx * 2]     = quantize_s16(left[idx]);
+		to[idx * 2 + 1] = quantize_s16(right[idx]);
+	}
+}
+
+static void stereo_s32(int32_t* to, const float* left, const float* right, size_t samples)
+{
+	size_t idx = 0;
+#if defined(D_PLATFORM_INSTR_X86)
+	for (; (idx + 4) <= samples; idx += 4) {
+		__m128i l = quantize_s32x4(_mm_loadu_ps(left + idx));
+		__m128i r = quantize_s32x4(_mm_loadu_ps(right + idx));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(to + idx * 2), _mm_unpacklo_epi32(l, r));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(to + idx * 2 + 4), _mm_unpackhi_epi32(l, r));
+	}
+#elif defined(D_PLATFORM_INSTR_ARM)
+	for (; (idx + 4) <= samples; idx += 4) {
+		vst2q_s32(to + idx * 2, int32x4x2_t{{quantize_s32x4(vld1q_f32(left + idx)), quantize_s32x4(vld1q_f32(right + idx))}});
+	}
+#endif
+	for (; idx < samples; idx++) {
+		to[idx * 2]     = quantize_s32(left[idx]);
+		to[idx * 2 + 1] = quantize_s32(right[idx]);
+	}
+}
+
+template<typename T, T (*Quantize)(float)>
+static void interleave(T* to, const float* const* from, size_t channels, size_t samples)
+{
+	for (size_t idx = 0; idx < samples; idx++) {
+		for (size_t ch = 0; ch < channels; ch++) {
+			to[idx * channels + ch] = Quantize(from[ch][idx]);
+		}
+	}
+}
+
+static inline float passthrough(float v)
+{
+	return v;
+}
+
+AVSampleFormat sample_convert::get_best_format(const AVSampleFormat* formats)
+{
+	if (!formats) {
+		return AV_SAMPLE_FMT_FLTP;
+	}
+
+	for (auto preferred : preferred_formats) {
+		for (auto format = formats; *format != AV_SAMPLE_FMT_NONE; format++) {
+			if (*format == preferred) {
+				return preferred;
+			}
+		}
+	}
+	return AV_SAMPLE_FMT_NONE;
+}
+
+bool sample_convert::is_supported(AVSampleFormat format)
+{
+	return std::find(std::begin(preferred_formats), std::end(preferred_formats), format) != std::end(preferred_formats);
+}
+
+void sample_convert::convert(AVFrame* frame, const uint8_t* const* planes, size_t channels, size_t samples)
+{
+	auto         format = static_cast<AVSampleFormat>(frame->format);
+	uint8_t**    to     = frame->extended_data;
+	size_t       count  = std::min<size_t>(channels, AV_NUM_DATA_POINTERS);
+	const float* from[AV_NUM_DATA_POINTERS];
+	for (size_t ch = 0; ch < count; ch++) {
+		from[ch] = reinterpret_cast<const float*>(planes[ch]);
+	}
+
+	// A single channel is laid out the same either way.
+	if ((count == 1) && !av_sample_fmt_is_planar(format)) {
+		format = av_get_planar_sample_fmt(format);
+	}
+
+	switch (format) {
+	case AV_SAMPLE_FMT_FLTP:
+		for (size_t ch = 0; ch < count; ch++) {
+			std::memcpy(to[ch], from[ch], samples * sizeof(float));
+		}
+		break;
+	case AV_SAMPLE_FMT_S16P:
+		for (size_t ch = 0; ch < count; ch++) {
+			planar_s16(reinterpret_cast<int16_t*>(to[ch]), from[ch], samples);
+		}
+		break;
+	case AV_SAMPLE_FMT_S32P:
+		for (size_t ch = 0; ch < count; ch++) {
+			planar_s32(reinterpret_cast<int32_t*>(to[ch]), from[ch], samples);
+		}
+		break;
+	case AV_SAMPLE_FMT_FLT:
+		if (count == 2) {
+			stereo_flt(reinterpret_cast<float*>(to[0]), from[0], from[1], samples);
+		} else {
+			interleave<float, passthrough>(reinterpret_cast<float*>(to[0]), from, count, samples);
+		}
+		break;
+	case AV_SAMPLE_FMT_S16:
+		if (count == 2) {
+			stereo_s16(reinterpret_cast<int16_t*>(to[0]), from[0], from[1], samples);
+		} else {
+			interleave<int16_t, quantize_s16>(reinterpret_cast<int16_t*>(to[0]), from, count, samples);
+		}
+		break;
+	case AV_SAMPLE_FMT_S32:
+		if (count == 2) {
+			stereo_s32(reinterpret_cast<int32_t*>(to[0]), from[0], from[1], samples);
+		} else {
+			interleave<int32_t, quantize_s32>(reinterpret_cast<int32_t*>(to[0]), from, count, samples);
+		}
+		break;
+	default:
+		throw std::invalid_argument("Unsupported sample format.");
+	}
+}
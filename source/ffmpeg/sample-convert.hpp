@@ -0,0 +1,35 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg::sample_convert {
+	/** Pick the least lossy format from 'formats' that convert() can produce, or AV_SAMPLE_FMT_NONE if there is none.
+	 *
+	 * A missing list means the encoder takes anything, in which case OBS's own planar float is used as is.
+	 */
+	AVSampleFormat get_best_format(const AVSampleFormat* formats);
+
+	bool is_supported(AVSampleFormat format);
+
+	/** Convert planar float samples, as OBS delivers them, into the format of 'frame'.
+	 *
+	 * Covers planar and interleaved float, 16-bit and 32-bit integer samples, which is everything the usual audio
+	 * encoders ask for. Mono and stereo, and any planar format, use SIMD where the CPU has it.
+	 */
+	void convert(AVFrame* frame, const uint8_t* const* planes, size_t channels, size_t samples);
+} // namespace streamfx::ffmpeg::sample_convert
@@ -0,0 +1,77 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "scene-detector.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdlib>
+#include <cstring>
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+// Only every n-th pixel of every n-th row is looked at, which is plenty for a histogram.
+constexpr int32_t sample_step = 8;
+
+scene_detector::scene_detector(double threshold, std::size_t distance) : _histogram(), _samples(0), _valid(false), _threshold(threshold), _distance(distance), _frames(0) {}
+
+scene_detector::~scene_detector() = default;
+
+bool scene_detector::is_cut(AVPixelFormat format, const uint8_t* data, size_t stride, int32_t width, int32_t height)
+{
+	const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+	if (!desc || !data || (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL)) || (desc->nb_components < 3)) {
+		return false;
+	}
+
+	auto const& luma  = desc->comp[0];
+	int32_t     shift = static_cast<int32_t>(luma.shift) + static_cast<int32_t>(luma.depth) - 6;
+
+	std::array<uint32_t, 64> histogram = {};
+	uint32_t                 samples   = 0;
+	for (int32_t y = sample_step / 2; y < height; y += sample_step) {
+		const uint8_t* row = data + stride * static_cast<size_t>(y) + luma.offset;
+		for (int32_t x = sample_step / 2; x < width; x += sample_step) {
+			const uint8_t* ptr = row + static_cast<size_t>(x) * static_cast<size_t>(luma.step);
+			uint32_t       value;
+			if (luma.depth > 8) {
+				uint16_t v16;
+				std::memcpy(&v16, ptr, sizeof(v16));
+				value = v16;
+			} else {
+				value = *ptr;
+			}
+			histogram[(shift >= 0 ? (value >> shift) : (value << -shift)) & 63]++;
+			samples++;
+		}
+	}
+
+	_frames++;
+
+	bool cut = false;
+	if (_valid && (samples == _samples) && (samples > 0) && (_frames >= _distance)) {
+		// Half the L1 distance of two normalized histograms is the fraction of pixels that moved to another bin.
+		uint64_t difference = 0;
+		for (std::size_t idx = 0; idx < histogram.size(); idx++) {
+			difference += static_cast<uint64_t>(std::abs(static_cast<int64_t>(histogram[idx]) - static_cast<int64_t>(_histogram[idx])));
+		}
+		cut = (static_cast<double>(difference) / (2. * samples)) >= _threshold;
+	}
+
+	_histogram = histogram;
+	_samples   = samples;
+	_valid     = true;
+	if (cut) {
+		_frames = 0;
+	}
+	return cut;
+}
+
+void scene_detector::reset()
+{
+	_frames = 0;
+}
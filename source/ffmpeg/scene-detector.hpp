@@ -0,0 +1,48 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/pixfmt.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	/** Detects hard cuts between frames by comparing luma histograms of a sparse grid of pixels.
+	 */
+	class scene_detector {
+		std::array<uint32_t, 64> _histogram;
+		uint32_t                 _samples;
+		bool                     _valid;
+
+		double      _threshold;
+		std::size_t _distance;
+		std::size_t _frames;
+
+		public:
+		/**
+		 * @param threshold Fraction of the histogram (0..1) that has to change for a frame to count as a cut.
+		 * @param distance Minimum number of frames between two cuts, so that flashes don't cause a flood of keyframes.
+		 */
+		scene_detector(double threshold, std::size_t distance);
+		~scene_detector();
+
+		/** Analyse the luma plane of a frame and tell whether it starts a new scene.
+		 *
+		 * Formats without a luma plane never report a cut.
+		 */
+		bool is_cut(AVPixelFormat format, const uint8_t* data, size_t stride, int32_t width, int32_t height);
+
+		/** Tell the detector that a keyframe was placed for other reasons, which restarts the minimum distance.
+		 */
+		void reset();
+	};
+} // namespace streamfx::ffmpeg
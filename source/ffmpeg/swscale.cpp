@@ -4,11 +4,26 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "swscale.hpp"
+#include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <atomic>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/pixdesc.h>
+#include "warning-enable.hpp"
+}
+
+// Height of bands must be a multiple of this, which covers all subsampled formats.
+constexpr int32_t band_alignment = 16;
+
+// swscale never looks at more than this many planes.
+constexpr std::size_t max_planes = 4;
+
 using namespace streamfx::ffmpeg;
 
 swscale::swscale() = default;
@@ -144,6 +159,16 @@ bool swscale::is_target_full_range()
 	return this->target_full_range;
 }
 
+void swscale::set_threads(std::size_t value)
+{
+	this->threads = std::max<std::size_t>(value, 1);
+}
+
+std::size_t swscale::get_threads()
+{
+	return this->threads;
+}
+
 bool swscale::initialize(int flags)
 {
 	if (this->context) {
@@ -156,18 +181,60 @@ bool swscale::initialize(int flags)
 		throw std::invalid_argument("not all target parameters were set");
 	}
 
-	this->context = sws_getContext(static_cast<int>(source_size.first), static_cast<int>(source_size.second), source_format, static_cast<int>(target_size.first), static_cast<int>(target_size.second), target_format, flags, nullptr, nullptr, nullptr);
+	this->context = create_context(source_size.second, flags);
 	if (!this->context) {
 		return false;
 	}
 
-	sws_setColorspaceDetails(this->context, sws_getCoefficients(source_colorspace), source_full_range ? 1 : 0, sws_getCoefficients(target_colorspace), target_full_range ? 1 : 0, 1L << 16 | 0L, 1L << 16 | 0L, 1L << 16 | 0L);
+	// Bands are only possible without vertical scaling, and must not split subsampled chroma rows.
+	if ((threads > 1) && (source_size == target_size)) {
+		int32_t height = static_cast<int32_t>(source_size.second);
+		int32_t align  = band_alignment;
+		int32_t band   = ((height / static_cast<int32_t>(threads)) + align - 1) / align * align;
+		if (band >= align) {
+			for (int32_t row = 0; row < height; row += band) {
+				int32_t rows = std::min(band, height - row);
+				if (SwsContext* ctx = create_context(static_cast<uint32_t>(rows), flags); ctx) {
+					bands.emplace_back(row, rows);
+					band_contexts.push_back(ctx);
+				} else {
+					finalize_bands();
+					break;
+				}
+			}
+			if (bands.size() <= 1) {
+				finalize_bands();
+			}
+		}
+	}
 
 	return true;
 }
 
+SwsContext* swscale::create_context(uint32_t height, int flags)
+{
+	SwsContext* ctx = sws_getContext(static_cast<int>(source_size.first), static_cast<int>(height), source_format, static_cast<int>(target_size.first), static_cast<int>(height * target_size.second / source_size.second), target_format, flags, nullptr, nullptr, nullptr);
+	if (!ctx) {
+		return nullptr;
+	}
+
+	sws_setColorspaceDetails(ctx, sws_getCoefficients(source_colorspace), source_full_range ? 1 : 0, sws_getCoefficients(target_colorspace), target_full_range ? 1 : 0, 1L << 16 | 0L, 1L << 16 | 0L, 1L << 16 | 0L);
+
+	return ctx;
+}
+
+void swscale::finalize_bands()
+{
+	for (auto ctx : band_contexts) {
+		sws_freeContext(ctx);
+	}
+	band_contexts.clear();
+	bands.clear();
+}
+
 bool swscale::finalize()
 {
+	finalize_bands();
 	if (this->context) {
 		sws_freeContext(this->context);
 		this->context = nullptr;
@@ -176,11 +243,54 @@ bool swscale::finalize()
 	return false;
 }
 
+template<typename T>
+static void offset_planes(AVPixelFormat format, int32_t row, const int stride[], T* const data[], T* out[])
+{
+	const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+	for (std::size_t plane = 0; plane < max_planes; plane++) {
+		if (!data[plane]) {
+			out[plane] = nullptr;
+			continue;
+		}
+
+		// Only the chroma planes are subsampled, luma and alpha are not.
+		int32_t shift = ((plane == 1) || (plane == 2)) ? desc->log2_chroma_h : 0;
+		out[plane]    = data[plane] + static_cast<ptrdiff_t>(stride[plane]) * (row >> shift);
+	}
+}
+
 int32_t swscale::convert(const uint8_t* const source_data[], const int source_stride[], int32_t source_row, int32_t source_rows, uint8_t* const target_data[], const int target_stride[])
 {
 	if (!this->context) {
 		return 0;
 	}
+
+	// Whole frames are split into bands if possible.
+	if (!band_contexts.empty() && (source_row == 0) && (source_rows == static_cast<int32_t>(source_size.second))) {
+		std::atomic<int32_t>                   total{0};
+		streamfx::util::threadpool::task_group group{streamfx::threadpool()};
+		auto                                   convert_band = [&](std::size_t idx) {
+			const uint8_t* src[max_planes];
+			uint8_t*       dst[max_planes];
+			offset_planes(source_format, bands[idx].first, source_stride, source_data, src);
+			offset_planes(target_format, bands[idx].first, target_stride, target_data, dst);
+
+			int res = sws_scale(band_contexts[idx], src, source_stride, 0, bands[idx].second, dst, target_stride);
+			if (res > 0) {
+				total.fetch_add(res);
+			}
+		};
+
+		// The calling thread converts the first band itself.
+		for (std::size_t idx = 1; idx < band_contexts.size(); idx++) {
+			group.push([&convert_band, idx](streamfx::util::threadpool::task_data_t) { convert_band(idx); }, nullptr, streamfx::util::threadpool::priority::REALTIME);
+		}
+		convert_band(0);
+		group.wait_all();
+
+		return total.load();
+	}
+
 	int height = sws_scale(this->context, source_data, source_stride, source_row, source_rows, target_data, target_stride);
 	return height;
 }
@@ -7,6 +7,7 @@
 
 #include "warning-disable.hpp"
 #include <utility>
+#include <vector>
 #include "warning-enable.hpp"
 
 extern "C" {
@@ -30,6 +31,11 @@ namespace streamfx::ffmpeg {
 
 		SwsContext* context = nullptr;
 
+		// Slice-parallel conversion, one context per band of rows.
+		std::size_t                              threads = 1;
+		std::vector<std::pair<int32_t, int32_t>> bands;
+		std::vector<SwsContext*>                 band_contexts;
+
 		public:
 		swscale();
 		~swscale();
@@ -60,9 +66,22 @@ namespace streamfx::ffmpeg {
 		void                          set_target_full_range(bool full_range);
 		bool                          is_target_full_range();
 
+		/** Split conversions into this many bands of rows, which are converted in parallel on the threadpool.
+		 *
+		 * Only applies if source and target have the same size, and takes effect on the next initialize().
+		 */
+		void        set_threads(std::size_t threads);
+		std::size_t get_threads();
+
 		bool initialize(int flags);
 		bool finalize();
 
+		private:
+		SwsContext* create_context(uint32_t height, int flags);
+		void        finalize_bands();
+
+		public:
+
 		int32_t convert(const uint8_t* const source_data[], const int source_stride[], int32_t source_row, int32_t source_rows, uint8_t* const target_data[], const int target_stride[]);
 	};
 } // namespace streamfx::ffmpeg
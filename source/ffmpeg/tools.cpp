@@ -8,7 +8,12 @@
 
 #include "warning-disable.hpp"
 #include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <vector>
 #include "warning-enable.hpp"
 
 extern "C" {
@@ -185,43 +190,69 @@ AVColorTransferCharacteristic streamfx::ffmpeg::tools::obs_to_av_color_transfer_
 	}
 }
 
+namespace {
+	// AVOption tables are static and belong to their AVClass, so they only need to be walked once per class.
+	struct avoption_index {
+		std::set<std::string_view>                               names;
+		std::map<std::string_view, std::vector<const AVOption*>> units;
+	};
+
+	avoption_index const& get_avoption_index(const void* obj)
+	{
+		static std::mutex                                                lock;
+		static std::map<const AVClass*, std::unique_ptr<avoption_index>> indices;
+
+		const AVClass* cls = *reinterpret_cast<const AVClass* const*>(obj);
+
+		std::unique_lock<std::mutex> ulock(lock);
+		if (auto kv = indices.find(cls); kv != indices.end()) {
+			return *kv->second;
+		}
+
+		auto index = std::make_unique<avoption_index>();
+		for (const AVOption* opt = nullptr; (opt = av_opt_next(obj, opt)) != nullptr;) {
+			index->names.emplace(opt->name);
+
+			// Skip all options that aren't a value of a unit.
+			if (!opt->unit)
+				continue;
+			if (opt->name == std::string_view(opt->unit))
+				continue;
+
+			index->units[opt->unit].push_back(opt);
+		}
+
+		return *indices.emplace(cls, std::move(index)).first->second;
+	}
+} // namespace
+
 const char* tools::avoption_name_from_unit_value(const void* obj, std::string_view unit, int64_t value)
 {
-	for (const AVOption* opt = nullptr; (opt = av_opt_next(obj, opt)) != nullptr;) {
-		// Skip all irrelevant options.
-		if (!opt->unit)
-			continue;
-		if (opt->unit != unit)
-			continue;
-		if (opt->name == unit)
-			continue;
-
-		if (opt->default_val.i64 == value)
-			return opt->name;
+	auto const& index = get_avoption_index(obj);
+	if (auto kv = index.units.find(unit); kv != index.units.end()) {
+		for (auto opt : kv->second) {
+			if (opt->default_val.i64 == value)
+				return opt->name;
+		}
 	}
 	return nullptr;
 }
 
 bool tools::avoption_exists(const void* obj, std::string_view name)
 {
-	for (const AVOption* opt = nullptr; (opt = av_opt_next(obj, opt)) != nullptr;) {
-		if (name == opt->name)
-			return true;
-	}
-	return false;
+	auto const& index = get_avoption_index(obj);
+	return index.names.find(name) != index.names.end();
 }
 
 void tools::avoption_list_add_entries(const void* obj, std::string_view unit, std::function<void(const AVOption*)> inserter)
 {
-	for (const AVOption* opt = nullptr; (opt = av_opt_next(obj, opt)) != nullptr;) {
-		// Skip all irrelevant options.
-		if (!opt->unit)
-			continue;
-		if (opt->unit != unit)
-			continue;
-		if (opt->name == unit)
-			continue;
+	auto const& index = get_avoption_index(obj);
+	auto        kv    = index.units.find(unit);
+	if (kv == index.units.end()) {
+		return;
+	}
 
+	for (auto opt : kv->second) {
 		// Skip any deprecated options.
 		if (opt->flags & AV_OPT_FLAG_DEPRECATED)
 			continue;
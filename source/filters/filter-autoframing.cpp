@@ -4,9 +4,16 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "filter-autoframing.hpp"
+#include "configuration.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -32,15 +39,15 @@
 // The goal is to provide Auto-Framing for single person streams ('Solo') as well as group streams
 // ('Group'), though the latter will only be available if the provider supports it. In 'Solo' mode
 // the filter will perfectly frame a single person, and no more than that. In 'Group' mode, it will
-// combine all important elements into a single frame, and track that instead. In the future, we
-// might want to offer a third mode to give each tracked face a separate frame however this may
-// exceed the intended complexity of this feature entirely.
+// combine all important elements into a single frame, and track that instead. In 'Split' mode, each
+// tracked face gets a separate frame, and all of them are laid out next to each other in the output.
 
 /** Settings
  * Framing
  *   Mode: How should things be tracked?
  *     Solo: Frame only a single face.
  *     Group: Frame many faces, group all into single frame.
+ *     Split: Frame many faces, each into its own column of the output.
  *   Padding: How many pixels/much % of tracked are should be kept
  *   Aspect Ratio: What Aspect Ratio should the framed output have?
  *   Stability: How stable is the framing against changes of tracked elements?
@@ -61,8 +68,14 @@
 #define ST_I18N_TRACKING_MODE ST_I18N_TRACKING ".Mode"
 #define ST_I18N_FRAMING_MODE_SOLO ST_I18N_TRACKING_MODE ".Solo"
 #define ST_I18N_FRAMING_MODE_GROUP ST_I18N_TRACKING_MODE ".Group"
+#define ST_I18N_FRAMING_MODE_SPLIT ST_I18N_TRACKING_MODE ".Split"
 #define ST_KEY_TRACKING_FREQUENCY "Tracking.Frequency"
 #define ST_I18N_TRACKING_FREQUENCY ST_I18N_TRACKING ".Frequency"
+#define ST_KEY_TRACKING_RESOLUTION "Tracking.Resolution"
+#define ST_I18N_TRACKING_RESOLUTION ST_I18N_TRACKING ".Resolution"
+#define ST_I18N_TRACKING_RESOLUTION_FULL ST_I18N_TRACKING_RESOLUTION ".Full"
+#define ST_KEY_TRACKING_ADAPTIVE "Tracking.Adaptive"
+#define ST_I18N_TRACKING_ADAPTIVE ST_I18N_TRACKING ".Adaptive"
 
 #define ST_I18N_MOTION ST_I18N ".Motion"
 #define ST_KEY_MOTION_PREDICTION "Motion.Prediction"
@@ -83,9 +96,19 @@
 #define ST_KEY_ADVANCED_PROVIDER "Provider"
 #define ST_I18N_ADVANCED_PROVIDER ST_I18N ".Provider"
 #define ST_I18N_ADVANCED_PROVIDER_NVIDIA_FACEDETECTION ST_I18N_ADVANCED_PROVIDER ".NVIDIA.FaceDetection"
+#define ST_I18N_ADVANCED_PROVIDER_CPU_FACEDETECTION ST_I18N_ADVANCED_PROVIDER ".CPU.FaceDetection"
 
 #define ST_KALMAN_EEC 1.0f
 
+// Adaptive tracking slows down to this interval (in seconds) while nothing moves, and runs at the configured frequency
+// once the prediction error reaches the given fraction of the element size.
+#define ST_ADAPTIVE_INTERVAL 0.5f
+#define ST_ADAPTIVE_MOTION 0.1f
+
+// The CPU provider reads back at most this many pixels wide, and looks for at most this many faces.
+#define ST_CPU_WIDTH 320
+#define ST_CPU_LIMIT 8
+
 using streamfx::filter::autoframing::autoframing_factory;
 using streamfx::filter::autoframing::autoframing_instance;
 using streamfx::filter::autoframing::tracking_provider;
@@ -94,6 +117,7 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
 
 static tracking_provider provider_priority[] = {
 	tracking_provider::NVIDIA_FACEDETECTION,
+	tracking_provider::CPU_FACEDETECTION,
 };
 
 inline std::pair<bool, double_t> parse_text_as_size(const char* text)
@@ -120,6 +144,8 @@ const char* streamfx::filter::autoframing::cstring(tracking_provider provider)
 		return D_TRANSLATE(S_STATE_AUTOMATIC);
 	case tracking_provider::NVIDIA_FACEDETECTION:
 		return D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_NVIDIA_FACEDETECTION);
+	case tracking_provider::CPU_FACEDETECTION:
+		return D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_CPU_FACEDETECTION);
 	default:
 		throw std::runtime_error("Missing Conversion Entry");
 	}
@@ -134,6 +160,15 @@ autoframing_instance::~autoframing_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
+	_roi->withdraw(this);
+
+	// Wait for any detection still in progress, as it publishes its results here.
+	if (_track_task) {
+		streamfx::threadpool()->pop(_track_task);
+		_track_task->await_completion();
+		_track_task.reset();
+	}
+
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -151,6 +186,9 @@ autoframing_instance::~autoframing_instance()
 			nvar_facedetection_unload();
 			break;
 #endif
+		case tracking_provider::CPU_FACEDETECTION:
+			cpu_facedetection_unload();
+			break;
 		default:
 			break;
 		}
@@ -162,21 +200,25 @@ autoframing_instance::autoframing_instance(obs_data_t* data, obs_source_t* self)
 
 	  _dirty(true), _size(1, 1), _out_size(1, 1),
 
-	  _gfx_debug(), _standard_effect(), _input(), _vb(),
+	  _gfx_debug(), _governor(::streamfx::gfx::governor::instance()), _input(), _detect_input(),
 
 	  _provider(tracking_provider::INVALID), _provider_ui(tracking_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(),
 
-	  _track_mode(tracking_mode::SOLO), _track_frequency(1),
+	  _cpu_fx(), _cpu_input(), _cpu_readback(), _cpu_frame(), _cpu_scale(),
+
+	  _track_mode(tracking_mode::SOLO), _track_frequency(1), _track_resolution(480), _track_adaptive(false), _track_interval(1), _track_motion(1.),
 
 	  _motion_smoothing(0.0), _motion_smoothing_kalman_pnc(1.), _motion_smoothing_kalman_mnc(1.), _motion_prediction(0.0),
 
 	  _frame_stability(0.), _frame_stability_kalman(1.), _frame_padding_prc(), _frame_padding(), _frame_offset_prc(), _frame_offset(), _frame_aspect_ratio(0.0),
 
-	  _track_frequency_counter(0), _tracked_elements(), _predicted_elements(),
+	  _track_frequency_counter(0), _track_task(), _detect_scale(), _detected_elements(), _tracked_next_id(0), _tracked_elements(), _tracked_filter(), _tracked_measurements(),
 
 	  _frame_pos_x({1., 1., 1., 1.}), _frame_pos_y({1., 1., 1., 1.}), _frame_pos({0, 0}), _frame_size({1, 1}),
 
-	  _debug(false)
+	  _split_elements(), _split_filter(), _split_measurements(),
+
+	  _debug(false), _roi(::streamfx::util::roi::channel::instance())
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -189,17 +231,8 @@ autoframing_instance::autoframing_instance(obs_data_t* data, obs_source_t* self)
 		// Create the render target for the input buffering.
 		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
 		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
-
-		// Load the required effect.
-		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
-
-		// Create the Vertex Buffer for rendering.
-		_vb = std::make_shared<::streamfx::obs::gs::vertex_buffer>(uint32_t{4}, uint8_t{1});
-		vec3_set(_vb->at(0).position, 0, 0, 0);
-		vec3_set(_vb->at(1).position, 1, 0, 0);
-		vec3_set(_vb->at(2).position, 0, 1, 0);
-		vec3_set(_vb->at(3).position, 1, 1, 0);
-		_vb->update(true);
+		_detect_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+		_detect_input->render(1, 1);
 	}
 
 	if (data) {
@@ -241,17 +274,17 @@ void autoframing_instance::update(obs_data_t* data)
 		}
 	}
 	_track_frequency_counter = 0;
+	_track_resolution        = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_TRACKING_RESOLUTION), 0));
+	_track_adaptive          = obs_data_get_bool(data, ST_KEY_TRACKING_ADAPTIVE);
+	_track_interval          = _track_frequency;
+	_track_motion            = 1.f;
 
 	// Motion
 	_motion_prediction           = static_cast<float>(obs_data_get_double(data, ST_KEY_MOTION_PREDICTION)) / 100.f;
 	_motion_smoothing            = static_cast<float>(obs_data_get_double(data, ST_KEY_MOTION_SMOOTHING)) / 100.f;
 	_motion_smoothing_kalman_pnc = streamfx::util::math::lerp<float>(1.0f, 0.00001f, _motion_smoothing);
 	_motion_smoothing_kalman_mnc = streamfx::util::math::lerp<float>(0.001f, 1000.0f, _motion_smoothing);
-	for (auto kv : _predicted_elements) {
-		// Regenerate filters.
-		kv.second->filter_pos_x = {_frame_stability_kalman, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, kv.second->filter_pos_x.get()};
-		kv.second->filter_pos_y = {_frame_stability_kalman, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, kv.second->filter_pos_y.get()};
-	}
+	_tracked_filter.configure(_frame_stability_kalman, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC); // Regenerate filters.
 
 	// Framing
 	{ // Smoothing
@@ -262,6 +295,7 @@ void autoframing_instance::update(obs_data_t* data)
 		_frame_pos_y  = {_frame_stability_kalman, 1.0f, ST_KALMAN_EEC, _frame_pos_y.get()};
 		_frame_size_x = {_frame_stability_kalman, 1.0f, ST_KALMAN_EEC, _frame_size_x.get()};
 		_frame_size_y = {_frame_stability_kalman, 1.0f, ST_KALMAN_EEC, _frame_size_y.get()};
+		_split_filter.configure(_frame_stability_kalman, 1.0f, ST_KALMAN_EEC);
 	}
 	{ // Padding
 		if (const char* text = obs_data_get_string(data, ST_KEY_FRAMING_PADDING ".X"); text != nullptr) {
@@ -419,8 +453,14 @@ void autoframing_instance::video_tick(float_t seconds)
 		}
 	}
 
+	// Merge the results of the latest detection, if one finished since the last tick.
+	if (auto detected = std::atomic_exchange(&_detected_elements, std::shared_ptr<std::vector<detect_el>>()); detected) {
+		tracking_merge(*detected);
+	}
+
 	// Update tracking.
 	tracking_tick(seconds);
+	publish_regions();
 
 	// Mark the effect as dirty.
 	_dirty = true;
@@ -443,7 +483,7 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 	// - We don't have a target.
 	// - The width/height of the next filter in the chain is empty.
 	if (!_provider_ready || !target || (width == 0) || (height == 0)) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -453,50 +493,99 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 #endif
 
 	if (_dirty) {
-		// Capture the input.
-		if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
-			auto op = _input->render(width, height);
+		{ // The CPU provider hands frames to the detector a frame after copying them, so it never waits on the GPU.
+			std::unique_lock<std::mutex> ul(_provider_lock);
+			if (_provider == tracking_provider::CPU_FACEDETECTION) {
+				cpu_facedetection_collect();
+			}
+		}
 
-			// Set correct projection matrix.
-			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
+		// The output is drawn straight from the source, so only detection, debug mode and split layouts need a copy of the
+		// input.
+		// Under load, detection runs less often, as the tracking smooths over the gaps anyway.
+		bool detect = (_track_frequency_counter >= (_track_interval * float(1 + _governor->level()))) && (!_track_task || _track_task->is_completed());
 
-			// Clear the buffer
-			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
+		// Capture the input.
+		if (detect || _debug || !_split_elements.empty()) {
+			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+				auto op = _input->render(width, height);
+
+				// Set correct projection matrix.
+				gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
+
+				// Clear the buffer
+				gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
+
+				// Set GPU state
+				gs_blend_state_push();
+				gs_enable_color(true, true, true, true);
+				gs_enable_blending(false);
+				gs_enable_depth_test(false);
+				gs_enable_stencil_test(false);
+				gs_set_cull_mode(GS_NEITHER);
+
+				// Render
+				bool srgb = gs_framebuffer_srgb_enabled();
+				gs_enable_framebuffer_srgb(gs_get_linear_srgb());
+				obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), width, height);
+				gs_enable_framebuffer_srgb(srgb);
+
+				// Reset GPU state
+				gs_blend_state_pop();
+			} else {
+				skip_video_filter();
+				return;
+			}
+		}
 
-			// Set GPU state
-			gs_blend_state_push();
-			gs_enable_color(true, true, true, true);
-			gs_enable_blending(false);
-			gs_enable_depth_test(false);
-			gs_enable_stencil_test(false);
-			gs_set_cull_mode(GS_NEITHER);
+		// Lock & Process the captured input with the provider, unless the previous detection is still running.
+		if (detect) {
+			_track_frequency_counter = 0;
 
-			// Render
-			bool srgb = gs_framebuffer_srgb_enabled();
-			gs_enable_framebuffer_srgb(gs_get_linear_srgb());
-			obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), width, height);
-			gs_enable_framebuffer_srgb(srgb);
+			// Faces are still found reliably at a fraction of the resolution, and the copy and detection get a lot cheaper.
+			auto detect_input = _input->get_texture();
+			if ((_track_resolution > 0) && (height > _track_resolution)) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+				::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Downscale"};
+#endif
 
-			// Reset GPU state
-			gs_blend_state_pop();
-		} else {
-			obs_source_skip_video_filter(_self);
-			return;
-		}
+				uint32_t detect_height = _track_resolution;
+				uint32_t detect_width  = std::max<uint32_t>(static_cast<uint32_t>(std::lround(static_cast<double>(width) * detect_height / height)), 1);
+				{
+					auto op = _detect_input->render(detect_width, detect_height);
+					gs_ortho(0, static_cast<float>(detect_width), 0, static_cast<float>(detect_height), 0, 1);
+
+					gs_blend_state_push();
+					gs_enable_color(true, true, true, true);
+					gs_enable_blending(false);
+					gs_enable_depth_test(false);
+					gs_enable_stencil_test(false);
+					gs_set_cull_mode(GS_NEITHER);
+
+					gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+					gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), detect_input->get_object());
+					while (gs_effect_loop(default_effect, "Draw")) {
+						gs_draw_sprite(nullptr, 0, detect_width, detect_height);
+					}
 
-		// Lock & Process the captured input with the provider.
-		if (_track_frequency_counter >= _track_frequency) {
-			_track_frequency_counter = 0;
+					gs_blend_state_pop();
+				}
+				detect_input = _detect_input->get_texture();
+			}
+			vec2_set(&_detect_scale, static_cast<float>(width) / static_cast<float>(detect_input->get_width()), static_cast<float>(height) / static_cast<float>(detect_input->get_height()));
 
 			std::unique_lock<std::mutex> ul(_provider_lock);
 			switch (_provider) {
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 			case tracking_provider::NVIDIA_FACEDETECTION:
-				nvar_facedetection_process();
+				nvar_facedetection_process(detect_input);
 				break;
 #endif
+			case tracking_provider::CPU_FACEDETECTION:
+				cpu_facedetection_process(detect_input);
+				break;
 			default:
-				obs_source_skip_video_filter(_self);
+				skip_video_filter();
 				return;
 			}
 		}
@@ -515,79 +604,72 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 				gs_draw_sprite(nullptr, 0, _size.first, _size.second);
 			}
 
-			for (auto kv : _predicted_elements) {
+			_gfx_debug->begin_batch();
+			for (size_t idx = 0; idx < _tracked_elements.size(); idx++) {
+				auto const& el = _tracked_elements[idx];
+
 				// Tracked Area (Red)
-				_gfx_debug->draw_rectangle(kv.first->pos.x - kv.first->size.x / 2.f, kv.first->pos.y - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7E0000FF);
+				_gfx_debug->draw_rectangle(el.pos.x - el.size.x / 2.f, el.pos.y - el.size.y / 2.f, el.size.x, el.size.y, true, 0x7E0000FF);
 
 				// Velocity Arrow (Black)
-				_gfx_debug->draw_arrow(kv.first->pos.x, kv.first->pos.y, kv.first->pos.x + kv.first->vel.x, kv.first->pos.y + kv.first->vel.y, 0., 0x7E000000);
+				_gfx_debug->draw_arrow(el.pos.x, el.pos.y, el.pos.x + el.vel.x, el.pos.y + el.vel.y, 0., 0x7E000000);
 
 				// Predicted Area (Orange)
-				_gfx_debug->draw_rectangle(kv.second->mp_pos.x - kv.first->size.x / 2.f, kv.second->mp_pos.y - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7E007EFF);
+				_gfx_debug->draw_rectangle(el.mp_pos.x - el.size.x / 2.f, el.mp_pos.y - el.size.y / 2.f, el.size.x, el.size.y, true, 0x7E007EFF);
 
 				// Filtered Area (Yellow)
-				_gfx_debug->draw_rectangle(kv.second->filter_pos_x.get() - kv.first->size.x / 2.f, kv.second->filter_pos_y.get() - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7E00FFFF);
+				_gfx_debug->draw_rectangle(_tracked_filter.get(idx * 2) - el.size.x / 2.f, _tracked_filter.get(idx * 2 + 1) - el.size.y / 2.f, el.size.x, el.size.y, true, 0x7E00FFFF);
 
 				// Offset Filtered Area (Blue)
-				_gfx_debug->draw_rectangle(kv.second->offset_pos.x - kv.first->size.x / 2.f, kv.second->offset_pos.y - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7EFF0000);
+				_gfx_debug->draw_rectangle(el.offset_pos.x - el.size.x / 2.f, el.offset_pos.y - el.size.y / 2.f, el.size.x, el.size.y, true, 0x7EFF0000);
 
 				// Padded Offset Filtered Area (Cyan)
-				_gfx_debug->draw_rectangle(kv.second->offset_pos.x - kv.second->pad_size.x / 2.f, kv.second->offset_pos.y - kv.second->pad_size.y / 2.f, kv.second->pad_size.x, kv.second->pad_size.y, true, 0x7EFFFF00);
+				_gfx_debug->draw_rectangle(el.offset_pos.x - el.pad_size.x / 2.f, el.offset_pos.y - el.pad_size.y / 2.f, el.pad_size.x, el.pad_size.y, true, 0x7EFFFF00);
 
 				// Aspect-Ratio-Corrected Padded Offset Filtered Area (Green)
-				_gfx_debug->draw_rectangle(kv.second->offset_pos.x - kv.second->aspected_size.x / 2.f, kv.second->offset_pos.y - kv.second->aspected_size.y / 2.f, kv.second->aspected_size.x, kv.second->aspected_size.y, true, 0x7E00FF00);
+				_gfx_debug->draw_rectangle(el.offset_pos.x - el.aspected_size.x / 2.f, el.offset_pos.y - el.aspected_size.y / 2.f, el.aspected_size.x, el.aspected_size.y, true, 0x7E00FF00);
 			}
 
-			// Final Region (White)
-			_gfx_debug->draw_rectangle(_frame_pos.x - _frame_size.x / 2.f, _frame_pos.y - _frame_size.y / 2.f, _frame_size.x, _frame_size.y, true, 0x7EFFFFFF);
-		} else {
-			float x0 = (_frame_pos.x - _frame_size.x / 2.f) / static_cast<float>(_size.first);
-			float x1 = (_frame_pos.x + _frame_size.x / 2.f) / static_cast<float>(_size.first);
-			float y0 = (_frame_pos.y - _frame_size.y / 2.f) / static_cast<float>(_size.second);
-			float y1 = (_frame_pos.y + _frame_size.y / 2.f) / static_cast<float>(_size.second);
-
-			{
-				auto v = _vb->at(0);
-				vec3_set(v.position, 0., 0., 0.);
-				v.uv[0]->x = x0;
-				v.uv[0]->y = y0;
-			}
-			{
-				auto v = _vb->at(1);
-				vec3_set(v.position, static_cast<float>(_out_size.first), 0., 0.);
-				v.uv[0]->x = x1;
-				v.uv[0]->y = y0;
-			}
-			{
-				auto v = _vb->at(2);
-				vec3_set(v.position, 0., static_cast<float>(_out_size.second), 0.);
-				v.uv[0]->x = x0;
-				v.uv[0]->y = y1;
-			}
-			{
-				auto v = _vb->at(3);
-				vec3_set(v.position, static_cast<float>(_out_size.first), static_cast<float>(_out_size.second), 0.);
-				v.uv[0]->x = x1;
-				v.uv[0]->y = y1;
+			// Split Cells (Magenta)
+			for (auto const& cell : _split_elements) {
+				_gfx_debug->draw_rectangle(cell.pos.x - cell.size.x / 2.f, cell.pos.y - cell.size.y / 2.f, cell.size.x, cell.size.y, true, 0x7EFF00FF);
 			}
 
-			gs_load_vertexbuffer(_vb->update(true));
-			if (!effect) {
-				if (_standard_effect->has_parameter("InputA", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
-					_standard_effect->get_parameter("InputA").set_texture(_input->get_texture());
-				}
-
-				while (gs_effect_loop(_standard_effect->get_object(), "Texture")) {
-					gs_draw(GS_TRISTRIP, 0, 4);
-				}
-			} else {
-				gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), _input->get_texture()->get_object());
-
+			// Final Region (White)
+			_gfx_debug->draw_rectangle(_frame_pos.x - _frame_size.x / 2.f, _frame_pos.y - _frame_size.y / 2.f, _frame_size.x, _frame_size.y, true, 0x7EFFFFFF);
+			_gfx_debug->end_batch();
+		} else if (!_split_elements.empty()) {
+			// All cells sample the same copy of the input, so an N person layout still only costs one capture.
+			auto  tex     = _input->get_texture();
+			float cell_cx = static_cast<float>(_out_size.first) / static_cast<float>(_split_elements.size());
+
+			gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex->get_object());
+			for (size_t idx = 0; idx < _split_elements.size(); idx++) {
+				auto const& cell = _split_elements[idx];
+
+				uint32_t x  = static_cast<uint32_t>(std::clamp<long>(std::lround(cell.pos.x - cell.size.x / 2.f), 0, static_cast<long>(tex->get_width()) - 1));
+				uint32_t y  = static_cast<uint32_t>(std::clamp<long>(std::lround(cell.pos.y - cell.size.y / 2.f), 0, static_cast<long>(tex->get_height()) - 1));
+				uint32_t cx = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(cell.size.x)), 1, tex->get_width() - x);
+				uint32_t cy = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(cell.size.y)), 1, tex->get_height() - y);
+
+				gs_matrix_push();
+				gs_matrix_translate3f(cell_cx * static_cast<float>(idx), 0., 0.);
+				gs_matrix_scale3f(cell_cx / static_cast<float>(cx), static_cast<float>(_out_size.second) / static_cast<float>(cy), 1.);
 				while (gs_effect_loop(effect, "Draw")) {
-					gs_draw(GS_TRISTRIP, 0, 4);
+					gs_draw_sprite_subregion(tex->get_object(), 0, x, y, cx, cy);
 				}
+				gs_matrix_pop();
 			}
-			gs_load_vertexbuffer(nullptr);
+		} else if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+			// Map the framed region onto the output, and let the viewport cut off the rest. This samples the original
+			// texture exactly once, instead of copying the full resolution input first.
+			gs_matrix_push();
+			gs_matrix_scale3f(static_cast<float>(_out_size.first) / std::max(_frame_size.x, 1.f), static_cast<float>(_out_size.second) / std::max(_frame_size.y, 1.f), 1.);
+			gs_matrix_translate3f(_frame_size.x / 2.f - _frame_pos.x, _frame_size.y / 2.f - _frame_pos.y, 0.);
+			obs_source_process_filter_end(_self, effect, width, height);
+			gs_matrix_pop();
+		} else {
+			skip_video_filter();
 		}
 	}
 }
@@ -595,116 +677,101 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float seconds)
 {
 	{ // Increase the age of all elements, and kill off any that are "too old".
-		float threshold = (0.5f * (1.f / (1.f - _track_frequency)));
+		float threshold = (0.5f * (1.f / (1.f - _track_interval)));
 
-		auto iter = _tracked_elements.begin();
-		while (iter != _tracked_elements.end()) {
+		for (size_t idx = 0; idx < _tracked_elements.size();) {
 			// Increment the age by the tick duration.
-			(*iter)->age += seconds;
-
-			// If the age exceeds the threshold, remove it.
-			if ((*iter)->age >= threshold) {
-				if (iter == _tracked_elements.begin()) {
-					// Erase iter, then reset to start.
-					_predicted_elements.erase(*iter);
-					_tracked_elements.erase(iter);
-					iter = _tracked_elements.begin();
-				} else {
-					// Copy, then advance before erasing.
-					auto iter2 = iter;
-					iter++;
-					_predicted_elements.erase(*iter2);
-					_tracked_elements.erase(iter2);
-				}
+			_tracked_elements[idx].age += seconds;
+
+			// If the age exceeds the threshold, remove it and its filters.
+			if (_tracked_elements[idx].age >= threshold) {
+				_tracked_elements.erase(_tracked_elements.begin() + static_cast<ptrdiff_t>(idx));
+				_tracked_filter.erase(idx * 2, 2);
 			} else {
-				// Move ahead.
-				iter++;
+				idx++;
 			}
 		}
 	}
 
-	for (auto trck : _tracked_elements) { // Updated predicted elements
-		std::shared_ptr<pred_el> pred;
-
-		// Find the corresponding prediction element.
-		auto iter = _predicted_elements.find(trck);
-		if (iter == _predicted_elements.end()) {
-			pred = std::make_shared<pred_el>();
-			_predicted_elements.insert_or_assign(trck, pred);
-			pred->filter_pos_x = {_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, trck->pos.x};
-			pred->filter_pos_y = {_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, trck->pos.y};
-		} else {
-			pred = iter->second;
-		}
+	// Predict the position of every element, so that all of them can be filtered in one go.
+	_tracked_measurements.resize(_tracked_elements.size() * 2);
+	for (size_t idx = 0; idx < _tracked_elements.size(); idx++) {
+		auto& el = _tracked_elements[idx];
 
 		// Calculate absolute velocity.
 		vec2 vel;
-		vec2_copy(&vel, &trck->vel);
+		vec2_copy(&vel, &el.vel);
 		vec2_mulf(&vel, &vel, _motion_prediction);
 		vec2_mulf(&vel, &vel, seconds);
 
 		// Calculate predicted position.
 		vec2 pos;
-		if (trck->age > seconds) {
-			vec2_copy(&pos, &pred->mp_pos);
+		if (el.age > seconds) {
+			vec2_copy(&pos, &el.mp_pos);
 		} else {
-			vec2_copy(&pos, &trck->pos);
+			vec2_copy(&pos, &el.pos);
 		}
 		vec2_add(&pos, &pos, &vel);
-		vec2_copy(&pred->mp_pos, &pos);
+		vec2_copy(&el.mp_pos, &pos);
+
+		_tracked_measurements[idx * 2]     = el.mp_pos.x;
+		_tracked_measurements[idx * 2 + 1] = el.mp_pos.y;
+	}
+
+	// Update filtered positions.
+	_tracked_filter.filter(_tracked_measurements.data());
 
-		// Update filtered position.
-		pred->filter_pos_x.filter(pred->mp_pos.x);
-		pred->filter_pos_y.filter(pred->mp_pos.y);
+	for (size_t idx = 0; idx < _tracked_elements.size(); idx++) {
+		auto& el = _tracked_elements[idx];
 
 		// Update offset position.
-		vec2_set(&pred->offset_pos, pred->filter_pos_x.get(), pred->filter_pos_y.get());
+		vec2_set(&el.offset_pos, _tracked_filter.get(idx * 2), _tracked_filter.get(idx * 2 + 1));
 		if (_frame_offset_prc[0]) { // %
-			pred->offset_pos.x += trck->size.x * (-_frame_offset.x);
+			el.offset_pos.x += el.size.x * (-_frame_offset.x);
 		} else { // Pixels
-			pred->offset_pos.x += _frame_offset.x;
+			el.offset_pos.x += _frame_offset.x;
 		}
 		if (_frame_offset_prc[1]) { // %
-			pred->offset_pos.y += trck->size.y * (-_frame_offset.y);
+			el.offset_pos.y += el.size.y * (-_frame_offset.y);
 		} else { // Pixels
-			pred->offset_pos.y += _frame_offset.y;
+			el.offset_pos.y += _frame_offset.y;
 		}
 
 		// Calculate padded area.
-		vec2_copy(&pred->pad_size, &trck->size);
+		vec2_copy(&el.pad_size, &el.size);
 		if (_frame_padding_prc[0]) { // %
-			pred->pad_size.x += trck->size.x * (-_frame_padding.x) * 2.f;
+			el.pad_size.x += el.size.x * (-_frame_padding.x) * 2.f;
 		} else { // Pixels
-			pred->pad_size.x += _frame_padding.x * 2.f;
+			el.pad_size.x += _frame_padding.x * 2.f;
 		}
 		if (_frame_padding_prc[1]) { // %
-			pred->pad_size.y += trck->size.y * (-_frame_padding.y) * 2.f;
+			el.pad_size.y += el.size.y * (-_frame_padding.y) * 2.f;
 		} else { // Pixels
-			pred->pad_size.y += _frame_padding.y * 2.f;
+			el.pad_size.y += _frame_padding.y * 2.f;
 		}
 
 		// Adjust to match aspect ratio (width / height).
-		vec2_copy(&pred->aspected_size, &pred->pad_size);
+		vec2_copy(&el.aspected_size, &el.pad_size);
 		if (_frame_aspect_ratio > 0.0) {
-			if ((pred->aspected_size.x / pred->aspected_size.y) >= _frame_aspect_ratio) { // Ours > Target
-				pred->aspected_size.y = pred->aspected_size.x / _frame_aspect_ratio;
+			if ((el.aspected_size.x / el.aspected_size.y) >= _frame_aspect_ratio) { // Ours > Target
+				el.aspected_size.y = el.aspected_size.x / _frame_aspect_ratio;
 			} else { // Target > Ours
-				pred->aspected_size.x = pred->aspected_size.y * _frame_aspect_ratio;
+				el.aspected_size.x = el.aspected_size.y * _frame_aspect_ratio;
 			}
 		}
 	}
 
 	{ // Find final frame.
 		bool need_filter = true;
-		if (_predicted_elements.size() > 0) {
+		if (_tracked_elements.size() > 0) {
 			if (_track_mode == tracking_mode::SOLO) {
-				auto kv = _predicted_elements.rbegin();
+				auto const& el = _tracked_elements.back();
 
-				_frame_pos_x.filter(kv->second->offset_pos.x);
-				_frame_pos_y.filter(kv->second->offset_pos.y);
+				_frame_pos_x.filter(el.offset_pos.x);
+				_frame_pos_y.filter(el.offset_pos.y);
 
 				vec2_set(&_frame_pos, _frame_pos_x.get(), _frame_pos_y.get());
-				vec2_copy(&_frame_size, &kv->second->aspected_size);
+				vec2_copy(&_frame_size, &el.aspected_size);
 
 				need_filter = false;
 			} else {
@@ -714,16 +781,16 @@ void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float se
 				vec2_set(&min, std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
 				vec2_set(&max, 0., 0.);
 
-				for (auto kv : _predicted_elements) {
+				for (auto const& el : _tracked_elements) {
 					vec2 size;
 					vec2 low;
 					vec2 high;
 
-					vec2_copy(&size, &kv.second->aspected_size);
+					vec2_copy(&size, &el.aspected_size);
 					vec2_mulf(&size, &size, .5f);
 
-					vec2_copy(&low, &kv.second->offset_pos);
-					vec2_copy(&high, &kv.second->offset_pos);
+					vec2_copy(&low, &el.offset_pos);
+					vec2_copy(&high, &el.offset_pos);
 
 					vec2_sub(&low, &low, &size);
 					vec2_add(&high, &high, &size);
@@ -771,43 +838,235 @@ void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float se
 			vec2_set(&_frame_size, _frame_size_x.get(), _frame_size_y.get());
 		}
 
-		{ // Aspect Ratio correction is a three step process:
-			float aspect = _frame_aspect_ratio > 0. ? _frame_aspect_ratio : (static_cast<float>(_size.first) / static_cast<float>(_size.second));
+		fit_frame(_frame_pos, _frame_size, _frame_aspect_ratio > 0. ? _frame_aspect_ratio : (static_cast<float>(_size.first) / static_cast<float>(_size.second)));
+	}
 
-			{ // 1. Adjust aspect ratio so that all elements end up contained.
-				float frame_aspect = _frame_size.x / _frame_size.y;
-				if (aspect < frame_aspect) {
-					_frame_size.y = _frame_size.x / aspect;
-				} else {
-					_frame_size.x = _frame_size.y * aspect;
-				}
+	// Lay out the split cells.
+	tracking_split();
+
+	// Increment tracking counter.
+	_track_frequency_counter += seconds;
+}
+
+void streamfx::filter::autoframing::autoframing_instance::tracking_merge(std::vector<detect_el> const& detected)
+{
+	// Frames may not move more than this distance.
+	float max_dst = sqrtf(static_cast<float>(_size.first * _size.first) + static_cast<float>(_size.second * _size.second)) * 0.667f;
+	max_dst *= 1.f / (1.f - _track_interval); // Fine-tune this?
+
+	// How far off the prediction was, which is high for anything that moves unexpectedly or just appeared.
+	float motion = 0.;
+
+	// Merge the detected elements with the tracked elements.
+	for (auto const& det : detected) {
+		// Try and find a match in the current list of tracked elements.
+		track_el* match     = nullptr;
+		float     match_dst = max_dst;
+		for (auto& el : _tracked_elements) {
+			// Skip "fresh" elements.
+			if (el.age < 0.00001) {
+				continue;
 			}
 
-			// 2. Limit the size of the frame to the allowed region, and adjust it so it's inside the frame.
-			// This will move the center, which might not be a wanted side effect.
-			vec4 rect;
-			rect.x        = std::clamp<float>(_frame_pos.x - _frame_size.x / 2.f, 0.f, static_cast<float>(_size.first));
-			rect.z        = std::clamp<float>(_frame_pos.x + _frame_size.x / 2.f, 0.f, static_cast<float>(_size.first));
-			rect.y        = std::clamp<float>(_frame_pos.y - _frame_size.y / 2.f, 0.f, static_cast<float>(_size.second));
-			rect.w        = std::clamp<float>(_frame_pos.y + _frame_size.y / 2.f, 0.f, static_cast<float>(_size.second));
-			_frame_pos.x  = (rect.x + rect.z) / 2.f;
-			_frame_pos.y  = (rect.y + rect.w) / 2.f;
-			_frame_size.x = (rect.z - rect.x);
-			_frame_size.y = (rect.w - rect.y);
-
-			{ // 3. Adjust the aspect ratio so that it matches the expected output aspect ratio.
-				float frame_aspect = _frame_size.x / _frame_size.y;
-				if (aspect < frame_aspect) {
-					_frame_size.x = _frame_size.y * aspect;
-				} else {
-					_frame_size.y = _frame_size.x / aspect;
-				}
+			// Check if the distance is within acceptable bounds.
+			float dst = vec2_dist(&det.pos, &el.pos);
+			if ((dst < match_dst) && (dst < max_dst)) {
+				match_dst = dst;
+				match     = &el;
 			}
 		}
+
+		// Do we have a match?
+		if (!match) {
+			// No, so create a new one, along with its filters.
+			match     = &_tracked_elements.emplace_back();
+			match->id = _tracked_next_id++;
+			_tracked_filter.push(_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, det.pos.x);
+			_tracked_filter.push(_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, det.pos.y);
+
+			// Update information.
+			vec2_copy(&match->pos, &det.pos);
+			vec2_copy(&match->size, &det.size);
+			vec2_set(&match->vel, 0., 0.);
+			match->age = 0.;
+
+			motion = std::max(motion, 1.f);
+		} else {
+			motion = std::max(motion, vec2_dist(&det.pos, &match->mp_pos) / std::max(vec2_len(&match->size), 1.f));
+
+			// Calculate the velocity between changes.
+			vec2 vel;
+			vec2_sub(&vel, &det.pos, &match->pos);
+
+			// Update information.
+			vec2_copy(&match->pos, &det.pos);
+			vec2_copy(&match->size, &det.size);
+			vec2_copy(&match->vel, &vel);
+			match->age = 0.;
+		}
 	}
 
-	// Increment tracking counter.
-	_track_frequency_counter += seconds;
+	// Rises at once, but only settles down over a few detections, so that a short pause does not drop the rate.
+	_track_motion = std::max(motion, _track_motion * .5f);
+	if (_track_adaptive) {
+		float slow      = std::max(_track_frequency, ST_ADAPTIVE_INTERVAL);
+		_track_interval = streamfx::util::math::lerp<float>(slow, _track_frequency, std::clamp<float>(_track_motion / ST_ADAPTIVE_MOTION, 0.f, 1.f));
+	} else {
+		_track_interval = _track_frequency;
+	}
+}
+
+void streamfx::filter::autoframing::autoframing_instance::tracking_split()
+{
+	if ((_track_mode != tracking_mode::SPLIT) || _tracked_elements.empty()) {
+		_split_elements.clear();
+		_split_filter.clear();
+		return;
+	}
+
+	// Lay out the cells from left to right, in the order the elements appear in the input.
+	std::vector<split_el> elements(_tracked_elements.size());
+	for (size_t idx = 0; idx < _tracked_elements.size(); idx++) {
+		elements[idx].id    = _tracked_elements[idx].id;
+		elements[idx].index = idx;
+	}
+	std::sort(elements.begin(), elements.end(), [this](split_el const& a, split_el const& b) { return _tracked_elements[a.index].offset_pos.x < _tracked_elements[b.index].offset_pos.x; });
+
+	// Every cell gets an equal share of the output width.
+	float aspect = static_cast<float>(_out_size.first) / static_cast<float>(std::max<uint32_t>(_out_size.second, 1)) / static_cast<float>(elements.size());
+
+	_split_measurements.resize(elements.size() * 4);
+	for (size_t idx = 0; idx < elements.size(); idx++) {
+		auto const& el = _tracked_elements[elements[idx].index];
+
+		vec2 size;
+		vec2_copy(&size, &el.pad_size);
+		if ((size.x / size.y) >= aspect) {
+			size.y = size.x / aspect;
+		} else {
+			size.x = size.y * aspect;
+		}
+
+		_split_measurements[idx * 4]     = el.offset_pos.x;
+		_split_measurements[idx * 4 + 1] = el.offset_pos.y;
+		_split_measurements[idx * 4 + 2] = size.x;
+		_split_measurements[idx * 4 + 3] = size.y;
+	}
+
+	// Cells that were already there keep their filtered state, so only new elements start from scratch.
+	bool unchanged = (elements.size() == _split_elements.size()) && std::equal(elements.begin(), elements.end(), _split_elements.begin(), [](split_el const& a, split_el const& b) { return a.id == b.id; });
+	if (!unchanged) {
+		streamfx::util::math::kalman_bank filter;
+		for (size_t idx = 0; idx < elements.size(); idx++) {
+			auto prev = std::find_if(_split_elements.begin(), _split_elements.end(), [&elements, idx](split_el const& v) { return v.id == elements[idx].id; });
+			for (size_t ch = 0; ch < 4; ch++) {
+				float value = (prev != _split_elements.end()) ? _split_filter.get(static_cast<size_t>(prev - _split_elements.begin()) * 4 + ch) : _split_measurements[idx * 4 + ch];
+				filter.push(_frame_stability_kalman, 1.0f, ST_KALMAN_EEC, value);
+			}
+		}
+		_split_filter = filter;
+	}
+	_split_filter.filter(_split_measurements.data());
+
+	for (size_t idx = 0; idx < elements.size(); idx++) {
+		vec2_set(&elements[idx].pos, _split_filter.get(idx * 4), _split_filter.get(idx * 4 + 1));
+		vec2_set(&elements[idx].size, _split_filter.get(idx * 4 + 2), _split_filter.get(idx * 4 + 3));
+		fit_frame(elements[idx].pos, elements[idx].size, aspect);
+	}
+	_split_elements = std::move(elements);
+}
+
+void streamfx::filter::autoframing::autoframing_instance::fit_frame(vec2& pos, vec2& size, float aspect)
+{
+	// Aspect Ratio correction is a three step process:
+	{ // 1. Adjust aspect ratio so that all elements end up contained.
+		float frame_aspect = size.x / size.y;
+		if (aspect < frame_aspect) {
+			size.y = size.x / aspect;
+		} else {
+			size.x = size.y * aspect;
+		}
+	}
+
+	// 2. Limit the size of the frame to the allowed region, and adjust it so it's inside the frame.
+	// This will move the center, which might not be a wanted side effect.
+	vec4 rect;
+	rect.x = std::clamp<float>(pos.x - size.x / 2.f, 0.f, static_cast<float>(_size.first));
+	rect.z = std::clamp<float>(pos.x + size.x / 2.f, 0.f, static_cast<float>(_size.first));
+	rect.y = std::clamp<float>(pos.y - size.y / 2.f, 0.f, static_cast<float>(_size.second));
+	rect.w = std::clamp<float>(pos.y + size.y / 2.f, 0.f, static_cast<float>(_size.second));
+	pos.x  = (rect.x + rect.z) / 2.f;
+	pos.y  = (rect.y + rect.w) / 2.f;
+	size.x = (rect.z - rect.x);
+	size.y = (rect.w - rect.y);
+
+	{ // 3. Adjust the aspect ratio so that it matches the expected output aspect ratio.
+		float frame_aspect = size.x / size.y;
+		if (aspect < frame_aspect) {
+			size.x = size.y * aspect;
+		} else {
+			size.y = size.x / aspect;
+		}
+	}
+}
+
+void streamfx::filter::autoframing::autoframing_instance::publish_regions()
+{
+	// Only what is on the program output matters to encoders.
+	if (!obs_source_active(obs_filter_get_parent(_self)) || (_frame_size.x <= 0.f) || (_frame_size.y <= 0.f)) {
+		_roi->withdraw(this);
+		return;
+	}
+
+	std::vector<::streamfx::util::roi::region> regions;
+
+	// In a split layout, each face lands in the cell that frames it.
+	if (!_split_elements.empty()) {
+		float cells = static_cast<float>(_split_elements.size());
+		for (size_t idx = 0; idx < _split_elements.size(); idx++) {
+			auto const& cell = _split_elements[idx];
+			auto const& el   = _tracked_elements[cell.index];
+			float       x    = _tracked_filter.get(cell.index * 2);
+			float       y    = _tracked_filter.get(cell.index * 2 + 1);
+			float       cl   = cell.pos.x - cell.size.x / 2.f;
+			float       ct   = cell.pos.y - cell.size.y / 2.f;
+
+			::streamfx::util::roi::region reg;
+			reg.left   = (static_cast<float>(idx) + std::clamp<float>((x - el.size.x / 2.f - cl) / cell.size.x, 0.f, 1.f)) / cells;
+			reg.right  = (static_cast<float>(idx) + std::clamp<float>((x + el.size.x / 2.f - cl) / cell.size.x, 0.f, 1.f)) / cells;
+			reg.top    = std::clamp<float>((y - el.size.y / 2.f - ct) / cell.size.y, 0.f, 1.f);
+			reg.bottom = std::clamp<float>((y + el.size.y / 2.f - ct) / cell.size.y, 0.f, 1.f);
+			if ((reg.right > reg.left) && (reg.bottom > reg.top)) {
+				regions.push_back(reg);
+			}
+		}
+
+		_roi->publish(this, std::move(regions));
+		return;
+	}
+
+	// Map each tracked face into the framed output, in normalized coordinates.
+	float left = _frame_pos.x - _frame_size.x / 2.f;
+	float top  = _frame_pos.y - _frame_size.y / 2.f;
+
+	regions.reserve(_tracked_elements.size());
+	for (size_t idx = 0; idx < _tracked_elements.size(); idx++) {
+		float x = _tracked_filter.get(idx * 2);
+		float y = _tracked_filter.get(idx * 2 + 1);
+		float w = _tracked_elements[idx].size.x / 2.f;
+		float h = _tracked_elements[idx].size.y / 2.f;
+
+		::streamfx::util::roi::region el;
+		el.left   = std::clamp<float>((x - w - left) / _frame_size.x, 0.f, 1.f);
+		el.right  = std::clamp<float>((x + w - left) / _frame_size.x, 0.f, 1.f);
+		el.top    = std::clamp<float>((y - h - top) / _frame_size.y, 0.f, 1.f);
+		el.bottom = std::clamp<float>((y + h - top) / _frame_size.y, 0.f, 1.f);
+		if ((el.right > el.left) && (el.bottom > el.top)) {
+			regions.push_back(el);
+		}
+	}
+
+	_roi->publish(this, std::move(regions));
 }
 
 struct switch_provider_data_t {
@@ -848,7 +1107,7 @@ void streamfx::filter::autoframing::autoframing_instance::switch_provider(tracki
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&autoframing_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->push(std::bind(&autoframing_instance::task_switch_provider, this, std::placeholders::_1), spd, util::threadpool::priority::BACKGROUND);
 }
 
 void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(util::threadpool::task_data_t data)
@@ -869,6 +1128,9 @@ void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(u
 			nvar_facedetection_unload();
 			break;
 #endif
+		case tracking_provider::CPU_FACEDETECTION:
+			cpu_facedetection_unload();
+			break;
 		default:
 			break;
 		}
@@ -880,6 +1142,9 @@ void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(u
 			nvar_facedetection_load();
 			break;
 #endif
+		case tracking_provider::CPU_FACEDETECTION:
+			cpu_facedetection_load();
+			break;
 		default:
 			break;
 		}
@@ -897,7 +1162,9 @@ void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(u
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_load()
 {
-	_nvidia_fx = std::make_shared<::streamfx::nvidia::ar::facedetection>();
+	size_t limit    = (_track_mode == tracking_mode::SOLO) ? 1 : ::streamfx::nvidia::ar::facedetection::tracking_limit_range().second;
+	_nvidia_fx      = ::streamfx::nvidia::ar::facedetection::acquire(limit, _size.first, _size.second);
+	_nvidia_fx_size = _size;
 }
 
 void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_unload()
@@ -905,82 +1172,48 @@ void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_unl
 	_nvidia_fx.reset();
 }
 
-void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_process()
+void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_process(std::shared_ptr<::streamfx::obs::gs::texture> input)
 {
 	if (!_nvidia_fx) {
 		return;
 	}
 
-	// Frames may not move more than this distance.
-	float max_dst = sqrtf(static_cast<float>(_size.first * _size.first) + static_cast<float>(_size.second * _size.second)) * 0.667f;
-	max_dst *= 1.f / (1.f - _track_frequency); // Fine-tune this?
-
-	// Process the current frame (if requested).
-	_nvidia_fx->process(_input->get_texture());
-
-	// If there are tracked faces, merge them with the tracked elements.
-	if (auto edx = _nvidia_fx->count(); edx > 0) {
-		for (size_t idx = 0; idx < edx; idx++) {
-			float confidence = 0.;
-			auto  rect       = _nvidia_fx->at(idx, confidence);
-
-			// Skip elements that have not enough confidence of being a face.
-			// TODO: Make the threshold configurable.
-			if (confidence < .5) {
-				continue;
-			}
-
-			// Calculate centered position.
-			vec2 pos;
-			pos.x = rect.x + (rect.z / 2.f);
-			pos.y = rect.y + (rect.w / 2.f);
-
-			// Try and find a match in the current list of tracked elements.
-			std::shared_ptr<track_el> match;
-			float                     match_dst = max_dst;
-			for (const auto& el : _tracked_elements) {
-				// Skip "fresh" elements.
-				if (el->age < 0.00001) {
-					continue;
-				}
+	// Detectors are shared by size, so a different size needs a different one.
+	if (std::pair<uint32_t, uint32_t> size{input->get_width(), input->get_height()}; size != _nvidia_fx_size) {
+		_nvidia_fx      = ::streamfx::nvidia::ar::facedetection::acquire(_nvidia_fx->tracking_limit(), size.first, size.second);
+		_nvidia_fx_size = size;
+	}
 
-				// Check if the distance is within acceptable bounds.
-				float dst = vec2_dist(&pos, &el->pos);
-				if ((dst < match_dst) && (dst < max_dst)) {
-					match_dst = dst;
-					match     = el;
-				}
-			}
+	// Only the copy happens here, detection itself is left to the thread pool so that rendering never waits for it.
+	if (_nvidia_fx->capture(input)) {
+		_track_task = streamfx::threadpool()->push<&autoframing_instance::nvar_facedetection_detect>(this, _nvidia_fx, util::threadpool::priority::REALTIME);
+	}
+}
 
-			// Do we have a match?
-			if (!match) {
-				// No, so create a new one.
-				match = std::make_shared<track_el>();
+void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_detect(util::threadpool::task_data_t data)
+{
+	auto fx = std::static_pointer_cast<::streamfx::nvidia::ar::facedetection>(data);
 
-				// Insert it.
-				_tracked_elements.push_back(match);
+	std::vector<std::pair<::streamfx::nvidia::ar::rect_t, float>> faces;
+	fx->detect(faces);
 
-				// Update information.
-				vec2_copy(&match->pos, &pos);
-				vec2_set(&match->size, rect.z, rect.w);
-				vec2_set(&match->vel, 0., 0.);
-				match->age = 0.;
-			} else {
-				// Reset the age to 0.
-				match->age = 0.;
-
-				// Calculate the velocity between changes.
-				vec2 vel;
-				vec2_sub(&vel, &pos, &match->pos);
-
-				// Update information.
-				vec2_copy(&match->pos, &pos);
-				vec2_set(&match->size, rect.z, rect.w);
-				vec2_copy(&match->vel, &vel);
-				match->age = 0.;
-			}
+	auto detected = std::make_shared<std::vector<detect_el>>();
+	for (auto const& [rect, confidence] : faces) {
+		// Skip elements that have not enough confidence of being a face.
+		// TODO: Make the threshold configurable.
+		if (confidence < .5) {
+			continue;
 		}
+
+		// Calculate centered position, back in the resolution of the input.
+		detect_el el;
+		vec2_set(&el.pos, (rect.x + (rect.z / 2.f)) * _detect_scale.x, (rect.y + (rect.w / 2.f)) * _detect_scale.y);
+		vec2_set(&el.size, rect.z * _detect_scale.x, rect.w * _detect_scale.y);
+		detected->push_back(el);
 	}
+
+	// Picked up by the next tick, which never has to wait for this.
+	std::atomic_store(&_detected_elements, detected);
 }
 
 void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_properties(obs_properties_t* props) {}
@@ -991,57 +1224,155 @@ void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_upd
 		return;
 	}
 
-	switch (_track_mode) {
-	case tracking_mode::SOLO:
-		_nvidia_fx->set_tracking_limit(1);
-		break;
-	case tracking_mode::GROUP:
-		_nvidia_fx->set_tracking_limit(_nvidia_fx->tracking_limit_range().second);
-		break;
+	// The detector may be shared with other instances, so a different configuration needs a different one.
+	size_t limit = (_track_mode == tracking_mode::SOLO) ? 1 : ::streamfx::nvidia::ar::facedetection::tracking_limit_range().second;
+	if (_nvidia_fx->tracking_limit() != limit) {
+		_nvidia_fx = ::streamfx::nvidia::ar::facedetection::acquire(limit, _nvidia_fx_size.first, _nvidia_fx_size.second);
 	}
 }
 
 #endif
 
-autoframing_factory::autoframing_factory()
+void streamfx::filter::autoframing::autoframing_instance::cpu_facedetection_load()
 {
-	bool any_available = false;
+	::streamfx::obs::gs::context gctx;
 
-	// 1. Try and load any configured providers.
-#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvar             = ::streamfx::nvidia::ar::ar::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvar.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvar.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available with unknown error.", nullptr);
+	_cpu_fx       = std::make_shared<::streamfx::util::face_detection::detector>();
+	_cpu_input    = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	_cpu_readback = std::make_shared<::streamfx::obs::gs::readback>(2);
+	_cpu_frame    = std::make_shared<cpu_frame_el>();
+}
+
+void streamfx::filter::autoframing::autoframing_instance::cpu_facedetection_unload()
+{
+	::streamfx::obs::gs::context gctx;
+
+	// A detection still in progress keeps its own reference to the detector.
+	_cpu_frame.reset();
+	_cpu_readback.reset();
+	_cpu_input.reset();
+	_cpu_fx.reset();
+}
+
+void streamfx::filter::autoframing::autoframing_instance::cpu_facedetection_process(std::shared_ptr<::streamfx::obs::gs::texture> input)
+{
+	if (!_cpu_readback) {
+		return;
 	}
+
+	auto     texture = input;
+	uint32_t width   = input->get_width();
+	uint32_t height  = input->get_height();
+	if (width > ST_CPU_WIDTH) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Downscale"};
 #endif
 
-	// 2. Check if any of them managed to load at all.
-	if (!any_available) {
-		D_LOG_ERROR("All supported providers failed to initialize, disabling effect.", 0);
+		height = std::max<uint32_t>(static_cast<uint32_t>(std::lround(static_cast<double>(height) * ST_CPU_WIDTH / width)), 1);
+		width  = ST_CPU_WIDTH;
+		{
+			auto op = _cpu_input->render(width, height);
+			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
+
+			gs_blend_state_push();
+			gs_enable_color(true, true, true, true);
+			gs_enable_blending(false);
+			gs_enable_depth_test(false);
+			gs_enable_stencil_test(false);
+			gs_set_cull_mode(GS_NEITHER);
+
+			gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+			gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), input->get_object());
+			while (gs_effect_loop(default_effect, "Draw")) {
+				gs_draw_sprite(nullptr, 0, width, height);
+			}
+
+			gs_blend_state_pop();
+		}
+		texture = _cpu_input->get_texture();
+	}
+
+	// Only queue the copy here, reading it right away would make the GPU finish everything queued before it.
+	_cpu_readback->stage(texture);
+	vec2_set(&_cpu_scale, _detect_scale.x * static_cast<float>(input->get_width()) / static_cast<float>(width), _detect_scale.y * static_cast<float>(input->get_height()) / static_cast<float>(height));
+}
+
+void streamfx::filter::autoframing::autoframing_instance::cpu_facedetection_collect()
+{
+	if (!_cpu_readback || (_cpu_readback->pending() == 0) || (_track_task && !_track_task->is_completed())) {
 		return;
 	}
 
+	// Staged during an earlier frame, so the copy is almost certainly done and mapping it does not stall.
+	auto frame = _cpu_frame;
+	auto copy  = [&frame](::streamfx::obs::gs::readback::view const& view) {
+        size_t row = static_cast<size_t>(view.width) * 4;
+        frame->pixels.resize(row * view.height);
+        for (uint32_t y = 0; y < view.height; y++) {
+            std::memcpy(frame->pixels.data() + row * y, view.data + static_cast<size_t>(view.linesize) * y, row);
+        }
+        frame->width  = view.width;
+        frame->height = view.height;
+	};
+	if (!_cpu_readback->read(copy, true)) {
+		return;
+	}
+
+	frame->fx    = _cpu_fx;
+	frame->scale = _cpu_scale;
+	frame->limit = (_track_mode == tracking_mode::SOLO) ? 1 : ST_CPU_LIMIT;
+
+	_track_task = streamfx::threadpool()->push<&autoframing_instance::cpu_facedetection_detect>(this, frame, util::threadpool::priority::REALTIME);
+}
+
+void streamfx::filter::autoframing::autoframing_instance::cpu_facedetection_detect(util::threadpool::task_data_t data)
+{
+	auto frame = std::static_pointer_cast<cpu_frame_el>(data);
+
+	std::vector<::streamfx::util::face_detection::face> faces;
+	frame->fx->detect(frame->pixels.data(), frame->width * 4, frame->width, frame->height, faces, frame->limit);
+
+	auto detected = std::make_shared<std::vector<detect_el>>();
+	for (auto const& face : faces) {
+		// Skip elements that have not enough confidence of being a face.
+		if (face.confidence < .5) {
+			continue;
+		}
+
+		// Calculate centered position, back in the resolution of the input.
+		detect_el el;
+		vec2_set(&el.pos, (face.x + (face.width / 2.f)) * frame->scale.x, (face.y + (face.height / 2.f)) * frame->scale.y);
+		vec2_set(&el.size, face.width * frame->scale.x, face.height * frame->scale.y);
+		detected->push_back(el);
+	}
+
+	// Picked up by the next tick, which never has to wait for this.
+	std::atomic_store(&_detected_elements, detected);
+}
+
+autoframing_factory::autoframing_factory()
+{
+	// The CPU provider runs everywhere.
+	bool any_available = true;
+
+	// 1. Check which providers were available last time. Loading them takes a while, so it waits until they are needed.
+#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+	_nvidia_loaded    = false;
+	_nvidia_available = streamfx::configuration::instance()->get_availability("Filter.Autoframing.NVIDIA").value_or(true);
+	any_available |= _nvidia_available;
+#endif
+
 	// Register initial source.
 	_info.id           = S_PREFIX "filter-autoframing";
 	_info.type         = OBS_SOURCE_TYPE_FILTER;
 	_info.output_flags = OBS_SOURCE_VIDEO;
 
+	// Keep the filter for existing scenes, but hide it if none of the providers were available last time.
+	if (!any_available) {
+		D_LOG_WARNING("No supported providers were available last time, hiding effect.", 0);
+		_info.output_flags |= OBS_SOURCE_CAP_DISABLED;
+	}
+
 	support_size(true);
 	finish_setup();
 
@@ -1062,6 +1393,8 @@ void autoframing_factory::get_defaults2(obs_data_t* data)
 	// Tracking
 	obs_data_set_default_int(data, ST_KEY_TRACKING_MODE, static_cast<int64_t>(tracking_mode::SOLO));
 	obs_data_set_default_string(data, ST_KEY_TRACKING_FREQUENCY, "20 Hz");
+	obs_data_set_default_int(data, ST_KEY_TRACKING_RESOLUTION, 480);
+	obs_data_set_default_bool(data, ST_KEY_TRACKING_ADAPTIVE, false);
 
 	// Motion
 	obs_data_set_default_double(data, ST_KEY_MOTION_SMOOTHING, 33.333);
@@ -1112,11 +1445,24 @@ obs_properties_t* autoframing_factory::get_properties2(autoframing_instance* dat
 			obs_property_set_modified_callback(p, modified_provider);
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_FRAMING_MODE_SOLO), static_cast<int64_t>(tracking_mode::SOLO));
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_FRAMING_MODE_GROUP), static_cast<int64_t>(tracking_mode::GROUP));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_FRAMING_MODE_SPLIT), static_cast<int64_t>(tracking_mode::SPLIT));
 		}
 
 		{
 			auto p = obs_properties_add_text(grp, ST_KEY_TRACKING_FREQUENCY, D_TRANSLATE(ST_I18N_TRACKING_FREQUENCY), OBS_TEXT_DEFAULT);
 		}
+
+		{
+			auto p = obs_properties_add_bool(grp, ST_KEY_TRACKING_ADAPTIVE, D_TRANSLATE(ST_I18N_TRACKING_ADAPTIVE));
+		}
+
+		{
+			auto p = obs_properties_add_list(grp, ST_KEY_TRACKING_RESOLUTION, D_TRANSLATE(ST_I18N_TRACKING_RESOLUTION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_TRACKING_RESOLUTION_FULL), 0);
+			obs_property_list_add_int(p, "720p", 720);
+			obs_property_list_add_int(p, "480p", 480);
+			obs_property_list_add_int(p, "360p", 360);
+		}
 	}
 
 	{
@@ -1216,6 +1562,7 @@ obs_properties_t* autoframing_factory::get_properties2(autoframing_instance* dat
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_NVIDIA_FACEDETECTION), static_cast<int64_t>(tracking_provider::NVIDIA_FACEDETECTION));
 #endif
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_CPU_FACEDETECTION), static_cast<int64_t>(tracking_provider::CPU_FACEDETECTION));
 		}
 
 		obs_properties_add_bool(grp, "Debug", "Debug");
@@ -1237,13 +1584,50 @@ bool streamfx::filter::autoframing::autoframing_factory::is_provider_available(t
 	switch (provider) {
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 	case tracking_provider::NVIDIA_FACEDETECTION:
-		return _nvidia_available;
+		return load_nvidia();
 #endif
+	case tracking_provider::CPU_FACEDETECTION:
+		return true;
 	default:
 		return false;
 	}
 }
 
+#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+bool streamfx::filter::autoframing::autoframing_factory::load_nvidia()
+{
+	std::unique_lock<std::mutex> lock(_nvidia_lock);
+	if (_nvidia_loaded) {
+		return _nvidia_available;
+	}
+	_nvidia_loaded = true;
+
+	try {
+		// Load CVImage and Video Effects SDK.
+		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
+		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
+		_nvar             = ::streamfx::nvidia::ar::ar::get();
+		_nvidia_available = true;
+	} catch (const std::exception& ex) {
+		_nvidia_available = false;
+		_nvar.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA providers available due to error: %s", ex.what());
+	} catch (...) {
+		_nvidia_available = false;
+		_nvar.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA providers available with unknown error.", nullptr);
+	}
+
+	// Remember the result, so that the next session knows whether to show the filter at all.
+	streamfx::configuration::instance()->set_availability("Filter.Autoframing.NVIDIA", _nvidia_available);
+	return _nvidia_available;
+}
+#endif
+
 tracking_provider streamfx::filter::autoframing::autoframing_factory::find_ideal_provider()
 {
 	for (auto v : provider_priority) {
@@ -3,20 +3,24 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-governor.hpp"
 #include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-readback.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
-#include "obs/gs/gs-vertexbuffer.hpp"
 #include "obs/obs-source-factory.hpp"
 #include "plugin.hpp"
+#include "util/util-face-detection.hpp"
+#include "util/util-kalman.hpp"
+#include "util/util-roi.hpp"
 #include "util/util-threadpool.hpp"
 #include "util/utility.hpp"
 
 #include "warning-disable.hpp"
 #include <atomic>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
@@ -28,12 +32,14 @@ namespace streamfx::filter::autoframing {
 	enum class tracking_mode : int64_t {
 		SOLO  = 0,
 		GROUP = 1,
+		SPLIT = 2,
 	};
 
 	enum class tracking_provider : int64_t {
 		INVALID              = -1,
 		AUTOMATIC            = 0,
 		NVIDIA_FACEDETECTION = 1,
+		CPU_FACEDETECTION    = 2,
 	};
 
 	const char* cstring(tracking_provider provider);
@@ -42,20 +48,15 @@ namespace streamfx::filter::autoframing {
 
 	class autoframing_instance : public obs::source_instance {
 		struct track_el {
-			float age;
-			vec2  pos;
-			vec2  size;
-			vec2  vel;
-		};
+			uint64_t id;
+			float    age;
+			vec2     pos;
+			vec2     size;
+			vec2     vel;
 
-		struct pred_el {
 			// Motion-Predicted Position
 			vec2 mp_pos;
 
-			// Filtered Position
-			streamfx::util::math::kalman1D<float> filter_pos_x;
-			streamfx::util::math::kalman1D<float> filter_pos_y;
-
 			// Offset Filtered Position
 			vec2 offset_pos;
 
@@ -66,14 +67,37 @@ namespace streamfx::filter::autoframing {
 			vec2 aspected_size;
 		};
 
+		struct detect_el {
+			vec2 pos;
+			vec2 size;
+		};
+
+		// A frame read back for the CPU provider, in the order and size of its pixels.
+		struct cpu_frame_el {
+			std::shared_ptr<::streamfx::util::face_detection::detector> fx;
+			std::vector<uint8_t>                                        pixels;
+			uint32_t                                                    width;
+			uint32_t                                                    height;
+			vec2                                                        scale; // Back to the resolution of the input.
+			size_t                                                      limit;
+		};
+
+		// One cell of the split layout, which frames a single tracked element.
+		struct split_el {
+			uint64_t id;
+			size_t   index; // Into _tracked_elements, only valid until the next merge.
+			vec2     pos;
+			vec2     size;
+		};
+
 		bool                          _dirty;
 		std::pair<uint32_t, uint32_t> _size;
 		std::pair<uint32_t, uint32_t> _out_size;
 
-		std::shared_ptr<::streamfx::gfx::util>              _gfx_debug;
-		std::shared_ptr<::streamfx::obs::gs::effect>        _standard_effect;
-		std::shared_ptr<::streamfx::obs::gs::rendertarget>  _input;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _vb;
+		std::shared_ptr<::streamfx::gfx::util>             _gfx_debug;
+		std::shared_ptr<::streamfx::gfx::governor>         _governor;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _input;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _detect_input;
 
 		tracking_provider                       _provider;
 		tracking_provider                       _provider_ui;
@@ -83,10 +107,21 @@ namespace streamfx::filter::autoframing {
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 		std::shared_ptr<::streamfx::nvidia::ar::facedetection> _nvidia_fx;
+		std::pair<uint32_t, uint32_t>                          _nvidia_fx_size;
 #endif
 
+		std::shared_ptr<::streamfx::util::face_detection::detector> _cpu_fx;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget>          _cpu_input;
+		std::shared_ptr<::streamfx::obs::gs::readback>              _cpu_readback;
+		std::shared_ptr<cpu_frame_el>                               _cpu_frame;
+		vec2                                                        _cpu_scale; // Of what is waiting in _cpu_readback.
+
 		tracking_mode _track_mode;
 		float         _track_frequency;
+		uint32_t      _track_resolution;
+		bool          _track_adaptive;
+		float         _track_interval; // Current time between detections, at most _track_frequency when not adaptive.
+		float         _track_motion;   // Largest recent prediction error, relative to the size of the element.
 
 		float _motion_smoothing;
 		float _motion_smoothing_kalman_pnc;
@@ -101,9 +136,14 @@ namespace streamfx::filter::autoframing {
 		vec2  _frame_offset;
 		float _frame_aspect_ratio;
 
-		float                                                         _track_frequency_counter;
-		std::list<std::shared_ptr<track_el>>                          _tracked_elements;
-		std::map<std::shared_ptr<track_el>, std::shared_ptr<pred_el>> _predicted_elements;
+		float                                   _track_frequency_counter;
+		std::shared_ptr<util::threadpool::task> _track_task;
+		vec2                                    _detect_scale;
+		std::shared_ptr<std::vector<detect_el>> _detected_elements;
+		uint64_t                                _tracked_next_id;
+		std::vector<track_el>                   _tracked_elements;
+		streamfx::util::math::kalman_bank       _tracked_filter;       // Filtered position, X and Y of each element.
+		std::vector<float>                      _tracked_measurements; // Input for _tracked_filter.
 
 		streamfx::util::math::kalman1D<float> _frame_pos_x;
 		streamfx::util::math::kalman1D<float> _frame_pos_y;
@@ -112,8 +152,14 @@ namespace streamfx::filter::autoframing {
 		streamfx::util::math::kalman1D<float> _frame_size_y;
 		vec2                                  _frame_size;
 
+		std::vector<split_el>             _split_elements; // Left to right, as they appear in the output.
+		streamfx::util::math::kalman_bank _split_filter;   // Filtered position and size of each cell.
+		std::vector<float>                _split_measurements;
+
 		bool _debug;
 
+		std::shared_ptr<::streamfx::util::roi::channel> _roi;
+
 		public:
 		~autoframing_instance();
 		autoframing_instance(obs_data_t* settings, obs_source_t* self);
@@ -131,6 +177,10 @@ namespace streamfx::filter::autoframing {
 
 		private:
 		void tracking_tick(float seconds);
+		void tracking_merge(std::vector<detect_el> const& detected);
+		void tracking_split();
+		void fit_frame(vec2& pos, vec2& size, float aspect);
+		void publish_regions();
 
 		void switch_provider(tracking_provider provider);
 		void task_switch_provider(util::threadpool::task_data_t data);
@@ -138,14 +188,23 @@ namespace streamfx::filter::autoframing {
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 		void nvar_facedetection_load();
 		void nvar_facedetection_unload();
-		void nvar_facedetection_process();
+		void nvar_facedetection_process(std::shared_ptr<::streamfx::obs::gs::texture> input);
+		void nvar_facedetection_detect(util::threadpool::task_data_t data);
 		void nvar_facedetection_properties(obs_properties_t* props);
 		void nvar_facedetection_update(obs_data_t* data);
 #endif
+
+		void cpu_facedetection_load();
+		void cpu_facedetection_unload();
+		void cpu_facedetection_process(std::shared_ptr<::streamfx::obs::gs::texture> input);
+		void cpu_facedetection_collect();
+		void cpu_facedetection_detect(util::threadpool::task_data_t data);
 	};
 
 	class autoframing_factory : public obs::source_factory<streamfx::filter::autoframing::autoframing_factory, streamfx::filter::autoframing::autoframing_instance> {
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+		std::mutex                                     _nvidia_lock;
+		bool                                           _nvidia_loaded;
 		bool                                           _nvidia_available;
 		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
 		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
@@ -168,6 +227,11 @@ namespace streamfx::filter::autoframing {
 		bool              is_provider_available(tracking_provider);
 		tracking_provider find_ideal_provider();
 
+#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+		private:
+		bool load_nvidia();
+#endif
+
 		public: // Singleton
 		static void                                 initialize();
 		static void                                 finalize();
@@ -9,7 +9,10 @@
 #include "gfx/blur/gfx-blur-dual-filtering.hpp"
 #include "gfx/blur/gfx-blur-gaussian-linear.hpp"
 #include "gfx/blur/gfx-blur-gaussian.hpp"
+#include "gfx/blur/gfx-blur-kawase.hpp"
+#include "gfx/gfx-quality.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-state.hpp"
 #include "obs/obs-source-tracker.hpp"
 #include "util/util-logging.hpp"
 
@@ -96,6 +99,8 @@
 #define ST_KEY_MASK_ALPHA "Filter.Blur.Mask.Alpha"
 #define ST_I18N_MASK_MULTIPLIER "Filter.Blur.Mask.Multiplier"
 #define ST_KEY_MASK_MULTIPLIER "Filter.Blur.Mask.Multiplier"
+#define ST_I18N_REUSE "Filter.Blur.Reuse"
+#define ST_KEY_REUSE "Filter.Blur.Reuse"
 
 using namespace streamfx::filter::blur;
 
@@ -111,7 +116,7 @@ struct local_blur_subtype_t {
 };
 
 static std::map<std::string, local_blur_type_t> list_of_types = {
-	{"box", {&::streamfx::gfx::blur::box_factory::get, S_BLUR_TYPE_BOX}}, {"box_linear", {&::streamfx::gfx::blur::box_linear_factory::get, S_BLUR_TYPE_BOX_LINEAR}}, {"gaussian", {&::streamfx::gfx::blur::gaussian_factory::get, S_BLUR_TYPE_GAUSSIAN}}, {"gaussian_linear", {&::streamfx::gfx::blur::gaussian_linear_factory::get, S_BLUR_TYPE_GAUSSIAN_LINEAR}}, {"dual_filtering", {&::streamfx::gfx::blur::dual_filtering_factory::get, S_BLUR_TYPE_DUALFILTERING}},
+	{"box", {&::streamfx::gfx::blur::box_factory::get, S_BLUR_TYPE_BOX}}, {"box_linear", {&::streamfx::gfx::blur::box_linear_factory::get, S_BLUR_TYPE_BOX_LINEAR}}, {"gaussian", {&::streamfx::gfx::blur::gaussian_factory::get, S_BLUR_TYPE_GAUSSIAN}}, {"gaussian_linear", {&::streamfx::gfx::blur::gaussian_linear_factory::get, S_BLUR_TYPE_GAUSSIAN_LINEAR}}, {"dual_filtering", {&::streamfx::gfx::blur::dual_filtering_factory::get, S_BLUR_TYPE_DUALFILTERING}}, {"kawase", {&::streamfx::gfx::blur::kawase_factory::get, S_BLUR_TYPE_KAWASE}},
 };
 static std::map<std::string, local_blur_subtype_t> list_of_subtypes = {
 	{"area", {::streamfx::gfx::blur::type::Area, S_BLUR_SUBTYPE_AREA}},
@@ -120,30 +125,51 @@ static std::map<std::string, local_blur_subtype_t> list_of_subtypes = {
 	{"zoom", {::streamfx::gfx::blur::type::Zoom, S_BLUR_SUBTYPE_ZOOM}},
 };
 
-blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _source_rendered(false), _output_rendered(false)
+blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _image_cache(::streamfx::gfx::image_cache::instance()), _source_rendered(false), _output_rendered(false), _rt_pool(::streamfx::obs::gs::rendertarget_pool::instance()), _blur_cache(::streamfx::gfx::blur::cache::get()), _reuse(false), _reuse_valid(false), _reuse_checksum(), _reuse_checksum_value(0), _reuse_texture()
 {
-	{
-		auto gctx = streamfx::obs::gs::context();
+	update(settings);
+}
 
-		// Create RenderTargets
-		this->_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		this->_output_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+blur_instance::~blur_instance()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_reuse_texture.reset();
+	_reuse_checksum.reset();
+}
 
-		// Load Effects
-		{
-			auto file = streamfx::data_file_path("effects/mask.effect");
-			try {
-				_effect_mask = streamfx::obs::gs::effect::create(file);
-			} catch (std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
-			}
-		}
+void blur_instance::create_resources()
+{
+	auto file = streamfx::data_file_path("effects/mask.effect");
+	try {
+		_effect_mask = streamfx::obs::gs::effect_registry::instance()->get(file);
+	} catch (std::exception& ex) {
+		DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 	}
 
-	update(settings);
+	try {
+		_reuse_checksum = std::make_shared<streamfx::gfx::checksum>();
+	} catch (std::exception const& ex) {
+		DLOG_WARNING("<filter-blur> Input will be blurred again every frame: %s", ex.what());
+	}
 }
 
-blur_instance::~blur_instance() {}
+bool blur_instance::input_changed()
+{
+	if (!_reuse_checksum) {
+		return true;
+	}
+
+	// The checksum arrives one frame late, so a change leaves the output one frame behind at worst.
+	uint64_t value = 0;
+	if (!_reuse_checksum->update(_source_texture, value)) {
+		return true;
+	}
+	if (value == _reuse_checksum_value) {
+		return false;
+	}
+	_reuse_checksum_value = value;
+	return true;
+}
 
 bool blur_instance::apply_mask_parameters(streamfx::obs::gs::effect effect, gs_texture_t* original_texture, gs_texture_t* blurred_texture)
 {
@@ -315,6 +341,12 @@ void blur_instance::update(obs_data_t* settings)
 			}
 		}
 	}
+
+	{ // Reuse
+		// Any change to the settings may change the result, so the kept one is no longer valid.
+		_reuse       = obs_data_get_bool(settings, ST_KEY_REUSE);
+		_reuse_valid = false;
+	}
 }
 
 void blur_instance::video_tick(float)
@@ -340,12 +372,28 @@ void blur_instance::video_tick(float)
 	// Load Mask
 	if (_mask.type == mask_type::Image) {
 		if (_mask.image.path_old != _mask.image.path) {
+			// Decoding happens on the threadpool, and every instance using the same file shares the result.
+			_mask.image.path_old = _mask.image.path;
+			_mask.image.request.reset();
+			if (!_mask.image.path.empty()) {
+				_mask.image.request = _image_cache->load(std::filesystem::path(_mask.image.path), false);
+			} else {
+				_mask.image.image.reset();
+				_mask.image.texture.reset();
+			}
+		}
+		if (_mask.image.request && _mask.image.request->task->is_completed()) {
 			try {
-				_mask.image.texture  = std::make_shared<streamfx::obs::gs::texture>(_mask.image.path);
-				_mask.image.path_old = _mask.image.path;
-			} catch (...) {
-				DLOG_ERROR("<filter-blur> Instance '%s' failed to load image '%s'.", obs_source_get_name(_self), _mask.image.path.c_str());
+				if (!_mask.image.request->result) {
+					throw std::runtime_error(_mask.image.request->error);
+				}
+				_mask.image.texture = _mask.image.request->result->texture();
+				_mask.image.image   = _mask.image.request->result;
+				_reuse_valid        = false;
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("<filter-blur> Instance '%s' failed to load image '%s': %s", obs_source_get_name(_self), _mask.image.path.c_str(), ex.what());
 			}
+			_mask.image.request.reset();
 		}
 	} else if (_mask.type == mask_type::Source) {
 		if (_mask.source.name_old != _mask.source.name) {
@@ -361,6 +409,12 @@ void blur_instance::video_tick(float)
 
 	_source_rendered = false;
 	_output_rendered = false;
+
+	// Render targets are borrowed for a single frame, so hidden instances hold on to none of them.
+	_source_texture.reset();
+	_output_texture.reset();
+	_source_rt.reset();
+	_output_rt.reset();
 }
 
 void blur_instance::video_render(gs_effect_t* effect)
@@ -373,7 +427,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 
 	// Verify that we can actually run first.
 	if (!target || !parent || !this->_self || !this->_blur || (baseW == 0) || (baseH == 0)) {
-		obs_source_skip_video_filter(this->_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -381,7 +435,17 @@ void blur_instance::video_render(gs_effect_t* effect)
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Blur '%s'", obs_source_get_name(_self)};
 #endif
 
-	if (!_source_rendered) {
+	// Filters directly on a source see the same input, so an identical blur from another filter this frame can be reused.
+	const void* origin = (target == parent) ? static_cast<const void*>(parent) : nullptr;
+	if (!_output_rendered && !_mask.enabled && origin) {
+		if (auto shared = _blur_cache->find(origin, _blur); shared) {
+			_output_texture  = shared;
+			_output_rendered = true;
+			_reuse_valid     = false; // Neither checked nor kept, so it can't be relied on next frame.
+		}
+	}
+
+	if (!_source_rendered && !_output_rendered) {
 		// Source To Texture
 		{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -389,24 +453,15 @@ void blur_instance::video_render(gs_effect_t* effect)
 #endif
 
 			if (obs_source_process_filter_begin(this->_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+				if (!_source_rt) {
+					_source_rt = _rt_pool->acquire(GS_RGBA, GS_ZS_NONE, baseW, baseH);
+				}
+
 				{
 					auto op = this->_source_rt->render(baseW, baseH);
 
-					gs_blend_state_push();
-					gs_reset_blend_state();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-					gs_set_cull_mode(GS_NEITHER);
-					gs_enable_color(true, true, true, true);
-
-					gs_enable_depth_test(false);
-					gs_depth_function(GS_ALWAYS);
-
-					gs_enable_stencil_test(false);
-					gs_enable_stencil_write(false);
-					gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-					gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+					streamfx::obs::gs::state::push();
+					streamfx::obs::gs::state::apply_opaque(GS_KEEP);
 
 					// Orthographic Camera and clear RenderTarget.
 					gs_ortho(0, static_cast<float>(baseW), 0, static_cast<float>(baseH), -1., 1.);
@@ -414,22 +469,32 @@ void blur_instance::video_render(gs_effect_t* effect)
 
 					// Render
 					obs_source_process_filter_end(this->_self, defaultEffect, baseW, baseH);
+					streamfx::obs::gs::state::invalidate();
 
-					gs_blend_state_pop();
+					streamfx::obs::gs::state::pop();
 				}
 
 				_source_texture = this->_source_rt->get_texture();
 				if (!_source_texture) {
-					obs_source_skip_video_filter(this->_self);
+					skip_video_filter();
 					return;
 				}
 			} else {
-				obs_source_skip_video_filter(this->_self);
+				skip_video_filter();
 				return;
 			}
 		}
 
 		_source_rendered = true;
+
+		// A source mask changes on its own, which the checksum of the input can't see.
+		if (_reuse && !(_mask.enabled && (_mask.type == mask_type::Source))) {
+			bool changed = input_changed();
+			if (!changed && _reuse_valid && _reuse_texture && (_reuse_texture->get_width() == baseW) && (_reuse_texture->get_height() == baseH)) {
+				_output_texture  = _reuse_texture;
+				_output_rendered = true;
+			}
+		}
 	}
 
 	if (!_output_rendered) {
@@ -438,8 +503,17 @@ void blur_instance::video_render(gs_effect_t* effect)
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Blur"};
 #endif
 
+			// Region masks only show the blur inside of them, so there is no need to blur the rest of the frame.
+			if (_mask.enabled && (_mask.type == mask_type::Region) && !_mask.region.invert) {
+				double_t grow = _mask.region.feather * (0.5 + std::max(_mask.region.feather_shift, 0.f));
+				_blur->set_region(_mask.region.left - grow, _mask.region.top - grow, _mask.region.right + grow, _mask.region.bottom + grow);
+				origin = nullptr; // A partial result must not be shared.
+			} else {
+				_blur->clear_region();
+			}
+
 			_blur->set_input(_source_texture);
-			_output_texture = _blur->render();
+			_output_texture = _blur_cache->render(origin, _blur);
 		}
 
 		// Mask
@@ -448,18 +522,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Mask"};
 #endif
 
-			gs_blend_state_push();
-			gs_reset_blend_state();
-			gs_enable_color(true, true, true, true);
-			gs_enable_blending(false);
-			gs_enable_depth_test(false);
-			gs_enable_stencil_test(false);
-			gs_enable_stencil_write(false);
-			gs_set_cull_mode(GS_NEITHER);
-			gs_depth_function(GS_ALWAYS);
-			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-			gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-			gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+			streamfx::obs::gs::state::push();
 
 			std::string technique = "";
 			switch (this->_mask.type) {
@@ -507,11 +570,19 @@ void blur_instance::video_render(gs_effect_t* effect)
 #endif
 
 				this->_mask.source.texture = this->_mask.source.source_texture->render(source_width, source_height);
+				streamfx::obs::gs::state::invalidate();
 			}
 
+			// Set after rendering the mask source, which may leave anything behind.
+			streamfx::obs::gs::state::apply_opaque();
+
 			apply_mask_parameters(_effect_mask, _source_texture->get_object(), _output_texture->get_object());
 
 			try {
+				if (!_output_rt) {
+					_output_rt = _rt_pool->acquire(GS_RGBA, GS_ZS_NONE, baseW, baseH);
+				}
+
 				auto op = this->_output_rt->render(baseW, baseH);
 				gs_ortho(0, 1, 0, 1, -1, 1);
 
@@ -520,18 +591,36 @@ void blur_instance::video_render(gs_effect_t* effect)
 					_gfx_util->draw_fullscreen_triangle();
 				}
 			} catch (const std::exception&) {
-				gs_blend_state_pop();
-				obs_source_skip_video_filter(this->_self);
+				streamfx::obs::gs::state::pop();
+				skip_video_filter();
 				return;
 			}
-			gs_blend_state_pop();
+			streamfx::obs::gs::state::pop();
 
 			if (!(_output_texture = this->_output_rt->get_texture())) {
-				obs_source_skip_video_filter(this->_self);
+				skip_video_filter();
 				return;
 			}
 		}
 
+		// Keep a copy, as the blur and the pooled render targets overwrite theirs later on.
+		if (_reuse && _reuse_checksum) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_copy, "Keep"};
+#endif
+
+			uint32_t        width  = _output_texture->get_width();
+			uint32_t        height = _output_texture->get_height();
+			gs_color_format format = _output_texture->get_color_format();
+			if (!_reuse_texture || (_reuse_texture->get_width() != width) || (_reuse_texture->get_height() != height) || (_reuse_texture->get_color_format() != format)) {
+				_reuse_texture = std::make_shared<streamfx::obs::gs::texture>(width, height, format, 1, nullptr, streamfx::obs::gs::texture::flags::None);
+			}
+			gs_copy_texture(_reuse_texture->get_object(), _output_texture->get_object());
+			_reuse_valid = true;
+		} else {
+			_reuse_texture.reset();
+		}
+
 		_output_rendered = true;
 	}
 
@@ -542,14 +631,14 @@ void blur_instance::video_render(gs_effect_t* effect)
 #endif
 
 		// It is important that we do not modify the blend state here, as it is set correctly by OBS
-		gs_set_cull_mode(GS_NEITHER);
-		gs_enable_color(true, true, true, true);
-		gs_enable_depth_test(false);
-		gs_depth_function(GS_ALWAYS);
-		gs_enable_stencil_test(false);
-		gs_enable_stencil_write(false);
-		gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-		gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+		streamfx::obs::gs::state::set_cull_mode(GS_NEITHER);
+		streamfx::obs::gs::state::enable_color(true, true, true, true);
+		streamfx::obs::gs::state::enable_depth_test(false);
+		streamfx::obs::gs::state::depth_function(GS_ALWAYS);
+		streamfx::obs::gs::state::enable_stencil_test(false);
+		streamfx::obs::gs::state::enable_stencil_write(false);
+		streamfx::obs::gs::state::stencil_function(GS_ALWAYS);
+		streamfx::obs::gs::state::stencil_op(GS_ZERO, GS_ZERO, GS_ZERO);
 
 		gs_effect_t* finalEffect = effect ? effect : defaultEffect;
 		const char*  technique   = "Draw";
@@ -557,7 +646,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 		gs_eparam_t* param = gs_effect_get_param_by_name(finalEffect, "image");
 		if (!param) {
 			DLOG_ERROR("<filter-blur:%s> Failed to set image param.", obs_source_get_name(this->_self));
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		} else {
 			gs_effect_set_texture(param, _output_texture->get_object());
@@ -589,7 +678,17 @@ const char* blur_factory::get_name()
 void blur_factory::get_defaults2(obs_data_t* settings)
 {
 	// Type, Subtype
-	obs_data_set_default_string(settings, ST_KEY_TYPE, "box");
+	switch (streamfx::gfx::resolve_quality_tier()) {
+	case streamfx::gfx::quality_tier::Low:
+		obs_data_set_default_string(settings, ST_KEY_TYPE, "dual_filtering");
+		break;
+	case streamfx::gfx::quality_tier::High:
+		obs_data_set_default_string(settings, ST_KEY_TYPE, "gaussian");
+		break;
+	default:
+		obs_data_set_default_string(settings, ST_KEY_TYPE, "box");
+		break;
+	}
 	obs_data_set_default_string(settings, ST_KEY_SUBTYPE, "area");
 
 	// Parameters
@@ -615,6 +714,9 @@ void blur_factory::get_defaults2(obs_data_t* settings)
 	obs_data_set_default_string(settings, ST_KEY_MASK_SOURCE, "");
 	obs_data_set_default_int(settings, ST_KEY_MASK_COLOR, 0xFFFFFFFFull);
 	obs_data_set_default_double(settings, ST_KEY_MASK_MULTIPLIER, 1.0);
+
+	// Reuse
+	obs_data_set_default_bool(settings, ST_KEY_REUSE, false);
 }
 
 bool modified_properties(void*, obs_properties_t* props, obs_property* prop, obs_data_t* settings) noexcept
@@ -759,6 +861,7 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_GAUSSIAN), "gaussian");
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_GAUSSIAN_LINEAR), "gaussian_linear");
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_DUALFILTERING), "dual_filtering");
+		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_KAWASE), "kawase");
 
 		p = obs_properties_add_list(pr, ST_KEY_SUBTYPE, D_TRANSLATE(ST_I18N_SUBTYPE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 		obs_property_set_modified_callback2(p, modified_properties, this);
@@ -807,18 +910,8 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		/// Source
 		p = obs_properties_add_list(pr, ST_KEY_MASK_SOURCE, D_TRANSLATE(ST_I18N_MASK_SOURCE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::instance()->enumerate(
-			[&p](std::string name, ::streamfx::obs::source) {
-				obs_property_list_add_string(p, std::string(name + " (Source)").c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_video_sources);
-		obs::source_tracker::instance()->enumerate(
-			[&p](std::string name, ::streamfx::obs::source) {
-				obs_property_list_add_string(p, std::string(name + " (Scene)").c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_video_sources, D_TRANSLATE(S_SOURCETYPE_SOURCE));
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_scenes, D_TRANSLATE(S_SOURCETYPE_SCENE));
 
 		/// Shared
 		p = obs_properties_add_color(pr, ST_KEY_MASK_COLOR, D_TRANSLATE(ST_I18N_MASK_COLOR));
@@ -826,6 +919,11 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		p = obs_properties_add_float_slider(pr, ST_KEY_MASK_MULTIPLIER, D_TRANSLATE(ST_I18N_MASK_MULTIPLIER), 0.0, 10.0, 0.01);
 	}
 
+	// Reuse
+	{
+		p = obs_properties_add_bool(pr, ST_KEY_REUSE, D_TRANSLATE(ST_I18N_REUSE));
+	}
+
 	return pr;
 }
 
@@ -5,6 +5,9 @@
 #pragma once
 #include "common.hpp"
 #include "gfx/blur/gfx-blur-base.hpp"
+#include "gfx/blur/gfx-blur-cache.hpp"
+#include "gfx/gfx-checksum.hpp"
+#include "gfx/gfx-image-cache.hpp"
 #include "gfx/gfx-source-texture.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
@@ -29,8 +32,9 @@ namespace streamfx::filter::blur {
 
 	class blur_instance : public obs::source_instance {
 		// Effects
-		streamfx::obs::gs::effect            _effect_mask;
-		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+		streamfx::obs::gs::effect                   _effect_mask;
+		std::shared_ptr<streamfx::gfx::util>        _gfx_util;
+		std::shared_ptr<streamfx::gfx::image_cache> _image_cache;
 
 		// Input
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _source_rt;
@@ -38,17 +42,26 @@ namespace streamfx::filter::blur {
 		bool                                             _source_rendered;
 
 		// Rendering
-		std::shared_ptr<streamfx::obs::gs::texture>      _output_texture;
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _output_rt;
-		bool                                             _output_rendered;
+		std::shared_ptr<streamfx::obs::gs::texture>           _output_texture;
+		std::shared_ptr<streamfx::obs::gs::rendertarget>      _output_rt;
+		bool                                                  _output_rendered;
+		std::shared_ptr<streamfx::obs::gs::rendertarget_pool> _rt_pool;
 
 		// Blur
-		std::shared_ptr<::streamfx::gfx::blur::base> _blur;
-		double_t                                     _blur_size;
-		double_t                                     _blur_angle;
-		std::pair<double_t, double_t>                _blur_center;
-		bool                                         _blur_step_scaling;
-		std::pair<double_t, double_t>                _blur_step_scale;
+		std::shared_ptr<::streamfx::gfx::blur::base>  _blur;
+		std::shared_ptr<::streamfx::gfx::blur::cache> _blur_cache;
+		double_t                                      _blur_size;
+		double_t                                      _blur_angle;
+		std::pair<double_t, double_t>                 _blur_center;
+		bool                                          _blur_step_scaling;
+		std::pair<double_t, double_t>                 _blur_step_scale;
+
+		// Reuse
+		bool                                        _reuse;
+		bool                                        _reuse_valid;
+		std::shared_ptr<streamfx::gfx::checksum>    _reuse_checksum;
+		uint64_t                                    _reuse_checksum_value;
+		std::shared_ptr<streamfx::obs::gs::texture> _reuse_texture;
 
 		// Masking
 		struct {
@@ -64,9 +77,11 @@ namespace streamfx::filter::blur {
 				bool    invert;
 			} region;
 			struct {
-				std::string                                 path;
-				std::string                                 path_old;
-				std::shared_ptr<streamfx::obs::gs::texture> texture;
+				std::string                                          path;
+				std::string                                          path_old;
+				std::shared_ptr<streamfx::gfx::image_cache::request> request;
+				std::shared_ptr<streamfx::gfx::image_cache::image>   image;
+				std::shared_ptr<streamfx::obs::gs::texture>          texture;
 			} image;
 			struct {
 				std::string                                    name_old;
@@ -96,8 +111,12 @@ namespace streamfx::filter::blur {
 		virtual void video_tick(float_t time) override;
 		virtual void video_render(gs_effect_t* effect) override;
 
+		virtual void create_resources() override;
+
 		private:
 		bool apply_mask_parameters(streamfx::obs::gs::effect effect, gs_texture_t* original_texture, gs_texture_t* blurred_texture);
+
+		bool input_changed();
 	};
 
 	class blur_factory : public obs::source_factory<filter::blur::blur_factory, filter::blur::blur_instance> {
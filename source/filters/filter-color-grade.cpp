@@ -9,6 +9,9 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -83,6 +86,14 @@ extern "C" {
 #define ST_I18N_RENDERMODE_LUT_6BIT ST_I18N_RENDERMODE ".LUT.6Bit"
 #define ST_I18N_RENDERMODE_LUT_8BIT ST_I18N_RENDERMODE ".LUT.8Bit"
 #define ST_I18N_RENDERMODE_LUT_10BIT ST_I18N_RENDERMODE ".LUT.10Bit"
+// LUT File
+#define ST_KEY_FILE "Filter.ColorGrade.File"
+#define ST_I18N_FILE ST_I18N ".File"
+// Automatic
+#define ST_KEY_AUTOMATIC "Filter.ColorGrade.Automatic"
+#define ST_I18N_AUTOMATIC ST_I18N ".Automatic"
+#define ST_KEY_AUTOMATIC_(x) ST_KEY_AUTOMATIC "." x
+#define ST_I18N_AUTOMATIC_(x) ST_I18N_AUTOMATIC "." x
 
 #define ST_RED "Red"
 #define ST_GREEN "Green"
@@ -103,6 +114,21 @@ extern "C" {
 #define ST_MODE_EXP2 "Exp2"
 #define ST_MODE_LOG "Log"
 #define ST_MODE_LOG10 "Log10"
+#define ST_WHITE_BALANCE "WhiteBalance"
+#define ST_EXPOSURE "Exposure"
+
+// Time in seconds over which automatic corrections follow the image.
+#define ST_AUTO_SMOOTHING 0.5f
+// Change in automatic corrections that is needed to rebuild the LUT.
+#define ST_AUTO_THRESHOLD 0.005f
+// Geometric mean luma that automatic exposure aims for, roughly middle gray.
+#define ST_AUTO_KEY 0.46f
+
+#ifdef ENABLE_PROFILING
+#define ST_KEY_BENCHMARK "Filter.ColorGrade.Benchmark"
+#define ST_I18N_BENCHMARK ST_I18N ".Benchmark"
+#define ST_BENCHMARK_FRAMES 300
+#endif
 
 using namespace streamfx::filter::color_grade;
 
@@ -111,44 +137,60 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
 // TODO: Figure out a way to merge _lut_rt, _lut_texture, _rt_source, _rt_grad, _tex_source, _tex_grade, _source_updated and _grade_updated.
 // Seriously this is too much GPU space wasted on unused trash.
 
-color_grade_instance::~color_grade_instance() {}
-
-color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _effect(), _gfx_util(::streamfx::gfx::util::get()), _lift(), _gamma(), _gain(), _offset(), _tint_detection(), _tint_luma(), _tint_exponent(), _tint_low(), _tint_mid(), _tint_hig(), _correction(), _lut_enabled(true), _lut_depth(), _ccache_rt(), _ccache_texture(), _ccache_fresh(false), _lut_initialized(false), _lut_dirty(true), _lut_producer(), _lut_consumer(), _lut_rt(), _lut_texture(), _cache_rt(), _cache_texture(), _cache_fresh(false)
+color_grade_instance::~color_grade_instance()
 {
-	{
+#ifdef ENABLE_PROFILING
+	if (_benchmark_direct || _benchmark_lut) {
 		auto gctx = streamfx::obs::gs::context();
+		_benchmark_direct.reset();
+		_benchmark_lut.reset();
+	}
+#endif
+}
 
-		// Load the color grading effect.
-		{
-			auto file = streamfx::data_file_path("effects/color-grade.effect");
-			try {
-				_effect = streamfx::obs::gs::effect::create(file);
-			} catch (std::exception& ex) {
-				D_LOG_ERROR("Error loading '%s': %s", file.u8string().c_str(), ex.what());
-				throw;
-			}
-		}
+color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _effect(), _effect_technique(), _gfx_util(::streamfx::gfx::util::get()), _lift(), _gamma(), _gain(), _offset(), _tint_detection(), _tint_luma(), _tint_exponent(), _tint_low(), _tint_mid(), _tint_hig(), _correction(), _lut_enabled(true), _lut_depth(), _file_lock(), _file_path(), _auto_white_balance(false), _auto_exposure(false), _ccache_rt(), _ccache_texture(), _ccache_fresh(false), _lut_initialized(false), _lut_dirty(true), _lut_producer(), _lut_consumer(), _lut_cache(), _lut_rt(), _lut_texture(), _file_loaded_path(), _file_request(), _file(), _file_rt(), _histogram(), _auto_gain(), _auto_gain_lut(), _auto_time(0), _cache_rt(), _cache_texture(), _cache_fresh(false), _renders(0), _renders_previous(0)
+{
+#ifdef ENABLE_PROFILING
+	_benchmark_frames = 0;
+#endif
+	vec4_set(&_auto_gain, 1., 1., 1., 1.);
+	vec4_set(&_auto_gain_lut, 1., 1., 1., 1.);
 
-		// Initialize LUT work flow.
-		try {
-			_lut_producer    = std::make_shared<streamfx::gfx::lut::producer>();
-			_lut_consumer    = std::make_shared<streamfx::gfx::lut::consumer>();
-			_lut_initialized = true;
-		} catch (std::exception const& ex) {
-			D_LOG_WARNING("Failed to initialize LUT rendering, falling back to direct rendering.\n%s", ex.what());
-			_lut_initialized = false;
-		}
+	update(data);
+}
 
-		// Allocate render target for rendering.
+void color_grade_instance::create_resources()
+{
+	// Load the color grading effect.
+	{
+		auto file = streamfx::data_file_path("effects/color-grade.effect");
 		try {
-			allocate_rendertarget(GS_RGBA);
-		} catch (std::exception const& ex) {
-			D_LOG_ERROR("Failed to acquire render target for rendering: %s", ex.what());
+			_effect = streamfx::obs::gs::effect::create(file);
+		} catch (std::exception& ex) {
+			D_LOG_ERROR("Error loading '%s': %s", file.u8string().c_str(), ex.what());
 			throw;
 		}
 	}
 
-	update(data);
+	// Initialize LUT work flow.
+	try {
+		_lut_producer    = std::make_shared<streamfx::gfx::lut::producer>();
+		_lut_consumer    = std::make_shared<streamfx::gfx::lut::consumer>();
+		_lut_cache       = streamfx::gfx::lut::cache::instance();
+		_lut_initialized = true;
+		_lut_dirty       = true;
+	} catch (std::exception const& ex) {
+		D_LOG_WARNING("Failed to initialize LUT rendering, falling back to direct rendering.\n%s", ex.what());
+		_lut_initialized = false;
+	}
+
+	// Allocate render target for rendering.
+	try {
+		allocate_rendertarget(GS_RGBA);
+	} catch (std::exception const& ex) {
+		D_LOG_ERROR("Failed to acquire render target for rendering: %s", ex.what());
+		throw;
+	}
 }
 
 void color_grade_instance::allocate_rendertarget(gs_color_format format)
@@ -207,23 +249,66 @@ void color_grade_instance::update(obs_data_t* data)
 	_correction.z   = static_cast<float_t>(obs_data_get_double(data, ST_KEY_CORRECTION_(ST_LIGHTNESS)) / 100.0);
 	_correction.w   = static_cast<float_t>(obs_data_get_double(data, ST_KEY_CORRECTION_(ST_CONTRAST)) / 100.0);
 
+	// Tint detection and mode are compiled into the effect, see color-grade.permutations.effect.
+	_effect_technique = "Draw_" + std::to_string(static_cast<int>(_tint_detection) + static_cast<int>(_tint_luma) * 3);
+
 	{
 		int64_t v = obs_data_get_int(data, ST_KEY_RENDERMODE);
 
 		// LUT status depends on selected option.
 		_lut_enabled = v != 0; // 0 (Direct)
 
-		if (v == -1) {
-			_lut_depth = streamfx::gfx::lut::color_depth::_8;
-		} else if (v > 0) {
+		if (v <= 0) { // Direct rendering still needs a LUT to apply a LUT file.
+			// 64 points per axis in half-float interpolate to well below 8-bit error, at 1/32th the size of an 8-bit LUT.
+			_lut_depth = streamfx::gfx::lut::color_depth::_6;
+		} else {
 			_lut_depth = static_cast<streamfx::gfx::lut::color_depth>(v);
 		}
 	}
 
-	if (_lut_enabled && _lut_initialized)
+	{
+		std::lock_guard<std::mutex> lock(_file_lock);
+		_file_path = obs_data_get_string(data, ST_KEY_FILE);
+	}
+
+	_auto_white_balance = obs_data_get_bool(data, ST_KEY_AUTOMATIC_(ST_WHITE_BALANCE));
+	_auto_exposure      = obs_data_get_bool(data, ST_KEY_AUTOMATIC_(ST_EXPOSURE));
+
+	if (_lut_initialized)
 		_lut_dirty = true;
 }
 
+void color_grade_instance::update_file()
+{
+	if (!_lut_initialized)
+		return;
+
+	// Start loading a different file if the user picked one.
+	{
+		std::lock_guard<std::mutex> lock(_file_lock);
+		if (_file_path != _file_loaded_path) {
+			_file_loaded_path = _file_path;
+			_file_request.reset();
+			if (_file_loaded_path.empty()) {
+				_file.reset();
+				_lut_dirty = true;
+			} else {
+				_file_request = _lut_cache->load(std::filesystem::u8path(_file_loaded_path));
+			}
+		}
+	}
+
+	// Keep using the previous file until the new one is ready, so the output does not flicker while loading.
+	if (_file_request && _file_request->task->is_completed()) {
+		if (!_file_request->lut) {
+			D_LOG_ERROR("Failed to load LUT file '%s': %s", _file_request->path.u8string().c_str(), _file_request->error.c_str());
+		}
+		_file = _file_request->lut;
+		_file_request.reset();
+		_lut_dirty = true;
+	}
+}
+
 void color_grade_instance::prepare_effect()
 {
 	if (auto p = _effect.get_parameter("pLift"); p) {
@@ -235,7 +320,9 @@ void color_grade_instance::prepare_effect()
 	}
 
 	if (auto p = _effect.get_parameter("pGain"); p) {
-		p.set_float4(_gain);
+		vec4 gain;
+		vec4_mul(&gain, &_gain, &_auto_gain);
+		p.set_float4(gain);
 	}
 
 	if (auto p = _effect.get_parameter("pOffset"); p) {
@@ -246,14 +333,6 @@ void color_grade_instance::prepare_effect()
 		p.set_float4(_lift);
 	}
 
-	if (auto p = _effect.get_parameter("pTintDetection"); p) {
-		p.set_int(static_cast<int32_t>(_tint_detection));
-	}
-
-	if (auto p = _effect.get_parameter("pTintMode"); p) {
-		p.set_int(static_cast<int32_t>(_tint_luma));
-	}
-
 	if (auto p = _effect.get_parameter("pTintExponent"); p) {
 		p.set_float(_tint_exponent);
 	}
@@ -281,6 +360,53 @@ void color_grade_instance::rebuild_lut()
 	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Rebuild LUT"};
 #endif
 
+	_auto_gain_lut = _auto_gain;
+
+	// Describe everything that goes into the LUT, so that identical grades on other sources can share it.
+	std::vector<uint8_t> key;
+	{
+		vec4 gain;
+		vec4_mul(&gain, &_gain, &_auto_gain);
+
+		auto write       = [&key](const void* data, size_t size) { key.insert(key.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size); };
+		auto write_float = [&write](float_t v) { write(&v, sizeof(v)); };
+		auto write_int   = [&write](int32_t v) { write(&v, sizeof(v)); };
+
+		write_int(static_cast<int32_t>(_lut_depth));
+		for (auto v : {&_lift, &_gamma, &gain, &_offset, &_correction}) {
+			write_float(v->x);
+			write_float(v->y);
+			write_float(v->z);
+			write_float(v->w);
+		}
+		write_int(static_cast<int32_t>(_tint_detection));
+		write_int(static_cast<int32_t>(_tint_luma));
+		write_float(_tint_exponent);
+		for (auto v : {&_tint_low, &_tint_mid, &_tint_hig}) {
+			write_float(v->x);
+			write_float(v->y);
+			write_float(v->z);
+		}
+		uint64_t file_hash = _file ? _file->hash() : 0;
+		write(&file_hash, sizeof(file_hash));
+	}
+
+	if (auto lut = _lut_cache->find(key); lut) {
+		_lut_rt = lut;
+		_lut_rt->get_texture(_lut_texture);
+		if (_lut_texture) {
+			_lut_dirty = false;
+			return;
+		}
+	}
+
+	// Our render target can only be reused if no other instance shares it, and only once it can no longer be found.
+	if (_lut_rt && (_lut_rt.use_count() > 1)) {
+		_lut_rt.reset();
+	} else if (_lut_rt) {
+		_lut_cache->remove(_lut_rt);
+	}
+
 	// Generate a fresh LUT texture.
 	auto lut_texture = _lut_producer->produce(_lut_depth);
 
@@ -292,6 +418,17 @@ void color_grade_instance::rebuild_lut()
 			_lut_rt = std::make_unique<streamfx::obs::gs::rendertarget>(lut_texture->get_color_format(), GS_ZS_NONE);
 		}
 
+		// With a LUT file, the grade goes into an intermediate target that the file is then applied to.
+		auto grade_rt = _lut_rt;
+		if (_file) {
+			if (!_file_rt || (lut_texture->get_color_format() != _file_rt->get_color_format())) {
+				_file_rt = std::make_unique<streamfx::obs::gs::rendertarget>(lut_texture->get_color_format(), GS_ZS_NONE);
+			}
+			grade_rt = _file_rt;
+		} else {
+			_file_rt.reset();
+		}
+
 		// Prepare our color grade effect.
 		prepare_effect();
 
@@ -301,7 +438,7 @@ void color_grade_instance::rebuild_lut()
 		}
 
 		{ // Begin rendering.
-			auto op = _lut_rt->render(lut_texture->get_width(), lut_texture->get_height());
+			auto op = grade_rt->render(lut_texture->get_width(), lut_texture->get_height());
 
 			// Set up graphics context.
 			gs_ortho(0, 1, 0, 1, 0, 1);
@@ -311,7 +448,27 @@ void color_grade_instance::rebuild_lut()
 			gs_enable_stencil_test(false);
 			gs_enable_stencil_write(false);
 
-			while (gs_effect_loop(_effect.get_object(), "Draw")) {
+			while (gs_effect_loop(_effect.get_object(), _effect_technique.c_str())) {
+				_gfx_util->draw_fullscreen_triangle();
+			}
+
+			gs_blend_state_pop();
+		}
+
+		if (_file) { // Apply the LUT file to the graded LUT, so the source itself still only needs a single lookup.
+			auto effect = _lut_consumer->prepare(_file);
+			effect->get_parameter("image").set_texture(_file_rt->get_texture());
+
+			auto op = _lut_rt->render(lut_texture->get_width(), lut_texture->get_height());
+
+			gs_ortho(0, 1, 0, 1, 0, 1);
+			gs_blend_state_push();
+			gs_enable_blending(false);
+			gs_enable_color(true, true, true, true);
+			gs_enable_stencil_test(false);
+			gs_enable_stencil_write(false);
+
+			while (gs_effect_loop(effect->get_object(), streamfx::gfx::lut::consumer::technique(streamfx::gfx::lut::interpolation::Tetrahedral))) {
 				_gfx_util->draw_fullscreen_triangle();
 			}
 
@@ -322,6 +479,7 @@ void color_grade_instance::rebuild_lut()
 		if (!_lut_texture) {
 			throw std::runtime_error("Failed to produce modified LUT texture.");
 		}
+		_lut_cache->insert(key, _lut_rt);
 	} else {
 		throw std::runtime_error("Failed to produce LUT texture.");
 	}
@@ -329,10 +487,246 @@ void color_grade_instance::rebuild_lut()
 	_lut_dirty = false;
 }
 
-void color_grade_instance::video_tick(float)
+void color_grade_instance::update_automatic()
 {
+	vec4 target;
+	vec4_set(&target, 1., 1., 1., 1.);
+
+	if (_auto_white_balance || _auto_exposure) {
+		try {
+			if (!_histogram) {
+				_histogram = std::make_shared<streamfx::gfx::histogram>();
+			}
+		} catch (std::exception const& ex) {
+			D_LOG_ERROR("Automatic corrections are unavailable: %s", ex.what());
+			_auto_white_balance = false;
+			_auto_exposure      = false;
+			return;
+		}
+
+		streamfx::gfx::histogram::statistics stats;
+		if (!_histogram->update(_ccache_texture, stats)) {
+			return;
+		}
+
+		if (_auto_white_balance) {
+			// Gray world: scale each channel so that the average color becomes neutral at the same luma.
+			float_t luma = stats.average[0] * 0.2126f + stats.average[1] * 0.7152f + stats.average[2] * 0.0722f;
+			target.x     = std::clamp(luma / std::max(stats.average[0], 1.f / 1024.f), .5f, 2.f);
+			target.y     = std::clamp(luma / std::max(stats.average[1], 1.f / 1024.f), .5f, 2.f);
+			target.z     = std::clamp(luma / std::max(stats.average[2], 1.f / 1024.f), .5f, 2.f);
+		}
+
+		if (_auto_exposure) {
+			// Bring the image to middle gray, but never push its brightest percent into clipping.
+			float_t gain = ST_AUTO_KEY / std::max(stats.key, 1.f / 1024.f);
+			gain         = std::min(gain, 1.f / std::max(stats.percentile(.99f), 1.f / 1024.f));
+			target.w     = std::clamp(gain, .25f, 4.f);
+		}
+	} else {
+		_histogram.reset();
+	}
+
+	// Follow the target smoothly instead of jumping, so a single bright frame does not flash the whole image.
+	float_t factor = std::clamp(1.f - std::exp(-_auto_time / ST_AUTO_SMOOTHING), 0.f, 1.f);
+	if (!_histogram) {
+		factor = 1.f;
+	}
+	_auto_time = 0;
+
+	// A new LUT every frame would cost far more than it saves, so only rebuild it once the change becomes visible.
+	for (size_t idx = 0; idx < 4; idx++) {
+		_auto_gain.ptr[idx] += (target.ptr[idx] - _auto_gain.ptr[idx]) * factor;
+		if (std::abs(_auto_gain.ptr[idx] - _auto_gain_lut.ptr[idx]) > ST_AUTO_THRESHOLD) {
+			_lut_dirty = true;
+		}
+	}
+}
+
+void color_grade_instance::render_lut(std::shared_ptr<streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height)
+{
+	vec4 blank = vec4{0, 0, 0, 0};
+	auto op    = target->render(width, height);
+	gs_ortho(0, 1., 0, 1., 0, 1);
+
+	// Blank out the input cache.
+	gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
+
+	// Enable all colors for rendering.
+	gs_enable_color(true, true, true, true);
+
+	// Prevent blending with existing content, even if it is cleared.
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	// Disable depth testing.
+	gs_enable_depth_test(false);
+
+	// Disable stencil testing.
+	gs_enable_stencil_test(false);
+
+	// Disable culling.
+	gs_set_cull_mode(GS_NEITHER);
+
+	auto effect = _lut_consumer->prepare(_lut_depth, _lut_texture);
+	effect->get_parameter("image").set_texture(_ccache_texture);
+	while (gs_effect_loop(effect->get_object(), "Draw")) {
+		_gfx_util->draw_fullscreen_triangle();
+	}
+
+	// Restore original blend mode.
+	gs_blend_state_pop();
+}
+
+void color_grade_instance::render_direct(std::shared_ptr<streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height)
+{
+	vec4 blank = vec4{0, 0, 0, 0};
+	auto op    = target->render(width, height);
+	gs_ortho(0, 1, 0, 1, 0, 1);
+
+	prepare_effect();
+
+	// Blank out the input cache.
+	gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
+
+	// Enable all colors for rendering.
+	gs_enable_color(true, true, true, true);
+
+	// Prevent blending with existing content, even if it is cleared.
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	// Disable depth testing.
+	gs_enable_depth_test(false);
+
+	// Disable stencil testing.
+	gs_enable_stencil_test(false);
+
+	// Disable culling.
+	gs_set_cull_mode(GS_NEITHER);
+
+	// Render the effect.
+	_effect.get_parameter("image").set_texture(_ccache_texture);
+	while (gs_effect_loop(_effect.get_object(), _effect_technique.c_str())) {
+		_gfx_util->draw_fullscreen_triangle();
+	}
+
+	// Restore original blend mode.
+	gs_blend_state_pop();
+}
+
+#ifdef ENABLE_PROFILING
+void color_grade_instance::start_benchmark()
+{
+	_benchmark_frames = ST_BENCHMARK_FRAMES;
+}
+
+void color_grade_instance::benchmark(uint32_t width, uint32_t height)
+{
+#if !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Benchmark"};
+#endif
+	if (!_benchmark_rt) {
+		try {
+			_benchmark_direct = std::make_shared<streamfx::obs::gs::timer>(streamfx::util::profiler::create("Direct"));
+			_benchmark_lut    = std::make_shared<streamfx::obs::gs::timer>(streamfx::util::profiler::create("LUT"));
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("Benchmark is unavailable: %s", ex.what());
+			_benchmark_frames = 0;
+			return;
+		}
+		_benchmark_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		D_LOG_INFO("Benchmarking '%s' at %" PRIu32 "x%" PRIu32 " for %zu frames...", obs_source_get_name(_self), width, height, _benchmark_frames);
+	}
+
+	// Both paths render the same input into a scratch target, which the output never sees.
+	{
+		streamfx::obs::gs::timer_scope ts{_benchmark_direct};
+		render_direct(_benchmark_rt, width, height);
+	}
+	if (_lut_initialized) {
+		try {
+			if (_lut_dirty || !_lut_texture) {
+				rebuild_lut();
+			}
+
+			streamfx::obs::gs::timer_scope ts{_benchmark_lut};
+			render_lut(_benchmark_rt, width, height);
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("Benchmark could not render with a LUT: %s", ex.what());
+		}
+	}
+
+	if (--_benchmark_frames > 0) {
+		return;
+	}
+
+	// Queries finish a few frames late, so the last couple of frames are not part of the result.
+	auto direct = _benchmark_direct->get_profiler();
+	auto lut    = _benchmark_lut->get_profiler();
+	D_LOG_INFO("Benchmark of '%s' finished: Direct %.3f ms (95th %.3f ms, %" PRIu64 " samples), LUT %.3f ms (95th %.3f ms, %" PRIu64 " samples).", obs_source_get_name(_self), direct->average_duration() / 1000000., static_cast<double_t>(direct->percentile(.95).count()) / 1000000., direct->count(), lut->average_duration() / 1000000., static_cast<double_t>(lut->percentile(.95).count()) / 1000000., lut->count());
+	if (lut->count() && direct->count() && (lut->average_duration() > direct->average_duration())) {
+		D_LOG_WARNING("LUT rendering of '%s' is slower than direct rendering on this GPU.", obs_source_get_name(_self));
+	}
+
+	_benchmark_direct.reset();
+	_benchmark_lut.reset();
+	_benchmark_rt.reset();
+}
+#endif
+
+bool color_grade_instance::render_fused(gs_effect_t* shader, uint32_t width, uint32_t height)
+{
+	// Anything that needs the captured input has to take the regular path.
+	if (!_lut_initialized || !(_lut_enabled || _file) || _auto_white_balance || _auto_exposure) {
+		return false;
+	}
+#ifdef ENABLE_PROFILING
+	if (_benchmark_frames > 0) {
+		return false;
+	}
+#endif
+
+	// Only a plain draw can be replaced with our own effect. When drawn more than once per frame, rendering everything
+	// above us every time costs more than the caches do.
+	if ((shader != obs_get_base_effect(OBS_EFFECT_DEFAULT)) || (_renders_previous > 1)) {
+		return false;
+	}
+
+	if (_lut_dirty) {
+		try {
+			rebuild_lut();
+		} catch (...) {
+			return false; // The regular path reports this and falls back.
+		}
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Fused LUT Rendering"};
+#endif
+
+	// Draw whatever is above us straight through the LUT into whoever consumes us. If the source above can be drawn
+	// directly, this needs no intermediate render target at all, otherwise only the one libobs keeps for every filter.
+	auto effect = _lut_consumer->prepare(_lut_depth, _lut_texture);
+	if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+		gs_enable_depth_test(false);
+		gs_enable_color(true, true, true, true);
+		gs_set_cull_mode(GS_NEITHER);
+		obs_source_process_filter_end(_self, effect->get_object(), width, height);
+	}
+	return true;
+}
+
+void color_grade_instance::video_tick(float time)
+{
+	_auto_time += time;
 	_ccache_fresh = false;
 	_cache_fresh  = false;
+
+	_renders_previous = _renders;
+	_renders          = 0;
 }
 
 void color_grade_instance::video_render(gs_effect_t* shader)
@@ -347,7 +741,7 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 
 	// Skip filter if anything is wrong.
 	if (!parent || !target || !width || !height) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -355,8 +749,12 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Color Grading '%s'", obs_source_get_name(_self)};
 #endif
 
-	// TODO: Optimize this once (https://github.com/obsproject/obs-studio/pull/4199) is merged.
-	// - We can skip the original capture and reduce the overall impact of this.
+	// 0. Skip all of our own caches if we can.
+	_renders++;
+	update_file();
+	if (render_fused(shader, width, height)) {
+		return;
+	}
 
 	// 1. Capture the filter/source rendered above this.
 	if (!_ccache_fresh || !_ccache_texture) {
@@ -410,10 +808,14 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 
 		// Mark the input cache as valid.
 		_ccache_fresh = true;
+
+		// Measure the fresh input for automatic corrections.
+		update_automatic();
 	}
 
-	// 2. Apply one of the two rendering methods (LUT or Direct).
-	if (_lut_initialized && _lut_enabled) { // Try to apply with the LUT based method.
+	// 2. Apply one of the two rendering methods (LUT or Direct). A LUT file can only be applied with the former.
+	bool use_lut = _lut_initialized && (_lut_enabled || _file);
+	if (use_lut) { // Try to apply with the LUT based method.
 		try {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "LUT Rendering"};
@@ -432,39 +834,8 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 			}
 
 			if (!_cache_fresh) {
-				{ // Render the source to the cache.
-					auto op = _cache_rt->render(width, height);
-					gs_ortho(0, 1., 0, 1., 0, 1);
-
-					// Blank out the input cache.
-					gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
-
-					// Enable all colors for rendering.
-					gs_enable_color(true, true, true, true);
-
-					// Prevent blending with existing content, even if it is cleared.
-					gs_blend_state_push();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-					// Disable depth testing.
-					gs_enable_depth_test(false);
-
-					// Disable stencil testing.
-					gs_enable_stencil_test(false);
-
-					// Disable culling.
-					gs_set_cull_mode(GS_NEITHER);
-
-					auto effect = _lut_consumer->prepare(_lut_depth, _lut_texture);
-					effect->get_parameter("image").set_texture(_ccache_texture);
-					while (gs_effect_loop(effect->get_object(), "Draw")) {
-						_gfx_util->draw_fullscreen_triangle();
-					}
-
-					// Restore original blend mode.
-					gs_blend_state_pop();
-				}
+				// Render the source to the cache.
+				render_lut(_cache_rt, width, height);
 
 				// Try and retrieve the render cache as a texture.
 				_cache_rt->get_texture(_cache_texture);
@@ -477,10 +848,12 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 			_lut_rt.reset();
 			_lut_texture.reset();
 			_lut_enabled = false;
+			_file.reset();
+			use_lut = false;
 			D_LOG_WARNING("Reverting to direct rendering due to error: %s", ex.what());
 		}
 	}
-	if ((!_lut_initialized || !_lut_enabled) && !_cache_fresh) {
+	if (!use_lut && !_cache_fresh) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Direct Rendering"};
 #endif
@@ -489,41 +862,8 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 			allocate_rendertarget(GS_RGBA);
 		}
 
-		{ // Render the source to the cache.
-			auto op = _cache_rt->render(width, height);
-			gs_ortho(0, 1, 0, 1, 0, 1);
-
-			prepare_effect();
-
-			// Blank out the input cache.
-			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
-
-			// Enable all colors for rendering.
-			gs_enable_color(true, true, true, true);
-
-			// Prevent blending with existing content, even if it is cleared.
-			gs_blend_state_push();
-			gs_enable_blending(false);
-			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-			// Disable depth testing.
-			gs_enable_depth_test(false);
-
-			// Disable stencil testing.
-			gs_enable_stencil_test(false);
-
-			// Disable culling.
-			gs_set_cull_mode(GS_NEITHER);
-
-			// Render the effect.
-			_effect.get_parameter("image").set_texture(_ccache_texture);
-			while (gs_effect_loop(_effect.get_object(), "Draw")) {
-				_gfx_util->draw_fullscreen_triangle();
-			}
-
-			// Restore original blend mode.
-			gs_blend_state_pop();
-		}
+		// Render the source to the cache.
+		render_direct(_cache_rt, width, height);
 
 		// Try and retrieve the render cache as a texture.
 		_cache_rt->get_texture(_cache_texture);
@@ -535,6 +875,12 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 		throw std::runtime_error("Failed to cache processed source.");
 	}
 
+#ifdef ENABLE_PROFILING
+	if (_benchmark_frames > 0) {
+		benchmark(width, height);
+	}
+#endif
+
 	// 3. Render the output cache.
 	{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -607,6 +953,9 @@ void color_grade_factory::get_defaults2(obs_data_t* data)
 	obs_data_set_default_double(data, ST_KEY_CORRECTION_(ST_CONTRAST), 100.0);
 
 	obs_data_set_default_int(data, ST_KEY_RENDERMODE, -1);
+	obs_data_set_default_string(data, ST_KEY_FILE, "");
+	obs_data_set_default_bool(data, ST_KEY_AUTOMATIC_(ST_WHITE_BALANCE), false);
+	obs_data_set_default_bool(data, ST_KEY_AUTOMATIC_(ST_EXPOSURE), false);
 }
 
 obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* data)
@@ -773,6 +1122,14 @@ obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* dat
 		}
 	}
 
+	{
+		obs_properties_t* grp = obs_properties_create();
+		obs_properties_add_group(pr, ST_KEY_AUTOMATIC, D_TRANSLATE(ST_I18N_AUTOMATIC), OBS_GROUP_NORMAL, grp);
+
+		obs_properties_add_bool(grp, ST_KEY_AUTOMATIC_(ST_WHITE_BALANCE), D_TRANSLATE(ST_I18N_AUTOMATIC_(ST_WHITE_BALANCE)));
+		obs_properties_add_bool(grp, ST_KEY_AUTOMATIC_(ST_EXPOSURE), D_TRANSLATE(ST_I18N_AUTOMATIC_(ST_EXPOSURE)));
+	}
+
 	{
 		obs_properties_t* grp = obs_properties_create();
 		obs_properties_add_group(pr, S_ADVANCED, D_TRANSLATE(S_ADVANCED), OBS_GROUP_NORMAL, grp);
@@ -805,11 +1162,27 @@ obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* dat
 				obs_property_list_add_int(p, D_TRANSLATE(kv.first), kv.second);
 			}
 		}
+
+#ifdef ENABLE_PROFILING
+		if (data) {
+			obs_properties_add_button2(grp, ST_KEY_BENCHMARK, D_TRANSLATE(ST_I18N_BENCHMARK), streamfx::filter::color_grade::color_grade_factory::on_benchmark, data);
+		}
+#endif
 	}
 
+	obs_properties_add_path(pr, ST_KEY_FILE, D_TRANSLATE(ST_I18N_FILE), OBS_PATH_FILE, "LUT (*.cube *.3dl);;* (*.*)", nullptr);
+
 	return pr;
 }
 
+#ifdef ENABLE_PROFILING
+bool color_grade_factory::on_benchmark(obs_properties_t* props, obs_property_t* property, void* data)
+{
+	reinterpret_cast<color_grade_instance*>(data)->start_benchmark();
+	return false;
+}
+#endif
+
 #ifdef ENABLE_FRONTEND
 bool color_grade_factory::on_manual_open(obs_properties_t* props, obs_property_t* property, void* data)
 {
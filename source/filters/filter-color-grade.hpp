@@ -3,17 +3,22 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-histogram.hpp"
 #include "gfx/gfx-mipmapper.hpp"
+#include "gfx/lut/gfx-lut-cache.hpp"
 #include "gfx/lut/gfx-lut-consumer.hpp"
 #include "gfx/lut/gfx-lut-producer.hpp"
 #include "gfx/lut/gfx-lut.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
+#include "obs/gs/gs-timer.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
 #include "obs/obs-source-factory.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <mutex>
+#include <string>
 #include <vector>
 #include "warning-enable.hpp"
 
@@ -34,6 +39,7 @@ namespace streamfx::filter::color_grade {
 
 	class color_grade_instance : public obs::source_instance {
 		streamfx::obs::gs::effect            _effect;
+		std::string                          _effect_technique;
 		std::shared_ptr<streamfx::gfx::util> _gfx_util;
 
 		// User Configuration
@@ -50,6 +56,10 @@ namespace streamfx::filter::color_grade {
 		vec4                            _correction;
 		bool                            _lut_enabled;
 		streamfx::gfx::lut::color_depth _lut_depth;
+		std::mutex                      _file_lock;
+		std::string                     _file_path;
+		bool                            _auto_white_balance;
+		bool                            _auto_exposure;
 
 		// Capture Cache
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _ccache_rt;
@@ -61,18 +71,43 @@ namespace streamfx::filter::color_grade {
 		bool                                             _lut_dirty;
 		std::shared_ptr<streamfx::gfx::lut::producer>    _lut_producer;
 		std::shared_ptr<streamfx::gfx::lut::consumer>    _lut_consumer;
+		std::shared_ptr<streamfx::gfx::lut::cache>       _lut_cache;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _lut_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _lut_texture;
 
+		// LUT file, applied on top of the grade.
+		std::string                                              _file_loaded_path;
+		std::shared_ptr<streamfx::gfx::lut::cache::file_request> _file_request;
+		std::shared_ptr<streamfx::gfx::lut::file>                _file;
+		std::shared_ptr<streamfx::obs::gs::rendertarget>         _file_rt;
+
+		// Automatic corrections, multiplied onto the gain.
+		std::shared_ptr<streamfx::gfx::histogram> _histogram;
+		vec4                                      _auto_gain;
+		vec4                                      _auto_gain_lut; // What the current LUT was built with.
+		float_t                                   _auto_time;
+
 		// Render Cache
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _cache_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _cache_texture;
 		bool                                             _cache_fresh;
+		uint32_t                                         _renders;
+		uint32_t                                         _renders_previous;
+
+#ifdef ENABLE_PROFILING
+		// Benchmark
+		size_t                                           _benchmark_frames;
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _benchmark_rt;
+		std::shared_ptr<streamfx::obs::gs::timer>        _benchmark_direct;
+		std::shared_ptr<streamfx::obs::gs::timer>        _benchmark_lut;
+#endif
 
 		public:
 		color_grade_instance(obs_data_t* data, obs_source_t* self);
 		virtual ~color_grade_instance();
 
+		virtual void create_resources() override;
+
 		void allocate_rendertarget(gs_color_format format);
 
 		virtual void load(obs_data_t* data) override;
@@ -83,6 +118,27 @@ namespace streamfx::filter::color_grade {
 
 		void rebuild_lut();
 
+		void update_file();
+
+		void update_automatic();
+
+		void render_lut(std::shared_ptr<streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height);
+
+		void render_direct(std::shared_ptr<streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height);
+
+		/** Apply the LUT while drawing the source above into our consumer, without any caches of our own.
+		 *
+		 * @return true if the frame was rendered this way.
+		 */
+		bool render_fused(gs_effect_t* shader, uint32_t width, uint32_t height);
+
+#ifdef ENABLE_PROFILING
+		/** Measure the GPU time of both the direct and the LUT path over the next few frames, and log the result. */
+		void start_benchmark();
+
+		void benchmark(uint32_t width, uint32_t height);
+#endif
+
 		virtual void video_tick(float_t time) override;
 		virtual void video_render(gs_effect_t* effect) override;
 	};
@@ -102,6 +158,10 @@ namespace streamfx::filter::color_grade {
 		static bool on_manual_open(obs_properties_t* props, obs_property_t* property, void* data);
 #endif
 
+#ifdef ENABLE_PROFILING
+		static bool on_benchmark(obs_properties_t* props, obs_property_t* property, void* data);
+#endif
+
 		public: // Singleton
 		static std::shared_ptr<color_grade_factory> instance();
 	};
@@ -3,12 +3,16 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "filter-denoising.hpp"
+#include "configuration.hpp"
+#include "gfx/gfx-quality.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-source-handoff.hpp"
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <array>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -29,6 +33,26 @@
 #define ST_KEY_PROVIDER "Provider"
 #define ST_I18N_PROVIDER ST_I18N "." ST_KEY_PROVIDER
 #define ST_I18N_PROVIDER_NVIDIA_DENOISING ST_I18N_PROVIDER ".NVIDIA.Denoising"
+#define ST_I18N_PROVIDER_TEMPORAL ST_I18N_PROVIDER ".Temporal"
+#define ST_KEY_ROI "RegionOfInterest"
+#define ST_I18N_ROI ST_I18N "." ST_KEY_ROI
+#define ST_KEY_ROI_LEFT "RegionOfInterest.Left"
+#define ST_I18N_ROI_LEFT ST_I18N "." ST_KEY_ROI_LEFT
+#define ST_KEY_ROI_TOP "RegionOfInterest.Top"
+#define ST_I18N_ROI_TOP ST_I18N "." ST_KEY_ROI_TOP
+#define ST_KEY_ROI_RIGHT "RegionOfInterest.Right"
+#define ST_I18N_ROI_RIGHT ST_I18N "." ST_KEY_ROI_RIGHT
+#define ST_KEY_ROI_BOTTOM "RegionOfInterest.Bottom"
+#define ST_I18N_ROI_BOTTOM ST_I18N "." ST_KEY_ROI_BOTTOM
+
+#define ST_KEY_TEMPORAL "Temporal"
+#define ST_I18N_TEMPORAL ST_I18N "." ST_KEY_TEMPORAL
+#define ST_KEY_TEMPORAL_STRENGTH "Temporal.Strength"
+#define ST_I18N_TEMPORAL_STRENGTH ST_I18N "." ST_KEY_TEMPORAL_STRENGTH
+#define ST_KEY_TEMPORAL_THRESHOLD "Temporal.Threshold"
+#define ST_I18N_TEMPORAL_THRESHOLD ST_I18N "." ST_KEY_TEMPORAL_THRESHOLD
+#define ST_KEY_TEMPORAL_SPATIAL "Temporal.Spatial"
+#define ST_I18N_TEMPORAL_SPATIAL ST_I18N "." ST_KEY_TEMPORAL_SPATIAL
 
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 #define ST_KEY_NVIDIA_DENOISING "NVIDIA.Denoising"
@@ -37,6 +61,12 @@
 #define ST_I18N_NVIDIA_DENOISING_STRENGTH ST_I18N "." ST_KEY_NVIDIA_DENOISING_STRENGTH
 #define ST_I18N_NVIDIA_DENOISING_STRENGTH_WEAK ST_I18N_NVIDIA_DENOISING_STRENGTH ".Weak"
 #define ST_I18N_NVIDIA_DENOISING_STRENGTH_STRONG ST_I18N_NVIDIA_DENOISING_STRENGTH ".Strong"
+#define ST_KEY_NVIDIA_DENOISING_PIPELINED "NVIDIA.Denoising.Pipelined"
+#define ST_I18N_NVIDIA_DENOISING_PIPELINED ST_I18N "." ST_KEY_NVIDIA_DENOISING_PIPELINED
+#define ST_KEY_NVIDIA_DENOISING_PRECISION "NVIDIA.Denoising.Precision"
+#define ST_I18N_NVIDIA_DENOISING_PRECISION ST_I18N "." ST_KEY_NVIDIA_DENOISING_PRECISION
+#define ST_I18N_NVIDIA_DENOISING_PRECISION_FULL ST_I18N_NVIDIA_DENOISING_PRECISION ".Full"
+#define ST_I18N_NVIDIA_DENOISING_PRECISION_HALF ST_I18N_NVIDIA_DENOISING_PRECISION ".Half"
 #endif
 
 using streamfx::filter::denoising::denoising_factory;
@@ -47,6 +77,7 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
 
 static denoising_provider provider_priority[] = {
 	denoising_provider::NVIDIA_DENOISING,
+	denoising_provider::TEMPORAL,
 };
 
 const char* streamfx::filter::denoising::cstring(denoising_provider provider)
@@ -58,6 +89,8 @@ const char* streamfx::filter::denoising::cstring(denoising_provider provider)
 		return D_TRANSLATE(S_STATE_AUTOMATIC);
 	case denoising_provider::NVIDIA_DENOISING:
 		return D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_DENOISING);
+	case denoising_provider::TEMPORAL:
+		return D_TRANSLATE(ST_I18N_PROVIDER_TEMPORAL);
 	default:
 		throw std::runtime_error("Missing Conversion Entry");
 	}
@@ -68,13 +101,36 @@ std::string streamfx::filter::denoising::string(denoising_provider provider)
 	return cstring(provider);
 }
 
+/** Crop the size to the region of interest, and return the part of the frame it covers as left, right, top, bottom.
+ *
+ * At least a single pixel always remains, no matter how large the region is set.
+ */
+static vec4 apply_roi(std::array<uint32_t, 4> const& roi, uint32_t& width, uint32_t& height)
+{
+	vec4 area;
+	vec4_set(&area, 0., 1., 0., 1.);
+	if ((width == 0) || (height == 0)) {
+		return area;
+	}
+
+	uint32_t left   = std::min<uint32_t>(roi[0], width - 1);
+	uint32_t top    = std::min<uint32_t>(roi[1], height - 1);
+	uint32_t right  = std::min<uint32_t>(roi[2], width - 1 - left);
+	uint32_t bottom = std::min<uint32_t>(roi[3], height - 1 - top);
+
+	vec4_set(&area, static_cast<float>(left) / static_cast<float>(width), static_cast<float>(width - right) / static_cast<float>(width), static_cast<float>(top) / static_cast<float>(height), static_cast<float>(height - bottom) / static_cast<float>(height));
+	width -= left + right;
+	height -= top + bottom;
+	return area;
+}
+
 //------------------------------------------------------------------------------
 // Instance
 //------------------------------------------------------------------------------
 denoising_instance::denoising_instance(obs_data_t* data, obs_source_t* self)
 	: obs::source_instance(data, self),
 
-	  _size(1, 1), _provider(denoising_provider::INVALID), _provider_ui(denoising_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _input(), _output()
+	  _size(1, 1), _roi(), _provider(denoising_provider::INVALID), _provider_ui(denoising_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _input(), _input_color(), _input_alpha(), _output(), _temporal_effect(), _temporal_util(), _temporal_spatial(), _temporal_history(), _temporal_index(0), _temporal_valid(false), _temporal_strength(.8f), _temporal_threshold(.05f), _temporal_range(0)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -84,10 +140,12 @@ denoising_instance::denoising_instance(obs_data_t* data, obs_source_t* self)
 		// Create the render target for the input buffering.
 		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
 		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
-		_output = _input->get_texture();
+		_input_color = _input->get_texture();
+		_input_alpha = _input_color;
+		_output      = _input_color;
 
 		// Load the required effect.
-		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
+		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::obs::gs::effect_registry::instance()->get(::streamfx::data_file_path("effects/standard.effect")));
 
 		// Create Samplers
 		_channel0_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
@@ -103,11 +161,14 @@ denoising_instance::denoising_instance(obs_data_t* data, obs_source_t* self)
 	if (data) {
 		load(data);
 	}
+
+	::streamfx::obs::handoff::offer(_self, true);
 }
 
 denoising_instance::~denoising_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+	::streamfx::obs::handoff::offer(_self, false);
 
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
@@ -126,6 +187,9 @@ denoising_instance::~denoising_instance()
 			nvvfx_denoising_unload();
 			break;
 #endif
+		case denoising_provider::TEMPORAL:
+			temporal_unload();
+			break;
 		default:
 			break;
 		}
@@ -141,6 +205,9 @@ void denoising_instance::migrate(obs_data_t* data, uint64_t version) {}
 
 void denoising_instance::update(obs_data_t* data)
 {
+	// Only the region of interest is processed, everything around it is cropped away.
+	_roi = {static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_LEFT)), static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_TOP)), static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_RIGHT)), static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_BOTTOM))};
+
 	// Check if the user changed which Denoising provider we use.
 	denoising_provider provider = static_cast<denoising_provider>(obs_data_get_int(data, ST_KEY_PROVIDER));
 	if (provider == denoising_provider::AUTOMATIC) {
@@ -162,6 +229,9 @@ void denoising_instance::update(obs_data_t* data)
 			nvvfx_denoising_update(data);
 			break;
 #endif
+		case denoising_provider::TEMPORAL:
+			temporal_update(data);
+			break;
 		default:
 			break;
 		}
@@ -170,12 +240,25 @@ void denoising_instance::update(obs_data_t* data)
 
 void streamfx::filter::denoising::denoising_instance::properties(obs_properties_t* properties)
 {
+	{ // Region of Interest
+		auto grp = obs_properties_create();
+		obs_properties_add_group(properties, ST_KEY_ROI, D_TRANSLATE(ST_I18N_ROI), OBS_GROUP_NORMAL, grp);
+
+		for (auto [key, name] : {std::pair{ST_KEY_ROI_LEFT, ST_I18N_ROI_LEFT}, std::pair{ST_KEY_ROI_TOP, ST_I18N_ROI_TOP}, std::pair{ST_KEY_ROI_RIGHT, ST_I18N_ROI_RIGHT}, std::pair{ST_KEY_ROI_BOTTOM, ST_I18N_ROI_BOTTOM}}) {
+			auto p = obs_properties_add_int(grp, key, D_TRANSLATE(name), 0, 16384, 1);
+			obs_property_int_set_suffix(p, " px");
+		}
+	}
+
 	switch (_provider_ui) {
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 	case denoising_provider::NVIDIA_DENOISING:
 		nvvfx_denoising_properties(properties);
 		break;
 #endif
+	case denoising_provider::TEMPORAL:
+		temporal_properties(properties);
+		break;
 	default:
 		break;
 	}
@@ -200,6 +283,7 @@ void denoising_instance::video_tick(float_t time)
 
 	// Verify that the detected size makes sense.
 	if ((width > 0) && (height > 0)) {
+		apply_roi(_roi, width, height);
 		_size = {width, height};
 	}
 
@@ -238,7 +322,7 @@ void denoising_instance::video_render(gs_effect_t* effect)
 	// - We don't have a target.
 	// - The width/height of the next filter in the chain is empty.
 	if (!_provider_ready || !target || (width == 0) || (height == 0)) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -247,6 +331,9 @@ void denoising_instance::video_render(gs_effect_t* effect)
 	::streamfx::obs::gs::debug_marker profiler0_0{::streamfx::obs::gs::debug_color_gray, "'%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(parent)};
 #endif
 
+	// Only the region of interest is captured.
+	vec4 area = apply_roi(_roi, width, height);
+
 	if (_dirty) { // Lock the provider from being changed.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -263,16 +350,21 @@ void denoising_instance::video_render(gs_effect_t* effect)
 			}
 		}
 
-		{ // Capture the incoming frame.
+		{ // Capture the incoming frame, or take it as it is from the filter below if that can hand it over.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_capture, "Capture"};
 #endif
-			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+			bool                             whole    = (_roi[0] == 0) && (_roi[1] == 0) && (_roi[2] == 0) && (_roi[3] == 0) && (_size.first == width) && (_size.second == height);
+			::streamfx::obs::handoff::result received = {};
+			if (whole && ::streamfx::obs::handoff::receive(target, _input, _size.first, _size.second, received)) {
+				_input_color = received.color;
+				_input_alpha = received.alpha;
+			} else if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
 				auto op = _input->render(_size.first, _size.second);
 
 				// Matrix
 				gs_matrix_push();
-				gs_ortho(0., 1., 0., 1., 0., 1.);
+				gs_ortho(area.x, area.y, area.z, area.w, 0., 1.);
 
 				// Clear the buffer
 				gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
@@ -294,8 +386,11 @@ void denoising_instance::video_render(gs_effect_t* effect)
 				// Reset GPU state
 				gs_blend_state_pop();
 				gs_matrix_pop();
+
+				_input_color = _input->get_texture();
+				_input_alpha = _input_color;
 			} else {
-				obs_source_skip_video_filter(_self);
+				skip_video_filter();
 				return;
 			}
 		}
@@ -310,18 +405,21 @@ void denoising_instance::video_render(gs_effect_t* effect)
 				nvvfx_denoising_process();
 				break;
 #endif
+			case denoising_provider::TEMPORAL:
+				temporal_process();
+				break;
 			default:
 				_output.reset();
 				break;
 			}
 		} catch (...) {
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 
 		if (!_output) {
 			D_LOG_ERROR("Provider '%s' did not return a result.", cstring(_provider));
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 
@@ -331,6 +429,11 @@ void denoising_instance::video_render(gs_effect_t* effect)
 		// Unlock the provider, as we are no longer doing critical work with it.
 	}
 
+	// The filter above may take the result as it is, which saves drawing it here and capturing it again there.
+	if (::streamfx::obs::handoff::provide(_self, {_output, _input_alpha})) {
+		return;
+	}
+
 	{ // Draw the result for the next filter to use.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Render"};
@@ -339,7 +442,7 @@ void denoising_instance::video_render(gs_effect_t* effect)
 			_standard_effect->get_parameter("InputA").set_texture(_output);
 		}
 		if (_standard_effect->has_parameter("InputB", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
-			_standard_effect->get_parameter("InputB").set_texture(_input->get_texture());
+			_standard_effect->get_parameter("InputB").set_texture(_input_alpha);
 		}
 		while (gs_effect_loop(_standard_effect->get_object(), "RestoreAlpha")) {
 			gs_draw_sprite(nullptr, 0, _size.first, _size.second);
@@ -385,7 +488,7 @@ void streamfx::filter::denoising::denoising_instance::switch_provider(denoising_
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&denoising_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->push(std::bind(&denoising_instance::task_switch_provider, this, std::placeholders::_1), spd, util::threadpool::priority::BACKGROUND);
 }
 
 void streamfx::filter::denoising::denoising_instance::task_switch_provider(util::threadpool::task_data_t data)
@@ -406,6 +509,9 @@ void streamfx::filter::denoising::denoising_instance::task_switch_provider(util:
 			nvvfx_denoising_unload();
 			break;
 #endif
+		case denoising_provider::TEMPORAL:
+			temporal_unload();
+			break;
 		default:
 			break;
 		}
@@ -417,6 +523,14 @@ void streamfx::filter::denoising::denoising_instance::task_switch_provider(util:
 			nvvfx_denoising_load();
 			break;
 #endif
+		case denoising_provider::TEMPORAL:
+			temporal_load();
+			{
+				auto data = obs_source_get_settings(_self);
+				temporal_update(data);
+				obs_data_release(data);
+			}
+			break;
 		default:
 			break;
 		}
@@ -454,11 +568,11 @@ void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_size()
 void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_process()
 {
 	if (!_nvidia_fx) {
-		_output = _input->get_texture();
+		_output = _input_color;
 		return;
 	}
 
-	_output = _nvidia_fx->process(_input->get_texture());
+	_output = _nvidia_fx->process(_input_color);
 }
 
 void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_properties(obs_properties_t* props)
@@ -471,6 +585,16 @@ void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_properties
 		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_DENOISING_STRENGTH_WEAK), 0);
 		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_DENOISING_STRENGTH_STRONG), 1);
 	}
+
+	{
+		obs_properties_add_bool(grp, ST_KEY_NVIDIA_DENOISING_PIPELINED, D_TRANSLATE(ST_I18N_NVIDIA_DENOISING_PIPELINED));
+	}
+
+	{
+		auto p = obs_properties_add_list(grp, ST_KEY_NVIDIA_DENOISING_PRECISION, D_TRANSLATE(ST_I18N_NVIDIA_DENOISING_PRECISION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_DENOISING_PRECISION_FULL), 0);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_DENOISING_PRECISION_HALF), 1);
+	}
 }
 
 void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_update(obs_data_t* data)
@@ -479,10 +603,127 @@ void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_update(obs
 		return;
 
 	_nvidia_fx->set_strength(static_cast<float>(obs_data_get_int(data, ST_KEY_NVIDIA_DENOISING_STRENGTH) == 0 ? 0. : 1.));
+	_nvidia_fx->set_pipelined(obs_data_get_bool(data, ST_KEY_NVIDIA_DENOISING_PIPELINED));
+	_nvidia_fx->set_half_precision(obs_data_get_int(data, ST_KEY_NVIDIA_DENOISING_PRECISION) == 1);
 }
 
 #endif
 
+void streamfx::filter::denoising::denoising_instance::temporal_load()
+{
+	::streamfx::obs::gs::context gctx;
+
+	_temporal_effect  = ::streamfx::obs::gs::effect_registry::instance()->get(::streamfx::data_file_path("effects/denoising.effect"));
+	_temporal_util    = ::streamfx::gfx::util::get();
+	_temporal_spatial = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	for (auto& history : _temporal_history) {
+		history = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	}
+	_temporal_valid = false;
+}
+
+void streamfx::filter::denoising::denoising_instance::temporal_unload()
+{
+	::streamfx::obs::gs::context gctx;
+
+	for (auto& history : _temporal_history) {
+		history.reset();
+	}
+	_temporal_spatial.reset();
+	_temporal_util.reset();
+	_temporal_effect.reset();
+	_temporal_valid = false;
+}
+
+void streamfx::filter::denoising::denoising_instance::temporal_process()
+{
+	if (!_temporal_effect) {
+		_output = _input_color;
+		return;
+	}
+
+	auto input    = _input_color;
+	auto previous = _temporal_history[_temporal_index];
+	auto next     = _temporal_history[_temporal_index ^ 1];
+
+	// The previous result is meaningless if the size changed since.
+	if (_temporal_valid) {
+		auto texture    = previous->get_texture();
+		_temporal_valid = texture && (texture->get_width() == _size.first) && (texture->get_height() == _size.second);
+	}
+
+	::streamfx::obs::gs::state::push();
+	::streamfx::obs::gs::state::apply_opaque();
+
+	_temporal_effect.get_parameter("InputTexel").set_float2(1.f / static_cast<float>(_size.first), 1.f / static_cast<float>(_size.second));
+
+	if (_temporal_range > 0) { // Smooth what the previous frame can't help with, such as anything in motion.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Spatial"};
+#endif
+		_temporal_effect.get_parameter("InputA").set_texture(input);
+		_temporal_effect.get_parameter("Range").set_float(_temporal_range);
+
+		auto op = _temporal_spatial->render(_size.first, _size.second);
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+		while (gs_effect_loop(_temporal_effect.get_object(), "Spatial")) {
+			_temporal_util->draw_fullscreen_triangle();
+		}
+		input = _temporal_spatial->get_texture();
+	}
+
+	{ // Blend with the previous result.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Temporal"};
+#endif
+		_temporal_effect.get_parameter("InputA").set_texture(input);
+		_temporal_effect.get_parameter("InputB").set_texture(_temporal_valid ? previous->get_texture() : input);
+		_temporal_effect.get_parameter("Strength").set_float(_temporal_valid ? _temporal_strength : 0.f);
+		_temporal_effect.get_parameter("Threshold").set_float(_temporal_threshold);
+
+		auto op = next->render(_size.first, _size.second);
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+		while (gs_effect_loop(_temporal_effect.get_object(), "Temporal")) {
+			_temporal_util->draw_fullscreen_triangle();
+		}
+	}
+
+	::streamfx::obs::gs::state::pop();
+
+	// Ping-pong, so that this result is the history of the next frame.
+	_output = next->get_texture();
+	_temporal_index ^= 1;
+	_temporal_valid = true;
+}
+
+void streamfx::filter::denoising::denoising_instance::temporal_properties(obs_properties_t* props)
+{
+	obs_properties_t* grp = obs_properties_create();
+	obs_properties_add_group(props, ST_KEY_TEMPORAL, D_TRANSLATE(ST_I18N_TEMPORAL), OBS_GROUP_NORMAL, grp);
+
+	{
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_TEMPORAL_STRENGTH, D_TRANSLATE(ST_I18N_TEMPORAL_STRENGTH), 0.00, 95.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+
+	{
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_TEMPORAL_THRESHOLD, D_TRANSLATE(ST_I18N_TEMPORAL_THRESHOLD), 0.10, 50.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+
+	{
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_TEMPORAL_SPATIAL, D_TRANSLATE(ST_I18N_TEMPORAL_SPATIAL), 0.00, 50.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+}
+
+void streamfx::filter::denoising::denoising_instance::temporal_update(obs_data_t* data)
+{
+	_temporal_strength  = static_cast<float>(obs_data_get_double(data, ST_KEY_TEMPORAL_STRENGTH) / 100.);
+	_temporal_threshold = static_cast<float>(obs_data_get_double(data, ST_KEY_TEMPORAL_THRESHOLD) / 100.);
+	_temporal_range     = static_cast<float>(obs_data_get_double(data, ST_KEY_TEMPORAL_SPATIAL) / 100.);
+}
+
 //------------------------------------------------------------------------------
 // Factory
 //------------------------------------------------------------------------------
@@ -490,39 +731,14 @@ denoising_factory::~denoising_factory() {}
 
 denoising_factory::denoising_factory()
 {
-	bool any_available = false;
-
-	// 1. Try and load any configured providers.
+	// 1. Check which providers were available last time. Loading them takes a while, so it waits until they are needed.
+	//    The temporal provider works on any GPU, so unlike other filters this one is never hidden.
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available with unknown error.", nullptr);
-	}
+	_nvidia_loaded    = false;
+	_nvidia_available = streamfx::configuration::instance()->get_availability("Filter.Denoising.NVIDIA").value_or(true);
 #endif
 
-	// 2. Check if any of them managed to load at all.
-	if (!any_available) {
-		D_LOG_ERROR("All supported providers failed to initialize, disabling effect.", 0);
-		return;
-	}
-
-	// 3. In any other case, register the filter!
+	// 2. Register the filter.
 	_info.id           = S_PREFIX "filter-denoising";
 	_info.type         = OBS_SOURCE_TYPE_FILTER;
 	_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW;
@@ -542,9 +758,19 @@ const char* denoising_factory::get_name()
 void denoising_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_int(data, ST_KEY_PROVIDER, static_cast<int64_t>(denoising_provider::AUTOMATIC));
+	obs_data_set_default_int(data, ST_KEY_ROI_LEFT, 0);
+	obs_data_set_default_int(data, ST_KEY_ROI_TOP, 0);
+	obs_data_set_default_int(data, ST_KEY_ROI_RIGHT, 0);
+	obs_data_set_default_int(data, ST_KEY_ROI_BOTTOM, 0);
+
+	obs_data_set_default_double(data, ST_KEY_TEMPORAL_STRENGTH, 80.);
+	obs_data_set_default_double(data, ST_KEY_TEMPORAL_THRESHOLD, 5.);
+	obs_data_set_default_double(data, ST_KEY_TEMPORAL_SPATIAL, 0.);
 
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 	obs_data_set_default_double(data, ST_KEY_NVIDIA_DENOISING_STRENGTH, 1.);
+	obs_data_set_default_bool(data, ST_KEY_NVIDIA_DENOISING_PIPELINED, false);
+	obs_data_set_default_int(data, ST_KEY_NVIDIA_DENOISING_PRECISION, (streamfx::gfx::resolve_quality_tier() == streamfx::gfx::quality_tier::Low) ? 1 : 0);
 #endif
 }
 
@@ -584,6 +810,7 @@ obs_properties_t* denoising_factory::get_properties2(denoising_instance* data)
 			obs_property_set_modified_callback(p, modified_provider);
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(denoising_provider::AUTOMATIC));
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_DENOISING), static_cast<int64_t>(denoising_provider::NVIDIA_DENOISING));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_TEMPORAL), static_cast<int64_t>(denoising_provider::TEMPORAL));
 		}
 	}
 
@@ -603,13 +830,50 @@ bool streamfx::filter::denoising::denoising_factory::is_provider_available(denoi
 	switch (provider) {
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 	case denoising_provider::NVIDIA_DENOISING:
-		return _nvidia_available;
+		return load_nvidia();
 #endif
+	case denoising_provider::TEMPORAL:
+		return true;
 	default:
 		return false;
 	}
 }
 
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+bool streamfx::filter::denoising::denoising_factory::load_nvidia()
+{
+	std::unique_lock<std::mutex> lock(_nvidia_lock);
+	if (_nvidia_loaded) {
+		return _nvidia_available;
+	}
+	_nvidia_loaded = true;
+
+	try {
+		// Load CVImage and Video Effects SDK.
+		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
+		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
+		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
+		_nvidia_available = true;
+	} catch (const std::exception& ex) {
+		_nvidia_available = false;
+		_nvvfx.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA providers available due to error: %s", ex.what());
+	} catch (...) {
+		_nvidia_available = false;
+		_nvvfx.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA providers available with unknown error.", nullptr);
+	}
+
+	// Remember the result, so that the next session knows whether to show the filter at all.
+	streamfx::configuration::instance()->set_availability("Filter.Denoising.NVIDIA", _nvidia_available);
+	return _nvidia_available;
+}
+#endif
+
 denoising_provider streamfx::filter::denoising::denoising_factory::find_ideal_provider()
 {
 	for (auto v : provider_priority) {
@@ -3,6 +3,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
@@ -11,6 +12,7 @@
 #include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -25,6 +27,7 @@ namespace streamfx::filter::denoising {
 		INVALID          = -1,
 		AUTOMATIC        = 0,
 		NVIDIA_DENOISING = 1,
+		TEMPORAL         = 2,
 	};
 
 	const char* cstring(denoising_provider provider);
@@ -33,6 +36,7 @@ namespace streamfx::filter::denoising {
 
 	class denoising_instance : public obs::source_instance {
 		std::pair<uint32_t, uint32_t> _size;
+		std::array<uint32_t, 4>       _roi; // Left, Top, Right, Bottom
 
 		denoising_provider                      _provider;
 		denoising_provider                      _provider_ui;
@@ -45,6 +49,8 @@ namespace streamfx::filter::denoising {
 		std::shared_ptr<::streamfx::obs::gs::sampler> _channel1_sampler;
 
 		std::shared_ptr<::streamfx::obs::gs::rendertarget> _input;
+		std::shared_ptr<::streamfx::obs::gs::texture>      _input_color; // Captured into _input, or handed over from below.
+		std::shared_ptr<::streamfx::obs::gs::texture>      _input_alpha;
 		std::shared_ptr<::streamfx::obs::gs::texture>      _output;
 		bool                                               _dirty;
 
@@ -52,6 +58,16 @@ namespace streamfx::filter::denoising {
 		std::shared_ptr<::streamfx::nvidia::vfx::denoising> _nvidia_fx;
 #endif
 
+		::streamfx::obs::gs::effect                                       _temporal_effect;
+		std::shared_ptr<::streamfx::gfx::util>                            _temporal_util;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget>                _temporal_spatial;
+		std::array<std::shared_ptr<::streamfx::obs::gs::rendertarget>, 2> _temporal_history;
+		size_t                                                            _temporal_index;
+		bool                                                              _temporal_valid;
+		float                                                             _temporal_strength;
+		float                                                             _temporal_threshold;
+		float                                                             _temporal_range;
+
 		public:
 		denoising_instance(obs_data_t* data, obs_source_t* self);
 		~denoising_instance() override;
@@ -79,10 +95,18 @@ namespace streamfx::filter::denoising {
 		void nvvfx_denoising_properties(obs_properties_t* props);
 		void nvvfx_denoising_update(obs_data_t* data);
 #endif
+
+		void temporal_load();
+		void temporal_unload();
+		void temporal_process();
+		void temporal_properties(obs_properties_t* props);
+		void temporal_update(obs_data_t* data);
 	};
 
 	class denoising_factory : public obs::source_factory<::streamfx::filter::denoising::denoising_factory, ::streamfx::filter::denoising::denoising_instance> {
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
+		std::mutex                                     _nvidia_lock;
+		bool                                           _nvidia_loaded;
 		bool                                           _nvidia_available;
 		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
 		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
@@ -105,6 +129,11 @@ namespace streamfx::filter::denoising {
 		bool               is_provider_available(denoising_provider);
 		denoising_provider find_ideal_provider();
 
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+		private:
+		bool load_nvidia();
+#endif
+
 		public: // Singleton
 		static void                                                              initialize();
 		static void                                                              finalize();
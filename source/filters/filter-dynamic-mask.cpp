@@ -9,6 +9,7 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <array>
 #include <sstream>
 #include <stdexcept>
@@ -54,17 +55,48 @@
 #define ST_I18N_DEBUG_TEXTURE ST_I18N ".Debug.Texture"
 #define ST_I18N_DEBUG_TEXTURE_BASE ST_I18N_DEBUG_TEXTURE ".Base"
 #define ST_I18N_DEBUG_TEXTURE_INPUT ST_I18N_DEBUG_TEXTURE ".Input"
+#define ST_I18N_OUTPUTS "Filter.DynamicMask.Outputs"
+#define ST_KEY_OUTPUTS "Filter.DynamicMask.Outputs"
+#define ST_I18N_OUTPUT "Filter.DynamicMask.Output"
+#define ST_I18N_OUTPUT_NAME "Filter.DynamicMask.Output.Name"
+
+#define ST_I18N_OUTPUTSOURCE "Source.DynamicMaskOutput"
+#define ST_I18N_OUTPUTSOURCE_NAME ST_I18N_OUTPUTSOURCE ".Name"
+#define ST_KEY_OUTPUTSOURCE_NAME "Name"
 
 using namespace streamfx::filter::dynamic_mask;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-Dynamic-Mask";
 
-static std::pair<channel, const char*> channel_translations[] = {
-	{channel::Red, S_CHANNEL_RED},
-	{channel::Green, S_CHANNEL_GREEN},
-	{channel::Blue, S_CHANNEL_BLUE},
-	{channel::Alpha, S_CHANNEL_ALPHA},
+// Every settings key of a channel, put together at compile time instead of for every update.
+struct channel_translation {
+	channel     id;
+	const char* name;
+	const char* group;
+	const char* value;
+	const char* multiplier;
+	const char* input[4];
+};
+#define ST_CHANNEL_TRANSLATION(PREFIX, ID, NAME) \
+	{ID, NAME, PREFIX ".Channel." NAME, PREFIX ".Channel.Value." NAME, PREFIX ".Channel.Multiplier." NAME, {PREFIX ".Channel.Input." NAME "." S_CHANNEL_RED, PREFIX ".Channel.Input." NAME "." S_CHANNEL_GREEN, PREFIX ".Channel.Input." NAME "." S_CHANNEL_BLUE, PREFIX ".Channel.Input." NAME "." S_CHANNEL_ALPHA}}
+
+// Same for every output, where the first output keeps the keys from before there were several.
+struct output_translation {
+	const char*         number;
+	const char*         group;
+	const char*         name;
+	channel_translation channels[4];
+};
+#define ST_OUTPUT_TRANSLATION(NUMBER, PREFIX) \
+	{NUMBER, PREFIX, PREFIX ".Name", {ST_CHANNEL_TRANSLATION(PREFIX, channel::Red, S_CHANNEL_RED), ST_CHANNEL_TRANSLATION(PREFIX, channel::Green, S_CHANNEL_GREEN), ST_CHANNEL_TRANSLATION(PREFIX, channel::Blue, S_CHANNEL_BLUE), ST_CHANNEL_TRANSLATION(PREFIX, channel::Alpha, S_CHANNEL_ALPHA)}}
+static constexpr output_translation output_translations[max_outputs] = {
+	ST_OUTPUT_TRANSLATION("1", ST_I18N),
+	ST_OUTPUT_TRANSLATION("2", ST_I18N ".Output.2"),
+	ST_OUTPUT_TRANSLATION("3", ST_I18N ".Output.3"),
+	ST_OUTPUT_TRANSLATION("4", ST_I18N ".Output.4"),
 };
+#undef ST_OUTPUT_TRANSLATION
+#undef ST_CHANNEL_TRANSLATION
 
 data::data()
 {
@@ -80,6 +112,46 @@ streamfx::obs::gs::effect data::channel_mask_fx()
 	return _channel_mask_fx;
 }
 
+std::shared_ptr<output> data::publish(std::string_view name)
+{
+	std::lock_guard<std::mutex> lock(_outputs_lock);
+
+	std::string key{name};
+	if (auto iter = _outputs.find(key); (iter != _outputs.end()) && !iter->second.expired()) {
+		return nullptr;
+	}
+
+	auto result   = std::make_shared<output>();
+	_outputs[key] = result;
+	return result;
+}
+
+std::shared_ptr<output> data::find(std::string_view name)
+{
+	std::lock_guard<std::mutex> lock(_outputs_lock);
+
+	if (auto iter = _outputs.find(std::string{name}); iter != _outputs.end()) {
+		return iter->second.lock();
+	}
+	return nullptr;
+}
+
+std::vector<std::string> data::outputs()
+{
+	std::lock_guard<std::mutex> lock(_outputs_lock);
+
+	std::vector<std::string> result;
+	for (auto iter = _outputs.begin(); iter != _outputs.end();) {
+		if (iter->second.expired()) {
+			iter = _outputs.erase(iter);
+		} else {
+			result.push_back(iter->first);
+			++iter;
+		}
+	}
+	return result;
+}
+
 std::shared_ptr<streamfx::filter::dynamic_mask::data> data::get()
 {
 	static std::mutex                                          instance_lock;
@@ -98,7 +170,10 @@ dynamic_mask_instance::dynamic_mask_instance(obs_data_t* settings, obs_source_t*
 	: obs::source_instance(settings, self), //
 	  _data(streamfx::filter::dynamic_mask::data::get()), //
 	  _gfx_util(::streamfx::gfx::util::get()), //
-	  _translation_map(), //
+	  _input_name(), //
+	  _input_pending(false), //
+	  _input_lock(), //
+	  _input_renamed(), //
 	  _input(), //
 	  _input_child(), //
 	  _input_vs(), //
@@ -106,25 +181,29 @@ dynamic_mask_instance::dynamic_mask_instance(obs_data_t* settings, obs_source_t*
 	  _have_base(false), //
 	  _base_rt(), //
 	  _base_tex(), //
-	  _base_color_space(GS_CS_SRGB), //
-	  _base_color_format(GS_RGBA), //
 	  _have_input(false), //
-	  _input_rt(), //
 	  _input_tex(), //
-	  _input_color_space(GS_CS_SRGB), //
-	  _input_color_format(GS_RGBA), //
 	  _have_final(false), //
 	  _final_rt(), //
 	  _final_tex(), //
-	  _channels(), //
-	  _precalc(), //
+	  _outputs(), //
+	  _output_count(1), //
 	  _debug_texture(-1) //
 {
+	// Follow the input through renames, even while it is not resolved yet.
+	_input_renamed = streamfx::obs::source_tracker::instance()->listen_rename([this](std::string_view old_name, std::string_view new_name) {
+		std::lock_guard<std::mutex> lock(_input_lock);
+		if (_input_name == old_name) {
+			_input_name = new_name;
+		}
+	});
+
 	update(settings);
 }
 
 dynamic_mask_instance::~dynamic_mask_instance()
 {
+	_input_renamed.reset();
 	release();
 }
 
@@ -137,56 +216,96 @@ void dynamic_mask_instance::migrate(obs_data_t* data, uint64_t version) {}
 
 void dynamic_mask_instance::update(obs_data_t* settings)
 {
-	// Update source.
+	// Update source, which is only looked up once the filter is shown. Loading a collection with many masks would
+	// otherwise look up every input at once, and fail for inputs that are loaded after the mask.
 	if (const char* v = obs_data_get_string(settings, ST_KEY_INPUT); (v != nullptr) && (v[0] != '\0')) {
-		if (!acquire(v))
-			DLOG_ERROR("Failed to acquire Input source '%s'.", v);
+		std::unique_lock<std::mutex> lock(_input_lock);
+		if (!_input || (_input_name != v)) {
+			_input_name = v;
+			lock.unlock();
+
+			release();
+			_input_pending = true;
+			if (_self.showing()) {
+				resolve();
+			}
+		}
 	} else {
+		{
+			std::lock_guard<std::mutex> lock(_input_lock);
+			_input_name.clear();
+		}
+		_input_pending = false;
 		release();
 	}
 
 	// Update data store
-	for (auto kv1 : channel_translations) {
-		auto found = _channels.find(kv1.first);
-		if (found == _channels.end()) {
-			_channels.insert({kv1.first, channel_data()});
-			found = _channels.find(kv1.first);
-			if (found == _channels.end()) {
-				assert(found != _channels.end());
-				throw std::runtime_error("Unable to insert element into data _store.");
+	_output_count = static_cast<size_t>(std::clamp<long long>(obs_data_get_int(settings, ST_KEY_OUTPUTS), 1, static_cast<long long>(max_outputs)));
+	for (size_t out = 0; out < max_outputs; out++) {
+		auto&       output      = _outputs[out];
+		auto const& translation = output_translations[out];
+
+		for (auto const& kv1 : translation.channels) {
+			auto found = output.channels.find(kv1.id);
+			if (found == output.channels.end()) {
+				output.channels.insert({kv1.id, channel_data()});
+				found = output.channels.find(kv1.id);
+				if (found == output.channels.end()) {
+					assert(found != output.channels.end());
+					throw std::runtime_error("Unable to insert element into data _store.");
+				}
+			}
+
+			found->second.value                                  = static_cast<float_t>(obs_data_get_double(settings, kv1.value));
+			output.precalc.base.ptr[static_cast<size_t>(kv1.id)] = found->second.value;
+
+			found->second.scale                                   = static_cast<float_t>(obs_data_get_double(settings, kv1.multiplier));
+			output.precalc.scale.ptr[static_cast<size_t>(kv1.id)] = found->second.scale;
+
+			vec4* ch = &output.precalc.matrix.x;
+			switch (kv1.id) {
+			case channel::Red:
+				ch = &output.precalc.matrix.x;
+				break;
+			case channel::Green:
+				ch = &output.precalc.matrix.y;
+				break;
+			case channel::Blue:
+				ch = &output.precalc.matrix.z;
+				break;
+			case channel::Alpha:
+				ch = &output.precalc.matrix.t;
+				break;
+			default:
+				break;
+			}
+
+			for (size_t idx = 0; idx < 4; idx++) {
+				found->second.values.ptr[idx] = static_cast<float_t>(obs_data_get_double(settings, kv1.input[idx]));
+				ch->ptr[idx]                  = found->second.values.ptr[idx];
 			}
 		}
 
-		std::string chv_key                               = std::string(ST_KEY_CHANNEL_VALUE) + "." + kv1.second;
-		found->second.value                               = static_cast<float_t>(obs_data_get_double(settings, chv_key.c_str()));
-		_precalc.base.ptr[static_cast<size_t>(kv1.first)] = found->second.value;
-
-		std::string chm_key                                = std::string(ST_KEY_CHANNEL_MULTIPLIER) + "." + kv1.second;
-		found->second.scale                                = static_cast<float_t>(obs_data_get_double(settings, chm_key.c_str()));
-		_precalc.scale.ptr[static_cast<size_t>(kv1.first)] = found->second.scale;
-
-		vec4* ch = &_precalc.matrix.x;
-		switch (kv1.first) {
-		case channel::Red:
-			ch = &_precalc.matrix.x;
-			break;
-		case channel::Green:
-			ch = &_precalc.matrix.y;
-			break;
-		case channel::Blue:
-			ch = &_precalc.matrix.z;
-			break;
-		case channel::Alpha:
-			ch = &_precalc.matrix.t;
-			break;
-		default:
-			break;
+		// The first output is the filter itself, the others are published for output sources to draw.
+		if (out == 0) {
+			continue;
+		} else if (out >= _output_count) {
+			output.name.clear();
+			std::atomic_store(&output.published, std::shared_ptr<streamfx::filter::dynamic_mask::output>());
+			continue;
 		}
 
-		for (auto kv2 : channel_translations) {
-			std::string ab_key                                       = std::string(ST_KEY_CHANNEL_INPUT) + "." + kv1.second + "." + kv2.second;
-			found->second.values.ptr[static_cast<size_t>(kv2.first)] = static_cast<float_t>(obs_data_get_double(settings, ab_key.c_str()));
-			ch->ptr[static_cast<size_t>(kv2.first)]                  = found->second.values.ptr[static_cast<size_t>(kv2.first)];
+		std::string name = obs_data_get_string(settings, translation.name);
+		if (name.empty()) {
+			name = std::string(obs_source_get_name(_self)) + " " + translation.number;
+		}
+		if ((name != output.name) || !output.published) {
+			output.name = name;
+			std::atomic_store(&output.published, std::shared_ptr<streamfx::filter::dynamic_mask::output>());
+			std::atomic_store(&output.published, _data->publish(name));
+			if (!output.published) {
+				DLOG_WARNING("Output '%s' is already published by another mask.", name.c_str());
+			}
 		}
 	}
 
@@ -197,84 +316,53 @@ void dynamic_mask_instance::save(obs_data_t* settings)
 {
 	if (auto source = _input.lock(); source) {
 		obs_data_set_string(settings, ST_KEY_INPUT, source.name().data());
+	} else if (_input_pending) {
+		std::lock_guard<std::mutex> lock(_input_lock);
+		obs_data_set_string(settings, ST_KEY_INPUT, _input_name.c_str());
 	}
 
-	for (auto kv1 : channel_translations) {
-		auto found = _channels.find(kv1.first);
-		if (found == _channels.end()) {
-			_channels.insert({kv1.first, channel_data()});
-			found = _channels.find(kv1.first);
-			if (found == _channels.end()) {
-				assert(found != _channels.end());
-				throw std::runtime_error("Unable to insert element into data _store.");
+	for (size_t out = 0; out < max_outputs; out++) {
+		auto& output = _outputs[out];
+		for (auto const& kv1 : output_translations[out].channels) {
+			auto found = output.channels.find(kv1.id);
+			if (found == output.channels.end()) {
+				output.channels.insert({kv1.id, channel_data()});
+				found = output.channels.find(kv1.id);
+				if (found == output.channels.end()) {
+					assert(found != output.channels.end());
+					throw std::runtime_error("Unable to insert element into data _store.");
+				}
 			}
-		}
-
-		std::string chv_key = std::string(ST_KEY_CHANNEL_VALUE) + "." + kv1.second;
-		obs_data_set_double(settings, chv_key.c_str(), static_cast<double_t>(found->second.value));
 
-		std::string chm_key = std::string(ST_KEY_CHANNEL_MULTIPLIER) + "." + kv1.second;
-		obs_data_set_double(settings, chm_key.c_str(), static_cast<double_t>(found->second.scale));
-
-		for (auto kv2 : channel_translations) {
-			std::string ab_key = std::string(ST_KEY_CHANNEL_INPUT) + "." + kv1.second + "." + kv2.second;
-			obs_data_set_double(settings, ab_key.c_str(), static_cast<double_t>(found->second.values.ptr[static_cast<size_t>(kv2.first)]));
+			obs_data_set_double(settings, kv1.value, static_cast<double_t>(found->second.value));
+			obs_data_set_double(settings, kv1.multiplier, static_cast<double_t>(found->second.scale));
+			for (size_t idx = 0; idx < 4; idx++) {
+				obs_data_set_double(settings, kv1.input[idx], static_cast<double_t>(found->second.values.ptr[idx]));
+			}
 		}
 	}
 }
 
-gs_color_space dynamic_mask_instance::video_get_color_space(size_t count, const gs_color_space* preferred_spaces)
-{
-	return _base_color_space;
-}
-
 void dynamic_mask_instance::video_tick(float time)
 {
+	// Inputs that did not exist yet when the filter was shown are picked up as soon as they do.
+	if (_input_pending && _self.showing()) {
+		resolve();
+	}
+
 	{ // Base Information
 		_have_base = false;
 
-		std::array<gs_color_space, 1> preferred_formats = {GS_CS_SRGB};
-		_base_color_space                               = obs_source_get_color_space(obs_filter_get_target(_self), preferred_formats.size(), preferred_formats.data());
-		switch (_base_color_space) {
-		case GS_CS_SRGB:
-			_base_color_format = GS_RGBA;
-			break;
-		case GS_CS_SRGB_16F:
-		case GS_CS_709_EXTENDED:
-		case GS_CS_709_SCRGB:
-			_base_color_format = GS_RGBA16F;
-			break;
-		default:
-			_base_color_format = GS_RGBA_UNORM;
-		}
-
-		if ((obs_source_get_output_flags(obs_filter_get_target(_self)) & OBS_SOURCE_SRGB) == OBS_SOURCE_SRGB) {
-			_base_srgb = (_base_color_space <= GS_CS_SRGB_16F);
-		} else {
-			_base_srgb = false;
-		}
+		// Whatever the target renders in is what everything else here is processed in.
+		negotiate_color_space(obs_filter_get_target(_self));
 	}
 
-	if (auto input = _input.lock(); input) { // Input Information
+	if (auto const& input = _input.resolve(); input) { // Input Information
 		_have_input = false;
 
-		std::array<gs_color_space, 1> preferred_formats = {GS_CS_SRGB};
-		_input_color_space                              = obs_source_get_color_space(input, preferred_formats.size(), preferred_formats.data());
-		switch (_input_color_space) {
-		case GS_CS_SRGB:
-			_input_color_format = GS_RGBA;
-			break;
-		case GS_CS_SRGB_16F:
-		case GS_CS_709_EXTENDED:
-		case GS_CS_709_SCRGB:
-			_input_color_format = GS_RGBA16F;
-			break;
-		default:
-			_input_color_format = GS_RGBA_UNORM;
-		}
-
+		// The input is captured straight into the working space, so the two never need converting to match.
 		if ((input.output_flags() & OBS_SOURCE_SRGB) == OBS_SOURCE_SRGB) {
-			_input_srgb = (_base_color_space <= GS_CS_SRGB_16F);
+			_input_srgb = (_color.space <= GS_CS_SRGB_16F);
 		} else {
 			_input_srgb = false;
 		}
@@ -283,7 +371,7 @@ void dynamic_mask_instance::video_tick(float time)
 	}
 
 	_have_final = false;
-	_final_srgb = _base_srgb;
+	_final_srgb = _color.srgb;
 }
 
 void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
@@ -294,7 +382,7 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 	obs_source_t* target         = obs_filter_get_target(_self);
 	uint32_t      width          = obs_source_get_base_width(target);
 	uint32_t      height         = obs_source_get_base_height(target);
-	auto          input          = _input.lock();
+	auto const&   input          = _input.resolve();
 
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Dynamic Mask '%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(obs_filter_get_parent(_self))};
@@ -309,26 +397,30 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 		return;
 	}
 
+	// Without texture debugging, the mask is applied while drawing the base, see below. Additional outputs need the base
+	// as a texture of its own.
+	bool direct = (_debug_texture < 0) && (_output_count <= 1);
+
 	// Capture the base texture for later rendering.
-	if (!_have_base) {
+	if (!_have_base && !direct) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Base Texture"};
 #endif
 		// Ensure the Render Target matches the expected format.
-		if (!_base_rt || (_base_rt->get_color_format() != _base_color_format)) {
-			_base_rt = std::make_shared<streamfx::obs::gs::rendertarget>(_base_color_format, GS_ZS_NONE);
+		if (!_base_rt || (_base_rt->get_color_format() != _color.format)) {
+			_base_rt = std::make_shared<streamfx::obs::gs::rendertarget>(_color.format, GS_ZS_NONE);
 		}
 
 		bool previous_srgb  = gs_framebuffer_srgb_enabled();
 		auto previous_lsrgb = gs_get_linear_srgb();
-		gs_set_linear_srgb(_base_srgb);
+		gs_set_linear_srgb(_color.srgb);
 		gs_enable_framebuffer_srgb(false);
 
 		// Begin rendering the source with a certain color space.
-		if (obs_source_process_filter_begin_with_color_space(_self, _base_color_format, _base_color_space, OBS_ALLOW_DIRECT_RENDERING)) {
+		if (obs_source_process_filter_begin_with_color_space(_self, _color.format, _color.space, OBS_ALLOW_DIRECT_RENDERING)) {
 			try {
 				{
-					auto op = _base_rt->render(width, height, _base_color_space);
+					auto op = _base_rt->render(width, height, _color.space);
 
 					// Push a new blend state to stack.
 					gs_blend_state_push();
@@ -391,71 +483,21 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 	if (!_have_input) {
 		if (!input) {
 			// Treat no selection as selecting the target filter.
-			_have_input         = _have_base;
-			_input_tex          = _base_tex;
-			_input_color_format = _base_color_format;
-			_input_color_space  = _base_color_space;
+			_have_input = _have_base;
+			_input_tex  = _base_tex;
 		} else {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_source, "Input '%s'", input.name().data()};
 #endif
-			// Ensure the Render Target matches the expected format.
-			if (!_input_rt || (_input_rt->get_color_format() != _input_color_format)) {
-				_input_rt = std::make_shared<streamfx::obs::gs::rendertarget>(_input_color_format, GS_ZS_NONE);
-			}
-
 			auto previous_lsrgb = gs_get_linear_srgb();
 			gs_set_linear_srgb(_input_srgb);
 			bool previous_srgb = gs_framebuffer_srgb_enabled();
 			gs_enable_framebuffer_srgb(false);
 
 			try {
-				{
-					auto op = _input_rt->render(input.width(), input.height(), _input_color_space);
-
-					// Push a new blend state to stack.
-					gs_blend_state_push();
-					gs_reset_blend_state();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-					try {
-						// Enable all channels.
-						gs_enable_color(true, true, true, true);
-
-						// Disable culling.
-						gs_set_cull_mode(GS_NEITHER);
-
-						// Disable depth testing.
-						gs_enable_depth_test(false);
-						gs_depth_function(GS_ALWAYS);
-
-						// Disable stencil testing
-						gs_enable_stencil_test(false);
-						gs_enable_stencil_write(false);
-						gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-						gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
-
-						// Set up rendering matrix.
-						gs_ortho(0, static_cast<float>(input.width()), 0, static_cast<float>(input.height()), -1., 1.);
-
-						{ // Clear to black.
-							vec4 clr = {0., 0., 0., 0.};
-							gs_clear(GS_CLEAR_COLOR, &clr, 0., 0);
-						}
-
-						// Render the source.
-						obs_source_video_render(input);
-
-						// Pop the old blend state.
-						gs_blend_state_pop();
-					} catch (...) {
-						gs_blend_state_pop();
-						throw;
-					}
-				}
-
-				_have_input = true;
-				_input_rt->get_texture(_input_tex);
+				// Other users of the same input share this render, as long as they want it in the same way.
+				_input_tex  = streamfx::gfx::source_texture::capture(input.get(), input.width(), input.height(), _color.format, _color.space, false);
+				_have_input = static_cast<bool>(_input_tex);
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Failed to capture input texture: %s", ex.what());
 			} catch (...) {
@@ -467,85 +509,64 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 		}
 	}
 
-	// Capture the final texture.
-	if (!_have_final && _have_base) {
+	// Apply the mask while drawing the base, which needs neither the base nor the final intermediate.
+	if (direct) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Final Calculation"};
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Render"};
 #endif
 
-		// Ensure the Render Target matches the expected format.
-		if (!_final_rt || (_final_rt->get_color_format() != _base_color_format)) {
-			_final_rt = std::make_shared<streamfx::obs::gs::rendertarget>(_base_color_format, GS_ZS_NONE);
+		if (input && !_have_input) {
+			_self.skip_video_filter();
+			return;
 		}
 
-		bool previous_srgb  = gs_framebuffer_srgb_enabled();
-		auto previous_lsrgb = gs_get_linear_srgb();
-		gs_enable_framebuffer_srgb(_final_srgb);
-		gs_set_linear_srgb(_final_srgb);
+		if (!obs_source_process_filter_begin_with_color_space(_self, _color.format, _color.space, OBS_ALLOW_DIRECT_RENDERING)) {
+			_self.skip_video_filter();
+			return;
+		}
 
-		try {
-			{
-				auto op = _final_rt->render(width, height);
-
-				// Push a new blend state to stack.
-				gs_blend_state_push();
-				gs_reset_blend_state();
-				gs_enable_blending(false);
-				gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-				try {
-					// Enable all channels.
-					gs_enable_color(true, true, true, true);
-
-					// Disable culling.
-					gs_set_cull_mode(GS_NEITHER);
-
-					// Disable depth testing.
-					gs_enable_depth_test(false);
-					gs_depth_function(GS_ALWAYS);
-
-					// Disable stencil testing
-					gs_enable_stencil_test(false);
-					gs_enable_stencil_write(false);
-					gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-					gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
-
-					// Set up rendering matrix.
-					gs_ortho(0, 1, 0, 1, -1., 1.);
-
-					{ // Clear to black.
-						vec4 clr = {0., 0., 0., 0.};
-						gs_clear(GS_CLEAR_COLOR, &clr, 0., 0);
-					}
+		const bool previous_srgb = gs_framebuffer_srgb_enabled();
+		gs_enable_framebuffer_srgb(gs_get_linear_srgb());
 
-					effect.get_parameter("pMaskInputA").set_texture(_base_tex, _base_srgb);
-					effect.get_parameter("pMaskInputB").set_texture(_input_tex, _input_srgb);
+		if (input) {
+			effect.get_parameter("pMaskInputB").set_texture(_input_tex, _input_srgb);
+		}
+		effect.get_parameter("pMaskBase").set_float4(_outputs[0].precalc.base);
+		effect.get_parameter("pMaskMatrix").set_matrix(_outputs[0].precalc.matrix);
+		effect.get_parameter("pMaskMultiplier").set_float4(_outputs[0].precalc.scale);
 
-					effect.get_parameter("pMaskBase").set_float4(_precalc.base);
-					effect.get_parameter("pMaskMatrix").set_matrix(_precalc.matrix);
-					effect.get_parameter("pMaskMultiplier").set_float4(_precalc.scale);
+		// Without an input, the base is its own mask.
+		_self.process_filter_tech_end(effect.get(), width, height, input ? "MaskDirect" : "MaskDirectSelf");
 
-					while (gs_effect_loop(effect.get(), "Mask")) {
-						_gfx_util->draw_fullscreen_triangle();
-					}
+		gs_enable_framebuffer_srgb(previous_srgb);
+		return;
+	}
 
-					// Pop the old blend state.
-					gs_blend_state_pop();
-				} catch (...) {
-					gs_blend_state_pop();
-					throw;
-				}
+	// Capture the final texture.
+	if (!_have_final && _have_base) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Final Calculation"};
+#endif
+		_final_tex  = render_mask(_final_rt, _outputs[0].precalc, width, height, _final_srgb);
+		_have_final = static_cast<bool>(_final_tex);
+	}
+
+	// Additional outputs share the base and input captured above, so each of them only costs a single draw.
+	if (_have_base && _have_input) {
+		for (size_t idx = 1; idx < _output_count; idx++) {
+			auto published = std::atomic_load(&_outputs[idx].published);
+			if (!published) {
+				continue;
 			}
 
-			_final_tex  = _final_rt->get_texture();
-			_have_final = true;
-		} catch (const std::exception& ex) {
-			DLOG_ERROR("Failed to render final texture: %s", ex.what());
-		} catch (...) {
-			DLOG_ERROR("Failed to render final texture.", nullptr);
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Output '%s'", _outputs[idx].name.c_str()};
+#endif
+			published->texture = render_mask(published->rt, _outputs[idx].precalc, width, height, _final_srgb);
+			published->srgb    = _final_srgb;
+			published->width   = width;
+			published->height  = height;
 		}
-
-		gs_set_linear_srgb(previous_lsrgb);
-		gs_enable_framebuffer_srgb(previous_srgb);
 	}
 
 	// Enable texture debugging
@@ -562,7 +583,7 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 
 	// Abort if we don't have a final render.
 	if (!_have_final || !_final_tex->get_object()) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -590,7 +611,7 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 		if (!param) {
 			DLOG_ERROR("<filter-dynamic-mask:%s> Failed to set image param.", obs_source_get_name(_self));
 			gs_enable_framebuffer_srgb(previous_srgb);
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		} else {
 			if (gs_get_linear_srgb()) {
@@ -607,6 +628,104 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 	}
 }
 
+void dynamic_mask_instance::evict()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	// video_tick() clears the _have_* flags, so video_render() recreates all of this on the next frame.
+	_base_rt.reset();
+	_base_tex.reset();
+	_input_tex.reset();
+	_final_rt.reset();
+	_final_tex.reset();
+	for (auto& output : _outputs) {
+		if (auto published = std::atomic_load(&output.published); published) {
+			published->rt.reset();
+			published->texture.reset();
+		}
+	}
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> dynamic_mask_instance::render_mask(std::shared_ptr<streamfx::obs::gs::rendertarget>& rt, precalc_data const& precalc, uint32_t width, uint32_t height, bool srgb)
+{
+	auto effect = _data->channel_mask_fx();
+
+	// Ensure the Render Target matches the expected format.
+	if (!rt || (rt->get_color_format() != _color.format)) {
+		rt = std::make_shared<streamfx::obs::gs::rendertarget>(_color.format, GS_ZS_NONE);
+	}
+
+	bool previous_srgb  = gs_framebuffer_srgb_enabled();
+	auto previous_lsrgb = gs_get_linear_srgb();
+	gs_enable_framebuffer_srgb(srgb);
+	gs_set_linear_srgb(srgb);
+
+	std::shared_ptr<streamfx::obs::gs::texture> result;
+	try {
+		{
+			auto op = rt->render(width, height);
+
+			// Push a new blend state to stack.
+			gs_blend_state_push();
+			gs_reset_blend_state();
+			gs_enable_blending(false);
+			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+			try {
+				// Enable all channels.
+				gs_enable_color(true, true, true, true);
+
+				// Disable culling.
+				gs_set_cull_mode(GS_NEITHER);
+
+				// Disable depth testing.
+				gs_enable_depth_test(false);
+				gs_depth_function(GS_ALWAYS);
+
+				// Disable stencil testing
+				gs_enable_stencil_test(false);
+				gs_enable_stencil_write(false);
+				gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
+				gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+
+				// Set up rendering matrix.
+				gs_ortho(0, 1, 0, 1, -1., 1.);
+
+				{ // Clear to black.
+					vec4 clr = {0., 0., 0., 0.};
+					gs_clear(GS_CLEAR_COLOR, &clr, 0., 0);
+				}
+
+				effect.get_parameter("pMaskInputA").set_texture(_base_tex, _color.srgb);
+				effect.get_parameter("pMaskInputB").set_texture(_input_tex, _input_srgb);
+
+				effect.get_parameter("pMaskBase").set_float4(precalc.base);
+				effect.get_parameter("pMaskMatrix").set_matrix(precalc.matrix);
+				effect.get_parameter("pMaskMultiplier").set_float4(precalc.scale);
+
+				while (gs_effect_loop(effect.get(), "Mask")) {
+					_gfx_util->draw_fullscreen_triangle();
+				}
+
+				// Pop the old blend state.
+				gs_blend_state_pop();
+			} catch (...) {
+				gs_blend_state_pop();
+				throw;
+			}
+		}
+
+		result = rt->get_texture();
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Failed to render mask: %s", ex.what());
+	} catch (...) {
+		DLOG_ERROR("Failed to render mask.", nullptr);
+	}
+
+	gs_set_linear_srgb(previous_lsrgb);
+	gs_enable_framebuffer_srgb(previous_srgb);
+	return result;
+}
+
 void dynamic_mask_instance::enum_active_sources(obs_source_enum_proc_t enum_callback, void* param)
 {
 	if (_input)
@@ -621,6 +740,8 @@ void dynamic_mask_instance::enum_all_sources(obs_source_enum_proc_t enum_callbac
 
 void streamfx::filter::dynamic_mask::dynamic_mask_instance::show()
 {
+	resolve();
+
 	if (!_input || !_self.showing() || !(_self.get_filter_parent().showing()))
 		return;
 
@@ -650,11 +771,14 @@ void streamfx::filter::dynamic_mask::dynamic_mask_instance::deactivate()
 bool dynamic_mask_instance::acquire(std::string_view name)
 {
 	try {
-		// Try and acquire the source.
-		_input = streamfx::obs::weak_source(name);
+		// Try and acquire the source, through the index of the tracker instead of a search by libobs.
+		_input = streamfx::obs::source_tracker::instance()->find(name);
+		if (!_input) {
+			throw std::invalid_argument("Parameter 'name' does not define an valid source.");
+		}
 
 		// Ensure that this wouldn't cause recursion.
-		_input_child = std::make_unique<streamfx::obs::source_active_child>(_self, _input.lock());
+		_input_child = streamfx::obs::source_active_child::add_active_child(_self, _input.lock());
 
 		// Handle the active and showing stuff.
 		activate();
@@ -678,6 +802,24 @@ void dynamic_mask_instance::release()
 	_input.reset();
 }
 
+void dynamic_mask_instance::resolve()
+{
+	if (!_input_pending.exchange(false)) {
+		return;
+	}
+
+	std::string name;
+	{
+		std::lock_guard<std::mutex> lock(_input_lock);
+		name = _input_name;
+	}
+
+	// Try again on the next frame if the input does not exist yet, which is only a lookup in the tracker.
+	if (!acquire(name)) {
+		_input_pending = true;
+	}
+}
+
 dynamic_mask_factory::dynamic_mask_factory()
 {
 	_info.id           = S_PREFIX "filter-dynamic-mask";
@@ -704,11 +846,15 @@ const char* dynamic_mask_factory::get_name()
 void dynamic_mask_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_int(data, ST_KEY_CHANNEL, static_cast<int64_t>(channel::Red));
-	for (auto kv : channel_translations) {
-		obs_data_set_default_double(data, (std::string(ST_KEY_CHANNEL_VALUE) + "." + kv.second).c_str(), 1.0);
-		obs_data_set_default_double(data, (std::string(ST_KEY_CHANNEL_MULTIPLIER) + "." + kv.second).c_str(), 1.0);
-		for (auto kv2 : channel_translations) {
-			obs_data_set_default_double(data, (std::string(ST_KEY_CHANNEL_INPUT) + "." + kv.second + "." + kv2.second).c_str(), 0.0);
+	obs_data_set_default_int(data, ST_KEY_OUTPUTS, 1);
+	for (auto const& output : output_translations) {
+		obs_data_set_default_string(data, output.name, "");
+		for (auto const& kv : output.channels) {
+			obs_data_set_default_double(data, kv.value, 1.0);
+			obs_data_set_default_double(data, kv.multiplier, 1.0);
+			for (auto key : kv.input) {
+				obs_data_set_default_double(data, key, 0.0);
+			}
 		}
 	}
 	obs_data_set_default_int(data, ST_KEY_DEBUG_TEXTURE, -1);
@@ -730,55 +876,53 @@ obs_properties_t* dynamic_mask_factory::get_properties2(dynamic_mask_instance* d
 	{ // Input
 		p = obs_properties_add_list(props, ST_KEY_INPUT, D_TRANSLATE(ST_I18N_INPUT), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::instance()->enumerate(
-			[&p](std::string name, ::streamfx::obs::source) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_video_sources);
-		obs::source_tracker::instance()->enumerate(
-			[&p](std::string name, ::streamfx::obs::source) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
-	}
-
-	const char* pri_chs[] = {S_CHANNEL_RED, S_CHANNEL_GREEN, S_CHANNEL_BLUE, S_CHANNEL_ALPHA};
-	for (auto pri_ch : pri_chs) {
-		auto grp = obs_properties_create();
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_video_sources, D_TRANSLATE(S_SOURCETYPE_SOURCE));
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_scenes, D_TRANSLATE(S_SOURCETYPE_SCENE));
+	}
 
-		{
-			_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL_VALUE), D_TRANSLATE(pri_ch)));
-			std::string buf = std::string(ST_KEY_CHANNEL_VALUE) + "." + pri_ch;
-			p               = obs_properties_add_float_slider(grp, buf.c_str(), _translation_cache.back().c_str(), -100.0, 100.0, 0.01);
-			obs_property_set_long_description(p, _translation_cache.back().c_str());
-		}
+	{ // Outputs
+		p = obs_properties_add_int_slider(props, ST_KEY_OUTPUTS, D_TRANSLATE(ST_I18N_OUTPUTS), 1, static_cast<int>(max_outputs), 1);
+	}
 
-		const char* sec_chs[] = {S_CHANNEL_RED, S_CHANNEL_GREEN, S_CHANNEL_BLUE, S_CHANNEL_ALPHA};
-		for (auto sec_ch : sec_chs) {
-			_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL_INPUT), D_TRANSLATE(sec_ch)));
-			std::string buf = std::string(ST_KEY_CHANNEL_INPUT) + "." + pri_ch + "." + sec_ch;
-			p               = obs_properties_add_float_slider(grp, buf.c_str(), _translation_cache.back().c_str(), -100.0, 100.0, 0.01);
-			obs_property_set_long_description(p, _translation_cache.back().c_str());
-		}
+	auto add_channels = [this, &p](obs_properties_t* parent, output_translation const& output) {
+		for (auto const& pri_ch : output.channels) {
+			auto grp = obs_properties_create();
 
-		{
-			_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL_MULTIPLIER), D_TRANSLATE(pri_ch)));
-			std::string buf = std::string(ST_KEY_CHANNEL_MULTIPLIER) + "." + pri_ch;
-			p               = obs_properties_add_float_slider(grp, buf.c_str(), _translation_cache.back().c_str(), -100.0, 100.0, 0.01);
-			obs_property_set_long_description(p, _translation_cache.back().c_str());
-		}
+			{
+				_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL_VALUE), D_TRANSLATE(pri_ch.name)));
+				p = obs_properties_add_float_slider(grp, pri_ch.value, _translation_cache.back().c_str(), -100.0, 100.0, 0.01);
+				obs_property_set_long_description(p, _translation_cache.back().c_str());
+			}
 
-		{
-			_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL), D_TRANSLATE(pri_ch)));
-			std::string buf = std::string(ST_KEY_CHANNEL) + "." + pri_ch;
-			obs_properties_add_group(props, buf.c_str(), _translation_cache.back().c_str(), obs_group_type::OBS_GROUP_NORMAL, grp);
+			for (size_t idx = 0; idx < 4; idx++) {
+				_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL_INPUT), D_TRANSLATE(output_translations[0].channels[idx].name)));
+				p = obs_properties_add_float_slider(grp, pri_ch.input[idx], _translation_cache.back().c_str(), -100.0, 100.0, 0.01);
+				obs_property_set_long_description(p, _translation_cache.back().c_str());
+			}
+
+			{
+				_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL_MULTIPLIER), D_TRANSLATE(pri_ch.name)));
+				p = obs_properties_add_float_slider(grp, pri_ch.multiplier, _translation_cache.back().c_str(), -100.0, 100.0, 0.01);
+				obs_property_set_long_description(p, _translation_cache.back().c_str());
+			}
+
+			{
+				_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_CHANNEL), D_TRANSLATE(pri_ch.name)));
+				obs_properties_add_group(parent, pri_ch.group, _translation_cache.back().c_str(), obs_group_type::OBS_GROUP_NORMAL, grp);
+			}
 		}
+	};
+
+	add_channels(props, output_translations[0]);
+	for (size_t out = 1; out < max_outputs; out++) {
+		auto const& output = output_translations[out];
+		auto        grp    = obs_properties_create();
+
+		p = obs_properties_add_text(grp, output.name, D_TRANSLATE(ST_I18N_OUTPUT_NAME), OBS_TEXT_DEFAULT);
+		add_channels(grp, output);
+
+		_translation_cache.push_back(translate_string(D_TRANSLATE(ST_I18N_OUTPUT), output.number));
+		obs_properties_add_group(props, output.group, _translation_cache.back().c_str(), obs_group_type::OBS_GROUP_NORMAL, grp);
 	}
 
 	{
@@ -836,13 +980,134 @@ std::shared_ptr<dynamic_mask_factory> dynamic_mask_factory::instance()
 	return instance;
 }
 
-static std::shared_ptr<dynamic_mask_factory> loader_instance;
+dynamic_mask_output_instance::dynamic_mask_output_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _data(streamfx::filter::dynamic_mask::data::get()), _lock(), _name(), _output()
+{
+	update(settings);
+}
+
+dynamic_mask_output_instance::~dynamic_mask_output_instance() {}
+
+uint32_t dynamic_mask_output_instance::get_width()
+{
+	auto output = _output.lock();
+	return output ? output->width : 0;
+}
+
+uint32_t dynamic_mask_output_instance::get_height()
+{
+	auto output = _output.lock();
+	return output ? output->height : 0;
+}
+
+void dynamic_mask_output_instance::load(obs_data_t* settings)
+{
+	update(settings);
+}
+
+void dynamic_mask_output_instance::update(obs_data_t* settings)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_name = obs_data_get_string(settings, ST_KEY_OUTPUTSOURCE_NAME);
+	_output.reset();
+}
+
+void dynamic_mask_output_instance::video_tick(float_t time)
+{
+	// Masks may be created after this source, or give up their output again, so keep looking while there is none.
+	std::lock_guard<std::mutex> lock(_lock);
+	if (_output.expired() && !_name.empty()) {
+		_output = _data->find(_name);
+	}
+}
+
+void dynamic_mask_output_instance::video_render(gs_effect_t* effect)
+{
+	// Shows whatever the mask rendered last, the mask itself is only computed while its source is being rendered.
+	auto output = _output.lock();
+	if (!output || !output->texture || !output->texture->get_object()) {
+		return;
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Dynamic Mask Output '%s'", obs_source_get_name(_self)};
+#endif
+
+	const bool previous_srgb = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(gs_get_linear_srgb());
+
+	gs_effect_t* final_effect = effect ? effect : obs_get_base_effect(obs_base_effect::OBS_EFFECT_DEFAULT);
+	if (gs_eparam_t* param = gs_effect_get_param_by_name(final_effect, "image"); param) {
+		if (gs_get_linear_srgb()) {
+			gs_effect_set_texture_srgb(param, output->texture->get_object());
+		} else {
+			gs_effect_set_texture(param, output->texture->get_object());
+		}
+		while (gs_effect_loop(final_effect, "Draw")) {
+			gs_draw_sprite(0, 0, output->width, output->height);
+		}
+	}
+
+	gs_enable_framebuffer_srgb(previous_srgb);
+}
+
+dynamic_mask_output_factory::dynamic_mask_output_factory()
+{
+	_info.id           = S_PREFIX "source-dynamic-mask-output";
+	_info.type         = OBS_SOURCE_TYPE_INPUT;
+	_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB;
+
+	finish_setup();
+}
+
+dynamic_mask_output_factory::~dynamic_mask_output_factory() {}
+
+const char* dynamic_mask_output_factory::get_name()
+{
+	return D_TRANSLATE(ST_I18N_OUTPUTSOURCE);
+}
+
+void dynamic_mask_output_factory::get_defaults2(obs_data_t* data)
+{
+	obs_data_set_default_string(data, ST_KEY_OUTPUTSOURCE_NAME, "");
+}
+
+obs_properties_t* dynamic_mask_output_factory::get_properties2(dynamic_mask_output_instance* data)
+{
+	obs_properties_t* props = obs_properties_create();
+
+	// Editable, so that outputs of masks which don't exist yet can be picked too.
+	auto p = obs_properties_add_list(props, ST_KEY_OUTPUTSOURCE_NAME, D_TRANSLATE(ST_I18N_OUTPUTSOURCE_NAME), OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+	for (auto const& name : streamfx::filter::dynamic_mask::data::get()->outputs()) {
+		obs_property_list_add_string(p, name.c_str(), name.c_str());
+	}
+
+	return props;
+}
+
+std::shared_ptr<dynamic_mask_output_factory> dynamic_mask_output_factory::instance()
+{
+	static std::weak_ptr<dynamic_mask_output_factory> winst;
+	static std::mutex                                 mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<dynamic_mask_output_factory>(new dynamic_mask_output_factory());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<dynamic_mask_factory>        loader_instance;
+static std::shared_ptr<dynamic_mask_output_factory> loader_output_instance;
 
 static auto loader = streamfx::loader(
 	[]() { // Initalizer
-		loader_instance = dynamic_mask_factory::instance();
+		loader_instance        = dynamic_mask_factory::instance();
+		loader_output_instance = dynamic_mask_output_factory::instance();
 	},
 	[]() { // Finalizer
+		loader_output_instance.reset();
 		loader_instance.reset();
 	},
 	streamfx::loader_priority::NORMAL);
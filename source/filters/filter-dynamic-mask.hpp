@@ -16,16 +16,40 @@
 #include "obs/obs-tools.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
 #include <list>
 #include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::filter::dynamic_mask {
 	enum class channel : int8_t { Invalid = -1, Red, Green, Blue, Alpha };
 
+	// The filter itself is the first output, every other output is drawn by output sources.
+	constexpr std::size_t max_outputs = 4;
+
+	/** Result of an additional output of a dynamic mask, as drawn by any number of output sources.
+	 *
+	 * Only touched while in the graphics context.
+	 */
+	struct output {
+		std::shared_ptr<streamfx::obs::gs::rendertarget> rt;
+		std::shared_ptr<streamfx::obs::gs::texture>      texture;
+		bool                                             srgb   = false;
+		uint32_t                                         width  = 0;
+		uint32_t                                         height = 0;
+	};
+
 	class data {
 		streamfx::obs::gs::effect _channel_mask_fx;
 
+		std::mutex                                   _outputs_lock;
+		std::map<std::string, std::weak_ptr<output>> _outputs;
+
 		private:
 		data();
 
@@ -34,6 +58,13 @@ namespace streamfx::filter::dynamic_mask {
 
 		streamfx::obs::gs::effect channel_mask_fx();
 
+		/** Claim an output name, which fails if another mask already uses it. */
+		std::shared_ptr<output> publish(std::string_view name);
+
+		std::shared_ptr<output> find(std::string_view name);
+
+		std::vector<std::string> outputs();
+
 		public:
 		static std::shared_ptr<streamfx::filter::dynamic_mask::data> get();
 	};
@@ -42,26 +73,24 @@ namespace streamfx::filter::dynamic_mask {
 		std::shared_ptr<streamfx::filter::dynamic_mask::data> _data;
 		std::shared_ptr<streamfx::gfx::util>                  _gfx_util;
 
-		std::map<std::tuple<channel, channel, std::string>, std::string> _translation_map;
+		// Resolved on first show, see resolve().
+		std::string                                                 _input_name;
+		std::atomic<bool>                                           _input_pending;
+		std::mutex                                                  _input_lock;
+		std::shared_ptr<streamfx::obs::source_tracker::rename_cb_t> _input_renamed;
 
-		streamfx::obs::weak_source                               _input;
-		std::unique_ptr<streamfx::obs::source_active_child>      _input_child;
-		std::shared_ptr<streamfx::obs::source_showing_reference> _input_vs;
-		std::shared_ptr<streamfx::obs::source_active_reference>  _input_ac;
+		streamfx::obs::weak_source                                  _input;
+		std::shared_ptr<streamfx::obs::source_active_child>         _input_child;
+		std::shared_ptr<streamfx::obs::source_showing_reference>    _input_vs;
+		std::shared_ptr<streamfx::obs::source_active_reference>     _input_ac;
 
 		// Base texture for filtering
 		bool                                             _have_base;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _base_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _base_tex;
-		gs_color_space                                   _base_color_space;
-		gs_color_format                                  _base_color_format;
-		bool                                             _base_srgb;
 
 		bool                                             _have_input;
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _input_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _input_tex;
-		gs_color_space                                   _input_color_space;
-		gs_color_format                                  _input_color_format;
 		bool                                             _input_srgb;
 
 		bool                                             _have_final;
@@ -76,13 +105,19 @@ namespace streamfx::filter::dynamic_mask {
 			float_t scale  = 1.0;
 			vec4    values = {0, 0, 0, 0};
 		};
-		std::map<channel, channel_data> _channels;
-
-		struct _precalc {
+		struct precalc_data {
 			vec4    base;
 			vec4    scale;
 			matrix4 matrix;
-		} _precalc;
+		};
+		struct output_data {
+			std::map<channel, channel_data> channels;
+			precalc_data                    precalc;
+			std::string                     name;
+			std::shared_ptr<output>         published;
+		};
+		std::array<output_data, max_outputs> _outputs;
+		std::size_t                          _output_count;
 
 		public:
 		dynamic_mask_instance(obs_data_t* data, obs_source_t* self);
@@ -93,9 +128,10 @@ namespace streamfx::filter::dynamic_mask {
 		virtual void update(obs_data_t* settings) override;
 		virtual void save(obs_data_t* settings) override;
 
-		virtual gs_color_space video_get_color_space(size_t count, const gs_color_space* preferred_spaces) override;
-		virtual void           video_tick(float_t time) override;
-		virtual void           video_render(gs_effect_t* effect) override;
+		virtual void video_tick(float_t time) override;
+		virtual void video_render(gs_effect_t* effect) override;
+
+		void evict() override;
 
 		void enum_active_sources(obs_source_enum_proc_t enum_callback, void* param) override;
 		void enum_all_sources(obs_source_enum_proc_t enum_callback, void* param) override;
@@ -107,6 +143,11 @@ namespace streamfx::filter::dynamic_mask {
 
 		bool acquire(std::string_view name);
 		void release();
+
+		private:
+		void resolve();
+
+		std::shared_ptr<streamfx::obs::gs::texture> render_mask(std::shared_ptr<streamfx::obs::gs::rendertarget>& rt, precalc_data const& precalc, uint32_t width, uint32_t height, bool srgb);
 	};
 
 	class dynamic_mask_factory : public obs::source_factory<filter::dynamic_mask::dynamic_mask_factory, filter::dynamic_mask::dynamic_mask_instance> {
@@ -135,4 +176,40 @@ namespace streamfx::filter::dynamic_mask {
 
 		static std::shared_ptr<dynamic_mask_factory> instance();
 	};
+
+	/** Draws one of the additional outputs of a dynamic mask, without rendering anything itself. */
+	class dynamic_mask_output_instance : public obs::source_instance {
+		std::shared_ptr<streamfx::filter::dynamic_mask::data> _data;
+		std::mutex                                            _lock;
+		std::string                                           _name;
+		std::weak_ptr<output>                                 _output;
+
+		public:
+		dynamic_mask_output_instance(obs_data_t* data, obs_source_t* self);
+		virtual ~dynamic_mask_output_instance();
+
+		virtual uint32_t get_width() override;
+		virtual uint32_t get_height() override;
+
+		virtual void load(obs_data_t* settings) override;
+		virtual void update(obs_data_t* settings) override;
+
+		virtual void video_tick(float_t time) override;
+		virtual void video_render(gs_effect_t* effect) override;
+	};
+
+	class dynamic_mask_output_factory : public obs::source_factory<filter::dynamic_mask::dynamic_mask_output_factory, filter::dynamic_mask::dynamic_mask_output_instance> {
+		public:
+		dynamic_mask_output_factory();
+		virtual ~dynamic_mask_output_factory() override;
+
+		virtual const char* get_name() override;
+
+		virtual void get_defaults2(obs_data_t* data) override;
+
+		virtual obs_properties_t* get_properties2(filter::dynamic_mask::dynamic_mask_output_instance* data) override;
+
+		public: // Singleton
+		static std::shared_ptr<dynamic_mask_output_factory> instance();
+	};
 } // namespace streamfx::filter::dynamic_mask
@@ -4,10 +4,15 @@
 
 #include "filter-sdf-effects.hpp"
 #include "strings.hpp"
+#include "gfx/gfx-quality.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -97,48 +102,48 @@
 #define ST_KEY_SDF_SCALE "Filter.SDFEffects.SDF.Scale"
 #define ST_I18N_SDF_THRESHOLD "Filter.SDFEffects.SDF.Threshold"
 #define ST_KEY_SDF_THRESHOLD "Filter.SDFEffects.SDF.Threshold"
+#define ST_I18N_SDF_MODE "Filter.SDFEffects.SDF.Mode"
+#define ST_KEY_SDF_MODE "Filter.SDFEffects.SDF.Mode"
+#define ST_I18N_SDF_MODE_ITERATIVE "Filter.SDFEffects.SDF.Mode.Iterative"
+#define ST_I18N_SDF_MODE_JUMPFLOOD "Filter.SDFEffects.SDF.Mode.JumpFlood"
+#define ST_I18N_SDF_PRECISION "Filter.SDFEffects.SDF.Precision"
+#define ST_KEY_SDF_PRECISION "Filter.SDFEffects.SDF.Precision"
 
 using namespace streamfx::filter::sdf_effects;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-SDF-Effects";
 
-sdf_effects_instance::sdf_effects_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _source_rendered(false), _sdf_scale(1.0), _sdf_threshold(), _output_rendered(false), _inner_shadow(false), _inner_shadow_color(), _inner_shadow_range_min(), _inner_shadow_range_max(), _inner_shadow_offset_x(), _inner_shadow_offset_y(), _outer_shadow(false), _outer_shadow_color(), _outer_shadow_range_min(), _outer_shadow_range_max(), _outer_shadow_offset_x(), _outer_shadow_offset_y(), _inner_glow(false), _inner_glow_color(), _inner_glow_width(), _inner_glow_sharpness(), _inner_glow_sharpness_inv(), _outer_glow(false), _outer_glow_color(), _outer_glow_width(), _outer_glow_sharpness(), _outer_glow_sharpness_inv(), _outline(false), _outline_color(), _outline_width(), _outline_offset(), _outline_sharpness(), _outline_sharpness_inv()
+sdf_effects_instance::sdf_effects_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _governor(::streamfx::gfx::governor::instance()), _source_rendered(false), _sdf_scale(1.0), _sdf_threshold(), _sdf_mode(sdf_mode::Iterative), _sdf_precision(streamfx::gfx::precision::Default), _sdf_dirty(true), _source_checksum(), _source_checksum_value(0), _output_rendered(false), _inner_shadow(false), _inner_shadow_color(), _inner_shadow_range_min(), _inner_shadow_range_max(), _inner_shadow_offset_x(), _inner_shadow_offset_y(), _outer_shadow(false), _outer_shadow_color(), _outer_shadow_range_min(), _outer_shadow_range_max(), _outer_shadow_offset_x(), _outer_shadow_offset_y(), _inner_glow(false), _inner_glow_color(), _inner_glow_width(), _inner_glow_sharpness(), _inner_glow_sharpness_inv(), _outer_glow(false), _outer_glow_color(), _outer_glow_width(), _outer_glow_sharpness(), _outer_glow_sharpness_inv(), _outline(false), _outline_color(), _outline_width(), _outline_offset(), _outline_sharpness(), _outline_sharpness_inv()
 {
-	{
-		auto gctx        = streamfx::obs::gs::context();
-		vec4 transparent = {0, 0, 0, 0};
-
-		_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		_sdf_write = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA32F, GS_ZS_NONE);
-		_sdf_read  = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA32F, GS_ZS_NONE);
-		_output_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-
-		std::shared_ptr<streamfx::obs::gs::rendertarget> initialize_rts[] = {_source_rt, _sdf_write, _sdf_read, _output_rt};
-		for (auto rt : initialize_rts) {
-			auto op = rt->render(1, 1);
-			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &transparent, 0, 0);
-		}
+	update(settings);
+}
 
-		std::pair<const char*, streamfx::obs::gs::effect&> load_arr[] = {
-			{"effects/sdf/sdf-producer.effect", _sdf_producer_effect},
-			{"effects/sdf/sdf-consumer.effect", _sdf_consumer_effect},
-		};
-		for (auto& kv : load_arr) {
-			auto file = streamfx::data_file_path(kv.first);
-			try {
-				kv.second = streamfx::obs::gs::effect::create(file);
-			} catch (std::exception& ex) {
-				D_LOG_ERROR("Error loading '%s': %s", file.u8string().c_str(), ex.what());
-				throw;
-			}
+sdf_effects_instance::~sdf_effects_instance() {}
+
+void sdf_effects_instance::create_resources()
+{
+	// The render targets are created by video_render(), which already has to do so after evict().
+	std::pair<const char*, streamfx::obs::gs::effect&> load_arr[] = {
+		{"effects/sdf/sdf-producer.effect", _sdf_producer_effect},
+		{"effects/sdf/sdf-consumer.effect", _sdf_consumer_effect},
+	};
+	for (auto& kv : load_arr) {
+		auto file = streamfx::data_file_path(kv.first);
+		try {
+			kv.second = streamfx::obs::gs::effect_registry::instance()->get(file);
+		} catch (std::exception& ex) {
+			D_LOG_ERROR("Error loading '%s': %s", file.u8string().c_str(), ex.what());
+			throw;
 		}
 	}
 
-	update(settings);
+	try {
+		_source_checksum = std::make_shared<streamfx::gfx::checksum>();
+	} catch (std::exception const& ex) {
+		D_LOG_WARNING("Distance field will be rebuilt every frame: %s", ex.what());
+	}
 }
 
-sdf_effects_instance::~sdf_effects_instance() {}
-
 void sdf_effects_instance::load(obs_data_t* settings)
 {
 	update(settings);
@@ -272,6 +277,56 @@ void sdf_effects_instance::update(obs_data_t* data)
 
 	_sdf_scale     = double_t(obs_data_get_double(data, ST_KEY_SDF_SCALE) / 100.0);
 	_sdf_threshold = float_t(obs_data_get_double(data, ST_KEY_SDF_THRESHOLD) / 100.0);
+	_sdf_mode      = static_cast<sdf_mode>(obs_data_get_int(data, ST_KEY_SDF_MODE));
+	_sdf_precision = static_cast<streamfx::gfx::precision>(obs_data_get_int(data, ST_KEY_SDF_PRECISION));
+	_sdf_dirty     = true;
+}
+
+void sdf_effects_instance::update_sdf(const char* technique, uint32_t width, uint32_t height, uint32_t step)
+{
+	vec4 color_transparent = {0, 0, 0, 0};
+
+	{
+		auto op = _sdf_write->render(width, height);
+		gs_ortho(0, 1, 0, 1, -1, 1);
+		gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &color_transparent, 0, 0);
+
+		_sdf_producer_effect.get_parameter("_image").set_texture(_source_texture);
+		_sdf_producer_effect.get_parameter("_size").set_float2(float_t(width), float_t(height));
+		_sdf_producer_effect.get_parameter("_sdf").set_texture(_sdf_texture);
+		_sdf_producer_effect.get_parameter("_threshold").set_float(_sdf_threshold);
+		if (auto p = _sdf_producer_effect.get_parameter("_step"); p) {
+			p.set_float(float_t(step));
+		}
+
+		while (gs_effect_loop(_sdf_producer_effect.get_object(), technique)) {
+			_gfx_util->draw_fullscreen_triangle();
+		}
+	}
+
+	std::swap(_sdf_read, _sdf_write);
+	_sdf_read->get_texture(_sdf_texture);
+	if (!_sdf_texture) {
+		throw std::runtime_error("SDF Backbuffer empty");
+	}
+}
+
+bool sdf_effects_instance::source_changed()
+{
+	if (!_source_checksum) {
+		return true;
+	}
+
+	// The checksum arrives one frame late, so a change leaves the distance field one frame behind at worst.
+	uint64_t value = 0;
+	if (!_source_checksum->update(_source_texture, value)) {
+		return true;
+	}
+	if (value == _source_checksum_value) {
+		return false;
+	}
+	_source_checksum_value = value;
+	return true;
 }
 
 void sdf_effects_instance::video_tick(float_t)
@@ -282,17 +337,31 @@ void sdf_effects_instance::video_tick(float_t)
 	}
 }
 
+void sdf_effects_instance::evict()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	// video_render() recreates these, and the distance field has to be rebuilt from scratch afterwards.
+	_source_rt.reset();
+	_source_texture.reset();
+	_sdf_write.reset();
+	_sdf_read.reset();
+	_sdf_texture.reset();
+	_output_rt.reset();
+	_output_texture.reset();
+	_sdf_dirty = true;
+}
+
 void sdf_effects_instance::video_render(gs_effect_t* effect)
 {
-	obs_source_t* parent         = obs_filter_get_parent(_self);
-	obs_source_t* target         = obs_filter_get_target(_self);
-	uint32_t      baseW          = obs_source_get_base_width(target);
-	uint32_t      baseH          = obs_source_get_base_height(target);
-	gs_effect_t*  final_effect   = effect ? effect : obs_get_base_effect(obs_base_effect::OBS_EFFECT_DEFAULT);
-	gs_effect_t*  default_effect = obs_get_base_effect(obs_base_effect::OBS_EFFECT_DEFAULT);
+	obs_source_t* parent       = obs_filter_get_parent(_self);
+	obs_source_t* target       = obs_filter_get_target(_self);
+	uint32_t      baseW        = obs_source_get_base_width(target);
+	uint32_t      baseH        = obs_source_get_base_height(target);
+	gs_effect_t*  final_effect = effect ? effect : obs_get_base_effect(obs_base_effect::OBS_EFFECT_DEFAULT);
 
 	if (!_self || !parent || !target || !baseW || !baseH || !final_effect) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -325,6 +394,10 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 				streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Cache"};
 #endif
 
+				if (!_source_rt) {
+					_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+				}
+
 				auto op = _source_rt->render(baseW, baseH);
 				gs_ortho(0, static_cast<float>(baseW), 0, static_cast<float>(baseH), -1, 1);
 				gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &color_transparent, 0, 0);
@@ -342,6 +415,29 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 
 			// Generate SDF Buffers
 			{
+				// Scale SDF Size, and shrink it further under heavy load.
+				double_t sdfW, sdfH;
+				double_t scale = _sdf_scale * std::pow(0.75, double_t(_governor->level()));
+				sdfW           = baseW * scale;
+				sdfH           = baseH * scale;
+				if (sdfW <= 1) {
+					sdfW = 1.0;
+				}
+				if (sdfH <= 1) {
+					sdfH = 1.0;
+				}
+
+				// Half precision still places the nearest edge coordinates within a texel up to 2048 texels.
+				if (auto format = streamfx::gfx::precision_format(_sdf_precision, 4, std::max(sdfW, sdfH) <= 2048.); !_sdf_read || (_sdf_read->get_color_format() != format)) {
+					_sdf_write = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+					_sdf_read  = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+					for (auto rt : {_sdf_write, _sdf_read}) {
+						auto op = rt->render(1, 1);
+						gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &color_transparent, 0, 0);
+					}
+					_sdf_dirty = true;
+				}
+
 				_sdf_read->get_texture(_sdf_texture);
 				if (!_sdf_texture) {
 					throw std::runtime_error("SDF Backbuffer empty");
@@ -351,39 +447,34 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 					throw std::runtime_error("SDF Effect no loaded");
 				}
 
-				// Scale SDF Size
-				double_t sdfW, sdfH;
-				sdfW = baseW * _sdf_scale;
-				sdfH = baseH * _sdf_scale;
-				if (sdfW <= 1) {
-					sdfW = 1.0;
-				}
-				if (sdfH <= 1) {
-					sdfH = 1.0;
-				}
-
-				{
+				// The iterative generator has to keep refining the field every frame, while the jump flood generator
+				// completes it in one update and can keep it for as long as the source does not change.
+				if (_sdf_mode != sdf_mode::JumpFlood) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 					streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Update Distance Field"};
 #endif
 
-					auto op = _sdf_write->render(uint32_t(sdfW), uint32_t(sdfH));
-					gs_ortho(0, 1, 0, 1, -1, 1);
-					gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &color_transparent, 0, 0);
+					update_sdf("Draw", uint32_t(sdfW), uint32_t(sdfH), 0);
+				} else if (source_changed() || _sdf_dirty || (_sdf_texture->get_width() != uint32_t(sdfW)) || (_sdf_texture->get_height() != uint32_t(sdfH))) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+					streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Jump Flood Distance Field"};
+#endif
 
-					_sdf_producer_effect.get_parameter("_image").set_texture(_source_texture);
-					_sdf_producer_effect.get_parameter("_size").set_float2(float_t(sdfW), float_t(sdfH));
-					_sdf_producer_effect.get_parameter("_sdf").set_texture(_sdf_texture);
-					_sdf_producer_effect.get_parameter("_threshold").set_float(_sdf_threshold);
+					// Start at half of the next power of two and halve the step every pass. One more single texel
+					// step at the end fixes most of the errors the large jumps leave behind.
+					uint32_t largest = std::max(uint32_t(sdfW), uint32_t(sdfH));
+					uint32_t step    = 1;
+					while ((step * 2) < largest) {
+						step *= 2;
+					}
 
-					while (gs_effect_loop(_sdf_producer_effect.get_object(), "Draw")) {
-						_gfx_util->draw_fullscreen_triangle();
+					update_sdf("JumpFloodSeed", uint32_t(sdfW), uint32_t(sdfH), 0);
+					for (; step > 0; step /= 2) {
+						update_sdf("JumpFlood", uint32_t(sdfW), uint32_t(sdfH), step);
 					}
-				}
-				std::swap(_sdf_read, _sdf_write);
-				_sdf_read->get_texture(_sdf_texture);
-				if (!_sdf_texture) {
-					throw std::runtime_error("SDF Backbuffer empty");
+					update_sdf("JumpFlood", uint32_t(sdfW), uint32_t(sdfH), 1);
+					update_sdf("JumpFloodResolve", uint32_t(sdfW), uint32_t(sdfH), 0);
+					_sdf_dirty = false;
 				}
 			}
 
@@ -393,7 +484,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		gs_blend_state_pop();
 	} catch (...) {
 		gs_blend_state_pop();
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -401,7 +492,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		_output_texture = _source_texture;
 
 		if (!_sdf_consumer_effect) {
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 
@@ -419,6 +510,10 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		//   Inner Glow
 		//   Outline
 
+		if (!_output_rt) {
+			_output_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		}
+
 		// Optimized Render path.
 		try {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -428,78 +523,59 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 			auto op = _output_rt->render(baseW, baseH);
 			gs_ortho(0, 1, 0, 1, 0, 1);
 
+			// Distances are stored in texels of the distance field, while all effects are given in source pixels.
+			vec2 sdf_size;
+			vec2_set(&sdf_size, float_t(_sdf_texture->get_width()), float_t(_sdf_texture->get_height()));
+			float_t sdf_scale = float_t(baseW) / sdf_size.x;
+
+			// The source and every enabled effect end up in the target in a single pass, which does its own blending.
 			gs_enable_blending(false);
 			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-			auto param = gs_effect_get_param_by_name(default_effect, "image");
-			if (param) {
-				gs_effect_set_texture(param, _output_texture->get_object());
-			}
-			while (gs_effect_loop(default_effect, "Draw")) {
-				_gfx_util->draw_fullscreen_triangle();
-			}
 
-			gs_enable_blending(true);
-			gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_ONE);
+			_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+			_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+			_sdf_consumer_effect.get_parameter("pSDFSize").set_float2(sdf_size);
+			_sdf_consumer_effect.get_parameter("pSDFScale").set_float(sdf_scale);
+			_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+
 			if (_outer_shadow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_outer_shadow_color);
-				_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_outer_shadow_range_min);
-				_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_outer_shadow_range_max);
-				_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowOuter")) {
-					_gfx_util->draw_fullscreen_triangle();
-				}
+				_sdf_consumer_effect.get_parameter("pShadowOuterColor").set_float4(_outer_shadow_color);
+				_sdf_consumer_effect.get_parameter("pShadowOuterMin").set_float(_outer_shadow_range_min);
+				_sdf_consumer_effect.get_parameter("pShadowOuterMax").set_float(_outer_shadow_range_max);
+				_sdf_consumer_effect.get_parameter("pShadowOuterOffset").set_float2(_outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
 			}
 			if (_inner_shadow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_inner_shadow_color);
-				_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_inner_shadow_range_min);
-				_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_inner_shadow_range_max);
-				_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowInner")) {
-					_gfx_util->draw_fullscreen_triangle();
-				}
+				_sdf_consumer_effect.get_parameter("pShadowInnerColor").set_float4(_inner_shadow_color);
+				_sdf_consumer_effect.get_parameter("pShadowInnerMin").set_float(_inner_shadow_range_min);
+				_sdf_consumer_effect.get_parameter("pShadowInnerMax").set_float(_inner_shadow_range_max);
+				_sdf_consumer_effect.get_parameter("pShadowInnerOffset").set_float2(_inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
 			}
 			if (_outer_glow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_outer_glow_color);
-				_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_outer_glow_width);
-				_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_outer_glow_sharpness);
-				_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_outer_glow_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowOuter")) {
-					_gfx_util->draw_fullscreen_triangle();
-				}
+				_sdf_consumer_effect.get_parameter("pGlowOuterColor").set_float4(_outer_glow_color);
+				_sdf_consumer_effect.get_parameter("pGlowOuterWidth").set_float(_outer_glow_width);
+				_sdf_consumer_effect.get_parameter("pGlowOuterSharpness").set_float(_outer_glow_sharpness);
+				_sdf_consumer_effect.get_parameter("pGlowOuterSharpnessInverse").set_float(_outer_glow_sharpness_inv);
 			}
 			if (_inner_glow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_inner_glow_color);
-				_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_inner_glow_width);
-				_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_inner_glow_sharpness);
-				_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_inner_glow_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowInner")) {
-					_gfx_util->draw_fullscreen_triangle();
-				}
+				_sdf_consumer_effect.get_parameter("pGlowInnerColor").set_float4(_inner_glow_color);
+				_sdf_consumer_effect.get_parameter("pGlowInnerWidth").set_float(_inner_glow_width);
+				_sdf_consumer_effect.get_parameter("pGlowInnerSharpness").set_float(_inner_glow_sharpness);
+				_sdf_consumer_effect.get_parameter("pGlowInnerSharpnessInverse").set_float(_inner_glow_sharpness_inv);
 			}
 			if (_outline) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
 				_sdf_consumer_effect.get_parameter("pOutlineColor").set_float4(_outline_color);
 				_sdf_consumer_effect.get_parameter("pOutlineWidth").set_float(_outline_width);
 				_sdf_consumer_effect.get_parameter("pOutlineOffset").set_float(_outline_offset);
 				_sdf_consumer_effect.get_parameter("pOutlineSharpness").set_float(_outline_sharpness);
 				_sdf_consumer_effect.get_parameter("pOutlineSharpnessInverse").set_float(_outline_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "Outline")) {
-					_gfx_util->draw_fullscreen_triangle();
-				}
+			}
+
+			// Only the enabled effects are compiled in, see sdf-consumer.permutations.effect.
+			uint32_t mask = (_outer_shadow ? 1u : 0u) | (_inner_shadow ? 2u : 0u) | (_outer_glow ? 4u : 0u) | (_inner_glow ? 8u : 0u) | (_outline ? 16u : 0u);
+			char     technique[16];
+			snprintf(technique, sizeof(technique), "Combined_%" PRIu32, mask);
+			while (gs_effect_loop(_sdf_consumer_effect.get_object(), technique)) {
+				_gfx_util->draw_fullscreen_triangle();
 			}
 		} catch (...) {
 		}
@@ -511,7 +587,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 	}
 
 	if (!_output_texture) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -587,6 +663,18 @@ void sdf_effects_factory::get_defaults2(obs_data_t* data)
 
 	obs_data_set_default_double(data, ST_KEY_SDF_SCALE, 100.0);
 	obs_data_set_default_double(data, ST_KEY_SDF_THRESHOLD, 50.0);
+	obs_data_set_default_int(data, ST_KEY_SDF_MODE, static_cast<int64_t>(sdf_mode::Iterative));
+	switch (streamfx::gfx::resolve_quality_tier()) {
+	case streamfx::gfx::quality_tier::Low:
+		obs_data_set_default_int(data, ST_KEY_SDF_PRECISION, static_cast<int64_t>(streamfx::gfx::precision::Half));
+		break;
+	case streamfx::gfx::quality_tier::High:
+		obs_data_set_default_int(data, ST_KEY_SDF_PRECISION, static_cast<int64_t>(streamfx::gfx::precision::Full));
+		break;
+	default:
+		obs_data_set_default_int(data, ST_KEY_SDF_PRECISION, static_cast<int64_t>(streamfx::gfx::precision::Default));
+		break;
+	}
 }
 
 obs_properties_t* sdf_effects_factory::get_properties2(sdf_effects_instance* data)
@@ -664,6 +752,13 @@ obs_properties_t* sdf_effects_factory::get_properties2(sdf_effects_instance* dat
 
 		obs_properties_add_float_slider(pr, ST_KEY_SDF_SCALE, D_TRANSLATE(ST_I18N_SDF_SCALE), 0.1, 500.0, 0.1);
 		obs_properties_add_float_slider(pr, ST_KEY_SDF_THRESHOLD, D_TRANSLATE(ST_I18N_SDF_THRESHOLD), 0.0, 100.0, 0.01);
+
+		p = obs_properties_add_list(pr, ST_KEY_SDF_MODE, D_TRANSLATE(ST_I18N_SDF_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SDF_MODE_ITERATIVE), static_cast<int64_t>(sdf_mode::Iterative));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SDF_MODE_JUMPFLOOD), static_cast<int64_t>(sdf_mode::JumpFlood));
+
+		p = obs_properties_add_list(pr, ST_KEY_SDF_PRECISION, D_TRANSLATE(ST_I18N_SDF_PRECISION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		streamfx::gfx::precision_properties(p);
 	}
 
 	return prs;
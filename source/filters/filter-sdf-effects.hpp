@@ -4,6 +4,9 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-checksum.hpp"
+#include "gfx/gfx-governor.hpp"
+#include "gfx/gfx-precision.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -13,10 +16,16 @@
 #include "obs/obs-source-factory.hpp"
 
 namespace streamfx::filter::sdf_effects {
+	enum class sdf_mode : int64_t {
+		Iterative = 0, // Refine the distance field a few texels further every frame.
+		JumpFlood = 1, // Rebuild the distance field every frame in log2 of its size passes.
+	};
+
 	class sdf_effects_instance : public obs::source_instance {
-		streamfx::obs::gs::effect            _sdf_producer_effect;
-		streamfx::obs::gs::effect            _sdf_consumer_effect;
-		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+		streamfx::obs::gs::effect                _sdf_producer_effect;
+		streamfx::obs::gs::effect                _sdf_consumer_effect;
+		std::shared_ptr<streamfx::gfx::util>     _gfx_util;
+		std::shared_ptr<streamfx::gfx::governor> _governor;
 
 		// Input
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _source_rt;
@@ -29,6 +38,11 @@ namespace streamfx::filter::sdf_effects {
 		std::shared_ptr<streamfx::obs::gs::texture>      _sdf_texture;
 		double_t                                         _sdf_scale;
 		float_t                                          _sdf_threshold;
+		sdf_mode                                         _sdf_mode;
+		streamfx::gfx::precision                         _sdf_precision;
+		bool                                             _sdf_dirty;
+		std::shared_ptr<streamfx::gfx::checksum>         _source_checksum;
+		uint64_t                                         _source_checksum_value;
 
 		// Effects
 		bool                                             _output_rendered;
@@ -78,6 +92,16 @@ namespace streamfx::filter::sdf_effects {
 
 		virtual void video_tick(float_t) override;
 		virtual void video_render(gs_effect_t*) override;
+
+		virtual void create_resources() override;
+		virtual void evict() override;
+
+		private:
+		/** Render one pass of the SDF producer from '_sdf_read' into '_sdf_write', then swap the two. */
+		void update_sdf(const char* technique, uint32_t width, uint32_t height, uint32_t step);
+
+		/** Whether the captured source changed since the distance field was last built, as far as is known yet. */
+		bool source_changed();
 	};
 
 	class sdf_effects_factory : public obs::source_factory<filter::sdf_effects::sdf_effects_factory, filter::sdf_effects::sdf_effects_instance> {
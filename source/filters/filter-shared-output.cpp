@@ -0,0 +1,212 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "filter-shared-output.hpp"
+#include "strings.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<filter::shared_output> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_I18N "Filter.SharedOutput"
+#define ST_KEY_NAME "Name"
+#define ST_I18N_NAME ST_I18N "." ST_KEY_NAME
+#define ST_KEY_COUNT "Count"
+#define ST_I18N_COUNT ST_I18N "." ST_KEY_COUNT
+#define ST_I18N_UNSUPPORTED ST_I18N ".Unsupported"
+
+using namespace streamfx::filter::shared_output;
+
+shared_output_instance::shared_output_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _name(), _count(3), _dirty(true), _failed(false)
+{
+	_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+
+	update(data);
+}
+
+shared_output_instance::~shared_output_instance()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_output.reset();
+	_rt.reset();
+}
+
+void shared_output_instance::load(obs_data_t* data)
+{
+	update(data);
+}
+
+void shared_output_instance::migrate(obs_data_t* data, uint64_t version) {}
+
+void shared_output_instance::update(obs_data_t* data)
+{
+	std::string name  = obs_data_get_string(data, ST_KEY_NAME);
+	size_t      count = static_cast<size_t>(obs_data_get_int(data, ST_KEY_COUNT));
+	if ((name != _name) || (count != _count)) {
+		_name  = name;
+		_count = count;
+		_dirty = true;
+	}
+}
+
+void shared_output_instance::video_render(gs_effect_t* effect)
+{
+	obs_source_t* target = obs_filter_get_target(_self);
+	uint32_t      width  = target ? obs_source_get_base_width(target) : 0;
+	uint32_t      height = target ? obs_source_get_base_height(target) : 0;
+	if ((width == 0) || (height == 0)) {
+		skip_video_filter();
+		return;
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Shared Output '%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(obs_filter_get_parent(_self))};
+#endif
+
+	if (_dirty) {
+		_dirty  = false;
+		_failed = false;
+		_output.reset();
+
+		// Unnamed outputs go by the name of the source they are on.
+		std::string name = _name.empty() ? std::string(obs_source_get_name(obs_filter_get_parent(_self))) : _name;
+		try {
+			_output = std::make_shared<streamfx::gfx::shared_output>(name, _count);
+		} catch (const std::exception& ex) {
+			D_LOG_ERROR("Failed to publish '%s': %s", name.c_str(), ex.what());
+			_failed = true;
+		}
+	}
+	if (_failed) {
+		skip_video_filter();
+		return;
+	}
+
+	{ // Capture the incoming frame.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_capture, "Capture"};
+#endif
+		if (!obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+			skip_video_filter();
+			return;
+		}
+
+		auto op = _rt->render(width, height);
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1, 1);
+
+		vec4 blank = {0, 0, 0, 0};
+		gs_clear(GS_CLEAR_COLOR, &blank, 0, 0);
+
+		gs_blend_state_push();
+		gs_reset_blend_state();
+		gs_enable_blending(false);
+		gs_enable_depth_test(false);
+		gs_enable_stencil_test(false);
+		gs_enable_stencil_write(false);
+		gs_enable_color(true, true, true, true);
+		gs_set_cull_mode(GS_NEITHER);
+
+		obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), width, height);
+
+		gs_blend_state_pop();
+	}
+
+	auto tex = _rt->get_texture();
+	{ // Hand the frame to other processes.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_copy, "Publish"};
+#endif
+		if (!_output->publish(tex->get_object(), obs_get_video_frame_time())) {
+			D_LOG_DEBUG("Dropped a frame for '%s', every texture is held by a consumer.", _output->name().data());
+		}
+	}
+
+	{ // Pass the frame on unchanged.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Render"};
+#endif
+		effect = effect ? effect : obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex->get_object());
+		while (gs_effect_loop(effect, "Draw")) {
+			gs_draw_sprite(tex->get_object(), 0, width, height);
+		}
+	}
+}
+
+shared_output_factory::shared_output_factory()
+{
+	_info.id           = S_PREFIX "filter-shared-output";
+	_info.type         = OBS_SOURCE_TYPE_FILTER;
+	_info.output_flags = OBS_SOURCE_VIDEO;
+
+	finish_setup();
+}
+
+shared_output_factory::~shared_output_factory() {}
+
+const char* shared_output_factory::get_name()
+{
+	return D_TRANSLATE(ST_I18N);
+}
+
+void shared_output_factory::get_defaults2(obs_data_t* data)
+{
+	obs_data_set_default_string(data, ST_KEY_NAME, "");
+	obs_data_set_default_int(data, ST_KEY_COUNT, 3);
+}
+
+obs_properties_t* shared_output_factory::get_properties2(shared_output_instance* data)
+{
+	auto pr = obs_properties_create();
+
+	if (!streamfx::gfx::shared_output::is_supported()) {
+		obs_properties_add_text(pr, ST_I18N_UNSUPPORTED, D_TRANSLATE(ST_I18N_UNSUPPORTED), OBS_TEXT_INFO);
+	}
+
+	obs_properties_add_text(pr, ST_KEY_NAME, D_TRANSLATE(ST_I18N_NAME), OBS_TEXT_DEFAULT);
+	obs_properties_add_int_slider(pr, ST_KEY_COUNT, D_TRANSLATE(ST_I18N_COUNT), 1, static_cast<int>(streamfx::gfx::shared_output::max_ring), 1);
+
+	return pr;
+}
+
+std::shared_ptr<shared_output_factory> shared_output_factory::instance()
+{
+	static std::weak_ptr<shared_output_factory> winst;
+	static std::mutex                           mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<shared_output_factory>(new shared_output_factory());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<shared_output_factory> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance = shared_output_factory::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::NORMAL);
@@ -0,0 +1,51 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx/gfx-shared-output.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/obs-source-factory.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include <string>
+#include "warning-enable.hpp"
+
+namespace streamfx::filter::shared_output {
+	class shared_output_instance : public obs::source_instance {
+		std::string _name;
+		size_t      _count;
+		bool        _dirty;
+		bool        _failed;
+
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
+		std::shared_ptr<streamfx::gfx::shared_output>    _output;
+
+		public:
+		shared_output_instance(obs_data_t* data, obs_source_t* self);
+		virtual ~shared_output_instance();
+
+		virtual void load(obs_data_t* data) override;
+		virtual void migrate(obs_data_t* data, uint64_t version) override;
+		virtual void update(obs_data_t* data) override;
+
+		virtual void video_render(gs_effect_t* effect) override;
+	};
+
+	class shared_output_factory : public obs::source_factory<filter::shared_output::shared_output_factory, filter::shared_output::shared_output_instance> {
+		public:
+		shared_output_factory();
+		virtual ~shared_output_factory();
+
+		virtual const char* get_name() override;
+
+		virtual void get_defaults2(obs_data_t* data) override;
+
+		virtual obs_properties_t* get_properties2(filter::shared_output::shared_output_instance* data) override;
+
+		public: // Singleton
+		static std::shared_ptr<shared_output_factory> instance();
+	};
+} // namespace streamfx::filter::shared_output
@@ -5,11 +5,16 @@
 
 #include "filter-transform.hpp"
 #include "strings.hpp"
+#include "gfx/gfx-quality.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -84,6 +89,55 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
 static const float farZ  = 2097152.0f; // 2 pow 21
 static const float nearZ = 1.0f / farZ;
 
+// Finest grid used for Corner Pin, as a power of two. 2^6 is a 64x64 grid.
+#define ST_GRID_LEVEL_MAX 6
+
+namespace {
+	std::shared_ptr<grid_mesh> get_grid(uint32_t level)
+	{
+		static std::mutex                                                  lock;
+		static std::array<std::weak_ptr<grid_mesh>, ST_GRID_LEVEL_MAX + 1> grids;
+
+		level = std::min<uint32_t>(level, ST_GRID_LEVEL_MAX);
+		std::lock_guard<std::mutex> lg(lock);
+		if (auto grid = grids[level].lock(); grid) {
+			return grid;
+		}
+
+		uint32_t cells = 1u << level;
+		uint32_t row   = cells + 1;
+		auto     grid  = std::make_shared<grid_mesh>();
+		auto     gctx  = streamfx::obs::gs::context();
+
+		// Corners are applied in the vertex shader, so the grid itself only ever holds the unit square.
+		grid->vertices = std::make_shared<streamfx::obs::gs::vertex_buffer>(row * row, uint8_t(1u));
+		for (uint32_t y = 0; y < row; y++) {
+			for (uint32_t x = 0; x < row; x++) {
+				float u    = static_cast<float>(x) / static_cast<float>(cells);
+				float v    = static_cast<float>(y) / static_cast<float>(cells);
+				auto  vtx  = grid->vertices->at(y * row + x);
+				*vtx.color = 0xFFFFFFFF;
+				vec3_set(vtx.position, u, v, 0);
+				vec4_set(vtx.uv[0], u, v, 0, 0);
+			}
+		}
+		grid->vertices->update(true);
+
+		grid->indices = std::make_shared<streamfx::obs::gs::index_buffer>(cells * cells * 6);
+		for (uint32_t y = 0; y < cells; y++) {
+			for (uint32_t x = 0; x < cells; x++) {
+				uint32_t tl = y * row + x;
+				uint32_t bl = tl + row;
+				grid->indices->insert(grid->indices->end(), {tl, tl + 1, bl, tl + 1, bl + 1, bl});
+			}
+		}
+		grid->indices->get(true);
+
+		grids[level] = grid;
+		return grid;
+	}
+} // namespace
+
 enum RotationOrder : int64_t {
 	XYZ = 0,
 	XZY = 1,
@@ -93,7 +147,7 @@ enum RotationOrder : int64_t {
 	ZYX = 5,
 };
 
-transform_instance::transform_instance(obs_data_t* data, obs_source_t* context) : obs::source_instance(data, context), _gfx_util(::streamfx::gfx::util::get()), _camera_mode(), _camera_fov(), _params(), _corners(), _standard_effect(), _transform_effect(), _sampler(), _cache_rendered(), _mipmap_enabled(), _source_rendered(), _source_size(), _update_mesh(true)
+transform_instance::transform_instance(obs_data_t* data, obs_source_t* context) : obs::source_instance(data, context), _gfx_util(::streamfx::gfx::util::get()), _governor(::streamfx::gfx::governor::instance()), _mip_chain(::streamfx::gfx::mip_chain::instance()), _camera_mode(), _camera_fov(), _params(), _corners(), _transform_effect(), _sampler(), _cache_rendered(), _cache_checksum(), _cache_checksum_value(0), _mipmap_enabled(), _mipmap_rendered(), _source_rendered(), _source_size(), _update_matrix(true), _matrix()
 {
 	{
 		auto gctx = obs::gs::context();
@@ -101,14 +155,16 @@ transform_instance::transform_instance(obs_data_t* data, obs_source_t* context)
 		_cache_rt      = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 		_source_rt     = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 		_vertex_buffer = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(4u), uint8_t(1u));
-		{
-			auto file = streamfx::data_file_path("effects/standard.effect");
-			try {
-				_standard_effect = streamfx::obs::gs::effect::create(file);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
-			}
+
+		// A unit quad that never changes, everything else is done by the matrix, see video_tick().
+		for (uint32_t idx = 0; idx < 4; idx++) {
+			auto vtx   = _vertex_buffer->at(idx);
+			*vtx.color = 0xFFFFFFFF;
+			vec3_set(vtx.position, static_cast<float>(idx % 2) * 2.f - 1.f, static_cast<float>(idx / 2) * 2.f - 1.f, 0);
+			vec4_set(vtx.uv[0], static_cast<float>(idx % 2), static_cast<float>(idx / 2), 0, 0);
 		}
+		_vertex_buffer->update(true);
+		matrix4_identity(&_matrix);
 		{
 			auto file = streamfx::data_file_path("effects/transform.effect");
 			try {
@@ -117,6 +173,11 @@ transform_instance::transform_instance(obs_data_t* data, obs_source_t* context)
 				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 			}
 		}
+		try {
+			_cache_checksum = std::make_shared<streamfx::gfx::checksum>();
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("Input will be transformed again every frame: %s", ex.what());
+		}
 		{
 			_sampler.set_address_mode_u(GS_ADDRESS_CLAMP);
 			_sampler.set_address_mode_v(GS_ADDRESS_CLAMP);
@@ -142,6 +203,7 @@ transform_instance::transform_instance(obs_data_t* data, obs_source_t* context)
 transform_instance::~transform_instance()
 {
 	_vertex_buffer.reset();
+	_grid.reset();
 	_cache_rt.reset();
 	_cache_texture.reset();
 	_mipmap_texture.reset();
@@ -204,39 +266,60 @@ void transform_instance::migrate(obs_data_t* settings, uint64_t version)
 
 void transform_instance::update(obs_data_t* settings)
 {
+	auto equal = [](vec3 const& a, vec3 const& b) { return (a.x == b.x) && (a.y == b.y) && (a.z == b.z); };
+
 	// Camera
-	_camera_mode = static_cast<transform_mode>(obs_data_get_int(settings, ST_KEY_CAMERA_MODE));
-	_camera_fov  = static_cast<float>(obs_data_get_double(settings, ST_KEY_CAMERA_FIELDOFVIEW));
+	auto camera_mode = static_cast<transform_mode>(obs_data_get_int(settings, ST_KEY_CAMERA_MODE));
+	if (camera_mode != _camera_mode) {
+		_camera_mode   = camera_mode;
+		_update_matrix = true;
+	}
+	_camera_fov = static_cast<float>(obs_data_get_double(settings, ST_KEY_CAMERA_FIELDOFVIEW));
 
 	{ // Parametrized Mesh
-		_params.position.x     = static_cast<float>(obs_data_get_double(settings, ST_KEY_POSITION_X) / 100.0);
-		_params.position.y     = static_cast<float>(obs_data_get_double(settings, ST_KEY_POSITION_Y) / 100.0);
-		_params.position.z     = static_cast<float>(obs_data_get_double(settings, ST_KEY_POSITION_Z) / 100.0);
-		_params.scale.x        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SCALE_X) / 100.0);
-		_params.scale.y        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SCALE_Y) / 100.0);
-		_params.scale.z        = 1.0f;
-		_params.rotation_order = static_cast<uint32_t>(obs_data_get_int(settings, ST_KEY_ROTATION_ORDER));
-		_params.rotation.x     = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROTATION_X) / 180.0 * S_PI);
-		_params.rotation.y     = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROTATION_Y) / 180.0 * S_PI);
-		_params.rotation.z     = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROTATION_Z) / 180.0 * S_PI);
-		_params.shear.x        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SHEAR_X) / 100.0);
-		_params.shear.y        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SHEAR_Y) / 100.0);
-		_params.shear.z        = 0.0f;
+		auto params           = _params;
+		params.position.x     = static_cast<float>(obs_data_get_double(settings, ST_KEY_POSITION_X) / 100.0);
+		params.position.y     = static_cast<float>(obs_data_get_double(settings, ST_KEY_POSITION_Y) / 100.0);
+		params.position.z     = static_cast<float>(obs_data_get_double(settings, ST_KEY_POSITION_Z) / 100.0);
+		params.scale.x        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SCALE_X) / 100.0);
+		params.scale.y        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SCALE_Y) / 100.0);
+		params.scale.z        = 1.0f;
+		params.rotation_order = static_cast<uint32_t>(obs_data_get_int(settings, ST_KEY_ROTATION_ORDER));
+		params.rotation.x     = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROTATION_X) / 180.0 * S_PI);
+		params.rotation.y     = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROTATION_Y) / 180.0 * S_PI);
+		params.rotation.z     = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROTATION_Z) / 180.0 * S_PI);
+		params.shear.x        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SHEAR_X) / 100.0);
+		params.shear.y        = static_cast<float>(obs_data_get_double(settings, ST_KEY_SHEAR_Y) / 100.0);
+		params.shear.z        = 0.0f;
+
+		// Animated transforms usually only change one or two of these, and nothing at all most of the time.
+		if (!equal(params.position, _params.position) || !equal(params.rotation, _params.rotation) || (params.rotation_order != _params.rotation_order) || !equal(params.scale, _params.scale) || !equal(params.shear, _params.shear)) {
+			_params        = params;
+			_update_matrix = true;
+		}
 	}
 	{ // Corners
+		auto corners = _corners;
+
 		std::pair<std::string, float&> opts[] = {
 			{ST_KEY_CORNERS_TOPLEFT "X", _corners.tl.x}, {ST_KEY_CORNERS_TOPLEFT "Y", _corners.tl.y}, {ST_KEY_CORNERS_TOPRIGHT "X", _corners.tr.x}, {ST_KEY_CORNERS_TOPRIGHT "Y", _corners.tr.y}, {ST_KEY_CORNERS_BOTTOMLEFT "X", _corners.bl.x}, {ST_KEY_CORNERS_BOTTOMLEFT "Y", _corners.bl.y}, {ST_KEY_CORNERS_BOTTOMRIGHT "X", _corners.br.x}, {ST_KEY_CORNERS_BOTTOMRIGHT "Y", _corners.br.y},
 		};
 		for (auto opt : opts) {
 			opt.second = static_cast<float>(obs_data_get_double(settings, opt.first.c_str()) / 100.0);
 		}
+
+		// Only the grid level depends on the corners, the grid itself is deformed while rendering.
+		if (std::memcmp(&corners, &_corners, sizeof(_corners)) != 0) {
+			_update_matrix = true;
+		}
 	}
 
 	// Mip-mapping
 	_mipmap_enabled = obs_data_get_bool(settings, ST_KEY_MIPMAPPING);
 	_sampler.set_filter(_mipmap_enabled ? GS_FILTER_ANISOTROPIC : GS_FILTER_LINEAR);
 
-	_update_mesh = true;
+	_mipmap_rendered = false;
+	_source_rendered = false;
 }
 
 void transform_instance::video_tick(float)
@@ -254,13 +337,13 @@ void transform_instance::video_tick(float)
 
 	// If size mismatch, force an update.
 	if (width != _source_size.first) {
-		_update_mesh = true;
+		_update_matrix = true;
 	} else if (height != _source_size.second) {
-		_update_mesh = true;
+		_update_matrix = true;
 	}
 
-	// Update Mesh
-	if (_update_mesh) {
+	// Update Matrix
+	if (_update_matrix) {
 		_source_size.first  = width;
 		_source_size.second = height;
 
@@ -277,9 +360,14 @@ void transform_instance::video_tick(float)
 			if (_camera_mode == transform_mode::ORTHOGRAPHIC)
 				aspect_ratio_x = 1.0;
 
-			// Mesh
-			matrix4 ident;
+			/// Scale and shear the unit quad first, which used to be baked into the mesh.
+			float p_x = aspect_ratio_x * _params.scale.x;
+			float p_y = 1.0f * _params.scale.y;
+
+			matrix4& ident = _matrix;
 			matrix4_identity(&ident);
+			vec4_set(&ident.x, p_x, _params.shear.y, 0, 0);
+			vec4_set(&ident.y, -_params.shear.x, p_y, 0, 0);
 			switch (_params.rotation_order) {
 			case RotationOrder::XYZ: // XYZ
 				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, _params.rotation.x);
@@ -313,52 +401,25 @@ void transform_instance::video_tick(float)
 				break;
 			}
 			matrix4_translate3f(&ident, &ident, _params.position.x, _params.position.y, _params.position.z);
-			//matrix4_scale3f(&ident, &ident, _source_size.first / 2.f, _source_size.second / 2.f, 1.f);
-
-			/// Calculate vertex position once only.
-			float p_x = aspect_ratio_x * _params.scale.x;
-			float p_y = 1.0f * _params.scale.y;
-
-			/// Generate mesh
-			{
-				auto vtx   = _vertex_buffer->at(0);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 0, 0, 0, 0);
-				vec3_set(vtx.position, -p_x + _params.shear.x, -p_y - _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(1);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 1, 0, 0, 0);
-				vec3_set(vtx.position, p_x + _params.shear.x, -p_y + _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(2);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 0, 1, 0, 0);
-				vec3_set(vtx.position, -p_x - _params.shear.x, p_y - _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(3);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 1, 1, 0, 0);
-				vec3_set(vtx.position, p_x - _params.shear.x, p_y + _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
 		} else if (_camera_mode == transform_mode::CORNER_PIN) {
-			// Corner Pin is rendered in Fragment.
+			// A triangle only interpolates linearly, while the mapping between the corners is bilinear. The error of that
+			// is at most a quarter of how far the quad is from being a parallelogram, shrinking with the square of the
+			// subdivisions, so pick the coarsest grid that keeps it below a quarter pixel.
+			float_t  dx    = (_corners.tl.x - _corners.tr.x + _corners.br.x - _corners.bl.x) * .5f * float_t(width);
+			float_t  dy    = (_corners.tl.y - _corners.tr.y + _corners.br.y - _corners.bl.y) * .5f * float_t(height);
+			float_t  cells = std::sqrt(std::sqrt(dx * dx + dy * dy));
+			uint32_t level = (cells > 1.f) ? static_cast<uint32_t>(std::ceil(std::log2(cells))) : 0;
+			_grid          = get_grid(level);
 		}
 
-		_vertex_buffer->update(true);
-		_update_mesh = false;
+		_update_matrix   = false;
+		_mipmap_rendered = false;
+		_source_rendered = false;
 	}
 
-	_cache_rendered  = false;
-	_mipmap_rendered = false;
-	_source_rendered = false;
+	// The input has to be captured every frame to find out whether it changed, everything after that only when it
+	// did, or when the transform did.
+	_cache_rendered = false;
 }
 
 void transform_instance::video_render(gs_effect_t* effect)
@@ -371,8 +432,8 @@ void transform_instance::video_render(gs_effect_t* effect)
 	if (!effect)
 		effect = default_effect;
 
-	if (!base_width || !base_height || !parent || !target || !_standard_effect || !_transform_effect) { // Skip if something is wrong.
-		obs_source_skip_video_filter(_self);
+	if (!base_width || !base_height || !parent || !target || !_transform_effect) { // Skip if something is wrong.
+		skip_video_filter();
 		return;
 	}
 
@@ -424,41 +485,45 @@ void transform_instance::video_render(gs_effect_t* effect)
 
 			gs_blend_state_pop();
 		} else {
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 
 		_cache_rendered = true;
+		if (cache_changed()) {
+			_mipmap_rendered = false;
+			_source_rendered = false;
+		}
 	}
 	_cache_rt->get_texture(_cache_texture);
 	if (!_cache_texture) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
-	if (_mipmap_enabled) {
+	// Under heavy load the mipmaps are not rebuilt, and the cache is sampled directly instead. It already has the size
+	// of the mipmapped texture, so the output only gets a bit more aliased.
+	bool mipmap = _mipmap_enabled && (_governor->level() < 2);
+	if (mipmap) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Mipmap"};
 #endif
 
-		if (!_mipmap_texture || (_mipmap_texture->get_width() != cache_width) || (_mipmap_texture->get_height() != cache_height)) {
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-			streamfx::obs::gs::debug_marker gdr{streamfx::obs::gs::debug_color_allocate, "Allocate Mipmapped Texture"};
-#endif
-
-			std::size_t mip_levels = _mipmapper.calculate_max_mip_level(cache_width, cache_height);
-			_mipmap_texture        = std::make_shared<streamfx::obs::gs::texture>(cache_width, cache_height, GS_RGBA, static_cast<uint32_t>(mip_levels), nullptr, streamfx::obs::gs::texture::flags::None);
+		// Anything else that wants the mip chain of our target this frame gets the same one, and the other way around.
+		auto mipmap_texture = _mip_chain->get(target, _cache_texture, calculate_mip_levels(base_width, base_height, cache_width, cache_height), !_mipmap_rendered);
+		if (mipmap_texture != _mipmap_texture) {
+			_mipmap_texture  = mipmap_texture;
+			_source_rendered = false;
 		}
-		_mipmapper.rebuild(_cache_texture, _mipmap_texture);
 
 		_mipmap_rendered = true;
 		if (!_mipmap_texture) {
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 	}
 
-	{
+	if (!_source_rendered) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Transform"};
 #endif
@@ -496,19 +561,20 @@ void transform_instance::video_render(gs_effect_t* effect)
 		if (_camera_mode != transform_mode::CORNER_PIN) {
 			gs_load_vertexbuffer(_vertex_buffer->update(false));
 			gs_load_indexbuffer(nullptr);
-			if (auto v = _standard_effect.get_parameter("InputA"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Texture) {
-				v.set_texture(_mipmap_enabled ? (_mipmap_texture ? _mipmap_texture->get_object() : _cache_texture->get_object()) : _cache_texture->get_object());
+			if (auto v = _transform_effect.get_parameter("InputA"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Texture) {
+				v.set_texture(mipmap ? (_mipmap_texture ? _mipmap_texture->get_object() : _cache_texture->get_object()) : _cache_texture->get_object());
 				v.set_sampler(_sampler.get_object());
 			}
-			while (gs_effect_loop(_standard_effect.get_object(), "Draw")) {
+			if (auto v = _transform_effect.get_parameter("Transform"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Matrix) {
+				v.set_matrix(_matrix);
+			}
+			while (gs_effect_loop(_transform_effect.get_object(), "Transform")) {
 				gs_draw(GS_TRISTRIP, 0, _vertex_buffer->size());
 			}
 			gs_load_vertexbuffer(nullptr);
 		} else {
-			gs_load_vertexbuffer(nullptr);
-			gs_load_indexbuffer(nullptr);
 			if (auto v = _transform_effect.get_parameter("InputA"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Texture) {
-				v.set_texture(_mipmap_enabled ? (_mipmap_texture ? _mipmap_texture->get_object() : _cache_texture->get_object()) : _cache_texture->get_object());
+				v.set_texture(mipmap ? (_mipmap_texture ? _mipmap_texture->get_object() : _cache_texture->get_object()) : _cache_texture->get_object());
 				v.set_sampler(_sampler.get_object());
 			}
 			if (auto v = _transform_effect.get_parameter("CornerTL"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
@@ -523,16 +589,24 @@ void transform_instance::video_render(gs_effect_t* effect)
 			if (auto v = _transform_effect.get_parameter("CornerBR"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
 				v.set_float2(_corners.br);
 			}
+			if (!_grid) { // Switched to Corner Pin since the last tick.
+				_grid = get_grid(ST_GRID_LEVEL_MAX);
+			}
+			gs_load_vertexbuffer(_grid->vertices->update(false));
+			gs_load_indexbuffer(_grid->indices->get(false));
 			while (gs_effect_loop(_transform_effect.get_object(), "CornerPin")) {
-				_gfx_util->draw_fullscreen_triangle();
+				gs_draw(GS_TRIS, 0, static_cast<uint32_t>(_grid->indices->size()));
 			}
+			gs_load_indexbuffer(nullptr);
+			gs_load_vertexbuffer(nullptr);
 		}
 
 		gs_blend_state_pop();
+		_source_rendered = true;
 	}
 	_source_rt->get_texture(_source_texture);
 	if (!_source_texture) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -548,6 +622,74 @@ void transform_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+bool transform_instance::cache_changed()
+{
+	if (!_cache_checksum) {
+		return true;
+	}
+
+	// The checksum arrives one frame late, so a change leaves the output one frame behind at worst.
+	uint64_t value = 0;
+	if (!_cache_checksum->update(_cache_rt->get_texture(), value)) {
+		return true;
+	}
+	if (value == _cache_checksum_value) {
+		return false;
+	}
+	_cache_checksum_value = value;
+	return true;
+}
+
+uint32_t transform_instance::calculate_mip_levels(uint32_t base_width, uint32_t base_height, uint32_t cache_width, uint32_t cache_height)
+{
+	uint32_t max_levels = _mip_chain->calculate_max_mip_level(cache_width, cache_height);
+
+	// Find where the corners of the texture end up on screen, in pixels. Order is TL, TR, BL, BR.
+	std::array<vec2, 4> screen;
+	if (_camera_mode == transform_mode::CORNER_PIN) {
+		vec2_set(&screen[0], _corners.tl.x * base_width, _corners.tl.y * base_height);
+		vec2_set(&screen[1], _corners.tr.x * base_width, _corners.tr.y * base_height);
+		vec2_set(&screen[2], _corners.bl.x * base_width, _corners.bl.y * base_height);
+		vec2_set(&screen[3], _corners.br.x * base_width, _corners.br.y * base_height);
+	} else {
+		float_t focal  = 1.f / std::tan(static_cast<float_t>(D_DEG_TO_RAD(_camera_fov)) / 2.f);
+		float_t aspect = float_t(base_width) / float_t(base_height);
+		const vec3* positions = _vertex_buffer->get_positions();
+		for (uint32_t idx = 0; idx < 4; idx++) {
+			vec3 transformed;
+			vec3_transform(&transformed, &positions[idx], &_matrix);
+			const vec3* position = &transformed;
+			float_t     x        = position->x;
+			float_t     y        = position->y;
+			if (_camera_mode == transform_mode::PERSPECTIVE) {
+				// The camera sits one unit in front of the plane, see video_render().
+				float_t depth = 1.f - position->z;
+				if (depth <= nearZ) {
+					return max_levels;
+				}
+				x = (x * focal / aspect) / depth;
+				y = (y * focal) / depth;
+			}
+			vec2_set(&screen[idx], (x + 1.f) * .5f * base_width, (y + 1.f) * .5f * base_height);
+		}
+	}
+
+	// On a flat quad the most extreme minification is along one of its edges, which decides the deepest level that
+	// the sampler can reach.
+	float_t ratio = std::max({
+		float_t(cache_width) / vec2_dist(&screen[0], &screen[1]),
+		float_t(cache_width) / vec2_dist(&screen[2], &screen[3]),
+		float_t(cache_height) / vec2_dist(&screen[0], &screen[2]),
+		float_t(cache_height) / vec2_dist(&screen[1], &screen[3]),
+	});
+	if (!std::isfinite(ratio)) {
+		return max_levels;
+	}
+
+	// Keep one more level than strictly needed, so that blending between levels never reaches a stale one.
+	return std::clamp<uint32_t>(static_cast<uint32_t>(std::ceil(std::log2(std::max(ratio, 1.f)))) + 2, 1, max_levels);
+}
+
 transform_factory::transform_factory()
 {
 	_info.id           = S_PREFIX "filter-transform";
@@ -589,7 +731,7 @@ void transform_factory::get_defaults2(obs_data_t* settings)
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMLEFT "Y", 100.);
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMRIGHT "X", 100.);
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMRIGHT "Y", 100.);
-	obs_data_set_default_bool(settings, ST_KEY_MIPMAPPING, false);
+	obs_data_set_default_bool(settings, ST_KEY_MIPMAPPING, streamfx::gfx::resolve_quality_tier() == streamfx::gfx::quality_tier::High);
 }
 
 static bool modified_camera_mode(obs_properties_t* pr, obs_property_t*, obs_data_t* d) noexcept
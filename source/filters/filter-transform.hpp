@@ -4,9 +4,12 @@
 
 #pragma once
 #include "common.hpp"
-#include "gfx/gfx-mipmapper.hpp"
+#include "gfx/gfx-checksum.hpp"
+#include "gfx/gfx-governor.hpp"
+#include "gfx/gfx-mip-chain.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-indexbuffer.hpp"
 #include "obs/gs/gs-texture.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
 #include "obs/obs-source-factory.hpp"
@@ -22,8 +25,15 @@ namespace streamfx::filter::transform {
 		CORNER_PIN   = 2,
 	};
 
+	/** A grid over the unit square, shared by all instances that use the same subdivision level. */
+	struct grid_mesh {
+		std::shared_ptr<streamfx::obs::gs::vertex_buffer> vertices;
+		std::shared_ptr<streamfx::obs::gs::index_buffer>  indices;
+	};
+
 	class transform_instance : public obs::source_instance {
-		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+		std::shared_ptr<streamfx::gfx::util>     _gfx_util;
+		std::shared_ptr<streamfx::gfx::governor> _governor;
 
 		// Settings
 		transform_mode _camera_mode;
@@ -43,7 +53,6 @@ namespace streamfx::filter::transform {
 		} _corners;
 
 		// Data
-		streamfx::obs::gs::effect  _standard_effect;
 		streamfx::obs::gs::effect  _transform_effect;
 		streamfx::obs::gs::sampler _sampler;
 
@@ -51,11 +60,13 @@ namespace streamfx::filter::transform {
 		bool                                             _cache_rendered;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _cache_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _cache_texture;
+		std::shared_ptr<streamfx::gfx::checksum>         _cache_checksum;
+		uint64_t                                         _cache_checksum_value;
 
 		// Mip-mapping
 		bool                                        _mipmap_enabled;
 		bool                                        _mipmap_rendered;
-		streamfx::gfx::mipmapper                    _mipmapper;
+		std::shared_ptr<streamfx::gfx::mip_chain>   _mip_chain;
 		std::shared_ptr<streamfx::obs::gs::texture> _mipmap_texture;
 
 		// Input
@@ -65,8 +76,10 @@ namespace streamfx::filter::transform {
 		std::shared_ptr<streamfx::obs::gs::texture>      _source_texture;
 
 		// Mesh
-		bool                                              _update_mesh;
+		bool                                              _update_matrix;
+		matrix4                                           _matrix;
 		std::shared_ptr<streamfx::obs::gs::vertex_buffer> _vertex_buffer;
+		std::shared_ptr<grid_mesh>                        _grid;
 
 		public:
 		transform_instance(obs_data_t*, obs_source_t*);
@@ -78,6 +91,11 @@ namespace streamfx::filter::transform {
 
 		virtual void video_tick(float) override;
 		virtual void video_render(gs_effect_t*) override;
+
+		private:
+		bool cache_changed();
+
+		uint32_t calculate_mip_levels(uint32_t base_width, uint32_t base_height, uint32_t cache_width, uint32_t cache_height);
 	};
 
 	class transform_factory : public obs::source_factory<filter::transform::transform_factory, filter::transform::transform_instance> {
@@ -3,12 +3,17 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "filter-upscaling.hpp"
+#include "configuration.hpp"
+#include "gfx/gfx-quality.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-source-handoff.hpp"
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -29,6 +34,31 @@
 #define ST_KEY_PROVIDER "Provider"
 #define ST_I18N_PROVIDER ST_I18N "." ST_KEY_PROVIDER
 #define ST_I18N_PROVIDER_NVIDIA_SUPERRES ST_I18N_PROVIDER ".NVIDIA.SuperResolution"
+#define ST_I18N_PROVIDER_EDGEADAPTIVE ST_I18N_PROVIDER ".EdgeAdaptive"
+#define ST_KEY_ROI "RegionOfInterest"
+#define ST_I18N_ROI ST_I18N "." ST_KEY_ROI
+#define ST_KEY_ROI_LEFT "RegionOfInterest.Left"
+#define ST_I18N_ROI_LEFT ST_I18N "." ST_KEY_ROI_LEFT
+#define ST_KEY_ROI_TOP "RegionOfInterest.Top"
+#define ST_I18N_ROI_TOP ST_I18N "." ST_KEY_ROI_TOP
+#define ST_KEY_ROI_RIGHT "RegionOfInterest.Right"
+#define ST_I18N_ROI_RIGHT ST_I18N "." ST_KEY_ROI_RIGHT
+#define ST_KEY_ROI_BOTTOM "RegionOfInterest.Bottom"
+#define ST_I18N_ROI_BOTTOM ST_I18N "." ST_KEY_ROI_BOTTOM
+
+#define ST_KEY_EDGEADAPTIVE "EdgeAdaptive"
+#define ST_I18N_EDGEADAPTIVE ST_I18N "." ST_KEY_EDGEADAPTIVE
+#define ST_KEY_EDGEADAPTIVE_SCALE "EdgeAdaptive.Scale"
+#define ST_I18N_EDGEADAPTIVE_SCALE ST_I18N "." ST_KEY_EDGEADAPTIVE_SCALE
+#define ST_KEY_EDGEADAPTIVE_SHARPNESS "EdgeAdaptive.Sharpness"
+#define ST_I18N_EDGEADAPTIVE_SHARPNESS ST_I18N "." ST_KEY_EDGEADAPTIVE_SHARPNESS
+#define ST_I18N_VARIANT ST_I18N ".Variant"
+#define ST_I18N_VARIANT_SCALE ST_I18N_VARIANT ".Scale"
+#define ST_I18N_VARIANT_NAME ST_I18N_VARIANT ".Name"
+
+#define ST_I18N_OUTPUTSOURCE "Source.UpscalingOutput"
+#define ST_KEY_OUTPUTSOURCE_NAME "Name"
+#define ST_I18N_OUTPUTSOURCE_NAME ST_I18N_OUTPUTSOURCE "." ST_KEY_OUTPUTSOURCE_NAME
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 #define ST_KEY_NVIDIA_SUPERRES "NVIDIA.SuperRes"
@@ -39,11 +69,20 @@
 #define ST_I18N_NVIDIA_SUPERRES_STRENGTH_STRONG ST_I18N_NVIDIA_SUPERRES_STRENGTH ".Strong"
 #define ST_KEY_NVIDIA_SUPERRES_SCALE "NVIDIA.SuperRes.Scale"
 #define ST_I18N_NVIDIA_SUPERRES_SCALE ST_I18N "." ST_KEY_NVIDIA_SUPERRES_SCALE
+#define ST_KEY_NVIDIA_SUPERRES_PIPELINED "NVIDIA.SuperRes.Pipelined"
+#define ST_I18N_NVIDIA_SUPERRES_PIPELINED ST_I18N "." ST_KEY_NVIDIA_SUPERRES_PIPELINED
+#define ST_KEY_NVIDIA_SUPERRES_PRECISION "NVIDIA.SuperRes.Precision"
+#define ST_I18N_NVIDIA_SUPERRES_PRECISION ST_I18N "." ST_KEY_NVIDIA_SUPERRES_PRECISION
+#define ST_I18N_NVIDIA_SUPERRES_PRECISION_FULL ST_I18N_NVIDIA_SUPERRES_PRECISION ".Full"
+#define ST_I18N_NVIDIA_SUPERRES_PRECISION_HALF ST_I18N_NVIDIA_SUPERRES_PRECISION ".Half"
 #endif
 
 using streamfx::filter::upscaling::upscaling_factory;
 using streamfx::filter::upscaling::upscaling_instance;
+using streamfx::filter::upscaling::upscaling_output_factory;
+using streamfx::filter::upscaling::upscaling_output_instance;
 using streamfx::filter::upscaling::upscaling_provider;
+using streamfx::filter::upscaling::variant;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-Upscaling";
 
@@ -52,6 +91,7 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
  */
 static upscaling_provider provider_priority[] = {
 	upscaling_provider::NVIDIA_SUPERRESOLUTION,
+	upscaling_provider::EDGE_ADAPTIVE,
 };
 
 const char* streamfx::filter::upscaling::cstring(upscaling_provider provider)
@@ -63,6 +103,8 @@ const char* streamfx::filter::upscaling::cstring(upscaling_provider provider)
 		return D_TRANSLATE(S_STATE_AUTOMATIC);
 	case upscaling_provider::NVIDIA_SUPERRESOLUTION:
 		return D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_SUPERRES);
+	case upscaling_provider::EDGE_ADAPTIVE:
+		return D_TRANSLATE(ST_I18N_PROVIDER_EDGEADAPTIVE);
 	default:
 		throw std::runtime_error("Missing Conversion Entry");
 	}
@@ -73,10 +115,44 @@ std::string streamfx::filter::upscaling::string(upscaling_provider provider)
 	return cstring(provider);
 }
 
+static constexpr struct {
+	const char* group;
+	const char* scale;
+	const char* name;
+	const char* number;
+} variant_keys[streamfx::filter::upscaling::max_variants] = {
+	{"Variant.1", "Variant.1.Scale", "Variant.1.Name", "1"},
+	{"Variant.2", "Variant.2.Scale", "Variant.2.Name", "2"},
+	{"Variant.3", "Variant.3.Scale", "Variant.3.Name", "3"},
+};
+
+/** Crop the size to the region of interest, and return the part of the frame it covers as left, right, top, bottom.
+ *
+ * At least a single pixel always remains, no matter how large the region is set.
+ */
+static vec4 apply_roi(std::array<uint32_t, 4> const& roi, uint32_t& width, uint32_t& height)
+{
+	vec4 area;
+	vec4_set(&area, 0., 1., 0., 1.);
+	if ((width == 0) || (height == 0)) {
+		return area;
+	}
+
+	uint32_t left   = std::min<uint32_t>(roi[0], width - 1);
+	uint32_t top    = std::min<uint32_t>(roi[1], height - 1);
+	uint32_t right  = std::min<uint32_t>(roi[2], width - 1 - left);
+	uint32_t bottom = std::min<uint32_t>(roi[3], height - 1 - top);
+
+	vec4_set(&area, static_cast<float>(left) / static_cast<float>(width), static_cast<float>(width - right) / static_cast<float>(width), static_cast<float>(top) / static_cast<float>(height), static_cast<float>(height - bottom) / static_cast<float>(height));
+	width -= left + right;
+	height -= top + bottom;
+	return area;
+}
+
 //------------------------------------------------------------------------------
 // Instance
 //------------------------------------------------------------------------------
-upscaling_instance::upscaling_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _in_size(1, 1), _out_size(1, 1), _provider(upscaling_provider::INVALID), _provider_ui(upscaling_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _input(), _output(), _dirty(false)
+upscaling_instance::upscaling_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _in_size(1, 1), _out_size(1, 1), _roi(), _provider(upscaling_provider::INVALID), _provider_ui(upscaling_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _input(), _input_color(), _input_alpha(), _output(), _dirty(false), _easu_effect(), _easu_util(), _easu_upscaled(), _easu_sharpened(), _easu_scale(1.5f), _easu_sharpness(.8f), _mip_chain(::streamfx::gfx::mip_chain::instance()), _variants()
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -86,10 +162,12 @@ upscaling_instance::upscaling_instance(obs_data_t* data, obs_source_t* self) : o
 		// Create the render target for the input buffering.
 		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
 		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
-		_output = _input->get_texture();
+		_input_color = _input->get_texture();
+		_input_alpha = _input_color;
+		_output      = _input_color;
 
 		// Load the required effect.
-		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
+		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::obs::gs::effect_registry::instance()->get(::streamfx::data_file_path("effects/standard.effect")));
 
 		// Create Samplers
 		_channel0_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
@@ -105,11 +183,14 @@ upscaling_instance::upscaling_instance(obs_data_t* data, obs_source_t* self) : o
 	if (data) {
 		load(data);
 	}
+
+	::streamfx::obs::handoff::offer(_self, true);
 }
 
 upscaling_instance::~upscaling_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+	::streamfx::obs::handoff::offer(_self, false);
 
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
@@ -128,10 +209,18 @@ upscaling_instance::~upscaling_instance()
 			nvvfxsr_unload();
 			break;
 #endif
+		case upscaling_provider::EDGE_ADAPTIVE:
+			easu_unload();
+			break;
 		default:
 			break;
 		}
 	}
+
+	// Output sources only hold on to the variants while drawing them.
+	for (auto& variant : _variants) {
+		std::atomic_store(&variant.published, std::shared_ptr<::streamfx::filter::upscaling::variant>());
+	}
 }
 
 void upscaling_instance::load(obs_data_t* data)
@@ -143,6 +232,9 @@ void upscaling_instance::migrate(obs_data_t* data, uint64_t version) {}
 
 void upscaling_instance::update(obs_data_t* data)
 {
+	// Only the region of interest is processed, everything around it is cropped away.
+	_roi = {static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_LEFT)), static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_TOP)), static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_RIGHT)), static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_ROI_BOTTOM))};
+
 	// Check if the user changed which Denoising provider we use.
 	upscaling_provider provider = static_cast<upscaling_provider>(obs_data_get_int(data, ST_KEY_PROVIDER));
 	if (provider == upscaling_provider::AUTOMATIC) {
@@ -155,6 +247,32 @@ void upscaling_instance::update(obs_data_t* data)
 		switch_provider(provider);
 	}
 
+	// Variants are published under a name, so that output sources can show them.
+	for (size_t idx = 0; idx < max_variants; idx++) {
+		auto& variant = _variants[idx];
+		auto& keys    = variant_keys[idx];
+
+		variant.scale = static_cast<float>(obs_data_get_int(data, keys.scale)) / 100.f;
+		if (variant.scale <= 0) {
+			variant.name.clear();
+			std::atomic_store(&variant.published, std::shared_ptr<::streamfx::filter::upscaling::variant>());
+			continue;
+		}
+
+		std::string name = obs_data_get_string(data, keys.name);
+		if (name.empty()) {
+			name = std::string(obs_source_get_name(_self)) + " " + keys.number;
+		}
+		if ((name != variant.name) || !variant.published) {
+			variant.name = name;
+			std::atomic_store(&variant.published, std::shared_ptr<::streamfx::filter::upscaling::variant>());
+			std::atomic_store(&variant.published, upscaling_factory::instance()->publish(name));
+			if (!variant.published) {
+				D_LOG_WARNING("Variant '%s' is already published by another upscaling filter.", name.c_str());
+			}
+		}
+	}
+
 	if (_provider_ready) {
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -164,6 +282,9 @@ void upscaling_instance::update(obs_data_t* data)
 			nvvfxsr_update(data);
 			break;
 #endif
+		case upscaling_provider::EDGE_ADAPTIVE:
+			easu_update(data);
+			break;
 		default:
 			break;
 		}
@@ -172,15 +293,42 @@ void upscaling_instance::update(obs_data_t* data)
 
 void streamfx::filter::upscaling::upscaling_instance::properties(obs_properties_t* properties)
 {
+	{ // Region of Interest
+		auto grp = obs_properties_create();
+		obs_properties_add_group(properties, ST_KEY_ROI, D_TRANSLATE(ST_I18N_ROI), OBS_GROUP_NORMAL, grp);
+
+		for (auto [key, name] : {std::pair{ST_KEY_ROI_LEFT, ST_I18N_ROI_LEFT}, std::pair{ST_KEY_ROI_TOP, ST_I18N_ROI_TOP}, std::pair{ST_KEY_ROI_RIGHT, ST_I18N_ROI_RIGHT}, std::pair{ST_KEY_ROI_BOTTOM, ST_I18N_ROI_BOTTOM}}) {
+			auto p = obs_properties_add_int(grp, key, D_TRANSLATE(name), 0, 16384, 1);
+			obs_property_int_set_suffix(p, " px");
+		}
+	}
+
 	switch (_provider_ui) {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 	case upscaling_provider::NVIDIA_SUPERRESOLUTION:
 		nvvfxsr_properties(properties);
 		break;
 #endif
+	case upscaling_provider::EDGE_ADAPTIVE:
+		easu_properties(properties);
+		break;
 	default:
 		break;
 	}
+
+	for (auto const& keys : variant_keys) {
+		auto grp = obs_properties_create();
+
+		{
+			auto p = obs_properties_add_int_slider(grp, keys.scale, D_TRANSLATE(ST_I18N_VARIANT_SCALE), 0, 100, 1);
+			obs_property_int_set_suffix(p, " %");
+		}
+		obs_properties_add_text(grp, keys.name, D_TRANSLATE(ST_I18N_VARIANT_NAME), OBS_TEXT_DEFAULT);
+
+		std::vector<char> buffer(256);
+		snprintf(buffer.data(), buffer.size(), D_TRANSLATE(ST_I18N_VARIANT), keys.number);
+		obs_properties_add_group(properties, keys.group, buffer.data(), OBS_GROUP_NORMAL, grp);
+	}
 }
 
 uint32_t streamfx::filter::upscaling::upscaling_instance::get_width()
@@ -198,8 +346,9 @@ void upscaling_instance::video_tick(float_t time)
 	auto target = obs_filter_get_target(_self);
 	auto width  = obs_source_get_base_width(target);
 	auto height = obs_source_get_base_height(target);
-	_in_size    = {width, height};
-	_out_size   = _in_size;
+	apply_roi(_roi, width, height);
+	_in_size  = {width, height};
+	_out_size = _in_size;
 
 	// Allow the provider to restrict the size.
 	if (target && _provider_ready) {
@@ -211,6 +360,9 @@ void upscaling_instance::video_tick(float_t time)
 			nvvfxsr_size();
 			break;
 #endif
+		case upscaling_provider::EDGE_ADAPTIVE:
+			easu_size();
+			break;
 		default:
 			break;
 		}
@@ -236,7 +388,7 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 	// - We don't have a target.
 	// - The width/height of the next filter in the chain is empty.
 	if (!_provider_ready || !target || (width == 0) || (height == 0)) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -245,20 +397,28 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 	::streamfx::obs::gs::debug_marker profiler0_0{::streamfx::obs::gs::debug_color_gray, "'%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(parent)};
 #endif
 
+	// Only the region of interest is captured.
+	vec4 area = apply_roi(_roi, width, height);
+
 	if (_dirty) {
 		// Lock the provider from being changed.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
-		{ // Capture the incoming frame.
+		{ // Capture the incoming frame, or take it as it is from the filter below if that can hand it over.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_capture, "Capture"};
 #endif
-			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+			bool                             whole    = (_roi[0] == 0) && (_roi[1] == 0) && (_roi[2] == 0) && (_roi[3] == 0) && (_in_size.first == width) && (_in_size.second == height);
+			::streamfx::obs::handoff::result received = {};
+			if (whole && ::streamfx::obs::handoff::receive(target, _input, _in_size.first, _in_size.second, received)) {
+				_input_color = received.color;
+				_input_alpha = received.alpha;
+			} else if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
 				auto op = _input->render(_in_size.first, _in_size.second);
 
 				// Matrix
 				gs_matrix_push();
-				gs_ortho(0., 1., 0., 1., 0., 1.);
+				gs_ortho(area.x, area.y, area.z, area.w, 0., 1.);
 
 				// Clear the buffer
 				gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
@@ -280,8 +440,11 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 				// Reset GPU state
 				gs_blend_state_pop();
 				gs_matrix_pop();
+
+				_input_color = _input->get_texture();
+				_input_alpha = _input_color;
 			} else {
-				obs_source_skip_video_filter(_self);
+				skip_video_filter();
 				return;
 			}
 		}
@@ -296,24 +459,34 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 				nvvfxsr_process();
 				break;
 #endif
+			case upscaling_provider::EDGE_ADAPTIVE:
+				easu_process();
+				break;
 			default:
 				_output.reset();
 				break;
 			}
 		} catch (...) {
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 
 		if (!_output) {
 			D_LOG_ERROR("Provider '%s' did not return a result.", cstring(_provider));
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 
+		render_variants();
+
 		_dirty = false;
 	}
 
+	// The filter above may take the result as it is, which saves drawing it here and capturing it again there.
+	if (::streamfx::obs::handoff::provide(_self, {_output, _input_alpha})) {
+		return;
+	}
+
 	{ // Draw the result for the next filter to use.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Render"};
@@ -322,7 +495,7 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 			_standard_effect->get_parameter("InputA").set_texture(_output);
 		}
 		if (_standard_effect->has_parameter("InputB", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
-			_standard_effect->get_parameter("InputB").set_texture(_input->get_texture());
+			_standard_effect->get_parameter("InputB").set_texture(_input_alpha);
 		}
 		while (gs_effect_loop(_standard_effect->get_object(), "RestoreAlpha")) {
 			gs_draw_sprite(nullptr, 0, _out_size.first, _out_size.second);
@@ -368,7 +541,7 @@ void streamfx::filter::upscaling::upscaling_instance::switch_provider(upscaling_
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&upscaling_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->push(std::bind(&upscaling_instance::task_switch_provider, this, std::placeholders::_1), spd, util::threadpool::priority::BACKGROUND);
 }
 
 void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util::threadpool::task_data_t data)
@@ -389,6 +562,9 @@ void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util:
 			nvvfxsr_unload();
 			break;
 #endif
+		case upscaling_provider::EDGE_ADAPTIVE:
+			easu_unload();
+			break;
 		default:
 			break;
 		}
@@ -405,6 +581,14 @@ void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util:
 			}
 			break;
 #endif
+		case upscaling_provider::EDGE_ADAPTIVE:
+			easu_load();
+			{
+				auto data = obs_source_get_settings(_self);
+				easu_update(data);
+				obs_data_release(data);
+			}
+			break;
 		default:
 			break;
 		}
@@ -420,6 +604,70 @@ void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util:
 	}
 }
 
+void streamfx::filter::upscaling::upscaling_instance::render_variants()
+{
+	// Only as many mip levels are built as the smallest variant needs, which is usually only one or two.
+	float smallest = 1.f;
+	for (auto const& variant : _variants) {
+		if (std::atomic_load(&variant.published)) {
+			smallest = std::min(smallest, variant.scale);
+		}
+	}
+	if (smallest >= 1.f) {
+		return;
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Variants"};
+#endif
+
+	uint32_t levels = 2 + static_cast<uint32_t>(std::ceil(std::log2(1.f / smallest)));
+	auto     mipped = _mip_chain->get(_self, _output, levels);
+	if (!mipped) {
+		return;
+	}
+
+	for (auto const& data : _variants) {
+		auto published = std::atomic_load(&data.published);
+		if (!published) {
+			continue;
+		}
+
+		uint32_t width  = std::max<uint32_t>(static_cast<uint32_t>(std::lround(_out_size.first * data.scale)), 1);
+		uint32_t height = std::max<uint32_t>(static_cast<uint32_t>(std::lround(_out_size.second * data.scale)), 1);
+		if (!published->rt) {
+			published->rt = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+		}
+
+		{ // Trilinear filtering from the mip chain, which never skips over source pixels no matter the scale.
+			auto op = published->rt->render(width, height);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+
+			gs_blend_state_push();
+			gs_enable_color(true, true, true, true);
+			gs_enable_blending(false);
+			gs_enable_depth_test(false);
+			gs_enable_stencil_test(false);
+			gs_set_cull_mode(GS_NEITHER);
+
+			if (_standard_effect->has_parameter("InputA", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+				_standard_effect->get_parameter("InputA").set_texture(mipped);
+			}
+			if (_standard_effect->has_parameter("InputB", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+				_standard_effect->get_parameter("InputB").set_texture(_input_alpha);
+			}
+			while (gs_effect_loop(_standard_effect->get_object(), "RestoreAlpha")) {
+				gs_draw_sprite(nullptr, 0, 1, 1);
+			}
+
+			gs_blend_state_pop();
+		}
+		published->texture = published->rt->get_texture();
+		published->width   = width;
+		published->height  = height;
+	}
+}
+
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_load()
 {
@@ -444,11 +692,11 @@ void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_size()
 void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_process()
 {
 	if (!_nvidia_fx) {
-		_output = _input->get_texture();
+		_output = _input_color;
 		return;
 	}
 
-	_output = _nvidia_fx->process(_input->get_texture());
+	_output = _nvidia_fx->process(_input_color);
 }
 
 void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_properties(obs_properties_t* props)
@@ -466,6 +714,16 @@ void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_properties(obs_pro
 		auto p = obs_properties_add_float_slider(grp, ST_KEY_NVIDIA_SUPERRES_SCALE, D_TRANSLATE(ST_I18N_NVIDIA_SUPERRES_SCALE), 100.00, 400.00, .01);
 		obs_property_float_set_suffix(p, " %");
 	}
+
+	{
+		obs_properties_add_bool(grp, ST_KEY_NVIDIA_SUPERRES_PIPELINED, D_TRANSLATE(ST_I18N_NVIDIA_SUPERRES_PIPELINED));
+	}
+
+	{
+		auto p = obs_properties_add_list(grp, ST_KEY_NVIDIA_SUPERRES_PRECISION, D_TRANSLATE(ST_I18N_NVIDIA_SUPERRES_PRECISION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_SUPERRES_PRECISION_FULL), 0);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_SUPERRES_PRECISION_HALF), 1);
+	}
 }
 
 void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_update(obs_data_t* data)
@@ -475,10 +733,113 @@ void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_update(obs_data_t*
 
 	_nvidia_fx->set_strength(static_cast<float>(obs_data_get_int(data, ST_KEY_NVIDIA_SUPERRES_STRENGTH) == 0 ? 0. : 1.));
 	_nvidia_fx->set_scale(static_cast<float>(obs_data_get_double(data, ST_KEY_NVIDIA_SUPERRES_SCALE) / 100.));
+	_nvidia_fx->set_pipelined(obs_data_get_bool(data, ST_KEY_NVIDIA_SUPERRES_PIPELINED));
+	_nvidia_fx->set_half_precision(obs_data_get_int(data, ST_KEY_NVIDIA_SUPERRES_PRECISION) == 1);
 }
 
 #endif
 
+void streamfx::filter::upscaling::upscaling_instance::easu_load()
+{
+	::streamfx::obs::gs::context gctx;
+
+	_easu_effect    = ::streamfx::obs::gs::effect_registry::instance()->get(::streamfx::data_file_path("effects/upscaling.effect"));
+	_easu_util      = ::streamfx::gfx::util::get();
+	_easu_upscaled  = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	_easu_sharpened = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+}
+
+void streamfx::filter::upscaling::upscaling_instance::easu_unload()
+{
+	::streamfx::obs::gs::context gctx;
+
+	_easu_sharpened.reset();
+	_easu_upscaled.reset();
+	_easu_util.reset();
+	_easu_effect.reset();
+}
+
+void streamfx::filter::upscaling::upscaling_instance::easu_size()
+{
+	// Same limit as the largest texture libOBS can create.
+	_out_size.first  = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(_in_size.first * _easu_scale)), 1, 16384);
+	_out_size.second = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(_in_size.second * _easu_scale)), 1, 16384);
+}
+
+void streamfx::filter::upscaling::upscaling_instance::easu_process()
+{
+	if (!_easu_effect) {
+		_output = _input_color;
+		return;
+	}
+
+	auto input = _input_color;
+
+	::streamfx::obs::gs::state::push();
+	::streamfx::obs::gs::state::apply_opaque();
+
+	{ // Upscale along the edges of the input.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Upscale"};
+#endif
+		float width  = static_cast<float>(input->get_width());
+		float height = static_cast<float>(input->get_height());
+
+		_easu_effect.get_parameter("InputA").set_texture(input);
+		_easu_effect.get_parameter("InputSize").set_float4(width, height, 1.f / width, 1.f / height);
+
+		auto op = _easu_upscaled->render(_out_size.first, _out_size.second);
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+		while (gs_effect_loop(_easu_effect.get_object(), "EdgeAdaptive")) {
+			_easu_util->draw_fullscreen_triangle();
+		}
+	}
+	_output = _easu_upscaled->get_texture();
+
+	if (_easu_sharpness > 0) { // Restore the detail that upscaling softened.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Sharpen"};
+#endif
+		float width  = static_cast<float>(_out_size.first);
+		float height = static_cast<float>(_out_size.second);
+
+		_easu_effect.get_parameter("InputA").set_texture(_output);
+		_easu_effect.get_parameter("InputSize").set_float4(width, height, 1.f / width, 1.f / height);
+		_easu_effect.get_parameter("Sharpness").set_float(_easu_sharpness);
+
+		auto op = _easu_sharpened->render(_out_size.first, _out_size.second);
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+		while (gs_effect_loop(_easu_effect.get_object(), "Sharpen")) {
+			_easu_util->draw_fullscreen_triangle();
+		}
+		_output = _easu_sharpened->get_texture();
+	}
+
+	::streamfx::obs::gs::state::pop();
+}
+
+void streamfx::filter::upscaling::upscaling_instance::easu_properties(obs_properties_t* props)
+{
+	obs_properties_t* grp = obs_properties_create();
+	obs_properties_add_group(props, ST_KEY_EDGEADAPTIVE, D_TRANSLATE(ST_I18N_EDGEADAPTIVE), OBS_GROUP_NORMAL, grp);
+
+	{
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_EDGEADAPTIVE_SCALE, D_TRANSLATE(ST_I18N_EDGEADAPTIVE_SCALE), 100.00, 400.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+
+	{
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_EDGEADAPTIVE_SHARPNESS, D_TRANSLATE(ST_I18N_EDGEADAPTIVE_SHARPNESS), 0.00, 100.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+}
+
+void streamfx::filter::upscaling::upscaling_instance::easu_update(obs_data_t* data)
+{
+	_easu_scale     = static_cast<float>(obs_data_get_double(data, ST_KEY_EDGEADAPTIVE_SCALE) / 100.);
+	_easu_sharpness = static_cast<float>(obs_data_get_double(data, ST_KEY_EDGEADAPTIVE_SHARPNESS) / 100.);
+}
+
 //------------------------------------------------------------------------------
 // Factory
 //------------------------------------------------------------------------------
@@ -486,39 +847,14 @@ upscaling_factory::~upscaling_factory() {}
 
 upscaling_factory::upscaling_factory()
 {
-	bool any_available = false;
-
-	// 1. Try and load any configured providers.
+	// 1. Check which providers were available last time. Loading them takes a while, so it waits until they are needed.
+	//    The edge adaptive provider works on any GPU, so unlike other filters this one is never hidden.
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Super-Resolution available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Super-Resolution available.", nullptr);
-	}
+	_nvidia_loaded    = false;
+	_nvidia_available = streamfx::configuration::instance()->get_availability("Filter.Upscaling.NVIDIA").value_or(true);
 #endif
 
-	// 2. Check if any of them managed to load at all.
-	if (!any_available) {
-		D_LOG_ERROR("All supported Super-Resolution providers failed to initialize, disabling effect.", 0);
-		return;
-	}
-
-	// 3. In any other case, register the filter!
+	// 2. Register the filter.
 	_info.id           = S_PREFIX "filter-upscaling";
 	_info.type         = OBS_SOURCE_TYPE_FILTER;
 	_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW /*| OBS_SOURCE_SRGB*/;
@@ -538,10 +874,24 @@ const char* upscaling_factory::get_name()
 void upscaling_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_int(data, ST_KEY_PROVIDER, static_cast<int64_t>(upscaling_provider::AUTOMATIC));
+	obs_data_set_default_int(data, ST_KEY_ROI_LEFT, 0);
+	obs_data_set_default_int(data, ST_KEY_ROI_TOP, 0);
+	obs_data_set_default_int(data, ST_KEY_ROI_RIGHT, 0);
+	obs_data_set_default_int(data, ST_KEY_ROI_BOTTOM, 0);
+
+	obs_data_set_default_double(data, ST_KEY_EDGEADAPTIVE_SCALE, 150.);
+	obs_data_set_default_double(data, ST_KEY_EDGEADAPTIVE_SHARPNESS, 80.);
+
+	for (auto const& keys : variant_keys) {
+		obs_data_set_default_int(data, keys.scale, 0);
+		obs_data_set_default_string(data, keys.name, "");
+	}
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 	obs_data_set_default_double(data, ST_KEY_NVIDIA_SUPERRES_SCALE, 150.);
 	obs_data_set_default_double(data, ST_KEY_NVIDIA_SUPERRES_STRENGTH, 0.);
+	obs_data_set_default_bool(data, ST_KEY_NVIDIA_SUPERRES_PIPELINED, false);
+	obs_data_set_default_int(data, ST_KEY_NVIDIA_SUPERRES_PRECISION, (streamfx::gfx::resolve_quality_tier() == streamfx::gfx::quality_tier::Low) ? 1 : 0);
 #endif
 }
 
@@ -581,6 +931,7 @@ obs_properties_t* upscaling_factory::get_properties2(upscaling_instance* data)
 			obs_property_set_modified_callback(p, modified_provider);
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(upscaling_provider::AUTOMATIC));
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_SUPERRES), static_cast<int64_t>(upscaling_provider::NVIDIA_SUPERRESOLUTION));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_EDGEADAPTIVE), static_cast<int64_t>(upscaling_provider::EDGE_ADAPTIVE));
 		}
 	}
 
@@ -608,13 +959,50 @@ bool streamfx::filter::upscaling::upscaling_factory::is_provider_available(upsca
 	switch (provider) {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 	case upscaling_provider::NVIDIA_SUPERRESOLUTION:
-		return _nvidia_available;
+		return load_nvidia();
 #endif
+	case upscaling_provider::EDGE_ADAPTIVE:
+		return true;
 	default:
 		return false;
 	}
 }
 
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+bool streamfx::filter::upscaling::upscaling_factory::load_nvidia()
+{
+	std::unique_lock<std::mutex> lock(_nvidia_lock);
+	if (_nvidia_loaded) {
+		return _nvidia_available;
+	}
+	_nvidia_loaded = true;
+
+	try {
+		// Load CVImage and Video Effects SDK.
+		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
+		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
+		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
+		_nvidia_available = true;
+	} catch (const std::exception& ex) {
+		_nvidia_available = false;
+		_nvvfx.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA Super-Resolution available due to error: %s", ex.what());
+	} catch (...) {
+		_nvidia_available = false;
+		_nvvfx.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA Super-Resolution available.", nullptr);
+	}
+
+	// Remember the result, so that the next session knows whether to show the filter at all.
+	streamfx::configuration::instance()->set_availability("Filter.Upscaling.NVIDIA", _nvidia_available);
+	return _nvidia_available;
+}
+#endif
+
 upscaling_provider streamfx::filter::upscaling::upscaling_factory::find_ideal_provider()
 {
 	for (auto v : provider_priority) {
@@ -626,6 +1014,46 @@ upscaling_provider streamfx::filter::upscaling::upscaling_factory::find_ideal_pr
 	return upscaling_provider::AUTOMATIC;
 }
 
+std::shared_ptr<variant> streamfx::filter::upscaling::upscaling_factory::publish(std::string_view name)
+{
+	std::lock_guard<std::mutex> lock(_variants_lock);
+
+	std::string key{name};
+	if (auto iter = _variants.find(key); (iter != _variants.end()) && !iter->second.expired()) {
+		return nullptr;
+	}
+
+	auto result    = std::make_shared<variant>();
+	_variants[key] = result;
+	return result;
+}
+
+std::shared_ptr<variant> streamfx::filter::upscaling::upscaling_factory::find(std::string_view name)
+{
+	std::lock_guard<std::mutex> lock(_variants_lock);
+
+	if (auto iter = _variants.find(std::string{name}); iter != _variants.end()) {
+		return iter->second.lock();
+	}
+	return nullptr;
+}
+
+std::vector<std::string> streamfx::filter::upscaling::upscaling_factory::variants()
+{
+	std::lock_guard<std::mutex> lock(_variants_lock);
+
+	std::vector<std::string> result;
+	for (auto iter = _variants.begin(); iter != _variants.end();) {
+		if (iter->second.expired()) {
+			iter = _variants.erase(iter);
+		} else {
+			result.push_back(iter->first);
+			++iter;
+		}
+	}
+	return result;
+}
+
 std::shared_ptr<upscaling_factory> upscaling_factory::instance()
 {
 	static std::weak_ptr<upscaling_factory> winst;
@@ -640,13 +1068,128 @@ std::shared_ptr<upscaling_factory> upscaling_factory::instance()
 	return instance;
 }
 
-static std::shared_ptr<upscaling_factory> loader_instance;
+//------------------------------------------------------------------------------
+// Output Source
+//------------------------------------------------------------------------------
+upscaling_output_instance::upscaling_output_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _lock(), _name(), _variant()
+{
+	update(data);
+}
+
+upscaling_output_instance::~upscaling_output_instance() {}
+
+uint32_t upscaling_output_instance::get_width()
+{
+	auto variant = _variant.lock();
+	return variant ? variant->width : 0;
+}
+
+uint32_t upscaling_output_instance::get_height()
+{
+	auto variant = _variant.lock();
+	return variant ? variant->height : 0;
+}
+
+void upscaling_output_instance::load(obs_data_t* data)
+{
+	update(data);
+}
+
+void upscaling_output_instance::update(obs_data_t* data)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_name = obs_data_get_string(data, ST_KEY_OUTPUTSOURCE_NAME);
+	_variant.reset();
+}
+
+void upscaling_output_instance::video_tick(float_t time)
+{
+	// Filters may be created after this source, or give up their variant again, so keep looking while there is none.
+	std::lock_guard<std::mutex> lock(_lock);
+	if (_variant.expired() && !_name.empty()) {
+		_variant = upscaling_factory::instance()->find(_name);
+	}
+}
+
+void upscaling_output_instance::video_render(gs_effect_t* effect)
+{
+	// Shows whatever the filter rendered last, the filter itself only upscales while its source is being rendered.
+	auto variant = _variant.lock();
+	if (!variant || !variant->texture || !variant->texture->get_object()) {
+		return;
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	::streamfx::obs::gs::debug_marker profiler0{::streamfx::obs::gs::debug_color_source, "Upscaling Output '%s'", obs_source_get_name(_self)};
+#endif
+
+	effect = effect ? effect : obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	if (gs_eparam_t* param = gs_effect_get_param_by_name(effect, "image"); param) {
+		gs_effect_set_texture(param, variant->texture->get_object());
+		while (gs_effect_loop(effect, "Draw")) {
+			gs_draw_sprite(nullptr, 0, variant->width, variant->height);
+		}
+	}
+}
+
+upscaling_output_factory::upscaling_output_factory()
+{
+	_info.id           = S_PREFIX "source-upscaling-output";
+	_info.type         = OBS_SOURCE_TYPE_INPUT;
+	_info.output_flags = OBS_SOURCE_VIDEO;
+
+	finish_setup();
+}
+
+upscaling_output_factory::~upscaling_output_factory() {}
+
+const char* upscaling_output_factory::get_name()
+{
+	return D_TRANSLATE(ST_I18N_OUTPUTSOURCE);
+}
+
+void upscaling_output_factory::get_defaults2(obs_data_t* data)
+{
+	obs_data_set_default_string(data, ST_KEY_OUTPUTSOURCE_NAME, "");
+}
+
+obs_properties_t* upscaling_output_factory::get_properties2(upscaling_output_instance* data)
+{
+	obs_properties_t* pr = obs_properties_create();
+
+	// Editable, so that variants of filters which don't exist yet can be picked too.
+	auto p = obs_properties_add_list(pr, ST_KEY_OUTPUTSOURCE_NAME, D_TRANSLATE(ST_I18N_OUTPUTSOURCE_NAME), OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+	for (auto const& name : upscaling_factory::instance()->variants()) {
+		obs_property_list_add_string(p, name.c_str(), name.c_str());
+	}
+
+	return pr;
+}
+
+std::shared_ptr<upscaling_output_factory> upscaling_output_factory::instance()
+{
+	static std::weak_ptr<upscaling_output_factory> winst;
+	static std::mutex                              mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<upscaling_output_factory>(new upscaling_output_factory());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<upscaling_factory>        loader_instance;
+static std::shared_ptr<upscaling_output_factory> loader_output_instance;
 
 static auto loader = streamfx::loader(
 	[]() { // Initalizer
-		loader_instance = upscaling_factory::instance();
+		loader_instance        = upscaling_factory::instance();
+		loader_output_instance = upscaling_output_factory::instance();
 	},
 	[]() { // Finalizer
+		loader_output_instance.reset();
 		loader_instance.reset();
 	},
 	streamfx::loader_priority::NORMAL);
@@ -3,6 +3,8 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-mip-chain.hpp"
+#include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
@@ -11,9 +13,14 @@
 #include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
 #include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "warning-enable.hpp"
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
@@ -25,15 +32,31 @@ namespace streamfx::filter::upscaling {
 		INVALID                = -1,
 		AUTOMATIC              = 0,
 		NVIDIA_SUPERRESOLUTION = 1,
+		EDGE_ADAPTIVE          = 2,
 	};
 
 	const char* cstring(upscaling_provider provider);
 
 	std::string string(upscaling_provider provider);
 
+	// Smaller copies of the result, so that a single upscaling pass can feed outputs of several sizes.
+	constexpr std::size_t max_variants = 3;
+
+	/** Downscaled copy of the result of an upscaling filter, as drawn by any number of output sources.
+	 *
+	 * Only touched while in the graphics context.
+	 */
+	struct variant {
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> rt;
+		std::shared_ptr<::streamfx::obs::gs::texture>      texture;
+		uint32_t                                           width  = 0;
+		uint32_t                                           height = 0;
+	};
+
 	class upscaling_instance : public ::streamfx::obs::source_instance {
 		std::pair<uint32_t, uint32_t> _in_size;
 		std::pair<uint32_t, uint32_t> _out_size;
+		std::array<uint32_t, 4>       _roi; // Left, Top, Right, Bottom
 
 		std::atomic<upscaling_provider>         _provider;
 		upscaling_provider                      _provider_ui;
@@ -46,6 +69,8 @@ namespace streamfx::filter::upscaling {
 		std::shared_ptr<::streamfx::obs::gs::sampler> _channel1_sampler;
 
 		std::shared_ptr<::streamfx::obs::gs::rendertarget> _input;
+		std::shared_ptr<::streamfx::obs::gs::texture>      _input_color; // Captured into _input, or handed over from below.
+		std::shared_ptr<::streamfx::obs::gs::texture>      _input_alpha;
 		std::shared_ptr<::streamfx::obs::gs::texture>      _output;
 		bool                                               _dirty;
 
@@ -53,6 +78,21 @@ namespace streamfx::filter::upscaling {
 		std::shared_ptr<::streamfx::nvidia::vfx::superresolution> _nvidia_fx;
 #endif
 
+		::streamfx::obs::gs::effect                        _easu_effect;
+		std::shared_ptr<::streamfx::gfx::util>             _easu_util;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _easu_upscaled;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _easu_sharpened;
+		float                                              _easu_scale;
+		float                                              _easu_sharpness;
+
+		struct variant_data {
+			float                    scale = 0; // Disabled if zero.
+			std::string              name;
+			std::shared_ptr<variant> published;
+		};
+		std::shared_ptr<::streamfx::gfx::mip_chain> _mip_chain;
+		std::array<variant_data, max_variants>      _variants;
+
 		public:
 		upscaling_instance(obs_data_t* data, obs_source_t* self);
 		~upscaling_instance() override;
@@ -72,6 +112,8 @@ namespace streamfx::filter::upscaling {
 		void switch_provider(upscaling_provider provider);
 		void task_switch_provider(util::threadpool::task_data_t data);
 
+		void render_variants();
+
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 		void nvvfxsr_load();
 		void nvvfxsr_unload();
@@ -80,16 +122,28 @@ namespace streamfx::filter::upscaling {
 		void nvvfxsr_properties(obs_properties_t* props);
 		void nvvfxsr_update(obs_data_t* data);
 #endif
+
+		void easu_load();
+		void easu_unload();
+		void easu_size();
+		void easu_process();
+		void easu_properties(obs_properties_t* props);
+		void easu_update(obs_data_t* data);
 	};
 
 	class upscaling_factory : public ::streamfx::obs::source_factory<::streamfx::filter::upscaling::upscaling_factory, ::streamfx::filter::upscaling::upscaling_instance> {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+		std::mutex                                     _nvidia_lock;
+		bool                                           _nvidia_loaded;
 		bool                                           _nvidia_available;
 		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
 		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
 		std::shared_ptr<::streamfx::nvidia::vfx::vfx>  _nvvfx;
 #endif
 
+		std::mutex                                    _variants_lock;
+		std::map<std::string, std::weak_ptr<variant>> _variants;
+
 		public:
 		virtual ~upscaling_factory();
 		upscaling_factory();
@@ -106,10 +160,56 @@ namespace streamfx::filter::upscaling {
 		bool               is_provider_available(upscaling_provider);
 		upscaling_provider find_ideal_provider();
 
+		/** Claim a variant name, which fails if another upscaling filter already uses it. */
+		std::shared_ptr<variant> publish(std::string_view name);
+
+		std::shared_ptr<variant> find(std::string_view name);
+
+		std::vector<std::string> variants();
+
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+		private:
+		bool load_nvidia();
+#endif
+
 		public: // Singleton
 		static void                                                              initialize();
 		static void                                                              finalize();
 		static std::shared_ptr<::streamfx::filter::upscaling::upscaling_factory> instance();
 	};
 
+	/** Draws one of the variants of an upscaling filter, without rendering anything itself. */
+	class upscaling_output_instance : public ::streamfx::obs::source_instance {
+		std::mutex             _lock;
+		std::string            _name;
+		std::weak_ptr<variant> _variant;
+
+		public:
+		upscaling_output_instance(obs_data_t* data, obs_source_t* self);
+		~upscaling_output_instance() override;
+
+		uint32_t get_width() override;
+		uint32_t get_height() override;
+
+		void load(obs_data_t* data) override;
+		void update(obs_data_t* data) override;
+
+		void video_tick(float_t time) override;
+		void video_render(gs_effect_t* effect) override;
+	};
+
+	class upscaling_output_factory : public ::streamfx::obs::source_factory<::streamfx::filter::upscaling::upscaling_output_factory, ::streamfx::filter::upscaling::upscaling_output_instance> {
+		public:
+		upscaling_output_factory();
+		~upscaling_output_factory() override;
+
+		const char* get_name() override;
+
+		void              get_defaults2(obs_data_t* data) override;
+		obs_properties_t* get_properties2(upscaling_output_instance* data) override;
+
+		public: // Singleton
+		static std::shared_ptr<::streamfx::filter::upscaling::upscaling_output_factory> instance();
+	};
+
 } // namespace streamfx::filter::upscaling
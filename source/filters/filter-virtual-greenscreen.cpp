@@ -3,12 +3,15 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "filter-virtual-greenscreen.hpp"
+#include "configuration.hpp"
+#include "gfx/gfx-quality.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <cmath>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -29,6 +32,24 @@
 #define ST_KEY_PROVIDER "Provider"
 #define ST_I18N_PROVIDER ST_I18N "." ST_KEY_PROVIDER
 #define ST_I18N_PROVIDER_NVIDIA_GREENSCREEN ST_I18N_PROVIDER ".NVIDIA.Greenscreen"
+#define ST_I18N_PROVIDER_KEYER ST_I18N_PROVIDER ".Keyer"
+
+#define ST_KEY_KEYER "Keyer"
+#define ST_I18N_KEYER ST_I18N "." ST_KEY_KEYER
+#define ST_KEY_KEYER_MODE ST_KEY_KEYER ".Mode"
+#define ST_I18N_KEYER_MODE ST_I18N_KEYER ".Mode"
+#define ST_I18N_KEYER_MODE_CHROMA ST_I18N_KEYER_MODE ".Chroma"
+#define ST_I18N_KEYER_MODE_LUMA ST_I18N_KEYER_MODE ".Luma"
+#define ST_KEY_KEYER_COLOR ST_KEY_KEYER ".Color"
+#define ST_I18N_KEYER_COLOR ST_I18N_KEYER ".Color"
+#define ST_KEY_KEYER_SIMILARITY ST_KEY_KEYER ".Similarity"
+#define ST_I18N_KEYER_SIMILARITY ST_I18N_KEYER ".Similarity"
+#define ST_KEY_KEYER_SMOOTHNESS ST_KEY_KEYER ".Smoothness"
+#define ST_I18N_KEYER_SMOOTHNESS ST_I18N_KEYER ".Smoothness"
+#define ST_KEY_KEYER_SPILL ST_KEY_KEYER ".Spill"
+#define ST_I18N_KEYER_SPILL ST_I18N_KEYER ".Spill"
+#define ST_KEY_KEYER_REFINE ST_KEY_KEYER ".Refine"
+#define ST_I18N_KEYER_REFINE ST_I18N_KEYER ".Refine"
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 #define ST_KEY_NVIDIA_GREENSCREEN "NVIDIA.Greenscreen"
@@ -37,6 +58,12 @@
 #define ST_I18N_NVIDIA_GREENSCREEN_MODE ST_I18N_NVIDIA_GREENSCREEN ".Mode"
 #define ST_I18N_NVIDIA_GREENSCREEN_MODE_PERFORMANCE ST_I18N_NVIDIA_GREENSCREEN_MODE ".Performance"
 #define ST_I18N_NVIDIA_GREENSCREEN_MODE_QUALITY ST_I18N_NVIDIA_GREENSCREEN_MODE ".Quality"
+#define ST_KEY_NVIDIA_GREENSCREEN_PIPELINED ST_KEY_NVIDIA_GREENSCREEN ".Pipelined"
+#define ST_I18N_NVIDIA_GREENSCREEN_PIPELINED ST_I18N_NVIDIA_GREENSCREEN ".Pipelined"
+#define ST_KEY_NVIDIA_GREENSCREEN_INTERVAL ST_KEY_NVIDIA_GREENSCREEN ".Interval"
+#define ST_I18N_NVIDIA_GREENSCREEN_INTERVAL ST_I18N_NVIDIA_GREENSCREEN ".Interval"
+#define ST_KEY_NVIDIA_GREENSCREEN_SCALE ST_KEY_NVIDIA_GREENSCREEN ".Scale"
+#define ST_I18N_NVIDIA_GREENSCREEN_SCALE ST_I18N_NVIDIA_GREENSCREEN ".Scale"
 #endif
 
 using streamfx::filter::virtual_greenscreen::virtual_greenscreen_factory;
@@ -50,6 +77,7 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
  */
 static virtual_greenscreen_provider provider_priority[] = {
 	virtual_greenscreen_provider::NVIDIA_GREENSCREEN,
+	virtual_greenscreen_provider::KEYER,
 };
 
 const char* streamfx::filter::virtual_greenscreen::cstring(virtual_greenscreen_provider provider)
@@ -61,6 +89,8 @@ const char* streamfx::filter::virtual_greenscreen::cstring(virtual_greenscreen_p
 		return D_TRANSLATE(S_STATE_AUTOMATIC);
 	case virtual_greenscreen_provider::NVIDIA_GREENSCREEN:
 		return D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_GREENSCREEN);
+	case virtual_greenscreen_provider::KEYER:
+		return D_TRANSLATE(ST_I18N_PROVIDER_KEYER);
 	default:
 		throw std::runtime_error("Missing Conversion Entry");
 	}
@@ -77,7 +107,7 @@ std::string streamfx::filter::virtual_greenscreen::string(virtual_greenscreen_pr
 virtual_greenscreen_instance::virtual_greenscreen_instance(obs_data_t* data, obs_source_t* self)
 	: obs::source_instance(data, self),
 
-	  _size(1, 1), _provider(virtual_greenscreen_provider::INVALID), _provider_ui(virtual_greenscreen_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _effect(), _channel0_sampler(), _channel1_sampler(), _input(), _output_color(), _output_alpha(), _dirty(true)
+	  _size(1, 1), _provider(virtual_greenscreen_provider::INVALID), _provider_ui(virtual_greenscreen_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _effect(), _channel0_sampler(), _channel1_sampler(), _input(), _output_color(), _output_alpha(), _dirty(true), _keyer_util(), _keyer_key(), _keyer_guide(), _keyer_refined(), _keyer_luma(false), _keyer_color(), _keyer_similarity(.4f), _keyer_smoothness(.08f), _keyer_spill(.1f), _keyer_refine(true)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -137,6 +167,9 @@ virtual_greenscreen_instance::~virtual_greenscreen_instance()
 			nvvfxgs_unload();
 			break;
 #endif
+		case virtual_greenscreen_provider::KEYER:
+			keyer_unload();
+			break;
 		default:
 			break;
 		}
@@ -173,6 +206,9 @@ void virtual_greenscreen_instance::update(obs_data_t* data)
 			nvvfxgs_update(data);
 			break;
 #endif
+		case virtual_greenscreen_provider::KEYER:
+			keyer_update(data);
+			break;
 		default:
 			break;
 		}
@@ -187,6 +223,9 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::proper
 		nvvfxgs_properties(properties);
 		break;
 #endif
+	case virtual_greenscreen_provider::KEYER:
+		keyer_properties(properties);
+		break;
 	default:
 		break;
 	}
@@ -244,7 +283,7 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 	// - We don't have a target.
 	// - The width/height of the next filter in the chain is empty.
 	if (!_provider_ready || !target || (width == 0) || (height == 0)) {
-		obs_source_skip_video_filter(_self);
+		skip_video_filter();
 		return;
 	}
 
@@ -289,7 +328,7 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 				gs_blend_state_pop();
 				gs_matrix_pop();
 			} else {
-				obs_source_skip_video_filter(_self);
+				skip_video_filter();
 				return;
 			}
 
@@ -307,11 +346,14 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 				nvvfxgs_process(_output_color, _output_alpha);
 				break;
 #endif
+			case virtual_greenscreen_provider::KEYER:
+				keyer_process(_output_color, _output_alpha);
+				break;
 			default:
 				break;
 			}
 		} catch (...) {
-			obs_source_skip_video_filter(_self);
+			skip_video_filter();
 			return;
 		}
 
@@ -334,7 +376,10 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 		if (_effect->has_parameter("ThresholdRange", ::streamfx::obs::gs::effect_parameter::type::Float)) {
 			_effect->get_parameter("ThresholdRange").set_float(.333333);
 		}
-		while (gs_effect_loop(_effect->get_object(), "DrawAlphaThreshold")) {
+
+		// A key is already a soft matte, thresholding it again would only harden the edges.
+		const char* technique = (_provider == virtual_greenscreen_provider::KEYER) ? "DrawAlpha" : "DrawAlphaThreshold";
+		while (gs_effect_loop(_effect->get_object(), technique)) {
 			gs_draw_sprite(nullptr, 0, _size.first, _size.second);
 		}
 	}
@@ -378,7 +423,7 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::switch
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&virtual_greenscreen_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->push(std::bind(&virtual_greenscreen_instance::task_switch_provider, this, std::placeholders::_1), spd, util::threadpool::priority::BACKGROUND);
 }
 
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::task_switch_provider(util::threadpool::task_data_t data)
@@ -399,6 +444,9 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::task_s
 			nvvfxgs_unload();
 			break;
 #endif
+		case virtual_greenscreen_provider::KEYER:
+			keyer_unload();
+			break;
 		default:
 			break;
 		}
@@ -415,6 +463,14 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::task_s
 			}
 			break;
 #endif
+		case virtual_greenscreen_provider::KEYER:
+			keyer_load();
+			{
+				auto data = obs_source_get_settings(_self);
+				keyer_update(data);
+				obs_data_release(data);
+			}
+			break;
 		default:
 			break;
 		}
@@ -434,10 +490,27 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::task_s
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_load()
 {
 	_nvidia_fx = std::make_shared<::streamfx::nvidia::vfx::greenscreen>();
+
+	::streamfx::obs::gs::context gctx;
+
+	_nvidia_util     = ::streamfx::gfx::util::get();
+	_nvidia_scaled   = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	_nvidia_guide    = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA16F, GS_ZS_NONE); // Coefficients are signed.
+	_nvidia_refined  = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	_nvidia_scale    = 1.f;
+	_nvidia_interval = 1;
+	_nvidia_governor = ::streamfx::gfx::governor::instance();
 }
 
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_unload()
 {
+	::streamfx::obs::gs::context gctx;
+
+	_nvidia_governor.reset();
+	_nvidia_refined.reset();
+	_nvidia_guide.reset();
+	_nvidia_scaled.reset();
+	_nvidia_util.reset();
 	_nvidia_fx.reset();
 }
 
@@ -448,6 +521,9 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxg
 	}
 
 	_nvidia_fx->size(_size);
+
+	// Under load, the mask is only updated every few frames, in the same way as the interval option does.
+	_nvidia_fx->set_interval(_nvidia_interval * (1 + _nvidia_governor->level()));
 }
 
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_process(std::shared_ptr<::streamfx::obs::gs::texture>& color, std::shared_ptr<::streamfx::obs::gs::texture>& alpha)
@@ -456,8 +532,86 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxg
 		return;
 	}
 
-	alpha = _nvidia_fx->process(_input->get_texture());
-	color = _nvidia_fx->get_color();
+	// The effect has a minimum size of its own, which it may adjust the scaled size to.
+	std::pair<uint32_t, uint32_t> scaled = {static_cast<uint32_t>(std::lround(static_cast<double>(_size.first) * _nvidia_scale)), static_cast<uint32_t>(std::lround(static_cast<double>(_size.second) * _nvidia_scale))};
+	_nvidia_fx->size(scaled);
+
+	// Segment the frame as is, unless asked to and able to do it at a lower resolution.
+	if ((_nvidia_scale >= 1.f) || !_effect || !_nvidia_scaled || ((scaled.first >= _size.first) && (scaled.second >= _size.second))) {
+		// While the model is still loading, the input is passed through unchanged.
+		auto input = _input->get_texture();
+		alpha      = _nvidia_fx->process(input);
+		color      = (alpha == input) ? input : _nvidia_fx->get_color();
+		return;
+	}
+
+	{ // Scale the frame down for segmentation.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Scale"};
+#endif
+		auto op = _nvidia_scaled->render(scaled.first, scaled.second);
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+
+		gs_blend_state_push();
+		gs_enable_color(true, true, true, true);
+		gs_enable_blending(false);
+		gs_enable_depth_test(false);
+		gs_enable_stencil_test(false);
+		gs_set_cull_mode(GS_NEITHER);
+
+		gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), _input->get_texture()->get_object());
+		while (gs_effect_loop(default_effect, "Draw")) {
+			gs_draw_sprite(nullptr, 0, 1, 1);
+		}
+
+		gs_blend_state_pop();
+	}
+
+	// While the model is still loading, the input is passed through unchanged.
+	auto input = _nvidia_scaled->get_texture();
+	auto mask  = _nvidia_fx->process(input);
+	if (mask == input) {
+		color = _input->get_texture();
+		alpha = color;
+		return;
+	}
+
+	{ // Bring the mask back up to full resolution, with the edges of the full resolution frame.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Upsample"};
+#endif
+		::streamfx::obs::gs::state::push();
+		::streamfx::obs::gs::state::apply_opaque();
+
+		// The mask may lag behind by a few frames, so fit it against the frame it was made from.
+		_effect->get_parameter("InputTexel").set_float2(1.f / static_cast<float>(mask->get_width()), 1.f / static_cast<float>(mask->get_height()));
+		_effect->get_parameter("Epsilon").set_float(1.f / 1024.f);
+		_effect->get_parameter("InputA").set_texture(_nvidia_fx->get_color());
+		_effect->get_parameter("InputB").set_texture(mask);
+		{
+			auto op = _nvidia_guide->render(mask->get_width(), mask->get_height());
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(_effect->get_object(), "JointCoefficients")) {
+				_nvidia_util->draw_fullscreen_triangle();
+			}
+		}
+
+		_effect->get_parameter("InputA").set_texture(_input->get_texture());
+		_effect->get_parameter("InputB").set_texture(_nvidia_guide->get_texture());
+		{
+			auto op = _nvidia_refined->render(_size.first, _size.second);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(_effect->get_object(), "JointApply")) {
+				_nvidia_util->draw_fullscreen_triangle();
+			}
+		}
+
+		::streamfx::obs::gs::state::pop();
+	}
+
+	color = _nvidia_refined->get_texture();
+	alpha = color;
 }
 
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_properties(obs_properties_t* props)
@@ -470,6 +624,26 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxg
 		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_MODE_PERFORMANCE), static_cast<int64_t>(::streamfx::nvidia::vfx::greenscreen_mode::PERFORMANCE));
 		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_MODE_QUALITY), static_cast<int64_t>(::streamfx::nvidia::vfx::greenscreen_mode::QUALITY));
 	}
+
+	{
+		obs_properties_add_bool(grp, ST_KEY_NVIDIA_GREENSCREEN_PIPELINED, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_PIPELINED));
+	}
+
+	{
+		auto p = obs_properties_add_list(grp, ST_KEY_NVIDIA_GREENSCREEN_INTERVAL, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_INTERVAL), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_INTERVAL ".1"), 1);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_INTERVAL ".2"), 2);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_INTERVAL ".3"), 3);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_INTERVAL ".4"), 4);
+	}
+
+	{
+		auto p = obs_properties_add_list(grp, ST_KEY_NVIDIA_GREENSCREEN_SCALE, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_SCALE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_SCALE ".100"), 100);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_SCALE ".75"), 75);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_SCALE ".50"), 50);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_NVIDIA_GREENSCREEN_SCALE ".25"), 25);
+	}
 }
 
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_update(obs_data_t* data)
@@ -478,9 +652,129 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxg
 		return;
 
 	_nvidia_fx->set_mode(static_cast<::streamfx::nvidia::vfx::greenscreen_mode>(obs_data_get_int(data, ST_KEY_NVIDIA_GREENSCREEN_MODE)));
+	_nvidia_fx->set_pipelined(obs_data_get_bool(data, ST_KEY_NVIDIA_GREENSCREEN_PIPELINED));
+	_nvidia_interval = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_NVIDIA_GREENSCREEN_INTERVAL), 1));
+	_nvidia_fx->set_interval(_nvidia_interval);
+	_nvidia_scale = static_cast<float>(std::clamp<int64_t>(obs_data_get_int(data, ST_KEY_NVIDIA_GREENSCREEN_SCALE), 1, 100)) / 100.f;
+}
+
+#endif
+
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::keyer_load()
+{
+	::streamfx::obs::gs::context gctx;
+
+	_keyer_util    = ::streamfx::gfx::util::get();
+	_keyer_key     = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	_keyer_guide   = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA16F, GS_ZS_NONE); // Coefficients are signed.
+	_keyer_refined = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+}
+
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::keyer_unload()
+{
+	::streamfx::obs::gs::context gctx;
+
+	_keyer_refined.reset();
+	_keyer_guide.reset();
+	_keyer_key.reset();
+	_keyer_util.reset();
 }
 
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::keyer_process(std::shared_ptr<::streamfx::obs::gs::texture>& color, std::shared_ptr<::streamfx::obs::gs::texture>& alpha)
+{
+	if (!_effect || !_keyer_key) {
+		return;
+	}
+
+	::streamfx::obs::gs::state::push();
+	::streamfx::obs::gs::state::apply_opaque();
+
+	_effect->get_parameter("InputTexel").set_float2(1.f / static_cast<float>(_size.first), 1.f / static_cast<float>(_size.second));
+
+	{ // Key out the color, with the matte in alpha.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Key"};
 #endif
+		_effect->get_parameter("InputA").set_texture(_input->get_texture());
+		_effect->get_parameter("KeyColor").set_float3(_keyer_color);
+		_effect->get_parameter("KeyRange").set_float2(_keyer_similarity, _keyer_smoothness);
+		_effect->get_parameter("Spill").set_float(_keyer_spill);
+
+		auto op = _keyer_key->render(_size.first, _size.second);
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+		while (gs_effect_loop(_effect->get_object(), _keyer_luma ? "KeyLuma" : "KeyChroma")) {
+			_keyer_util->draw_fullscreen_triangle();
+		}
+	}
+	color = _keyer_key->get_texture();
+
+	if (_keyer_refine) { // Snap the edges of the matte to the edges in the image.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Refine"};
+#endif
+		_effect->get_parameter("InputA").set_texture(color);
+		_effect->get_parameter("Epsilon").set_float(1.f / 1024.f);
+		{
+			auto op = _keyer_guide->render(_size.first, _size.second);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(_effect->get_object(), "GuideCoefficients")) {
+				_keyer_util->draw_fullscreen_triangle();
+			}
+		}
+
+		_effect->get_parameter("InputB").set_texture(_keyer_guide->get_texture());
+		{
+			auto op = _keyer_refined->render(_size.first, _size.second);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(_effect->get_object(), "GuideApply")) {
+				_keyer_util->draw_fullscreen_triangle();
+			}
+		}
+		color = _keyer_refined->get_texture();
+	}
+
+	::streamfx::obs::gs::state::pop();
+
+	alpha = color;
+}
+
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::keyer_properties(obs_properties_t* props)
+{
+	obs_properties_t* grp = obs_properties_create();
+	obs_properties_add_group(props, ST_KEY_KEYER, D_TRANSLATE(ST_I18N_KEYER), OBS_GROUP_NORMAL, grp);
+
+	{
+		auto p = obs_properties_add_list(grp, ST_KEY_KEYER_MODE, D_TRANSLATE(ST_I18N_KEYER_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_KEYER_MODE_CHROMA), 0);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_KEYER_MODE_LUMA), 1);
+	}
+
+	{
+		obs_properties_add_color(grp, ST_KEY_KEYER_COLOR, D_TRANSLATE(ST_I18N_KEYER_COLOR));
+	}
+
+	for (auto [key, name] : {std::pair{ST_KEY_KEYER_SIMILARITY, ST_I18N_KEYER_SIMILARITY}, std::pair{ST_KEY_KEYER_SMOOTHNESS, ST_I18N_KEYER_SMOOTHNESS}, std::pair{ST_KEY_KEYER_SPILL, ST_I18N_KEYER_SPILL}}) {
+		auto p = obs_properties_add_float_slider(grp, key, D_TRANSLATE(name), 0.00, 100.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+
+	{
+		obs_properties_add_bool(grp, ST_KEY_KEYER_REFINE, D_TRANSLATE(ST_I18N_KEYER_REFINE));
+	}
+}
+
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::keyer_update(obs_data_t* data)
+{
+	uint32_t color    = static_cast<uint32_t>(obs_data_get_int(data, ST_KEY_KEYER_COLOR));
+	_keyer_luma       = obs_data_get_int(data, ST_KEY_KEYER_MODE) == 1;
+	_keyer_color.x    = static_cast<float>((color >> 0) & 0xFF) / 255.0f;
+	_keyer_color.y    = static_cast<float>((color >> 8) & 0xFF) / 255.0f;
+	_keyer_color.z    = static_cast<float>((color >> 16) & 0xFF) / 255.0f;
+	_keyer_similarity = static_cast<float>(obs_data_get_double(data, ST_KEY_KEYER_SIMILARITY) / 100.);
+	_keyer_smoothness = static_cast<float>(obs_data_get_double(data, ST_KEY_KEYER_SMOOTHNESS) / 100.);
+	_keyer_spill      = static_cast<float>(obs_data_get_double(data, ST_KEY_KEYER_SPILL) / 100.);
+	_keyer_refine     = obs_data_get_bool(data, ST_KEY_KEYER_REFINE);
+}
 
 //------------------------------------------------------------------------------
 // Factory
@@ -489,39 +783,14 @@ virtual_greenscreen_factory::~virtual_greenscreen_factory() {}
 
 virtual_greenscreen_factory::virtual_greenscreen_factory()
 {
-	bool any_available = false;
-
-	// 1. Try and load any configured providers.
+	// 1. Check which providers were available last time. Loading them takes a while, so it waits until they are needed.
+	//    The keyer works on any GPU, so unlike other filters this one is never hidden.
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Greenscreen available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Greenscreen available.", nullptr);
-	}
+	_nvidia_loaded    = false;
+	_nvidia_available = streamfx::configuration::instance()->get_availability("Filter.VirtualGreenscreen.NVIDIA").value_or(true);
 #endif
 
-	// 2. Check if any of them managed to load at all.
-	if (!any_available) {
-		D_LOG_ERROR("All supported Virtual Greenscreen providers failed to initialize, disabling effect.", 0);
-		return;
-	}
-
-	// 3. In any other case, register the filter!
+	// 2. Register the filter.
 	_info.id           = S_PREFIX "filter-virtual-greenscreen";
 	_info.type         = OBS_SOURCE_TYPE_FILTER;
 	_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW /*| OBS_SOURCE_SRGB*/;
@@ -539,8 +808,18 @@ void virtual_greenscreen_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_int(data, ST_KEY_PROVIDER, static_cast<int64_t>(virtual_greenscreen_provider::AUTOMATIC));
 
+	obs_data_set_default_int(data, ST_KEY_KEYER_MODE, 0);
+	obs_data_set_default_int(data, ST_KEY_KEYER_COLOR, 0xFF00FF00ull);
+	obs_data_set_default_double(data, ST_KEY_KEYER_SIMILARITY, 40.);
+	obs_data_set_default_double(data, ST_KEY_KEYER_SMOOTHNESS, 8.);
+	obs_data_set_default_double(data, ST_KEY_KEYER_SPILL, 10.);
+	obs_data_set_default_bool(data, ST_KEY_KEYER_REFINE, true);
+
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
-	obs_data_set_default_int(data, ST_KEY_NVIDIA_GREENSCREEN_MODE, static_cast<int64_t>(::streamfx::nvidia::vfx::greenscreen_mode::QUALITY));
+	obs_data_set_default_int(data, ST_KEY_NVIDIA_GREENSCREEN_MODE, static_cast<int64_t>((streamfx::gfx::resolve_quality_tier() == streamfx::gfx::quality_tier::Low) ? ::streamfx::nvidia::vfx::greenscreen_mode::PERFORMANCE : ::streamfx::nvidia::vfx::greenscreen_mode::QUALITY));
+	obs_data_set_default_bool(data, ST_KEY_NVIDIA_GREENSCREEN_PIPELINED, false);
+	obs_data_set_default_int(data, ST_KEY_NVIDIA_GREENSCREEN_INTERVAL, 1);
+	obs_data_set_default_int(data, ST_KEY_NVIDIA_GREENSCREEN_SCALE, 100);
 #endif
 }
 
@@ -580,6 +859,7 @@ obs_properties_t* virtual_greenscreen_factory::get_properties2(virtual_greenscre
 			obs_property_set_modified_callback(p, modified_provider);
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(virtual_greenscreen_provider::AUTOMATIC));
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_GREENSCREEN), static_cast<int64_t>(virtual_greenscreen_provider::NVIDIA_GREENSCREEN));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_KEYER), static_cast<int64_t>(virtual_greenscreen_provider::KEYER));
 		}
 	}
 
@@ -607,13 +887,50 @@ bool streamfx::filter::virtual_greenscreen::virtual_greenscreen_factory::is_prov
 	switch (provider) {
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 	case virtual_greenscreen_provider::NVIDIA_GREENSCREEN:
-		return _nvidia_available;
+		return load_nvidia();
 #endif
+	case virtual_greenscreen_provider::KEYER:
+		return true;
 	default:
 		return false;
 	}
 }
 
+#ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+bool streamfx::filter::virtual_greenscreen::virtual_greenscreen_factory::load_nvidia()
+{
+	std::unique_lock<std::mutex> lock(_nvidia_lock);
+	if (_nvidia_loaded) {
+		return _nvidia_available;
+	}
+	_nvidia_loaded = true;
+
+	try {
+		// Load CVImage and Video Effects SDK.
+		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
+		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
+		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
+		_nvidia_available = true;
+	} catch (const std::exception& ex) {
+		_nvidia_available = false;
+		_nvvfx.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA Greenscreen available due to error: %s", ex.what());
+	} catch (...) {
+		_nvidia_available = false;
+		_nvvfx.reset();
+		_nvcvi.reset();
+		_nvcuda.reset();
+		D_LOG_WARNING("Failed to make NVIDIA Greenscreen available.", nullptr);
+	}
+
+	// Remember the result, so that the next session knows whether to show the filter at all.
+	streamfx::configuration::instance()->set_availability("Filter.VirtualGreenscreen.NVIDIA", _nvidia_available);
+	return _nvidia_available;
+}
+#endif
+
 virtual_greenscreen_provider streamfx::filter::virtual_greenscreen::virtual_greenscreen_factory::find_ideal_provider()
 {
 	for (auto v : provider_priority) {
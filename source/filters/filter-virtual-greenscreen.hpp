@@ -3,6 +3,8 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-governor.hpp"
+#include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
@@ -25,6 +27,7 @@ namespace streamfx::filter::virtual_greenscreen {
 		INVALID            = -1,
 		AUTOMATIC          = 0,
 		NVIDIA_GREENSCREEN = 1,
+		KEYER              = 2,
 	};
 
 	const char* cstring(virtual_greenscreen_provider provider);
@@ -51,8 +54,26 @@ namespace streamfx::filter::virtual_greenscreen {
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 		std::shared_ptr<::streamfx::nvidia::vfx::greenscreen> _nvidia_fx;
+		std::shared_ptr<::streamfx::gfx::util>                _nvidia_util;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget>    _nvidia_scaled;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget>    _nvidia_guide;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget>    _nvidia_refined;
+		float                                                 _nvidia_scale;
+		uint32_t                                              _nvidia_interval;
+		std::shared_ptr<::streamfx::gfx::governor>            _nvidia_governor;
 #endif
 
+		std::shared_ptr<::streamfx::gfx::util>             _keyer_util;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _keyer_key;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _keyer_guide;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _keyer_refined;
+		bool                                               _keyer_luma;
+		vec3                                               _keyer_color;
+		float                                              _keyer_similarity;
+		float                                              _keyer_smoothness;
+		float                                              _keyer_spill;
+		bool                                               _keyer_refine;
+
 		public:
 		virtual_greenscreen_instance(obs_data_t* data, obs_source_t* self);
 		~virtual_greenscreen_instance() override;
@@ -80,10 +101,18 @@ namespace streamfx::filter::virtual_greenscreen {
 		void nvvfxgs_properties(obs_properties_t* props);
 		void nvvfxgs_update(obs_data_t* data);
 #endif
+
+		void keyer_load();
+		void keyer_unload();
+		void keyer_process(std::shared_ptr<::streamfx::obs::gs::texture>& color, std::shared_ptr<::streamfx::obs::gs::texture>& alpha);
+		void keyer_properties(obs_properties_t* props);
+		void keyer_update(obs_data_t* data);
 	};
 
 	class virtual_greenscreen_factory : public ::streamfx::obs::source_factory<::streamfx::filter::virtual_greenscreen::virtual_greenscreen_factory, ::streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance> {
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+		std::mutex                                     _nvidia_lock;
+		bool                                           _nvidia_loaded;
 		bool                                           _nvidia_available;
 		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
 		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
@@ -106,6 +135,11 @@ namespace streamfx::filter::virtual_greenscreen {
 		bool                         is_provider_available(virtual_greenscreen_provider);
 		virtual_greenscreen_provider find_ideal_provider();
 
+#ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+		private:
+		bool load_nvidia();
+#endif
+
 		public: // Singleton
 		static void                                                                                  initialize();
 		static void                                                                                  finalize();
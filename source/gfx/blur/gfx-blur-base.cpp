@@ -5,9 +5,13 @@
 #include "gfx-blur-base.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
+streamfx::gfx::blur::base::base() : _region({false, 0., 0., 1., 1.}) {}
+
 void streamfx::gfx::blur::base::set_step_scale_x(double_t v)
 {
 	this->set_step_scale(v, this->get_step_scale_y());
@@ -32,6 +36,51 @@ double_t streamfx::gfx::blur::base::get_step_scale_y()
 	return y;
 }
 
+void streamfx::gfx::blur::base::set_region(double_t left, double_t top, double_t right, double_t bottom)
+{
+	_region.enabled = true;
+	_region.left    = std::clamp(left, 0., 1.);
+	_region.top     = std::clamp(top, 0., 1.);
+	_region.right   = std::clamp(right, _region.left, 1.);
+	_region.bottom  = std::clamp(bottom, _region.top, 1.);
+}
+
+void streamfx::gfx::blur::base::clear_region()
+{
+	_region.enabled = false;
+}
+
+void streamfx::gfx::blur::base::apply_region(uint32_t width, uint32_t height, double_t downscale)
+{
+	if (!_region.enabled) {
+		return;
+	}
+
+	// Every pass after this one may still sample this far out, so grow by the reach of two passes.
+	double_t step_x, step_y;
+	get_step_scale(step_x, step_y);
+	double_t padding = std::ceil((2. * get_size() * std::max(std::abs(step_x), std::abs(step_y))) / std::max(downscale, 1.)) + 2.;
+
+	double_t left   = std::clamp(std::floor(_region.left * width - padding), 0., double_t(width));
+	double_t top    = std::clamp(std::floor(_region.top * height - padding), 0., double_t(height));
+	double_t right  = std::clamp(std::ceil(_region.right * width + padding), left, double_t(width));
+	double_t bottom = std::clamp(std::ceil(_region.bottom * height + padding), top, double_t(height));
+
+	gs_rect rect;
+	rect.x  = static_cast<int>(left);
+	rect.y  = static_cast<int>(top);
+	rect.cx = static_cast<int>(right - left);
+	rect.cy = static_cast<int>(bottom - top);
+	gs_set_scissor_rect(&rect);
+}
+
+void streamfx::gfx::blur::base::reset_region()
+{
+	if (_region.enabled) {
+		gs_set_scissor_rect(nullptr);
+	}
+}
+
 void streamfx::gfx::blur::base_center::set_center_x(double_t v)
 {
 	this->set_center(v, this->get_center_y());
@@ -17,7 +17,16 @@ namespace streamfx::gfx {
 		};
 
 		class base {
+			struct {
+				bool     enabled;
+				double_t left;
+				double_t top;
+				double_t right;
+				double_t bottom;
+			} _region;
+
 			public:
+			base();
 			virtual ~base() {}
 
 			virtual void set_input(std::shared_ptr<::streamfx::obs::gs::texture> texture) = 0;
@@ -43,6 +52,25 @@ namespace streamfx::gfx {
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> render() = 0;
 
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> get() = 0;
+
+			/** Only blur the given part of the input, in normalized coordinates.
+			 *
+			 * Implementations that support it restrict every pass to this region grown by the blur size, and leave
+			 * the content outside of it undefined. Others ignore it and blur everything.
+			 */
+			virtual void set_region(double_t left, double_t top, double_t right, double_t bottom);
+
+			virtual void clear_region();
+
+			protected:
+			/** Scissor the current render target to the region, if there is one.
+			 *
+			 * @param downscale How much smaller the render target is compared to the input.
+			 */
+			void apply_region(uint32_t width, uint32_t height, double_t downscale = 1.);
+
+			/** Undo apply_region(), must be called before handing control back to libobs. */
+			void reset_region();
 		};
 
 		class base_angle {
@@ -6,6 +6,7 @@
 #include "gfx-blur-box-linear.hpp"
 #include "common.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-state.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
@@ -22,7 +23,7 @@ streamfx::gfx::blur::box_linear_data::box_linear_data() : _gfx_util(::streamfx::
 	{
 		auto file = streamfx::data_file_path("effects/blur/box-linear.effect");
 		try {
-			_effect = streamfx::obs::gs::effect::create(file);
+			_effect = streamfx::obs::gs::effect_registry::instance()->get(file);
 		} catch (const std::exception& ex) {
 			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 		}
@@ -239,18 +240,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	// Two Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -269,6 +260,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
@@ -285,13 +277,15 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 
 			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
 		}
 	}
 
-	gs_blend_state_pop();
+	reset_region();
+	streamfx::obs::gs::state::pop();
 
 	return _rendertarget->get_texture();
 }
@@ -329,18 +323,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear_di
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -360,7 +344,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear_di
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return _rendertarget->get_texture();
 }
@@ -6,6 +6,7 @@
 #include "gfx-blur-box.hpp"
 #include "common.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-state.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
@@ -15,6 +16,8 @@
 #include "warning-enable.hpp"
 
 #define ST_MAX_BLUR_SIZE 128 // Also change this in box.effect if modified.
+// Directional and zoom blurs of at least this size are built up over several passes.
+#define ST_HIERARCHICAL_THRESHOLD 8
 
 streamfx::gfx::blur::box_data::box_data() : _gfx_util(::streamfx::gfx::util::get())
 {
@@ -22,7 +25,7 @@ streamfx::gfx::blur::box_data::box_data() : _gfx_util(::streamfx::gfx::util::get
 	{
 		auto file = streamfx::data_file_path("effects/blur/box.effect");
 		try {
-			_effect = streamfx::obs::gs::effect::create(file);
+			_effect = streamfx::obs::gs::effect_registry::instance()->get(file);
 		} catch (const std::exception& ex) {
 			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 		}
@@ -249,18 +252,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box::render()
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	// Two Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -279,6 +272,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box::render()
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
@@ -295,17 +289,58 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box::render()
 
 			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
 		}
 	}
 
-	gs_blend_state_pop();
+	reset_region();
+	streamfx::obs::gs::state::pop();
 
 	return _rendertarget->get_texture();
 }
 
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box::render_hierarchical(streamfx::obs::gs::effect& effect, const char* technique, float_t texel_x, float_t texel_y)
+{
+	uint32_t width  = _input_texture->get_width();
+	uint32_t height = _input_texture->get_height();
+
+	// All passes together sample 4^passes evenly spaced taps, squeezed together slightly to span exactly 2 * size.
+	size_t passes = 1;
+	for (double_t taps = 4.; taps < (_size * 2. + 1.); taps *= 4.) {
+		passes++;
+	}
+	double_t spacing = (_size * 2.) / (std::pow(4., double_t(passes)) - 1.);
+
+	effect.get_parameter("pImageTexel").set_float2(texel_x, texel_y);
+	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
+
+	std::shared_ptr<::streamfx::obs::gs::texture> source = _input_texture;
+	for (size_t pass = 0; pass < passes; pass++, spacing *= 4.) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Pass %" PRIuMAX, pass);
+#endif
+
+		effect.get_parameter("pImage").set_texture(source);
+		effect.get_parameter("pSize").set_float(float_t(spacing));
+
+		{
+			auto op = _rendertarget2->render(width, height);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect.get_object(), technique)) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+
+		std::swap(_rendertarget, _rendertarget2);
+		source = _rendertarget->get_texture();
+	}
+
+	return source;
+}
+
 std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box::get()
 {
 	return _rendertarget->get_texture();
@@ -339,22 +374,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_direction
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
-	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
-	if (effect) {
+	if (effect && (_size >= ST_HIERARCHICAL_THRESHOLD)) {
+		render_hierarchical(effect, "DrawStep", float_t(1. / width * cos(_angle)), float_t(1.f / height * sin(_angle)));
+	} else if (effect) { // One Pass Blur
 		effect.get_parameter("pImage").set_texture(_input_texture);
 		effect.get_parameter("pImageTexel").set_float2(float_t(1. / width * cos(_angle)), float_t(1.f / height * sin(_angle)));
 		effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
@@ -370,7 +396,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_direction
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return _rendertarget->get_texture();
 }
@@ -413,18 +439,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_rotationa
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -446,7 +462,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_rotationa
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return _rendertarget->get_texture();
 }
@@ -479,22 +495,14 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_zoom::ren
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
-	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
-	if (effect) {
+	if (effect && (_size >= ST_HIERARCHICAL_THRESHOLD)) {
+		effect.get_parameter("pCenter").set_float2(float_t(_center.first), float_t(_center.second));
+		render_hierarchical(effect, "ZoomStep", float_t(1.f / width), float_t(1.f / height));
+	} else if (effect) { // One Pass Blur
 		effect.get_parameter("pImage").set_texture(_input_texture);
 		effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
 		effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
@@ -511,7 +519,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_zoom::ren
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return _rendertarget->get_texture();
 }
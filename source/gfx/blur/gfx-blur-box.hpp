@@ -85,6 +85,14 @@ namespace streamfx::gfx {
 			private:
 			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget2;
 
+			protected:
+			/** Blur along a line in a few cheap passes instead of one pass with hundreds of taps.
+			 *
+			 * Each pass averages four taps, spaced four times as far apart as in the previous pass, which adds up to one
+			 * evenly weighted box after log4(size) passes. The technique is run with 'pSize' set to the tap spacing.
+			 */
+			std::shared_ptr<::streamfx::obs::gs::texture> render_hierarchical(streamfx::obs::gs::effect& effect, const char* technique, float_t texel_x, float_t texel_y);
+
 			public:
 			box();
 			virtual ~box() override;
@@ -0,0 +1,86 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-blur-cache.hpp"
+
+#include "warning-disable.hpp"
+#include <mutex>
+#include "warning-enable.hpp"
+
+streamfx::gfx::blur::cache::key::key(const void* origin_, ::streamfx::gfx::blur::base& blur)
+	: origin(origin_), implementation(typeid(blur)), type(blur.get_type()), size(blur.get_size()), step_scale(), angle(0.), center(0., 0.)
+{
+	blur.get_step_scale(step_scale.first, step_scale.second);
+	if (auto obj = dynamic_cast<::streamfx::gfx::blur::base_angle*>(&blur); obj) {
+		angle = obj->get_angle();
+	}
+	if (auto obj = dynamic_cast<::streamfx::gfx::blur::base_center*>(&blur); obj) {
+		obj->get_center(center.first, center.second);
+	}
+}
+
+bool streamfx::gfx::blur::cache::key::operator==(const key& rhs) const
+{
+	return (origin == rhs.origin) && (implementation == rhs.implementation) && (type == rhs.type) && (size == rhs.size) && (step_scale == rhs.step_scale) && (angle == rhs.angle) && (center == rhs.center);
+}
+
+std::shared_ptr<streamfx::gfx::blur::cache> streamfx::gfx::blur::cache::get()
+{
+	static std::weak_ptr<streamfx::gfx::blur::cache> instance;
+	static std::mutex                                lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::blur::cache>(new streamfx::gfx::blur::cache());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
+
+streamfx::gfx::blur::cache::cache() : _frame(0), _entries() {}
+
+streamfx::gfx::blur::cache::~cache() {}
+
+void streamfx::gfx::blur::cache::refresh()
+{
+	// Results are only valid for the frame they were rendered in.
+	if (uint64_t frame = obs_get_video_frame_time(); frame != _frame) {
+		_frame = frame;
+		_entries.clear();
+	}
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::cache::find(const void* origin, std::shared_ptr<::streamfx::gfx::blur::base> blur)
+{
+	if (!origin || !blur) {
+		return nullptr;
+	}
+
+	refresh();
+
+	key id{origin, *blur};
+	for (auto& kv : _entries) {
+		if (kv.id == id) {
+			return kv.texture;
+		}
+	}
+	return nullptr;
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::cache::render(const void* origin, std::shared_ptr<::streamfx::gfx::blur::base> blur)
+{
+	if (!origin) {
+		return blur->render();
+	}
+
+	if (auto texture = find(origin, blur); texture) {
+		return texture;
+	}
+
+	// Keep the blur alive alongside its result, as the texture belongs to one of its render targets.
+	auto texture = blur->render();
+	_entries.push_back({key{origin, *blur}, blur, texture});
+	return texture;
+}
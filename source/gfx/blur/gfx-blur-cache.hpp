@@ -0,0 +1,71 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx-blur-base.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include <typeindex>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx::blur {
+	/** Per-frame cache of blur results, so identical blurs of the same input are only computed once.
+	 *
+	 * Results are keyed by where the input came from, the blur implementation and all of its parameters. The
+	 * cache empties itself whenever a new video frame begins, and must only be used from the graphics thread.
+	 */
+	class cache {
+		struct key {
+			const void*                   origin;
+			std::type_index               implementation;
+			::streamfx::gfx::blur::type   type;
+			double_t                      size;
+			std::pair<double_t, double_t> step_scale;
+			double_t                      angle;
+			std::pair<double_t, double_t> center;
+
+			key(const void* origin, ::streamfx::gfx::blur::base& blur);
+
+			bool operator==(const key& rhs) const;
+		};
+
+		struct entry {
+			key                                           id;
+			std::shared_ptr<::streamfx::gfx::blur::base>  owner;
+			std::shared_ptr<::streamfx::obs::gs::texture> texture;
+		};
+
+		uint64_t           _frame;
+		std::vector<entry> _entries;
+
+		public /* Singleton */:
+		static std::shared_ptr<::streamfx::gfx::blur::cache> get();
+
+		private:
+		cache();
+
+		void refresh();
+
+		public:
+		~cache();
+
+		/** Look up the result of an identical blur of the same origin in this frame.
+		 *
+		 * @param origin What the input texture was produced from, e.g. the upstream source. Must not be nullptr.
+		 * @return The already blurred texture, or nullptr if there is none yet.
+		 */
+		std::shared_ptr<::streamfx::obs::gs::texture> find(const void* origin, std::shared_ptr<::streamfx::gfx::blur::base> blur);
+
+		/** Render the blur, or reuse an identical result from this frame.
+		 *
+		 * The input must already be set on the blur. An origin of nullptr disables sharing entirely.
+		 */
+		std::shared_ptr<::streamfx::obs::gs::texture> render(const void* origin, std::shared_ptr<::streamfx::gfx::blur::base> blur);
+	};
+} // namespace streamfx::gfx::blur
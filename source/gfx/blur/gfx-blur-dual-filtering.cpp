@@ -6,6 +6,7 @@
 #include "gfx-blur-dual-filtering.hpp"
 #include "common.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-state.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
@@ -30,6 +31,10 @@
 //   6: 3 Iteration (8x), Arm Size 7, Offset Scale 0.75
 //   7: 3 Iteration (8x), Arm Size 8, Offset Scale 1.0
 //   ...
+//
+// Fractional sizes run the iterations of the next larger size, but blend the upsampled
+//  result with the downsampled image once it arrives at the level of the smaller size.
+//  Every later upsample is linear, which makes this the same as blending both results.
 
 #define ST_MAX_LEVELS 16
 
@@ -39,7 +44,7 @@ streamfx::gfx::blur::dual_filtering_data::dual_filtering_data() : _gfx_util(::st
 	{
 		auto file = streamfx::data_file_path("effects/blur/dual-filtering.effect");
 		try {
-			_effect = streamfx::obs::gs::effect::create(file);
+			_effect = streamfx::obs::gs::effect_registry::instance()->get(file);
 		} catch (const std::exception& ex) {
 			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 		}
@@ -93,7 +98,7 @@ double_t streamfx::gfx::blur::dual_filtering_factory::get_min_size(::streamfx::g
 
 double_t streamfx::gfx::blur::dual_filtering_factory::get_step_size(::streamfx::gfx::blur::type)
 {
-	return double_t(1.);
+	return double_t(0.01);
 }
 
 double_t streamfx::gfx::blur::dual_filtering_factory::get_max_size(::streamfx::gfx::blur::type)
@@ -168,10 +173,11 @@ std::shared_ptr<::streamfx::gfx::blur::dual_filtering_data> streamfx::gfx::blur:
 	return instance;
 }
 
-streamfx::gfx::blur::dual_filtering::dual_filtering() : _data(::streamfx::gfx::blur::dual_filtering_factory::get().data()), _size(0), _iterations(0)
+streamfx::gfx::blur::dual_filtering::dual_filtering() : _data(::streamfx::gfx::blur::dual_filtering_factory::get().data()), _size(0), _iterations(0), _mix(0)
 {
 	auto gctx = streamfx::obs::gs::context();
 	_rts.resize(ST_MAX_LEVELS + 1);
+	_rts_mix.resize(ST_MAX_LEVELS + 1);
 	for (std::size_t n = 0; n <= ST_MAX_LEVELS; n++) {
 		gs_color_format cf = GS_RGBA;
 #if 0
@@ -179,7 +185,8 @@ streamfx::gfx::blur::dual_filtering::dual_filtering() : _data(::streamfx::gfx::b
 #elif 0
 		cf = GS_RGBA32F;
 #endif
-		_rts[n] = std::make_shared<streamfx::obs::gs::rendertarget>(cf, GS_ZS_NONE);
+		_rts[n]     = std::make_shared<streamfx::obs::gs::rendertarget>(cf, GS_ZS_NONE);
+		_rts_mix[n] = std::make_shared<streamfx::obs::gs::rendertarget>(cf, GS_ZS_NONE);
 	}
 }
 
@@ -202,8 +209,12 @@ double_t streamfx::gfx::blur::dual_filtering::get_size()
 
 void streamfx::gfx::blur::dual_filtering::set_size(double_t width)
 {
-	_size       = width;
-	_iterations = std::clamp<size_t>(static_cast<size_t>(round(width)), 0, ST_MAX_LEVELS);
+	_size = width;
+
+	// Sizes this close to a whole number are not worth the extra pass.
+	double_t size = round(std::clamp<double_t>(width, 0., ST_MAX_LEVELS) * 1000.) / 1000.;
+	_iterations   = static_cast<size_t>(ceil(size));
+	_mix          = static_cast<float_t>(size - floor(size));
 }
 
 void streamfx::gfx::blur::dual_filtering::set_step_scale(double_t, double_t) {}
@@ -219,26 +230,18 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 #endif
 
 	auto effect = _data->get_effect();
-	if (!effect) {
-		return _input_texture;
+	if (!effect || (_iterations == 0)) {
+		_output_texture = _input_texture;
+		return _output_texture;
 	}
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	uint32_t width      = _input_texture->get_width();
 	uint32_t height     = _input_texture->get_height();
 	size_t   iterations = _iterations;
+	float_t  mix        = _mix;
 
 	// Downsample
 	for (std::size_t n = 1; n <= iterations; n++) {
@@ -259,6 +262,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 		uint32_t oheight = height >> n;
 		if ((owidth == 0) || (oheight == 0)) {
 			iterations = n - 1;
+			mix        = 0.;
 			break;
 		}
 
@@ -277,13 +281,14 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 	}
 
 	// Upsample
+	std::shared_ptr<streamfx::obs::gs::texture> tex = iterations > 0 ? _rts[iterations]->get_texture() : _input_texture;
 	for (std::size_t n = iterations; n > 0; n--) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Up %" PRIuMAX, n);
 #endif
 
-		// Select Texture
-		std::shared_ptr<streamfx::obs::gs::texture> tex = _rts[n]->get_texture();
+		// Blend with the downsampled image at the level the smaller size would have started upsampling from.
+		bool is_mix = (mix > 0.) && (n == iterations);
 
 		// Get Size
 		uint32_t iwidth  = tex->get_width();
@@ -295,22 +300,29 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 		effect.get_parameter("pImage").set_texture(tex);
 		effect.get_parameter("pImageSize").set_float2(static_cast<float>(iwidth), static_cast<float>(iheight));
 		effect.get_parameter("pImageTexel").set_float2(0.5f / static_cast<float>(iwidth), 0.5f / static_cast<float>(iheight));
+		if (is_mix) {
+			effect.get_parameter("pImageBase").set_texture((n > 1) ? _rts[n - 1]->get_texture() : _input_texture);
+			effect.get_parameter("pMix").set_float(mix);
+		}
 
+		auto rt = is_mix ? _rts_mix[n - 1] : _rts[n - 1];
 		{
-			auto op = _rts[n - 1]->render(owidth, oheight);
+			auto op = rt->render(owidth, oheight);
 			gs_ortho(0., 1., 0., 1., 0., 1.);
-			while (gs_effect_loop(effect.get_object(), "Up")) {
+			while (gs_effect_loop(effect.get_object(), is_mix ? "UpMix" : "Up")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
 		}
+		tex = rt->get_texture();
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
-	return _rts[0]->get_texture();
+	_output_texture = tex;
+	return _output_texture;
 }
 
 std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filtering::get()
 {
-	return _rts[0]->get_texture();
+	return _output_texture;
 }
@@ -79,10 +79,15 @@ namespace streamfx::gfx {
 
 			double_t    _size;
 			std::size_t _iterations;
+			float_t     _mix;
 
 			std::shared_ptr<streamfx::obs::gs::texture> _input_texture;
+			std::shared_ptr<streamfx::obs::gs::texture> _output_texture;
 
+			// One target per level, plus one per level for blending fractional sizes. Each keeps its size for
+			// as long as the input does, so changing the blur size never reallocates anything.
 			std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> _rts;
+			std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> _rts_mix;
 
 			public:
 			dual_filtering();
@@ -6,8 +6,11 @@
 #include "gfx-blur-gaussian-linear.hpp"
 #include "common.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-state.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -30,7 +33,7 @@ streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data() : _gfx_util(::
 		{
 			auto file = streamfx::data_file_path("effects/blur/gaussian-linear.effect");
 			try {
-				_effect = streamfx::obs::gs::effect::create(file);
+				_effect = streamfx::obs::gs::effect_registry::instance()->get(file);
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 			}
@@ -43,11 +46,29 @@ streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data() : _gfx_util(::
 		std::vector<float_t>  kernel_data(ST_MAX_KERNEL_SIZE);
 		double_t              actual_width = 1.;
 
-		// Find actual kernel width.
-		for (double_t h = ST_SEARCH_DENSITY; h < ST_SEARCH_RANGE; h += ST_SEARCH_DENSITY) {
-			if (streamfx::util::math::gaussian<double_t>(double_t(kernel_size + ST_SEARCH_EXTENSION), h) > ST_SEARCH_THRESHOLD) {
-				actual_width = h;
-				break;
+		// Find actual kernel width, which is the first width on the search grid that crosses the threshold. The value
+		// at a fixed distance only rises with the width up until the width equals the distance, so the crossing can
+		// be bisected instead of walking the entire grid.
+		{
+			double_t x = double_t(kernel_size + ST_SEARCH_EXTENSION);
+			auto     f = [x](double_t h) { return streamfx::util::math::gaussian<double_t>(x, h) > ST_SEARCH_THRESHOLD; };
+
+			double_t hi = std::min<double_t>(x, ST_SEARCH_RANGE);
+			if (f(hi)) {
+				double_t lo = 0.;
+				while ((hi - lo) > (ST_SEARCH_DENSITY / 4.)) {
+					double_t mid = (lo + hi) / 2.;
+					(f(mid) ? hi : lo) = mid;
+				}
+
+				// Snap to the grid the search was originally done on.
+				actual_width = std::max<double_t>(std::ceil(hi / ST_SEARCH_DENSITY), 1.) * ST_SEARCH_DENSITY;
+				while (!f(actual_width)) {
+					actual_width += ST_SEARCH_DENSITY;
+				}
+				while ((actual_width > ST_SEARCH_DENSITY) && f(actual_width - ST_SEARCH_DENSITY)) {
+					actual_width -= ST_SEARCH_DENSITY;
+				}
 			}
 		}
 
@@ -296,18 +317,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
@@ -325,6 +336,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
@@ -345,6 +357,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
@@ -353,7 +366,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 		std::swap(_rendertarget, _rendertarget2);
 	}
 
-	gs_blend_state_pop();
+	reset_region();
+	streamfx::obs::gs::state::pop();
 
 	return this->get();
 }
@@ -401,18 +415,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width * cos(_angle)), float_t(1.f / height * sin(_angle)));
@@ -429,7 +433,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return this->get();
 }
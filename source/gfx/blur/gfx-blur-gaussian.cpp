@@ -7,88 +7,77 @@
 #include "common.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-state.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <stdexcept>
+#include <utility>
 #include "warning-enable.hpp"
 
 // TODO: It may be possible to optimize to run much faster: https://rastergrid.com/blog/2010/09/efficient-gaussian-blur-with-linear-sampling/
 
 #define ST_KERNEL_SIZE 128u
 #define ST_OVERSAMPLE_MULTIPLIER 2
-#define ST_MAX_BLUR_SIZE ST_KERNEL_SIZE / ST_OVERSAMPLE_MULTIPLIER
+#define ST_MAX_BLUR_SIZE (ST_KERNEL_SIZE / ST_OVERSAMPLE_MULTIPLIER)
+// Blur sizes at or above this are evaluated at a reduced resolution, so that each pass reads far fewer texels.
+#define ST_DOWNSAMPLE_THRESHOLD 16
+// Area blurs run on a pyramid, which keeps the kernel small no matter how large the requested size is.
+#define ST_MAX_PYRAMID_SIZE 512
 
-streamfx::gfx::blur::gaussian_data::gaussian_data() : _gfx_util(::streamfx::gfx::util::get())
-{
-	using namespace streamfx::util;
-
-	std::array<double, ST_KERNEL_SIZE> kernel_dbl;
-	std::vector<float>                 kernel(ST_KERNEL_SIZE);
+namespace {
+	using kernel_t = streamfx::gfx::blur::gaussian_data::kernel_t;
+	static_assert(std::tuple_size_v<kernel_t> == ST_KERNEL_SIZE, "Kernel type does not match the kernel size.");
 
+	constexpr kernel_t make_kernel(size_t size)
 	{
-		auto gctx = streamfx::obs::gs::context();
+		using namespace streamfx::util;
 
-		{
-			auto file = streamfx::data_file_path("effects/blur/gaussian.effect");
-			try {
-				_effect = streamfx::obs::gs::effect::create(file);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
-			}
-		}
-	}
-
-	//#define ST_USE_PASCAL_TRIANGLE
-
-	// Pre-calculate Kernel Information for all Kernel sizes
-	for (size_t size = 1; size <= ST_MAX_BLUR_SIZE; size++) {
-#ifdef ST_USE_PASCAL_TRIANGLE
-		// The Pascal Triangle can be used to generate Gaussian Kernels, which is
-		// significantly faster than doing the same task with searching. It is also
-		// much more accurate at the same time, so it is a 2-in-1 solution.
-
-		// Generate the required row and sum.
-		size_t offset   = size;
-		size_t row      = size * 2;
-		auto   triangle = math::pascal_triangle<double>(row);
-		double sum      = pow(2, row);
-
-		// Convert all integers to floats.
-		double accum = 0.;
-		for (size_t idx = offset; idx < std::min<size_t>(triangle.size(), ST_KERNEL_SIZE); idx++) {
-			double v                 = static_cast<double>(triangle[idx]) / sum;
-			kernel_dbl[idx - offset] = v;
-			// Accumulator needed as we end up with float inaccuracies above a certain threshold.
-			accum += v * (idx > offset ? 2 : 1);
-		}
-
-		// Rescale all values back into useful ranges.
-		accum = 1. / accum;
-		for (size_t idx = offset; idx < ST_KERNEL_SIZE; idx++) {
-			kernel[idx - offset] = kernel_dbl[idx - offset] * accum;
-		}
-#else
-		size_t oversample = size * ST_OVERSAMPLE_MULTIPLIER;
+		std::array<double, ST_KERNEL_SIZE> kernel_dbl = {};
+		kernel_t                           kernel     = {};
+		size_t                             oversample = size * ST_OVERSAMPLE_MULTIPLIER;
 
 		// Generate initial weights and calculate a total from them.
 		double total = 0.;
 		for (size_t idx = 0; (idx < oversample) && (idx < ST_KERNEL_SIZE); idx++) {
-			kernel_dbl[idx] = math::gaussian<double>(static_cast<double>(idx), static_cast<double>(size));
+			kernel_dbl[idx] = math::gaussian_constexpr<double>(static_cast<double>(idx), static_cast<double>(size));
 			total += kernel_dbl[idx] * (idx > 0 ? 2 : 1);
 		}
 
 		// Scale the weights according to the total gathered, and convert to float.
 		for (size_t idx = 0; (idx < oversample) && (idx < ST_KERNEL_SIZE); idx++) {
-			kernel_dbl[idx] /= total;
-			kernel[idx] = static_cast<float>(kernel_dbl[idx]);
+			kernel[idx] = static_cast<float>(kernel_dbl[idx] / total);
 		}
 
-#endif
+		return kernel;
+	}
 
-		// Store Kernel
-		_kernels.insert_or_assign(size, kernel);
+	// Each size is its own constant, which keeps every single evaluation well within the compilers' step limits.
+	template<size_t Size>
+	constexpr kernel_t kernel_v = make_kernel(Size);
+
+	template<size_t... Sizes>
+	constexpr std::array<const kernel_t*, sizeof...(Sizes)> make_kernels(std::index_sequence<Sizes...>)
+	{
+		return {&kernel_v<Sizes + 1>...};
+	}
+
+	// All kernels from size 1 up to ST_MAX_BLUR_SIZE, generated entirely at compile time.
+	constexpr auto kernels = make_kernels(std::make_index_sequence<ST_MAX_BLUR_SIZE>());
+} // namespace
+
+streamfx::gfx::blur::gaussian_data::gaussian_data() : _gfx_util(::streamfx::gfx::util::get())
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	auto file = streamfx::data_file_path("effects/blur/gaussian.effect");
+	try {
+		_effect = streamfx::obs::gs::effect_registry::instance()->get(file);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 	}
 }
 
@@ -108,10 +97,10 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::gaussian_data::get_gfx
 	return _gfx_util;
 }
 
-std::vector<float_t> const& streamfx::gfx::blur::gaussian_data::get_kernel(std::size_t width)
+streamfx::gfx::blur::gaussian_data::kernel_t const& streamfx::gfx::blur::gaussian_data::get_kernel(std::size_t width)
 {
 	width = std::clamp<size_t>(width, 1, ST_MAX_BLUR_SIZE);
-	return _kernels.at(width);
+	return *kernels[width - 1];
 }
 
 streamfx::gfx::blur::gaussian_factory::gaussian_factory() {}
@@ -160,8 +149,11 @@ double_t streamfx::gfx::blur::gaussian_factory::get_step_size(::streamfx::gfx::b
 	return double_t(1.0);
 }
 
-double_t streamfx::gfx::blur::gaussian_factory::get_max_size(::streamfx::gfx::blur::type)
+double_t streamfx::gfx::blur::gaussian_factory::get_max_size(::streamfx::gfx::blur::type v)
 {
+	if (v == ::streamfx::gfx::blur::type::Area) {
+		return double_t(ST_MAX_PYRAMID_SIZE);
+	}
 	return double_t(ST_MAX_BLUR_SIZE);
 }
 
@@ -279,8 +271,9 @@ void streamfx::gfx::blur::gaussian::set_size(double_t width)
 {
 	if (width < 1.)
 		width = 1.;
-	if (width > ST_MAX_BLUR_SIZE)
-		width = ST_MAX_BLUR_SIZE;
+	double_t limit = (get_type() == ::streamfx::gfx::blur::type::Area) ? ST_MAX_PYRAMID_SIZE : ST_MAX_BLUR_SIZE;
+	if (width > limit)
+		width = limit;
 	_size = width;
 }
 
@@ -320,31 +313,56 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 		return _input_texture;
 	}
 
-	auto    kernel = _data->get_kernel(size_t(_size));
-	float_t width  = float_t(_input_texture->get_width());
-	float_t height = float_t(_input_texture->get_height());
+	// Large blurs barely change with resolution, so halve the input until the remaining blur size is small.
+	uint32_t factor = 1;
+	while ((_size / (factor * 2)) >= (ST_DOWNSAMPLE_THRESHOLD / 2)) {
+		factor *= 2;
+	}
+
+	std::shared_ptr<::streamfx::obs::gs::texture> source = _input_texture;
+	double_t                                      size   = _size / factor;
+	auto                                          kernel = _data->get_kernel(size_t(size));
+	float_t                                       width  = float_t(_input_texture->get_width());
+	float_t                                       height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
+
+	if (factor > 1) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Downsample");
+#endif
+
+		// Each step samples between four texels, which with linear filtering is an exact 2x2 box average.
+		gs_effect_t* copy = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		for (uint32_t level = 0, scale = 2; scale <= factor; level++, scale *= 2) {
+			if (_levels.size() <= level) {
+				_levels.push_back(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE));
+			}
+
+			width  = std::max(1.f, std::floor(float_t(_input_texture->get_width()) / float_t(scale)));
+			height = std::max(1.f, std::floor(float_t(_input_texture->get_height()) / float_t(scale)));
+			{
+				auto op = _levels[level]->render(uint32_t(width), uint32_t(height));
+				gs_ortho(0, 1., 0, 1., 0, 1.);
+				apply_region(uint32_t(width), uint32_t(height), double_t(scale));
+				gs_effect_set_texture(gs_effect_get_param_by_name(copy, "image"), source->get_object());
+				while (gs_effect_loop(copy, "Draw")) {
+					_data->get_gfx_util()->draw_fullscreen_triangle();
+				}
+			}
+			source = _levels[level]->get_texture();
+		}
+	}
 
 	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
-	effect.get_parameter("pSize").set_float(float_t(_size * ST_OVERSAMPLE_MULTIPLIER));
+	effect.get_parameter("pSize").set_float(float_t(size * ST_OVERSAMPLE_MULTIPLIER));
 	effect.get_parameter("pKernel").set_value(kernel.data(), ST_KERNEL_SIZE);
 
 	// First Pass
 	if (_step_scale.first > std::numeric_limits<double_t>::epsilon()) {
-		effect.get_parameter("pImage").set_texture(_input_texture);
+		effect.get_parameter("pImage").set_texture(source);
 		effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), 0.f);
 
 		{
@@ -354,6 +372,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height), double_t(factor));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
@@ -374,6 +393,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			apply_region(uint32_t(width), uint32_t(height), double_t(factor));
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				_data->get_gfx_util()->draw_fullscreen_triangle();
 			}
@@ -382,7 +402,45 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 		std::swap(_rendertarget, _rendertarget2);
 	}
 
-	gs_blend_state_pop();
+	// Bring a reduced resolution result back to the input size one octave at a time. Each step is a tent filter
+	// through linear filtering, and going through every level avoids the blockiness of a single large upscale.
+	if (factor > 1) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Upsample");
+#endif
+
+		gs_effect_t* copy = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		source            = _rendertarget->get_texture();
+		for (uint32_t scale = factor / 2; scale >= 1; scale /= 2) {
+			// The level for 'scale' is held by _levels[log2(scale) - 1], the full resolution result by _rendertarget2.
+			std::shared_ptr<::streamfx::obs::gs::rendertarget> target = _rendertarget2;
+			if (scale > 1) {
+				size_t level = 0;
+				for (uint32_t v = scale; v > 2; v /= 2) {
+					level++;
+				}
+				target = _levels[level];
+			}
+
+			width  = std::max(1.f, std::floor(float_t(_input_texture->get_width()) / float_t(scale)));
+			height = std::max(1.f, std::floor(float_t(_input_texture->get_height()) / float_t(scale)));
+			{
+				auto op = target->render(uint32_t(width), uint32_t(height));
+				gs_ortho(0, 1., 0, 1., 0, 1.);
+				apply_region(uint32_t(width), uint32_t(height), double_t(scale));
+				gs_effect_set_texture(gs_effect_get_param_by_name(copy, "image"), source->get_object());
+				while (gs_effect_loop(copy, "Draw")) {
+					_data->get_gfx_util()->draw_fullscreen_triangle();
+				}
+			}
+			source = target->get_texture();
+		}
+
+		std::swap(_rendertarget, _rendertarget2);
+	}
+
+	reset_region();
+	streamfx::obs::gs::state::pop();
 
 	return this->get();
 }
@@ -430,18 +488,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_dire
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width * cos(m_angle)), float_t(1.f / height * sin(m_angle)));
@@ -457,7 +505,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_dire
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return this->get();
 }
@@ -486,18 +534,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_rota
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
@@ -516,7 +554,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_rota
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return this->get();
 }
@@ -567,18 +605,8 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_zoom
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
@@ -596,7 +624,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_zoom
 		}
 	}
 
-	gs_blend_state_pop();
+	streamfx::obs::gs::state::pop();
 
 	return this->get();
 }
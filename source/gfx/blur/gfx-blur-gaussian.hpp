@@ -11,6 +11,7 @@
 #include "obs/gs/gs-texture.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
 #include <mutex>
 #include <vector>
 #include "warning-enable.hpp"
@@ -20,9 +21,10 @@ namespace streamfx::gfx {
 		class gaussian_data {
 			streamfx::obs::gs::effect            _effect;
 			std::shared_ptr<streamfx::gfx::util> _gfx_util;
-			std::map<size_t, std::vector<float>> _kernels;
 
 			public:
+			typedef std::array<float_t, 128> kernel_t;
+
 			gaussian_data();
 			virtual ~gaussian_data();
 
@@ -30,7 +32,8 @@ namespace streamfx::gfx {
 
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
-			std::vector<float_t> const& get_kernel(std::size_t width);
+			/** Kernel for the given width, which is looked up from a table generated at compile time. */
+			kernel_t const& get_kernel(std::size_t width);
 		};
 
 		class gaussian_factory : public ::streamfx::gfx::blur::ifactory {
@@ -87,7 +90,8 @@ namespace streamfx::gfx {
 			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget;
 
 			private:
-			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget2;
+			std::shared_ptr<::streamfx::obs::gs::rendertarget>              _rendertarget2;
+			std::vector<std::shared_ptr<::streamfx::obs::gs::rendertarget>> _levels;
 
 			public:
 			gaussian();
@@ -0,0 +1,250 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-blur-kawase.hpp"
+#include "common.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-state.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+// Kawase Blur
+//
+// Each iteration takes four bilinear samples on the diagonals, each one between four texels,
+//  and pushes them further out every iteration. That approximates a Gaussian of growing size
+//  with only four texture fetches per pixel and iteration, and no intermediate allocations.
+//
+// That means that for a blur size of:
+//   0: No Iterations, straight copy.
+//   1: 1 Iteration, Offsets 0.5
+//   2: 2 Iterations, Offsets 0.5, 1.5
+//   3: 3 Iterations, Offsets 0.5, 1.5, 2.5
+//   ...
+
+#define ST_MAX_ITERATIONS 32
+
+streamfx::gfx::blur::kawase_data::kawase_data() : _gfx_util(::streamfx::gfx::util::get())
+{
+	auto gctx = streamfx::obs::gs::context();
+	{
+		auto file = streamfx::data_file_path("effects/blur/kawase.effect");
+		try {
+			_effect = streamfx::obs::gs::effect_registry::instance()->get(file);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+		}
+	}
+}
+
+streamfx::gfx::blur::kawase_data::~kawase_data()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_effect.reset();
+}
+
+std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::kawase_data::get_gfx_util()
+{
+	return _gfx_util;
+}
+
+streamfx::obs::gs::effect streamfx::gfx::blur::kawase_data::get_effect()
+{
+	return _effect;
+}
+
+streamfx::gfx::blur::kawase_factory::kawase_factory() {}
+
+streamfx::gfx::blur::kawase_factory::~kawase_factory() {}
+
+bool streamfx::gfx::blur::kawase_factory::is_type_supported(::streamfx::gfx::blur::type type)
+{
+	switch (type) {
+	case ::streamfx::gfx::blur::type::Area:
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::shared_ptr<::streamfx::gfx::blur::base> streamfx::gfx::blur::kawase_factory::create(::streamfx::gfx::blur::type type)
+{
+	switch (type) {
+	case ::streamfx::gfx::blur::type::Area:
+		return std::make_shared<::streamfx::gfx::blur::kawase>();
+	default:
+		throw std::runtime_error("Invalid type.");
+	}
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_min_size(::streamfx::gfx::blur::type)
+{
+	return double_t(1.);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_step_size(::streamfx::gfx::blur::type)
+{
+	return double_t(1.);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_max_size(::streamfx::gfx::blur::type)
+{
+	return double_t(ST_MAX_ITERATIONS);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_min_angle(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_step_angle(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_max_angle(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+bool streamfx::gfx::blur::kawase_factory::is_step_scale_supported(::streamfx::gfx::blur::type)
+{
+	return false;
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_min_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_step_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_max_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_min_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_step_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::kawase_factory::get_max_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+std::shared_ptr<::streamfx::gfx::blur::kawase_data> streamfx::gfx::blur::kawase_factory::data()
+{
+	std::unique_lock<std::mutex>                                ulock(_data_lock);
+	std::shared_ptr<::streamfx::gfx::blur::kawase_data> data = _data.lock();
+	if (!data) {
+		data  = std::make_shared<::streamfx::gfx::blur::kawase_data>();
+		_data = data;
+	}
+	return data;
+}
+
+::streamfx::gfx::blur::kawase_factory& streamfx::gfx::blur::kawase_factory::get()
+{
+	static ::streamfx::gfx::blur::kawase_factory instance;
+	return instance;
+}
+
+streamfx::gfx::blur::kawase::kawase() : _data(::streamfx::gfx::blur::kawase_factory::get().data()), _size(0), _iterations(0)
+{
+	auto gctx      = streamfx::obs::gs::context();
+	_rendertarget  = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_rendertarget2 = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+}
+
+streamfx::gfx::blur::kawase::~kawase() {}
+
+void streamfx::gfx::blur::kawase::set_input(std::shared_ptr<::streamfx::obs::gs::texture> texture)
+{
+	_input_texture = std::move(texture);
+}
+
+::streamfx::gfx::blur::type streamfx::gfx::blur::kawase::get_type()
+{
+	return ::streamfx::gfx::blur::type::Area;
+}
+
+double_t streamfx::gfx::blur::kawase::get_size()
+{
+	return _size;
+}
+
+void streamfx::gfx::blur::kawase::set_size(double_t width)
+{
+	_size       = width;
+	_iterations = std::clamp<size_t>(static_cast<size_t>(round(width)), 0, ST_MAX_ITERATIONS);
+}
+
+void streamfx::gfx::blur::kawase::set_step_scale(double_t, double_t) {}
+
+void streamfx::gfx::blur::kawase::get_step_scale(double_t&, double_t&) {}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::kawase::render()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Kawase Blur");
+#endif
+
+	auto effect = _data->get_effect();
+	if (!effect || (_iterations == 0)) {
+		return _input_texture;
+	}
+
+	streamfx::obs::gs::state::push();
+	streamfx::obs::gs::state::apply_opaque();
+
+	uint32_t width  = _input_texture->get_width();
+	uint32_t height = _input_texture->get_height();
+
+	effect.get_parameter("pImageTexel").set_float2(1.f / static_cast<float>(width), 1.f / static_cast<float>(height));
+
+	std::shared_ptr<streamfx::obs::gs::texture> tex = _input_texture;
+	for (std::size_t n = 0; n < _iterations; n++) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Iteration %" PRIuMAX, n);
+#endif
+
+		effect.get_parameter("pImage").set_texture(tex);
+		effect.get_parameter("pSize").set_float(static_cast<float>(n));
+
+		{
+			auto op = _rendertarget2->render(width, height);
+			gs_ortho(0., 1., 0., 1., 0., 1.);
+			while (gs_effect_loop(effect.get_object(), "Draw")) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+
+		std::swap(_rendertarget, _rendertarget2);
+		tex = _rendertarget->get_texture();
+	}
+
+	streamfx::obs::gs::state::pop();
+
+	return _rendertarget->get_texture();
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::kawase::get()
+{
+	return _rendertarget->get_texture();
+}
@@ -0,0 +1,99 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-checksum.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+#include "util/util-hash.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+// Size of the grid of block sums that is read back. Every texel of the input still contributes to it.
+#define ST_SIZE 16
+
+streamfx::gfx::checksum::checksum() : _effect(), _gfx_util(::streamfx::gfx::util::get()), _levels(), _readback(2)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	_effect = std::make_shared<streamfx::obs::gs::effect>(streamfx::data_file_path("effects/checksum.effect"));
+}
+
+streamfx::gfx::checksum::~checksum()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_readback.clear();
+	_levels.clear();
+	_effect.reset();
+}
+
+bool streamfx::gfx::checksum::update(std::shared_ptr<streamfx::obs::gs::texture> texture, uint64_t& result)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Checksum"};
+#endif
+
+	// Read what was staged last frame first, since the GPU has most likely finished with it by now.
+	bool updated = _readback.read([&result](streamfx::obs::gs::readback::view const& view) { result = streamfx::util::hash::plane(view.data, view.linesize, ST_SIZE * 4 * sizeof(float), ST_SIZE); });
+
+	if (!texture) {
+		return updated;
+	}
+
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	gs_enable_color(true, true, true, true);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_enable_stencil_write(false);
+	gs_set_cull_mode(GS_NEITHER);
+
+	// The first pass sums up 4x4 blocks, every further one shrinks by four until one pass fits the fixed size grid.
+	uint32_t width  = texture->get_width();
+	uint32_t height = texture->get_height();
+	auto     input  = texture;
+	for (size_t level = 0;; level++) {
+		bool last = (level > 0) && (width <= (ST_SIZE * 4)) && (height <= (ST_SIZE * 4));
+
+		uint32_t output_width  = last ? ST_SIZE : std::max<uint32_t>((width + 3) / 4, 1);
+		uint32_t output_height = last ? ST_SIZE : std::max<uint32_t>((height + 3) / 4, 1);
+
+		if (_levels.size() <= level) {
+			_levels.push_back(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA32F, GS_ZS_NONE));
+		}
+
+		{
+			auto op = _levels[level]->render(output_width, output_height);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+
+			_effect->get_parameter("image").set_texture(input);
+			if (auto p = _effect->get_parameter("pImageSize"); p) {
+				p.set_float2(static_cast<float>(width), static_cast<float>(height));
+			}
+			if (auto p = _effect->get_parameter("pImageTexel"); p) {
+				p.set_float2(1.f / static_cast<float>(width), 1.f / static_cast<float>(height));
+			}
+			while (gs_effect_loop(_effect->get_object(), (level == 0) ? "ReduceFirst" : "Reduce")) {
+				_gfx_util->draw_fullscreen_triangle();
+			}
+		}
+
+		input  = _levels[level]->get_texture();
+		width  = output_width;
+		height = output_height;
+		if (last) {
+			break;
+		}
+	}
+
+	gs_blend_state_pop();
+
+	_readback.stage(input);
+
+	return updated;
+}
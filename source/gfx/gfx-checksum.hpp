@@ -0,0 +1,43 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-readback.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Cheap checksum of the content of a texture, to tell whether it changed since the last frame.
+	 *
+	 * The texture is reduced on the GPU to a small grid of position weighted block sums, which is read back one frame
+	 * later so that nothing ever waits on the GPU, and then hashed. Equal content always gives the same checksum on
+	 * the same GPU, while different content is very likely to give a different one.
+	 */
+	class checksum {
+		std::shared_ptr<streamfx::obs::gs::effect>                    _effect;
+		std::shared_ptr<streamfx::gfx::util>                          _gfx_util;
+		std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> _levels;
+
+		streamfx::obs::gs::readback _readback;
+
+		public:
+		checksum();
+		~checksum();
+
+		/** Queue the checksum of the given texture, and retrieve the latest one that finished.
+		 *
+		 * @return true if 'result' was updated.
+		 */
+		bool update(std::shared_ptr<streamfx::obs::gs::texture> texture, uint64_t& result);
+	};
+} // namespace streamfx::gfx
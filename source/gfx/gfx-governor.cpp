@@ -0,0 +1,141 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-governor.hpp"
+#include "configuration.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <mutex>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::governor> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_GOVERNOR "Graphics.Governor"
+
+namespace {
+	constexpr float window_seconds = 1.f;
+
+	// Share of the frame interval the graphics thread may use before it counts as out of headroom, and below which it
+	// counts as having plenty again. The gap between them keeps the level from bouncing.
+	constexpr double busy_ratio = 0.95;
+	constexpr double calm_ratio = 0.75;
+
+	constexpr uint32_t calm_windows      = 5;
+	constexpr uint32_t sustained_windows = 30;
+} // namespace
+
+streamfx::gfx::governor::~governor()
+{
+	obs_remove_tick_callback(tick, this);
+}
+
+streamfx::gfx::governor::governor() : _level(0), _sustained(0), _elapsed(0), _lagged(obs_get_lagged_frames()), _calm(0), _loaded(0)
+{
+	if (auto config = streamfx::configuration::instance(); config) {
+		auto dataptr = config->get();
+		if (obs_data_has_user_value(dataptr.get(), ST_CFG_GOVERNOR) && !obs_data_get_bool(dataptr.get(), ST_CFG_GOVERNOR)) {
+			D_LOG_INFO("Disabled by the configuration.", "");
+			return;
+		}
+	}
+
+	obs_add_tick_callback(tick, this);
+}
+
+void streamfx::gfx::governor::tick(void* ptr, float seconds)
+{
+	auto self = reinterpret_cast<governor*>(ptr);
+
+	self->_elapsed += seconds;
+	if (self->_elapsed < window_seconds) {
+		return;
+	}
+	self->_elapsed = 0;
+
+	uint32_t lagged  = obs_get_lagged_frames();
+	bool     lagging = (lagged != self->_lagged);
+	self->_lagged    = lagged;
+
+	double budget = double(obs_get_frame_interval_ns());
+	double used   = double(obs_get_average_frame_time_ns());
+	bool   busy   = lagging || (used > (budget * busy_ratio));
+	bool   calm   = !lagging && (used < (budget * calm_ratio));
+
+	uint32_t level = self->_level.load();
+	if (busy) {
+		self->_calm = 0;
+		if (level < max_level) {
+			self->_level.store(++level);
+			D_LOG_DEBUG("Render load is high (%.2f of %.2f ms), shedding work at level %" PRIu32 ".", used / 1000000., budget / 1000000., level);
+		}
+	} else if (calm && (level > 0)) {
+		if (++self->_calm >= calm_windows) {
+			self->_calm = 0;
+			self->_level.store(--level);
+			D_LOG_DEBUG("Render load is low (%.2f of %.2f ms), restoring quality to level %" PRIu32 ".", used / 1000000., budget / 1000000., level);
+		}
+	} else {
+		self->_calm = 0;
+	}
+
+	if (level > 0) {
+		if (++self->_loaded >= sustained_windows) {
+			self->_loaded = 0;
+			self->_sustained.fetch_add(1);
+			D_LOG_INFO("Render load stayed high for %" PRIu32 " seconds.", sustained_windows);
+		}
+	} else {
+		self->_loaded = 0;
+	}
+}
+
+uint32_t streamfx::gfx::governor::level()
+{
+	return _level.load(std::memory_order_relaxed);
+}
+
+uint32_t streamfx::gfx::governor::sustained()
+{
+	return _sustained.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<streamfx::gfx::governor> streamfx::gfx::governor::instance()
+{
+	static std::weak_ptr<streamfx::gfx::governor> winst;
+	static std::mutex                             mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::gfx::governor>(new streamfx::gfx::governor());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::gfx::governor> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance = streamfx::gfx::governor::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::NORMAL);
@@ -0,0 +1,50 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Watches how close rendering is to the frame budget, and tells filters that opt in how much work to shed.
+	 *
+	 * The level rises by one as soon as a second passes in which frames lagged behind, or in which the graphics thread
+	 * used nearly all of the frame interval. It only falls again after a few seconds with enough headroom, so that
+	 * filters don't flip between quality levels every other frame.
+	 */
+	class governor {
+		std::atomic<uint32_t> _level;
+		std::atomic<uint32_t> _sustained;
+
+		float    _elapsed;
+		uint32_t _lagged;
+		uint32_t _calm;   // Seconds in a row with enough headroom.
+		uint32_t _loaded; // Seconds in a row at a raised level.
+
+		public:
+		static constexpr uint32_t max_level = 3;
+
+		~governor();
+
+		private:
+		governor();
+
+		static void tick(void* ptr, float seconds);
+
+		public:
+		/** How much work filters should shed right now, from 0 (none) to max_level. Always 0 if disabled. */
+		uint32_t level();
+
+		/** How many times the level stayed raised for half a minute in this session. */
+		uint32_t sustained();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::governor> instance();
+	};
+} // namespace streamfx::gfx
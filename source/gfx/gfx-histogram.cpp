@@ -0,0 +1,140 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-histogram.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+// Size of the grid of block averages that is read back. 32x32 blocks are plenty for statistics, and the read back
+// stays at 16 KiB.
+#define ST_SIZE 32
+
+static constexpr float luma_weights[3] = {0.2126f, 0.7152f, 0.0722f};
+
+float streamfx::gfx::histogram::statistics::percentile(float fraction) const
+{
+	float sum = 0.f;
+	for (size_t idx = 0; idx < bins; idx++) {
+		sum += luma[idx];
+		if (sum >= fraction) {
+			return static_cast<float>(idx + 1) / static_cast<float>(bins);
+		}
+	}
+	return 1.f;
+}
+
+streamfx::gfx::histogram::histogram() : _effect(), _gfx_util(::streamfx::gfx::util::get()), _levels(), _readback(2)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	_effect = std::make_shared<streamfx::obs::gs::effect>(streamfx::data_file_path("effects/histogram.effect"));
+}
+
+streamfx::gfx::histogram::~histogram()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_readback.clear();
+	_levels.clear();
+	_effect.reset();
+}
+
+bool streamfx::gfx::histogram::update(std::shared_ptr<streamfx::obs::gs::texture> texture, statistics& result)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Histogram"};
+#endif
+
+	// Read what was staged last frame first, since the GPU has most likely finished with it by now.
+	bool updated = _readback.read([this, &result](streamfx::obs::gs::readback::view const& view) { read(view, result); });
+
+	if (!texture) {
+		return updated;
+	}
+
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	gs_enable_color(true, true, true, true);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_enable_stencil_write(false);
+	gs_set_cull_mode(GS_NEITHER);
+
+	// Shrink by four each pass, and finish with one pass into the fixed size grid.
+	uint32_t width  = texture->get_width();
+	uint32_t height = texture->get_height();
+	auto     input  = texture;
+	for (size_t level = 0;; level++) {
+		bool last = (width <= (ST_SIZE * 4)) && (height <= (ST_SIZE * 4));
+
+		uint32_t output_width  = last ? ST_SIZE : std::max<uint32_t>((width + 3) / 4, 1);
+		uint32_t output_height = last ? ST_SIZE : std::max<uint32_t>((height + 3) / 4, 1);
+
+		if (_levels.size() <= level) {
+			_levels.push_back(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA32F, GS_ZS_NONE));
+		}
+
+		{
+			auto op = _levels[level]->render(output_width, output_height);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+
+			_effect->get_parameter("image").set_texture(input);
+			_effect->get_parameter("pImageTexel").set_float2(1.f / static_cast<float>(width), 1.f / static_cast<float>(height));
+			while (gs_effect_loop(_effect->get_object(), (level == 0) ? "ReduceFirst" : "Reduce")) {
+				_gfx_util->draw_fullscreen_triangle();
+			}
+		}
+
+		input  = _levels[level]->get_texture();
+		width  = output_width;
+		height = output_height;
+		if (last) {
+			break;
+		}
+	}
+
+	gs_blend_state_pop();
+
+	_readback.stage(input);
+
+	return updated;
+}
+
+void streamfx::gfx::histogram::read(streamfx::obs::gs::readback::view const& view, statistics& result)
+{
+	std::array<double, 3> average  = {0., 0., 0.};
+	double                log_luma = 0.;
+	result.luma.fill(0.f);
+
+	for (size_t y = 0; y < ST_SIZE; y++) {
+		const float* row = reinterpret_cast<const float*>(view.data + y * view.linesize);
+		for (size_t x = 0; x < ST_SIZE; x++) {
+			const float* px   = row + x * 4;
+			float        luma = px[0] * luma_weights[0] + px[1] * luma_weights[1] + px[2] * luma_weights[2];
+			size_t       bin  = std::min(static_cast<size_t>(std::clamp(luma, 0.f, 1.f) * static_cast<float>(bins)), bins - 1);
+
+			average[0] += px[0];
+			average[1] += px[1];
+			average[2] += px[2];
+			log_luma += px[3];
+			result.luma[bin] += 1.f;
+		}
+	}
+
+	constexpr double count = static_cast<double>(ST_SIZE * ST_SIZE);
+	for (size_t idx = 0; idx < 3; idx++) {
+		result.average[idx] = static_cast<float>(average[idx] / count);
+	}
+	result.key = static_cast<float>(std::exp2(log_luma / count));
+	for (auto& v : result.luma) {
+		v /= static_cast<float>(count);
+	}
+}
@@ -0,0 +1,57 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-readback.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <memory>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Coarse statistics of an image, for automatic corrections like white balance and exposure.
+	 *
+	 * The image is reduced on the GPU to a small grid of block averages, which is read back one frame later so that
+	 * nothing ever waits on the GPU. Everything else is derived from those blocks on the CPU.
+	 */
+	class histogram {
+		public:
+		static constexpr size_t bins = 64;
+
+		struct statistics {
+			std::array<float, 3>    average; // Average color.
+			float                   key;     // Geometric mean of the luma, which small highlights barely move.
+			std::array<float, bins> luma;    // Share of the image in each luma bin between 0 and 1.
+
+			/** Luma below which the given fraction of the image lies. */
+			float percentile(float fraction) const;
+		};
+
+		private:
+		std::shared_ptr<streamfx::obs::gs::effect>                    _effect;
+		std::shared_ptr<streamfx::gfx::util>                          _gfx_util;
+		std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> _levels;
+
+		streamfx::obs::gs::readback _readback;
+
+		public:
+		histogram();
+		~histogram();
+
+		/** Queue a reduction of the given texture, and retrieve the statistics of the latest one that finished.
+		 *
+		 * @return true if 'result' was updated.
+		 */
+		bool update(std::shared_ptr<streamfx::obs::gs::texture> texture, statistics& result);
+
+		private:
+		void read(streamfx::obs::gs::readback::view const& view, statistics& result);
+	};
+} // namespace streamfx::gfx
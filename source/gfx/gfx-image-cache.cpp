@@ -0,0 +1,134 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-image-cache.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+#include "util/util-platform.hpp"
+#include "util/utility.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+streamfx::gfx::image_cache::image::image(const std::filesystem::path& path, bool mipmaps) : _lock(), _file(), _mipmaps(mipmaps), _file_mt(std::filesystem::last_write_time(path)), _texture()
+{
+	gs_image_file_init(&_file, streamfx::util::platform::native_to_utf8(path).generic_u8string().c_str());
+	if (!_file.loaded) {
+		gs_image_file_free(&_file);
+		throw std::runtime_error("Failed to decode image.");
+	}
+}
+
+streamfx::gfx::image_cache::image::~image()
+{
+	if (_texture) {
+		auto gctx = streamfx::obs::gs::context();
+		_texture.reset();
+	}
+	gs_image_file_free(&_file);
+}
+
+std::filesystem::file_time_type streamfx::gfx::image_cache::image::last_write_time()
+{
+	return _file_mt;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::image_cache::image::texture()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	if (!_texture && _file.loaded) {
+		auto gctx = streamfx::obs::gs::context();
+
+		// Mip maps can only be built for still images with power of two dimensions.
+		if (_mipmaps && !_file.is_animated_gif && _file.texture_data && streamfx::util::math::is_power_of_two(_file.cx) && streamfx::util::math::is_power_of_two(_file.cy)) {
+			const uint8_t* data[] = {_file.texture_data};
+			_texture              = std::make_shared<streamfx::obs::gs::texture>(_file.cx, _file.cy, _file.format, 1, data, streamfx::obs::gs::texture::flags::BuildMipMaps);
+		} else {
+			gs_image_file_init_texture(&_file);
+			if (!_file.texture) {
+				throw std::runtime_error("Failed to upload image.");
+			}
+			_texture      = std::make_shared<streamfx::obs::gs::texture>(_file.texture, true);
+			_file.texture = nullptr;
+		}
+
+		// The GPU holds the only copy we need from now on.
+		gs_image_file_free(&_file);
+	}
+
+	return _texture;
+}
+
+std::shared_ptr<streamfx::gfx::image_cache> streamfx::gfx::image_cache::instance()
+{
+	static std::weak_ptr<streamfx::gfx::image_cache> _instance;
+	static std::mutex                                _mutex;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto reference = _instance.lock();
+	if (!reference) {
+		reference = std::shared_ptr<streamfx::gfx::image_cache>(new streamfx::gfx::image_cache());
+		_instance = reference;
+	}
+	return reference;
+}
+
+streamfx::gfx::image_cache::image_cache() : _lock(), _images() {}
+
+streamfx::gfx::image_cache::~image_cache() {}
+
+std::shared_ptr<streamfx::gfx::image_cache::request> streamfx::gfx::image_cache::load(const std::filesystem::path& path, bool mipmaps)
+{
+	auto request     = std::make_shared<image_cache::request>();
+	request->path    = path;
+	request->mipmaps = mipmaps;
+
+	auto self     = instance();
+	request->task = streamfx::threadpool()->push(
+		[self, request](streamfx::util::threadpool::task_data_t) {
+			try {
+				auto key     = std::make_pair(request->path.generic_u8string(), request->mipmaps);
+				auto file_mt = std::filesystem::last_write_time(request->path);
+
+				{
+					std::lock_guard<std::mutex> lock(self->_lock);
+					if (auto itr = self->_images.find(key); itr != self->_images.end()) {
+						if (auto img = itr->second.lock(); img && (img->last_write_time() == file_mt)) {
+							request->result = img;
+							return;
+						}
+					}
+				}
+
+				// Decode outside of the lock, images can take a while and do not have to wait for each other.
+				auto img = std::make_shared<image_cache::image>(request->path, request->mipmaps);
+
+				std::lock_guard<std::mutex> lock(self->_lock);
+				if (auto itr = self->_images.find(key); itr != self->_images.end()) {
+					if (auto existing = itr->second.lock(); existing && (existing->last_write_time() == img->last_write_time())) {
+						// Someone else finished the same file first.
+						request->result = existing;
+						return;
+					}
+				}
+				for (auto itr = self->_images.begin(); itr != self->_images.end();) {
+					if (itr->second.expired()) {
+						itr = self->_images.erase(itr);
+					} else {
+						++itr;
+					}
+				}
+				self->_images[key] = img;
+				request->result    = img;
+			} catch (const std::exception& ex) {
+				request->error = ex.what();
+			}
+		},
+		nullptr, streamfx::util::threadpool::priority::BACKGROUND);
+
+	return request;
+}
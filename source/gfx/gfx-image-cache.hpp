@@ -0,0 +1,74 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <graphics/image-file.h>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Process-wide cache of images loaded from disk, so that every user of the same file shares one texture.
+	 *
+	 * Images are decoded on the threadpool, and only the upload itself happens on the graphics thread. The cache only
+	 * holds weak references, so an image lives exactly as long as someone is using it.
+	 */
+	class image_cache {
+		public:
+		class image {
+			std::mutex                                  _lock;
+			gs_image_file_t                             _file;
+			bool                                        _mipmaps;
+			std::filesystem::file_time_type             _file_mt;
+			std::shared_ptr<streamfx::obs::gs::texture> _texture;
+
+			public:
+			/** Decode the given file. Does not require a graphics context, and throws if the file can't be decoded. */
+			image(const std::filesystem::path& path, bool mipmaps);
+			~image();
+
+			std::filesystem::file_time_type last_write_time();
+
+			/** GPU texture of the image, which is created on first use. Requires a graphics context. */
+			std::shared_ptr<streamfx::obs::gs::texture> texture();
+		};
+
+		/** State of an image that is being loaded in the background. Only valid to read once 'task' completed. */
+		struct request {
+			std::filesystem::path                             path;
+			bool                                              mipmaps;
+			std::shared_ptr<streamfx::util::threadpool::task> task;
+			std::shared_ptr<image_cache::image>               result;
+			std::string                                       error;
+		};
+
+		private:
+		std::mutex                                                   _lock;
+		std::map<std::pair<std::string, bool>, std::weak_ptr<image>> _images;
+
+		public:
+		static std::shared_ptr<image_cache> instance();
+
+		private:
+		image_cache();
+
+		public:
+		~image_cache();
+
+		/** Load an image on the threadpool, or share the one already loaded if the file did not change since.
+		 *
+		 * Nothing is called back on completion, so an unwanted request can simply be dropped.
+		 */
+		std::shared_ptr<request> load(const std::filesystem::path& path, bool mipmaps);
+	};
+} // namespace streamfx::gfx
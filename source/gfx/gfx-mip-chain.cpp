@@ -0,0 +1,83 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-mip-chain.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include "warning-enable.hpp"
+
+// Chains that haven't been used for this long are released. In nanoseconds.
+#define ST_CHAIN_EXPIRY 1000000000ull
+
+streamfx::gfx::mip_chain::mip_chain() : _lock(), _mipmapper(), _entries() {}
+
+streamfx::gfx::mip_chain::~mip_chain()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_entries.clear();
+}
+
+uint32_t streamfx::gfx::mip_chain::calculate_max_mip_level(uint32_t width, uint32_t height)
+{
+	return _mipmapper.calculate_max_mip_level(width, height);
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::mip_chain::get(obs_source_t* source, std::shared_ptr<streamfx::obs::gs::texture> texture, uint32_t levels, bool changed)
+{
+	if (!texture) {
+		return nullptr;
+	}
+
+	uint32_t width  = texture->get_width();
+	uint32_t height = texture->get_height();
+	uint64_t frame  = obs_get_video_frame_time();
+	key_t    key{source, width, height, texture->get_color_format()};
+
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// Release whatever nobody asked for in a while, as full mip chains are not small.
+	for (auto kv = _entries.begin(); kv != _entries.end();) {
+		if ((frame - kv->second.frame) > ST_CHAIN_EXPIRY) {
+			kv = _entries.erase(kv);
+		} else {
+			kv++;
+		}
+	}
+
+	auto& entry = _entries[key];
+	if (!entry.texture) {
+		entry.texture = std::make_shared<streamfx::obs::gs::texture>(width, height, std::get<3>(key), calculate_max_mip_level(width, height), nullptr, streamfx::obs::gs::texture::flags::None);
+		entry.levels  = 0;
+		entry.frame   = frame - 1;
+	}
+
+	// Someone else already built enough of it during this frame, or nothing changed since the last time.
+	bool same_source = (entry.built_from == texture->get_object()) && !changed;
+	if (((entry.frame == frame) || same_source) && (entry.levels >= levels)) {
+		entry.frame = frame;
+		return entry.texture;
+	}
+
+	_mipmapper.rebuild(texture, entry.texture, levels);
+	entry.built_from = texture->get_object();
+	entry.levels     = levels;
+	entry.frame      = frame;
+	return entry.texture;
+}
+
+std::shared_ptr<streamfx::gfx::mip_chain> streamfx::gfx::mip_chain::instance()
+{
+	static std::weak_ptr<streamfx::gfx::mip_chain> winst;
+	static std::mutex                              mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::gfx::mip_chain>(new streamfx::gfx::mip_chain());
+		winst    = instance;
+	}
+	return instance;
+}
@@ -0,0 +1,55 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx/gfx-mipmapper.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Mip chains of sources, built at most once per frame no matter how many users need them.
+	 *
+	 * The first user in a frame hands in its capture of the source and has the chain built from it, everyone asking
+	 * for the same source and size after that gets the same chain back. It must be treated as read-only.
+	 */
+	class mip_chain {
+		struct entry {
+			std::shared_ptr<streamfx::obs::gs::texture> texture;
+			gs_texture_t*                               built_from;
+			uint64_t                                    frame;
+			uint32_t                                    levels;
+		};
+
+		typedef std::tuple<obs_source_t*, uint32_t, uint32_t, gs_color_format> key_t;
+
+		std::mutex               _lock;
+		streamfx::gfx::mipmapper _mipmapper;
+		std::map<key_t, entry>   _entries;
+
+		mip_chain();
+
+		public:
+		~mip_chain();
+
+		uint32_t calculate_max_mip_level(uint32_t width, uint32_t height);
+
+		/** Mip chain of 'source' with at least 'levels' levels, built from 'texture' if nobody else did so this frame.
+		 *
+		 * @param texture A capture of 'source' from this frame, with a power of two size.
+		 * @param changed Whether 'texture' has new content since it was last handed in. Chains built from unchanged
+		 *                content are kept as they are.
+		 */
+		std::shared_ptr<streamfx::obs::gs::texture> get(obs_source_t* source, std::shared_ptr<streamfx::obs::gs::texture> texture, uint32_t levels, bool changed = true);
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::gfx::mip_chain> instance();
+	};
+} // namespace streamfx::gfx
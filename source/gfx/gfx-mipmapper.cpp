@@ -41,6 +41,36 @@ void d3d_copy_subregion(d3d_info& info, std::shared_ptr<streamfx::obs::gs::textu
 	info.context->CopySubresourceRegion(info.target, mip_level, 0, 0, 0, source_ref, 0, &box);
 }
 
+bool d3d_generate_mips(d3d_info& info, uint32_t levels)
+{
+	// Only textures created for it can have their mip chain built by the driver.
+	ID3D11Texture2D* texture = nullptr;
+	if (FAILED(info.target->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&texture)))) {
+		return false;
+	}
+	D3D11_TEXTURE2D_DESC desc;
+	texture->GetDesc(&desc);
+	texture->Release();
+	if (((desc.MiscFlags & D3D11_RESOURCE_MISC_GENERATE_MIPS) == 0) || ((desc.BindFlags & D3D11_BIND_RENDER_TARGET) == 0) || ((desc.BindFlags & D3D11_BIND_SHADER_RESOURCE) == 0)) {
+		return false;
+	}
+
+	// GenerateMips only touches the levels visible through the view.
+	D3D11_SHADER_RESOURCE_VIEW_DESC view_desc = {};
+	view_desc.Format                          = desc.Format;
+	view_desc.ViewDimension                   = D3D11_SRV_DIMENSION_TEXTURE2D;
+	view_desc.Texture2D.MostDetailedMip       = 0;
+	view_desc.Texture2D.MipLevels             = std::min<UINT>(levels, desc.MipLevels);
+
+	ID3D11ShaderResourceView* view = nullptr;
+	if (FAILED(info.device->CreateShaderResourceView(info.target, &view_desc, &view))) {
+		return false;
+	}
+	info.context->GenerateMips(view);
+	view->Release();
+	return true;
+}
+
 #endif
 
 struct opengl_info {
@@ -162,6 +192,19 @@ void opengl_copy_subregion(opengl_info& info, std::shared_ptr<streamfx::obs::gs:
 	D_OPENGL_CHECK_ERROR("glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);");
 }
 
+bool opengl_generate_mips(opengl_info& info, uint32_t levels)
+{
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, info.target);
+	// Limits both generation and sampling to the levels that are actually built.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels - 1));
+	glGenerateMipmap(GL_TEXTURE_2D);
+	bool success = (glGetError() == GL_NO_ERROR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	return success;
+}
+
 streamfx::gfx::mipmapper::~mipmapper()
 {
 	_rt.reset();
@@ -187,7 +230,7 @@ uint32_t streamfx::gfx::mipmapper::calculate_max_mip_level(uint32_t width, uint3
 	return static_cast<uint32_t>(1 + std::lroundl(floor(log2(std::max<GLint>(static_cast<GLint>(width), static_cast<GLint>(height))))));
 }
 
-void streamfx::gfx::mipmapper::rebuild(std::shared_ptr<streamfx::obs::gs::texture> source, std::shared_ptr<streamfx::obs::gs::texture> target)
+void streamfx::gfx::mipmapper::rebuild(std::shared_ptr<streamfx::obs::gs::texture> source, std::shared_ptr<streamfx::obs::gs::texture> target, uint32_t levels)
 {
 	{ // Validate arguments and structure.
 		if (!source || !target)
@@ -236,7 +279,7 @@ void streamfx::gfx::mipmapper::rebuild(std::shared_ptr<streamfx::obs::gs::textur
 	if (source->get_type() == streamfx::obs::gs::texture::type::Normal) {
 		uint32_t width         = source->get_width();
 		uint32_t height        = source->get_height();
-		size_t   max_mip_level = calculate_max_mip_level(width, height);
+		size_t   max_mip_level = std::clamp<size_t>(levels, 1, calculate_max_mip_level(width, height));
 
 		{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -254,60 +297,73 @@ void streamfx::gfx::mipmapper::rebuild(std::shared_ptr<streamfx::obs::gs::textur
 			}
 		}
 
-		// Set up rendering state.
-		gs_blend_state_push();
-		gs_reset_blend_state();
-		gs_enable_blending(false);
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-		gs_enable_color(true, true, true, true);
-		gs_enable_depth_test(false);
-		gs_enable_stencil_test(false);
-		gs_enable_stencil_write(false);
-		gs_set_cull_mode(GS_NEITHER);
-
-		// sRGB support.
-		bool old_srgb = gs_framebuffer_srgb_enabled();
-		gs_enable_framebuffer_srgb(gs_get_linear_srgb());
-
-		// Render each mip map level.
-		for (size_t mip = 1; mip < max_mip_level; mip++) {
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-			auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Mip Level %" PRIuMAX, mip);
+		// Let the driver build the whole chain in a single call where possible, instead of a render target switch
+		// and a copy for every level.
+		bool generated = false;
+#ifdef _WIN32
+		if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+			generated = d3d_generate_mips(d3dinfo, static_cast<uint32_t>(max_mip_level));
+		}
 #endif
+		if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+			generated = opengl_generate_mips(oglinfo, static_cast<uint32_t>(max_mip_level));
+		}
 
-			uint32_t cwidth  = std::max<uint32_t>(width >> mip, 1);
-			uint32_t cheight = std::max<uint32_t>(height >> mip, 1);
-			float_t  iwidth  = 1.f / static_cast<float_t>(cwidth);
-			float_t  iheight = 1.f / static_cast<float_t>(cheight);
-
-			try {
-				auto op = _rt->render(cwidth, cheight);
-				gs_ortho(0, 1, 0, 1, 0, 1);
+		if (!generated) {
+			// Set up rendering state.
+			gs_blend_state_push();
+			gs_reset_blend_state();
+			gs_enable_blending(false);
+			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+			gs_enable_color(true, true, true, true);
+			gs_enable_depth_test(false);
+			gs_enable_stencil_test(false);
+			gs_enable_stencil_write(false);
+			gs_set_cull_mode(GS_NEITHER);
+
+			// sRGB support.
+			bool old_srgb = gs_framebuffer_srgb_enabled();
+			gs_enable_framebuffer_srgb(gs_get_linear_srgb());
+
+			// Render each mip map level.
+			for (size_t mip = 1; mip < max_mip_level; mip++) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+				auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Mip Level %" PRIuMAX, mip);
+#endif
 
-				_effect.get_parameter("image").set_texture(target, gs_get_linear_srgb());
-				_effect.get_parameter("imageTexel").set_float2(iwidth, iheight);
-				_effect.get_parameter("level").set_int(int32_t(mip - 1));
-				while (gs_effect_loop(_effect.get_object(), "Draw")) {
-					_gfx_util->draw_fullscreen_triangle();
+				uint32_t cwidth  = std::max<uint32_t>(width >> mip, 1);
+				uint32_t cheight = std::max<uint32_t>(height >> mip, 1);
+				float_t  iwidth  = 1.f / static_cast<float_t>(cwidth);
+				float_t  iheight = 1.f / static_cast<float_t>(cheight);
+
+				try {
+					auto op = _rt->render(cwidth, cheight);
+					gs_ortho(0, 1, 0, 1, 0, 1);
+
+					_effect.get_parameter("image").set_texture(target, gs_get_linear_srgb());
+					_effect.get_parameter("imageTexel").set_float2(iwidth, iheight);
+					_effect.get_parameter("level").set_int(int32_t(mip - 1));
+					while (gs_effect_loop(_effect.get_object(), "Draw")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				} catch (...) {
 				}
-			} catch (...) {
-			}
 
-			// Copy from the render target to the target mip level.
+				// Copy from the render target to the target mip level.
 #ifdef _WIN32
-			if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
-				d3d_copy_subregion(d3dinfo, _rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
-			}
+				if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+					d3d_copy_subregion(d3dinfo, _rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
+				}
 #endif
-			if (gs_get_device_type() == GS_DEVICE_OPENGL) {
-				opengl_copy_subregion(oglinfo, _rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
+				if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+					opengl_copy_subregion(oglinfo, _rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
+				}
 			}
-		}
-
-		// Clean up rendering state.
-		gs_enable_framebuffer_srgb(old_srgb);
-		gs_blend_state_pop();
 
+			// Clean up rendering state.
+			gs_enable_framebuffer_srgb(old_srgb);
+			gs_blend_state_pop();
+		}
 	} else {
 		throw std::runtime_error("Only 2D Textures support Mip-mapping.");
 	}
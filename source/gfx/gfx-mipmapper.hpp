@@ -34,6 +34,10 @@ namespace streamfx::gfx {
 
 		uint32_t calculate_max_mip_level(uint32_t width, uint32_t height);
 
-		void rebuild(std::shared_ptr<streamfx::obs::gs::texture> source, std::shared_ptr<streamfx::obs::gs::texture> target);
+		/** Copy source into the top level of target and rebuild the mip levels below it.
+		 *
+		 * @param levels How many levels, including the top one, are needed. Deeper levels are left untouched.
+		 */
+		void rebuild(std::shared_ptr<streamfx::obs::gs::texture> source, std::shared_ptr<streamfx::obs::gs::texture> target, uint32_t levels = std::numeric_limits<uint32_t>::max());
 	};
 } // namespace streamfx::gfx
@@ -0,0 +1,61 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-precision.hpp"
+#include "configuration.hpp"
+#include "strings.hpp"
+
+#define ST_CFG_PRECISION "Graphics.Precision"
+#define ST_I18N_PRECISION_FULL "Precision.Full"
+#define ST_I18N_PRECISION_HALF "Precision.Half"
+
+streamfx::gfx::precision streamfx::gfx::resolve_precision(precision policy)
+{
+	if (policy != precision::Default) {
+		return policy;
+	}
+
+	if (auto config = streamfx::configuration::instance(); config) {
+		auto dataptr = config->get();
+		if (obs_data_has_user_value(dataptr.get(), ST_CFG_PRECISION)) {
+			auto value = static_cast<precision>(obs_data_get_int(dataptr.get(), ST_CFG_PRECISION));
+			if ((value == precision::Full) || (value == precision::Half)) {
+				return value;
+			}
+		}
+	}
+	return precision::Automatic;
+}
+
+gs_color_format streamfx::gfx::precision_format(precision policy, uint8_t channels, bool half_suffices)
+{
+	bool half = false;
+	switch (resolve_precision(policy)) {
+	case precision::Half:
+		half = true;
+		break;
+	case precision::Automatic:
+		half = half_suffices;
+		break;
+	default:
+		break;
+	}
+
+	switch (channels) {
+	case 1:
+		return half ? GS_R16F : GS_R32F;
+	case 2:
+		return half ? GS_RG16F : GS_RG32F;
+	default:
+		return half ? GS_RGBA16F : GS_RGBA32F;
+	}
+}
+
+void streamfx::gfx::precision_properties(obs_property_t* p)
+{
+	obs_property_list_add_int(p, D_TRANSLATE(S_STATE_DEFAULT), static_cast<int64_t>(precision::Default));
+	obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(precision::Automatic));
+	obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PRECISION_FULL), static_cast<int64_t>(precision::Full));
+	obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PRECISION_HALF), static_cast<int64_t>(precision::Half));
+}
@@ -0,0 +1,34 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdint>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Precision of intermediate render targets that hold more than plain colors, like distances or coordinates. */
+	enum class precision : int64_t {
+		Default   = -1, // Use the global setting.
+		Automatic = 0,  // Use half precision where the stored values still fit.
+		Full      = 1,
+		Half      = 2,
+	};
+
+	/** Resolve 'Default' to the global setting, which is stored in the configuration. */
+	precision resolve_precision(precision policy);
+
+	/** Pick a floating point color format for an intermediate render target.
+	 *
+	 * @param policy Precision policy of the user of the render target.
+	 * @param channels Number of channels actually needed, which can be 1, 2 or 4.
+	 * @param half_suffices If half precision is enough for the values that will be stored.
+	 */
+	gs_color_format precision_format(precision policy, uint8_t channels, bool half_suffices);
+
+	/** Fill an integer list property with the choices of the precision policy. */
+	void precision_properties(obs_property_t* p);
+} // namespace streamfx::gfx
@@ -0,0 +1,146 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-quality.hpp"
+#include "configuration.hpp"
+#include "gfx/gfx-governor.hpp"
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-readback.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <mutex>
+#include <optional>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::quality> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_QUALITY_TIER "Graphics.QualityTier"
+
+namespace {
+	constexpr uint32_t probe_width  = 1920;
+	constexpr uint32_t probe_height = 1080;
+	constexpr size_t   probe_warmup = 4;
+	constexpr size_t   probe_passes = 32;
+
+	// Average time of a single 1080p pass, below which a GPU counts as fast enough for the next tier. A dedicated GPU
+	// copies a 1080p target in well under a quarter millisecond, while integrated GPUs share their memory bandwidth.
+	constexpr double probe_high_ms     = 0.25;
+	constexpr double probe_balanced_ms = 1.00;
+
+	std::mutex                                 measure_lock;
+	std::optional<streamfx::gfx::quality_tier> measured;
+
+	void passes(std::shared_ptr<streamfx::obs::gs::rendertarget> (&targets)[2], size_t count)
+	{
+		auto         gfx  = streamfx::gfx::util::get();
+		gs_effect_t* copy = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		for (size_t idx = 0; idx < count; idx++) {
+			auto& source = targets[idx % 2];
+			auto& target = targets[(idx + 1) % 2];
+
+			auto op = target->render(probe_width, probe_height);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			gs_effect_set_texture(gs_effect_get_param_by_name(copy, "image"), source->get_texture()->get_object());
+			while (gs_effect_loop(copy, "Draw")) {
+				gfx->draw_fullscreen_triangle();
+			}
+		}
+	}
+
+	// Reading a pixel back forces the GPU to finish everything queued before it.
+	void synchronize(streamfx::obs::gs::readback& readback, std::shared_ptr<streamfx::obs::gs::rendertarget> const& target)
+	{
+		readback.stage(target->get_texture());
+		readback.read([](streamfx::obs::gs::readback::view const&) {}, true);
+	}
+
+	streamfx::gfx::quality_tier measure()
+	{
+		try {
+			auto gctx = streamfx::obs::gs::context();
+
+			std::shared_ptr<streamfx::obs::gs::rendertarget> targets[2] = {
+				std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE),
+				std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE),
+			};
+			streamfx::obs::gs::readback readback{1};
+
+			gs_blend_state_push();
+			gs_reset_blend_state();
+			gs_enable_blending(false);
+
+			// The first passes also pay for allocating the render targets, so they are not counted.
+			passes(targets, probe_warmup);
+			synchronize(readback, targets[probe_warmup % 2]);
+
+			auto begin = std::chrono::high_resolution_clock::now();
+			passes(targets, probe_passes);
+			synchronize(readback, targets[(probe_warmup + probe_passes) % 2]);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			gs_blend_state_pop();
+
+			double ms = std::chrono::duration<double, std::milli>(end - begin).count() / double(probe_passes);
+			auto   tier = (ms <= probe_high_ms) ? streamfx::gfx::quality_tier::High : ((ms <= probe_balanced_ms) ? streamfx::gfx::quality_tier::Balanced : streamfx::gfx::quality_tier::Low);
+			D_LOG_INFO("GPU needs %.3f ms per 1080p pass, picking quality tier %" PRId64 ".", ms, static_cast<int64_t>(tier));
+			return tier;
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("Failed to measure the GPU, assuming the balanced quality tier: %s", ex.what());
+			return streamfx::gfx::quality_tier::Balanced;
+		}
+	}
+
+	streamfx::gfx::quality_tier measured_tier()
+	{
+		std::lock_guard<std::mutex> lock(measure_lock);
+		if (measured) {
+			return measured.value();
+		}
+
+		auto config = streamfx::configuration::instance();
+		if (auto value = config->get_measurement(ST_CFG_QUALITY_TIER); value && (value.value() >= static_cast<int64_t>(streamfx::gfx::quality_tier::Low)) && (value.value() <= static_cast<int64_t>(streamfx::gfx::quality_tier::High))) {
+			measured = static_cast<streamfx::gfx::quality_tier>(value.value());
+		} else {
+			measured = measure();
+			config->set_measurement(ST_CFG_QUALITY_TIER, static_cast<int64_t>(measured.value()));
+		}
+		return measured.value();
+	}
+} // namespace
+
+streamfx::gfx::quality_tier streamfx::gfx::resolve_quality_tier()
+{
+	if (auto config = streamfx::configuration::instance(); config) {
+		auto dataptr = config->get();
+		if (obs_data_has_user_value(dataptr.get(), ST_CFG_QUALITY_TIER)) {
+			auto value = static_cast<quality_tier>(obs_data_get_int(dataptr.get(), ST_CFG_QUALITY_TIER));
+			if ((value == quality_tier::Low) || (value == quality_tier::Balanced) || (value == quality_tier::High)) {
+				return value;
+			}
+		}
+	}
+
+	// Every half minute of sustained load steps down one tier for the rest of the session. The steps are not stored, as
+	// the load may well be different next time.
+	auto tier = static_cast<int64_t>(measured_tier()) - static_cast<int64_t>(streamfx::gfx::governor::instance()->sustained());
+	return static_cast<quality_tier>(std::max<int64_t>(tier, static_cast<int64_t>(quality_tier::Low)));
+}
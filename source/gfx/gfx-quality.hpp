@@ -0,0 +1,27 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdint>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** How much GPU time filters should spend by default, which picks the defaults of newly created filters. */
+	enum class quality_tier : int64_t {
+		Automatic = -1, // Measure the GPU once per version, and step down while frames keep lagging.
+		Low       = 0,
+		Balanced  = 1,
+		High      = 2,
+	};
+
+	/** Resolve the global setting, which is stored in the configuration, to an actual tier.
+	 *
+	 * If the setting is 'Automatic', the GPU is measured on first use with a short series of full screen passes. The
+	 * result is kept in the configuration so later sessions skip the measurement.
+	 */
+	quality_tier resolve_quality_tier();
+} // namespace streamfx::gfx
@@ -0,0 +1,62 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-rendertarget-pool.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+// Targets that were not used for this long are freed on the next acquire.
+#define ST_EXPIRY std::chrono::seconds(5)
+
+streamfx::gfx::rendertarget_pool::rendertarget_pool() : _lock(), _entries() {}
+
+streamfx::gfx::rendertarget_pool::~rendertarget_pool()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_entries.clear();
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::rendertarget_pool::acquire(gs_color_format format, uint32_t width, uint32_t height)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	auto                         now = std::chrono::steady_clock::now();
+
+	// Free what nobody needed in a while.
+	_entries.remove_if([now](const entry& v) { return (v.target.use_count() == 1) && ((now - v.used) > ST_EXPIRY); });
+
+	// An exact match avoids reallocating the texture, otherwise any free target of the same format will do.
+	entry* found = nullptr;
+	for (auto& v : _entries) {
+		if ((v.target.use_count() != 1) || (v.target->get_color_format() != format)) {
+			continue;
+		}
+		if ((v.width == width) && (v.height == height)) {
+			found = &v;
+			break;
+		} else if (!found) {
+			found = &v;
+		}
+	}
+
+	if (!found) {
+		found = &_entries.emplace_back(entry{std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE), width, height, now});
+	}
+	found->width  = width;
+	found->height = height;
+	found->used   = now;
+	return found->target;
+}
+
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::rendertarget_pool::get()
+{
+	static std::weak_ptr<streamfx::gfx::rendertarget_pool> instance;
+	static std::mutex                                      lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::rendertarget_pool>(new streamfx::gfx::rendertarget_pool());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
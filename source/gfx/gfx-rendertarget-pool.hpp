@@ -0,0 +1,49 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Render targets for intermediate results that only live for the duration of a single render.
+	 *
+	 * A target is in use for as long as anyone other than the pool holds on to it, and is handed out again once it
+	 * was released. Several effects rendering one after another thus share the same few targets, instead of each one
+	 * keeping its own full size copies around. Targets that have not been used for a while are freed.
+	 */
+	class rendertarget_pool {
+		struct entry {
+			std::shared_ptr<streamfx::obs::gs::rendertarget> target;
+			uint32_t                                         width;
+			uint32_t                                         height;
+			std::chrono::steady_clock::time_point            used;
+		};
+
+		std::mutex       _lock;
+		std::list<entry> _entries;
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::rendertarget_pool> get();
+
+		private:
+		rendertarget_pool();
+
+		public:
+		~rendertarget_pool();
+
+		/** Acquire a target of the given format, preferring one that already has the given size.
+		 *
+		 * Must be called from within a graphics context, and the target must be released once the render is done.
+		 */
+		std::shared_ptr<streamfx::obs::gs::rendertarget> acquire(gs_color_format format, uint32_t width, uint32_t height);
+	};
+} // namespace streamfx::gfx
@@ -0,0 +1,180 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-shared-output.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-logging.hpp"
+#include "util/util-platform.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#ifdef D_PLATFORM_WINDOWS
+#include <Windows.h>
+#include <dxgiformat.h>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::shared_output> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#ifdef D_PLATFORM_WINDOWS
+static uint32_t get_dxgi_format(gs_color_format format)
+{
+	switch (format) {
+	case GS_RGBA:
+		return DXGI_FORMAT_R8G8B8A8_UNORM;
+	case GS_BGRA:
+		return DXGI_FORMAT_B8G8R8A8_UNORM;
+	case GS_R10G10B10A2:
+		return DXGI_FORMAT_R10G10B10A2_UNORM;
+	case GS_RGBA16F:
+		return DXGI_FORMAT_R16G16B16A16_FLOAT;
+	case GS_RGBA32F:
+		return DXGI_FORMAT_R32G32B32A32_FLOAT;
+	default:
+		return DXGI_FORMAT_UNKNOWN;
+	}
+}
+#endif
+
+streamfx::gfx::shared_output::~shared_output()
+{
+#ifdef D_PLATFORM_WINDOWS
+	if (_header) {
+		UnmapViewOfFile(_header);
+	}
+	if (_mapping) {
+		CloseHandle(reinterpret_cast<HANDLE>(_mapping));
+	}
+#endif
+
+	auto gctx = streamfx::obs::gs::context();
+	_ring.clear();
+}
+
+streamfx::gfx::shared_output::shared_output(std::string_view name, size_t count) : _name(name), _count(std::clamp<size_t>(count, 1, max_ring)), _ring(), _next(0), _sequence(0), _mapping(nullptr), _header(nullptr)
+{
+	if (!is_supported()) {
+		throw std::runtime_error("Sharing textures requires Direct3D 11.");
+	}
+
+#ifdef D_PLATFORM_WINDOWS
+	auto path = ::streamfx::util::platform::utf8_to_native("Local\\StreamFX.SharedOutput." + _name);
+	_mapping  = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(header), path.c_str());
+	if (!_mapping) {
+		throw std::runtime_error("Failed to create file mapping.");
+	} else if (GetLastError() == ERROR_ALREADY_EXISTS) {
+		CloseHandle(reinterpret_cast<HANDLE>(_mapping));
+		_mapping = nullptr;
+		throw std::runtime_error("Another output already uses this name.");
+	}
+
+	void* view = MapViewOfFile(reinterpret_cast<HANDLE>(_mapping), FILE_MAP_ALL_ACCESS, 0, 0, sizeof(header));
+	if (!view) {
+		CloseHandle(reinterpret_cast<HANDLE>(_mapping));
+		_mapping = nullptr;
+		throw std::runtime_error("Failed to map file mapping.");
+	}
+
+	_header          = new (view) header{};
+	_header->magic   = magic;
+	_header->version = version;
+	_header->count   = 0;
+#endif
+
+	D_LOG_DEBUG("Publishing '%s' with %zu textures.", _name.c_str(), _count);
+}
+
+std::string_view streamfx::gfx::shared_output::name()
+{
+	return _name;
+}
+
+bool streamfx::gfx::shared_output::publish(gs_texture_t* texture, uint64_t timestamp)
+{
+#ifdef D_PLATFORM_WINDOWS
+	auto gctx = streamfx::obs::gs::context();
+
+	uint32_t        width  = gs_texture_get_width(texture);
+	uint32_t        height = gs_texture_get_height(texture);
+	gs_color_format format = gs_texture_get_color_format(texture);
+	if (_ring.empty() || (_ring[0]->get_width() != width) || (_ring[0]->get_height() != height) || (_ring[0]->get_color_format() != format)) {
+		reset(width, height, format);
+	}
+
+	// Skip over textures a consumer is still reading from, which costs the consumer at most its oldest frames.
+	for (size_t tries = 0; tries < _ring.size(); tries++) {
+		size_t idx = _next;
+		_next      = (_next + 1) % _ring.size();
+
+		gs_texture_t* slot = _ring[idx]->get_object();
+		if (gs_texture_acquire_sync(slot, 0, 0) != 0) {
+			continue;
+		}
+		gs_copy_texture(slot, texture);
+		gs_texture_release_sync(slot, 0);
+
+		_header->timestamps[idx] = timestamp;
+		_header->latest.store((++_sequence << 8) | static_cast<uint64_t>(idx), std::memory_order_release);
+		return true;
+	}
+#endif
+	return false;
+}
+
+bool streamfx::gfx::shared_output::is_supported()
+{
+#ifdef D_PLATFORM_WINDOWS
+	auto gctx = streamfx::obs::gs::context();
+	return gs_get_device_type() == GS_DEVICE_DIRECT3D_11;
+#else
+	return false;
+#endif
+}
+
+void streamfx::gfx::shared_output::reset(uint32_t width, uint32_t height, gs_color_format format)
+{
+#ifdef D_PLATFORM_WINDOWS
+	// Tell consumers to let go before the old textures disappear.
+	_header->count = 0;
+	_header->latest.store(0, std::memory_order_release);
+	_header->generation.fetch_add(1, std::memory_order_acq_rel);
+	_ring.clear();
+
+	_ring.reserve(_count);
+	for (size_t idx = 0; idx < _count; idx++) {
+		auto tex = std::make_shared<streamfx::obs::gs::texture>(width, height, format, 1, nullptr, streamfx::obs::gs::texture::flags::GlobalShared);
+
+		// libobs hands out keyed mutex textures already acquired with key 0.
+		gs_texture_release_sync(tex->get_object(), 0);
+
+		_header->handles[idx]    = gs_texture_get_shared_handle(tex->get_object());
+		_header->timestamps[idx] = 0;
+		_ring.push_back(tex);
+	}
+	_next     = 0;
+	_sequence = 0;
+
+	_header->width  = width;
+	_header->height = height;
+	_header->format = get_dxgi_format(format);
+	_header->count  = static_cast<uint32_t>(_count);
+	_header->generation.fetch_add(1, std::memory_order_acq_rel);
+
+	D_LOG_DEBUG("Resized '%s' to %" PRIu32 "x%" PRIu32 ".", _name.c_str(), width, height);
+#endif
+}
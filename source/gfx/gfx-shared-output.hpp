@@ -0,0 +1,83 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Publish textures to other processes, without a round trip through system memory.
+	 *
+	 * Every frame is copied into the next free texture of a small ring of keyed mutex textures. Their legacy D3D11
+	 * handles can be opened by any process with ID3D11Device::OpenSharedResource, and are listed together with the
+	 * newest frame in the named file mapping "Local\StreamFX.SharedOutput.<name>", laid out as a 'header'.
+	 *
+	 * Consumers acquire and release a texture with key 0 and should hold it no longer than a copy takes, as textures
+	 * that are still held are skipped over.
+	 */
+	class shared_output {
+		public:
+		static constexpr uint32_t magic    = 0x53584653; // 'SFXS'
+		static constexpr uint32_t version  = 1;
+		static constexpr size_t   max_ring = 8;
+
+		struct header {
+			uint32_t magic;
+			uint32_t version;
+
+			// Incremented whenever the ring is created anew, after which every other field must be read again.
+			std::atomic<uint32_t> generation;
+
+			uint32_t width;
+			uint32_t height;
+			uint32_t format; // DXGI_FORMAT of every texture in the ring.
+			uint32_t count;
+			uint32_t handles[max_ring];
+
+			// Frame time of the frame in each texture, in nanoseconds.
+			uint64_t timestamps[max_ring];
+
+			// Frames published so far in the upper 56 bits, the texture that holds the newest in the lower 8 bits.
+			std::atomic<uint64_t> latest;
+		};
+
+		private:
+		std::string _name;
+		size_t      _count;
+
+		std::vector<std::shared_ptr<streamfx::obs::gs::texture>> _ring;
+		size_t                                                   _next;
+		uint64_t                                                 _sequence;
+
+		void*   _mapping;
+		header* _header;
+
+		public:
+		~shared_output();
+		shared_output(std::string_view name, size_t count);
+
+		std::string_view name();
+
+		/** Copy 'texture' into the ring and announce it to consumers.
+		 *
+		 * @return false if every texture in the ring was held by a consumer, in which case the frame is dropped.
+		 */
+		bool publish(gs_texture_t* texture, uint64_t timestamp);
+
+		public:
+		/** Only Direct3D 11 can hand textures to other processes, libobs has no way to export a DMA-BUF. */
+		static bool is_supported();
+
+		private:
+		void reset(uint32_t width, uint32_t height, gs_color_format format);
+	};
+} // namespace streamfx::gfx
@@ -7,9 +7,119 @@
 #include "obs/obs-tools.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
 #include <stdexcept>
+#include <tuple>
 #include "warning-enable.hpp"
 
+// Renders that haven't been used for this long are released. In nanoseconds.
+#define ST_CACHE_EXPIRY 1000000000ull
+// Largest atlas that is created, sources beyond this are left out.
+#define ST_ATLAS_MAX_SIZE 8192u
+// Empty texels between regions of an atlas.
+#define ST_ATLAS_PADDING 1u
+
+namespace {
+	struct cached_render {
+		std::shared_ptr<streamfx::obs::gs::rendertarget> rt;
+		streamfx::obs::gs::texture                       texture{nullptr};
+		uint64_t                                         frame;
+	};
+
+	typedef std::tuple<obs_source_t*, uint32_t, uint32_t, gs_color_format, gs_color_space, bool, bool, bool> cache_key_t;
+
+	struct cached_atlas {
+		std::shared_ptr<streamfx::obs::gs::rendertarget> rt;
+		streamfx::obs::gs::texture                       texture{nullptr};
+		uint64_t                                         frame;
+		uint32_t                                         width;
+		uint32_t                                         height;
+		std::vector<std::array<uint32_t, 4>>             rects;
+	};
+
+	typedef std::tuple<std::vector<std::tuple<obs_source_t*, uint32_t, uint32_t>>, gs_color_format, gs_color_space, bool, bool, bool> atlas_key_t;
+
+	std::mutex                                            cache_lock;
+	std::map<cache_key_t, std::shared_ptr<cached_render>> cache;
+	std::map<atlas_key_t, std::shared_ptr<cached_atlas>>  atlas_cache;
+
+	template<typename T>
+	void expire(T& map, uint64_t frame)
+	{
+		for (auto kv = map.begin(); kv != map.end();) {
+			if ((frame - kv->second->frame) > ST_CACHE_EXPIRY) {
+				kv = map.erase(kv);
+			} else {
+				kv++;
+			}
+		}
+	}
+
+	// The result is shared with other users, so it can't depend on the state of whoever rendered it first.
+	void push_render_state(bool blend)
+	{
+		gs_blend_state_push();
+		gs_reset_blend_state();
+		if (!blend) {
+			gs_enable_blending(false);
+			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+		}
+		gs_enable_color(true, true, true, true);
+		gs_set_cull_mode(GS_NEITHER);
+		gs_enable_depth_test(false);
+		gs_enable_stencil_test(false);
+		gs_enable_stencil_write(false);
+	}
+
+	// Tallest first onto shelves about as wide as a square atlas would be, which is plenty for similarly sized sources.
+	void pack_atlas(std::vector<streamfx::gfx::source_texture::atlas_entry> const& entries, cached_atlas& atlas)
+	{
+		uint64_t area   = 0;
+		uint32_t widest = 1;
+		for (auto const& entry : entries) {
+			area += static_cast<uint64_t>(entry.width + ST_ATLAS_PADDING) * (entry.height + ST_ATLAS_PADDING);
+			widest = std::max(widest, entry.width);
+		}
+		uint32_t row = std::clamp(static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(area)))), widest, ST_ATLAS_MAX_SIZE);
+
+		std::vector<size_t> order(entries.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&entries](size_t a, size_t b) { return entries[a].height > entries[b].height; });
+
+		uint32_t x     = 0;
+		uint32_t y     = 0;
+		uint32_t shelf = 0;
+		atlas.width    = 0;
+		atlas.rects.assign(entries.size(), {0, 0, 0, 0});
+		for (size_t idx : order) {
+			auto const& entry = entries[idx];
+			if (!entry.source || !entry.width || !entry.height) {
+				continue;
+			}
+
+			if ((x > 0) && ((x + entry.width) > row)) {
+				y += shelf + ST_ATLAS_PADDING;
+				x     = 0;
+				shelf = 0;
+			}
+			if (((x + entry.width) > ST_ATLAS_MAX_SIZE) || ((y + entry.height) > ST_ATLAS_MAX_SIZE)) {
+				continue;
+			}
+
+			atlas.rects[idx] = {x, y, entry.width, entry.height};
+			atlas.width      = std::max(atlas.width, x + entry.width);
+			shelf            = std::max(shelf, entry.height);
+			x += entry.width + ST_ATLAS_PADDING;
+		}
+		atlas.height = y + shelf;
+	}
+} // namespace
+
 streamfx::gfx::source_texture::~source_texture()
 {
 	if (_child && _parent) {
@@ -30,8 +140,6 @@ streamfx::gfx::source_texture::source_texture(streamfx::obs::source child, strea
 	} else if (!obs_source_add_active_child(parent, child)) {
 		throw std::runtime_error("Child contains Parent");
 	}
-
-	_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 obs_source_t* streamfx::gfx::source_texture::get_object()
@@ -67,19 +175,140 @@ std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::source_texture::rende
 		return nullptr;
 	}
 
-	if (_child) {
+	return capture(_child.get(), static_cast<uint32_t>(width), static_cast<uint32_t>(height), GS_RGBA, GS_CS_SRGB, true);
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::source_texture::capture(obs_source_t* source, uint32_t width, uint32_t height, gs_color_format format, gs_color_space space, bool blend)
+{
+	if (!source || (width == 0) || (height == 0)) {
+		return nullptr;
+	}
+
+	// Everything that changes the result is part of the key, including the sRGB state of the caller.
+	uint64_t frame = obs_get_video_frame_time();
+	auto     key   = cache_key_t{source, width, height, format, space, blend, gs_get_linear_srgb(), gs_framebuffer_srgb_enabled()};
+
+	std::shared_ptr<cached_render> entry;
+	{
+		std::lock_guard<std::mutex> lock(cache_lock);
+		if (auto kv = cache.find(key); kv != cache.end()) {
+			entry = kv->second;
+		} else {
+			// Release whatever nobody asked for in a while, before adding another one.
+			expire(cache, frame);
+
+			entry        = std::make_shared<cached_render>();
+			entry->rt    = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+			entry->frame = frame - 1;
+			cache.emplace(key, entry);
+		}
+
+		// Someone else already rendered this source this way during this frame.
+		if (entry->frame == frame) {
+			return std::shared_ptr<streamfx::obs::gs::texture>(entry, &entry->texture);
+		}
+		entry->frame = frame;
+	}
+
+	{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_capture, "gfx::source_texture '%s'", obs_source_get_name(_child.get()));
+		auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_capture, "gfx::source_texture '%s'", obs_source_get_name(source));
 #endif
-		auto op = _rt->render(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+		auto op = entry->rt->render(width, height, space);
 		vec4 black;
 		vec4_zero(&black);
 		gs_ortho(0, static_cast<float>(width), 0, static_cast<float_t>(height), 0, 1);
 		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
-		obs_source_video_render(_child.get());
+
+		push_render_state(blend);
+		obs_source_video_render(source);
+		gs_blend_state_pop();
+	}
+
+	// The texture keeps the render target alive for as long as anyone holds on to it.
+	entry->rt->get_texture(entry->texture);
+	return std::shared_ptr<streamfx::obs::gs::texture>(entry, &entry->texture);
+}
+
+std::vector<streamfx::gfx::source_texture::atlas_region> streamfx::gfx::source_texture::capture_atlas(std::vector<atlas_entry> const& entries, gs_color_format format, gs_color_space space, bool blend)
+{
+	std::vector<atlas_region> regions(entries.size(), atlas_region{nullptr, 0, 0, 0, 0, {}});
+	if (entries.empty()) {
+		return regions;
+	}
+
+	uint64_t    frame = obs_get_video_frame_time();
+	atlas_key_t key{{}, format, space, blend, gs_get_linear_srgb(), gs_framebuffer_srgb_enabled()};
+	for (auto const& entry : entries) {
+		std::get<0>(key).emplace_back(entry.source, entry.width, entry.height);
+	}
+
+	std::shared_ptr<cached_atlas> atlas;
+	bool                          fresh = false;
+	{
+		std::lock_guard<std::mutex> lock(cache_lock);
+		if (auto kv = atlas_cache.find(key); kv != atlas_cache.end()) {
+			atlas = kv->second;
+		} else {
+			expire(atlas_cache, frame);
+
+			atlas        = std::make_shared<cached_atlas>();
+			atlas->rt    = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+			atlas->frame = frame - 1;
+			pack_atlas(entries, *atlas);
+			atlas_cache.emplace(key, atlas);
+		}
+
+		fresh        = (atlas->frame != frame);
+		atlas->frame = frame;
 	}
 
-	std::shared_ptr<streamfx::obs::gs::texture> tex;
-	_rt->get_texture(tex);
-	return tex;
+	if (!atlas->width || !atlas->height) {
+		return regions;
+	}
+
+	if (fresh) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_capture, "gfx::source_texture atlas of %zu", entries.size());
+#endif
+		auto op = atlas->rt->render(atlas->width, atlas->height, space);
+		vec4 black;
+		vec4_zero(&black);
+		gs_ortho(0, static_cast<float>(atlas->width), 0, static_cast<float>(atlas->height), 0, 1);
+		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+
+		push_render_state(blend);
+		for (size_t idx = 0; idx < entries.size(); idx++) {
+			auto const& rect = atlas->rects[idx];
+			if (!rect[2]) {
+				continue;
+			}
+
+			// Each source believes it is rendering to a target of its own size.
+			gs_set_viewport(static_cast<int>(rect[0]), static_cast<int>(rect[1]), static_cast<int>(rect[2]), static_cast<int>(rect[3]));
+			gs_ortho(0, static_cast<float>(rect[2]), 0, static_cast<float>(rect[3]), 0, 1);
+			obs_source_video_render(entries[idx].source);
+		}
+		gs_blend_state_pop();
+	}
+
+	atlas->rt->get_texture(atlas->texture);
+	auto  texture = std::shared_ptr<streamfx::obs::gs::texture>(atlas, &atlas->texture);
+	float width   = static_cast<float>(atlas->width);
+	float height  = static_cast<float>(atlas->height);
+	for (size_t idx = 0; idx < entries.size(); idx++) {
+		auto const& rect = atlas->rects[idx];
+		if (!rect[2]) {
+			continue;
+		}
+
+		auto& region   = regions[idx];
+		region.texture = texture;
+		region.x       = rect[0];
+		region.y       = rect[1];
+		region.width   = rect[2];
+		region.height  = rect[3];
+		vec4_set(&region.uv, rect[0] / width, rect[1] / height, rect[2] / width, rect[3] / height);
+	}
+	return regions;
 }
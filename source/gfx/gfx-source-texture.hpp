@@ -11,6 +11,7 @@
 
 #include "warning-disable.hpp"
 #include <map>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx {
@@ -18,8 +19,6 @@ namespace streamfx::gfx {
 		streamfx::obs::source _parent;
 		streamfx::obs::source _child;
 
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
-
 		public:
 		~source_texture();
 		source_texture(streamfx::obs::source child, streamfx::obs::source parent);
@@ -33,8 +32,47 @@ namespace streamfx::gfx {
 		source_texture& operator=(source_texture&& other) = delete;
 
 		public:
+		/** Render the child at the given size.
+		 *
+		 * All users of the same child and size share a single render per frame, so the returned texture must be
+		 * treated as read-only. It contains premultiplied alpha.
+		 */
 		std::shared_ptr<streamfx::obs::gs::texture> render(std::size_t width, std::size_t height);
 
+		/** Render any source through the same per-frame cache, for users that manage the child relation themselves.
+		 *
+		 * @param blend Render with the default blend state for premultiplied alpha, or without any blending.
+		 */
+		static std::shared_ptr<streamfx::obs::gs::texture> capture(obs_source_t* source, uint32_t width, uint32_t height, gs_color_format format = GS_RGBA, gs_color_space space = GS_CS_SRGB, bool blend = true);
+
+		public /* Atlas */:
+		struct atlas_entry {
+			obs_source_t* source;
+			uint32_t      width;
+			uint32_t      height;
+		};
+
+		struct atlas_region {
+			/** The entire atlas, or nullptr if the source did not fit. */
+			std::shared_ptr<streamfx::obs::gs::texture> texture;
+
+			uint32_t x;
+			uint32_t y;
+			uint32_t width;
+			uint32_t height;
+
+			/** Offset (x, y) and scale (z, w) that map a 0..1 UV onto this region of the atlas. */
+			vec4 uv;
+		};
+
+		/** Render several sources into regions of one shared target, with a single render target bind.
+		 *
+		 * Meant for many small sources, like thumbnail grids, where switching render targets costs more than drawing.
+		 * Regions are returned in the order of 'entries', and are a texel apart so that bilinear filtering does not
+		 * bleed between them. Like capture(), the same list asked for again in the same frame is only rendered once.
+		 */
+		static std::vector<atlas_region> capture_atlas(std::vector<atlas_entry> const& entries, gs_color_format format = GS_RGBA, gs_color_space space = GS_CS_SRGB, bool blend = true);
+
 		public: // Unsafe Methods
 		void clear();
 
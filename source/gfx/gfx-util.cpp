@@ -9,7 +9,10 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
 #include <mutex>
+#include <stdexcept>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -40,7 +43,7 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::util::get()
 	return instance.lock();
 }
 
-streamfx::gfx::util::util()
+streamfx::gfx::util::util() : _effect(), _batch_vb(), _batch(), _batch_depth(0), _fstri_vb(nullptr)
 {
 	{
 		std::filesystem::path file = ::streamfx::data_file_path("effects/standard.effect");
@@ -56,69 +59,109 @@ streamfx::gfx::util::~util()
 {
 	obs::gs::context gctx{};
 
-	_point_vb.reset();
-	_line_vb.reset();
-	_arrow_vb.reset();
-	_quad_vb.reset();
+	_batch_vb.reset();
+	if (_fstri_vb) {
+		gs_vertexbuffer_destroy(_fstri_vb);
+	}
 }
 
-void streamfx::gfx::util::draw_point(float x, float y, uint32_t color)
+void streamfx::gfx::util::begin_batch()
 {
-	obs::gs::context gctx{};
-
-	if (!_point_vb) {
-		_point_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{1}, uint8_t{1});
-	}
+	_batch_depth++;
+}
 
-	{
-		auto vtx = _point_vb->at(0);
-		vec3_set(vtx.position, x, y, 0.);
-		*vtx.color = color;
+void streamfx::gfx::util::end_batch()
+{
+	if ((_batch_depth > 0) && (--_batch_depth == 0)) {
+		flush();
 	}
+}
 
-	gs_load_indexbuffer(nullptr);
-	gs_load_vertexbuffer(_point_vb->update(true));
-	while (gs_effect_loop(_effect->get_object(), "Color")) {
-		gs_draw(GS_POINTS, 0, 1);
-	}
-	gs_load_vertexbuffer(nullptr);
+void streamfx::gfx::util::push(size_t kind, float x, float y, uint32_t color)
+{
+	vec3 position;
+	vec3_set(&position, x, y, 0.);
+	_batch[kind].positions.push_back(position);
+	_batch[kind].colors.push_back(color);
 }
 
-void streamfx::gfx::util::draw_line(float x, float y, float x2, float y2, uint32_t color /*= 0xFFFFFFFF*/)
+void streamfx::gfx::util::flush()
 {
-	obs::gs::context gctx{};
+	static constexpr gs_draw_mode modes[] = {GS_POINTS, GS_LINES, GS_TRIS};
 
-	if (!_line_vb) {
-		_line_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{2}, uint8_t{1});
+	size_t total = 0;
+	for (auto const& kind : _batch) {
+		total += kind.positions.size();
+	}
+	if (total == 0) {
+		return;
 	}
 
-	{
-		auto vtx = _line_vb->at(0);
-		vec3_set(vtx.position, x, y, 0.);
-		*vtx.color = color;
+	obs::gs::context gctx{};
+
+	// Grow in powers of two, so that a busy overlay settles on one buffer quickly.
+	if (!_batch_vb || (_batch_vb->capacity() < total)) {
+		uint32_t capacity = 64;
+		while (capacity < total) {
+			capacity *= 2;
+		}
+		_batch_vb = std::make_shared<obs::gs::vertex_buffer>(capacity, uint8_t{1});
 	}
+
+	// Only positions and colors are ever written, so only those are uploaded.
+	std::array<std::pair<uint32_t, uint32_t>, 3> ranges;
 	{
-		auto vtx = _line_vb->at(1);
-		vec3_set(vtx.position, x2, y2, 0.);
-		*vtx.color = color;
+		vec3*     positions = _batch_vb->get_positions();
+		uint32_t* colors    = _batch_vb->get_colors();
+		uint32_t  offset    = 0;
+		for (size_t idx = 0; idx < _batch.size(); idx++) {
+			auto&    kind  = _batch[idx];
+			uint32_t count = static_cast<uint32_t>(kind.positions.size());
+			std::copy(kind.positions.begin(), kind.positions.end(), positions + offset);
+			std::copy(kind.colors.begin(), kind.colors.end(), colors + offset);
+			ranges[idx] = {offset, count};
+			offset += count;
+			kind.positions.clear();
+			kind.colors.clear();
+		}
 	}
 
+	// Only what was drawn this time needs to reach the GPU.
+	_batch_vb->resize(static_cast<uint32_t>(total));
+
 	gs_load_indexbuffer(nullptr);
-	gs_load_vertexbuffer(_line_vb->update(true));
+	gs_load_vertexbuffer(_batch_vb->update(true));
 	while (gs_effect_loop(_effect->get_object(), "Color")) {
-		gs_draw(GS_LINES, 0, 2);
+		for (size_t idx = 0; idx < ranges.size(); idx++) {
+			if (ranges[idx].second > 0) {
+				gs_draw(modes[idx], ranges[idx].first, ranges[idx].second);
+			}
+		}
 	}
 	gs_load_vertexbuffer(nullptr);
 }
 
-void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float w /*= 0.*/, uint32_t color /*= 0xFFFFFFFF*/)
+void streamfx::gfx::util::draw_point(float x, float y, uint32_t color)
 {
-	obs::gs::context gctx{};
+	push(0, x, y, color);
 
-	if (!_arrow_vb) {
-		_arrow_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{5}, uint8_t{1});
+	if (_batch_depth == 0) {
+		flush();
 	}
+}
+
+void streamfx::gfx::util::draw_line(float x, float y, float x2, float y2, uint32_t color /*= 0xFFFFFFFF*/)
+{
+	push(1, x, y, color);
+	push(1, x2, y2, color);
 
+	if (_batch_depth == 0) {
+		flush();
+	}
+}
+
+void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float w /*= 0.*/, uint32_t color /*= 0xFFFFFFFF*/)
+{
 	float dx  = x2 - x;
 	float dy  = y2 - y;
 	float ang = atan2(-dx, dy);
@@ -134,146 +177,83 @@ void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float
 	vec3 offset;
 	vec3_set(&offset, x, y, 0.);
 
-	{
-		auto vtx = _arrow_vb->at(0);
-		vec3_set(vtx.position, 0, 0, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
+	// Shaft, then both sides of the head.
+	std::array<vec3, 4> points;
+	vec3_set(&points[0], 0, 0, 0.);
+	vec3_set(&points[1], 0, len, 0.);
+	vec3_set(&points[2], -w, len - w, 0.);
+	vec3_set(&points[3], w, len - w, 0.);
+	for (auto& point : points) {
+		vec3_transform(&point, &point, &rotator);
+		vec3_add(&point, &point, &offset);
 	}
-	{
-		auto vtx = _arrow_vb->at(1);
-		vec3_set(vtx.position, 0, len, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(2);
-		vec3_set(vtx.position, -w, len - w, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(3);
-		vec3_set(vtx.position, w, len - w, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(4);
-		vec3_set(vtx.position, 0, len, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
+
+	for (size_t idx : {0, 1, 1, 2, 1, 3}) {
+		push(1, points[idx].x, points[idx].y, color);
 	}
 
-	gs_load_indexbuffer(nullptr);
-	gs_load_vertexbuffer(_arrow_vb->update(true));
-	while (gs_effect_loop(_effect->get_object(), "Color")) {
-		gs_draw(GS_LINESTRIP, 0, 5);
+	if (_batch_depth == 0) {
+		flush();
 	}
-	gs_load_vertexbuffer(nullptr);
 }
 
 void streamfx::gfx::util::draw_rectangle(float x, float y, float w, float h, bool frame, uint32_t color /*= 0xFFFFFFFF*/)
 {
-	obs::gs::context gctx{};
-
-	if (!_quad_vb) {
-		_quad_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{5}, uint8_t{1});
-	}
-
 	if (frame) {
-		{
-			auto vtx = _quad_vb->at(0);
-			vec3_set(vtx.position, x, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(1);
-			vec3_set(vtx.position, x + w, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(2);
-			vec3_set(vtx.position, x + w, y + h, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(3);
-			vec3_set(vtx.position, x, y + h, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(4);
-			vec3_set(vtx.position, x, y, 0.);
-			*vtx.color = color;
-		}
-
-		gs_load_indexbuffer(nullptr);
-		gs_load_vertexbuffer(_quad_vb->update(true));
-		while (gs_effect_loop(_effect->get_object(), "Color")) {
-			gs_draw(GS_LINESTRIP, 0, 5);
-		}
-		gs_load_vertexbuffer(nullptr);
+		push(1, x, y, color);
+		push(1, x + w, y, color);
+		push(1, x + w, y, color);
+		push(1, x + w, y + h, color);
+		push(1, x + w, y + h, color);
+		push(1, x, y + h, color);
+		push(1, x, y + h, color);
+		push(1, x, y, color);
 	} else {
-		{
-			auto vtx = _quad_vb->at(0);
-			vec3_set(vtx.position, x, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(1);
-			vec3_set(vtx.position, x + w, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(2);
-			vec3_set(vtx.position, x, y + h, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(3);
-			vec3_set(vtx.position, x + w, y + h, 0.);
-			*vtx.color = color;
-		}
+		push(2, x, y, color);
+		push(2, x + w, y, color);
+		push(2, x, y + h, color);
+		push(2, x + w, y, color);
+		push(2, x + w, y + h, color);
+		push(2, x, y + h, color);
+	}
 
-		gs_load_indexbuffer(nullptr);
-		gs_load_vertexbuffer(_quad_vb->update(true));
-		while (gs_effect_loop(_effect->get_object(), "Color")) {
-			gs_draw(GS_TRISTRIP, 0, 4);
-		}
-		gs_load_vertexbuffer(nullptr);
+	if (_batch_depth == 0) {
+		flush();
 	}
 }
 
 void streamfx::gfx::util::draw_fullscreen_triangle()
 {
 	if (!_fstri_vb) {
-		_fstri_vb = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(3), uint8_t(1));
-		{
-			auto vtx = _fstri_vb->at(0);
-			vec3_set(vtx.position, 0, 0, 0);
-			vec4_set(vtx.uv[0], 0, 0, 0, 0);
-		}
-		{
-			auto vtx = _fstri_vb->at(1);
-			vec3_set(vtx.position, 2, 0, 0);
-			vec4_set(vtx.uv[0], 2, 0, 0, 0);
-		}
-		{
-			auto vtx = _fstri_vb->at(2);
-			vec3_set(vtx.position, 0, 2, 0);
-			vec4_set(vtx.uv[0], 0, 2, 0, 0);
+		// Never changes, so let the driver place it wherever is fastest to read from.
+		gs_vb_data* data = gs_vbdata_create();
+		data->num        = 3;
+		data->points     = static_cast<vec3*>(bzalloc(sizeof(vec3) * 3));
+		data->normals    = static_cast<vec3*>(bzalloc(sizeof(vec3) * 3));
+		data->tangents   = static_cast<vec3*>(bzalloc(sizeof(vec3) * 3));
+		data->colors     = static_cast<uint32_t*>(bzalloc(sizeof(uint32_t) * 3));
+		data->num_tex    = 1;
+		data->tvarray    = static_cast<gs_tvertarray*>(bzalloc(sizeof(gs_tvertarray)));
+
+		data->tvarray[0].width = 4;
+		data->tvarray[0].array = bzalloc(sizeof(vec4) * 3);
+
+		vec4* uvs = static_cast<vec4*>(data->tvarray[0].array);
+		vec3_set(&data->points[0], 0, 0, 0);
+		vec4_set(&uvs[0], 0, 0, 0, 0);
+		vec3_set(&data->points[1], 2, 0, 0);
+		vec4_set(&uvs[1], 2, 0, 0, 0);
+		vec3_set(&data->points[2], 0, 2, 0);
+		vec4_set(&uvs[2], 0, 2, 0, 0);
+
+		_fstri_vb = gs_vertexbuffer_create(data, 0);
+		if (!_fstri_vb) {
+			throw std::runtime_error("Failed to create vertex buffer.");
 		}
-		_fstri_vb->update();
 	}
 
 	gs_load_indexbuffer(nullptr);
-	gs_load_vertexbuffer(_fstri_vb->update(false));
-	gs_draw(GS_TRIS, 0, 3); //_gs_fstri_vb->size());
+	gs_load_vertexbuffer(_fstri_vb);
+	gs_draw(GS_TRIS, 0, 3);
 	gs_load_vertexbuffer(nullptr);
 }
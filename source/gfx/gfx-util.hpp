@@ -7,17 +7,23 @@
 #include "obs/gs/gs-vertexbuffer.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
 #include <memory>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx {
 	class util {
+		struct primitives {
+			std::vector<vec3>     positions;
+			std::vector<uint32_t> colors;
+		};
+
 		std::shared_ptr<::streamfx::obs::gs::effect>        _effect;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _point_vb;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _line_vb;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _arrow_vb;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _quad_vb;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _fstri_vb;
+		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _batch_vb;
+		std::array<primitives, 3>                           _batch; // Points, Lines, Triangles
+		size_t                                              _batch_depth;
+		gs_vertbuffer_t*                                    _fstri_vb;
 
 		public /* Singleton */:
 		static std::shared_ptr<streamfx::gfx::util> get();
@@ -28,6 +34,15 @@ namespace streamfx::gfx {
 		public:
 		~util();
 
+		/** Collect all following draw_* calls until the matching end_batch().
+		 *
+		 * Everything is then uploaded into one vertex buffer and drawn with one call per kind of primitive, instead of
+		 * one upload and draw per call. The transform and render target must not change until end_batch().
+		 */
+		void begin_batch();
+
+		void end_batch();
+
 		void draw_point(float x, float y, uint32_t color = 0xFFFFFFFF);
 
 		void draw_line(float x, float y, float x2, float y2, uint32_t color = 0xFFFFFFFF);
@@ -37,5 +52,10 @@ namespace streamfx::gfx {
 		void draw_rectangle(float x, float y, float w, float h, bool frame, uint32_t color = 0xFFFFFFFF);
 
 		void draw_fullscreen_triangle();
+
+		private:
+		void push(size_t kind, float x, float y, uint32_t color);
+
+		void flush();
 	};
 } // namespace streamfx::gfx
@@ -0,0 +1,127 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-lut-cache.hpp"
+#include "plugin.hpp"
+#include "util/util-hash.hpp"
+
+std::shared_ptr<streamfx::gfx::lut::cache> streamfx::gfx::lut::cache::instance()
+{
+	static std::weak_ptr<streamfx::gfx::lut::cache> _instance;
+	static std::mutex                               _mutex;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto reference = _instance.lock();
+	if (!reference) {
+		reference = std::shared_ptr<streamfx::gfx::lut::cache>(new streamfx::gfx::lut::cache());
+		_instance = reference;
+	}
+	return reference;
+}
+
+streamfx::gfx::lut::cache::cache() : _lock(), _entries(), _files() {}
+
+streamfx::gfx::lut::cache::~cache() {}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::lut::cache::find(const std::vector<uint8_t>& key)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	uint64_t hash  = streamfx::util::hash::plane(key.data(), key.size(), key.size(), 1);
+	auto     range = _entries.equal_range(hash);
+	for (auto itr = range.first; itr != range.second;) {
+		auto lut = itr->second.lut.lock();
+		if (!lut) { // Nobody uses this one anymore.
+			itr = _entries.erase(itr);
+			continue;
+		}
+		if (itr->second.key == key) {
+			return lut;
+		}
+		++itr;
+	}
+	return nullptr;
+}
+
+void streamfx::gfx::lut::cache::insert(const std::vector<uint8_t>& key, std::shared_ptr<streamfx::obs::gs::rendertarget> lut)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// Drop anything that expired in the meantime, so the cache does not grow while a grade is being edited.
+	for (auto itr = _entries.begin(); itr != _entries.end();) {
+		if (itr->second.lut.expired()) {
+			itr = _entries.erase(itr);
+		} else {
+			++itr;
+		}
+	}
+
+	uint64_t hash = streamfx::util::hash::plane(key.data(), key.size(), key.size(), 1);
+	_entries.insert({hash, entry{key, lut}});
+}
+
+void streamfx::gfx::lut::cache::remove(const std::shared_ptr<streamfx::obs::gs::rendertarget>& lut)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	for (auto itr = _entries.begin(); itr != _entries.end();) {
+		if (itr->second.lut.lock() == lut) {
+			itr = _entries.erase(itr);
+		} else {
+			++itr;
+		}
+	}
+}
+
+std::shared_ptr<streamfx::gfx::lut::cache::file_request> streamfx::gfx::lut::cache::load(const std::filesystem::path& path)
+{
+	auto request  = std::make_shared<file_request>();
+	request->path = path;
+
+	auto self     = instance();
+	request->task = streamfx::threadpool()->push(
+		[self, request](streamfx::util::threadpool::task_data_t) {
+			try {
+				auto content = streamfx::gfx::lut::file::read(request->path);
+				auto key     = std::make_pair(streamfx::gfx::lut::file::hash(content), content.size());
+
+				{
+					std::lock_guard<std::mutex> lock(self->_lock);
+					if (auto itr = self->_files.find(key); itr != self->_files.end()) {
+						if (auto lut = itr->second.lock(); lut) {
+							request->lut = lut;
+							return;
+						}
+					}
+				}
+
+				// Parse outside of the lock, files can take a while and do not have to wait for each other.
+				auto lut = std::make_shared<streamfx::gfx::lut::file>(content, request->path.extension().u8string());
+
+				std::lock_guard<std::mutex> lock(self->_lock);
+				if (auto itr = self->_files.find(key); itr != self->_files.end()) {
+					if (auto existing = itr->second.lock(); existing) {
+						// Someone else finished the same file first.
+						request->lut = existing;
+						return;
+					}
+				}
+				for (auto itr = self->_files.begin(); itr != self->_files.end();) {
+					if (itr->second.expired()) {
+						itr = self->_files.erase(itr);
+					} else {
+						++itr;
+					}
+				}
+				self->_files[key] = lut;
+				request->lut      = lut;
+			} catch (const std::exception& ex) {
+				request->error = ex.what();
+			}
+		},
+		nullptr, streamfx::util::threadpool::priority::BACKGROUND);
+
+	return request;
+}
@@ -0,0 +1,72 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "gfx-lut-file.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx::lut {
+	/** Process-wide cache of finished LUTs, so that identical grades only produce and store one.
+	 *
+	 * A key is an opaque description of everything that went into a LUT. The cache only holds weak references, so a
+	 * LUT lives exactly as long as someone is using it.
+	 */
+	class cache {
+		public:
+		/** State of a LUT file that is being loaded in the background. Only valid to read once 'task' completed. */
+		struct file_request {
+			std::filesystem::path                             path;
+			std::shared_ptr<streamfx::util::threadpool::task> task;
+			std::shared_ptr<streamfx::gfx::lut::file>         lut;
+			std::string                                       error;
+		};
+
+		private:
+		struct entry {
+			std::vector<uint8_t>                           key;
+			std::weak_ptr<streamfx::obs::gs::rendertarget> lut;
+		};
+
+		std::mutex                     _lock;
+		std::multimap<uint64_t, entry> _entries;
+
+		// Loaded files by content hash and length.
+		std::map<std::pair<uint64_t, size_t>, std::weak_ptr<streamfx::gfx::lut::file>> _files;
+
+		public:
+		static std::shared_ptr<cache> instance();
+
+		private:
+		cache();
+
+		public:
+		~cache();
+
+		std::shared_ptr<streamfx::obs::gs::rendertarget> find(const std::vector<uint8_t>& key);
+
+		void insert(const std::vector<uint8_t>& key, std::shared_ptr<streamfx::obs::gs::rendertarget> lut);
+
+		/** Stop handing out the given LUT, for example because its owner is about to render something else into it. */
+		void remove(const std::shared_ptr<streamfx::obs::gs::rendertarget>& lut);
+
+		/** Load a '.cube' or '.3dl' file on the threadpool.
+		 *
+		 * Files with identical content share one parsed LUT and texture, no matter where they are stored. Nothing is
+		 * called back on completion, so an unwanted request can simply be dropped.
+		 */
+		std::shared_ptr<file_request> load(const std::filesystem::path& path);
+	};
+} // namespace streamfx::gfx::lut
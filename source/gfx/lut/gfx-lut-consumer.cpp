@@ -16,15 +16,23 @@ streamfx::gfx::lut::consumer::consumer()
 streamfx::gfx::lut::consumer::~consumer() = default;
 
 std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::consumer::prepare(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut)
+{
+	int32_t idepth = static_cast<int32_t>(depth);
+	return prepare(static_cast<int32_t>(pow(2l, idepth)), static_cast<int32_t>(pow(2l, (idepth / 2))), lut);
+}
+
+std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::consumer::prepare(std::shared_ptr<streamfx::gfx::lut::file> lut)
+{
+	return prepare(static_cast<int32_t>(lut->size()), static_cast<int32_t>(lut->grid_size()), lut->texture());
+}
+
+std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::consumer::prepare(int32_t size, int32_t grid_size, std::shared_ptr<streamfx::obs::gs::texture> lut)
 {
 	auto gctx = streamfx::obs::gs::context();
 
 	auto effect = _data->consumer_effect();
 
-	int32_t idepth         = static_cast<int32_t>(depth);
-	int32_t size           = static_cast<int32_t>(pow(2l, idepth));
-	int32_t grid_size      = static_cast<int32_t>(pow(2l, (idepth / 2)));
-	int32_t container_size = static_cast<int32_t>(pow(2l, (idepth + (idepth / 2))));
+	int32_t container_size = size * grid_size;
 
 	if (streamfx::obs::gs::effect_parameter efp = effect->get_parameter("lut_params_0"); efp) {
 		efp.set_int4(size, grid_size, container_size, 0l);
@@ -45,7 +53,7 @@ std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::consumer::prepare
 	return effect;
 }
 
-void streamfx::gfx::lut::consumer::consume(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::texture> texture)
+void streamfx::gfx::lut::consumer::consume(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::texture> texture, streamfx::gfx::lut::interpolation interpolation)
 {
 	auto gctx = streamfx::obs::gs::context();
 
@@ -56,7 +64,17 @@ void streamfx::gfx::lut::consumer::consume(streamfx::gfx::lut::color_depth depth
 	}
 
 	// Draw a simple quad.
-	while (gs_effect_loop(effect->get_object(), "Draw")) {
+	while (gs_effect_loop(effect->get_object(), technique(interpolation))) {
 		gs_draw_sprite(nullptr, 0, 1, 1);
 	}
 }
+
+const char* streamfx::gfx::lut::consumer::technique(streamfx::gfx::lut::interpolation interpolation)
+{
+	switch (interpolation) {
+	case streamfx::gfx::lut::interpolation::Tetrahedral:
+		return "DrawTetrahedral";
+	default:
+		return "Draw";
+	}
+}
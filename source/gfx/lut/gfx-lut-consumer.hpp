@@ -3,6 +3,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx-lut-file.hpp"
 #include "gfx-lut.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-texture.hpp"
@@ -21,6 +22,13 @@ namespace streamfx::gfx::lut {
 
 		std::shared_ptr<streamfx::obs::gs::effect> prepare(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut);
 
-		void consume(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::texture> texture);
+		std::shared_ptr<streamfx::obs::gs::effect> prepare(std::shared_ptr<streamfx::gfx::lut::file> lut);
+
+		void consume(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::texture> texture, streamfx::gfx::lut::interpolation interpolation = streamfx::gfx::lut::interpolation::Trilinear);
+
+		static const char* technique(streamfx::gfx::lut::interpolation interpolation);
+
+		private:
+		std::shared_ptr<streamfx::obs::gs::effect> prepare(int32_t size, int32_t grid_size, std::shared_ptr<streamfx::obs::gs::texture> lut);
 	};
 } // namespace streamfx::gfx::lut
@@ -0,0 +1,303 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-lut-file.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-hash.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "warning-enable.hpp"
+
+// Above this the floating point texture quickly grows into hundreds of megabytes, and real LUTs rarely exceed 65.
+#define ST_MAX_SIZE 129
+#define ST_MAX_FILE_SIZE (256ull * 1024ull * 1024ull)
+
+namespace {
+	typedef std::array<double, 3> value_t;
+
+	bool is_keyword(const std::string& token)
+	{
+		return !token.empty() && std::isalpha(static_cast<unsigned char>(token[0]));
+	}
+
+	uint32_t cube_root(size_t count)
+	{
+		uint32_t size = 0;
+		while ((static_cast<size_t>(size + 1) * (size + 1) * (size + 1)) <= count) {
+			size++;
+		}
+		return size;
+	}
+
+	/** Parse an Adobe/IRIDAS '.cube' file. Red changes fastest, values are normalized. */
+	uint32_t parse_cube(std::istream& stream, std::vector<value_t>& values)
+	{
+		uint32_t           size = 0;
+		std::string        line;
+		std::istringstream ls;
+		ls.imbue(std::locale::classic());
+
+		while (std::getline(stream, line)) {
+			if (auto pos = line.find('#'); pos != std::string::npos) {
+				line.erase(pos);
+			}
+
+			ls.clear();
+			ls.str(line);
+
+			std::string keyword;
+			if (!(ls >> keyword)) {
+				continue;
+			}
+
+			if (!is_keyword(keyword)) {
+				value_t value;
+				ls.clear();
+				ls.str(line);
+				if (!(ls >> value[0] >> value[1] >> value[2])) {
+					throw std::runtime_error("Malformed lattice entry.");
+				}
+				values.push_back(value);
+			} else if (keyword == "LUT_3D_SIZE") {
+				if (!(ls >> size)) {
+					throw std::runtime_error("Malformed 'LUT_3D_SIZE'.");
+				}
+			} else if (keyword == "LUT_1D_SIZE") {
+				throw std::runtime_error("1D LUTs are not supported.");
+			} else if ((keyword == "DOMAIN_MIN") || (keyword == "DOMAIN_MAX")) {
+				double expected = (keyword == "DOMAIN_MIN") ? 0. : 1.;
+				value_t value;
+				if (!(ls >> value[0] >> value[1] >> value[2])) {
+					throw std::runtime_error("Malformed domain.");
+				}
+				for (auto v : value) {
+					if (v != expected) {
+						throw std::runtime_error("Domains other than 0..1 are not supported.");
+					}
+				}
+			} else if (keyword == "LUT_3D_INPUT_RANGE") {
+				double lo, hi;
+				if (!(ls >> lo >> hi) || (lo != 0.) || (hi != 1.)) {
+					throw std::runtime_error("Input ranges other than 0..1 are not supported.");
+				}
+			}
+			// Everything else, like 'TITLE', does not change the lattice.
+		}
+
+		return size;
+	}
+
+	/** Parse an Autodesk/Lustre '.3dl' file. Blue changes fastest, values are integers of a fixed bit depth. */
+	uint32_t parse_3dl(std::istream& stream, std::vector<value_t>& values)
+	{
+		uint32_t            size        = 0;
+		uint32_t            output_bits = 0;
+		double              peak        = 0.;
+		std::string         line;
+		std::istringstream  ls;
+		std::vector<double> tokens;
+		ls.imbue(std::locale::classic());
+
+		while (std::getline(stream, line)) {
+			if (auto pos = line.find('#'); pos != std::string::npos) {
+				line.erase(pos);
+			}
+
+			ls.clear();
+			ls.str(line);
+
+			std::string keyword;
+			if (!(ls >> keyword)) {
+				continue;
+			}
+
+			if (is_keyword(keyword)) {
+				if (keyword == "Mesh") {
+					uint32_t input_bits = 0;
+					ls >> input_bits >> output_bits;
+				}
+				// Everything else, like '3DMESH', does not change the lattice.
+				continue;
+			}
+
+			tokens.clear();
+			ls.clear();
+			ls.str(line);
+			for (double v; ls >> v;) {
+				tokens.push_back(v);
+			}
+
+			if ((tokens.size() > 3) && (size == 0) && values.empty()) {
+				// The first line lists the input positions of the lattice points.
+				size = static_cast<uint32_t>(tokens.size());
+			} else if (tokens.size() == 3) {
+				values.push_back({tokens[0], tokens[1], tokens[2]});
+				for (auto v : tokens) {
+					peak = std::max(peak, v);
+				}
+			} else {
+				throw std::runtime_error("Malformed lattice entry.");
+			}
+		}
+
+		if (size == 0) {
+			size = cube_root(values.size());
+		}
+		if (values.size() != (static_cast<size_t>(size) * size * size)) {
+			throw std::runtime_error("LUT file does not contain the expected number of entries.");
+		}
+
+		// Without a 'Mesh' line, the output depth is the smallest common one that fits every value.
+		if (output_bits == 0) {
+			for (uint32_t bits : {8, 10, 12, 14, 16}) {
+				output_bits = bits;
+				if (peak <= static_cast<double>((1ull << bits) - 1)) {
+					break;
+				}
+			}
+		}
+		if ((output_bits == 0) || (output_bits > 32)) {
+			throw std::runtime_error("Invalid output depth.");
+		}
+
+		double scale = 1. / static_cast<double>((1ull << output_bits) - 1);
+		for (auto& value : values) {
+			for (auto& v : value) {
+				v *= scale;
+			}
+		}
+
+		// Reorder the lattice from blue-fastest to red-fastest.
+		std::vector<value_t> reordered(values.size());
+		for (size_t idx = 0, r = 0; r < size; r++) {
+			for (size_t g = 0; g < size; g++) {
+				for (size_t b = 0; b < size; b++, idx++) {
+					reordered[(b * size + g) * size + r] = values[idx];
+				}
+			}
+		}
+		values.swap(reordered);
+
+		return size;
+	}
+} // namespace
+
+streamfx::gfx::lut::file::file(const std::vector<char>& content, std::string_view extension) : _hash(hash(content)), _size(0), _grid_size(0), _lock(), _data(), _texture()
+{
+	std::istringstream stream(std::string(content.begin(), content.end()));
+	stream.imbue(std::locale::classic());
+
+	std::vector<value_t> values;
+	if ((extension == ".cube") || (extension == ".CUBE")) {
+		_size = parse_cube(stream, values);
+	} else if ((extension == ".3dl") || (extension == ".3DL")) {
+		_size = parse_3dl(stream, values);
+	} else {
+		throw std::runtime_error("Unsupported LUT file type.");
+	}
+
+	if ((_size < 2) || (_size > ST_MAX_SIZE)) {
+		throw std::runtime_error("Unsupported LUT size.");
+	}
+	if (values.size() != (static_cast<size_t>(_size) * _size * _size)) {
+		throw std::runtime_error("LUT file does not contain the expected number of entries.");
+	}
+
+	// Lay out the blue slices in the smallest square grid that can hold all of them.
+	_grid_size = 1;
+	while ((_grid_size * _grid_size) < _size) {
+		_grid_size++;
+	}
+
+	size_t container_size = static_cast<size_t>(_size) * _grid_size;
+	_data.resize(container_size * container_size * 4, 0.f);
+	for (size_t idx = 0; idx < values.size(); idx++) {
+		size_t r = idx % _size;
+		size_t g = (idx / _size) % _size;
+		size_t b = idx / (static_cast<size_t>(_size) * _size);
+		size_t x = r + (b % _grid_size) * _size;
+		size_t y = g + (b / _grid_size) * _size;
+
+		float* px = &_data[(y * container_size + x) * 4];
+		px[0]     = static_cast<float>(values[idx][0]);
+		px[1]     = static_cast<float>(values[idx][1]);
+		px[2]     = static_cast<float>(values[idx][2]);
+		px[3]     = 1.f;
+	}
+}
+
+streamfx::gfx::lut::file::~file()
+{
+	if (_texture) {
+		auto gctx = streamfx::obs::gs::context();
+		_texture.reset();
+	}
+}
+
+uint64_t streamfx::gfx::lut::file::hash()
+{
+	return _hash;
+}
+
+uint32_t streamfx::gfx::lut::file::size()
+{
+	return _size;
+}
+
+uint32_t streamfx::gfx::lut::file::grid_size()
+{
+	return _grid_size;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::lut::file::texture()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	if (!_texture) {
+		auto gctx = streamfx::obs::gs::context();
+
+		uint32_t       container_size = _size * _grid_size;
+		const uint8_t* data[]         = {reinterpret_cast<const uint8_t*>(_data.data())};
+		_texture                      = std::make_shared<streamfx::obs::gs::texture>(container_size, container_size, GS_RGBA32F, 1, data, streamfx::obs::gs::texture::flags::None);
+
+		// The GPU holds the only copy we need from now on.
+		_data.clear();
+		_data.shrink_to_fit();
+	}
+
+	return _texture;
+}
+
+uint64_t streamfx::gfx::lut::file::hash(const std::vector<char>& content)
+{
+	return streamfx::util::hash::plane(reinterpret_cast<const uint8_t*>(content.data()), content.size(), content.size(), 1);
+}
+
+std::vector<char> streamfx::gfx::lut::file::read(const std::filesystem::path& path)
+{
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if (!stream) {
+		throw std::runtime_error("Unable to open LUT file.");
+	}
+
+	auto length = static_cast<size_t>(stream.tellg());
+	if (length > ST_MAX_FILE_SIZE) {
+		throw std::runtime_error("LUT file is too large.");
+	}
+
+	std::vector<char> content(length);
+	stream.seekg(0);
+	if (!stream.read(content.data(), static_cast<std::streamsize>(length))) {
+		throw std::runtime_error("Unable to read LUT file.");
+	}
+	return content;
+}
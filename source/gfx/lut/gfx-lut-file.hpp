@@ -0,0 +1,58 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx::lut {
+	/** A 3D LUT loaded from an external file, such as a '.cube' or '.3dl' file.
+	 *
+	 * The lattice is stored in the same layout as the LUTs made by the producer, with the blue slices laid out in a
+	 * square grid, so the consumer can apply either kind. Only 'size' has to be known to address it.
+	 */
+	class file {
+		uint64_t _hash;
+		uint32_t _size;
+		uint32_t _grid_size;
+
+		std::mutex                                  _lock;
+		std::vector<float>                          _data;
+		std::shared_ptr<streamfx::obs::gs::texture> _texture;
+
+		public:
+		/** Parse the given file content. Does not require a graphics context, and throws if the content is invalid.
+		 *
+		 * @param content Raw content of the file.
+		 * @param extension Extension of the file including the dot, used to pick between '.cube' and '.3dl'.
+		 */
+		file(const std::vector<char>& content, std::string_view extension);
+		~file();
+
+		/** Hash of the file content, which identifies the LUT. */
+		uint64_t hash();
+
+		/** Number of lattice points along each axis. */
+		uint32_t size();
+
+		/** Number of blue slices along each axis of the texture. */
+		uint32_t grid_size();
+
+		/** GPU texture of the LUT, which is created on first use. Requires a graphics context. */
+		std::shared_ptr<streamfx::obs::gs::texture> texture();
+
+		static uint64_t hash(const std::vector<char>& content);
+
+		/** Read a file from disk in full. */
+		static std::vector<char> read(const std::filesystem::path& path);
+	};
+} // namespace streamfx::gfx::lut
@@ -13,6 +13,8 @@ gs_color_format format_from_depth(streamfx::gfx::lut::color_depth depth)
 	case streamfx::gfx::lut::color_depth::_2:
 	case streamfx::gfx::lut::color_depth::_4:
 	case streamfx::gfx::lut::color_depth::_6:
+		// Coarse LUTs are interpolated between their points, so store them with more precision than the output has.
+		return gs_color_format::GS_RGBA16F;
 	case streamfx::gfx::lut::color_depth::_8:
 		return gs_color_format::GS_RGBA;
 	case streamfx::gfx::lut::color_depth::_10:
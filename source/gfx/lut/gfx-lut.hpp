@@ -45,4 +45,9 @@ namespace streamfx::gfx::lut {
 		_14     = 14,
 		_16     = 16,
 	};
+
+	enum class interpolation {
+		Trilinear,
+		Tetrahedral, // Exact on the gray axis and smoother for coarse LUTs, like most '.cube' files.
+	};
 } // namespace streamfx::gfx::lut
@@ -1,3 +1,579 @@
 // AUTOGENERATED COPYRIGHT HEADER START
 // Copyright (C) 2019-2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
 // AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-shader-param-audio.hpp"
+#include "strings.hpp"
+#include "gfx-shader.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/obs-source-tracker.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <sstream>
+#include <media-io/audio-io.h>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <emmintrin.h>
+#elif defined(D_PLATFORM_INSTR_ARM)
+#include <arm_neon.h>
+#endif
+#include "warning-enable.hpp"
+
+// UI:
+// Name/Key {
+//   Source = ...
+//   Size = 256...8192
+//   Window = Rectangular/Hann/Hamming/Blackman
+// }
+
+#define ST_I18N "Shader.Parameter.Audio"
+#define ST_KEY_SOURCE ".Source"
+#define ST_I18N_SOURCE ST_I18N ".Source"
+#define ST_KEY_SIZE ".Size"
+#define ST_I18N_SIZE ST_I18N ".Size"
+#define ST_KEY_WINDOW ".Window"
+#define ST_I18N_WINDOW ST_I18N ".Window"
+#define ST_I18N_WINDOW_RECTANGULAR ST_I18N_WINDOW ".Rectangular"
+#define ST_I18N_WINDOW_HANN ST_I18N_WINDOW ".Hann"
+#define ST_I18N_WINDOW_HAMMING ST_I18N_WINDOW ".Hamming"
+#define ST_I18N_WINDOW_BLACKMAN ST_I18N_WINDOW ".Blackman"
+
+#define ST_SIZE_MINIMUM 256
+#define ST_SIZE_MAXIMUM 8192
+#define ST_SIZE_DEFAULT 2048
+
+// UI:
+// Name/Key {
+//   Source = ...
+//   Smoothing = 0...5000ms
+// }
+
+#define ST_I18N_METER "Shader.Parameter.AudioMeter"
+#define ST_I18N_METER_SOURCE ST_I18N_METER ".Source"
+#define ST_KEY_SMOOTHING ".Smoothing"
+#define ST_I18N_METER_SMOOTHING ST_I18N_METER ".Smoothing"
+
+#define ST_SMOOTHING_DEFAULT 300.
+
+namespace {
+	double window_weight(streamfx::gfx::shader::audio_window window, size_t idx, size_t size)
+	{
+		constexpr double pi = 3.14159265358979323846;
+		double           t  = (2. * pi * static_cast<double>(idx)) / static_cast<double>(size - 1);
+		switch (window) {
+		case streamfx::gfx::shader::audio_window::Hann:
+			return 0.5 - 0.5 * std::cos(t);
+		case streamfx::gfx::shader::audio_window::Hamming:
+			return 0.54 - 0.46 * std::cos(t);
+		case streamfx::gfx::shader::audio_window::Blackman:
+			return 0.42 - 0.5 * std::cos(t) + 0.08 * std::cos(2. * t);
+		default:
+			return 1.;
+		}
+	}
+
+	/** In-place iterative radix-2 FFT. The size must be a power of two. */
+	void fft(std::vector<std::complex<float>>& data)
+	{
+		constexpr double pi   = 3.14159265358979323846;
+		size_t           size = data.size();
+
+		// Bit reversal permutation.
+		for (size_t idx = 1, rev = 0; idx < size; idx++) {
+			size_t bit = size >> 1;
+			for (; rev & bit; bit >>= 1) {
+				rev ^= bit;
+			}
+			rev ^= bit;
+			if (idx < rev) {
+				std::swap(data[idx], data[rev]);
+			}
+		}
+
+		// Butterflies, with the twiddle factors of each stage computed in double precision to avoid drift.
+		for (size_t length = 2; length <= size; length <<= 1) {
+			size_t                           half = length >> 1;
+			double                           step = -2. * pi / static_cast<double>(length);
+			std::vector<std::complex<float>> twiddles(half);
+			for (size_t idx = 0; idx < half; idx++) {
+				twiddles[idx] = std::polar(1.f, static_cast<float>(step * static_cast<double>(idx)));
+			}
+
+			for (size_t offset = 0; offset < size; offset += length) {
+				for (size_t idx = 0; idx < half; idx++) {
+					std::complex<float> a = data[offset + idx];
+					std::complex<float> b = data[offset + idx + half] * twiddles[idx];
+
+					data[offset + idx]        = a + b;
+					data[offset + idx + half] = a - b;
+				}
+			}
+		}
+	}
+
+	/** Sum of squares and largest magnitude of a plane of samples. */
+	void measure(const float* samples, size_t count, float& sum, float& peak)
+	{
+		size_t idx = 0;
+		sum        = 0.f;
+		peak       = 0.f;
+#if defined(D_PLATFORM_INSTR_X86)
+		if (count >= 4) {
+			__m128 vsum  = _mm_setzero_ps();
+			__m128 vpeak = _mm_setzero_ps();
+			__m128 vabs  = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			for (; (idx + 4) <= count; idx += 4) {
+				__m128 v = _mm_loadu_ps(samples + idx);
+				vsum     = _mm_add_ps(vsum, _mm_mul_ps(v, v));
+				vpeak    = _mm_max_ps(vpeak, _mm_and_ps(v, vabs));
+			}
+
+			float lanes_sum[4];
+			float lanes_peak[4];
+			_mm_storeu_ps(lanes_sum, vsum);
+			_mm_storeu_ps(lanes_peak, vpeak);
+			sum  = (lanes_sum[0] + lanes_sum[1]) + (lanes_sum[2] + lanes_sum[3]);
+			peak = std::max(std::max(lanes_peak[0], lanes_peak[1]), std::max(lanes_peak[2], lanes_peak[3]));
+		}
+#elif defined(D_PLATFORM_INSTR_ARM)
+		if (count >= 4) {
+			float32x4_t vsum  = vdupq_n_f32(0.f);
+			float32x4_t vpeak = vdupq_n_f32(0.f);
+			for (; (idx + 4) <= count; idx += 4) {
+				float32x4_t v = vld1q_f32(samples + idx);
+				vsum          = vmlaq_f32(vsum, v, v);
+				vpeak         = vmaxq_f32(vpeak, vabsq_f32(v));
+			}
+
+			float lanes_sum[4];
+			float lanes_peak[4];
+			vst1q_f32(lanes_sum, vsum);
+			vst1q_f32(lanes_peak, vpeak);
+			sum  = (lanes_sum[0] + lanes_sum[1]) + (lanes_sum[2] + lanes_sum[3]);
+			peak = std::max(std::max(lanes_peak[0], lanes_peak[1]), std::max(lanes_peak[2], lanes_peak[3]));
+		}
+#endif
+		for (; idx < count; idx++) {
+			sum += samples[idx] * samples[idx];
+			peak = std::max(peak, std::abs(samples[idx]));
+		}
+	}
+} // namespace
+
+streamfx::gfx::shader::audio_parameter::audio_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _keys(), _source_name(), _size(ST_SIZE_DEFAULT), _window(audio_window::Hann), _active(false), _dirty(true), _source(), _source_audio(), _source_active(), _capture(std::make_shared<capture>()), _task(), _texture()
+{
+	char string_buffer[256];
+
+	// Build keys.
+	{
+		_keys.reserve(3);
+		{ // Source
+			snprintf(string_buffer, sizeof(string_buffer), "%s%s", get_key().data(), ST_KEY_SOURCE);
+			_keys.emplace_back(string_buffer);
+		}
+		{ // Size
+			snprintf(string_buffer, sizeof(string_buffer), "%s%s", get_key().data(), ST_KEY_SIZE);
+			_keys.emplace_back(string_buffer);
+		}
+		{ // Window
+			snprintf(string_buffer, sizeof(string_buffer), "%s%s", get_key().data(), ST_KEY_WINDOW);
+			_keys.emplace_back(string_buffer);
+		}
+	}
+
+	_capture->samples.resize(_size, 0.f);
+	_capture->position    = 0;
+	_capture->size        = _size;
+	_capture->window      = _window;
+	_capture->result_size = 0;
+}
+
+streamfx::gfx::shader::audio_parameter::~audio_parameter()
+{
+	// Stop listening first, so that the audio thread is done with us.
+	_source_audio.reset();
+	_source_active.reset();
+
+	if (_task) {
+		_task->await_completion();
+	}
+
+	if (_texture) {
+		auto gctx = streamfx::obs::gs::context();
+		_texture.reset();
+	}
+}
+
+void streamfx::gfx::shader::audio_parameter::defaults(obs_data_t* settings)
+{
+	obs_data_set_default_string(settings, _keys[0].c_str(), "");
+	obs_data_set_default_int(settings, _keys[1].c_str(), ST_SIZE_DEFAULT);
+	obs_data_set_default_int(settings, _keys[2].c_str(), static_cast<long long>(audio_window::Hann));
+}
+
+void streamfx::gfx::shader::audio_parameter::properties(obs_properties_t* props, obs_data_t* settings)
+{
+	if (!is_visible())
+		return;
+
+	obs_properties_t* pr = obs_properties_create();
+	{
+		auto p = obs_properties_add_group(props, get_key().data(), has_name() ? get_name().data() : get_key().data(), OBS_GROUP_NORMAL, pr);
+		if (has_description())
+			obs_property_set_long_description(p, get_description().data());
+	}
+
+	{
+		auto p = obs_properties_add_list(pr, _keys[0].c_str(), D_TRANSLATE(ST_I18N_SOURCE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+		obs_property_list_add_string(p, "", "");
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_audio_sources, D_TRANSLATE(S_SOURCETYPE_SOURCE));
+	}
+
+	{
+		auto p = obs_properties_add_list(pr, _keys[1].c_str(), D_TRANSLATE(ST_I18N_SIZE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		for (long long size = ST_SIZE_MINIMUM; size <= ST_SIZE_MAXIMUM; size <<= 1) {
+			obs_property_list_add_int(p, std::to_string(size).c_str(), size);
+		}
+	}
+
+	{
+		auto p = obs_properties_add_list(pr, _keys[2].c_str(), D_TRANSLATE(ST_I18N_WINDOW), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_WINDOW_RECTANGULAR), static_cast<int64_t>(audio_window::Rectangular));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_WINDOW_HANN), static_cast<int64_t>(audio_window::Hann));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_WINDOW_HAMMING), static_cast<int64_t>(audio_window::Hamming));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_WINDOW_BLACKMAN), static_cast<int64_t>(audio_window::Blackman));
+	}
+}
+
+void streamfx::gfx::shader::audio_parameter::update(obs_data_t* settings)
+{
+	// Value is assigned elsewhere.
+	if (is_automatic())
+		return;
+
+	if (const char* source_name = obs_data_get_string(settings, _keys[0].c_str()); _source_name != source_name) {
+		_source_name = source_name;
+		_dirty       = true;
+	}
+
+	// Only powers of two are supported by the FFT.
+	uint32_t size = ST_SIZE_MINIMUM;
+	while ((size < ST_SIZE_MAXIMUM) && (size < static_cast<uint32_t>(std::max<long long>(obs_data_get_int(settings, _keys[1].c_str()), 0)))) {
+		size <<= 1;
+	}
+	_size   = size;
+	_window = static_cast<audio_window>(obs_data_get_int(settings, _keys[2].c_str()));
+
+	std::unique_lock<std::mutex> ul(_capture->lock);
+	if (_capture->size != _size) {
+		_capture->samples.assign(_size, 0.f);
+		_capture->position = 0;
+		_capture->size     = _size;
+	}
+	_capture->window = _window;
+}
+
+void streamfx::gfx::shader::audio_parameter::assign()
+{
+	if (is_automatic())
+		return;
+
+	if (_dirty) {
+		_dirty = false;
+
+		// Remove now unused references.
+		_source_audio.reset();
+		_source_active.reset();
+		_source.reset();
+
+		if (!_source_name.empty()) {
+			if (auto source = ::streamfx::obs::source(_source_name); source) {
+				// Sources like media only play back while they are active.
+				if (_active) {
+					_source_active = ::streamfx::obs::source_active_reference::add_active_reference(source);
+				}
+
+				_source_audio = std::make_shared<::streamfx::obs::audio_signal_handler>(source);
+				_source_audio->event.add(std::bind(&audio_parameter::on_audio, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+				_source = source;
+			}
+		}
+	}
+
+	// Upload what the worker finished, and immediately give it the next frame to work on. Nothing here ever waits,
+	// so the texture trails the audio by one frame.
+	if (!_task || _task->is_completed()) {
+		if (_task && (_capture->result_size > 0)) {
+			uint32_t width = _capture->result_size / 2;
+			if (!_texture || (_texture->get_width() != width)) {
+				_texture = std::make_shared<streamfx::obs::gs::texture>(width, 2, GS_R32F, 1, nullptr, streamfx::obs::gs::texture::flags::Dynamic);
+			}
+			gs_texture_set_image(_texture->get_object(), reinterpret_cast<const uint8_t*>(_capture->result.data()), width * sizeof(float), false);
+		}
+
+		if (_source_audio) {
+			auto data = _capture;
+			_task     = streamfx::threadpool()->push([data](streamfx::util::threadpool::task_data_t) { analyze(data); }, nullptr, streamfx::util::threadpool::priority::REALTIME);
+		} else {
+			_task.reset();
+		}
+	}
+
+	get_parameter().set_texture(_texture);
+}
+
+void streamfx::gfx::shader::audio_parameter::active(bool active)
+{
+	_active = active;
+	if (active) {
+		auto source = _source.lock();
+		if (source) {
+			_source_active = ::streamfx::obs::source_active_reference::add_active_reference(source);
+		}
+	} else {
+		_source_active.reset();
+	}
+}
+
+bool streamfx::gfx::shader::audio_parameter::is_dynamic()
+{
+	return _dirty || _source_audio;
+}
+
+void streamfx::gfx::shader::audio_parameter::on_audio(::streamfx::obs::source, const struct audio_data* audio, bool muted)
+{
+	// Audio from libobs is always planar floating point at this point.
+	size_t channels = audio_output_get_channels(obs_get_audio());
+	size_t planes   = 0;
+	for (size_t idx = 0; idx < std::min<size_t>(channels, MAX_AV_PLANES); idx++) {
+		if (audio->data[idx]) {
+			planes = idx + 1;
+		}
+	}
+	float scale = ((planes > 0) && !muted) ? (1.f / static_cast<float>(planes)) : 0.f;
+
+	// Only copy while holding the lock, so the audio thread is never held up by the analysis.
+	std::unique_lock<std::mutex> ul(_capture->lock);
+	auto&                        samples = _capture->samples;
+	for (size_t frame = 0; frame < audio->frames; frame++) {
+		float value = 0.f;
+		for (size_t idx = 0; idx < planes; idx++) {
+			if (audio->data[idx]) {
+				value += reinterpret_cast<const float*>(audio->data[idx])[frame];
+			}
+		}
+		samples[_capture->position] = value * scale;
+		_capture->position          = (_capture->position + 1) % samples.size();
+	}
+}
+
+void streamfx::gfx::shader::audio_parameter::analyze(std::shared_ptr<capture> data)
+{
+	std::vector<float> samples;
+	audio_window       window;
+	size_t             position;
+	{
+		std::unique_lock<std::mutex> ul(data->lock);
+		samples  = data->samples;
+		position = data->position;
+		window   = data->window;
+	}
+
+	size_t size = samples.size();
+	size_t half = size / 2;
+
+	// Unroll the ring buffer into chronological order and apply the window.
+	std::vector<std::complex<float>> bins(size);
+	double                           weight_sum = 0.;
+	for (size_t idx = 0; idx < size; idx++) {
+		double weight = window_weight(window, idx, size);
+		bins[idx]     = std::complex<float>(static_cast<float>(samples[(position + idx) % size] * weight), 0.f);
+		weight_sum += weight;
+	}
+	fft(bins);
+
+	// Spectrum first, scaled so that a full scale sine wave reads as 1.0, followed by the most recent samples.
+	data->result.resize(size);
+	float normalize = static_cast<float>(2. / std::max(weight_sum, 1.));
+	for (size_t idx = 0; idx < half; idx++) {
+		data->result[idx] = std::abs(bins[idx]) * normalize;
+	}
+	for (size_t idx = 0; idx < half; idx++) {
+		data->result[half + idx] = samples[(position + half + idx) % size];
+	}
+	data->result_size = static_cast<uint32_t>(size);
+}
+
+streamfx::gfx::shader::audio_meter_parameter::audio_meter_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _keys(), _source_name(), _smoothing(static_cast<float>(ST_SMOOTHING_DEFAULT / 1000.)), _active(false), _dirty(true), _source(), _source_audio(), _source_active(), _meter(std::make_shared<meter>())
+{
+	char string_buffer[256];
+
+	// Build keys.
+	{
+		_keys.reserve(2);
+		{ // Source
+			snprintf(string_buffer, sizeof(string_buffer), "%s%s", get_key().data(), ST_KEY_SOURCE);
+			_keys.emplace_back(string_buffer);
+		}
+		{ // Smoothing
+			snprintf(string_buffer, sizeof(string_buffer), "%s%s", get_key().data(), ST_KEY_SMOOTHING);
+			_keys.emplace_back(string_buffer);
+		}
+	}
+
+	_meter->smoothing.store(_smoothing);
+}
+
+streamfx::gfx::shader::audio_meter_parameter::~audio_meter_parameter()
+{
+	// Stop listening first, so that the audio thread is done with us.
+	_source_audio.reset();
+	_source_active.reset();
+}
+
+void streamfx::gfx::shader::audio_meter_parameter::defaults(obs_data_t* settings)
+{
+	obs_data_set_default_string(settings, _keys[0].c_str(), "");
+	obs_data_set_default_double(settings, _keys[1].c_str(), ST_SMOOTHING_DEFAULT);
+}
+
+void streamfx::gfx::shader::audio_meter_parameter::properties(obs_properties_t* props, obs_data_t* settings)
+{
+	if (!is_visible())
+		return;
+
+	obs_properties_t* pr = obs_properties_create();
+	{
+		auto p = obs_properties_add_group(props, get_key().data(), has_name() ? get_name().data() : get_key().data(), OBS_GROUP_NORMAL, pr);
+		if (has_description())
+			obs_property_set_long_description(p, get_description().data());
+	}
+
+	{
+		auto p = obs_properties_add_list(pr, _keys[0].c_str(), D_TRANSLATE(ST_I18N_METER_SOURCE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+		obs_property_list_add_string(p, "", "");
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_audio_sources, D_TRANSLATE(S_SOURCETYPE_SOURCE));
+	}
+
+	{
+		auto p = obs_properties_add_float_slider(pr, _keys[1].c_str(), D_TRANSLATE(ST_I18N_METER_SMOOTHING), 0., 5000., 1.);
+		obs_property_float_set_suffix(p, " ms");
+	}
+}
+
+void streamfx::gfx::shader::audio_meter_parameter::update(obs_data_t* settings)
+{
+	// Value is assigned elsewhere.
+	if (is_automatic())
+		return;
+
+	if (const char* source_name = obs_data_get_string(settings, _keys[0].c_str()); _source_name != source_name) {
+		_source_name = source_name;
+		_dirty       = true;
+	}
+
+	_smoothing = static_cast<float>(std::max(obs_data_get_double(settings, _keys[1].c_str()), 0.) / 1000.);
+	_meter->smoothing.store(_smoothing, std::memory_order_relaxed);
+}
+
+void streamfx::gfx::shader::audio_meter_parameter::assign()
+{
+	if (is_automatic())
+		return;
+
+	if (_dirty) {
+		_dirty = false;
+
+		// Remove now unused references.
+		_source_audio.reset();
+		_source_active.reset();
+		_source.reset();
+
+		// Levels of the previous source should not linger on.
+		_meter = std::make_shared<meter>();
+		_meter->smoothing.store(_smoothing);
+
+		if (!_source_name.empty()) {
+			if (auto source = ::streamfx::obs::source(_source_name); source) {
+				// Sources like media only play back while they are active.
+				if (_active) {
+					_source_active = ::streamfx::obs::source_active_reference::add_active_reference(source);
+				}
+
+				_source_audio = std::make_shared<::streamfx::obs::audio_signal_handler>(source);
+				_source_audio->event.add(std::bind(&audio_meter_parameter::on_audio, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+				_source = source;
+			}
+		}
+	}
+
+	// Pick up the newest levels if the audio thread published any, otherwise keep showing the last ones.
+	if (_meter->middle.load(std::memory_order_relaxed) & meter::fresh) {
+		_meter->front = _meter->middle.exchange(_meter->front, std::memory_order_acq_rel) & ~meter::fresh;
+	}
+	auto& levels = _meter->buffers[_meter->front];
+	get_parameter().set_float4(levels.rms[0], levels.rms[1], levels.peak[0], levels.peak[1]);
+}
+
+void streamfx::gfx::shader::audio_meter_parameter::active(bool active)
+{
+	_active = active;
+	if (active) {
+		auto source = _source.lock();
+		if (source) {
+			_source_active = ::streamfx::obs::source_active_reference::add_active_reference(source);
+		}
+	} else {
+		_source_active.reset();
+	}
+}
+
+bool streamfx::gfx::shader::audio_meter_parameter::is_dynamic()
+{
+	return _dirty || _source_audio;
+}
+
+void streamfx::gfx::shader::audio_meter_parameter::on_audio(::streamfx::obs::source, const struct audio_data* audio, bool muted)
+{
+	auto&  data        = *_meter;
+	size_t channels    = std::min<size_t>(audio_output_get_channels(obs_get_audio()), 2);
+	float  sample_rate = static_cast<float>(audio_output_get_sample_rate(obs_get_audio()));
+	if (audio->frames == 0) {
+		return;
+	}
+
+	// Audio from libobs is always planar floating point at this point.
+	float mean_square[2] = {0.f, 0.f};
+	float peak[2]        = {0.f, 0.f};
+	if (!muted) {
+		for (size_t idx = 0; idx < channels; idx++) {
+			if (audio->data[idx]) {
+				measure(reinterpret_cast<const float*>(audio->data[idx]), audio->frames, mean_square[idx], peak[idx]);
+				mean_square[idx] /= static_cast<float>(audio->frames);
+			}
+		}
+		if ((channels < 2) || !audio->data[1]) {
+			mean_square[1] = mean_square[0];
+			peak[1]        = peak[0];
+		}
+	}
+
+	// Exponential decay over the smoothing time, independent of how many frames each callback delivers.
+	float smoothing = data.smoothing.load(std::memory_order_relaxed);
+	float decay     = (smoothing > 0.f) ? std::exp(-static_cast<float>(audio->frames) / (smoothing * sample_rate)) : 0.f;
+	for (size_t idx = 0; idx < 2; idx++) {
+		data.mean_square[idx] = mean_square[idx] + (data.mean_square[idx] - mean_square[idx]) * decay;
+		data.peak[idx]        = std::max(peak[idx], data.peak[idx] * decay);
+	}
+
+	// Publish without ever waiting on the graphics thread.
+	auto& levels = data.buffers[data.back];
+	for (size_t idx = 0; idx < 2; idx++) {
+		levels.rms[idx]  = std::sqrt(data.mean_square[idx]);
+		levels.peak[idx] = data.peak[idx];
+	}
+	data.back = data.middle.exchange(data.back | meter::fresh, std::memory_order_acq_rel) & ~meter::fresh;
+}
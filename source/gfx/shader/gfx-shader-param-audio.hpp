@@ -1,3 +1,159 @@
 // AUTOGENERATED COPYRIGHT HEADER START
 // Copyright (C) 2019-2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
 // AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx-shader-param.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "obs/obs-signal-handler.hpp"
+#include "obs/obs-source-active-reference.hpp"
+#include "obs/obs-weak-source.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	namespace shader {
+		enum class audio_window : int64_t {
+			Rectangular = 0,
+			Hann        = 1,
+			Hamming     = 2,
+			Blackman    = 3,
+		};
+
+		/** Audio of another source, provided to the shader as a texture.
+		 *
+		 * The texture is 'size / 2' texels wide and two texels high. The first row holds the magnitude of each frequency
+		 * bin of the spectrum, and the second row holds the most recent samples of the waveform, both as single floats.
+		 * Channels are mixed down to mono before either is computed.
+		 */
+		struct audio_parameter : public parameter {
+			struct capture {
+				std::mutex lock;
+
+				// Ring buffer of the mono mix, written by the audio thread.
+				std::vector<float> samples;
+				size_t             position;
+				uint32_t           size;
+				audio_window       window;
+
+				// Written by the worker, and only read once its task has completed.
+				std::vector<float> result;
+				uint32_t           result_size;
+			};
+
+			std::vector<std::string> _keys;
+
+			// Data
+			std::string  _source_name;
+			uint32_t     _size;
+			audio_window _window;
+			bool         _active;
+			bool         _dirty;
+
+			// Data: Source
+			::streamfx::obs::weak_source                            _source;
+			std::shared_ptr<streamfx::obs::audio_signal_handler>    _source_audio;
+			std::shared_ptr<streamfx::obs::source_active_reference> _source_active;
+
+			// Data: Analysis
+			std::shared_ptr<capture>                          _capture;
+			std::shared_ptr<streamfx::util::threadpool::task> _task;
+			std::shared_ptr<streamfx::obs::gs::texture>       _texture;
+
+			public:
+			audio_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix);
+			virtual ~audio_parameter();
+
+			void defaults(obs_data_t* settings) override;
+
+			void properties(obs_properties_t* props, obs_data_t* settings) override;
+
+			void update(obs_data_t* settings) override;
+
+			void assign() override;
+
+			void active(bool enabled) override;
+
+			bool is_dynamic() override;
+
+			private:
+			void on_audio(::streamfx::obs::source, const struct audio_data* audio, bool muted);
+
+			static void analyze(std::shared_ptr<capture> data);
+		};
+
+		/** Level of another source, provided to the shader as a float4.
+		 *
+		 * Holds the RMS of the first two channels in x and y, and their peak in z and w, with mono sources repeating the
+		 * first channel. Peaks rise immediately and fall off over the smoothing time, which the RMS is averaged over.
+		 * Unlike an audio parameter, this is cheap enough to compute on the audio thread as the audio arrives.
+		 */
+		struct audio_meter_parameter : public parameter {
+			struct levels {
+				float rms[2];
+				float peak[2];
+			};
+
+			struct meter {
+				// Lock free triple buffer, the audio thread writes 'back' while the graphics thread reads 'front'. The
+				// remaining one is swapped through 'middle', with 'fresh' set whenever it holds new levels.
+				std::array<levels, 3> buffers = {};
+				std::atomic<uint8_t>  middle  = 1;
+				uint8_t               back    = 0;
+				uint8_t               front   = 2;
+
+				// Only touched by the audio thread.
+				float mean_square[2] = {0.f, 0.f};
+				float peak[2]        = {0.f, 0.f};
+
+				// In seconds.
+				std::atomic<float> smoothing = 0.f;
+
+				static constexpr uint8_t fresh = 0x80;
+			};
+
+			std::vector<std::string> _keys;
+
+			// Data
+			std::string _source_name;
+			float       _smoothing;
+			bool        _active;
+			bool        _dirty;
+
+			// Data: Source
+			::streamfx::obs::weak_source                            _source;
+			std::shared_ptr<streamfx::obs::audio_signal_handler>    _source_audio;
+			std::shared_ptr<streamfx::obs::source_active_reference> _source_active;
+
+			// Data: Analysis
+			std::shared_ptr<meter> _meter;
+
+			public:
+			audio_meter_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix);
+			virtual ~audio_meter_parameter();
+
+			void defaults(obs_data_t* settings) override;
+
+			void properties(obs_properties_t* props, obs_data_t* settings) override;
+
+			void update(obs_data_t* settings) override;
+
+			void assign() override;
+
+			void active(bool enabled) override;
+
+			bool is_dynamic() override;
+
+			private:
+			void on_audio(::streamfx::obs::source, const struct audio_data* audio, bool muted);
+		};
+	} // namespace shader
+} // namespace streamfx::gfx
@@ -67,7 +67,7 @@ streamfx::gfx::shader::basic_field_type streamfx::gfx::shader::get_field_type_fr
 	return basic_field_type::Input;
 }
 
-streamfx::gfx::shader::basic_parameter::basic_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _field_type(basic_field_type::Input), _suffix(), _keys(), _names(), _min(), _max(), _step(), _values()
+streamfx::gfx::shader::basic_parameter::basic_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _field_type(basic_field_type::Input), _suffix(), _keys(), _names(), _min(), _max(), _step(), _values(), _dirty(true)
 {
 	char string_buffer[256];
 
@@ -190,11 +190,16 @@ void streamfx::gfx::shader::bool_parameter::update(obs_data_t* settings)
 	if (get_size() == 1) {
 		_data[0] = static_cast<int32_t>(obs_data_get_int(settings, get_key().data()));
 	}
+	_dirty = true;
 }
 
 void streamfx::gfx::shader::bool_parameter::assign()
 {
+	if (!_dirty)
+		return;
+
 	get_parameter().set_value(_data.data(), _data.size());
+	_dirty = false;
 }
 
 streamfx::gfx::shader::float_parameter::float_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : basic_parameter(parent, param, prefix)
@@ -289,14 +294,16 @@ void streamfx::gfx::shader::float_parameter::update(obs_data_t* settings)
 	for (std::size_t idx = 0; idx < get_size(); idx++) {
 		_data[idx].f32 = static_cast<float_t>(obs_data_get_double(settings, key_at(idx).data())) * _scale[idx].f32;
 	}
+	_dirty = true;
 }
 
 void streamfx::gfx::shader::float_parameter::assign()
 {
-	if (is_automatic())
+	if (is_automatic() || !_dirty)
 		return;
 
 	get_parameter().set_value(_data.data(), get_size());
+	_dirty = false;
 }
 static inline obs_property_t* build_int_property(streamfx::gfx::shader::basic_field_type ft, obs_properties_t* props, const char* key, const char* name, int32_t min, int32_t max, int32_t step, std::list<streamfx::gfx::shader::basic_enum_data> edata)
 {
@@ -389,12 +396,14 @@ void streamfx::gfx::shader::int_parameter::update(obs_data_t* settings)
 	for (std::size_t idx = 0; idx < get_size(); idx++) {
 		_data[idx].i32 = static_cast<int32_t>(obs_data_get_int(settings, key_at(idx).data()) * _scale[idx].i32);
 	}
+	_dirty = true;
 }
 
 void streamfx::gfx::shader::int_parameter::assign()
 {
-	if (is_automatic())
+	if (is_automatic() || !_dirty)
 		return;
 
 	get_parameter().set_value(_data.data(), get_size());
+	_dirty = false;
 }
@@ -52,6 +52,9 @@ namespace streamfx::gfx {
 			// Enumeration Information
 			std::list<basic_enum_data> _values;
 
+			// Whether the value changed since it was last assigned. The effect keeps what was assigned until then.
+			bool _dirty;
+
 			public:
 			basic_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix);
 			virtual ~basic_parameter();
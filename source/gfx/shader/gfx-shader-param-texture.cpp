@@ -10,7 +10,6 @@
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "obs/obs-source-tracker.hpp"
-#include "util/util-platform.hpp"
 
 #include "warning-disable.hpp"
 #include <map>
@@ -18,10 +17,6 @@
 #include <stdexcept>
 #include "warning-enable.hpp"
 
-// TODO:
-// - FFT Audio Conversion
-// - FFT Variable Size...
-
 // UI:
 // Name/Key {
 //   Type = File/Source/Sink
@@ -41,6 +36,7 @@
 
 static constexpr std::string_view _annotation_field_type      = "field_type";
 static constexpr std::string_view _annotation_default         = "default";
+static constexpr std::string_view _annotation_mipmaps         = "mipmaps";
 static constexpr std::string_view _annotation_enum_entry      = "enum_%zu";
 static constexpr std::string_view _annotation_enum_entry_name = "enum_%zu_name";
 
@@ -59,7 +55,7 @@ streamfx::gfx::shader::texture_field_type streamfx::gfx::shader::get_texture_fie
 	return texture_field_type::Input;
 }
 
-streamfx::gfx::shader::texture_parameter::texture_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _field_type(texture_field_type::Input), _keys(), _values(), _type(texture_type::File), _active(false), _visible(false), _dirty(true), _dirty_ts(std::chrono::high_resolution_clock::now()), _file_path(), _file_texture(), _source_name(), _source(), _source_child(), _source_active(), _source_visible(), _source_rendertarget()
+streamfx::gfx::shader::texture_parameter::texture_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _field_type(texture_field_type::Input), _keys(), _values(), _type(texture_type::File), _active(false), _visible(false), _dirty(true), _dirty_ts(std::chrono::high_resolution_clock::now()), _file_path(), _file_texture(), _file_changed(false), _file_watch(), _file_mipmaps(false), _file_image(), _file_request(), _image_cache(streamfx::gfx::image_cache::instance()), _source_name(), _source(), _source_child(), _source_active(), _source_visible(), _source_texture()
 {
 	char string_buffer[256];
 
@@ -87,6 +83,9 @@ streamfx::gfx::shader::texture_parameter::texture_parameter(streamfx::gfx::shade
 	if (auto anno = get_parameter().get_annotation(_annotation_default); anno) {
 		_default = std::filesystem::path(anno.get_default_string());
 	}
+	if (auto anno = get_parameter().get_annotation(_annotation_mipmaps); anno) {
+		_file_mipmaps = anno.get_default_bool();
+	}
 
 	if (field_type() == texture_field_type::Enum) {
 		for (std::size_t idx = 0; idx < std::numeric_limits<std::size_t>::max(); idx++) {
@@ -188,22 +187,8 @@ void streamfx::gfx::shader::texture_parameter::properties(obs_properties_t* prop
 		{
 			auto p = obs_properties_add_list(pr, _keys[2].c_str(), D_TRANSLATE(ST_I18N_SOURCE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 			obs_property_list_add_string(p, "", "");
-			obs::source_tracker::instance()->enumerate(
-				[&p](std::string name, ::streamfx::obs::source) {
-					std::stringstream sstr;
-					sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-					obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-					return false;
-				},
-				obs::source_tracker::filter_video_sources);
-			obs::source_tracker::instance()->enumerate(
-				[&p](std::string name, ::streamfx::obs::source) {
-					std::stringstream sstr;
-					sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-					obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-					return false;
-				},
-				obs::source_tracker::filter_scenes);
+			obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_video_sources, D_TRANSLATE(S_SOURCETYPE_SOURCE));
+			obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_scenes, D_TRANSLATE(S_SOURCETYPE_SCENE));
 		}
 
 		modified_type(this, props, nullptr, settings);
@@ -237,6 +222,12 @@ void streamfx::gfx::shader::texture_parameter::update(obs_data_t* settings)
 			_file_path = file_path;
 			_dirty     = true;
 			_dirty_ts  = std::chrono::high_resolution_clock::now() - std::chrono::milliseconds(1);
+
+			// Reload the texture whenever the file is changed on disk.
+			_file_watch.reset();
+			if (!_file_path.empty()) {
+				_file_watch = streamfx::util::file_watcher::instance()->add(_file_path, [this]() { _file_changed = true; });
+			}
 		}
 	} else if (_type == texture_type::Source) {
 		const char* source_name = obs_data_get_string(settings, _keys[2].c_str());
@@ -254,6 +245,11 @@ void streamfx::gfx::shader::texture_parameter::assign()
 	if (is_automatic())
 		return;
 
+	if (_file_changed.exchange(false)) {
+		_dirty    = true;
+		_dirty_ts = std::chrono::high_resolution_clock::now() - std::chrono::milliseconds(1);
+	}
+
 	// If the data has been marked dirty, and the future timestamp minus the now is smaller than 0ms.
 	if (_dirty && ((_dirty_ts - std::chrono::high_resolution_clock::now()) < std::chrono::milliseconds(0))) {
 		// Reload or Reacquire everything necessary.
@@ -263,14 +259,21 @@ void streamfx::gfx::shader::texture_parameter::assign()
 			_source_child.reset();
 			_source_active.reset();
 			_source_visible.reset();
-			_source_rendertarget.reset();
-			_file_texture.reset();
+			_source_texture.reset();
+			_file_request.reset();
 
 			if (((field_type() == texture_field_type::Input) && (_type == texture_type::File)) || (field_type() == texture_field_type::Enum)) {
+				// Decoding happens in the background, and the previous image stays until the new one is ready.
 				if (!_file_path.empty()) {
-					_file_texture = std::make_shared<streamfx::obs::gs::texture>(streamfx::util::platform::native_to_utf8(_file_path).generic_u8string().c_str());
+					_file_request = _image_cache->load(_file_path, _file_mipmaps);
+				} else {
+					_file_texture.reset();
+					_file_image.reset();
 				}
 			} else if ((field_type() == texture_field_type::Input) && (_type == texture_type::Source)) {
+				_file_texture.reset();
+				_file_image.reset();
+
 				// Try and grab the source itself.
 				auto source = ::streamfx::obs::source(_source_name);
 				if (!source) {
@@ -278,7 +281,7 @@ void streamfx::gfx::shader::texture_parameter::assign()
 				}
 
 				// Attach the child to our parent.
-				auto child = std::make_shared<::streamfx::obs::source_active_child>(source, get_parent()->get());
+				auto child = ::streamfx::obs::source_active_child::add_active_child(source, get_parent()->get());
 
 				// Create necessary visible and active objects.
 				decltype(_source_active)  active;
@@ -290,15 +293,12 @@ void streamfx::gfx::shader::texture_parameter::assign()
 					visible = ::streamfx::obs::source_showing_reference::add_showing_reference(source);
 				}
 
-				// Create the necessary render target to capture the source.
-				auto rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-
 				// Propagate all of this into the storage.
-				_source_rendertarget = rt;
-				_source_visible      = std::move(visible);
-				_source_active       = std::move(active);
-				_source_child        = child;
-				_source              = source;
+				_source_texture.reset();
+				_source_visible = std::move(visible);
+				_source_active  = std::move(active);
+				_source_child   = child;
+				_source         = source;
 			}
 
 			_dirty = false;
@@ -309,42 +309,36 @@ void streamfx::gfx::shader::texture_parameter::assign()
 		}
 	}
 
+	// Pick up images that finished loading, which at most requires an upload.
+	if (_file_request && _file_request->task->is_completed()) {
+		try {
+			if (!_file_request->result) {
+				throw std::runtime_error(_file_request->error);
+			}
+			_file_texture = _file_request->result->texture();
+			_file_image   = _file_request->result;
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Loading texture '%s' failed with error: %s", _file_request->path.u8string().c_str(), ex.what());
+			_file_texture.reset();
+			_file_image.reset();
+		}
+		_file_request.reset();
+	}
+
 	// If this is a source and active or visible, capture it.
-	if ((_type == texture_type::Source) && (_active || _visible) && _source_rendertarget) {
-		auto source = _source.lock();
+	if ((_type == texture_type::Source) && (_active || _visible) && _source_child) {
+		auto const& source = _source.resolve();
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_capture, "Parameter '%s'", get_key().data()};
 		::streamfx::obs::gs::debug_marker profiler2{::streamfx::obs::gs::debug_color_capture, "Capture '%s'", source.name().data()};
 #endif
-		uint32_t width  = source.width();
-		uint32_t height = source.height();
-
-		auto op = _source_rendertarget->render(width, height);
-
-		gs_matrix_push();
-		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
-
-		// ToDo: Figure out if this breaks some sources.
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-		gs_enable_blending(false);
-
-		gs_enable_color(true, true, true, true);
-
-		obs_source_video_render(source.get());
-
-		gs_blend_state_pop();
-		gs_matrix_pop();
+		// Shared with every other user that captures the same source in the same way this frame.
+		_source_texture = ::streamfx::gfx::source_texture::capture(source.get(), source.width(), source.height(), GS_RGBA, GS_CS_SRGB, false);
 	}
 
 	if (_type == texture_type::Source) {
-		if (_source_rendertarget) {
-			auto tex = _source_rendertarget->get_texture();
-			if (tex) {
-				get_parameter().set_texture(_source_rendertarget->get_texture(), false);
-			} else {
-				get_parameter().set_texture(nullptr, false);
-			}
+		if (_source_texture) {
+			get_parameter().set_texture(_source_texture, false);
 		} else {
 			get_parameter().set_texture(nullptr, false);
 		}
@@ -383,3 +377,9 @@ void streamfx::gfx::shader::texture_parameter::active(bool active)
 		_source_active.reset();
 	}
 }
+
+bool streamfx::gfx::shader::texture_parameter::is_dynamic()
+{
+	// Sources change every frame, and pending reloads have to reach the render target at some point.
+	return _dirty || _file_changed || _file_request || ((field_type() == texture_field_type::Input) && (_type == texture_type::Source));
+}
@@ -7,15 +7,18 @@
 #pragma once
 #include "common.hpp"
 #include "gfx-shader-param.hpp"
-#include "obs/gs/gs-rendertarget.hpp"
+#include "gfx/gfx-image-cache.hpp"
+#include "gfx/gfx-source-texture.hpp"
 #include "obs/gs/gs-texture.hpp"
 #include "obs/obs-source-active-child.hpp"
 #include "obs/obs-source-active-reference.hpp"
 #include "obs/obs-source-showing-reference.hpp"
 #include "obs/obs-tools.hpp"
 #include "obs/obs-weak-source.hpp"
+#include "util/util-file-watcher.hpp"
 
 #include "warning-disable.hpp"
+#include <atomic>
 #include <chrono>
 #include <mutex>
 #include "warning-enable.hpp"
@@ -62,8 +65,14 @@ namespace streamfx::gfx {
 			std::chrono::high_resolution_clock::time_point _dirty_ts;
 
 			// Data: File
-			std::filesystem::path                       _file_path;
-			std::shared_ptr<streamfx::obs::gs::texture> _file_texture;
+			std::filesystem::path                                _file_path;
+			std::shared_ptr<streamfx::obs::gs::texture>          _file_texture;
+			std::atomic<bool>                                    _file_changed;
+			std::shared_ptr<streamfx::util::file_watcher::watch> _file_watch;
+			bool                                                 _file_mipmaps;
+			std::shared_ptr<streamfx::gfx::image_cache::image>   _file_image;
+			std::shared_ptr<streamfx::gfx::image_cache::request> _file_request;
+			std::shared_ptr<streamfx::gfx::image_cache>          _image_cache;
 
 			// Data: Source
 			std::string                                              _source_name;
@@ -71,7 +80,7 @@ namespace streamfx::gfx {
 			std::shared_ptr<streamfx::obs::source_active_child>      _source_child;
 			std::shared_ptr<streamfx::obs::source_active_reference>  _source_active;
 			std::shared_ptr<streamfx::obs::source_showing_reference> _source_visible;
-			std::shared_ptr<streamfx::obs::gs::rendertarget>         _source_rendertarget;
+			std::shared_ptr<streamfx::obs::gs::texture>              _source_texture;
 
 			public:
 			texture_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix);
@@ -91,6 +100,8 @@ namespace streamfx::gfx {
 
 			void active(bool enabled) override;
 
+			bool is_dynamic() override;
+
 			public:
 			inline texture_field_type field_type()
 			{
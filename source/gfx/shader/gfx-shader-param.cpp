@@ -5,6 +5,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "gfx-shader-param.hpp"
+#include "gfx-shader-param-audio.hpp"
 #include "gfx-shader-param-basic.hpp"
 #include "gfx-shader-param-texture.hpp"
 
@@ -95,6 +96,15 @@ streamfx::gfx::shader::parameter_type streamfx::gfx::shader::get_type_from_strin
 	if ((v == "sampler")) {
 		return parameter_type::Sampler;
 	}
+	if ((v == "audio")) {
+		return parameter_type::Audio;
+	}
+	if ((v == "audio_meter") || (v == "meter")) {
+		return parameter_type::AudioMeter;
+	}
+	if ((v == "buffer")) {
+		return parameter_type::Buffer;
+	}
 	/* To decide on in the future:
 	 * - Double support?
 	 * - Half Support?
@@ -171,6 +181,11 @@ void streamfx::gfx::shader::parameter::visible(bool visible) {}
 
 void streamfx::gfx::shader::parameter::active(bool active) {}
 
+bool streamfx::gfx::shader::parameter::is_dynamic()
+{
+	return false;
+}
+
 std::shared_ptr<streamfx::gfx::shader::parameter> streamfx::gfx::shader::parameter::make_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix)
 {
 	if (!parent || !param) {
@@ -180,7 +195,7 @@ std::shared_ptr<streamfx::gfx::shader::parameter> streamfx::gfx::shader::paramet
 	parameter_type real_type = get_type_from_effect_type(param.get_type());
 	if (auto anno = param.get_annotation(ST_ANNO_TYPE); anno) {
 		// We have a type override.
-		real_type = get_type_from_string(param.get_default_string());
+		real_type = get_type_from_string(anno.get_default_string());
 	}
 
 	switch (real_type) {
@@ -192,6 +207,16 @@ std::shared_ptr<streamfx::gfx::shader::parameter> streamfx::gfx::shader::paramet
 		return std::make_shared<streamfx::gfx::shader::float_parameter>(parent, param, prefix);
 	case parameter_type::Texture:
 		return std::make_shared<streamfx::gfx::shader::texture_parameter>(parent, param, prefix);
+	case parameter_type::Audio:
+		if (param.get_type() != streamfx::obs::gs::effect_parameter::type::Texture) {
+			return nullptr;
+		}
+		return std::make_shared<streamfx::gfx::shader::audio_parameter>(parent, param, prefix);
+	case parameter_type::AudioMeter:
+		if (param.get_type() != streamfx::obs::gs::effect_parameter::type::Float4) {
+			return nullptr;
+		}
+		return std::make_shared<streamfx::gfx::shader::audio_meter_parameter>(parent, param, prefix);
 	default:
 		return nullptr;
 	}
@@ -30,7 +30,13 @@ namespace streamfx::gfx {
 			// Texture with dimensions stored in size (1 = Texture1D, 2 = Texture2D, 3 = Texture3D, 6 = TextureCube).
 			Texture,
 			// Sampler for Textures.
-			Sampler
+			Sampler,
+			// Spectrum and waveform of an audio source, provided as a Texture.
+			Audio,
+			// RMS and peak level of an audio source, provided as a float4.
+			AudioMeter,
+			// Intermediate buffer rendered by the shader itself, see shader::update_buffers.
+			Buffer
 		};
 
 		parameter_type get_type_from_effect_type(streamfx::obs::gs::effect_parameter::type type);
@@ -81,6 +87,9 @@ namespace streamfx::gfx {
 
 			virtual void active(bool enabled);
 
+			/** Whether the value can change between frames without an update, like the content of another source. */
+			virtual bool is_dynamic();
+
 			public:
 			inline streamfx::gfx::shader::shader* get_parent()
 			{
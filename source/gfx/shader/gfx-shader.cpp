@@ -8,9 +8,11 @@
 #include "obs/gs/gs-helper.hpp"
 #include "obs/obs-tools.hpp"
 #include "plugin.hpp"
+#include "util/util-platform.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include "warning-enable.hpp"
@@ -32,19 +34,35 @@
 #define ST_KEY_SHADER_SIZE_HEIGHT ST_KEY_SHADER_SIZE ".Height"
 #define ST_I18N_SHADER_SEED ST_I18N_SHADER ".Seed"
 #define ST_KEY_SHADER_SEED ST_KEY_SHADER ".Seed"
+#define ST_I18N_SHADER_RENDERSCALE ST_I18N_SHADER ".RenderScale"
+#define ST_KEY_SHADER_RENDERSCALE ST_KEY_SHADER ".RenderScale"
+#define ST_I18N_SHADER_RENDERINTERVAL ST_I18N_SHADER ".RenderInterval"
+#define ST_KEY_SHADER_RENDERINTERVAL ST_KEY_SHADER ".RenderInterval"
 #define ST_I18N_PARAMETERS ST_I18N ".Parameters"
 #define ST_KEY_PARAMETERS "Shader.Parameters"
 
+#define ST_ANNO_TYPE "type"
+#define ST_ANNO_BUFFER_TECHNIQUE "technique"
+#define ST_ANNO_BUFFER_SCALE "scale"
+#define ST_ANNO_BUFFER_FORMAT "format"
+#define ST_ANNO_BUFFER_PERSISTENT "persistent"
+#define ST_ANNO_BUFFER_STATIC "static"
+#define ST_ANNO_BUFFER_ORDER "order"
+#define ST_ANNO_BUFFER_ITERATIONS "iterations"
+#define ST_ANNO_BUFFER_ITERATION_SCALE "iteration_scale"
+
 streamfx::gfx::shader::shader::shader(obs_source_t* self, shader_mode mode)
 	: _self(self), _gfx_util(::streamfx::gfx::util::get()), _mode(mode), _base_width(1), _base_height(1), _active(true),
 
-	  _shader(), _shader_file(), _shader_tech("Draw"), _shader_file_mt(), _shader_file_sz(), _shader_file_tick(0),
+	  _shader(), _shader_file(), _shader_tech("Draw"), _shader_file_mt(), _shader_file_sz(), _shader_hash(0), _shader_file_changed(false), _shader_watch(), _shader_request(), _shader_task(),
 
-	  _width_type(size_type::Percent), _width_value(1.0), _height_type(size_type::Percent), _height_value(1.0),
+	  _width_type(size_type::Percent), _width_value(1.0), _height_type(size_type::Percent), _height_value(1.0), _render_scale(1.0), _render_interval(1),
 
 	  _have_current_params(false), _time(0), _time_loop(0), _loops(0), _random(), _random_seed(0),
 
-	  _rt_up_to_date(false), _rt(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE))
+	  _pure(false), _warm(false), _rt_up_to_date(false), _rt_skipped(0), _rt(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE)),
+
+	  _buffers(), _rt_pool(streamfx::gfx::rendertarget_pool::get())
 {
 	// Initialize random values.
 	_random.seed(static_cast<unsigned long long>(_random_seed));
@@ -96,78 +114,263 @@ bool streamfx::gfx::shader::shader::load_shader(const std::filesystem::path& fil
 		if (!std::filesystem::exists(file))
 			return false;
 
-		shader_dirty = is_shader_different(file);
-		param_dirty  = is_technique_different(tech) || shader_dirty;
+		shader_dirty = false;
+		param_dirty  = false;
+
+		// A different file is loaded in the background, and the current shader stays in use until it is ready.
+		if (is_shader_different(file)) {
+			queue_shader(file, tech, true);
+			return true;
+		}
 
-		// Update Shader
-		if (shader_dirty) {
-			_shader           = streamfx::obs::gs::effect(file);
-			_shader_file_mt   = std::filesystem::last_write_time(file);
-			_shader_file_sz   = std::filesystem::file_size(file);
-			_shader_file      = file;
-			_shader_file_tick = 0;
+		// A pending load decides the technique once it is done, as the current shader may not have it.
+		if (_shader_request) {
+			_shader_request->tech = tech;
+			return true;
 		}
 
 		// Update Params
-		if (param_dirty) {
-			auto settings = std::shared_ptr<obs_data_t>(obs_source_get_settings(_self), [](obs_data_t* p) { obs_data_release(p); });
+		if (_shader && is_technique_different(tech)) {
+			param_dirty = true;
+			update_technique(tech);
+		}
 
-			bool have_valid_tech = false;
-			for (std::size_t idx = 0; idx < _shader.count_techniques(); idx++) {
-				if (_shader.get_technique(idx).name() == tech) {
-					have_valid_tech = true;
-					break;
-				}
-			}
-			if (have_valid_tech) {
-				_shader_tech = tech;
-			} else {
-				_shader_tech = _shader.get_technique(0).name();
+		return true;
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Loading shader '%s' failed with error: %s", file.c_str(), ex.what());
+		return false;
+	} catch (...) {
+		return false;
+	}
+}
 
-				// Update source data.
-				obs_data_set_string(settings.get(), ST_KEY_SHADER_TECHNIQUE, _shader_tech.c_str());
+void streamfx::gfx::shader::shader::queue_shader(const std::filesystem::path& file, std::string_view tech, bool force)
+{
+	if (_shader_request && (_shader_request->file == file)) {
+		// Already on its way, only the technique may have changed.
+		_shader_request->tech = tech;
+		return;
+	}
+
+	auto request     = std::make_shared<load_request>();
+	request->file    = file;
+	request->tech    = tech;
+	request->force   = force;
+	request->file_mt = _shader_file_mt;
+	request->file_sz = _shader_file_sz;
+	request->changed = false;
+	request->hash    = 0;
+
+	_shader_request = request;
+	_shader_task    = streamfx::threadpool()->push([request](streamfx::util::threadpool::task_data_t) {
+		try {
+			// Polling only reads the file again if it actually changed on disk.
+			auto file_mt = std::filesystem::last_write_time(request->file);
+			auto file_sz = std::filesystem::file_size(request->file);
+			if (!request->force && (file_mt == request->file_mt) && (file_sz == request->file_sz)) {
+				return;
 			}
 
-			// Clear the shader parameters map and rebuild.
-			_shader_params.clear();
-			auto etech = _shader.get_technique(_shader_tech);
-			for (std::size_t idx = 0; idx < etech.count_passes(); idx++) {
-				auto pass         = etech.get_pass(idx);
-				auto fetch_params = [&](std::size_t count, std::function<streamfx::obs::gs::effect_parameter(std::size_t)> get_func) {
-					for (std::size_t vidx = 0; vidx < count; vidx++) {
-						auto el = get_func(vidx);
-						if (!el)
-							continue;
-
-						auto el_name = el.get_name();
-						auto fnd     = _shader_params.find(el_name);
-						if (fnd != _shader_params.end())
-							continue;
-
-						auto param = streamfx::gfx::shader::parameter::make_parameter(this, el, ST_KEY_PARAMETERS);
-
-						if (param) {
-							_shader_params.insert_or_assign(el_name, param);
-							param->defaults(settings.get());
-							param->update(settings.get());
-						}
+			request->file_mt = file_mt;
+			request->file_sz = file_sz;
+			request->code    = streamfx::obs::gs::effect::preprocess(request->file, request->hash);
+			request->changed = true;
+		} catch (const std::exception& ex) {
+			request->error = ex.what();
+		}
+	}, nullptr, streamfx::util::threadpool::priority::BACKGROUND);
+}
+
+void streamfx::gfx::shader::shader::apply_shader()
+{
+	auto request = std::move(_shader_request);
+	_shader_task.reset();
+
+	if (!request->error.empty()) {
+		DLOG_ERROR("Loading shader '%s' failed with error: %s", request->file.c_str(), request->error.c_str());
+		return;
+	}
+	if (!request->changed) {
+		return;
+	}
+
+	// Remember the file even if it fails to compile, so that it is only tried again once it changes.
+	if (!_shader_watch || (_shader_file != request->file)) {
+		_shader_watch = streamfx::util::file_watcher::instance()->add(request->file, [this]() { _shader_file_changed = true; });
+	}
+	_shader_file    = request->file;
+	_shader_file_mt = request->file_mt;
+	_shader_file_sz = request->file_sz;
+
+	// Saving a file without changing it, or only touching it, needs no compile.
+	if (_shader && (request->hash == _shader_hash)) {
+		if (is_technique_different(request->tech)) {
+			update_technique(request->tech);
+			obs_source_update_properties(_self);
+		}
+		return;
+	}
+
+	try {
+		// Only the compile itself has to happen here, everything else was done in the background.
+		_shader      = streamfx::obs::gs::effect(request->code, streamfx::util::platform::utf8_to_native(std::filesystem::absolute(request->file)).generic_u8string());
+		_shader_hash = request->hash;
+		update_technique(request->tech);
+		_rt_up_to_date = false;
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Loading shader '%s' failed with error: %s", request->file.c_str(), ex.what());
+		return;
+	}
+
+	// Let the properties catch up with the new techniques and parameters.
+	obs_source_update_properties(_self);
+}
+
+void streamfx::gfx::shader::shader::update_technique(std::string_view tech)
+{
+	auto settings = std::shared_ptr<obs_data_t>(obs_source_get_settings(_self), [](obs_data_t* p) { obs_data_release(p); });
+
+	bool have_valid_tech = false;
+	for (std::size_t idx = 0; idx < _shader.count_techniques(); idx++) {
+		if (_shader.get_technique(idx).name() == tech) {
+			have_valid_tech = true;
+			break;
+		}
+	}
+	if (have_valid_tech) {
+		_shader_tech = tech;
+	} else {
+		_shader_tech = _shader.get_technique(0).name();
+
+		// Update source data.
+		obs_data_set_string(settings.get(), ST_KEY_SHADER_TECHNIQUE, _shader_tech.c_str());
+	}
+
+	// Clear the shader parameters map and rebuild.
+	_shader_params.clear();
+	_rt_up_to_date = false;
+	_warm          = false;
+	update_buffers();
+
+	// Filters and transitions receive new input every frame, but a source only has to render again if it uses values
+	// that change by themselves. Persistent buffers carry the previous frame into the next one.
+	_pure = (_mode == shader_mode::Source);
+	for (auto& buf : _buffers) {
+		if (buf.persistent) {
+			_pure = false;
+		}
+	}
+
+	// Parameters used by the techniques of the buffers belong to the shader as well.
+	std::vector<streamfx::obs::gs::effect_technique> etechs;
+	for (auto& buf : _buffers) {
+		etechs.push_back(_shader.get_technique(buf.technique));
+	}
+	etechs.push_back(_shader.get_technique(_shader_tech));
+
+	for (auto& etech : etechs) {
+		for (std::size_t idx = 0; idx < etech.count_passes(); idx++) {
+			auto pass         = etech.get_pass(idx);
+			auto fetch_params = [&](std::size_t count, std::function<streamfx::obs::gs::effect_parameter(std::size_t)> get_func) {
+				for (std::size_t vidx = 0; vidx < count; vidx++) {
+					auto el = get_func(vidx);
+					if (!el)
+						continue;
+
+					auto el_name = el.get_name();
+					auto fnd     = std::find_if(_shader_params.begin(), _shader_params.end(), [&el_name](const std::shared_ptr<parameter>& v) { return v->get_parameter().get_name() == el_name; });
+					if ((el_name == "Time") || (el_name == "Random")) {
+						_pure = false;
 					}
-				};
+					if (fnd != _shader_params.end())
+						continue;
+
+					auto param = streamfx::gfx::shader::parameter::make_parameter(this, el, ST_KEY_PARAMETERS);
+
+					if (param) {
+						_shader_params.push_back(param);
+						param->defaults(settings.get());
+						param->update(settings.get());
+					}
+				}
+			};
+
+			auto gvp = [&](std::size_t idx) { return pass.get_vertex_parameter(idx); };
+			fetch_params(pass.count_vertex_parameters(), gvp);
+			auto gpp = [&](std::size_t idx) { return pass.get_pixel_parameter(idx); };
+			fetch_params(pass.count_pixel_parameters(), gpp);
+		}
+	}
+
+	// Keep the order by name the properties have always been shown in.
+	std::sort(_shader_params.begin(), _shader_params.end(), [](const std::shared_ptr<parameter>& a, const std::shared_ptr<parameter>& b) { return a->get_parameter().get_name() < b->get_parameter().get_name(); });
+}
+
+void streamfx::gfx::shader::shader::update_buffers()
+{
+	static const std::map<std::string_view, gs_color_format> formats = {
+		{"rgba", GS_RGBA}, {"rgba16", GS_RGBA16}, {"rgba16f", GS_RGBA16F}, {"rgba32f", GS_RGBA32F}, {"rg16f", GS_RG16F}, {"rg32f", GS_RG32F}, {"r8", GS_R8}, {"r16f", GS_R16F}, {"r32f", GS_R32F},
+	};
 
-				auto gvp = [&](std::size_t idx) { return pass.get_vertex_parameter(idx); };
-				fetch_params(pass.count_vertex_parameters(), gvp);
-				auto gpp = [&](std::size_t idx) { return pass.get_pixel_parameter(idx); };
-				fetch_params(pass.count_pixel_parameters(), gpp);
+	_buffers.clear();
+	for (std::size_t idx = 0; idx < _shader.count_parameters(); idx++) {
+		auto el = _shader.get_parameter(idx);
+		if (el.get_type() != streamfx::obs::gs::effect_parameter::type::Texture) {
+			continue;
+		}
+		if (auto anno = el.get_annotation(ST_ANNO_TYPE); !anno || (anno.get_default_string() != "buffer")) {
+			continue;
+		}
+
+		buffer buf;
+		buf.param           = el;
+		buf.scale           = 1.f;
+		buf.format          = GS_RGBA;
+		buf.persistent      = false;
+		buf.is_static       = false;
+		buf.valid           = false;
+		buf.valid_size      = {0, 0};
+		buf.order           = 0;
+		buf.iterations      = 1;
+		buf.iteration_scale = 1.f;
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_TECHNIQUE); anno) {
+			buf.technique = anno.get_default_string();
+		}
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_SCALE); anno) {
+			buf.scale = std::clamp(anno.get_default_float(), 1.f / 64.f, 4.f);
+		}
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_FORMAT); anno) {
+			if (auto fnd = formats.find(anno.get_default_string()); fnd != formats.end()) {
+				buf.format = fnd->second;
 			}
 		}
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_PERSISTENT); anno) {
+			buf.persistent = anno.get_default_bool();
+		}
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_STATIC); anno) {
+			// A buffer that never changes has no previous content worth looking at.
+			buf.is_static  = anno.get_default_bool();
+			buf.persistent = buf.persistent && !buf.is_static;
+		}
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_ORDER); anno) {
+			buf.order = anno.get_default_int();
+		}
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_ITERATIONS); anno) {
+			buf.iterations = std::clamp(anno.get_default_int(), 1, 64);
+		}
+		if (auto anno = el.get_annotation(ST_ANNO_BUFFER_ITERATION_SCALE); anno) {
+			buf.iteration_scale = std::clamp(anno.get_default_float(), 1.f / 16.f, 1.f);
+		}
 
-		return true;
-	} catch (const std::exception& ex) {
-		DLOG_ERROR("Loading shader '%s' failed with error: %s", file.c_str(), ex.what());
-		return false;
-	} catch (...) {
-		return false;
+		if (buf.technique.empty() || !_shader.has_technique(buf.technique)) {
+			DLOG_ERROR("Buffer '%s' of shader '%s' does not name a valid technique.", el.get_name().data(), _shader_file.u8string().c_str());
+			continue;
+		}
+		_buffers.push_back(std::move(buf));
 	}
+
+	// Buffers with the same order are rendered in the order they were declared in.
+	std::stable_sort(_buffers.begin(), _buffers.end(), [](const buffer& a, const buffer& b) { return a.order < b.order; });
 }
 
 void streamfx::gfx::shader::shader::defaults(obs_data_t* data)
@@ -177,6 +380,8 @@ void streamfx::gfx::shader::shader::defaults(obs_data_t* data)
 	obs_data_set_default_string(data, ST_KEY_SHADER_SIZE_WIDTH, "100.0 %");
 	obs_data_set_default_string(data, ST_KEY_SHADER_SIZE_HEIGHT, "100.0 %");
 	obs_data_set_default_int(data, ST_KEY_SHADER_SEED, static_cast<long long>(time(NULL)));
+	obs_data_set_default_int(data, ST_KEY_SHADER_RENDERSCALE, 100);
+	obs_data_set_default_int(data, ST_KEY_SHADER_RENDERINTERVAL, 1);
 }
 
 void streamfx::gfx::shader::shader::properties(obs_properties_t* pr)
@@ -220,6 +425,18 @@ void streamfx::gfx::shader::shader::properties(obs_properties_t* pr)
 		{
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_SHADER_SEED, D_TRANSLATE(ST_I18N_SHADER_SEED), std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 1);
 		}
+
+		if (_mode == shader_mode::Source) {
+			{
+				auto p = obs_properties_add_list(grp, ST_KEY_SHADER_RENDERSCALE, D_TRANSLATE(ST_I18N_SHADER_RENDERSCALE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+				obs_property_list_add_int(p, "100%", 100);
+				obs_property_list_add_int(p, "50%", 50);
+				obs_property_list_add_int(p, "25%", 25);
+			}
+			{
+				auto p = obs_properties_add_int_slider(grp, ST_KEY_SHADER_RENDERINTERVAL, D_TRANSLATE(ST_I18N_SHADER_RENDERINTERVAL), 1, 10, 1);
+			}
+		}
 	}
 	{
 		auto grp = obs_properties_create();
@@ -249,11 +466,11 @@ bool streamfx::gfx::shader::shader::on_refresh_properties(obs_properties_t* prop
 
 		// Rebuild new parameters.
 		obs_data_t* data = obs_source_get_settings(_self);
-		for (auto kv : _shader_params) {
+		for (auto& param : _shader_params) {
 			try {
-				kv.second->defaults(data);
-				kv.second->update(data);
-				kv.second->properties(grp, data);
+				param->defaults(data);
+				param->update(data);
+				param->properties(grp, data);
 			} catch (...) {
 				// ToDo: Do something with these?
 			}
@@ -272,7 +489,7 @@ bool streamfx::gfx::shader::shader::on_shader_or_technique_modified(obs_properti
 	if (!update_shader(data, shader_dirty, param_dirty))
 		return false;
 
-	{ // Clear list of techniques and rebuild it.
+	if (_shader) { // Clear list of techniques and rebuild it.
 		obs_property_t* p_tech_list = obs_properties_get(props, ST_KEY_SHADER_TECHNIQUE);
 		obs_property_list_clear(p_tech_list);
 		for (std::size_t idx = 0; idx < _shader.count_techniques(); idx++) {
@@ -288,10 +505,10 @@ bool streamfx::gfx::shader::shader::on_shader_or_technique_modified(obs_properti
 		}
 
 		// Rebuild new parameters.
-		for (auto kv : _shader_params) {
-			kv.second->properties(grp, data);
-			kv.second->defaults(data);
-			kv.second->update(data);
+		for (auto& param : _shader_params) {
+			param->properties(grp, data);
+			param->defaults(data);
+			param->update(data);
 		}
 	}
 
@@ -339,6 +556,13 @@ void streamfx::gfx::shader::shader::update(obs_data_t* data)
 		_height_value = std::clamp(sz_y.second, 0.01, 8192.0);
 	}
 
+	// Only sources can be rendered at a lower resolution or rate, as filters and transitions are expected to follow
+	// their inputs exactly.
+	if (_mode == shader_mode::Source) {
+		_render_scale    = std::clamp(static_cast<double_t>(obs_data_get_int(data, ST_KEY_SHADER_RENDERSCALE)) / 100.0, 0.01, 1.0);
+		_render_interval = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(data, ST_KEY_SHADER_RENDERINTERVAL), 1, 10));
+	}
+
 	if (int32_t seed = static_cast<int32_t>(obs_data_get_int(data, ST_KEY_SHADER_SEED)); _random_seed != seed) {
 		_random_seed = seed;
 		_random.seed(static_cast<unsigned long long>(_random_seed));
@@ -347,10 +571,17 @@ void streamfx::gfx::shader::shader::update(obs_data_t* data)
 		}
 	}
 
-	for (auto kv : _shader_params) {
-		kv.second->defaults(data);
-		kv.second->update(data);
+	for (auto& param : _shader_params) {
+		param->defaults(data);
+		param->update(data);
+	}
+
+	// Static buffers only depend on the parameters, so this is the only place they can become outdated.
+	for (auto& buf : _buffers) {
+		buf.valid = false;
 	}
+
+	_rt_up_to_date = false;
 }
 
 uint32_t streamfx::gfx::shader::shader::width()
@@ -389,6 +620,16 @@ uint32_t streamfx::gfx::shader::shader::height()
 	}
 }
 
+uint32_t streamfx::gfx::shader::shader::render_width()
+{
+	return std::max<uint32_t>(static_cast<uint32_t>(std::lround(static_cast<double_t>(width()) * _render_scale)), 1u);
+}
+
+uint32_t streamfx::gfx::shader::shader::render_height()
+{
+	return std::max<uint32_t>(static_cast<uint32_t>(std::lround(static_cast<double_t>(height()) * _render_scale)), 1u);
+}
+
 uint32_t streamfx::gfx::shader::shader::base_width()
 {
 	return _base_width;
@@ -401,11 +642,13 @@ uint32_t streamfx::gfx::shader::shader::base_height()
 
 bool streamfx::gfx::shader::shader::tick(float_t time)
 {
-	_shader_file_tick = static_cast<float_t>(static_cast<double_t>(_shader_file_tick) + static_cast<double_t>(time));
-	if (_shader_file_tick >= 1.0f / 3.0f) {
-		_shader_file_tick -= 1.0f / 3.0f;
-		bool v1, v2;
-		load_shader(_shader_file, _shader_tech, v1, v2);
+	if (_shader_task) {
+		if (_shader_task->is_completed()) {
+			apply_shader();
+		}
+	} else if (_shader_file_changed.exchange(false) && !_shader_file.empty()) {
+		// The watcher may report changes that do not matter, so the background load checks again before reading.
+		queue_shader(_shader_file, _shader_tech, false);
 	}
 
 	// Update State
@@ -425,8 +668,20 @@ bool streamfx::gfx::shader::shader::tick(float_t time)
 		_random_values[8 + idx] = static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
 	}
 
-	// Flag Render Target as outdated.
-	_rt_up_to_date = false;
+	// Flag Render Target as outdated, unless nothing it depends on could have changed, or it is not due yet.
+	if (++_rt_skipped >= _render_interval) {
+		_rt_skipped = 0;
+		if (!_pure) {
+			_rt_up_to_date = false;
+		} else {
+			for (auto& param : _shader_params) {
+				if (param->is_dynamic()) {
+					_rt_up_to_date = false;
+					break;
+				}
+			}
+		}
+	}
 
 	return false;
 }
@@ -437,8 +692,8 @@ void streamfx::gfx::shader::shader::prepare_render()
 		return;
 
 	// Assign user parameters
-	for (auto kv : _shader_params) {
-		kv.second->assign();
+	for (auto& param : _shader_params) {
+		param->assign();
 	}
 
 	// float4 Time: (Time in Seconds), (Time in Current Second), (Time in Seconds only), (Random Value)
@@ -451,7 +706,7 @@ void streamfx::gfx::shader::shader::prepare_render()
 	// float4 ViewSize: (Width), (Height), (1.0 / Width), (1.0 / Height)
 	if (auto el = _shader.get_parameter("ViewSize"); el != nullptr) {
 		if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Float4) {
-			el.set_float4(static_cast<float_t>(width()), static_cast<float_t>(height()), 1.0f / static_cast<float_t>(width()), 1.0f / static_cast<float_t>(height()));
+			el.set_float4(static_cast<float_t>(render_width()), static_cast<float_t>(render_height()), 1.0f / static_cast<float_t>(render_width()), 1.0f / static_cast<float_t>(render_height()));
 		}
 	}
 
@@ -480,52 +735,194 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 	if (!effect)
 		effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
 
+	// Changes in size do not go through update(), so the cached output has to be checked against them.
+	if (auto tex = _rt->get_texture(); !tex || (tex->get_width() != render_width()) || (tex->get_height() != render_height())) {
+		_rt_up_to_date = false;
+	}
+
 	if (!_rt_up_to_date) {
+		render_cache();
+	}
+
+	if (auto tex = _rt->get_texture(); tex) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Render Cache"};
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Draw Cache"};
 #endif
 
-		auto op = _rt->render(width(), height());
+		// A lower render scale is stretched back to the full size by the bilinear sampler of the effect.
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex->get_object());
+		while (gs_effect_loop(effect, "Draw")) {
+			gs_draw_sprite(nullptr, 0, width(), height());
+		}
+	}
+}
 
-		vec4 zero = {0, 0, 0, 0};
-		gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
-		gs_ortho(0, 1, 0, 1, 0, 1);
+void streamfx::gfx::shader::shader::render_cache()
+{
+	// Pooled buffers have to stay around until the technique itself was drawn.
+	std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> pooled;
+	pooled.reserve(_buffers.size());
+	for (auto& buf : _buffers) {
+		if (!buf.persistent && !buf.is_static) {
+			// Whatever the pool handed out last frame may already belong to someone else.
+			buf.param.set_texture(static_cast<gs_texture_t*>(nullptr));
+		}
+	}
+	for (auto& buf : _buffers) {
+		render_buffer(buf, pooled);
+	}
 
-		// Update Blend State
-		gs_blend_state_push();
-		gs_reset_blend_state();
-		gs_enable_blending(false);
-		gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_ZERO);
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Render Cache"};
+#endif
 
-		gs_enable_color(true, true, true, true);
+	auto op = _rt->render(render_width(), render_height());
 
-		// Fix sRGB Status
-		bool old_srgb = gs_framebuffer_srgb_enabled();
-		gs_enable_framebuffer_srgb(false);
+	vec4 zero = {0, 0, 0, 0};
+	gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
+	gs_ortho(0, 1, 0, 1, 0, 1);
 
-		while (gs_effect_loop(_shader.get_object(), _shader_tech.c_str())) {
-			_gfx_util->draw_fullscreen_triangle();
-		}
+	// Update Blend State
+	gs_blend_state_push();
+	gs_reset_blend_state();
+	gs_enable_blending(false);
+	gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_ZERO);
 
-		// Restore sRGB Status
-		gs_enable_framebuffer_srgb(old_srgb);
+	gs_enable_color(true, true, true, true);
 
-		// Restore Blend State
-		gs_blend_state_pop();
+	// Fix sRGB Status
+	bool old_srgb = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(false);
 
-		_rt_up_to_date = true;
+	while (gs_effect_loop(_shader.get_object(), _shader_tech.c_str())) {
+		_gfx_util->draw_fullscreen_triangle();
 	}
 
-	if (auto tex = _rt->get_texture(); tex) {
+	// Restore sRGB Status
+	gs_enable_framebuffer_srgb(old_srgb);
+
+	// Restore Blend State
+	gs_blend_state_pop();
+
+	_rt_up_to_date = true;
+}
+
+void streamfx::gfx::shader::shader::prewarm()
+{
+	if (_warm || !_shader)
+		return;
+	_warm = true;
+
+	auto gctx = streamfx::obs::gs::context();
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Draw Cache"};
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Prewarm"};
 #endif
 
-		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex->get_object());
-		while (gs_effect_loop(effect, "Draw")) {
-			gs_draw_sprite(nullptr, 0, width(), height());
+	// Empty inputs are enough to allocate every target at its final size, and to get the driver to finish preparing
+	// the shaders, which some of them only do on first use.
+	uint8_t        pixel[4] = {0, 0, 0, 0};
+	const uint8_t* data[]   = {pixel};
+	auto           input    = std::make_shared<streamfx::obs::gs::texture>(1, 1, GS_RGBA, 1, data, streamfx::obs::gs::texture::flags::None);
+	set_input_a(input);
+	set_input_b(input);
+	prepare_render();
+	render_cache();
+	set_input_a(nullptr);
+	set_input_b(nullptr);
+
+	// The real inputs still have to be rendered.
+	_rt_up_to_date = false;
+}
+
+void streamfx::gfx::shader::shader::render_buffer(buffer& buf, std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>>& pooled)
+{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Buffer '%s'", buf.param.get_name().data()};
+#endif
+
+	// Static buffers are kept until the parameters or the size change.
+	if (buf.is_static) {
+		std::pair<uint32_t, uint32_t> size{render_width(), render_height()};
+		if (buf.valid && (buf.valid_size == size)) {
+			buf.param.set_texture(buf.history[0]->get_object());
+			return;
+		}
+		buf.valid_size = size;
+		if (!buf.history[0]) {
+			buf.history[0] = std::make_shared<streamfx::obs::gs::rendertarget>(buf.format, GS_ZS_NONE);
+		}
+	}
+
+	// Persistent buffers see their own content from the previous frame.
+	if (buf.persistent) {
+		std::swap(buf.history[0], buf.history[1]);
+		if (!buf.history[0]) {
+			buf.history[0] = std::make_shared<streamfx::obs::gs::rendertarget>(buf.format, GS_ZS_NONE);
+		}
+		buf.param.set_texture(buf.history[1] ? buf.history[1]->get_object() : nullptr);
+	}
+
+	// Every iteration after the first sees the result of the one before it, which allows reductions and similar.
+	float_t                                          scale = buf.scale;
+	std::shared_ptr<streamfx::obs::gs::rendertarget> target;
+	for (int32_t iteration = 0; iteration < buf.iterations; iteration++) {
+		uint32_t buf_width  = std::max<uint32_t>(static_cast<uint32_t>(static_cast<float_t>(render_width()) * scale), 1u);
+		uint32_t buf_height = std::max<uint32_t>(static_cast<uint32_t>(static_cast<float_t>(render_height()) * scale), 1u);
+
+		if (iteration > 0) {
+			buf.param.set_texture(target->get_object());
+		}
+		if ((buf.persistent || buf.is_static) && ((iteration + 1) == buf.iterations)) {
+			target = buf.history[0];
+		} else {
+			target = _rt_pool->acquire(buf.format, buf_width, buf_height);
+			pooled.push_back(target);
+		}
+
+		// int Iteration: Current iteration of the buffer being rendered.
+		if (auto el = _shader.get_parameter("Iteration"); el != nullptr) {
+			if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Integer) {
+				el.set_int(iteration);
+			}
+		}
+
+		// float4 BufferSize: (Width), (Height), (1.0 / Width), (1.0 / Height) of the buffer being rendered.
+		if (auto el = _shader.get_parameter("BufferSize"); el != nullptr) {
+			if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Float4) {
+				el.set_float4(static_cast<float_t>(buf_width), static_cast<float_t>(buf_height), 1.0f / static_cast<float_t>(buf_width), 1.0f / static_cast<float_t>(buf_height));
+			}
+		}
+
+		{
+			auto op = target->render(buf_width, buf_height);
+
+			vec4 zero = {0, 0, 0, 0};
+			gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+
+			gs_blend_state_push();
+			gs_reset_blend_state();
+			gs_enable_blending(false);
+			gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_ZERO);
+			gs_enable_color(true, true, true, true);
+
+			bool old_srgb = gs_framebuffer_srgb_enabled();
+			gs_enable_framebuffer_srgb(false);
+
+			while (gs_effect_loop(_shader.get_object(), buf.technique.c_str())) {
+				_gfx_util->draw_fullscreen_triangle();
+			}
+
+			gs_enable_framebuffer_srgb(old_srgb);
+			gs_blend_state_pop();
 		}
+
+		scale *= buf.iteration_scale;
 	}
+
+	// Everything rendered after this, including later buffers, sees the new content.
+	buf.param.set_texture(target->get_object());
+	buf.valid = true;
 }
 
 void streamfx::gfx::shader::shader::set_size(uint32_t w, uint32_t h)
@@ -547,7 +944,7 @@ void streamfx::gfx::shader::shader::set_input_a(std::shared_ptr<streamfx::obs::g
 	for (auto& name : params) {
 		if (streamfx::obs::gs::effect_parameter el = _shader.get_parameter(name.data()); el != nullptr) {
 			if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Texture) {
-				el.set_texture(tex, srgb);
+				el.set_texture(tex ? tex->get_object() : nullptr, srgb);
 				break;
 			}
 		}
@@ -567,7 +964,7 @@ void streamfx::gfx::shader::shader::set_input_b(std::shared_ptr<streamfx::obs::g
 	for (auto& name : params) {
 		if (streamfx::obs::gs::effect_parameter el = _shader.get_parameter(name.data()); el != nullptr) {
 			if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Texture) {
-				el.set_texture(tex, srgb);
+				el.set_texture(tex ? tex->get_object() : nullptr, srgb);
 				break;
 			}
 		}
@@ -601,8 +998,8 @@ void streamfx::gfx::shader::shader::set_visible(bool visible)
 {
 	_visible = visible;
 
-	for (auto kv : _shader_params) {
-		kv.second->visible(visible);
+	for (auto& param : _shader_params) {
+		param->visible(visible);
 	}
 }
 
@@ -610,14 +1007,15 @@ void streamfx::gfx::shader::shader::set_active(bool active)
 {
 	_active = active;
 
-	for (auto kv : _shader_params) {
-		kv.second->active(active);
+	for (auto& param : _shader_params) {
+		param->active(active);
 	}
 
 	// Recreate Per-Activation-Random values.
 	for (size_t idx = 0; idx < 4; idx++) {
 		_random_values[4 + idx] = static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
 	}
+	_rt_up_to_date = false;
 }
 
 obs_source_t* streamfx::gfx::shader::shader::get()
@@ -6,16 +6,22 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
 #include "gfx/gfx-util.hpp"
 #include "gfx/shader/gfx-shader-param.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
+#include "util/util-file-watcher.hpp"
+#include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
 #include <filesystem>
 #include <list>
 #include <map>
 #include <random>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx {
@@ -31,7 +37,7 @@ namespace streamfx::gfx {
 			Transition,
 		};
 
-		typedef std::map<std::string_view, std::shared_ptr<parameter>> shader_param_map_t;
+		typedef std::vector<std::shared_ptr<parameter>> shader_param_list_t;
 
 		class shader {
 			obs_source_t* _self;
@@ -51,14 +57,34 @@ namespace streamfx::gfx {
 			std::string                     _shader_tech;
 			std::filesystem::file_time_type _shader_file_mt;
 			uintmax_t                       _shader_file_sz;
-			float_t                         _shader_file_tick;
-			shader_param_map_t              _shader_params;
+			uint64_t                        _shader_hash; // Of the code _shader was compiled from.
+			shader_param_list_t             _shader_params;
+			std::atomic<bool>               _shader_file_changed;
+
+			std::shared_ptr<streamfx::util::file_watcher::watch> _shader_watch;
+
+			// Background Loading
+			struct load_request {
+				std::filesystem::path           file;
+				std::string                     tech;
+				bool                            force;
+				std::filesystem::file_time_type file_mt;
+				uintmax_t                       file_sz;
+				bool                            changed;
+				std::string                     code;
+				uint64_t                        hash;
+				std::string                     error;
+			};
+			std::shared_ptr<load_request>                     _shader_request;
+			std::shared_ptr<streamfx::util::threadpool::task> _shader_task;
 
 			// Options
 			size_type _width_type;
 			double_t  _width_value;
 			size_type _height_type;
 			double_t  _height_value;
+			double_t  _render_scale;    // Fraction of the size that is actually rendered.
+			uint32_t  _render_interval; // Number of ticks between renders.
 
 			// Cache
 			bool            _have_current_params;
@@ -70,9 +96,32 @@ namespace streamfx::gfx {
 			float_t         _random_values[16]; // 0..4 Per-Instance-Random, 4..8 Per-Activation-Random 9..15 Per-Frame-Random
 
 			// Rendering
+			bool                                             _pure; // Output only depends on the parameters.
+			bool                                             _warm; // Everything has been rendered at least once.
 			bool                                             _rt_up_to_date;
+			uint32_t                                         _rt_skipped; // Ticks since the last time it was outdated.
 			std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
 
+			// Intermediate Buffers, rendered in order before the technique itself.
+			struct buffer {
+				streamfx::obs::gs::effect_parameter param;
+				std::string                         technique;
+				float_t                             scale;
+				gs_color_format                     format;
+				bool                                persistent;
+				bool                                is_static; // Only depends on the parameters, and is rendered once for each set.
+				bool                                valid;
+				std::pair<uint32_t, uint32_t>       valid_size; // Render size that the static content was rendered at.
+				int32_t                             order;
+				int32_t                             iterations;
+				float_t                             iteration_scale;
+
+				// Persistent buffers keep their own targets, the current frame first and the previous one second.
+				std::array<std::shared_ptr<streamfx::obs::gs::rendertarget>, 2> history;
+			};
+			std::vector<buffer>                               _buffers;
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> _rt_pool;
+
 			public:
 			shader(obs_source_t* self, shader_mode mode);
 			~shader();
@@ -83,6 +132,18 @@ namespace streamfx::gfx {
 
 			bool load_shader(const std::filesystem::path& file, std::string_view tech, bool& shader_dirty, bool& param_dirty);
 
+			/** Read and preprocess a shader file in the background. Unless forced, only reads it if it changed. */
+			void queue_shader(const std::filesystem::path& file, std::string_view tech, bool force);
+
+			/** Compile the result of a finished background load, which must happen on the graphics thread. */
+			void apply_shader();
+
+			/** Select a technique of the current shader and rebuild the parameters for it. */
+			void update_technique(std::string_view tech);
+
+			/** Find the intermediate buffers declared by the current shader. */
+			void update_buffers();
+
 			static void defaults(obs_data_t* data);
 
 			void properties(obs_properties_t* props);
@@ -99,6 +160,11 @@ namespace streamfx::gfx {
 
 			uint32_t height();
 
+			/** Size that is actually rendered, which may be lower than width() and height() to save time. */
+			uint32_t render_width();
+
+			uint32_t render_height();
+
 			uint32_t base_width();
 
 			uint32_t base_height();
@@ -109,6 +175,16 @@ namespace streamfx::gfx {
 
 			void render(gs_effect* effect);
 
+			/** Render once with empty inputs, so that the first real render does not have to allocate or prepare anything. */
+			void prewarm();
+
+			private:
+			void render_cache();
+
+			void render_buffer(buffer& buf, std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>>& pooled);
+
+			public:
+
 			obs_source_t* get();
 
 			std::filesystem::path get_shader_file();
@@ -0,0 +1,127 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-ar-bodypose.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::ar::bodypose> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+using namespace ::streamfx::nvidia;
+
+streamfx::nvidia::ar::bodypose::~bodypose()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+	detach();
+}
+
+streamfx::nvidia::ar::bodypose::bodypose(std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline)
+	: feature(FEATURE_BODY_POSE_ESTIMATION, pipeline), _keypoints(), _keypoints_3d(), _joint_angles(), _keypoints_confidence(), _rect(), _bboxes(), _dirty(true), _result_lock(), _result(), _result_rect()
+{
+	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
+
+	// A single body is followed over time, which also makes the key points a lot more stable.
+	if (auto err = set(P_NVAR_CONFIG "Temporal", true); err != cv::result::SUCCESS) {
+		throw cv::exception("Temporal", err);
+	}
+
+	_bboxes.rects   = &_rect;
+	_bboxes.maximum = 1;
+	_bboxes.current = 0;
+
+	// Attempt to load the feature.
+	load();
+
+	attach();
+}
+
+ar::rect_t ar::bodypose::keypoints(std::vector<std::pair<point_t, float>>& keypoints)
+{
+	std::unique_lock<std::mutex> ul(_result_lock);
+	keypoints = _result;
+	return _result_rect;
+}
+
+void ar::bodypose::process(std::shared_ptr<::streamfx::nvidia::cv::image> const& source, bool resized)
+{
+	if (resized) {
+		if (auto err = set(P_NVAR_INPUT "Image", source); err != cv::result::SUCCESS) {
+			throw cv::exception("Image", err);
+		}
+		_dirty = true;
+	}
+
+	// Reload effect if dirty.
+	if (_dirty) {
+		load();
+	}
+
+	if (auto err = run(); err != cv::result::SUCCESS) {
+		throw cv::exception("Run", err);
+	}
+
+	std::unique_lock<std::mutex> ul(_result_lock);
+	_result.clear();
+	_result_rect = {};
+	if (_bboxes.current > 0) {
+		for (size_t idx = 0; idx < _keypoints.size(); idx++) {
+			_result.emplace_back(_keypoints[idx], _keypoints_confidence[idx]);
+		}
+		_result_rect = _rect;
+	}
+}
+
+void streamfx::nvidia::ar::bodypose::load()
+{
+	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+
+	// Assign CUDA Stream object.
+	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _stream); err != cv::result::SUCCESS) {
+		throw cv::exception("CUDAStream", err);
+	}
+
+	// Attempt to load the feature.
+	if (auto err = feature::load(); err != cv::result::SUCCESS) {
+		throw cv::exception("Load", err);
+	}
+
+	// The number of key points depends on the model, and is only known once it is loaded.
+	uint32_t count = 0;
+	if (auto err = get(P_NVAR_CONFIG "NumKeyPoints", &count); err != cv::result::SUCCESS) {
+		throw cv::exception("NumKeyPoints", err);
+	}
+	_keypoints.resize(count);
+	_keypoints_3d.resize(count);
+	_joint_angles.resize(count);
+	_keypoints_confidence.resize(count);
+
+	if (auto err = set_object(P_NVAR_OUTPUT "KeyPoints", reinterpret_cast<void*>(_keypoints.data()), sizeof(point_t)); err != cv::result::SUCCESS) {
+		throw cv::exception("KeyPoints", err);
+	}
+	if (auto err = set_object(P_NVAR_OUTPUT "KeyPoints3D", reinterpret_cast<void*>(_keypoints_3d.data()), sizeof(vec3<float>)); err != cv::result::SUCCESS) {
+		throw cv::exception("KeyPoints3D", err);
+	}
+	if (auto err = set_object(P_NVAR_OUTPUT "JointAngles", reinterpret_cast<void*>(_joint_angles.data()), sizeof(quaternion_t)); err != cv::result::SUCCESS) {
+		throw cv::exception("JointAngles", err);
+	}
+	if (auto err = set(P_NVAR_OUTPUT "KeyPointsConfidence", _keypoints_confidence); err != cv::result::SUCCESS) {
+		throw cv::exception("KeyPointsConfidence", err);
+	}
+	if (auto err = set_object(P_NVAR_OUTPUT "BoundingBoxes", reinterpret_cast<void*>(&_bboxes), sizeof(bounds_t)); err != cv::result::SUCCESS) {
+		throw cv::exception("BoundingBoxes", err);
+	}
+
+	_dirty = false;
+}
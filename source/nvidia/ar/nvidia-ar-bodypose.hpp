@@ -0,0 +1,54 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "nvidia-ar-feature.hpp"
+#include "nvidia/cv/nvidia-cv-image.hpp"
+
+#include "warning-disable.hpp"
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia::ar {
+	/** Key points of the skeleton of the most prominent body, like the head, the shoulders and the hips. */
+	class bodypose : public feature {
+		std::vector<point_t>      _keypoints;
+		std::vector<vec3<float>>  _keypoints_3d;
+		std::vector<quaternion_t> _joint_angles;
+		std::vector<float>        _keypoints_confidence;
+		rect_t                    _rect;
+		bounds_t                  _bboxes;
+
+		bool _dirty;
+
+		std::mutex                             _result_lock;
+		std::vector<std::pair<point_t, float>> _result;
+		rect_t                                 _result_rect;
+
+		public:
+		~bodypose() override;
+
+		/** Create a new body pose estimation feature, optionally on a pipeline shared with other features.
+		 *
+		 * Must be in a graphics and CUDA context when calling.
+		 */
+		bodypose(std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline = nullptr);
+
+		/** Key points found in the last frame the pipeline ran on, in pixels and with their confidence.
+		 *
+		 * Empty if there was no body in the frame.
+		 *
+		 * @return The bounding box of the body.
+		 */
+		rect_t keypoints(std::vector<std::pair<point_t, float>>& keypoints);
+
+		protected:
+		void process(std::shared_ptr<::streamfx::nvidia::cv::image> const& source, bool resized) override;
+
+		private:
+		void load();
+	};
+} // namespace streamfx::nvidia::ar
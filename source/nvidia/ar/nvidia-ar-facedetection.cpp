@@ -4,12 +4,13 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "nvidia-ar-facedetection.hpp"
-#include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
-#include <stdexcept>
+#include <map>
+#include <mutex>
+#include <tuple>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -34,14 +35,15 @@ using namespace ::streamfx::nvidia;
 streamfx::nvidia::ar::facedetection::~facedetection()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+	detach();
 }
 
-streamfx::nvidia::ar::facedetection::facedetection() : feature(FEATURE_FACE_DETECTION), _input(), _source(), _tmp(), _rects(), _rects_confidence(), _bboxes(), _dirty(true)
+streamfx::nvidia::ar::facedetection::facedetection(std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline) : feature(FEATURE_FACE_DETECTION, pipeline), _rects(), _rects_confidence(), _bboxes(), _dirty(true), _faces_lock(), _faces()
 {
 	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
 
 	// Assign CUDA Stream object.
-	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _nvcuda->get_stream()); err != cv::result::SUCCESS) {
+	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _stream); err != cv::result::SUCCESS) {
 		throw cv::exception("CUDAStream", err);
 	}
 
@@ -56,6 +58,8 @@ streamfx::nvidia::ar::facedetection::facedetection() : feature(FEATURE_FACE_DETE
 	if (auto err = feature::load(); err != cv::result::SUCCESS) {
 		throw cv::exception("Load", err);
 	}
+
+	attach();
 }
 
 std::pair<size_t, size_t> ar::facedetection::tracking_limit_range()
@@ -97,113 +101,89 @@ void ar::facedetection::set_tracking_limit(size_t v)
 	_dirty = true;
 }
 
-void ar::facedetection::process(std::shared_ptr<::streamfx::obs::gs::texture> in)
+bool ar::facedetection::capture(std::shared_ptr<::streamfx::obs::gs::texture> in)
 {
-	// Enter Graphics and CUDA context.
-	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = _nvcuda->get_context()->enter();
+	return _pipeline->capture(in);
+}
 
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvAR Face Detection"};
-#endif
+void ar::facedetection::detect(std::vector<std::pair<rect_t, float>>& faces)
+{
+	_pipeline->run();
+	this->faces(faces);
+}
 
-	// Resize if the size or scale was changed.
-	resize(in->get_width(), in->get_height());
+void ar::facedetection::faces(std::vector<std::pair<rect_t, float>>& faces)
+{
+	std::unique_lock<std::mutex> ul(_faces_lock);
+	faces = _faces;
+}
+
+void ar::facedetection::process(std::shared_ptr<::streamfx::nvidia::cv::image> const& source, bool resized)
+{
+	if (resized) {
+		if (auto err = set(P_NVAR_INPUT "Image", source); err != cv::result::SUCCESS) {
+			throw cv::exception("Image", err);
+		}
+		_dirty = true;
+	}
 
 	// Reload effect if dirty.
 	if (_dirty) {
 		load();
 	}
 
-	{ // Copy parameter to input.
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy In -> Input"};
-#endif
-		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
-	}
-
-	{ // Convert Input to Source format
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Copy Input -> Source"};
-#endif
-		if (auto res = _nvcv->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcv->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
-		}
+	if (auto err = run(); err != cv::result::SUCCESS) {
+		throw cv::exception("Run", err);
 	}
 
-	{ // Run
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Run"};
-#endif
-		if (auto err = run(); err != cv::result::SUCCESS) {
-			throw cv::exception("Run", err);
-		}
+	std::unique_lock<std::mutex> ul(_faces_lock);
+	_faces.clear();
+	for (size_t idx = 0; idx < _bboxes.current; idx++) {
+		_faces.emplace_back(_rects[idx], _rects_confidence[idx]);
 	}
 }
 
-size_t streamfx::nvidia::ar::facedetection::count()
+std::shared_ptr<ar::facedetection> ar::facedetection::acquire(size_t tracking_limit, uint32_t width, uint32_t height)
 {
-	return _bboxes.current;
-}
-
-streamfx::nvidia::ar::rect_t const& streamfx::nvidia::ar::facedetection::at(size_t index)
-{
-	float v;
-	return at(index, v);
-}
-
-streamfx::nvidia::ar::rect_t const& streamfx::nvidia::ar::facedetection::at(size_t index, float& confidence)
-{
-	if (_bboxes.current == 0)
-		throw std::runtime_error("no tracked faces");
-	if (index > _bboxes.current)
-		throw std::out_of_range("index too large");
-	auto& ref  = _rects.at(index);
-	confidence = _rects_confidence.at(index);
-	return ref;
-}
-
-void ar::facedetection::resize(uint32_t width, uint32_t height)
-{
-	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-
-	if (!_tmp) {
-		_tmp = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+	static std::mutex                                                                     lock;
+	static std::map<std::tuple<size_t, uint32_t, uint32_t>, std::weak_ptr<facedetection>> instances;
+
+	tracking_limit = std::clamp<size_t>(tracking_limit, tracking_limit_range().first, tracking_limit_range().second);
+	if (tracking_limit == 1) {
+		auto fx = std::make_shared<facedetection>();
+		fx->set_tracking_limit(tracking_limit);
+		return fx;
 	}
 
-	if (!_input || (width != _input->get_texture()->get_width()) || (height != _input->get_texture()->get_height())) {
-		if (_input) {
-			_input->resize(width, height);
+	std::unique_lock<std::mutex> ul(lock);
+	for (auto itr = instances.begin(); itr != instances.end();) {
+		if (itr->second.expired()) {
+			itr = instances.erase(itr);
 		} else {
-			_input = std::make_shared<::streamfx::nvidia::cv::texture>(width, height, GS_RGBA_UNORM);
+			++itr;
 		}
-		_dirty = true;
 	}
 
-	if (!_source || (width != _source->get_image()->width) || (height != _source->get_image()->height)) {
-		if (_source) {
-			_source->resize(width, height);
-		} else {
-			_source = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::BGR, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::INTERLEAVED, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+	auto key = std::make_tuple(tracking_limit, width, height);
+	if (auto kv = instances.find(key); kv != instances.end()) {
+		if (auto fx = kv->second.lock(); fx) {
+			return fx;
 		}
-
-		if (auto err = set(P_NVAR_INPUT "Image", _source); err != cv::result::SUCCESS) {
-			throw cv::exception("Image", err);
-		}
-
-		_dirty = true;
 	}
+
+	auto fx = std::make_shared<facedetection>();
+	fx->set_tracking_limit(tracking_limit);
+	fx->_pipeline->resize(width, height);
+	instances[key] = fx;
+	return fx;
 }
 
 void streamfx::nvidia::ar::facedetection::load()
 {
-	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	// Assign CUDA Stream object.
-	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _nvcuda->get_stream()); err != cv::result::SUCCESS) {
+	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _stream); err != cv::result::SUCCESS) {
 		throw cv::exception("CUDAStream", err);
 	}
 
@@ -11,44 +11,71 @@
 #include "nvidia/cv/nvidia-cv-texture.hpp"
 #include "obs/gs/gs-texture.hpp"
 
+#include "warning-disable.hpp"
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
 namespace streamfx::nvidia::ar {
 	class facedetection : public feature {
-		std::shared_ptr<::streamfx::nvidia::cv::texture> _input;
-		std::shared_ptr<::streamfx::nvidia::cv::image>   _source;
-		std::shared_ptr<::streamfx::nvidia::cv::image>   _tmp;
-
 		std::vector<rect_t> _rects;
 		std::vector<float>  _rects_confidence;
 		bounds_t            _bboxes;
 
 		bool _dirty;
 
+		std::mutex                            _faces_lock;
+		std::vector<std::pair<rect_t, float>> _faces;
+
 		public:
-		~facedetection();
+		~facedetection() override;
 
-		/** Create a new face detection feature.
+		/** Create a new face detection feature, optionally on a pipeline shared with other features.
 		 *
 		 * Must be in a graphics and CUDA context when calling.
 		 */
-		facedetection();
+		facedetection(std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline = nullptr);
 
-		std::pair<size_t, size_t> tracking_limit_range();
+		static std::pair<size_t, size_t> tracking_limit_range();
 
 		size_t tracking_limit();
 
 		void set_tracking_limit(size_t v);
 
-		void process(std::shared_ptr<::streamfx::obs::gs::texture> in);
+		/** Copy a frame for detection, without waiting for anything.
+		 *
+		 * Must be in a graphics context when calling. Fails if the pipeline is still busy with a previous frame, which
+		 * may have come from anyone sharing this feature.
+		 *
+		 * @return true if 'detect' must be called next.
+		 */
+		bool capture(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
-		size_t count();
+		/** Run the pipeline on the captured frame, and retrieve the faces with their confidence.
+		 *
+		 * Blocks until the results are available, so this belongs on a worker thread.
+		 */
+		void detect(std::vector<std::pair<rect_t, float>>& faces);
 
-		rect_t const& at(size_t index);
+		/** Faces found in the last frame the pipeline ran on, with their confidence. */
+		void faces(std::vector<std::pair<rect_t, float>>& faces);
 
-		rect_t const& at(size_t index, float& confidence);
+		public:
+		/** Acquire a face detection feature for the given number of faces and input size.
+		 *
+		 * Tracking more than one face keeps no state between frames, so everyone asking for the same configuration
+		 * shares one feature, and with it one copy of the model. Tracking a single face filters results over time,
+		 * which must not mix different inputs, so that always creates a new feature.
+		 *
+		 * Must be in a graphics and CUDA context when calling.
+		 */
+		static std::shared_ptr<facedetection> acquire(size_t tracking_limit, uint32_t width, uint32_t height);
 
-		private:
-		void resize(uint32_t width, uint32_t height);
+		protected:
+		void process(std::shared_ptr<::streamfx::nvidia::cv::image> const& source, bool resized) override;
 
+		private:
 		void load();
 	};
 } // namespace streamfx::nvidia::ar
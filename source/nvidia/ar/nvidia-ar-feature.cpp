@@ -26,7 +26,8 @@ streamfx::nvidia::ar::feature::~feature()
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 }
 
-streamfx::nvidia::ar::feature::feature(feature_t feature) : _nvcuda(::streamfx::nvidia::cuda::obs::get()), _nvcv(::streamfx::nvidia::cv::cv::get()), _nvar(::streamfx::nvidia::ar::ar::get()), _fx()
+streamfx::nvidia::ar::feature::feature(feature_t feature, std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline)
+	: _nvcuda(::streamfx::nvidia::cuda::obs::get()), _pipeline(pipeline ? pipeline : std::make_shared<::streamfx::nvidia::ar::pipeline>()), _stream(_pipeline->get_stream()), _nvcv(::streamfx::nvidia::cv::cv::get()), _nvar(::streamfx::nvidia::ar::ar::get()), _fx()
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 	auto gctx = ::streamfx::obs::gs::context();
@@ -40,7 +41,7 @@ streamfx::nvidia::ar::feature::feature(feature_t feature) : _nvcuda(::streamfx::
 	_fx = std::shared_ptr<void>(handle, [this](::streamfx::nvidia::ar::handle_t handle) { _nvar->NvAR_Destroy(handle); });
 
 	// Set CUDA stream and model directory.
-	set(P_NVAR_CONFIG "CUDAStream", _nvcuda->get_stream());
+	set(P_NVAR_CONFIG "CUDAStream", _stream);
 	_model_path = _nvar->get_model_path().generic_u8string();
 	set(P_NVAR_CONFIG "ModelDir", _model_path);
 }
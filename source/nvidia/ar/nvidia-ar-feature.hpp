@@ -3,6 +3,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "nvidia/ar/nvidia-ar-pipeline.hpp"
 #include "nvidia/ar/nvidia-ar.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "nvidia/cv/nvidia-cv-image.hpp"
@@ -16,15 +17,27 @@
 namespace streamfx::nvidia::ar {
 	class feature {
 		protected:
-		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
-		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcv;
-		std::shared_ptr<::streamfx::nvidia::ar::ar>    _nvar;
-		std::shared_ptr<void>                          _fx;
-		std::string                                    _model_path;
+		std::shared_ptr<::streamfx::nvidia::cuda::obs>    _nvcuda;
+		std::shared_ptr<::streamfx::nvidia::ar::pipeline> _pipeline;
+		std::shared_ptr<::streamfx::nvidia::cuda::stream> _stream;
+		std::shared_ptr<::streamfx::nvidia::cv::cv>       _nvcv;
+		std::shared_ptr<::streamfx::nvidia::ar::ar>       _nvar;
+		std::shared_ptr<void>                             _fx;
+		std::string                                       _model_path;
 
 		public:
-		~feature();
-		feature(feature_t feature);
+		virtual ~feature();
+
+		/** Create a feature on the given pipeline, or on a new one if there is none.
+		 *
+		 * Features on the same pipeline share its CUDA stream and its input.
+		 */
+		feature(feature_t feature, std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline = nullptr);
+
+		std::shared_ptr<::streamfx::nvidia::ar::pipeline> get_pipeline()
+		{
+			return _pipeline;
+		}
 
 		::streamfx::nvidia::ar::handle_t get()
 		{
@@ -188,5 +201,26 @@ namespace streamfx::nvidia::ar {
 		{
 			return _nvar->NvAR_Run(_fx.get());
 		}
+
+		protected /* Pipeline */:
+		friend class pipeline;
+
+		/** Start receiving frames from the pipeline. Call once the derived feature is fully constructed. */
+		void attach()
+		{
+			_pipeline->attach(this);
+		}
+
+		/** Stop receiving frames from the pipeline. Call before the derived feature starts to be destroyed. */
+		void detach()
+		{
+			_pipeline->detach(this);
+		}
+
+		/** Process the frame the pipeline captured, on the pipeline's worker thread and in a CUDA context.
+		 *
+		 * @param resized true if 'source' was reallocated since the last call, and has to be bound again.
+		 */
+		virtual void process(std::shared_ptr<::streamfx::nvidia::cv::image> const& source, bool resized) = 0;
 	};
 } // namespace streamfx::nvidia::ar
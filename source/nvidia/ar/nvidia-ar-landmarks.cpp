@@ -0,0 +1,115 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-ar-landmarks.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::ar::landmarks> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+using namespace ::streamfx::nvidia;
+
+streamfx::nvidia::ar::landmarks::~landmarks()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+	detach();
+}
+
+streamfx::nvidia::ar::landmarks::landmarks(std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline) : feature(FEATURE_LANDMARK_DETECTION, pipeline), _points(), _points_confidence(), _rect(), _bboxes(), _dirty(true), _result_lock(), _result()
+{
+	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
+
+	// A single face is followed over time, which also makes the landmarks a lot more stable.
+	if (auto err = set(P_NVAR_CONFIG "Temporal", true); err != cv::result::SUCCESS) {
+		throw cv::exception("Temporal", err);
+	}
+
+	_bboxes.rects   = &_rect;
+	_bboxes.maximum = 1;
+	_bboxes.current = 0;
+
+	// Attempt to load the feature.
+	load();
+
+	attach();
+}
+
+void ar::landmarks::points(std::vector<std::pair<point_t, float>>& points)
+{
+	std::unique_lock<std::mutex> ul(_result_lock);
+	points = _result;
+}
+
+void ar::landmarks::process(std::shared_ptr<::streamfx::nvidia::cv::image> const& source, bool resized)
+{
+	if (resized) {
+		if (auto err = set(P_NVAR_INPUT "Image", source); err != cv::result::SUCCESS) {
+			throw cv::exception("Image", err);
+		}
+		_dirty = true;
+	}
+
+	// Reload effect if dirty.
+	if (_dirty) {
+		load();
+	}
+
+	if (auto err = run(); err != cv::result::SUCCESS) {
+		throw cv::exception("Run", err);
+	}
+
+	std::unique_lock<std::mutex> ul(_result_lock);
+	_result.clear();
+	if (_bboxes.current > 0) {
+		for (size_t idx = 0; idx < _points.size(); idx++) {
+			_result.emplace_back(_points[idx], _points_confidence[idx]);
+		}
+	}
+}
+
+void streamfx::nvidia::ar::landmarks::load()
+{
+	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+
+	// Assign CUDA Stream object.
+	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _stream); err != cv::result::SUCCESS) {
+		throw cv::exception("CUDAStream", err);
+	}
+
+	// Attempt to load the feature.
+	if (auto err = feature::load(); err != cv::result::SUCCESS) {
+		throw cv::exception("Load", err);
+	}
+
+	// The number of landmarks depends on the model, and is only known once it is loaded.
+	uint32_t count = 0;
+	if (auto err = get(P_NVAR_CONFIG "Landmarks_Size", &count); err != cv::result::SUCCESS) {
+		throw cv::exception("Landmarks_Size", err);
+	}
+	_points.resize(count);
+	_points_confidence.resize(count);
+
+	if (auto err = set_object(P_NVAR_OUTPUT "Landmarks", reinterpret_cast<void*>(_points.data()), sizeof(point_t)); err != cv::result::SUCCESS) {
+		throw cv::exception("Landmarks", err);
+	}
+	if (auto err = set(P_NVAR_OUTPUT "LandmarksConfidence", _points_confidence); err != cv::result::SUCCESS) {
+		throw cv::exception("LandmarksConfidence", err);
+	}
+	if (auto err = set_object(P_NVAR_OUTPUT "BoundingBoxes", reinterpret_cast<void*>(&_bboxes), sizeof(bounds_t)); err != cv::result::SUCCESS) {
+		throw cv::exception("BoundingBoxes", err);
+	}
+
+	_dirty = false;
+}
@@ -0,0 +1,49 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "nvidia-ar-feature.hpp"
+#include "nvidia/cv/nvidia-cv-image.hpp"
+
+#include "warning-disable.hpp"
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia::ar {
+	/** Facial landmarks of the most prominent face, like the eyes, the nose and the outline of the mouth. */
+	class landmarks : public feature {
+		std::vector<point_t> _points;
+		std::vector<float>   _points_confidence;
+		rect_t               _rect;
+		bounds_t             _bboxes;
+
+		bool _dirty;
+
+		std::mutex                             _result_lock;
+		std::vector<std::pair<point_t, float>> _result;
+
+		public:
+		~landmarks() override;
+
+		/** Create a new landmark detection feature, optionally on a pipeline shared with other features.
+		 *
+		 * Must be in a graphics and CUDA context when calling.
+		 */
+		landmarks(std::shared_ptr<::streamfx::nvidia::ar::pipeline> pipeline = nullptr);
+
+		/** Landmarks found in the last frame the pipeline ran on, in pixels and with their confidence.
+		 *
+		 * Empty if there was no face in the frame.
+		 */
+		void points(std::vector<std::pair<point_t, float>>& points);
+
+		protected:
+		void process(std::shared_ptr<::streamfx::nvidia::cv::image> const& source, bool resized) override;
+
+		private:
+		void load();
+	};
+} // namespace streamfx::nvidia::ar
@@ -0,0 +1,152 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-ar-pipeline.hpp"
+#include "nvidia-ar-feature.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::ar::pipeline> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+streamfx::nvidia::ar::pipeline::~pipeline()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	auto gctx = ::streamfx::obs::gs::context();
+	auto cctx = _nvcuda->get_context()->enter();
+	_input.reset();
+	_source.reset();
+	_tmp.reset();
+}
+
+streamfx::nvidia::ar::pipeline::pipeline() : _nvcuda(::streamfx::nvidia::cuda::obs::get()), _nvcv(::streamfx::nvidia::cv::cv::get()), _stream(_nvcuda->acquire_stream()), _input(), _source(), _tmp(), _generation(1), _lock(), _features(), _busy(false)
+{
+	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
+}
+
+std::shared_ptr<streamfx::nvidia::cuda::stream> streamfx::nvidia::ar::pipeline::get_stream()
+{
+	return _stream;
+}
+
+void streamfx::nvidia::ar::pipeline::resize(uint32_t width, uint32_t height)
+{
+	auto gctx = ::streamfx::obs::gs::context();
+	auto cctx = _nvcuda->get_context()->enter();
+
+	if (!_tmp) {
+		_tmp = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+	}
+
+	if (!_input || (width != _input->get_texture()->get_width()) || (height != _input->get_texture()->get_height())) {
+		if (_input) {
+			_input->resize(width, height);
+		} else {
+			_input = std::make_shared<::streamfx::nvidia::cv::texture>(width, height, GS_RGBA_UNORM);
+		}
+	}
+
+	if (!_source || (width != _source->get_image()->width) || (height != _source->get_image()->height)) {
+		if (_source) {
+			_source->resize(width, height);
+		} else {
+			_source = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::BGR, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::INTERLEAVED, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+		}
+
+		// Features have to bind the new source again before their next run.
+		_generation++;
+	}
+}
+
+bool streamfx::nvidia::ar::pipeline::capture(std::shared_ptr<::streamfx::obs::gs::texture> in)
+{
+	// The features may still be busy with the previous frame.
+	if (_busy.exchange(true)) {
+		return false;
+	}
+
+	// Enter Graphics and CUDA context.
+	auto gctx = ::streamfx::obs::gs::context();
+	auto cctx = _nvcuda->get_context()->enter();
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvAR Pipeline"};
+#endif
+
+	try {
+		// Resize if the size was changed.
+		resize(in->get_width(), in->get_height());
+
+		{ // Copy parameter to input.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy In -> Input"};
+#endif
+			gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
+		}
+
+		{ // Convert Input to Source format, which is then ordered before every run on the same stream.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Copy Input -> Source"};
+#endif
+			if (auto res = _nvcv->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcv->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
+		}
+	} catch (...) {
+		_busy = false;
+		throw;
+	}
+
+	return true;
+}
+
+void streamfx::nvidia::ar::pipeline::run()
+{
+	auto cctx = _nvcuda->get_context()->enter();
+
+	try {
+		std::unique_lock<std::mutex> ul(_lock);
+		for (auto& kv : _features) {
+			bool resized = (kv.second != _generation);
+			kv.second    = _generation;
+			kv.first->process(_source, resized);
+		}
+	} catch (...) {
+		_busy = false;
+		throw;
+	}
+
+	_busy = false;
+}
+
+void streamfx::nvidia::ar::pipeline::attach(feature* fx)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_features.emplace_back(fx, 0);
+}
+
+void streamfx::nvidia::ar::pipeline::detach(feature* fx)
+{
+	// Also waits for a run that is still using the feature.
+	std::unique_lock<std::mutex> ul(_lock);
+	_features.erase(std::remove_if(_features.begin(), _features.end(), [fx](auto const& kv) { return kv.first == fx; }), _features.end());
+}
@@ -0,0 +1,76 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "nvidia/cuda/nvidia-cuda-obs.hpp"
+#include "nvidia/cuda/nvidia-cuda-stream.hpp"
+#include "nvidia/cv/nvidia-cv-image.hpp"
+#include "nvidia/cv/nvidia-cv-texture.hpp"
+#include "nvidia/cv/nvidia-cv.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia::ar {
+	class feature;
+
+	/** A frame uploaded once, and shared by every feature that runs on it.
+	 *
+	 * Owns the CUDA stream, the input texture and the converted source image. Every feature created on the same pipeline
+	 * reads that source directly, so a frame is copied and converted once no matter how many features look at it.
+	 */
+	class pipeline {
+		std::shared_ptr<::streamfx::nvidia::cuda::obs>    _nvcuda;
+		std::shared_ptr<::streamfx::nvidia::cv::cv>       _nvcv;
+		std::shared_ptr<::streamfx::nvidia::cuda::stream> _stream;
+
+		std::shared_ptr<::streamfx::nvidia::cv::texture> _input;
+		std::shared_ptr<::streamfx::nvidia::cv::image>   _source;
+		std::shared_ptr<::streamfx::nvidia::cv::image>   _tmp;
+		uint64_t                                         _generation; // Incremented whenever '_source' changes size.
+
+		std::mutex                                  _lock;
+		std::vector<std::pair<feature*, uint64_t>> _features; // Feature and the generation it last saw.
+		std::atomic<bool>                           _busy;
+
+		public:
+		~pipeline();
+
+		/** Create a new, empty pipeline.
+		 *
+		 * Must be in a graphics and CUDA context when calling.
+		 */
+		pipeline();
+
+		std::shared_ptr<::streamfx::nvidia::cuda::stream> get_stream();
+
+		/** Allocate the buffers for a frame of the given size ahead of time. */
+		void resize(uint32_t width, uint32_t height);
+
+		/** Copy a frame for all features, without waiting for anything.
+		 *
+		 * Must be in a graphics context when calling. Fails if the features are still busy with the previous frame.
+		 *
+		 * @return true if 'run' must be called next.
+		 */
+		bool capture(std::shared_ptr<::streamfx::obs::gs::texture> in);
+
+		/** Run every feature on the captured frame, in the order they were created.
+		 *
+		 * Blocks until the results are available, so this belongs on a worker thread.
+		 */
+		void run();
+
+		private:
+		friend class feature;
+
+		void attach(feature* fx);
+		void detach(feature* fx);
+	};
+} // namespace streamfx::nvidia::ar
@@ -7,7 +7,10 @@
 
 #include "warning-disable.hpp"
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
+#include <string>
+#include <vector>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -32,10 +35,21 @@
 
 #define ENABLE_STACK_CHECKS
 
+namespace {
+	// Context bound to the calling thread by context::bind(), which stays current until it is destroyed.
+	thread_local ::streamfx::nvidia::cuda::context_t bound_context = nullptr;
+} // namespace
+
 streamfx::nvidia::cuda::context::~context()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
+	// Other threads keep the handle on their stack, which for primary contexts is the same handle on the next retain.
+	if (bound_context == _ctx) {
+		pop();
+		bound_context = nullptr;
+	}
+
 	if (_has_device) {
 		_cuda->cuDevicePrimaryCtxRelease(_device);
 	} else {
@@ -48,26 +62,10 @@ streamfx::nvidia::cuda::context::context() : _cuda(::streamfx::nvidia::cuda::cud
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 }
 
-#ifdef WIN32
-streamfx::nvidia::cuda::context::context(ID3D11Device* device) : context()
+void streamfx::nvidia::cuda::context::acquire_primary()
 {
 	using namespace streamfx::nvidia::cuda;
 
-	if (!device)
-		throw std::invalid_argument("device");
-	// Get DXGI Device
-	IDXGIDevice* dxgi_device; // Don't use ATL::CComPtr
-	device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgi_device);
-
-	// Get DXGI Adapter
-	ATL::CComPtr<IDXGIAdapter> dxgi_adapter;
-	dxgi_device->GetAdapter(&dxgi_adapter);
-
-	// Get Device Index
-	if (result res = _cuda->cuD3D11GetDevice(&_device, dxgi_adapter); res != result::SUCCESS) {
-		throw std::runtime_error("Failed to get device index for device.");
-	}
-
 	_cuda->cuDevicePrimaryCtxSetFlags(_device, context_flags::SCHEDULER_BLOCKING_SYNC);
 
 	// Acquire Context
@@ -77,9 +75,9 @@ streamfx::nvidia::cuda::context::context(ID3D11Device* device) : context()
 
 	// Log some information.
 	std::string device_name;
-	uuid_t      device_uuid;
-	luid_t      device_luid;
-	uint32_t    device_luid_mask;
+	uuid_t      device_uuid      = {};
+	luid_t      device_luid      = {};
+	uint32_t    device_luid_mask = 0;
 	{
 		// Device Name
 		std::vector<char> name(256, 0);
@@ -97,6 +95,35 @@ streamfx::nvidia::cuda::context::context(ID3D11Device* device) : context()
 
 	_has_device = true;
 }
+
+streamfx::nvidia::cuda::context::context(::streamfx::nvidia::cuda::device_t device) : context()
+{
+	_device = device;
+	acquire_primary();
+}
+
+#ifdef WIN32
+streamfx::nvidia::cuda::context::context(ID3D11Device* device) : context()
+{
+	using namespace streamfx::nvidia::cuda;
+
+	if (!device)
+		throw std::invalid_argument("device");
+	// Get DXGI Device
+	IDXGIDevice* dxgi_device; // Don't use ATL::CComPtr
+	device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgi_device);
+
+	// Get DXGI Adapter
+	ATL::CComPtr<IDXGIAdapter> dxgi_adapter;
+	dxgi_device->GetAdapter(&dxgi_adapter);
+
+	// Get Device Index
+	if (result res = _cuda->cuD3D11GetDevice(&_device, dxgi_adapter); res != result::SUCCESS) {
+		throw std::runtime_error("Failed to get device index for device.");
+	}
+
+	acquire_primary();
+}
 #endif
 
 ::streamfx::nvidia::cuda::context_t streamfx::nvidia::cuda::context::get()
@@ -104,8 +131,22 @@ streamfx::nvidia::cuda::context::context(ID3D11Device* device) : context()
 	return _ctx;
 }
 
+::streamfx::nvidia::cuda::device_t streamfx::nvidia::cuda::context::get_device()
+{
+	return _device;
+}
+
 std::shared_ptr<::streamfx::nvidia::cuda::context_stack> streamfx::nvidia::cuda::context::enter()
 {
+	// Bound contexts are already current, unless someone else pushed their own on top of it.
+	if (bound_context == _ctx) {
+		::streamfx::nvidia::cuda::context_t ctx = nullptr;
+		if ((_cuda->cuCtxGetCurrent(&ctx) == ::streamfx::nvidia::cuda::result::SUCCESS) && (ctx == _ctx)) {
+			static auto bound_stack = std::make_shared<::streamfx::nvidia::cuda::context_stack>(nullptr);
+			return bound_stack;
+		}
+	}
+
 	return std::make_shared<::streamfx::nvidia::cuda::context_stack>(shared_from_this());
 }
 
@@ -124,7 +165,20 @@ void streamfx::nvidia::cuda::context::pop()
 		assert(ctx == _ctx);
 #endif
 
-	assert(_cuda->cuCtxPopCurrent(&ctx) == ::streamfx::nvidia::cuda::result::SUCCESS);
+	::streamfx::nvidia::cuda::context_t popped;
+	[[maybe_unused]] auto               res = _cuda->cuCtxPopCurrent(&popped);
+	assert(res == ::streamfx::nvidia::cuda::result::SUCCESS);
+}
+
+void streamfx::nvidia::cuda::context::bind()
+{
+	if (bound_context == _ctx) {
+		return;
+	}
+
+	push();
+	bound_context = _ctx;
+	D_LOG_DEBUG("Bound to thread. (Addr: 0x%" PRIuPTR ")", this);
 }
 
 void streamfx::nvidia::cuda::context::synchronize()
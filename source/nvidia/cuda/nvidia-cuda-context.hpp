@@ -25,16 +25,28 @@ namespace streamfx::nvidia::cuda {
 		private:
 		context();
 
+		void acquire_primary();
+
 		public:
+		context(::streamfx::nvidia::cuda::device_t device);
 #ifdef WIN32
 		context(ID3D11Device* device);
 #endif
 
 		::streamfx::nvidia::cuda::context_t get();
 
+		::streamfx::nvidia::cuda::device_t get_device();
+
 		void push();
 		void pop();
 
+		/** Keep this context current on the calling thread, for as long as the context lives.
+		 *
+		 * Every later enter() on the same thread then skips pushing and popping the context, which the driver charges
+		 * for on every call. Meant for threads that use the context every frame, like the graphics thread.
+		 */
+		void bind();
+
 		void synchronize();
 
 		public:
@@ -47,11 +59,15 @@ namespace streamfx::nvidia::cuda {
 		public:
 		inline ~context_stack()
 		{
-			_ctx->pop();
+			if (_ctx) {
+				_ctx->pop();
+			}
 		}
 		inline context_stack(std::shared_ptr<::streamfx::nvidia::cuda::context> ctx) : _ctx(std::move(ctx))
 		{
-			_ctx->push();
+			if (_ctx) {
+				_ctx->push();
+			}
 		}
 	};
 } // namespace streamfx::nvidia::cuda
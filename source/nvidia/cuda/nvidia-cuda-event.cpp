@@ -0,0 +1,71 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-cuda-event.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::cuda::event> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+streamfx::nvidia::cuda::event::~event()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	_cuda->cuEventDestroy(_event);
+}
+
+streamfx::nvidia::cuda::event::event(::streamfx::nvidia::cuda::event_flags flags) : _cuda(::streamfx::nvidia::cuda::cuda::get())
+{
+	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
+
+	if (auto res = _cuda->cuEventCreate(&_event, flags); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw std::runtime_error("Failed to create CUevent object.");
+	}
+}
+
+::streamfx::nvidia::cuda::event_t streamfx::nvidia::cuda::event::get()
+{
+	return _event;
+}
+
+void streamfx::nvidia::cuda::event::record(std::shared_ptr<::streamfx::nvidia::cuda::stream> stream)
+{
+	if (auto res = _cuda->cuEventRecord(_event, stream->get()); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+}
+
+bool streamfx::nvidia::cuda::event::query()
+{
+	switch (auto res = _cuda->cuEventQuery(_event); res) {
+	case ::streamfx::nvidia::cuda::result::SUCCESS:
+		return true;
+	case ::streamfx::nvidia::cuda::result::NOT_READY:
+		return false;
+	default:
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+}
+
+void streamfx::nvidia::cuda::event::synchronize()
+{
+	if (auto res = _cuda->cuEventSynchronize(_event); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+}
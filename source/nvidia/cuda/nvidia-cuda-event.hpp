@@ -0,0 +1,32 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "nvidia-cuda-stream.hpp"
+#include "nvidia-cuda.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia::cuda {
+	class event {
+		std::shared_ptr<::streamfx::nvidia::cuda::cuda> _cuda;
+		::streamfx::nvidia::cuda::event_t               _event;
+
+		public:
+		~event();
+		event(::streamfx::nvidia::cuda::event_flags flags = ::streamfx::nvidia::cuda::event_flags::DISABLE_TIMING);
+
+		::streamfx::nvidia::cuda::event_t get();
+
+		/** Mark the point in the stream that completing this event waits for. */
+		void record(std::shared_ptr<::streamfx::nvidia::cuda::stream> stream);
+
+		/** Check if all work before the recorded point has completed, without waiting for it. */
+		bool query();
+
+		void synchronize();
+	};
+} // namespace streamfx::nvidia::cuda
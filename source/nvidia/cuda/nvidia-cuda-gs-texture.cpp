@@ -7,6 +7,10 @@
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -40,7 +44,35 @@ streamfx::nvidia::cuda::gstexture::gstexture(std::shared_ptr<streamfx::obs::gs::
 	int                        dev_type = gs_get_device_type();
 
 	if (dev_type == GS_DEVICE_OPENGL) {
-		// ToDo
+		if (!_cuda->cuGraphicsGLRegisterImage) {
+			throw std::runtime_error("nvidia::cuda::gstexture: OpenGL interoperability is not supported.");
+		}
+
+		// libOBS hands out a pointer to the GL texture name.
+		auto*    object = reinterpret_cast<uint32_t*>(gs_texture_get_obj(_texture->get_object()));
+		uint32_t target = 0;
+		switch (_texture->get_type()) {
+		case streamfx::obs::gs::texture::type::Normal:
+			target = 0x0DE1; // GL_TEXTURE_2D
+			break;
+		case streamfx::obs::gs::texture::type::Volume:
+			target = 0x806F; // GL_TEXTURE_3D
+			break;
+		case streamfx::obs::gs::texture::type::Cube:
+			target = 0x8513; // GL_TEXTURE_CUBE_MAP
+			break;
+		}
+
+		if (!object || !target) {
+			throw std::runtime_error("nvidia::cuda::gstexture: Failed to get resource from gs::texture.");
+		}
+
+		switch (_cuda->cuGraphicsGLRegisterImage(&_resource, *object, target, ::streamfx::nvidia::cuda::graphics_register_flags::READ_ONLY)) {
+		case streamfx::nvidia::cuda::result::SUCCESS:
+			break;
+		default:
+			throw std::runtime_error("nvidia::cuda::gstexture: Failed to register resource.");
+		}
 	}
 #ifdef WIN32
 	if (dev_type == GS_DEVICE_DIRECT3D_11) {
@@ -64,6 +96,11 @@ streamfx::nvidia::cuda::gstexture::gstexture(std::shared_ptr<streamfx::obs::gs::
 		default:
 			throw std::runtime_error("nvidia::cuda::gstexture: Failed to register resource.");
 		}
+
+		// CUDA only ever reads from it, so nothing has to be synchronized back to Direct3D when unmapping.
+		if (_cuda->cuGraphicsResourceSetMapFlags) {
+			_cuda->cuGraphicsResourceSetMapFlags(_resource, ::streamfx::nvidia::cuda::graphics_map_flags::READ_ONLY);
+		}
 	}
 #endif
 }
@@ -114,6 +151,74 @@ void streamfx::nvidia::cuda::gstexture::unmap()
 	_stream.reset();
 }
 
+void streamfx::nvidia::cuda::gstexture::map_all(std::vector<std::shared_ptr<gstexture>> const& textures, std::shared_ptr<streamfx::nvidia::cuda::stream> stream)
+{
+	std::vector<graphics_resource_t> resources;
+	resources.reserve(textures.size());
+	for (auto& texture : textures) {
+		if (!texture->_is_mapped) {
+			resources.push_back(texture->_resource);
+		}
+	}
+	if (resources.empty()) {
+		return;
+	}
+
+	auto cuda = textures.front()->_cuda;
+	switch (cuda->cuGraphicsMapResources(static_cast<uint32_t>(resources.size()), resources.data(), stream->get())) {
+	case streamfx::nvidia::cuda::result::SUCCESS:
+		break;
+	default:
+		throw std::runtime_error("nvidia::cuda::gstexture: Mapping failed.");
+	}
+
+	for (auto& texture : textures) {
+		if (texture->_is_mapped) {
+			continue;
+		}
+
+		texture->_stream    = stream;
+		texture->_is_mapped = true;
+
+		switch (cuda->cuGraphicsSubResourceGetMappedArray(&texture->_pointer, texture->_resource, 0, 0)) {
+		case streamfx::nvidia::cuda::result::SUCCESS:
+			break;
+		default:
+			unmap_all(textures);
+			throw std::runtime_error("nvidia::cuda::gstexture: Mapping pointer failed.");
+		}
+	}
+}
+
+void streamfx::nvidia::cuda::gstexture::unmap_all(std::vector<std::shared_ptr<gstexture>> const& textures)
+{
+	std::vector<graphics_resource_t>                resources;
+	std::shared_ptr<streamfx::nvidia::cuda::stream> stream;
+	resources.reserve(textures.size());
+	for (auto& texture : textures) {
+		if (texture->_is_mapped) {
+			resources.push_back(texture->_resource);
+			stream = texture->_stream;
+		}
+	}
+	if (resources.empty()) {
+		return;
+	}
+
+	switch (textures.front()->_cuda->cuGraphicsUnmapResources(static_cast<uint32_t>(resources.size()), resources.data(), stream->get())) {
+	case streamfx::nvidia::cuda::result::SUCCESS:
+		break;
+	default:
+		throw std::runtime_error("nvidia::cuda::gstexture: Unmapping failed.");
+	}
+
+	for (auto& texture : textures) {
+		texture->_is_mapped = false;
+		texture->_pointer   = nullptr;
+		texture->_stream.reset();
+	}
+}
+
 std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::cuda::gstexture::get_texture()
 {
 	return _texture;
@@ -10,6 +10,7 @@
 #include "warning-disable.hpp"
 #include <cstddef>
 #include <memory>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cuda {
@@ -29,6 +30,14 @@ namespace streamfx::nvidia::cuda {
 		array_t map(std::shared_ptr<streamfx::nvidia::cuda::stream> stream);
 		void    unmap();
 
+		/** Map or unmap several textures at once.
+		 *
+		 * Every call synchronizes with the graphics API, so doing it once for all planes of a frame is much cheaper
+		 * than once per plane. 'map' then just returns the cached array of each texture until it is unmapped.
+		 */
+		static void map_all(std::vector<std::shared_ptr<gstexture>> const& textures, std::shared_ptr<streamfx::nvidia::cuda::stream> stream);
+		static void unmap_all(std::vector<std::shared_ptr<gstexture>> const& textures);
+
 		std::shared_ptr<streamfx::obs::gs::texture>   get_texture();
 		::streamfx::nvidia::cuda::graphics_resource_t get();
 	};
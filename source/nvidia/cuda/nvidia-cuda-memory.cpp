@@ -6,9 +6,18 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
+#include <utility>
 #include "warning-enable.hpp"
 
+// Idle memory beyond this is freed, largest buffers first.
+#define ST_IDLE_LIMIT (256ull * 1024ull * 1024ull)
+
+// Size classes never get finer than this.
+#define ST_GRANULARITY (64ull * 1024ull)
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -30,7 +39,7 @@ streamfx::nvidia::cuda::memory::~memory()
 	_cuda->cuMemFree(_pointer);
 }
 
-streamfx::nvidia::cuda::memory::memory(size_t size) : _cuda(::streamfx::nvidia::cuda::cuda::get()), _pointer(), _size(size)
+streamfx::nvidia::cuda::memory::memory(size_t size) : _cuda(::streamfx::nvidia::cuda::cuda::get()), _pointer(), _size(size), _memory()
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -41,6 +50,7 @@ streamfx::nvidia::cuda::memory::memory(size_t size) : _cuda(::streamfx::nvidia::
 	default:
 		throw std::runtime_error("nvidia::cuda::memory: cuMemAlloc failed.");
 	}
+	_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::CUDA, _size);
 }
 
 streamfx::nvidia::cuda::device_ptr_t streamfx::nvidia::cuda::memory::get()
@@ -52,3 +62,86 @@ std::size_t streamfx::nvidia::cuda::memory::size()
 {
 	return _size;
 }
+
+streamfx::nvidia::cuda::memory_pool::~memory_pool()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	trim();
+}
+
+streamfx::nvidia::cuda::memory_pool::memory_pool() : _cuda(::streamfx::nvidia::cuda::cuda::get()), _lock(), _idle(), _idle_size(0)
+{
+	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
+}
+
+std::shared_ptr<streamfx::nvidia::cuda::memory> streamfx::nvidia::cuda::memory_pool::acquire(size_t size)
+{
+	size_t                  cls = size_class(size);
+	std::unique_ptr<memory> buffer;
+
+	{
+		std::unique_lock<std::mutex> ul(_lock);
+		if (auto kv = _idle.find(cls); kv != _idle.end()) {
+			buffer = std::move(kv->second);
+			_idle.erase(kv);
+			_idle_size -= cls;
+		}
+	}
+
+	if (!buffer) {
+		try {
+			buffer = std::make_unique<memory>(cls);
+		} catch (const std::exception&) {
+			// Idle buffers of other classes may be what stands in the way.
+			trim();
+			buffer = std::make_unique<memory>(cls);
+		}
+	} else {
+		buffer->_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::CUDA, buffer->_size);
+	}
+
+	std::weak_ptr<memory_pool> pool = weak_from_this();
+	return std::shared_ptr<memory>(buffer.release(), [pool](memory* ptr) {
+		std::unique_ptr<memory> buffer{ptr};
+		if (auto self = pool.lock(); self) {
+			self->release(std::move(buffer));
+		}
+	});
+}
+
+void streamfx::nvidia::cuda::memory_pool::trim()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_idle.clear();
+	_idle_size = 0;
+}
+
+void streamfx::nvidia::cuda::memory_pool::release(std::unique_ptr<memory> buffer)
+{
+	// Work still queued on any stream might be using it, and the next user of it may be on a different stream.
+	_cuda->cuCtxSynchronize();
+
+	// Idle buffers belong to nobody in particular.
+	buffer->_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::CUDA, buffer->_size, ::streamfx::util::memory::owner::shared());
+
+	std::unique_lock<std::mutex> ul(_lock);
+	_idle_size += buffer->size();
+	_idle.emplace(buffer->size(), std::move(buffer));
+
+	while ((_idle_size > ST_IDLE_LIMIT) && !_idle.empty()) {
+		auto kv = std::prev(_idle.end());
+		_idle_size -= kv->first;
+		_idle.erase(kv);
+	}
+}
+
+size_t streamfx::nvidia::cuda::memory_pool::size_class(size_t size)
+{
+	// Round up in steps of at most a quarter of the size, so little is wasted while classes stay few.
+	size_t step = ST_GRANULARITY;
+	while ((step * 8) <= size) {
+		step *= 2;
+	}
+	return ((std::max<size_t>(size, 1) + step - 1) / step) * step;
+}
@@ -4,17 +4,23 @@
 
 #pragma once
 #include "nvidia-cuda.hpp"
+#include "util/util-memory.hpp"
 
 #include "warning-disable.hpp"
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <mutex>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cuda {
 	class memory {
+		friend class memory_pool;
+
 		std::shared_ptr<::streamfx::nvidia::cuda::cuda> _cuda;
 		device_ptr_t                                    _pointer;
 		size_t                                          _size;
+		::streamfx::util::memory::allocation            _memory;
 
 		public:
 		~memory();
@@ -24,4 +30,32 @@ namespace streamfx::nvidia::cuda {
 
 		std::size_t size();
 	};
+
+	/** Recycles device memory in size classes, so that resizing doesn't turn into a storm of allocations.
+	 *
+	 * Every request is rounded up to its size class, which wastes at most a quarter of it. Released buffers are kept
+	 * for the next request of the same class, by any effect or instance, until too much memory sits idle.
+	 */
+	class memory_pool : public std::enable_shared_from_this<memory_pool> {
+		std::shared_ptr<::streamfx::nvidia::cuda::cuda> _cuda;
+
+		std::mutex                                     _lock;
+		std::multimap<size_t, std::unique_ptr<memory>> _idle;
+		size_t                                         _idle_size;
+
+		public:
+		~memory_pool();
+		memory_pool();
+
+		/** Acquire a buffer of at least 'size' bytes, which returns to the pool once the last reference is released. */
+		std::shared_ptr<::streamfx::nvidia::cuda::memory> acquire(size_t size);
+
+		/** Free all buffers that are currently not in use. */
+		void trim();
+
+		private:
+		void release(std::unique_ptr<memory> memory);
+
+		static size_t size_class(size_t size);
+	};
 } // namespace streamfx::nvidia::cuda
@@ -6,6 +6,10 @@
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
+#include "warning-disable.hpp"
+#include <algorithm>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -29,13 +33,15 @@ streamfx::nvidia::cuda::obs::~obs()
 		auto stack = _context->enter();
 		_stream->synchronize();
 		_context->synchronize();
+		_streams.clear();
 		_stream.reset();
+		_memory_pool.reset();
 	}
 	_context.reset();
 	_cuda.reset();
 }
 
-streamfx::nvidia::cuda::obs::obs() : _cuda(::streamfx::nvidia::cuda::cuda::get()), _context()
+streamfx::nvidia::cuda::obs::obs() : _cuda(::streamfx::nvidia::cuda::cuda::get()), _context(), _stream(), _memory_pool(), _streams_lock(), _streams(), _priority_lowest(0), _priority_highest(0)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -48,12 +54,33 @@ streamfx::nvidia::cuda::obs::obs() : _cuda(::streamfx::nvidia::cuda::cuda::get()
 	}
 #endif
 	if (gs_get_device_type() == GS_DEVICE_OPENGL) {
-		throw std::runtime_error("Not yet implemented.");
+		// Pick the CUDA device that drives the OpenGL context libOBS is currently using.
+		if (!_cuda->cuGLGetDevices) {
+			throw std::runtime_error("CUDA driver does not support OpenGL interoperability.");
+		}
+
+		uint32_t                           count  = 0;
+		::streamfx::nvidia::cuda::device_t device = 0;
+		if (auto res = _cuda->cuGLGetDevices(&count, &device, 1, ::streamfx::nvidia::cuda::gl_device_list::ALL); (res != ::streamfx::nvidia::cuda::result::SUCCESS) || (count == 0)) {
+			throw std::runtime_error("OpenGL context is not running on a CUDA device.");
+		}
+
+		_context = std::make_shared<::streamfx::nvidia::cuda::context>(device);
+	}
+	if (!_context) {
+		throw std::runtime_error("Graphics device is not supported by CUDA.");
 	}
 
 	// Create Stream
 	auto stack = _context->enter();
-	_stream    = std::make_shared<::streamfx::nvidia::cuda::stream>();
+	_stream      = std::make_shared<::streamfx::nvidia::cuda::stream>();
+	_memory_pool = std::make_shared<::streamfx::nvidia::cuda::memory_pool>();
+
+	// Not every device supports priorities, in which case the range is empty.
+	if (auto res = _cuda->cuCtxGetStreamPriorityRange(&_priority_lowest, &_priority_highest); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		_priority_lowest  = 0;
+		_priority_highest = 0;
+	}
 }
 
 std::shared_ptr<streamfx::nvidia::cuda::obs> streamfx::nvidia::cuda::obs::get()
@@ -61,14 +88,18 @@ std::shared_ptr<streamfx::nvidia::cuda::obs> streamfx::nvidia::cuda::obs::get()
 	static std::weak_ptr<streamfx::nvidia::cuda::obs> instance;
 	static std::mutex                                 lock;
 
-	std::unique_lock<std::mutex> ul(lock);
-	if (instance.expired()) {
-		std::shared_ptr<streamfx::nvidia::cuda::obs> hard_instance;
+	std::unique_lock<std::mutex>                 ul(lock);
+	std::shared_ptr<streamfx::nvidia::cuda::obs> hard_instance = instance.lock();
+	if (!hard_instance) {
 		hard_instance = std::make_shared<streamfx::nvidia::cuda::obs>();
 		instance      = hard_instance;
-		return hard_instance;
 	}
-	return instance.lock();
+
+	// The graphics thread uses the context every frame, so keep it current there instead of entering it every time.
+	if (obs_in_task_thread(OBS_TASK_GRAPHICS)) {
+		hard_instance->_context->bind();
+	}
+	return hard_instance;
 }
 
 std::shared_ptr<streamfx::nvidia::cuda::cuda> streamfx::nvidia::cuda::obs::get_cuda()
@@ -85,3 +116,29 @@ std::shared_ptr<streamfx::nvidia::cuda::stream> streamfx::nvidia::cuda::obs::get
 {
 	return _stream;
 }
+
+std::shared_ptr<streamfx::nvidia::cuda::stream> streamfx::nvidia::cuda::obs::acquire_stream(int32_t priority)
+{
+	// Lower values are higher priorities, so the highest priority is the smallest value.
+	priority = std::clamp(priority, _priority_highest, _priority_lowest);
+
+	std::unique_lock<std::mutex> ul(_streams_lock);
+
+	// Streams only referenced by the pool are no longer in use by anyone.
+	for (auto& stream : _streams) {
+		if ((stream.use_count() == 1) && (stream->get_priority() == priority)) {
+			return stream;
+		}
+	}
+
+	auto stack  = _context->enter();
+	auto stream = std::make_shared<::streamfx::nvidia::cuda::stream>(::streamfx::nvidia::cuda::stream_flags::DEFAULT, priority);
+	_streams.push_back(stream);
+	D_LOG_DEBUG("Created stream %zu with priority %" PRId32 ".", _streams.size(), priority);
+	return stream;
+}
+
+std::shared_ptr<streamfx::nvidia::cuda::memory_pool> streamfx::nvidia::cuda::obs::get_memory_pool()
+{
+	return _memory_pool;
+}
@@ -4,11 +4,14 @@
 
 #pragma once
 #include "nvidia-cuda-context.hpp"
+#include "nvidia-cuda-memory.hpp"
 #include "nvidia-cuda-stream.hpp"
 #include "nvidia-cuda.hpp"
 
 #include "warning-disable.hpp"
 #include <memory>
+#include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cuda {
@@ -17,6 +20,15 @@ namespace streamfx::nvidia::cuda {
 		std::shared_ptr<::streamfx::nvidia::cuda::context> _context;
 		std::shared_ptr<::streamfx::nvidia::cuda::stream>  _stream;
 
+		// Memory Pool
+		std::shared_ptr<::streamfx::nvidia::cuda::memory_pool> _memory_pool;
+
+		// Stream Pool
+		std::mutex                                                      _streams_lock;
+		std::vector<std::shared_ptr<::streamfx::nvidia::cuda::stream>> _streams;
+		int32_t                                                         _priority_lowest;
+		int32_t                                                         _priority_highest;
+
 		public:
 		~obs();
 		obs();
@@ -25,6 +37,15 @@ namespace streamfx::nvidia::cuda {
 		std::shared_ptr<::streamfx::nvidia::cuda::context> get_context();
 		std::shared_ptr<::streamfx::nvidia::cuda::stream>  get_stream();
 
+		/** Acquire a stream for exclusive use, so that independent work can overlap on the GPU.
+		 *
+		 * Streams are returned to the pool once the last reference is released. As in CUDA, lower priority values are
+		 * scheduled first, and values outside of what the device supports are clamped.
+		 */
+		std::shared_ptr<::streamfx::nvidia::cuda::stream> acquire_stream(int32_t priority = 0);
+
+		std::shared_ptr<::streamfx::nvidia::cuda::memory_pool> get_memory_pool();
+
 		public:
 		static std::shared_ptr<::streamfx::nvidia::cuda::obs> get();
 	};
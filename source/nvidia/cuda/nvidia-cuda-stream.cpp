@@ -3,6 +3,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "nvidia-cuda-stream.hpp"
+#include "nvidia-cuda-event.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
@@ -30,7 +31,7 @@ streamfx::nvidia::cuda::stream::~stream()
 	_cuda->cuStreamDestroy(_stream);
 }
 
-streamfx::nvidia::cuda::stream::stream(::streamfx::nvidia::cuda::stream_flags flags, int32_t priority) : _cuda(::streamfx::nvidia::cuda::cuda::get())
+streamfx::nvidia::cuda::stream::stream(::streamfx::nvidia::cuda::stream_flags flags, int32_t priority) : _cuda(::streamfx::nvidia::cuda::cuda::get()), _priority(priority)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -53,6 +54,18 @@ streamfx::nvidia::cuda::stream::stream(::streamfx::nvidia::cuda::stream_flags fl
 	return _stream;
 }
 
+int32_t streamfx::nvidia::cuda::stream::get_priority()
+{
+	return _priority;
+}
+
+void streamfx::nvidia::cuda::stream::wait(std::shared_ptr<::streamfx::nvidia::cuda::event> event)
+{
+	if (auto res = _cuda->cuStreamWaitEvent(_stream, event->get(), 0); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+}
+
 void streamfx::nvidia::cuda::stream::synchronize()
 {
 	//D_LOG_DEBUG("Synchronizing... (Addr: 0x%" PRIuPTR ")", this);
@@ -10,9 +10,12 @@
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cuda {
+	class event;
+
 	class stream {
 		std::shared_ptr<::streamfx::nvidia::cuda::cuda> _cuda;
 		::streamfx::nvidia::cuda::stream_t              _stream;
+		int32_t                                         _priority;
 
 		public:
 		~stream();
@@ -20,6 +23,11 @@ namespace streamfx::nvidia::cuda {
 
 		::streamfx::nvidia::cuda::stream_t get();
 
+		int32_t get_priority();
+
+		/** Make all future work on this stream wait until the event has completed, without blocking the caller. */
+		void wait(std::shared_ptr<::streamfx::nvidia::cuda::event> event);
+
 		void synchronize();
 	};
 } // namespace streamfx::nvidia::cuda
@@ -102,6 +102,9 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 
 	{ // 3. Load remaining functions.
 		// Device Management
+		P_CUDA_LOAD_SYMBOL(cuDeviceGet);
+		P_CUDA_LOAD_SYMBOL(cuDeviceGetAttribute);
+		P_CUDA_LOAD_SYMBOL(cuDeviceGetCount);
 		P_CUDA_LOAD_SYMBOL(cuDeviceGetName);
 		P_CUDA_LOAD_SYMBOL(cuDeviceGetLuid);
 		P_CUDA_LOAD_SYMBOL(cuDeviceGetUuid);
@@ -167,9 +170,16 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		P_CUDA_LOAD_SYMBOL(cuStreamSynchronize);
 		P_CUDA_LOAD_SYMBOL_OPT(cuStreamCreateWithPriority);
 		P_CUDA_LOAD_SYMBOL_OPT(cuStreamGetPriority);
+		P_CUDA_LOAD_SYMBOL(cuStreamWaitEvent);
+		P_CUDA_LOAD_SYMBOL_OPT_EX(cuStreamBeginCapture, cuStreamBeginCapture_v2);
+		P_CUDA_LOAD_SYMBOL_OPT(cuStreamEndCapture);
 
 		// Event Management
-		// - Not yet needed.
+		P_CUDA_LOAD_SYMBOL(cuEventCreate);
+		P_CUDA_LOAD_SYMBOL_V2(cuEventDestroy);
+		P_CUDA_LOAD_SYMBOL(cuEventQuery);
+		P_CUDA_LOAD_SYMBOL(cuEventRecord);
+		P_CUDA_LOAD_SYMBOL(cuEventSynchronize);
 
 		// External Resource Interoperability (CUDA 11.1+)
 		// - Not yet needed.
@@ -180,8 +190,11 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		// Execution Control
 		// - Not yet needed.
 
-		// Graph Management
-		// - Not yet needed.
+		// Graph Management (CUDA 11.4+)
+		P_CUDA_LOAD_SYMBOL_OPT(cuGraphDestroy);
+		P_CUDA_LOAD_SYMBOL_OPT(cuGraphExecDestroy);
+		P_CUDA_LOAD_SYMBOL_OPT(cuGraphInstantiateWithFlags);
+		P_CUDA_LOAD_SYMBOL_OPT(cuGraphLaunch);
 
 		// Occupancy
 		// - Not yet needed.
@@ -200,6 +213,7 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		P_CUDA_LOAD_SYMBOL(cuGraphicsSubResourceGetMappedArray);
 		P_CUDA_LOAD_SYMBOL(cuGraphicsUnmapResources);
 		P_CUDA_LOAD_SYMBOL(cuGraphicsUnregisterResource);
+		P_CUDA_LOAD_SYMBOL_OPT_V2(cuGraphicsResourceSetMapFlags);
 
 		// Driver Entry Point Access
 		// - Not yet needed.
@@ -208,7 +222,8 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		// - Not yet needed.
 
 		// OpenGL Interoperability
-		// - Not yet needed.
+		P_CUDA_LOAD_SYMBOL_OPT_V2(cuGLGetDevices);
+		P_CUDA_LOAD_SYMBOL_OPT(cuGraphicsGLRegisterImage);
 
 		// VDPAU Interoperability
 		// - Not yet needed.
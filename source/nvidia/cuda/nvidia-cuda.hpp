@@ -41,6 +41,7 @@ namespace streamfx::nvidia::cuda {
 		ALREADY_MAPPED           = 208,
 		NOT_MAPPED               = 211,
 		INVALID_GRAPHICS_CONTEXT = 219,
+		NOT_READY                = 600,
 		// Still missing some.
 	};
 
@@ -88,10 +89,51 @@ namespace streamfx::nvidia::cuda {
 		NON_BLOCKING = 0x1,
 	};
 
+	enum class stream_capture_mode : uint32_t {
+		GLOBAL       = 0x0,
+		THREAD_LOCAL = 0x1,
+		RELAXED      = 0x2,
+	};
+
+	enum class event_flags : uint32_t {
+		DEFAULT        = 0x0,
+		BLOCKING_SYNC  = 0x1,
+		DISABLE_TIMING = 0x2,
+		INTERPROCESS   = 0x4,
+	};
+
+	enum class graphics_register_flags : uint32_t {
+		NONE           = 0x0,
+		READ_ONLY      = 0x1,
+		WRITE_DISCARD  = 0x2,
+		SURFACE_LDST   = 0x4,
+		TEXTURE_GATHER = 0x8,
+	};
+
+	enum class graphics_map_flags : uint32_t {
+		NONE          = 0x0,
+		READ_ONLY     = 0x1,
+		WRITE_DISCARD = 0x2,
+	};
+
+	enum class device_attribute : int32_t {
+		COMPUTE_CAPABILITY_MAJOR = 75,
+		COMPUTE_CAPABILITY_MINOR = 76,
+	};
+
+	enum class gl_device_list : uint32_t {
+		ALL           = 0x1,
+		CURRENT_FRAME = 0x2,
+		NEXT_FRAME    = 0x3,
+	};
+
 	typedef void*    array_t;
 	typedef void*    context_t;
 	typedef uint64_t device_ptr_t;
+	typedef void*    event_t;
 	typedef void*    external_memory_t;
+	typedef void*    graph_t;
+	typedef void*    graph_exec_t;
 	typedef void*    graphics_resource_t;
 	typedef void*    stream_t;
 	typedef int32_t  device_t;
@@ -203,6 +245,9 @@ namespace streamfx::nvidia::cuda {
 		P_CUDA_DEFINE_FUNCTION(cuDriverGetVersion, int32_t* driverVersion);
 
 		// Device Management
+		P_CUDA_DEFINE_FUNCTION(cuDeviceGet, device_t* device, int32_t ordinal);
+		P_CUDA_DEFINE_FUNCTION(cuDeviceGetAttribute, int32_t* value, device_attribute attribute, device_t device);
+		P_CUDA_DEFINE_FUNCTION(cuDeviceGetCount, int32_t* count);
 		P_CUDA_DEFINE_FUNCTION(cuDeviceGetName, char* name, int32_t length, device_t device);
 		P_CUDA_DEFINE_FUNCTION(cuDeviceGetLuid, luid_t* luid, uint32_t* device_node_mask, device_t device);
 		P_CUDA_DEFINE_FUNCTION(cuDeviceGetUuid, uuid_t* uuid, device_t device);
@@ -269,9 +314,16 @@ namespace streamfx::nvidia::cuda {
 		P_CUDA_DEFINE_FUNCTION(cuStreamDestroy, stream_t stream);
 		P_CUDA_DEFINE_FUNCTION(cuStreamSynchronize, stream_t stream);
 		P_CUDA_DEFINE_FUNCTION(cuStreamGetPriority, stream_t stream, int32_t* priority);
+		P_CUDA_DEFINE_FUNCTION(cuStreamWaitEvent, stream_t stream, event_t event, uint32_t flags);
+		P_CUDA_DEFINE_FUNCTION(cuStreamBeginCapture, stream_t stream, stream_capture_mode mode);
+		P_CUDA_DEFINE_FUNCTION(cuStreamEndCapture, stream_t stream, graph_t* graph);
 
 		// Event Management
-		// - Not yet needed.
+		P_CUDA_DEFINE_FUNCTION(cuEventCreate, event_t* event, event_flags flags);
+		P_CUDA_DEFINE_FUNCTION(cuEventDestroy, event_t event);
+		P_CUDA_DEFINE_FUNCTION(cuEventQuery, event_t event);
+		P_CUDA_DEFINE_FUNCTION(cuEventRecord, event_t event, stream_t stream);
+		P_CUDA_DEFINE_FUNCTION(cuEventSynchronize, event_t event);
 
 		// External Resource Interoperability (CUDA 11.1+)
 		// - Not yet needed.
@@ -283,7 +335,10 @@ namespace streamfx::nvidia::cuda {
 		// - Not yet needed.
 
 		// Graph Management
-		// - Not yet needed.
+		P_CUDA_DEFINE_FUNCTION(cuGraphDestroy, graph_t graph);
+		P_CUDA_DEFINE_FUNCTION(cuGraphExecDestroy, graph_exec_t graph_exec);
+		P_CUDA_DEFINE_FUNCTION(cuGraphInstantiateWithFlags, graph_exec_t* graph_exec, graph_t graph, uint64_t flags);
+		P_CUDA_DEFINE_FUNCTION(cuGraphLaunch, graph_exec_t graph_exec, stream_t stream);
 
 		// Occupancy
 		// - Not yet needed.
@@ -302,6 +357,7 @@ namespace streamfx::nvidia::cuda {
 		P_CUDA_DEFINE_FUNCTION(cuGraphicsSubResourceGetMappedArray, array_t* array, graphics_resource_t resource, uint32_t index, uint32_t level);
 		P_CUDA_DEFINE_FUNCTION(cuGraphicsUnmapResources, uint32_t count, graphics_resource_t* resources, stream_t stream);
 		P_CUDA_DEFINE_FUNCTION(cuGraphicsUnregisterResource, graphics_resource_t resource);
+		P_CUDA_DEFINE_FUNCTION(cuGraphicsResourceSetMapFlags, graphics_resource_t resource, graphics_map_flags flags);
 
 		// Driver Entry Point Access
 		// - Not yet needed.
@@ -310,7 +366,8 @@ namespace streamfx::nvidia::cuda {
 		// - Not yet needed.
 
 		// OpenGL Interoperability
-		// - Not yet needed.
+		P_CUDA_DEFINE_FUNCTION(cuGLGetDevices, uint32_t* count, device_t* devices, uint32_t max_count, gl_device_list list);
+		P_CUDA_DEFINE_FUNCTION(cuGraphicsGLRegisterImage, graphics_resource_t* resource, uint32_t image, uint32_t target, graphics_register_flags flags);
 
 		// VDPAU Interoperability
 		// - Not yet needed.
@@ -337,3 +394,5 @@ namespace streamfx::nvidia::cuda {
 
 P_ENABLE_BITMASK_OPERATORS(::streamfx::nvidia::cuda::context_flags)
 P_ENABLE_BITMASK_OPERATORS(::streamfx::nvidia::cuda::stream_flags)
+P_ENABLE_BITMASK_OPERATORS(::streamfx::nvidia::cuda::event_flags)
+P_ENABLE_BITMASK_OPERATORS(::streamfx::nvidia::cuda::graphics_register_flags)
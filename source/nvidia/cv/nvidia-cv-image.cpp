@@ -10,6 +10,12 @@
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "obs/gs/gs-helper.hpp"
 
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -33,9 +39,11 @@ image::~image()
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	_cv->NvCVImage_Dealloc(&_image);
+	_memory.reset();
+	_allocation.reset();
 }
 
-image::image() : _cv(::streamfx::nvidia::cv::cv::get()), _image(), _alignment(1)
+image::image() : _cv(::streamfx::nvidia::cv::cv::get()), _image(), _alignment(1), _memory(), _allocation()
 {
 	// Forcefully clear the image storage.
 	memset(&_image, sizeof(_image), 0);
@@ -47,8 +55,12 @@ image::image(uint32_t width, uint32_t height, pixel_format pix_fmt, component_ty
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	_alignment = alignment;
-	if (auto res = _cv->NvCVImage_Alloc(&_image, width, height, pix_fmt, cmp_type, static_cast<uint32_t>(cmp_layout), static_cast<uint32_t>(location), _alignment); res != result::SUCCESS) {
+	if (is_pooled(cmp_layout, location)) {
+		allocate_pooled(width, height, pix_fmt, cmp_type, cmp_layout, location, alignment);
+	} else if (auto res = _cv->NvCVImage_Alloc(&_image, width, height, pix_fmt, cmp_type, static_cast<uint32_t>(cmp_layout), static_cast<uint32_t>(location), _alignment); res != result::SUCCESS) {
 		throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
+	} else if (location == memory_location::GPU) {
+		_allocation = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::CV, _image.buffer_bytes);
 	}
 }
 
@@ -57,8 +69,25 @@ void streamfx::nvidia::cv::image::reallocate(uint32_t width, uint32_t height, pi
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
-	if (auto res = _cv->NvCVImage_Realloc(&_image, width, height, pix_fmt, cmp_type, static_cast<uint32_t>(cmp_layout), static_cast<uint32_t>(location), alignment); res != result::SUCCESS) {
-		throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
+	if (is_pooled(cmp_layout, location)) {
+		allocate_pooled(width, height, pix_fmt, cmp_type, cmp_layout, location, alignment);
+	} else {
+		// Pooled storage isn't owned by the image, so the SDK must not try to reuse it.
+		if (_memory) {
+			std::memset(&_image, 0, sizeof(_image));
+			_memory.reset();
+		}
+
+		if (auto res = _cv->NvCVImage_Realloc(&_image, width, height, pix_fmt, cmp_type, static_cast<uint32_t>(cmp_layout), static_cast<uint32_t>(location), alignment); res != result::SUCCESS) {
+			throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
+		}
+	}
+
+	// Pooled storage is already accounted for by the pool.
+	if (!_memory && (location == memory_location::GPU)) {
+		_allocation = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::CV, _image.buffer_bytes);
+	} else {
+		_allocation.reset();
 	}
 	_alignment = alignment;
 }
@@ -68,6 +97,39 @@ void streamfx::nvidia::cv::image::resize(uint32_t width, uint32_t height)
 	reallocate(width, height, _image.pxl_format, _image.comp_type, static_cast<component_layout>(_image.comp_layout), static_cast<memory_location>(_image.mem_location), _alignment);
 }
 
+bool streamfx::nvidia::cv::image::is_pooled(component_layout cmp_layout, memory_location location)
+{
+	// The layout of these is simple enough to size the storage ourselves.
+	return (location == memory_location::GPU) && ((cmp_layout == component_layout::INTERLEAVED) || (cmp_layout == component_layout::PLANAR));
+}
+
+void streamfx::nvidia::cv::image::allocate_pooled(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment)
+{
+	// Let the SDK tell us the size of pixels and components, without allocating anything.
+	image_t probe;
+	std::memset(&probe, 0, sizeof(probe));
+	if (auto res = _cv->NvCVImage_Init(&probe, width, height, 0, nullptr, pix_fmt, cmp_type, cmp_layout, location); res != result::SUCCESS) {
+		throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
+	}
+
+	// Interleaved images are one plane of whole pixels, planar ones have a plane per component.
+	size_t row   = static_cast<size_t>(width) * ((cmp_layout == component_layout::INTERLEAVED) ? probe.pixel_bytes : probe.component_bytes);
+	size_t rows  = static_cast<size_t>(height) * ((cmp_layout == component_layout::INTERLEAVED) ? 1 : probe.num_components);
+	size_t align = std::max<size_t>(alignment, 1);
+	size_t pitch = ((row + align - 1) / align) * align;
+
+	// Acquire first, so that the old storage can't be handed right back while it is still in place.
+	auto memory = ::streamfx::nvidia::cuda::obs::get()->get_memory_pool()->acquire(pitch * rows);
+
+	_cv->NvCVImage_Dealloc(&_image);
+	std::memset(&_image, 0, sizeof(_image));
+	_memory = memory;
+	if (auto res = _cv->NvCVImage_Init(&_image, width, height, static_cast<uint32_t>(pitch), reinterpret_cast<void*>(_memory->get()), pix_fmt, cmp_type, cmp_layout, location); res != result::SUCCESS) {
+		_memory.reset();
+		throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
+	}
+}
+
 streamfx::nvidia::cv::image_t* streamfx::nvidia::cv::image::get_image()
 {
 	return &_image;
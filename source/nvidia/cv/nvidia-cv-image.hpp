@@ -3,10 +3,12 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "nvidia/cuda/nvidia-cuda-memory.hpp"
 #include "nvidia/cv/nvidia-cv.hpp"
 
 #include "warning-disable.hpp"
 #include <cinttypes>
+#include <memory>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cv {
@@ -21,6 +23,12 @@ namespace streamfx::nvidia::cv {
 		image_t                                     _image;
 		uint32_t                                    _alignment;
 
+		// Storage of GPU images, borrowed from the shared pool.
+		std::shared_ptr<::streamfx::nvidia::cuda::memory> _memory;
+
+		// Storage that the SDK allocated by itself, which the pool knows nothing about.
+		::streamfx::util::memory::allocation _allocation;
+
 		public:
 		virtual ~image();
 
@@ -35,6 +43,11 @@ namespace streamfx::nvidia::cv {
 		virtual void resize(uint32_t width, uint32_t height);
 
 		virtual ::streamfx::nvidia::cv::image_t* get_image();
+
+		private:
+		static bool is_pooled(component_layout cmp_layout, memory_location location);
+
+		void allocate_pooled(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment);
 	};
 
 } // namespace streamfx::nvidia::cv
@@ -83,6 +83,9 @@ void streamfx::nvidia::cv::texture::alloc()
 		D_LOG_ERROR("Object 0x%" PRIxPTR " failed NvCVImage_MapResource call with error: %s", this, _cv->NvCV_GetErrorStringFromCode(res));
 		throw std::runtime_error("NvCVImage_MapResource");
 	}
+
+	// Effects run on streams of their own, which must not see the resource before the mapping completed.
+	nvobs->get_stream()->synchronize();
 }
 
 void streamfx::nvidia::cv::texture::free()
@@ -91,6 +94,9 @@ void streamfx::nvidia::cv::texture::free()
 	auto cctx  = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 	auto nvobs = ::streamfx::nvidia::cuda::obs::get();
 
+	// Effects run on streams of their own, any of which may still be working with the resource.
+	nvobs->get_context()->synchronize();
+
 	// Unmap and deallocate any relevant CV buffers.
 	if (auto res = _cv->NvCVImage_UnmapResource(&_image, nvobs->get_stream()->get()); res != result::SUCCESS) {
 		D_LOG_ERROR("Object 0x%" PRIxPTR " failed NvCVImage_UnmapResource call with error: %s", this, _cv->NvCV_GetErrorStringFromCode(res));
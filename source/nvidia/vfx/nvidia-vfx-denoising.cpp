@@ -26,13 +26,22 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
+// Number of resolutions whose temporal state is kept around for when they come back.
+constexpr std::size_t state_pool_size = 4;
+
 streamfx::nvidia::vfx::denoising::~denoising()
 {
+	load_wait();
+
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
-	// Clean up state buffer.
+	// Clean up state buffers.
 	_nvcuda->get_cuda()->cuMemFree(_state);
+	for (auto& entry : _state_pool) {
+		_nvcuda->get_cuda()->cuMemFree(entry.state);
+	}
+	_state_pool.clear();
 
 	// Clean up any CUDA resources in use.
 	_input.reset();
@@ -44,10 +53,9 @@ streamfx::nvidia::vfx::denoising::~denoising()
 	_tmp.reset();
 }
 
-streamfx::nvidia::vfx::denoising::denoising() : effect(EFFECT_DENOISING), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _state(0), _state_size(0), _strength(1.)
+streamfx::nvidia::vfx::denoising::denoising() : effect(EFFECT_DENOISING), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _direct_input(true), _direct_output(true), _half_precision(false), _half_precision_supported(true), _state(0), _state_size(0), _state_width(0), _state_height(0), _state_half_precision(false), _state_pool(), _strength(1.)
 {
-	// Enter Graphics and CUDA context.
-	auto gctx = ::streamfx::obs::gs::context();
+	// Enter CUDA context, loading the model does not need the graphics context.
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	// Set the strength, scale and buffers.
@@ -60,6 +68,8 @@ streamfx::nvidia::vfx::denoising::denoising() : effect(EFFECT_DENOISING), _dirty
 
 void streamfx::nvidia::vfx::denoising::set_strength(float strength)
 {
+	std::unique_lock<std::mutex> ul(_load_lock);
+
 	std::swap(_strength, strength);
 
 	// If anything was changed, flag the effect as dirty.
@@ -67,7 +77,6 @@ void streamfx::nvidia::vfx::denoising::set_strength(float strength)
 		_dirty = true;
 
 	// Update Effect
-	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = _nvcuda->get_context()->enter();
 	if (auto res = set(PARAMETER_STRENGTH, _strength); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 		D_LOG_ERROR("Failed to set '%s' to %1.3f.", PARAMETER_STRENGTH, _strength);
@@ -100,6 +109,34 @@ void streamfx::nvidia::vfx::denoising::size(std::pair<uint32_t, uint32_t>& size)
 	}
 }
 
+void streamfx::nvidia::vfx::denoising::set_half_precision(bool enabled)
+{
+	std::unique_lock<std::mutex> ul(_load_lock);
+
+	if (_half_precision == enabled) {
+		return;
+	}
+	_half_precision = enabled;
+
+	// The buffers handed to the effect have to be recreated with the other component type, once nothing uses them.
+	auto cctx = _nvcuda->get_context()->enter();
+	pipeline_wait();
+	graph_reset();
+	_source.reset();
+	_destination.reset();
+	_dirty = true;
+}
+
+bool streamfx::nvidia::vfx::denoising::is_half_precision()
+{
+	return _half_precision && _half_precision_supported;
+}
+
+::streamfx::nvidia::cv::component_type streamfx::nvidia::vfx::denoising::precision()
+{
+	return is_half_precision() ? ::streamfx::nvidia::cv::component_type::FP16 : ::streamfx::nvidia::cv::component_type::FP32;
+}
+
 std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::denoising::process(std::shared_ptr<::streamfx::obs::gs::texture> in)
 {
 	// Enter Graphics and CUDA context.
@@ -110,12 +147,26 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::denoising::
 	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Denoising"};
 #endif
 
+	// Pass the input through while the effect is being loaded.
+	std::unique_lock<std::mutex> ul(_load_lock, std::try_to_lock);
+	if (!ul.owns_lock() || is_loading()) {
+		return in;
+	}
+
+	// Retrieve the result of the previous frame first, before anything can overwrite it.
+	bool have_result = pipeline_wait();
+
 	// Resize if the size or scale was changed.
 	resize(in->get_width(), in->get_height());
 
-	// Reload effect if dirty.
+	// Reload effect in the background if dirty, and pass the input through until it finished.
 	if (_dirty) {
-		load();
+		load_async([this]() { load(); });
+		return in;
+	}
+
+	if (have_result) {
+		convert_output(in->get_width(), in->get_height());
 	}
 
 	{ // Copy parameter to input.
@@ -125,58 +176,78 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::denoising::
 		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
 	}
 
-	{ // Convert Input to Source format
+	{ // Process source to destination.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Input -> Source"};
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Process"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f / 255.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
+		// The conversions are part of the run, so that all of it can be captured into a single graph.
+		uint32_t              width  = in->get_width();
+		uint32_t              height = in->get_height();
+		std::function<void()> after;
+		if (!is_pipelined()) {
+			after = [this, width, height]() { convert_output(width, height); };
 		}
+		pipeline_run([this, width, height]() { convert_input(width, height); }, after);
+	}
+
+	// Without pipelining, the result is available right away.
+	if (!is_pipelined()) {
+		have_result = true;
 	}
 
-	{ // Copy input to source.
+	// Return output, or the unprocessed input until the first result is available.
+	return have_result ? _output->get_texture() : in;
+}
+
+void streamfx::nvidia::vfx::denoising::convert_input(uint32_t width, uint32_t height)
+{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Input -> Source"};
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Input -> Source"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+	// A single transfer handles type, layout and channel order at once, without a full frame in between.
+	if (_direct_input) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f / 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_WARNING("Direct transfer from input to processing source failed with error '%s', falling back to intermediate conversion.", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			_direct_input = false;
+			resize(width, height);
+		}
+	}
+
+	if (!_direct_input) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f / 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			throw std::runtime_error("Transfer failed.");
+		}
+		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
 	}
+}
 
-	{ // Process source to destination.
+void streamfx::nvidia::vfx::denoising::convert_output(uint32_t width, uint32_t height)
+{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Process"};
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Destination -> Output"};
 #endif
-		if (auto res = _nvvfx->NvVFX_Run(_fx.get(), 0); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to process due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Run failed.");
+	if (_direct_output) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_WARNING("Direct transfer from processing result to output failed with error '%s', falling back to intermediate conversion.", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			_direct_output = false;
+			resize(width, height);
 		}
 	}
 
-	{ // Convert Destination to Output format
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Destination -> Output"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 255.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+	if (!_direct_output) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
-	}
-
-	{ // Copy destination to output.
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Destination -> Output"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
 	}
-
-	// Return output.
-	return _output->get_texture();
 }
 
 void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
@@ -194,21 +265,26 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 		} else {
 			_input = std::make_shared<::streamfx::nvidia::cv::texture>(width, height, GS_RGBA_UNORM);
 		}
+
+		graph_reset();
 	}
 
-	if (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != width) || (_convert_to_fp32->get_image()->height != height)) {
+	// Only needed if the direct transfer isn't supported.
+	if (!_direct_input && (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != width) || (_convert_to_fp32->get_image()->height != height))) {
 		if (_convert_to_fp32) {
 			_convert_to_fp32->resize(width, height);
 		} else {
 			_convert_to_fp32 = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::FP32, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
+
+		graph_reset();
 	}
 
 	if (!_source || (_source->get_image()->width != width) || (_source->get_image()->height != height)) {
 		if (_source) {
 			_source->resize(width, height);
 		} else {
-			_source = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::BGR, ::streamfx::nvidia::cv::component_type::FP32, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+			_source = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::BGR, precision(), ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
 
 		if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_INPUT_IMAGE_0, _source); res != ::streamfx::nvidia::cv::result::SUCCESS) {
@@ -224,7 +300,7 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 		if (_destination) {
 			_destination->resize(width, height);
 		} else {
-			_destination = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::BGR, ::streamfx::nvidia::cv::component_type::FP32, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+			_destination = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::BGR, precision(), ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
 
 		if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_OUTPUT_IMAGE_0, _destination); res != ::streamfx::nvidia::cv::result::SUCCESS) {
@@ -236,12 +312,15 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 		_dirty = true;
 	}
 
-	if (!_convert_to_u8 || (_convert_to_u8->get_image()->width != width) || (_convert_to_u8->get_image()->height != height)) {
+	// Only needed if the direct transfer isn't supported.
+	if (!_direct_output && (!_convert_to_u8 || (_convert_to_u8->get_image()->width != width) || (_convert_to_u8->get_image()->height != height))) {
 		if (_convert_to_u8) {
 			_convert_to_u8->resize(width, height);
 		} else {
 			_convert_to_u8 = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::INTERLEAVED, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
+
+		graph_reset();
 	}
 
 	if (!_output || (_output->get_image()->width != width) || (_output->get_image()->height != height)) {
@@ -250,16 +329,42 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 		} else {
 			_output = std::make_shared<::streamfx::nvidia::cv::texture>(width, height, GS_RGBA_UNORM);
 		}
+
+		graph_reset();
 	}
 
-	if (!_state || _dirty) { // Reallocate and clean state.
-		if (_state) {
-			_nvcuda->get_cuda()->cuMemFree(_state);
+	if (!_state || _dirty) {
+		uint32_t state_size = 0;
+		bool     half       = is_half_precision();
+		_nvvfx->NvVFX_GetU32(_fx.get(), ::streamfx::nvidia::vfx::PARAMETER_STATE_SIZE, &state_size);
+
+		// Park the state instead of throwing it away, sources often return to their previous resolution.
+		if (_state && ((_state_width != width) || (_state_height != height) || (_state_half_precision != half) || (_state_size != state_size))) {
+			_state_pool.push_front({_state_width, _state_height, _state_half_precision, _state, _state_size});
+			_state = 0;
+
+			while (_state_pool.size() > state_pool_size) {
+				_nvcuda->get_cuda()->cuMemFree(_state_pool.back().state);
+				_state_pool.pop_back();
+			}
 		}
 
-		_nvvfx->NvVFX_GetU32(_fx.get(), ::streamfx::nvidia::vfx::PARAMETER_STATE_SIZE, &_state_size);
-		_nvcuda->get_cuda()->cuMemAlloc(&_state, _state_size);
-		_nvcuda->get_cuda()->cuMemsetD8(_state, 0, _state_size);
+		if (!_state) { // Resume a parked state, or start over with a clean one.
+			auto iter = std::find_if(_state_pool.begin(), _state_pool.end(), [width, height, half, state_size](const state_entry& entry) { return (entry.width == width) && (entry.height == height) && (entry.half_precision == half) && (entry.size == state_size); });
+			if (iter != _state_pool.end()) {
+				_state = iter->state;
+				_state_pool.erase(iter);
+				D_LOG_DEBUG("Resumed temporal state for %" PRIu32 "x%" PRIu32 ".", width, height);
+			} else {
+				_nvcuda->get_cuda()->cuMemAlloc(&_state, state_size);
+				_nvcuda->get_cuda()->cuMemsetD8(_state, 0, state_size);
+			}
+
+			_state_size           = state_size;
+			_state_width          = width;
+			_state_height         = height;
+			_state_half_precision = half;
+		}
 
 		_states[0] = reinterpret_cast<void*>(_state);
 		if (auto res = _nvvfx->NvVFX_SetObject(_fx.get(), ::streamfx::nvidia::vfx::PARAMETER_STATE, reinterpret_cast<void*>(_states)); res != ::streamfx::nvidia::cv::result::SUCCESS) {
@@ -273,10 +378,18 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 
 void streamfx::nvidia::vfx::denoising::load()
 {
-	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	if (auto res = effect::load(); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		if (is_half_precision()) {
+			// Older models only accept full precision, so try again with that on the next frame.
+			D_LOG_WARNING("Failed to initialize effect in half precision due to error '%s', falling back to full precision.", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			_half_precision_supported = false;
+			_source.reset();
+			_destination.reset();
+			return;
+		}
+
 		D_LOG_ERROR("Failed to initialize effect due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 		throw std::runtime_error("Load failed.");
 	}
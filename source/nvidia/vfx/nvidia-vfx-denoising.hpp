@@ -12,6 +12,10 @@
 #include "nvidia/cv/nvidia-cv-texture.hpp"
 #include "obs/gs/gs-texture.hpp"
 
+#include "warning-disable.hpp"
+#include <list>
+#include "warning-enable.hpp"
+
 namespace streamfx::nvidia::vfx {
 	class denoising : protected effect {
 		bool _dirty;
@@ -23,10 +27,26 @@ namespace streamfx::nvidia::vfx {
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _convert_to_u8;
 		std::shared_ptr<::streamfx::nvidia::cv::texture> _output;
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _tmp;
+		bool                                             _direct_input;
+		bool                                             _direct_output;
+		bool                                             _half_precision;
+		bool                                             _half_precision_supported;
 
+		// Temporal state of the effect, which only fits the resolution and precision it was built up with.
+		struct state_entry {
+			uint32_t                               width;
+			uint32_t                               height;
+			bool                                   half_precision;
+			::streamfx::nvidia::cuda::device_ptr_t state;
+			uint32_t                               size;
+		};
 		void*                                  _states[1];
 		::streamfx::nvidia::cuda::device_ptr_t _state;
 		uint32_t                               _state_size;
+		uint32_t                               _state_width;
+		uint32_t                               _state_height;
+		bool                                   _state_half_precision;
+		std::list<state_entry>                 _state_pool; // Parked states of other resolutions, most recent first.
 
 		float _strength;
 
@@ -39,11 +59,26 @@ namespace streamfx::nvidia::vfx {
 
 		void size(std::pair<uint32_t, uint32_t>& size);
 
+		/** Process in half instead of full precision, which halves the size and bandwidth of the buffers.
+		 *
+		 * Falls back to full precision if the installed models don't support it.
+		 */
+		void set_half_precision(bool enabled);
+		bool is_half_precision();
+
 		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
+		using effect::is_pipelined;
+		using effect::set_pipelined;
+
 		private:
 		void resize(uint32_t width, uint32_t height);
 
+		void convert_input(uint32_t width, uint32_t height);
+		void convert_output(uint32_t width, uint32_t height);
+
+		::streamfx::nvidia::cv::component_type precision();
+
 		void load();
 	};
 } // namespace streamfx::nvidia::vfx
@@ -4,9 +4,11 @@
 
 #include "nvidia-vfx-effect.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <stdexcept>
 #include <string_view>
 #include "warning-enable.hpp"
 
@@ -28,16 +30,29 @@ using namespace ::streamfx::nvidia;
 
 streamfx::nvidia::vfx::effect::~effect()
 {
+	load_wait();
+
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = cuda::obs::get()->get_context()->enter();
 
+	// The effect must not be destroyed while it is still running.
+	if (_pipeline_pending) {
+		try {
+			_pipeline_event->synchronize();
+		} catch (...) {
+		}
+	}
+	_pipeline_event.reset();
+	graph_reset();
+
 	_fx.reset();
+	_stream.reset();
 	_nvvfx.reset();
 	_nvcvi.reset();
 	_nvcuda.reset();
 }
 
-streamfx::nvidia::vfx::effect::effect(effect_t effect) : _nvcuda(cuda::obs::get()), _nvcvi(cv::cv::get()), _nvvfx(vfx::vfx::get()), _fx()
+streamfx::nvidia::vfx::effect::effect(effect_t effect) : _nvcuda(cuda::obs::get()), _stream(_nvcuda->acquire_stream()), _nvcvi(cv::cv::get()), _nvvfx(vfx::vfx::get()), _fx(), _model_path(), _pipeline_event(), _pipelined(false), _pipeline_pending(false), _graph(nullptr), _graph_supported(false), _graph_capturing(false), _graph_invalid(false), _load_lock(), _load_task()
 {
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = cuda::obs::get()->get_context()->enter();
@@ -51,7 +66,7 @@ streamfx::nvidia::vfx::effect::effect(effect_t effect) : _nvcuda(cuda::obs::get(
 	_fx = std::shared_ptr<void>(handle, [](::vfx::handle_t handle) { ::vfx::vfx::get()->NvVFX_DestroyEffect(handle); });
 
 	// Assign CUDA Stream object.
-	if (auto v = set(PARAMETER_CUDA_STREAM, _nvcuda->get_stream()); v != cv::result::SUCCESS) {
+	if (auto v = set(PARAMETER_CUDA_STREAM, _stream); v != cv::result::SUCCESS) {
 		throw ::streamfx::nvidia::cv::exception(PARAMETER_CUDA_STREAM, v);
 	}
 
@@ -60,6 +75,12 @@ streamfx::nvidia::vfx::effect::effect(effect_t effect) : _nvcuda(cuda::obs::get(
 	if (auto v = set(PARAMETER_MODEL_DIRECTORY, _model_path); v != cv::result::SUCCESS) {
 		throw ::streamfx::nvidia::cv::exception(PARAMETER_MODEL_DIRECTORY, v);
 	}
+
+	// Graphs need CUDA 11.4 or newer.
+	{
+		auto nvcuda      = _nvcuda->get_cuda();
+		_graph_supported = nvcuda->cuStreamBeginCapture && nvcuda->cuStreamEndCapture && nvcuda->cuGraphInstantiateWithFlags && nvcuda->cuGraphLaunch && nvcuda->cuGraphExecDestroy && nvcuda->cuGraphDestroy;
+	}
 }
 
 cv::result streamfx::nvidia::vfx::effect::get(parameter_t param, std::string_view& value)
@@ -89,3 +110,173 @@ cv::result streamfx::nvidia::vfx::effect::get(parameter_t param, std::string& va
 	}
 	return res;
 }
+
+void streamfx::nvidia::vfx::effect::set_pipelined(bool enabled)
+{
+	std::unique_lock<std::mutex> ul(_load_lock);
+
+	if (_pipelined == enabled) {
+		return;
+	}
+
+	auto cctx = _nvcuda->get_context()->enter();
+
+	// Finish whatever is still in flight, its result belongs to the previous mode.
+	pipeline_wait();
+	_pipeline_pending = false;
+
+	// The conversion of the output is only part of the captured work without pipelining.
+	graph_reset();
+
+	_pipelined = enabled;
+	if (_pipelined && !_pipeline_event) {
+		_pipeline_event = std::make_shared<cuda::event>();
+	}
+}
+
+bool streamfx::nvidia::vfx::effect::is_pipelined()
+{
+	return _pipelined;
+}
+
+bool streamfx::nvidia::vfx::effect::is_loading()
+{
+	return _load_task && !_load_task->is_completed();
+}
+
+void streamfx::nvidia::vfx::effect::load_async(std::function<void()> loader)
+{
+	if (is_loading()) {
+		return;
+	}
+
+	_load_task = ::streamfx::threadpool()->push(
+		[this, loader](::streamfx::util::threadpool::task_data_t) {
+			std::unique_lock<std::mutex> ul(_load_lock);
+			auto                         cctx = _nvcuda->get_context()->enter();
+			loader();
+		},
+		nullptr, ::streamfx::util::threadpool::priority::BACKGROUND);
+}
+
+void streamfx::nvidia::vfx::effect::load_wait()
+{
+	if (!_load_task) {
+		return;
+	}
+
+	::streamfx::threadpool()->pop(_load_task);
+	_load_task->await_completion();
+	_load_task.reset();
+}
+
+bool streamfx::nvidia::vfx::effect::pipeline_wait()
+{
+	if (!_pipeline_pending) {
+		return false;
+	}
+
+	// Usually already complete, as a whole frame passed since the run was started.
+	_pipeline_event->synchronize();
+	_pipeline_pending = false;
+	return true;
+}
+
+void streamfx::nvidia::vfx::effect::pipeline_run(const std::function<void()>& before, const std::function<void()>& after)
+{
+	auto work = [this, &before, &after]() {
+		if (before) {
+			before();
+		}
+
+		// Waiting is impossible while capturing, so this is always asynchronous and synchronized below instead.
+		if (auto res = run(true); res != cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to process due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			throw std::runtime_error("Run failed.");
+		}
+		if (after) {
+			after();
+		}
+	};
+
+	if (_graph_supported && !_graph) {
+		graph_capture(work);
+	}
+
+	if (_graph) {
+		if (auto res = _nvcuda->get_cuda()->cuGraphLaunch(_graph, _stream->get()); res != cuda::result::SUCCESS) {
+			throw cuda::cuda_error(res);
+		}
+	} else {
+		work();
+	}
+
+	if (_pipelined) {
+		_pipeline_event->record(_stream);
+		_pipeline_pending = true;
+	} else {
+		_stream->synchronize();
+	}
+}
+
+void streamfx::nvidia::vfx::effect::graph_reset()
+{
+	// Anything changed while capturing can't be undone, so the graph is thrown away once capturing ends.
+	if (_graph_capturing) {
+		_graph_invalid = true;
+		return;
+	}
+
+	if (_graph) {
+		_nvcuda->get_cuda()->cuGraphExecDestroy(_graph);
+		_graph = nullptr;
+	}
+}
+
+bool streamfx::nvidia::vfx::effect::graph_capture(const std::function<void()>& work)
+{
+	auto nvcuda = _nvcuda->get_cuda();
+
+	if (auto res = nvcuda->cuStreamBeginCapture(_stream->get(), cuda::stream_capture_mode::RELAXED); res != cuda::result::SUCCESS) {
+		D_LOG_WARNING("Unable to capture work into a graph (error %zu), issuing it directly instead.", static_cast<size_t>(res));
+		_graph_supported = false;
+		return false;
+	}
+
+	bool captured    = true;
+	_graph_capturing = true;
+	_graph_invalid   = false;
+	try {
+		work();
+	} catch (const std::exception& ex) {
+		D_LOG_WARNING("Failed to capture work into a graph, issuing it directly instead: %s", ex.what());
+		captured = false;
+	}
+	_graph_capturing = false;
+
+	cuda::graph_t graph = nullptr;
+	if (auto res = nvcuda->cuStreamEndCapture(_stream->get(), &graph); res != cuda::result::SUCCESS) {
+		if (captured) {
+			D_LOG_WARNING("Failed to capture work into a graph (error %zu), issuing it directly instead.", static_cast<size_t>(res));
+		}
+		captured = false;
+	}
+
+	// Some part of the SDK can't be captured, which won't change later on.
+	if (!captured) {
+		_graph_supported = false;
+	}
+
+	if (captured && !_graph_invalid) {
+		if (auto res = nvcuda->cuGraphInstantiateWithFlags(&_graph, graph, 0); res != cuda::result::SUCCESS) {
+			D_LOG_WARNING("Failed to instantiate graph (error %zu), issuing work directly instead.", static_cast<size_t>(res));
+			_graph           = nullptr;
+			_graph_supported = false;
+		}
+	}
+
+	if (graph) {
+		nvcuda->cuGraphDestroy(graph);
+	}
+	return _graph != nullptr;
+}
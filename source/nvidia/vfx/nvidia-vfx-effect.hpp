@@ -4,6 +4,7 @@
 
 #pragma once
 #include "nvidia-vfx.hpp"
+#include "nvidia/cuda/nvidia-cuda-event.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "nvidia/cuda/nvidia-cuda-stream.hpp"
 #include "nvidia/cuda/nvidia-cuda.hpp"
@@ -11,9 +12,12 @@
 #include "nvidia/cv/nvidia-cv-texture.hpp"
 #include "nvidia/cv/nvidia-cv.hpp"
 #include "nvidia/vfx/nvidia-vfx.hpp"
+#include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include "warning-enable.hpp"
@@ -23,11 +27,27 @@ namespace streamfx::nvidia::vfx {
 
 	class effect {
 		protected:
-		std::shared_ptr<cuda::obs> _nvcuda;
-		std::shared_ptr<cv::cv>    _nvcvi;
-		std::shared_ptr<vfx>       _nvvfx;
-		std::shared_ptr<void>      _fx;
-		std::string                _model_path;
+		std::shared_ptr<cuda::obs>    _nvcuda;
+		std::shared_ptr<cuda::stream> _stream;
+		std::shared_ptr<cv::cv>       _nvcvi;
+		std::shared_ptr<vfx>          _nvvfx;
+		std::shared_ptr<void>         _fx;
+		std::string                   _model_path;
+
+		// Pipelining
+		std::shared_ptr<cuda::event> _pipeline_event;
+		bool                         _pipelined;
+		bool                         _pipeline_pending;
+
+		// Graphs
+		cuda::graph_exec_t _graph;
+		bool               _graph_supported;
+		bool               _graph_capturing;
+		bool               _graph_invalid;
+
+		// Loading
+		std::mutex                                          _load_lock;
+		std::shared_ptr<::streamfx::util::threadpool::task> _load_task;
 
 		public:
 		~effect();
@@ -164,6 +184,7 @@ namespace streamfx::nvidia::vfx {
 		public /* Control */:
 		inline cv::result load()
 		{
+			graph_reset();
 			return _nvvfx->NvVFX_Load(_fx.get());
 		};
 
@@ -171,5 +192,50 @@ namespace streamfx::nvidia::vfx {
 		{
 			return _nvvfx->NvVFX_Run(_fx.get(), async ? 1 : 0);
 		};
+
+		public /* Pipelining */:
+		/** Run the effect asynchronously, and retrieve the result one frame later.
+		 *
+		 * Inference then overlaps with the rest of the frame instead of stalling the graphics thread, at the cost of one
+		 * frame of latency.
+		 */
+		void set_pipelined(bool enabled);
+		bool is_pipelined();
+
+		public /* Loading */:
+		/** Whether a load queued with 'load_async' has not finished yet. */
+		bool is_loading();
+
+		protected:
+		/** Load the model on the thread pool, so that the graphics thread never waits for it.
+		 *
+		 * 'loader' runs with '_load_lock' and the CUDA context held. Implementations of 'process' must pass their input
+		 * through while they can't acquire '_load_lock' or 'is_loading' is true.
+		 */
+		void load_async(std::function<void()> loader);
+
+		/** Cancel or wait for a queued load, which must happen before anything it uses is destroyed. */
+		void load_wait();
+
+		protected:
+		/** Wait for the run started in the previous frame.
+		 *
+		 * @return true if there is a result that has not been retrieved yet.
+		 */
+		bool pipeline_wait();
+
+		/** Run the effect along with the transfers around it, which is only asynchronous while pipelined.
+		 *
+		 * 'before' and 'after' are optional, and must only enqueue work on '_stream'. At a fixed resolution the sequence is identical
+		 * every frame, so it is captured into a CUDA graph on the first call and replayed from then on, which costs far
+		 * less to launch. If capturing fails, the sequence is simply issued directly from then on.
+		 */
+		void pipeline_run(const std::function<void()>& before, const std::function<void()>& after);
+
+		/** Discard the captured graph, as buffers or parameters it depends on were changed. */
+		void graph_reset();
+
+		private:
+		bool graph_capture(const std::function<void()>& work);
 	};
 } // namespace streamfx::nvidia::vfx
@@ -9,7 +9,9 @@
 #include "util/utility.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <utility>
 #include "warning-enable.hpp"
 
@@ -32,6 +34,8 @@
 
 streamfx::nvidia::vfx::greenscreen::~greenscreen()
 {
+	load_wait();
+
 	// Enter Contexts.
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
@@ -44,7 +48,7 @@ streamfx::nvidia::vfx::greenscreen::~greenscreen()
 	_buffer.clear();
 }
 
-streamfx::nvidia::vfx::greenscreen::greenscreen() : effect(EFFECT_GREEN_SCREEN), _dirty(true), _input(), _source(), _destination(), _output(), _tmp()
+streamfx::nvidia::vfx::greenscreen::greenscreen() : effect(EFFECT_GREEN_SCREEN), _dirty(true), _input(), _source(), _destination(), _output(), _tmp(), _interval(1), _skipped(std::numeric_limits<uint32_t>::max())
 {
 	// Enter Contexts.
 	auto gctx = ::streamfx::obs::gs::context();
@@ -78,10 +82,17 @@ void streamfx::nvidia::vfx::greenscreen::size(std::pair<uint32_t, uint32_t>& siz
 
 void streamfx::nvidia::vfx::greenscreen::set_mode(greenscreen_mode mode)
 {
+	std::unique_lock<std::mutex> ul(_load_lock);
+
 	set(PARAMETER_MODE, static_cast<uint32_t>(mode));
 	_dirty = true;
 }
 
+void streamfx::nvidia::vfx::greenscreen::set_interval(uint32_t interval)
+{
+	_interval = std::max<uint32_t>(interval, 1);
+}
+
 std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::process(std::shared_ptr<::streamfx::obs::gs::texture> in)
 {
 	// Enter Graphics and CUDA context.
@@ -92,19 +103,27 @@ std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::
 	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Background Removal"};
 #endif
 
+	// Pass the input through while the effect is being loaded.
+	std::unique_lock<std::mutex> ul(_load_lock, std::try_to_lock);
+	if (!ul.owns_lock() || is_loading()) {
+		return in;
+	}
+
+	// Retrieve the result of the previous frame first, before anything can overwrite it.
+	bool have_result = pipeline_wait();
+
 	// Resize if the size or scale was changed.
 	resize(in->get_width(), in->get_height());
 
-	// Reload effect if dirty.
+	// Reload effect in the background if dirty, and pass the input through until it finished.
 	if (_dirty) {
-		load();
+		load_async([this]() { load(); });
+		_skipped = std::numeric_limits<uint32_t>::max();
+		return in;
 	}
 
-	{ // Copy parameter to input.
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy In -> Input"};
-#endif
-		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
+	if (have_result) {
+		convert_output();
 	}
 
 	{ // Enqueue into buffer (back is newest).
@@ -114,38 +133,56 @@ std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::
 		_buffer.pop_front();
 	}
 
-	{ // Copy input to source.
+	// Between inferences the latest mask is reused, while the color keeps moving.
+	if ((_skipped != std::numeric_limits<uint32_t>::max()) && ((_skipped + 1) < _interval)) {
+		_skipped++;
+		return _output->get_texture();
+	}
+	_skipped = 0;
+
+	{ // Copy parameter to input.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Input -> Source"};
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy In -> Input"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
-		}
+		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
 	}
 
 	{ // Process source to destination.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Process"};
 #endif
-		if (auto res = run(); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to process due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Run failed.");
+		// The conversions are part of the run, so that all of it can be captured into a single graph.
+		std::function<void()> after;
+		if (!is_pipelined()) {
+			after = [this]() { convert_output(); };
 		}
+		pipeline_run([this]() { convert_input(); }, after);
 	}
 
-	{ // Copy destination to output.
+	// Return output.
+	return _output->get_texture();
+}
+
+void streamfx::nvidia::vfx::greenscreen::convert_input()
+{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Destination -> Output"};
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Input -> Source"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 1., _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
-		}
+	if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("Transfer failed.");
 	}
+}
 
-	// Return output.
-	return _output->get_texture();
+void streamfx::nvidia::vfx::greenscreen::convert_output()
+{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Destination -> Output"};
+#endif
+	if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 1., _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("Transfer failed.");
+	}
 }
 
 std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::get_color()
@@ -171,15 +208,17 @@ void streamfx::nvidia::vfx::greenscreen::resize(uint32_t width, uint32_t height)
 		_tmp = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 	}
 
-	if (!_input || (in_size.first != _input->get_texture()->get_width()) || (in_size.second != _input->get_texture()->get_height())) {
-		{
-			_buffer.clear();
-			for (size_t idx = 0; idx < LATENCY_BUFFER; idx++) {
-				auto el = std::make_shared<::streamfx::obs::gs::texture>(width, height, GS_RGBA_UNORM, 1, nullptr, ::streamfx::obs::gs::texture::flags::None);
-				_buffer.push_back(el);
-			}
+	// While pipelined the mask is a frame older, so the color has to be delayed by one more frame to match.
+	size_t latency = LATENCY_BUFFER + (is_pipelined() ? 1 : 0);
+	if ((_buffer.size() != latency) || (in_size.first != _buffer.front()->get_width()) || (in_size.second != _buffer.front()->get_height())) {
+		_buffer.clear();
+		for (size_t idx = 0; idx < latency; idx++) {
+			auto el = std::make_shared<::streamfx::obs::gs::texture>(width, height, GS_RGBA_UNORM, 1, nullptr, ::streamfx::obs::gs::texture::flags::None);
+			_buffer.push_back(el);
 		}
+	}
 
+	if (!_input || (in_size.first != _input->get_texture()->get_width()) || (in_size.second != _input->get_texture()->get_height())) {
 		if (_input) {
 			_input->resize(in_size.first, in_size.second);
 		} else {
@@ -230,11 +269,10 @@ void streamfx::nvidia::vfx::greenscreen::resize(uint32_t width, uint32_t height)
 
 void streamfx::nvidia::vfx::greenscreen::load()
 {
-	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = _nvcuda->get_context()->enter();
 
 	// Assign CUDA Stream object.
-	if (auto v = set(PARAMETER_CUDA_STREAM, _nvcuda->get_stream()); v != cv::result::SUCCESS) {
+	if (auto v = set(PARAMETER_CUDA_STREAM, _stream); v != cv::result::SUCCESS) {
 		throw ::streamfx::nvidia::cv::exception(PARAMETER_CUDA_STREAM, v);
 	}
 
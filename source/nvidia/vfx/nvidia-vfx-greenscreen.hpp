@@ -27,6 +27,10 @@ namespace streamfx::nvidia::vfx {
 		std::shared_ptr<::streamfx::nvidia::cv::texture>         _output;
 		std::shared_ptr<::streamfx::nvidia::cv::image>           _tmp;
 
+		// Inference Rate
+		uint32_t _interval;
+		uint32_t _skipped;
+
 		public:
 		~greenscreen();
 		greenscreen();
@@ -35,15 +39,24 @@ namespace streamfx::nvidia::vfx {
 
 		void set_mode(greenscreen_mode mode);
 
+		/** Only run inference on every Nth frame, and reuse the latest mask in between. */
+		void set_interval(uint32_t interval);
+
 		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
 		std::shared_ptr<::streamfx::obs::gs::texture> get_color();
 
 		std::shared_ptr<::streamfx::obs::gs::texture> get_mask();
 
+		using effect::is_pipelined;
+		using effect::set_pipelined;
+
 		private:
 		void resize(uint32_t width, uint32_t height);
 
+		void convert_input();
+		void convert_output();
+
 		void load();
 	};
 } // namespace streamfx::nvidia::vfx
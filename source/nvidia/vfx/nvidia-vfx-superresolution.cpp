@@ -61,6 +61,8 @@ static size_t find_closest_scale_factor_index(float factor)
 
 streamfx::nvidia::vfx::superresolution::~superresolution()
 {
+	load_wait();
+
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
@@ -74,10 +76,9 @@ streamfx::nvidia::vfx::superresolution::~superresolution()
 	_tmp.reset();
 }
 
-streamfx::nvidia::vfx::superresolution::superresolution() : effect(EFFECT_SUPERRESOLUTION), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _strength(1.), _scale(1.5), _cache_input_size(), _cache_output_size(), _cache_scale()
+streamfx::nvidia::vfx::superresolution::superresolution() : effect(EFFECT_SUPERRESOLUTION), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _direct_input(true), _direct_output(true), _half_precision(false), _half_precision_supported(true), _strength(1.), _scale(1.5), _cache_input_size(), _cache_output_size(), _cache_scale()
 {
-	// Enter Graphics and CUDA context.
-	auto gctx = ::streamfx::obs::gs::context();
+	// Enter CUDA context, loading the model does not need the graphics context.
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	// Set the strength, scale and buffers.
@@ -91,6 +92,8 @@ streamfx::nvidia::vfx::superresolution::superresolution() : effect(EFFECT_SUPERR
 
 void streamfx::nvidia::vfx::superresolution::set_strength(float strength)
 {
+	std::unique_lock<std::mutex> ul(_load_lock);
+
 	strength = (strength >= .5f) ? 1.f : 0.f;
 	std::swap(_strength, strength);
 
@@ -100,7 +103,6 @@ void streamfx::nvidia::vfx::superresolution::set_strength(float strength)
 
 	// Update Effect
 	uint32_t value = (_strength >= .5f) ? 1u : 0u;
-	auto     gctx  = ::streamfx::obs::gs::context();
 	auto     cctx  = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_STRENGTH, value); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 		D_LOG_ERROR("Failed to set '%s' to %lu.", ::streamfx::nvidia::vfx::PARAMETER_STRENGTH, value);
@@ -114,6 +116,8 @@ float streamfx::nvidia::vfx::superresolution::strength()
 
 void streamfx::nvidia::vfx::superresolution::set_scale(float scale)
 {
+	std::unique_lock<std::mutex> ul(_load_lock);
+
 	// Limit to acceptable range.
 	scale = std::clamp<float>(scale, 1., 4.);
 
@@ -197,6 +201,34 @@ void streamfx::nvidia::vfx::superresolution::size(std::pair<uint32_t, uint32_t>
 	_cache_scale       = _scale;
 }
 
+void streamfx::nvidia::vfx::superresolution::set_half_precision(bool enabled)
+{
+	std::unique_lock<std::mutex> ul(_load_lock);
+
+	if (_half_precision == enabled) {
+		return;
+	}
+	_half_precision = enabled;
+
+	// The buffers handed to the effect have to be recreated with the other component type, once nothing uses them.
+	auto cctx = _nvcuda->get_context()->enter();
+	pipeline_wait();
+	graph_reset();
+	_source.reset();
+	_destination.reset();
+	_dirty = true;
+}
+
+bool streamfx::nvidia::vfx::superresolution::is_half_precision()
+{
+	return _half_precision && _half_precision_supported;
+}
+
+::streamfx::nvidia::cv::component_type streamfx::nvidia::vfx::superresolution::precision()
+{
+	return is_half_precision() ? ::streamfx::nvidia::cv::component_type::FP16 : ::streamfx::nvidia::cv::component_type::FP32;
+}
+
 std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolution::process(std::shared_ptr<::streamfx::obs::gs::texture> in)
 {
 	// Enter Graphics and CUDA context.
@@ -207,12 +239,26 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolu
 	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Super-Resolution"};
 #endif
 
+	// Pass the input through while the effect is being loaded.
+	std::unique_lock<std::mutex> ul(_load_lock, std::try_to_lock);
+	if (!ul.owns_lock() || is_loading()) {
+		return in;
+	}
+
+	// Retrieve the result of the previous frame first, before anything can overwrite it.
+	bool have_result = pipeline_wait();
+
 	// Resize if the size or scale was changed.
 	resize(in->get_width(), in->get_height());
 
-	// Reload effect if dirty.
+	// Reload effect in the background if dirty, and pass the input through until it finished.
 	if (_dirty) {
-		load();
+		load_async([this]() { load(); });
+		return in;
+	}
+
+	if (have_result) {
+		convert_output(in->get_width(), in->get_height());
 	}
 
 	{ // Copy parameter to input.
@@ -222,58 +268,78 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolu
 		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
 	}
 
-	{ // Convert Input to Source format
+	{ // Process source to destination.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Input -> Source"};
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Process"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
+		// The conversions are part of the run, so that all of it can be captured into a single graph.
+		uint32_t              width  = in->get_width();
+		uint32_t              height = in->get_height();
+		std::function<void()> after;
+		if (!is_pipelined()) {
+			after = [this, width, height]() { convert_output(width, height); };
 		}
+		pipeline_run([this, width, height]() { convert_input(width, height); }, after);
 	}
 
-	{ // Copy input to source.
+	// Without pipelining, the result is available right away.
+	if (!is_pipelined()) {
+		have_result = true;
+	}
+
+	// Return output, or the unprocessed input until the first result is available.
+	return have_result ? _output->get_texture() : in;
+}
+
+void streamfx::nvidia::vfx::superresolution::convert_input(uint32_t width, uint32_t height)
+{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Input -> Source"};
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Input -> Source"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+	// A single transfer handles type, layout and channel order at once, without a full frame in between.
+	if (_direct_input) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_WARNING("Direct transfer from input to processing source failed with error '%s', falling back to intermediate conversion.", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			_direct_input = false;
+			resize(width, height);
+		}
+	}
+
+	if (!_direct_input) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			throw std::runtime_error("Transfer failed.");
+		}
+		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
 	}
+}
 
-	{ // Process source to destination.
+void streamfx::nvidia::vfx::superresolution::convert_output(uint32_t width, uint32_t height)
+{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Process"};
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Destination -> Output"};
 #endif
-		if (auto res = run(); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to process due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Run failed.");
+	if (_direct_output) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_WARNING("Direct transfer from processing result to output failed with error '%s', falling back to intermediate conversion.", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			_direct_output = false;
+			resize(width, height);
 		}
 	}
 
-	{ // Convert Destination to Output format
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Destination -> Output"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+	if (!_direct_output) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
-	}
-
-	{ // Copy destination to output.
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Destination -> Output"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
 	}
-
-	// Return output.
-	return _output->get_texture();
 }
 
 void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t height)
@@ -294,21 +360,26 @@ void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t hei
 		} else {
 			_input = std::make_shared<::streamfx::nvidia::cv::texture>(_cache_input_size.first, _cache_input_size.second, GS_RGBA_UNORM);
 		}
+
+		graph_reset();
 	}
 
-	if (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != _cache_input_size.first) || (_convert_to_fp32->get_image()->height != _cache_input_size.second)) {
+	// Only needed if the direct transfer isn't supported.
+	if (!_direct_input && (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != _cache_input_size.first) || (_convert_to_fp32->get_image()->height != _cache_input_size.second))) {
 		if (_convert_to_fp32) {
 			_convert_to_fp32->resize(_cache_input_size.first, _cache_input_size.second);
 		} else {
 			_convert_to_fp32 = std::make_shared<::streamfx::nvidia::cv::image>(_cache_input_size.first, _cache_input_size.second, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::FP32, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
+
+		graph_reset();
 	}
 
 	if (!_source || (_source->get_image()->width != _cache_input_size.first) || (_source->get_image()->height != _cache_input_size.second)) {
 		if (_source) {
 			_source->resize(_cache_input_size.first, _cache_input_size.second);
 		} else {
-			_source = std::make_shared<::streamfx::nvidia::cv::image>(_cache_input_size.first, _cache_input_size.second, ::streamfx::nvidia::cv::pixel_format::BGR, ::streamfx::nvidia::cv::component_type::FP32, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+			_source = std::make_shared<::streamfx::nvidia::cv::image>(_cache_input_size.first, _cache_input_size.second, ::streamfx::nvidia::cv::pixel_format::BGR, precision(), ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
 
 		if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_INPUT_IMAGE_0, _source); res != ::streamfx::nvidia::cv::result::SUCCESS) {
@@ -323,7 +394,7 @@ void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t hei
 		if (_destination) {
 			_destination->resize(_cache_output_size.first, _cache_output_size.second);
 		} else {
-			_destination = std::make_shared<::streamfx::nvidia::cv::image>(_cache_output_size.first, _cache_output_size.second, ::streamfx::nvidia::cv::pixel_format::BGR, ::streamfx::nvidia::cv::component_type::FP32, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
+			_destination = std::make_shared<::streamfx::nvidia::cv::image>(_cache_output_size.first, _cache_output_size.second, ::streamfx::nvidia::cv::pixel_format::BGR, precision(), ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
 
 		if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_OUTPUT_IMAGE_0, _destination); res != ::streamfx::nvidia::cv::result::SUCCESS) {
@@ -334,12 +405,15 @@ void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t hei
 		_dirty = true;
 	}
 
-	if (!_convert_to_u8 || (_convert_to_u8->get_image()->width != _cache_output_size.first) || (_convert_to_u8->get_image()->height != _cache_output_size.second)) {
+	// Only needed if the direct transfer isn't supported.
+	if (!_direct_output && (!_convert_to_u8 || (_convert_to_u8->get_image()->width != _cache_output_size.first) || (_convert_to_u8->get_image()->height != _cache_output_size.second))) {
 		if (_convert_to_u8) {
 			_convert_to_u8->resize(_cache_output_size.first, _cache_output_size.second);
 		} else {
 			_convert_to_u8 = std::make_shared<::streamfx::nvidia::cv::image>(_cache_output_size.first, _cache_output_size.second, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::INTERLEAVED, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 		}
+
+		graph_reset();
 	}
 
 	if (!_output || (_output->get_image()->width != _cache_output_size.first) || (_output->get_image()->height != _cache_output_size.second)) {
@@ -348,15 +422,25 @@ void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t hei
 		} else {
 			_output = std::make_shared<::streamfx::nvidia::cv::texture>(_cache_output_size.first, _cache_output_size.second, GS_RGBA_UNORM);
 		}
+
+		graph_reset();
 	}
 }
 
 void streamfx::nvidia::vfx::superresolution::load()
 {
-	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	if (auto res = effect::load(); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		if (is_half_precision()) {
+			// Older models only accept full precision, so try again with that on the next frame.
+			D_LOG_WARNING("Failed to initialize effect in half precision due to error '%s', falling back to full precision.", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			_half_precision_supported = false;
+			_source.reset();
+			_destination.reset();
+			return;
+		}
+
 		D_LOG_ERROR("Failed to initialize effect due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 		throw std::runtime_error("Load failed.");
 	}
@@ -22,6 +22,10 @@ namespace streamfx::nvidia::vfx {
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _convert_to_u8;
 		std::shared_ptr<::streamfx::nvidia::cv::texture> _output;
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _tmp;
+		bool                                             _direct_input;
+		bool                                             _direct_output;
+		bool                                             _half_precision;
+		bool                                             _half_precision_supported;
 
 		float _strength;
 		float _scale;
@@ -42,11 +46,26 @@ namespace streamfx::nvidia::vfx {
 
 		void size(std::pair<uint32_t, uint32_t> const& size, std::pair<uint32_t, uint32_t>& input_size, std::pair<uint32_t, uint32_t>& output_size);
 
+		/** Process in half instead of full precision, which halves the size and bandwidth of the buffers.
+		 *
+		 * Falls back to full precision if the installed models don't support it.
+		 */
+		void set_half_precision(bool enabled);
+		bool is_half_precision();
+
 		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
+		using effect::is_pipelined;
+		using effect::set_pipelined;
+
 		private:
 		void resize(uint32_t width, uint32_t height);
 
+		void convert_input(uint32_t width, uint32_t height);
+		void convert_output(uint32_t width, uint32_t height);
+
+		::streamfx::nvidia::cv::component_type precision();
+
 		void load();
 	};
 } // namespace streamfx::nvidia::vfx
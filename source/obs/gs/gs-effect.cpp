@@ -5,28 +5,95 @@
 
 #include "gs-effect.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
 #include "util/util-platform.hpp"
 
 #include "warning-disable.hpp"
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
 #include "warning-enable.hpp"
 
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gs::effect> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
 #define MAX_EFFECT_SIZE 32 * 1024 * 1024 // 32 MiB, big enough for everything.
 
-static std::string load_file_as_code(const std::filesystem::path& shader_file, bool is_top_level = true)
+#define MAX_INCLUDE_DEPTH 32 // Anything deeper is almost certainly a file including itself.
+
+/** A file with all of its includes resolved, and what it was built from.
+ *
+ * Shared by every effect, so headers included by many effects are only read and expanded once. An entry stays valid
+ * for as long as none of the files it was built from changed in size or modification time, which is a lot cheaper to
+ * check than reading them again.
+ */
+struct preprocessed_file {
+	struct stamp {
+		std::filesystem::path           path;
+		std::filesystem::file_time_type mt;
+		uintmax_t                       size;
+	};
+
+	std::string        code;
+	std::vector<stamp> files; // The file itself, followed by everything it includes.
+};
+
+static std::mutex                                                          preprocessed_lock;
+static std::map<std::filesystem::path, std::shared_ptr<preprocessed_file>> preprocessed_files;
+
+static bool is_up_to_date(preprocessed_file const& entry)
+{
+	for (auto const& file : entry.files) {
+		std::error_code ec;
+		if ((std::filesystem::last_write_time(file.path, ec) != file.mt) || ec) {
+			return false;
+		}
+		if ((std::filesystem::file_size(file.path, ec) != file.size) || ec) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static std::shared_ptr<preprocessed_file> load_file_as_code(const std::filesystem::path& shader_file, size_t depth)
 {
-	std::stringstream           shader_stream;
+	if (depth > MAX_INCLUDE_DEPTH) {
+		throw std::runtime_error("Includes are nested too deeply.");
+	}
+
 	const std::filesystem::path shader_path = std::filesystem::absolute(shader_file.native());
 	const std::filesystem::path shader_root = std::filesystem::path(shader_path.native()).remove_filename();
 
+	{ // Someone else may already have read it, and nothing changed since.
+		std::lock_guard<std::mutex> lock(preprocessed_lock);
+		if (auto kv = preprocessed_files.find(shader_path); (kv != preprocessed_files.end()) && is_up_to_date(*kv->second)) {
+			return kv->second;
+		}
+	}
+
+	auto entry = std::make_shared<preprocessed_file>();
+
 	// Ensure it meets size limits.
 	uintmax_t size = std::filesystem::file_size(shader_path);
 	if (size > MAX_EFFECT_SIZE) {
 		throw std::runtime_error("File is too large to be loaded.");
 	}
+	entry->files.push_back({shader_path, std::filesystem::last_write_time(shader_path), size});
 
 	// Try to open as-is.
 	std::ifstream ifs(shader_path, std::ios::in);
@@ -34,22 +101,9 @@ static std::string load_file_as_code(const std::filesystem::path& shader_file, b
 		throw std::runtime_error("Failed to open file.");
 	}
 
-	// Push Graphics API to shader.
-	if (is_top_level) {
-		auto gctx = streamfx::obs::gs::context();
-		switch (gs_get_device_type()) {
-		case GS_DEVICE_DIRECT3D_11:
-			shader_stream << "#define GS_DEVICE_DIRECT3D_11" << std::endl;
-			shader_stream << "#define GS_DEVICE_DIRECT3D" << std::endl;
-			break;
-		case GS_DEVICE_OPENGL:
-			shader_stream << "#define GS_DEVICE_OPENGL" << std::endl;
-			break;
-		}
-	}
-
 	// Pre-process the shader.
-	std::string line;
+	std::stringstream shader_stream;
+	std::string       line;
 	while (std::getline(ifs, line)) {
 		std::string line_trimmed = line;
 
@@ -76,12 +130,40 @@ static std::string load_file_as_code(const std::filesystem::path& shader_file, b
 				include_path = shader_root / include_str;
 			}
 
-			line = load_file_as_code(include_path, false);
+			auto include = load_file_as_code(include_path, depth + 1);
+			entry->files.insert(entry->files.end(), include->files.begin(), include->files.end());
+			line = include->code;
 		}
 
 		shader_stream << line << std::endl;
 	}
+	entry->code = shader_stream.str();
+
+	{
+		std::lock_guard<std::mutex> lock(preprocessed_lock);
+		preprocessed_files[shader_path] = entry;
+	}
+	return entry;
+}
+
+static std::string load_file_as_code(const std::filesystem::path& shader_file)
+{
+	std::stringstream shader_stream;
 
+	{ // Push Graphics API to shader.
+		auto gctx = streamfx::obs::gs::context();
+		switch (gs_get_device_type()) {
+		case GS_DEVICE_DIRECT3D_11:
+			shader_stream << "#define GS_DEVICE_DIRECT3D_11" << std::endl;
+			shader_stream << "#define GS_DEVICE_DIRECT3D" << std::endl;
+			break;
+		case GS_DEVICE_OPENGL:
+			shader_stream << "#define GS_DEVICE_OPENGL" << std::endl;
+			break;
+		}
+	}
+
+	shader_stream << load_file_as_code(shader_file, 0)->code;
 	return shader_stream.str();
 }
 
@@ -97,10 +179,40 @@ streamfx::obs::gs::effect::effect(std::string_view code, std::string_view name)
 	}
 
 	reset(effect, [](gs_effect_t* ptr) { gs_effect_destroy(ptr); });
+
+	// Filters look up the same handful of names every frame, so resolve them once instead of comparing strings.
+	_index        = std::make_shared<index>();
+	_index->owner = effect;
+	_index->techniques.reserve(effect->techniques.num);
+	for (std::size_t idx = 0; idx < effect->techniques.num; idx++) {
+		_index->techniques.emplace(effect->techniques.array[idx].name, idx);
+	}
+	_index->parameters.reserve(effect->params.num);
+	for (std::size_t idx = 0; idx < effect->params.num; idx++) {
+		_index->parameters.emplace(effect->params.array[idx].name, idx);
+	}
 }
 
 streamfx::obs::gs::effect::effect(std::filesystem::path file) : effect(load_file_as_code(file), streamfx::util::platform::utf8_to_native(std::filesystem::absolute(file)).generic_u8string()) {}
 
+std::string streamfx::obs::gs::effect::preprocess(const std::filesystem::path& file)
+{
+	return load_file_as_code(file);
+}
+
+std::string streamfx::obs::gs::effect::preprocess(const std::filesystem::path& file, uint64_t& hash)
+{
+	std::string code = load_file_as_code(file);
+
+	// FNV-1a, which is plenty to tell whether two versions of the same file differ.
+	hash = 0xCBF29CE484222325ull;
+	for (char ch : code) {
+		hash = (hash ^ static_cast<uint8_t>(ch)) * 0x100000001B3ull;
+	}
+
+	return code;
+}
+
 streamfx::obs::gs::effect::~effect()
 {
 	auto gctx = streamfx::obs::gs::context();
@@ -123,6 +235,13 @@ streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(std
 
 streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(std::string_view name)
 {
+	if (_index && (_index->owner == get())) {
+		if (auto kv = _index->techniques.find(name); kv != _index->techniques.end()) {
+			return streamfx::obs::gs::effect_technique(get()->techniques.array + kv->second, *this);
+		}
+		return nullptr;
+	}
+
 	for (std::size_t idx = 0; idx < count_techniques(); idx++) {
 		auto ptr = get()->techniques.array + idx;
 		if (strcmp(ptr->name, name.data()) == 0) {
@@ -156,6 +275,13 @@ streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(std
 
 streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(std::string_view name)
 {
+	if (_index && (_index->owner == get())) {
+		if (auto kv = _index->parameters.find(name); kv != _index->parameters.end()) {
+			return streamfx::obs::gs::effect_parameter(get()->params.array + kv->second, *this);
+		}
+		return nullptr;
+	}
+
 	for (std::size_t idx = 0; idx < count_parameters(); idx++) {
 		auto ptr = get()->params.array + idx;
 		if (strcmp(ptr->name, name.data()) == 0) {
@@ -180,3 +306,97 @@ bool streamfx::obs::gs::effect::has_parameter(std::string_view name, effect_para
 		return eprm.get_type() == type;
 	return false;
 }
+
+streamfx::obs::gs::effect_registry::effect_registry() : _lock(), _effects(), _task() {}
+
+streamfx::obs::gs::effect_registry::~effect_registry()
+{
+	if (_task) {
+		streamfx::threadpool()->pop(_task);
+		_task->await_completion();
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+	_effects.clear();
+}
+
+streamfx::obs::gs::effect streamfx::obs::gs::effect_registry::get(const std::filesystem::path& file)
+{
+	// Always enter the graphics context before taking the lock, otherwise the graphics thread and a compile could end
+	// up waiting on each other.
+	auto gctx = streamfx::obs::gs::context();
+
+	std::string                  key = name(file);
+	std::unique_lock<std::mutex> lock(_lock);
+	if (auto kv = _effects.find(key); kv != _effects.end()) {
+		return kv->second;
+	}
+
+	auto effect = streamfx::obs::gs::effect(file);
+	_effects.emplace(key, effect);
+	return effect;
+}
+
+void streamfx::obs::gs::effect_registry::precompile(std::list<std::filesystem::path> files)
+{
+	auto task = streamfx::threadpool()->push(
+		[this, files](streamfx::util::threadpool::task_data_t) {
+			for (auto const& file : files) {
+				std::string key = name(file);
+				try {
+					// Reading the file and its includes does not need the graphics context, so do it up front.
+					std::string code = streamfx::obs::gs::effect::preprocess(file);
+
+					auto                         gctx = streamfx::obs::gs::context();
+					std::unique_lock<std::mutex> lock(_lock);
+					if (_effects.find(key) == _effects.end()) {
+						_effects.emplace(key, streamfx::obs::gs::effect(code, key));
+					}
+				} catch (const std::exception& ex) {
+					D_LOG_WARNING("Failed to precompile '%s': %s", key.c_str(), ex.what());
+				}
+			}
+		},
+		nullptr, streamfx::util::threadpool::priority::BACKGROUND);
+
+	std::unique_lock<std::mutex> lock(_lock);
+	_task = task;
+}
+
+std::string streamfx::obs::gs::effect_registry::name(const std::filesystem::path& file)
+{
+	// Same name the effect gets when it is compiled from the file directly.
+	return streamfx::util::platform::utf8_to_native(std::filesystem::absolute(file)).generic_u8string();
+}
+
+std::shared_ptr<streamfx::obs::gs::effect_registry> streamfx::obs::gs::effect_registry::instance()
+{
+	static std::weak_ptr<streamfx::obs::gs::effect_registry> winst;
+	static std::mutex                                        mtx;
+
+	std::unique_lock<std::mutex> lock(mtx);
+	auto                         instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::obs::gs::effect_registry>(new streamfx::obs::gs::effect_registry());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::obs::gs::effect_registry> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance = streamfx::obs::gs::effect_registry::instance();
+
+		// Effects that most filters end up using.
+		std::list<std::filesystem::path> files;
+		for (auto file : {"effects/standard.effect", "effects/mask.effect", "effects/blur/box.effect", "effects/blur/box-linear.effect", "effects/blur/dual-filtering.effect", "effects/blur/gaussian.effect", "effects/blur/gaussian-linear.effect", "effects/blur/kawase.effect", "effects/sdf/sdf-producer.effect", "effects/sdf/sdf-consumer.effect"}) {
+			files.push_back(streamfx::data_file_path(file));
+		}
+		loader_instance->precompile(files);
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
@@ -11,10 +11,27 @@
 #include "warning-disable.hpp"
 #include <filesystem>
 #include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include "warning-enable.hpp"
 
 namespace streamfx::obs::gs {
 	class effect : public std::shared_ptr<gs_effect_t> {
+		/** Index of techniques and parameters by name, built once when the effect is compiled.
+		 *
+		 * The names point into the effect itself, so the index is only valid while 'owner' is what we hold.
+		 */
+		struct index {
+			gs_effect_t*                                      owner;
+			std::unordered_map<std::string_view, std::size_t> techniques;
+			std::unordered_map<std::string_view, std::size_t> parameters;
+		};
+		std::shared_ptr<index> _index;
+
 		public:
 		effect() = default;
 		effect(std::string_view code, std::string_view name);
@@ -52,5 +69,47 @@ namespace streamfx::obs::gs {
 		{
 			return streamfx::obs::gs::effect(file);
 		};
+
+		/** Read an effect file with all of its includes resolved, exactly as it would be compiled.
+		 *
+		 * Does not need the graphics context for anything but a quick look at the device type, so it can be used to
+		 * prepare an effect off the graphics thread. Included files are shared between all effects, and only read
+		 * again once they change on disk.
+		 */
+		static std::string preprocess(const std::filesystem::path& file);
+
+		/** Same as above, but also hashes the result, so that unchanged code does not have to be compiled again. */
+		static std::string preprocess(const std::filesystem::path& file, uint64_t& hash);
+	};
+
+	/** Compiles each effect file once, and hands out the same effect to everyone asking for it.
+	 *
+	 * Everyone shares the parameters of the effect, so they have to be set right before drawing with it, just like with
+	 * the effects that come with OBS.
+	 */
+	class effect_registry {
+		std::mutex                                        _lock;
+		std::map<std::string, streamfx::obs::gs::effect>  _effects;
+		std::shared_ptr<streamfx::util::threadpool::task> _task;
+
+		public:
+		~effect_registry();
+
+		/** Retrieve the effect compiled from a file, compiling it now if nobody asked for it before.
+		 *
+		 * Throws the same errors as compiling the file directly does.
+		 */
+		streamfx::obs::gs::effect get(const std::filesystem::path& file);
+
+		/** Compile files on the threadpool, so that they are ready once someone asks for them. */
+		void precompile(std::list<std::filesystem::path> files);
+
+		private:
+		effect_registry();
+
+		static std::string name(const std::filesystem::path& file);
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::obs::gs::effect_registry> instance();
 	};
 } // namespace streamfx::obs::gs
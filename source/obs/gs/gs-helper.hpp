@@ -10,6 +10,10 @@
 #include <vector>
 #include "warning-enable.hpp"
 
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+#include "util/util-trace.hpp"
+#endif
+
 namespace streamfx::obs::gs {
 	class context {
 		public:
@@ -52,7 +56,8 @@ namespace streamfx::obs::gs {
 	static const float_t* debug_color_render       = debug_color_teal;
 
 	class debug_marker {
-		std::string _name;
+		std::string                                    _name;
+		std::chrono::high_resolution_clock::time_point _begin;
 
 		public:
 		inline debug_marker(const float_t color[4], const char* format, ...)
@@ -65,13 +70,16 @@ namespace streamfx::obs::gs {
 			size = static_cast<size_t>(vsnprintf(buffer.data(), buffer.size(), format, vargs));
 			va_end(vargs);
 
-			_name = std::string(buffer.data(), buffer.data() + size);
+			_name  = std::string(buffer.data(), buffer.data() + size);
+			_begin = std::chrono::high_resolution_clock::now();
 			gs_debug_marker_begin(color, _name.c_str());
 		}
 
 		inline ~debug_marker()
 		{
 			gs_debug_marker_end();
+			static auto recorder = streamfx::util::trace::recorder::instance();
+			recorder->record(_name, "graphics", _begin, std::chrono::high_resolution_clock::now());
 		}
 	};
 #endif
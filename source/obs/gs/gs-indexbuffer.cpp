@@ -7,26 +7,32 @@
 #include "obs/gs/gs-helper.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
-streamfx::obs::gs::index_buffer::index_buffer(uint32_t maximumVertices)
+streamfx::obs::gs::index_buffer::index_buffer(uint32_t maximumVertices) : _capacity(maximumVertices)
 {
 	this->reserve(maximumVertices);
+
+	// The index buffer takes ownership of the memory it is created with, so it must come from the OBS allocator.
 	auto gctx     = streamfx::obs::gs::context();
-	_index_buffer = gs_indexbuffer_create(gs_index_type::GS_UNSIGNED_LONG, this->data(), maximumVertices, GS_DYNAMIC);
+	_index_buffer = gs_indexbuffer_create(gs_index_type::GS_UNSIGNED_LONG, bzalloc(sizeof(uint32_t) * _capacity), _capacity, GS_DYNAMIC);
+	if (!_index_buffer) {
+		throw std::runtime_error("Failed to create index buffer.");
+	}
 }
 
 streamfx::obs::gs::index_buffer::index_buffer() : index_buffer(MAXIMUM_VERTICES) {}
 
 streamfx::obs::gs::index_buffer::index_buffer(index_buffer& other) : index_buffer(static_cast<uint32_t>(other.size()))
 {
-	std::copy(other.begin(), other.end(), this->end());
+	this->assign(other.begin(), other.end());
 }
 
 streamfx::obs::gs::index_buffer::index_buffer(std::vector<uint32_t>& other) : index_buffer(static_cast<uint32_t>(other.size()))
 {
-	std::copy(other.begin(), other.end(), this->end());
+	this->assign(other.begin(), other.end());
 }
 
 streamfx::obs::gs::index_buffer::~index_buffer()
@@ -44,6 +50,7 @@ gs_indexbuffer_t* streamfx::obs::gs::index_buffer::get(bool refreshGPU)
 {
 	if (refreshGPU) {
 		auto gctx = streamfx::obs::gs::context();
+		std::copy_n(this->data(), std::min<size_t>(this->size(), _capacity), static_cast<uint32_t*>(gs_indexbuffer_get_data(_index_buffer)));
 		gs_indexbuffer_flush(_index_buffer);
 	}
 	return _index_buffer;
@@ -10,6 +10,10 @@
 #include "warning-enable.hpp"
 
 namespace streamfx::obs::gs {
+	/** 32-bit indices, edited through the std::vector interface and uploaded by get().
+	 *
+	 * The GPU buffer holds at most as many indices as it was created with, anything beyond that is not uploaded.
+	 */
 	class index_buffer : public std::vector<uint32_t> {
 		public:
 		index_buffer(uint32_t maximumVertices);
@@ -23,6 +27,7 @@ namespace streamfx::obs::gs {
 		gs_indexbuffer_t* get(bool refreshGPU);
 
 		protected:
+		uint32_t          _capacity;
 		gs_indexbuffer_t* _index_buffer;
 	};
 } // namespace streamfx::obs::gs
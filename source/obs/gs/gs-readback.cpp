@@ -0,0 +1,110 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-readback.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+streamfx::obs::gs::readback::~readback()
+{
+	auto gctx = streamfx::obs::gs::context();
+	for (auto& slot : _slots) {
+		if (slot.surface) {
+			gs_stagesurface_destroy(slot.surface);
+		}
+	}
+}
+
+streamfx::obs::gs::readback::readback(size_t depth) : _slots(), _head(0), _pending(0)
+{
+	if (depth < 2) {
+		throw std::invalid_argument("depth");
+	}
+	_slots.resize(depth, slot{nullptr, 0, 0, GS_UNKNOWN});
+}
+
+void streamfx::obs::gs::readback::stage(gs_texture_t* texture)
+{
+	if (!texture) {
+		throw std::invalid_argument("texture");
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+
+	// Nobody read in time, so give up on the oldest copy instead of the newest.
+	if (_pending == _slots.size()) {
+		_pending--;
+	}
+
+	auto&           slot   = _slots[_head];
+	uint32_t        width  = gs_texture_get_width(texture);
+	uint32_t        height = gs_texture_get_height(texture);
+	gs_color_format format = gs_texture_get_color_format(texture);
+	if (!slot.surface || (slot.width != width) || (slot.height != height) || (slot.format != format)) {
+		if (slot.surface) {
+			gs_stagesurface_destroy(slot.surface);
+		}
+		slot.surface = gs_stagesurface_create(width, height, format);
+		if (!slot.surface) {
+			slot = {nullptr, 0, 0, GS_UNKNOWN};
+			throw std::runtime_error("Failed to create staging surface.");
+		}
+		slot.width  = width;
+		slot.height = height;
+		slot.format = format;
+	}
+
+	gs_stage_texture(slot.surface, texture);
+	_head = (_head + 1) % _slots.size();
+	_pending++;
+}
+
+void streamfx::obs::gs::readback::stage(std::shared_ptr<streamfx::obs::gs::texture> texture)
+{
+	if (!texture) {
+		throw std::invalid_argument("texture");
+	}
+	stage(texture->get_object());
+}
+
+bool streamfx::obs::gs::readback::read(std::function<void(view const&)> const& callback, bool force)
+{
+	// The newest copies are still in flight, so only ever look at the oldest one.
+	if ((_pending == 0) || (!force && (_pending < (_slots.size() - 1)))) {
+		return false;
+	}
+
+	auto  gctx = streamfx::obs::gs::context();
+	auto& slot = _slots[(_head + _slots.size() - _pending) % _slots.size()];
+	_pending--;
+
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+	if (!gs_stagesurface_map(slot.surface, &data, &linesize)) {
+		return false;
+	}
+
+	try {
+		callback(view{data, linesize, slot.width, slot.height, slot.format});
+	} catch (...) {
+		gs_stagesurface_unmap(slot.surface);
+		throw;
+	}
+	gs_stagesurface_unmap(slot.surface);
+
+	return true;
+}
+
+void streamfx::obs::gs::readback::clear()
+{
+	_pending = 0;
+}
+
+size_t streamfx::obs::gs::readback::pending()
+{
+	return _pending;
+}
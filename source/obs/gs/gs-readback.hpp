@@ -0,0 +1,72 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::gs {
+	/** Ring of staging surfaces for reading textures back to the CPU without waiting on the GPU.
+	 *
+	 * Each stage() queues a copy into the next surface, and read() only maps a surface once enough newer copies were
+	 * queued behind it that the GPU has most likely finished with it. With the default depth of three, results arrive
+	 * two frames late. If nobody reads, the oldest copy is dropped to make room for the newest.
+	 */
+	class readback {
+		public:
+		struct view {
+			const uint8_t*  data;
+			uint32_t        linesize;
+			uint32_t        width;
+			uint32_t        height;
+			gs_color_format format;
+		};
+
+		private:
+		struct slot {
+			gs_stagesurf_t* surface;
+			uint32_t        width;
+			uint32_t        height;
+			gs_color_format format;
+		};
+
+		std::vector<slot> _slots;
+		size_t            _head;    // Next slot to stage into.
+		size_t            _pending; // Staged slots waiting to be read, ending just before _head.
+
+		public:
+		~readback();
+
+		/** @param depth Number of surfaces, and one more than the number of frames a result is delayed by. */
+		readback(size_t depth = 3);
+
+		readback(readback const&)            = delete;
+		readback& operator=(readback const&) = delete;
+
+		/** Queue a copy of the texture, recreating the surface if the size or format changed. */
+		void stage(gs_texture_t* texture);
+
+		void stage(std::shared_ptr<streamfx::obs::gs::texture> texture);
+
+		/** Map the oldest copy if it is old enough, and hand it to the callback.
+		 *
+		 * The view is only valid during the callback.
+		 *
+		 * @param force Map the oldest copy regardless of its age, which may wait on the GPU.
+		 * @return true if the callback was called.
+		 */
+		bool read(std::function<void(view const&)> const& callback, bool force = false);
+
+		/** Forget every queued copy, for example after a seek, so no stale result is read. */
+		void clear();
+
+		size_t pending();
+	};
+} // namespace streamfx::obs::gs
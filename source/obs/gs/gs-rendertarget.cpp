@@ -10,13 +10,16 @@
 #include <stdexcept>
 #include "warning-enable.hpp"
 
+// Render targets nobody borrowed for this long are destroyed.
+static constexpr std::chrono::seconds pool_timeout{5};
+
 streamfx::obs::gs::rendertarget::~rendertarget()
 {
 	auto gctx = streamfx::obs::gs::context();
 	gs_texrender_destroy(_render_target);
 }
 
-streamfx::obs::gs::rendertarget::rendertarget(gs_color_format colorFormat, gs_zstencil_format zsFormat) : _color_format(colorFormat), _zstencil_format(zsFormat)
+streamfx::obs::gs::rendertarget::rendertarget(gs_color_format colorFormat, gs_zstencil_format zsFormat) : _color_format(colorFormat), _zstencil_format(zsFormat), _width(0), _height(0)
 {
 	_is_being_rendered = false;
 	auto gctx          = streamfx::obs::gs::context();
@@ -73,6 +76,43 @@ gs_zstencil_format streamfx::obs::gs::rendertarget::get_zstencil_format()
 	return _zstencil_format;
 }
 
+void streamfx::obs::gs::rendertarget::resized(uint32_t width, uint32_t height)
+{
+	if ((_width == width) && (_height == height)) {
+		return;
+	}
+	_width  = width;
+	_height = height;
+
+	// The render target only reallocates its storage when the size changes.
+	account(::streamfx::util::memory::owner::current());
+}
+
+void streamfx::obs::gs::rendertarget::account(std::shared_ptr<::streamfx::util::memory::owner> owner)
+{
+	uint64_t texel = gs_get_format_bpp(_color_format) / 8;
+	switch (_zstencil_format) {
+	case GS_Z16:
+		texel += 2;
+		break;
+	case GS_Z24_S8:
+	case GS_Z32F:
+		texel += 4;
+		break;
+	case GS_Z32F_S8X24:
+		texel += 8;
+		break;
+	default:
+		break;
+	}
+	_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::RenderTarget, static_cast<uint64_t>(_width) * _height * texel, owner);
+}
+
+std::pair<uint32_t, uint32_t> streamfx::obs::gs::rendertarget::get_size()
+{
+	return {_width, _height};
+}
+
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget* rt, uint32_t width, uint32_t height) : parent(rt)
 {
 	if (parent == nullptr)
@@ -86,6 +126,7 @@ streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertar
 		throw std::runtime_error("Failed to begin rendering to render target.");
 	}
 	parent->_is_being_rendered = true;
+	parent->resized(width, height);
 }
 
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget* rt, uint32_t width, uint32_t height, gs_color_space cs) : parent(rt)
@@ -101,6 +142,7 @@ streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertar
 		throw std::runtime_error("Failed to begin rendering to render target.");
 	}
 	parent->_is_being_rendered = true;
+	parent->resized(width, height);
 }
 
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget_op&& r) noexcept
@@ -118,3 +160,90 @@ streamfx::obs::gs::rendertarget_op::~rendertarget_op()
 	gs_texrender_end(parent->_render_target);
 	parent->_is_being_rendered = false;
 }
+
+streamfx::obs::gs::rendertarget_pool::~rendertarget_pool()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_free.clear();
+}
+
+streamfx::obs::gs::rendertarget_pool::rendertarget_pool() : _lock(), _free() {}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::obs::gs::rendertarget_pool::acquire(gs_color_format color_format, gs_zstencil_format zs_format, uint32_t width, uint32_t height)
+{
+	std::unique_ptr<streamfx::obs::gs::rendertarget> rt;
+	list_t                                           expired;
+	{
+		std::unique_lock<std::mutex> ul(_lock);
+		expired = trim(std::chrono::steady_clock::now());
+
+		// Any free one works, but one of the same size does not have to reallocate its texture.
+		if (auto kv = _free.find({color_format, zs_format}); (kv != _free.end()) && !kv->second.empty()) {
+			auto match = kv->second.begin();
+			for (auto itr = kv->second.begin(); itr != kv->second.end(); itr++) {
+				if (itr->first->get_size() == std::pair<uint32_t, uint32_t>{width, height}) {
+					match = itr;
+					break;
+				}
+			}
+			rt = std::move(match->first);
+			kv->second.erase(match);
+		}
+	}
+
+	if (!rt) {
+		rt = std::make_unique<streamfx::obs::gs::rendertarget>(color_format, zs_format);
+	} else {
+		rt->account(::streamfx::util::memory::owner::current());
+	}
+
+	// Hand it back to the pool instead of destroying it, unless the pool is already gone.
+	std::weak_ptr<streamfx::obs::gs::rendertarget_pool> wpool = instance();
+	return std::shared_ptr<streamfx::obs::gs::rendertarget>(rt.release(), [wpool](streamfx::obs::gs::rendertarget* ptr) {
+		std::unique_ptr<streamfx::obs::gs::rendertarget> owned{ptr};
+		if (auto pool = wpool.lock(); pool) {
+			pool->release(std::move(owned));
+		}
+	});
+}
+
+void streamfx::obs::gs::rendertarget_pool::release(std::unique_ptr<streamfx::obs::gs::rendertarget> rt)
+{
+	// Idle render targets belong to nobody in particular.
+	rt->account(::streamfx::util::memory::owner::shared());
+
+	list_t expired;
+	{
+		std::unique_lock<std::mutex> ul(_lock);
+		auto                         now = std::chrono::steady_clock::now();
+		_free[{rt->get_color_format(), rt->get_zstencil_format()}].emplace_front(std::move(rt), now);
+		expired = trim(now);
+	}
+	// Destroyed here, as that needs the graphics context, which must never be entered while holding the lock.
+}
+
+streamfx::obs::gs::rendertarget_pool::list_t streamfx::obs::gs::rendertarget_pool::trim(std::chrono::steady_clock::time_point now)
+{
+	// Most recently released ones are at the front, so stale ones collect at the back.
+	list_t expired;
+	for (auto& kv : _free) {
+		while (!kv.second.empty() && ((now - kv.second.back().second) > pool_timeout)) {
+			expired.splice(expired.end(), kv.second, std::prev(kv.second.end()));
+		}
+	}
+	return expired;
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget_pool> streamfx::obs::gs::rendertarget_pool::instance()
+{
+	static std::weak_ptr<streamfx::obs::gs::rendertarget_pool> winst;
+	static std::mutex                                          mtx;
+
+	std::unique_lock<std::mutex> lock(mtx);
+	auto                         instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::obs::gs::rendertarget_pool>(new streamfx::obs::gs::rendertarget_pool());
+		winst    = instance;
+	}
+	return instance;
+}
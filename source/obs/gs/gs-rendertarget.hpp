@@ -7,11 +7,21 @@
 #include "common.hpp"
 #include "gs-texture.hpp"
 
+#include "warning-disable.hpp"
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "warning-enable.hpp"
+
 namespace streamfx::obs::gs {
 	class rendertarget_op;
 
 	class rendertarget {
 		friend class rendertarget_op;
+		friend class rendertarget_pool;
 
 		protected:
 		gs_texrender_t* _render_target;
@@ -20,6 +30,11 @@ namespace streamfx::obs::gs {
 		gs_color_format    _color_format;
 		gs_zstencil_format _zstencil_format;
 
+		uint32_t _width;
+		uint32_t _height;
+
+		::streamfx::util::memory::allocation _memory;
+
 		public:
 		~rendertarget();
 
@@ -39,9 +54,17 @@ namespace streamfx::obs::gs {
 
 		gs_zstencil_format get_zstencil_format();
 
+		/** Size of the last render, or zero if it was never rendered to. */
+		std::pair<uint32_t, uint32_t> get_size();
+
 		streamfx::obs::gs::rendertarget_op render(uint32_t width, uint32_t height);
 
 		streamfx::obs::gs::rendertarget_op render(uint32_t width, uint32_t height, gs_color_space cs);
+
+		private:
+		void resized(uint32_t width, uint32_t height);
+
+		void account(std::shared_ptr<::streamfx::util::memory::owner> owner);
 	};
 
 	class rendertarget_op {
@@ -62,4 +85,37 @@ namespace streamfx::obs::gs {
 
 		rendertarget_op& operator=(const streamfx::obs::gs::rendertarget_op& r) = delete;
 	};
+
+	/** Render targets shared by everyone who only needs them for a frame.
+	 *
+	 * Borrowed render targets go back to the pool once the last reference is gone, and are handed out again to the next
+	 * one asking for the same formats. Ones that have not been borrowed for a while are destroyed, so memory follows what
+	 * is actually being rendered rather than how many filters exist.
+	 */
+	class rendertarget_pool {
+		typedef std::pair<gs_color_format, gs_zstencil_format>                                                                key_t;
+		typedef std::list<std::pair<std::unique_ptr<streamfx::obs::gs::rendertarget>, std::chrono::steady_clock::time_point>> list_t;
+
+		std::mutex              _lock;
+		std::map<key_t, list_t> _free;
+
+		public:
+		~rendertarget_pool();
+
+		/** Borrow a render target, preferring one that was last rendered at the given size.
+		 *
+		 * Keep the returned reference for as long as its content is needed, usually until the next video_tick.
+		 */
+		std::shared_ptr<streamfx::obs::gs::rendertarget> acquire(gs_color_format color_format, gs_zstencil_format zs_format, uint32_t width = 0, uint32_t height = 0);
+
+		private:
+		rendertarget_pool();
+
+		void release(std::unique_ptr<streamfx::obs::gs::rendertarget> rt);
+
+		list_t trim(std::chrono::steady_clock::time_point now);
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::obs::gs::rendertarget_pool> instance();
+	};
 } // namespace streamfx::obs::gs
@@ -3,11 +3,76 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "gs-sampler.hpp"
+#include "obs/gs/gs-helper.hpp"
 
 #include "warning-disable.hpp"
+#include <map>
+#include <mutex>
 #include <stdexcept>
+#include <tuple>
 #include "warning-enable.hpp"
 
+namespace {
+	typedef std::tuple<gs_sample_filter, gs_address_mode, gs_address_mode, gs_address_mode, int, uint32_t> key_t;
+
+	struct registry {
+		std::mutex                                       lock;
+		std::map<key_t, std::weak_ptr<gs_sampler_state>> states;
+	};
+
+	registry& get_registry()
+	{
+		static registry instance;
+		return instance;
+	}
+
+	key_t make_key(gs_sampler_info const& info)
+	{
+		// Only anisotropic filtering reads the anisotropy, and only the border address mode reads the border color.
+		bool has_border = (info.address_u == GS_ADDRESS_BORDER) || (info.address_v == GS_ADDRESS_BORDER) || (info.address_w == GS_ADDRESS_BORDER);
+		int  anisotropy = (info.filter == GS_FILTER_ANISOTROPIC) ? info.max_anisotropy : 1;
+		return key_t{info.filter, info.address_u, info.address_v, info.address_w, anisotropy, has_border ? info.border_color : 0};
+	}
+
+	std::shared_ptr<gs_sampler_state> intern(gs_sampler_info const& info)
+	{
+		auto  key = make_key(info);
+		auto& reg = get_registry();
+
+		std::lock_guard<std::mutex> lock(reg.lock);
+		if (auto iter = reg.states.find(key); iter != reg.states.end()) {
+			if (auto state = iter->second.lock(); state) {
+				return state;
+			}
+		}
+
+		gs_sampler_state* state;
+		{
+			auto gctx = streamfx::obs::gs::context();
+			state     = gs_samplerstate_create(&info);
+		}
+		if (!state) {
+			throw std::runtime_error("Failed to create sampler state.");
+		}
+
+		auto shared = std::shared_ptr<gs_sampler_state>(state, [](gs_sampler_state* v) {
+			auto gctx = streamfx::obs::gs::context();
+			gs_samplerstate_destroy(v);
+		});
+
+		// Drop whatever expired since the last new state, so the map does not grow with every settings change.
+		for (auto iter = reg.states.begin(); iter != reg.states.end();) {
+			if (iter->second.expired()) {
+				iter = reg.states.erase(iter);
+			} else {
+				++iter;
+			}
+		}
+		reg.states[key] = shared;
+		return shared;
+	}
+} // namespace
+
 streamfx::obs::gs::sampler::sampler()
 {
 	_dirty         = true;
@@ -15,15 +80,11 @@ streamfx::obs::gs::sampler::sampler()
 	_sampler_state = nullptr;
 }
 
-streamfx::obs::gs::sampler::~sampler()
-{
-	if (_sampler_state)
-		gs_samplerstate_destroy(_sampler_state);
-}
+streamfx::obs::gs::sampler::~sampler() {}
 
 void streamfx::obs::gs::sampler::set_filter(gs_sample_filter v)
 {
-	_dirty               = true;
+	_dirty |= (_sampler_info.filter != v);
 	_sampler_info.filter = v;
 }
 
@@ -34,7 +95,7 @@ gs_sample_filter streamfx::obs::gs::sampler::get_filter()
 
 void streamfx::obs::gs::sampler::set_address_mode_u(gs_address_mode v)
 {
-	_dirty                  = true;
+	_dirty |= (_sampler_info.address_u != v);
 	_sampler_info.address_u = v;
 }
 
@@ -45,7 +106,7 @@ gs_address_mode streamfx::obs::gs::sampler::get_address_mode_u()
 
 void streamfx::obs::gs::sampler::set_address_mode_v(gs_address_mode v)
 {
-	_dirty                  = true;
+	_dirty |= (_sampler_info.address_v != v);
 	_sampler_info.address_v = v;
 }
 
@@ -56,7 +117,7 @@ gs_address_mode streamfx::obs::gs::sampler::get_address_mode_v()
 
 void streamfx::obs::gs::sampler::set_address_mode_w(gs_address_mode v)
 {
-	_dirty                  = true;
+	_dirty |= (_sampler_info.address_w != v);
 	_sampler_info.address_w = v;
 }
 
@@ -67,7 +128,7 @@ gs_address_mode streamfx::obs::gs::sampler::get_address_mode_w()
 
 void streamfx::obs::gs::sampler::set_max_anisotropy(int32_t v)
 {
-	_dirty                       = true;
+	_dirty |= (_sampler_info.max_anisotropy != v);
 	_sampler_info.max_anisotropy = v;
 }
 
@@ -78,14 +139,13 @@ int32_t streamfx::obs::gs::sampler::get_max_anisotropy()
 
 void streamfx::obs::gs::sampler::set_border_color(uint32_t v)
 {
-	_dirty                     = true;
+	_dirty |= (_sampler_info.border_color != v);
 	_sampler_info.border_color = v;
 }
 
 void streamfx::obs::gs::sampler::set_border_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
-	_dirty                     = true;
-	_sampler_info.border_color = (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b);
+	set_border_color((static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b));
 }
 
 uint32_t streamfx::obs::gs::sampler::get_border_color()
@@ -108,15 +168,14 @@ uint8_t streamfx::obs::gs::sampler::get_border_color(bool r, bool g, bool b, boo
 
 gs_sampler_state* streamfx::obs::gs::sampler::refresh()
 {
-	gs_samplerstate_destroy(_sampler_state);
-	_sampler_state = gs_samplerstate_create(&_sampler_info);
+	_sampler_state = intern(_sampler_info);
 	_dirty         = false;
-	return _sampler_state;
+	return _sampler_state.get();
 }
 
 gs_sampler_state* streamfx::obs::gs::sampler::get_object()
 {
-	if (_dirty)
+	if (_dirty || !_sampler_state)
 		return refresh();
-	return _sampler_state;
+	return _sampler_state.get();
 }
@@ -5,7 +5,17 @@
 #pragma once
 #include "common.hpp"
 
+#include "warning-disable.hpp"
+#include <memory>
+#include "warning-enable.hpp"
+
 namespace streamfx::obs::gs {
+	/** Description of a sampler state, which creates the actual state on demand.
+	 *
+	 * States are interned: all samplers with the same effective settings share a single gs_sampler_state, which lives
+	 * for as long as any of them uses it. Settings that the GPU ignores, such as the border color without a border
+	 * address mode, do not prevent sharing.
+	 */
 	class sampler {
 		public:
 		sampler();
@@ -36,8 +46,8 @@ namespace streamfx::obs::gs {
 		gs_sampler_state* get_object();
 
 		private:
-		bool              _dirty;
-		gs_sampler_info   _sampler_info;
-		gs_sampler_state* _sampler_state;
+		bool                              _dirty;
+		gs_sampler_info                   _sampler_info;
+		std::shared_ptr<gs_sampler_state> _sampler_state;
 	};
 } // namespace streamfx::obs::gs
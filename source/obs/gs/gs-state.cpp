@@ -0,0 +1,184 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-state.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <optional>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace {
+	// Part of the state that gs_blend_state_push() and gs_blend_state_pop() save and restore.
+	struct blend_values {
+		std::optional<bool>                         enabled;
+		std::optional<std::array<gs_blend_type, 4>> function;
+	};
+
+	struct other_values {
+		std::optional<std::array<bool, 4>>               color;
+		std::optional<gs_cull_mode>                      cull;
+		std::optional<bool>                              depth_test;
+		std::optional<gs_depth_test>                     depth_function;
+		std::optional<bool>                              stencil_test;
+		std::optional<bool>                              stencil_write;
+		std::optional<gs_depth_test>                     stencil_function;
+		std::optional<std::array<gs_stencil_op_type, 3>> stencil_op;
+	};
+
+	struct level {
+		blend_values blend;
+		uint64_t     generation;
+	};
+
+	struct tracker {
+		blend_values       blend;
+		other_values       other;
+		std::vector<level> levels;
+		uint64_t           generation = 0;
+	};
+
+	tracker& get_tracker()
+	{
+		static tracker instance;
+		return instance;
+	}
+
+	// Store the new value, and tell whether the caller has to forward it.
+	template<typename T>
+	bool changes(std::optional<T>& current, T const& value)
+	{
+		if (current.has_value() && (current.value() == value)) {
+			return false;
+		}
+		current = value;
+		return true;
+	}
+} // namespace
+
+void streamfx::obs::gs::state::push()
+{
+	auto& data = get_tracker();
+	gs_blend_state_push();
+	data.levels.push_back({data.blend, data.generation});
+}
+
+void streamfx::obs::gs::state::pop()
+{
+	auto& data = get_tracker();
+	gs_blend_state_pop();
+	if (data.levels.empty()) {
+		invalidate();
+		return;
+	}
+
+	// libobs restores the blend state exactly as it was pushed. Everything else is only still known if nothing outside
+	// changed it in the meantime.
+	auto& back = data.levels.back();
+	data.blend = back.blend;
+	if (back.generation != data.generation) {
+		data.other = {};
+	}
+	data.levels.pop_back();
+}
+
+void streamfx::obs::gs::state::invalidate()
+{
+	auto& data = get_tracker();
+	data.blend = {};
+	data.other = {};
+	data.generation++;
+}
+
+void streamfx::obs::gs::state::enable_blending(bool enable)
+{
+	if (changes(get_tracker().blend.enabled, enable)) {
+		gs_enable_blending(enable);
+	}
+}
+
+void streamfx::obs::gs::state::blend_function(gs_blend_type src, gs_blend_type dest)
+{
+	if (changes(get_tracker().blend.function, {src, dest, src, dest})) {
+		gs_blend_function(src, dest);
+	}
+}
+
+void streamfx::obs::gs::state::blend_function_separate(gs_blend_type src_c, gs_blend_type dest_c, gs_blend_type src_a, gs_blend_type dest_a)
+{
+	if (changes(get_tracker().blend.function, {src_c, dest_c, src_a, dest_a})) {
+		gs_blend_function_separate(src_c, dest_c, src_a, dest_a);
+	}
+}
+
+void streamfx::obs::gs::state::enable_color(bool red, bool green, bool blue, bool alpha)
+{
+	if (changes(get_tracker().other.color, {red, green, blue, alpha})) {
+		gs_enable_color(red, green, blue, alpha);
+	}
+}
+
+void streamfx::obs::gs::state::set_cull_mode(gs_cull_mode mode)
+{
+	if (changes(get_tracker().other.cull, mode)) {
+		gs_set_cull_mode(mode);
+	}
+}
+
+void streamfx::obs::gs::state::enable_depth_test(bool enable)
+{
+	if (changes(get_tracker().other.depth_test, enable)) {
+		gs_enable_depth_test(enable);
+	}
+}
+
+void streamfx::obs::gs::state::depth_function(gs_depth_test test)
+{
+	if (changes(get_tracker().other.depth_function, test)) {
+		gs_depth_function(test);
+	}
+}
+
+void streamfx::obs::gs::state::enable_stencil_test(bool enable)
+{
+	if (changes(get_tracker().other.stencil_test, enable)) {
+		gs_enable_stencil_test(enable);
+	}
+}
+
+void streamfx::obs::gs::state::enable_stencil_write(bool enable)
+{
+	if (changes(get_tracker().other.stencil_write, enable)) {
+		gs_enable_stencil_write(enable);
+	}
+}
+
+void streamfx::obs::gs::state::stencil_function(gs_depth_test test)
+{
+	if (changes(get_tracker().other.stencil_function, test)) {
+		gs_stencil_function(GS_STENCIL_BOTH, test);
+	}
+}
+
+void streamfx::obs::gs::state::stencil_op(gs_stencil_op_type fail, gs_stencil_op_type zfail, gs_stencil_op_type zpass)
+{
+	if (changes(get_tracker().other.stencil_op, {fail, zfail, zpass})) {
+		gs_stencil_op(GS_STENCIL_BOTH, fail, zfail, zpass);
+	}
+}
+
+void streamfx::obs::gs::state::apply_opaque(gs_stencil_op_type stencil)
+{
+	enable_blending(false);
+	blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	enable_color(true, true, true, true);
+	set_cull_mode(GS_NEITHER);
+	enable_depth_test(false);
+	depth_function(GS_ALWAYS);
+	enable_stencil_test(false);
+	enable_stencil_write(false);
+	stencil_function(GS_ALWAYS);
+	stencil_op(stencil, stencil, stencil);
+}
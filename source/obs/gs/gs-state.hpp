@@ -0,0 +1,53 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+namespace streamfx::obs::gs {
+	/** Fixed function state, with calls that would not change anything skipped.
+	 *
+	 * Remembers what was last set through it, and only forwards actual changes to libobs. push() and pop() wrap
+	 * gs_blend_state_push() and gs_blend_state_pop(), so the blend state is restored by pop() while everything else
+	 * keeps its latest value, just like with libobs.
+	 *
+	 * Nothing is known about state set anywhere else. Call invalidate() after handing control to other code, like
+	 * obs_source_process_filter_end() or the rendering of another source, and never mix it with direct gs_* calls for
+	 * the same state. Only for use in the graphics thread.
+	 */
+	class state {
+		public:
+		static void push();
+
+		static void pop();
+
+		/** Forget everything, as the state may have been changed elsewhere. */
+		static void invalidate();
+
+		static void enable_blending(bool enable);
+
+		static void blend_function(gs_blend_type src, gs_blend_type dest);
+
+		static void blend_function_separate(gs_blend_type src_c, gs_blend_type dest_c, gs_blend_type src_a, gs_blend_type dest_a);
+
+		static void enable_color(bool red, bool green, bool blue, bool alpha);
+
+		static void set_cull_mode(gs_cull_mode mode);
+
+		static void enable_depth_test(bool enable);
+
+		static void depth_function(gs_depth_test test);
+
+		static void enable_stencil_test(bool enable);
+
+		static void enable_stencil_write(bool enable);
+
+		static void stencil_function(gs_depth_test test);
+
+		static void stencil_op(gs_stencil_op_type fail, gs_stencil_op_type zfail, gs_stencil_op_type zpass);
+
+		/** Overwrite everything that is drawn: no blending, depth, stencil or culling, and all channels written. */
+		static void apply_opaque(gs_stencil_op_type stencil = GS_ZERO);
+	};
+} // namespace streamfx::obs::gs
@@ -25,6 +25,16 @@ static uint32_t decode_flags(streamfx::obs::gs::texture::flags texture_flags)
 	return flags;
 }
 
+static uint64_t estimate_size(uint64_t texels, gs_color_format format, uint32_t mip_levels, streamfx::obs::gs::texture::flags texture_flags)
+{
+	// A full chain of mip maps adds up to another third of the base level.
+	uint64_t bytes = texels * gs_get_format_bpp(format) / 8;
+	if ((mip_levels > 1) || has(texture_flags, streamfx::obs::gs::texture::flags::BuildMipMaps)) {
+		bytes = bytes * 4 / 3;
+	}
+	return bytes;
+}
+
 streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
 {
 	if (width == 0)
@@ -48,7 +58,8 @@ streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, gs_color_fo
 	if (!_texture)
 		throw std::runtime_error("Failed to create texture.");
 
-	_type = type::Normal;
+	_type   = type::Normal;
+	_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::Texture, estimate_size(static_cast<uint64_t>(width) * height, format, mip_levels, texture_flags));
 }
 
 streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, uint32_t depth, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
@@ -76,7 +87,8 @@ streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, uint32_t de
 	if (!_texture)
 		throw std::runtime_error("Failed to create texture.");
 
-	_type = type::Volume;
+	_type   = type::Volume;
+	_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::Texture, estimate_size(static_cast<uint64_t>(width) * height * depth, format, mip_levels, texture_flags));
 }
 
 streamfx::obs::gs::texture::texture(uint32_t size, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
@@ -100,7 +112,8 @@ streamfx::obs::gs::texture::texture(uint32_t size, gs_color_format format, uint3
 	if (!_texture)
 		throw std::runtime_error("Failed to create texture.");
 
-	_type = type::Cube;
+	_type   = type::Cube;
+	_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::Texture, estimate_size(static_cast<uint64_t>(size) * size * 6, format, mip_levels, texture_flags));
 }
 
 streamfx::obs::gs::texture::texture(std::string file)
@@ -114,6 +127,8 @@ streamfx::obs::gs::texture::texture(std::string file)
 
 	if (!_texture)
 		throw std::runtime_error("Failed to load texture.");
+
+	account();
 }
 
 streamfx::obs::gs::texture::~texture()
@@ -194,3 +209,29 @@ gs_color_format streamfx::obs::gs::texture::get_color_format()
 {
 	return gs_texture_get_color_format(_texture);
 }
+
+void streamfx::obs::gs::texture::account()
+{
+	if (!_texture) {
+		return;
+	}
+
+	auto            gctx   = streamfx::obs::gs::context();
+	uint64_t        texels = 0;
+	gs_color_format format = GS_UNKNOWN;
+	switch (gs_get_texture_type(_texture)) {
+	case GS_TEXTURE_2D:
+		texels = static_cast<uint64_t>(gs_texture_get_width(_texture)) * gs_texture_get_height(_texture);
+		format = gs_texture_get_color_format(_texture);
+		break;
+	case GS_TEXTURE_3D:
+		texels = static_cast<uint64_t>(gs_voltexture_get_width(_texture)) * gs_voltexture_get_height(_texture) * gs_voltexture_get_depth(_texture);
+		format = gs_voltexture_get_color_format(_texture);
+		break;
+	case GS_TEXTURE_CUBE:
+		texels = static_cast<uint64_t>(gs_cubetexture_get_size(_texture)) * gs_cubetexture_get_size(_texture) * 6;
+		format = gs_cubetexture_get_color_format(_texture);
+		break;
+	}
+	_memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::Texture, estimate_size(texels, format, 1, flags::None));
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "util/util-memory.hpp"
 
 namespace streamfx::obs::gs {
 	class texture {
@@ -23,6 +24,8 @@ namespace streamfx::obs::gs {
 		bool          _is_owner = true;
 		type          _type     = type::Normal;
 
+		::streamfx::util::memory::allocation _memory;
+
 		public:
 		~texture();
 
@@ -70,6 +73,10 @@ namespace streamfx::obs::gs {
 		* will be thrown. If there is an error reading the file, a
 		* #Plugin::io_error will be thrown.
 		*
+		* Decodes on the calling thread while holding the graphics context,
+		* use #streamfx::gfx::image_cache to load and share images without
+		* stalling rendering.
+		*
 		* \param file File to create the texture from.
 		*/
 		texture(std::string file);
@@ -77,7 +84,11 @@ namespace streamfx::obs::gs {
 		/*!
 		* \brief Create a texture from an existing gs_texture_t object.
 		*/
-		texture(gs_texture_t* tex, bool takeOwnership = false) : _texture(tex), _is_owner(takeOwnership) {}
+		texture(gs_texture_t* tex, bool takeOwnership = false) : _texture(tex), _is_owner(takeOwnership)
+		{
+			if (takeOwnership)
+				account();
+		}
 
 		void load(int32_t unit);
 
@@ -92,6 +103,10 @@ namespace streamfx::obs::gs {
 		streamfx::obs::gs::texture::type get_type();
 
 		gs_color_format get_color_format();
+
+		private:
+		/** Account the memory of a texture that was created elsewhere, which has no information about mip maps. */
+		void account();
 	};
 } // namespace streamfx::obs::gs
 
@@ -0,0 +1,194 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-timer.hpp"
+#include "util/util-trace.hpp"
+
+#include "warning-disable.hpp"
+// Direct3D 11
+#ifdef _WIN32
+#include <Windows.h>
+#include <atlutil.h>
+#include <d3d11.h>
+#endif
+// OpenGL
+#include "glad/gl.h"
+#include "warning-enable.hpp"
+
+// Timeline used for GPU events in traces, as they don't belong to any CPU thread.
+constexpr uint64_t trace_gpu_timeline = 0;
+
+struct streamfx::obs::gs::timer::query {
+	bool                                           pending = false;
+	std::chrono::high_resolution_clock::time_point submitted;
+
+#ifdef _WIN32
+	ATL::CComPtr<ID3D11DeviceContext> d3d_context;
+	ATL::CComPtr<ID3D11Query>         d3d_disjoint;
+	ATL::CComPtr<ID3D11Query>         d3d_begin;
+	ATL::CComPtr<ID3D11Query>         d3d_end;
+#endif
+
+	GLuint gl_queries[2] = {0, 0};
+
+	query()
+	{
+#ifdef _WIN32
+		if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+			auto device = reinterpret_cast<ID3D11Device*>(gs_get_device_obj());
+			device->GetImmediateContext(&d3d_context);
+
+			D3D11_QUERY_DESC desc = {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
+			if (FAILED(device->CreateQuery(&desc, &d3d_disjoint))) {
+				throw std::runtime_error("Failed to create disjoint timestamp query.");
+			}
+			desc.Query = D3D11_QUERY_TIMESTAMP;
+			if (FAILED(device->CreateQuery(&desc, &d3d_begin)) || FAILED(device->CreateQuery(&desc, &d3d_end))) {
+				throw std::runtime_error("Failed to create timestamp query.");
+			}
+		}
+#endif
+		if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+			glGenQueries(2, gl_queries);
+		}
+	}
+
+	~query()
+	{
+		if ((gs_get_device_type() == GS_DEVICE_OPENGL) && gl_queries[0]) {
+			glDeleteQueries(2, gl_queries);
+		}
+	}
+
+	void begin()
+	{
+		submitted = std::chrono::high_resolution_clock::now();
+#ifdef _WIN32
+		if (d3d_context) {
+			d3d_context->Begin(d3d_disjoint);
+			d3d_context->End(d3d_begin);
+		}
+#endif
+		if (gl_queries[0]) {
+			glQueryCounter(gl_queries[0], GL_TIMESTAMP);
+		}
+	}
+
+	void end()
+	{
+#ifdef _WIN32
+		if (d3d_context) {
+			d3d_context->End(d3d_end);
+			d3d_context->End(d3d_disjoint);
+		}
+#endif
+		if (gl_queries[1]) {
+			glQueryCounter(gl_queries[1], GL_TIMESTAMP);
+		}
+		pending = true;
+	}
+
+	// Returns true once the result is known, with a negative duration if the measurement was unreliable.
+	bool resolve(std::chrono::nanoseconds& duration)
+	{
+		duration = std::chrono::nanoseconds(-1);
+#ifdef _WIN32
+		if (d3d_context) {
+			D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+			UINT64                              t0, t1;
+			if ((d3d_context->GetData(d3d_disjoint, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+				|| (d3d_context->GetData(d3d_begin, &t0, sizeof(t0), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+				|| (d3d_context->GetData(d3d_end, &t1, sizeof(t1), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)) {
+				return false;
+			}
+			if (!disjoint.Disjoint && (disjoint.Frequency > 0) && (t1 >= t0)) {
+				duration = std::chrono::nanoseconds(static_cast<int64_t>(double_t(t1 - t0) * 1000000000. / double_t(disjoint.Frequency)));
+			}
+			return true;
+		}
+#endif
+		if (gl_queries[0]) {
+			GLint available = 0;
+			glGetQueryObjectiv(gl_queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) {
+				return false;
+			}
+
+			GLuint64 t0 = 0, t1 = 0;
+			glGetQueryObjectui64v(gl_queries[0], GL_QUERY_RESULT, &t0);
+			glGetQueryObjectui64v(gl_queries[1], GL_QUERY_RESULT, &t1);
+			if (t1 >= t0) {
+				duration = std::chrono::nanoseconds(static_cast<int64_t>(t1 - t0));
+			}
+			return true;
+		}
+		return true;
+	}
+};
+
+streamfx::obs::gs::timer::~timer() {}
+
+streamfx::obs::gs::timer::timer(std::shared_ptr<streamfx::util::profiler> profiler, std::string_view name) : _profiler(profiler), _name(name), _queries(), _current(0), _active(false)
+{
+	for (auto& query : _queries) {
+		query = std::make_unique<struct query>();
+	}
+}
+
+void streamfx::obs::gs::timer::begin()
+{
+	poll();
+
+	// If the GPU is so far behind that every query is still in flight, skip this measurement.
+	auto& query = _queries[_current];
+	if (query->pending) {
+		_active = false;
+		return;
+	}
+
+	query->begin();
+	_active = true;
+}
+
+void streamfx::obs::gs::timer::end()
+{
+	if (!_active) {
+		return;
+	}
+
+	_queries[_current]->end();
+	_current = (_current + 1) % latency;
+	_active  = false;
+}
+
+std::shared_ptr<streamfx::util::profiler> streamfx::obs::gs::timer::get_profiler()
+{
+	return _profiler;
+}
+
+void streamfx::obs::gs::timer::poll()
+{
+	static auto recorder = streamfx::util::trace::recorder::instance();
+
+	// Queries complete in order, so stop at the first that isn't done yet.
+	for (size_t idx = 0; idx < latency; idx++) {
+		auto& query = _queries[(_current + idx) % latency];
+		if (!query->pending) {
+			continue;
+		}
+
+		std::chrono::nanoseconds duration;
+		if (!query->resolve(duration)) {
+			break;
+		}
+		query->pending = false;
+
+		if (duration.count() >= 0) {
+			_profiler->track(duration);
+			if (!_name.empty()) {
+				recorder->record(_name, "gpu", query->submitted, query->submitted + duration, trace_gpu_timeline);
+			}
+		}
+	}
+}
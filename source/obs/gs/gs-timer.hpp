@@ -0,0 +1,66 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "util/util-profiler.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::gs {
+	/** Measures the GPU time spent between begin() and end() using timestamp queries.
+	 *
+	 * Results are only available a few frames later, so every timer keeps a small ring of queries and feeds completed
+	 * measurements into the given profiler whenever begin() is called. Supports Direct3D 11 and OpenGL, and silently
+	 * does nothing on other graphics APIs. Must be created, used and destroyed inside the graphics context.
+	 */
+	class timer {
+		static constexpr size_t latency = 4;
+
+		struct query;
+
+		std::shared_ptr<streamfx::util::profiler>    _profiler;
+		std::string                                  _name;
+		std::array<std::unique_ptr<query>, latency> _queries;
+		size_t                                       _current;
+		bool                                         _active;
+
+		public:
+		~timer();
+		timer(std::shared_ptr<streamfx::util::profiler> profiler, std::string_view name = {});
+
+		void begin();
+
+		void end();
+
+		std::shared_ptr<streamfx::util::profiler> get_profiler();
+
+		private:
+		void poll();
+	};
+
+	/** Scope guard for timer::begin() and timer::end().
+	 */
+	class timer_scope {
+		timer* _timer;
+
+		public:
+		inline timer_scope(std::shared_ptr<timer> timer) : _timer(timer.get())
+		{
+			if (_timer)
+				_timer->begin();
+		}
+
+		inline ~timer_scope()
+		{
+			if (_timer)
+				_timer->end();
+		}
+	};
+} // namespace streamfx::obs::gs
@@ -5,6 +5,7 @@
 
 #include "gs-vertexbuffer.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "util/util-memory.hpp"
 
 #include "warning-disable.hpp"
 #include <stdexcept>
@@ -21,43 +22,43 @@ void streamfx::obs::gs::vertex_buffer::initialize(uint32_t capacity, uint8_t lay
 		throw std::out_of_range("layers");
 	}
 
-	// Allocate memory for data.
-	_data          = std::make_shared<decltype(_data)::element_type>();
-	_data->num     = _capacity;
-	_data->num_tex = _layers;
-	_data->points = _positions = static_cast<vec3*>(streamfx::util::malloc_aligned(16, sizeof(vec3) * _capacity));
-	_data->normals = _normals = static_cast<vec3*>(streamfx::util::malloc_aligned(16, sizeof(vec3) * _capacity));
-	_data->tangents = _tangents = static_cast<vec3*>(streamfx::util::malloc_aligned(16, sizeof(vec3) * _capacity));
-	_data->colors = _colors = static_cast<uint32_t*>(streamfx::util::malloc_aligned(16, sizeof(uint32_t) * _capacity));
-
-	// Clear the allocated memory of any data.
-	memset(_positions, 0, sizeof(vec3) * _capacity);
-	memset(_normals, 0, sizeof(vec3) * _capacity);
-	memset(_tangents, 0, sizeof(vec3) * _capacity);
-	memset(_colors, 0, sizeof(uint32_t) * _capacity);
+	_capacity = capacity;
+	_uploaded = 0;
+	_layers   = layers;
+	_dirty    = attribute::None;
+
+	// Allocate memory for data. The vertex buffer takes ownership of all of it, so that it has no reason to keep a
+	// second copy around, which means it must come from the OBS allocator.
+	gs_vb_data* data = gs_vbdata_create();
+	data->num        = _capacity;
+	data->num_tex    = _layers;
+	data->points = _positions = static_cast<vec3*>(bzalloc(sizeof(vec3) * _capacity));
+	data->normals = _normals = static_cast<vec3*>(bzalloc(sizeof(vec3) * _capacity));
+	data->tangents = _tangents = static_cast<vec3*>(bzalloc(sizeof(vec3) * _capacity));
+	data->colors = _colors = static_cast<uint32_t*>(bzalloc(sizeof(uint32_t) * _capacity));
 
 	if (_layers == 0) {
-		_data->tvarray = nullptr;
+		data->tvarray = nullptr;
 	} else {
-		_data->tvarray = _uv_layers = static_cast<gs_tvertarray*>(streamfx::util::malloc_aligned(16, sizeof(gs_tvertarray) * _layers));
+		data->tvarray = _uv_layers = static_cast<gs_tvertarray*>(bzalloc(sizeof(gs_tvertarray) * _layers));
 		for (uint8_t n = 0; n < _layers; n++) {
-			_uv_layers[n].array = _uvs[n] = static_cast<vec4*>(streamfx::util::malloc_aligned(16, sizeof(vec4) * _capacity));
+			_uv_layers[n].array = _uvs[n] = static_cast<vec4*>(bzalloc(sizeof(vec4) * _capacity));
 			_uv_layers[n].width           = 4;
-			memset(_uvs[n], 0, sizeof(vec4) * _capacity);
 		}
 	}
 
-	// Allocate actual GPU vertex buffer.
+	// Allocate actual GPU vertex buffer, which is accounted for until the last reference to it is gone.
+	uint64_t bytes = static_cast<uint64_t>(_capacity) * (sizeof(vec3) * 3 + sizeof(uint32_t) + sizeof(vec4) * _layers);
 	{
 		auto gctx = streamfx::obs::gs::context();
-		_buffer   = decltype(_buffer)(gs_vertexbuffer_create(_data.get(), GS_DYNAMIC | GS_DUP_BUFFER), [this](gs_vertbuffer_t* v) {
+		_buffer   = decltype(_buffer)(gs_vertexbuffer_create(data, GS_DYNAMIC), [data, memory = ::streamfx::util::memory::allocation(::streamfx::util::memory::kind::VertexBuffer, bytes)](gs_vertbuffer_t* v) {
             try {
                 auto gctx = streamfx::obs::gs::context();
                 gs_vertexbuffer_destroy(v);
             } catch (...) {
                 if (obs_get_version() < MAKE_SEMANTIC_VERSION(26, 0, 0)) {
                     // Fixes a memory leak with OBS Studio versions older than 26.x.
-                    gs_vbdata_destroy(_obs_data);
+                    gs_vbdata_destroy(data);
                 }
             }
         });
@@ -71,18 +72,17 @@ void streamfx::obs::gs::vertex_buffer::initialize(uint32_t capacity, uint8_t lay
 
 void streamfx::obs::gs::vertex_buffer::finalize()
 {
-	// Free data
-	streamfx::util::free_aligned(_positions);
-	streamfx::util::free_aligned(_normals);
-	streamfx::util::free_aligned(_tangents);
-	streamfx::util::free_aligned(_colors);
-	streamfx::util::free_aligned(_uv_layers);
-	for (std::size_t n = 0; n < _layers; n++) {
-		streamfx::util::free_aligned(_uvs[n]);
-	}
-
+	// The memory belongs to the buffer, which may still be shared with a moved-from instance.
 	_buffer.reset();
-	_data.reset();
+	_obs_data  = nullptr;
+	_positions = nullptr;
+	_normals   = nullptr;
+	_tangents  = nullptr;
+	_colors    = nullptr;
+	_uv_layers = nullptr;
+	for (std::size_t n = 0; n < MAXIMUM_UVW_LAYERS; n++) {
+		_uvs[n] = nullptr;
+	}
 }
 
 streamfx::obs::gs::vertex_buffer::~vertex_buffer()
@@ -91,9 +91,9 @@ streamfx::obs::gs::vertex_buffer::~vertex_buffer()
 }
 
 streamfx::obs::gs::vertex_buffer::vertex_buffer(uint32_t size, uint8_t layers)
-	: _capacity(size), _size(size), _layers(layers),
+	: _capacity(size), _size(size), _uploaded(0), _layers(layers), _dirty(attribute::None),
 
-	  _buffer(nullptr), _data(nullptr),
+	  _buffer(nullptr),
 
 	  _positions(nullptr), _normals(nullptr), _tangents(nullptr), _colors(nullptr), _uv_layers(nullptr), _uvs(),
 
@@ -103,9 +103,9 @@ streamfx::obs::gs::vertex_buffer::vertex_buffer(uint32_t size, uint8_t layers)
 }
 
 streamfx::obs::gs::vertex_buffer::vertex_buffer(gs_vertbuffer_t* vb)
-	: _capacity(0), _size(0), _layers(0),
+	: _capacity(0), _size(0), _uploaded(0), _layers(0), _dirty(attribute::None),
 
-	  _buffer(nullptr), _data(nullptr),
+	  _buffer(nullptr),
 
 	  _positions(nullptr), _normals(nullptr), _tangents(nullptr), _colors(nullptr), _uv_layers(nullptr), _uvs(),
 
@@ -117,6 +117,8 @@ streamfx::obs::gs::vertex_buffer::vertex_buffer(gs_vertbuffer_t* vb)
 		throw std::runtime_error("vertex buffer with no data");
 
 	initialize(static_cast<uint32_t>(vbd->num), static_cast<uint8_t>(vbd->num_tex));
+	_size  = _capacity;
+	_dirty = attribute::All;
 
 	if (_positions && vbd->points)
 		memcpy(_positions, vbd->points, vbd->num * sizeof(vec3));
@@ -145,28 +147,31 @@ streamfx::obs::gs::vertex_buffer::vertex_buffer(gs_vertbuffer_t* vb)
 
 streamfx::obs::gs::vertex_buffer::vertex_buffer(vertex_buffer const& other) : vertex_buffer(other._capacity, other._layers)
 { // Copy Constructor
-	memcpy(_positions, other._positions, _capacity * sizeof(vec3));
-	memcpy(_normals, other._normals, _capacity * sizeof(vec3));
-	memcpy(_tangents, other._tangents, _capacity * sizeof(vec3));
-	memcpy(_colors, other._colors, _capacity * sizeof(vec3));
+	// Everything past the used size is still zero from initialize().
+	_size  = other._size;
+	_dirty = attribute::All;
+	memcpy(_positions, other._positions, _size * sizeof(vec3));
+	memcpy(_normals, other._normals, _size * sizeof(vec3));
+	memcpy(_tangents, other._tangents, _size * sizeof(vec3));
+	memcpy(_colors, other._colors, _size * sizeof(uint32_t));
 	for (std::size_t n = 0; n < other._layers; n++) {
-		memcpy(_uvs[n], other._uvs[n], _capacity * sizeof(vec4));
+		memcpy(_uvs[n], other._uvs[n], _size * sizeof(vec4));
 	}
 }
 
 void streamfx::obs::gs::vertex_buffer::operator=(vertex_buffer const& other)
 { // Copy operator
 	initialize(other._capacity, other._layers);
-	_size = other._size;
+	_size  = other._size;
+	_dirty = attribute::All;
 
 	// Copy actual data over.
-	memcpy(_positions, other._positions, other._capacity * sizeof(vec3));
-	memcpy(_normals, other._normals, other._capacity * sizeof(vec3));
-	memcpy(_tangents, other._tangents, other._capacity * sizeof(vec3));
-	memcpy(_colors, other._colors, other._capacity * sizeof(uint32_t));
-	memcpy(_uv_layers, other._uv_layers, sizeof(gs_tvertarray));
+	memcpy(_positions, other._positions, _size * sizeof(vec3));
+	memcpy(_normals, other._normals, _size * sizeof(vec3));
+	memcpy(_tangents, other._tangents, _size * sizeof(vec3));
+	memcpy(_colors, other._colors, _size * sizeof(uint32_t));
 	for (std::size_t n = 0; n < other._layers; n++) {
-		memcpy(_uvs[n], other._uvs[n], _capacity * sizeof(vec4));
+		memcpy(_uvs[n], other._uvs[n], _size * sizeof(vec4));
 	}
 }
 
@@ -174,9 +179,10 @@ streamfx::obs::gs::vertex_buffer::vertex_buffer(vertex_buffer const&& other) noe
 { // Move Constructor
 	_capacity  = other._capacity;
 	_size      = other._size;
+	_uploaded  = other._uploaded;
 	_layers    = other._layers;
+	_dirty     = other._dirty;
 	_buffer    = other._buffer;
-	_data      = other._data;
 	_positions = other._positions;
 	_normals   = other._normals;
 	_tangents  = other._tangents;
@@ -194,9 +200,10 @@ void streamfx::obs::gs::vertex_buffer::operator=(vertex_buffer const&& other) no
 
 	_capacity  = other._capacity;
 	_size      = other._size;
+	_uploaded  = other._uploaded;
 	_layers    = other._layers;
+	_dirty     = other._dirty;
 	_buffer    = other._buffer;
-	_data      = other._data;
 	_positions = other._positions;
 	_normals   = other._normals;
 	_tangents  = other._tangents;
@@ -237,6 +244,9 @@ const streamfx::obs::gs::vertex streamfx::obs::gs::vertex_buffer::at(uint32_t id
 		throw std::out_of_range("idx out of range");
 	}
 
+	// The caller may write to any of these.
+	_dirty = attribute::All;
+
 	streamfx::obs::gs::vertex vtx(&_positions[idx], &_normals[idx], &_tangents[idx], &_colors[idx], nullptr);
 	for (std::size_t n = 0; n < _layers; n++) {
 		vtx.uv[n] = &_uvs[n][idx];
@@ -249,6 +259,11 @@ const streamfx::obs::gs::vertex streamfx::obs::gs::vertex_buffer::operator[](uin
 	return at(pos);
 }
 
+void streamfx::obs::gs::vertex_buffer::invalidate(attribute which)
+{
+	_dirty = _dirty | which;
+}
+
 void streamfx::obs::gs::vertex_buffer::set_uv_layers(uint8_t layers)
 {
 	_layers = layers;
@@ -261,21 +276,25 @@ uint8_t streamfx::obs::gs::vertex_buffer::get_uv_layers()
 
 vec3* streamfx::obs::gs::vertex_buffer::get_positions()
 {
+	_dirty = _dirty | attribute::Position;
 	return _positions;
 }
 
 vec3* streamfx::obs::gs::vertex_buffer::get_normals()
 {
+	_dirty = _dirty | attribute::Normal;
 	return _normals;
 }
 
 vec3* streamfx::obs::gs::vertex_buffer::get_tangents()
 {
+	_dirty = _dirty | attribute::Tangent;
 	return _tangents;
 }
 
 uint32_t* streamfx::obs::gs::vertex_buffer::get_colors()
 {
+	_dirty = _dirty | attribute::Color;
 	return _colors;
 }
 
@@ -284,15 +303,40 @@ vec4* streamfx::obs::gs::vertex_buffer::get_uv_layer(uint8_t idx)
 	if (idx >= _layers) {
 		throw std::out_of_range("idx out of range");
 	}
+	_dirty = _dirty | static_cast<attribute>(static_cast<uint16_t>(attribute::UV0) << idx);
 	return _uvs[idx];
 }
 
 gs_vertbuffer_t* streamfx::obs::gs::vertex_buffer::update(bool refreshGPU)
 {
-	if (refreshGPU) {
+	// Attributes that were left out of earlier, smaller uploads are missing the vertices past what was uploaded then.
+	if (_size > _uploaded) {
+		_dirty = attribute::All;
+	}
+
+	if (refreshGPU && any(_dirty)) {
+		// Hand the buffer only what changed, everything left out is kept as it is on the GPU. UV layers can only be
+		// skipped from the end, so everything up to the last changed layer is uploaded.
+		//
+		// Only the used vertices are handed over. Direct3D 11 always copies the whole buffer regardless, but OpenGL
+		// maps and copies only as much as it is given, which for a mostly empty buffer is a large part of the cost.
+		gs_vb_data data = {};
+		data.num        = _size;
+		data.points     = any(_dirty & attribute::Position) ? _positions : nullptr;
+		data.normals    = any(_dirty & attribute::Normal) ? _normals : nullptr;
+		data.tangents   = any(_dirty & attribute::Tangent) ? _tangents : nullptr;
+		data.colors     = any(_dirty & attribute::Color) ? _colors : nullptr;
+		data.tvarray    = _uv_layers;
+		for (uint8_t n = 0; n < _layers; n++) {
+			if (any(_dirty & static_cast<attribute>(static_cast<uint16_t>(attribute::UV0) << n))) {
+				data.num_tex = n + 1;
+			}
+		}
+
 		auto gctx = streamfx::obs::gs::context();
-		gs_vertexbuffer_flush_direct(_buffer.get(), _data.get());
-		_obs_data = gs_vertexbuffer_get_data(_buffer.get());
+		gs_vertexbuffer_flush_direct(_buffer.get(), &data);
+		_dirty    = attribute::None;
+		_uploaded = _size;
 	}
 	return _buffer.get();
 }
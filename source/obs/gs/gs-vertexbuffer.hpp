@@ -10,13 +10,27 @@
 
 namespace streamfx::obs::gs {
 	class vertex_buffer {
-		uint32_t _capacity;
-		uint32_t _size;
-		uint8_t  _layers;
-
-		// OBS GS Data
+		public:
+		enum class attribute : uint16_t {
+			None     = 0,
+			Position = 1 << 0,
+			Normal   = 1 << 1,
+			Tangent  = 1 << 2,
+			Color    = 1 << 3,
+			UV0      = 1 << 4, // UV layer n is 'UV0 << n'.
+			UV       = 0xFF << 4,
+			All      = 0xFFF,
+		};
+
+		private:
+		uint32_t  _capacity;
+		uint32_t  _size;
+		uint32_t  _uploaded; // Vertices of every attribute that are valid on the GPU.
+		uint8_t   _layers;
+		attribute _dirty;
+
+		// OBS GS Data, which owns all of the memory below.
 		std::shared_ptr<gs_vertbuffer_t> _buffer;
-		std::shared_ptr<gs_vb_data>      _data;
 
 		// Memory Storage
 		vec3*          _positions;
@@ -111,13 +125,22 @@ namespace streamfx::obs::gs {
 
 		const streamfx::obs::gs::vertex operator[](uint32_t const pos);
 
+		/*!
+		* \brief Mark attributes as changed
+		* Only changed attributes are uploaded by the next update(). Accessing a single attribute through one of the
+		* get_*() functions marks it automatically, while at() marks all of them.
+		*
+		* \param which The attributes to upload again.
+		*/
+		void invalidate(attribute which = attribute::All);
+
 		void set_uv_layers(uint8_t layers);
 
 		uint8_t get_uv_layers();
 
 		/*!
 		* \brief Directly access the positions buffer
-		* Returns the internal memory that is assigned to hold all vertex positions.
+		* Returns the internal memory that is assigned to hold all vertex positions, and marks them as changed.
 		*
 		* \return A <vec3*> that points at the first vertex's position.
 		*/
@@ -125,7 +148,7 @@ namespace streamfx::obs::gs {
 
 		/*!
 		* \brief Directly access the normals buffer
-		* Returns the internal memory that is assigned to hold all vertex normals.
+		* Returns the internal memory that is assigned to hold all vertex normals, and marks them as changed.
 		*
 		* \return A <vec3*> that points at the first vertex's normal.
 		*/
@@ -133,7 +156,7 @@ namespace streamfx::obs::gs {
 
 		/*!
 		* \brief Directly access the tangents buffer
-		* Returns the internal memory that is assigned to hold all vertex tangents.
+		* Returns the internal memory that is assigned to hold all vertex tangents, and marks them as changed.
 		*
 		* \return A <vec3*> that points at the first vertex's tangent.
 		*/
@@ -141,7 +164,7 @@ namespace streamfx::obs::gs {
 
 		/*!
 		* \brief Directly access the colors buffer
-		* Returns the internal memory that is assigned to hold all vertex colors.
+		* Returns the internal memory that is assigned to hold all vertex colors, and marks them as changed.
 		*
 		* \return A <uint32_t*> that points at the first vertex's color.
 		*/
@@ -149,7 +172,7 @@ namespace streamfx::obs::gs {
 
 		/*!
 		* \brief Directly access the uv buffer
-		* Returns the internal memory that is assigned to hold all vertex uvs.
+		* Returns the internal memory that is assigned to hold all vertex uvs, and marks them as changed.
 		*
 		* \return A <vec4*> that points at the first vertex's uv.
 		*/
@@ -160,3 +183,5 @@ namespace streamfx::obs::gs {
 		gs_vertbuffer_t* update(bool refreshGPU);
 	};
 } // namespace streamfx::obs::gs
+
+P_ENABLE_BITMASK_OPERATORS(streamfx::obs::gs::vertex_buffer::attribute)
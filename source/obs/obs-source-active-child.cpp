@@ -3,3 +3,47 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "obs-source-active-child.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <mutex>
+#include <utility>
+#include "warning-enable.hpp"
+
+std::shared_ptr<streamfx::obs::source_active_child> streamfx::obs::source_active_child::add_active_child(::streamfx::obs::source const& parent, ::streamfx::obs::source const& child)
+{
+	static std::mutex                                                                            lock;
+	static std::map<std::pair<obs_source_t*, obs_source_t*>, std::weak_ptr<source_active_child>> references;
+
+	// Sources may be destroyed and another one created at the same address, so check who is actually referenced.
+	auto key  = std::make_pair(parent.get(), child.get());
+	auto find = [&key, &parent, &child]() -> std::shared_ptr<source_active_child> {
+		auto iter = references.find(key);
+		if (iter != references.end()) {
+			if (auto ref = iter->second.lock(); ref && (ref->_parent == parent) && (ref->_child == child)) {
+				return ref;
+			}
+		}
+		return nullptr;
+	};
+
+	{
+		std::lock_guard<std::mutex> lg(lock);
+		if (auto ref = find(); ref) {
+			return ref;
+		}
+	}
+
+	// libobs activates the child right away if the parent is active, which may call back into us, so never hold the lock.
+	auto ref = std::make_shared<source_active_child>(parent, child);
+
+	std::lock_guard<std::mutex> lg(lock);
+	if (auto other = find(); other) {
+		return other; // Someone else was faster, so ours goes away again.
+	}
+	for (auto iter = references.begin(); iter != references.end();) {
+		iter = iter->second.expired() ? references.erase(iter) : std::next(iter);
+	}
+	references[key] = ref;
+	return ref;
+}
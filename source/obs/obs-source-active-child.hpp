@@ -30,5 +30,9 @@ namespace streamfx::obs {
 				throw std::runtime_error("Child contains Parent");
 			}
 		}
+
+		public:
+		/** Add the child to the parent, sharing one libobs reference with everyone else who already did. */
+		static std::shared_ptr<source_active_child> add_active_child(::streamfx::obs::source const& parent, ::streamfx::obs::source const& child);
 	};
 } // namespace streamfx::obs
@@ -25,9 +25,7 @@ namespace streamfx::obs {
 		}
 
 		public:
-		static FORCE_INLINE std::shared_ptr<source_active_reference> add_active_reference(::streamfx::obs::source& source)
-		{
-			return std::make_shared<source_active_reference>(source);
-		}
+		/** Mark the source as active, sharing one libobs reference with everyone else who already did. */
+		static std::shared_ptr<source_active_reference> add_active_reference(::streamfx::obs::source& source);
 	};
 } // namespace streamfx::obs
@@ -3,3 +3,261 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "obs-source-factory.hpp"
+#include "configuration.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include "warning-enable.hpp"
+
+// Long enough that briefly hidden sources, like during a scene switch, keep their resources.
+#define ST_CFG_IDLE_TIMEOUT "Graphics.IdleTimeout"
+#define ST_DEFAULT_IDLE_TIMEOUT 30.f
+
+float streamfx::obs::source_instance::idle_timeout()
+{
+	static float timeout = []() {
+		if (auto config = streamfx::configuration::instance(); config) {
+			auto dataptr = config->get();
+			if (obs_data_has_user_value(dataptr.get(), ST_CFG_IDLE_TIMEOUT)) {
+				return std::max(static_cast<float>(obs_data_get_double(dataptr.get(), ST_CFG_IDLE_TIMEOUT)), 0.f);
+			}
+		}
+		return ST_DEFAULT_IDLE_TIMEOUT;
+	}();
+	return timeout;
+}
+
+namespace {
+	struct visibility_cache {
+		std::mutex                    lock;
+		uint64_t                      frame = 0;
+		std::map<obs_source_t*, bool> visible;
+	};
+
+	bool is_item_invisible(obs_sceneitem_t* item)
+	{
+		vec2 scale;
+		obs_sceneitem_get_scale(item, &scale);
+		if ((scale.x == 0.f) || (scale.y == 0.f)) {
+			return true;
+		}
+
+		if (obs_sceneitem_get_bounds_type(item) != OBS_BOUNDS_NONE) {
+			vec2 bounds;
+			obs_sceneitem_get_bounds(item, &bounds);
+			if ((bounds.x == 0.f) || (bounds.y == 0.f)) {
+				return true;
+			}
+		}
+
+		obs_sceneitem_crop crop;
+		obs_sceneitem_get_crop(item, &crop);
+		obs_source_t* source = obs_sceneitem_get_source(item);
+		return ((static_cast<int64_t>(crop.left) + crop.right) >= obs_source_get_width(source)) || ((static_cast<int64_t>(crop.top) + crop.bottom) >= obs_source_get_height(source));
+	}
+
+	struct walk_state {
+		std::map<obs_source_t*, bool>* visible;
+		bool                           invisible;
+	};
+
+	bool walk_items(obs_scene_t*, obs_sceneitem_t* item, void* param)
+	{
+		auto* state = static_cast<walk_state*>(param);
+
+		// Hidden items are not rendered at all, so they say nothing about whether their source is seen.
+		if (!obs_sceneitem_visible(item)) {
+			return true;
+		}
+
+		bool invisible = state->invisible || is_item_invisible(item);
+		auto kv        = state->visible->try_emplace(obs_sceneitem_get_source(item), false).first;
+		kv->second     = kv->second || !invisible;
+
+		if (obs_sceneitem_is_group(item)) {
+			walk_state child{state->visible, invisible};
+			obs_scene_enum_items(obs_sceneitem_group_get_scene(item), walk_items, &child);
+		}
+		return true;
+	}
+
+	// Whether each source shown through a scene that is being shown can be seen in at least one of them.
+	std::map<obs_source_t*, bool> const& scene_visibility(std::unique_lock<std::mutex>& lock)
+	{
+		static visibility_cache cache;
+		lock = std::unique_lock<std::mutex>(cache.lock);
+
+		uint64_t frame = obs_get_video_frame_time();
+		if (cache.frame != frame) {
+			cache.frame = frame;
+			cache.visible.clear();
+			obs_enum_scenes(
+				[](void* param, obs_source_t* source) {
+					if (obs_source_showing(source)) {
+						if (obs_scene_t* scene = obs_scene_from_source(source); scene) {
+							walk_state state{static_cast<std::map<obs_source_t*, bool>*>(param), false};
+							obs_scene_enum_items(scene, walk_items, &state);
+						}
+					}
+					return true;
+				},
+				&cache.visible);
+		}
+		return cache.visible;
+	}
+
+	// Whether a color correction after 'filter' leaves nothing of it.
+	bool is_faded_out(obs_source_t* parent, obs_source_t* filter)
+	{
+		struct state_t {
+			obs_source_t* filter;
+			bool          after;
+			bool          faded;
+		} state{filter, false, false};
+
+		obs_source_enum_filters(
+			parent,
+			[](obs_source_t*, obs_source_t* child, void* param) {
+				auto* state = static_cast<state_t*>(param);
+				if (child == state->filter) {
+					state->after = true;
+				} else if (state->after && !state->faded && obs_source_enabled(child)) {
+					std::string_view id = obs_source_get_unversioned_id(child);
+					if (id == "color_filter") { // Both versions of it use 'opacity', and 0 is transparent in both.
+						obs_data_t* settings = obs_source_get_settings(child);
+						state->faded         = (obs_data_get_double(settings, "opacity") <= 0.);
+						obs_data_release(settings);
+					}
+				}
+			},
+			&state);
+		return state.faded;
+	}
+} // namespace
+
+void streamfx::obs::source_instance::visibility_tick()
+{
+	_hidden = false;
+	if (obs_source_get_type(_self) != OBS_SOURCE_TYPE_FILTER) {
+		return;
+	}
+
+	obs_source_t* parent = obs_filter_get_parent(_self);
+	if (!parent) {
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock;
+		auto const&                  visible = scene_visibility(lock);
+		if (auto kv = visible.find(parent); kv != visible.end()) {
+			_hidden = !kv->second;
+		}
+	}
+
+	if (!_hidden) {
+		_hidden = is_faded_out(parent, _self);
+	}
+}
+
+streamfx::obs::source_instance::color_info streamfx::obs::source_instance::query_color_space(obs_source_t* source, size_t count, const gs_color_space* preferred_spaces)
+{
+	color_info info{GS_CS_SRGB, GS_RGBA, false};
+	if (!source) {
+		return info;
+	}
+
+	info.space = obs_source_get_color_space(source, count, preferred_spaces);
+	switch (info.space) {
+	case GS_CS_SRGB:
+		info.format = GS_RGBA;
+		break;
+	case GS_CS_SRGB_16F:
+	case GS_CS_709_EXTENDED:
+	case GS_CS_709_SCRGB:
+		info.format = GS_RGBA16F;
+		break;
+	default:
+		info.format = GS_RGBA_UNORM;
+	}
+
+	if ((obs_source_get_output_flags(source) & OBS_SOURCE_SRGB) == OBS_SOURCE_SRGB) {
+		info.srgb = (info.space <= GS_CS_SRGB_16F);
+	}
+
+	return info;
+}
+
+streamfx::obs::source_instance::color_info const& streamfx::obs::source_instance::negotiate_color_space(obs_source_t* source)
+{
+	_color = query_color_space(source, _color_preferred.size(), _color_preferred.data());
+	return _color;
+}
+
+#ifdef ENABLE_PROFILING
+#include "warning-disable.hpp"
+#include <mutex>
+#include <set>
+#include "warning-enable.hpp"
+
+namespace {
+	struct registry {
+		std::mutex                                lock;
+		std::set<streamfx::obs::source_instance*> instances;
+	};
+
+	registry& get_registry()
+	{
+		static registry instance;
+		return instance;
+	}
+} // namespace
+
+void streamfx::obs::source_instance::register_instance(source_instance* instance)
+{
+	auto&                       reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.lock);
+	reg.instances.insert(instance);
+}
+
+void streamfx::obs::source_instance::unregister_instance(source_instance* instance)
+{
+	auto&                       reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.lock);
+	reg.instances.erase(instance);
+}
+
+std::vector<streamfx::obs::source_instance::profile_info> streamfx::obs::source_instance::profile_all()
+{
+	auto&                       reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.lock);
+
+	// Only touch members of source_instance here, as the derived part of an instance may already be gone.
+	std::vector<profile_info> result;
+	result.reserve(reg.instances.size());
+	for (auto instance : reg.instances) {
+		profile_info info;
+		obs_source_t* source = instance->_self;
+		if (const char* name = obs_source_get_name(source); name) {
+			info.name = name;
+		}
+		if (obs_source_t* parent = obs_filter_get_parent(source); parent) {
+			if (const char* name = obs_source_get_name(parent); name) {
+				info.name = std::string(name) + " / " + info.name;
+			}
+		}
+		if (const char* type = obs_source_get_display_name(obs_source_get_id(source)); type) {
+			info.type = type;
+		}
+		info.cpu     = instance->_profile_cpu;
+		info.gpu     = instance->_profile_gpu;
+		info.skipped = instance->profile_skipped();
+		info.memory  = instance->_memory ? instance->_memory->total() : 0;
+		result.push_back(std::move(info));
+	}
+	return result;
+}
+#endif
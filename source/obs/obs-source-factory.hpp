@@ -6,6 +6,19 @@
 #pragma once
 #include "common.hpp"
 #include "obs-source.hpp"
+#include "obs/gs/gs-state.hpp"
+#include "util/util-memory.hpp"
+
+#ifdef ENABLE_PROFILING
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-timer.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+#endif
 
 namespace streamfx::obs {
 	template<class _factory, typename _instance>
@@ -146,6 +159,9 @@ namespace streamfx::obs {
 		static void* _create(obs_data_t* settings, obs_source_t* source) noexcept
 		{
 			try {
+				// Everything allocated while the instance is created belongs to it.
+				auto memory = ::streamfx::util::memory::owner::create(obs_source_get_name(source));
+				::streamfx::util::memory::scope memory_scope{memory};
 				return reinterpret_cast<_factory*>(obs_source_get_type_data(source))->create(settings, source);
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
@@ -236,8 +252,12 @@ namespace streamfx::obs {
 		static void _video_tick(void* data, float seconds) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					auto memory = reinterpret_cast<_instance*>(data)->memory_scope();
+					reinterpret_cast<_instance*>(data)->idle_tick(seconds);
+					reinterpret_cast<_instance*>(data)->visibility_tick();
 					reinterpret_cast<_instance*>(data)->video_tick(seconds);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -248,8 +268,20 @@ namespace streamfx::obs {
 		static void _video_render(void* data, gs_effect_t* effect) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					auto memory = reinterpret_cast<_instance*>(data)->memory_scope();
+					reinterpret_cast<_instance*>(data)->idle_reset();
+					if (!reinterpret_cast<_instance*>(data)->prepare_resources()) {
+						return;
+					}
+#ifdef ENABLE_PROFILING
+					auto profile = reinterpret_cast<_instance*>(data)->profile_render();
+#endif
+					// Whatever rendered before or after us may have changed the state behind the back of the tracker.
+					::streamfx::obs::gs::state::invalidate();
 					reinterpret_cast<_instance*>(data)->video_render(effect);
+					::streamfx::obs::gs::state::invalidate();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -260,22 +292,42 @@ namespace streamfx::obs {
 		static void _video_render_filter(void* data, gs_effect_t* effect) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					// Nobody would see the result, so render nothing at all. Staying idle lets it drop its resources too.
+					if (reinterpret_cast<_instance*>(data)->is_output_hidden()) {
+						return;
+					}
+
+					auto memory = reinterpret_cast<_instance*>(data)->memory_scope();
+					reinterpret_cast<_instance*>(data)->idle_reset();
+					if (!reinterpret_cast<_instance*>(data)->prepare_resources()) {
+						reinterpret_cast<_instance*>(data)->skip_video_filter();
+						return;
+					}
+#ifdef ENABLE_PROFILING
+					auto profile = reinterpret_cast<_instance*>(data)->profile_render();
+#endif
+					// Whatever rendered before or after us may have changed the state behind the back of the tracker.
+					::streamfx::obs::gs::state::invalidate();
 					reinterpret_cast<_instance*>(data)->video_render(effect);
+					::streamfx::obs::gs::state::invalidate();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-				obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
+				reinterpret_cast<_instance*>(data)->skip_video_filter();
 			} catch (...) {
 				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
-				obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
+				reinterpret_cast<_instance*>(data)->skip_video_filter();
 			}
 		}
 
 		static struct obs_source_frame* _filter_video(void* data, struct obs_source_frame* frame) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					auto memory = reinterpret_cast<_instance*>(data)->memory_scope();
 					return reinterpret_cast<_instance*>(data)->filter_video(frame);
+				}
 				return frame;
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
@@ -448,6 +500,7 @@ namespace streamfx::obs {
 			try {
 				auto priv = reinterpret_cast<_instance*>(data);
 				if (priv) {
+					auto     memory  = priv->memory_scope();
 					uint64_t version = static_cast<uint64_t>(obs_data_get_int(settings, S_VERSION));
 					priv->migrate(settings, version);
 					obs_data_set_int(settings, S_VERSION, static_cast<int64_t>(STREAMFX_VERSION));
@@ -464,8 +517,10 @@ namespace streamfx::obs {
 		static void _update(void* data, obs_data_t* settings) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					auto memory = reinterpret_cast<_instance*>(data)->memory_scope();
 					reinterpret_cast<_instance*>(data)->update(settings);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -503,8 +558,10 @@ namespace streamfx::obs {
 		static void _activate(void* data) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					auto memory = reinterpret_cast<_instance*>(data)->memory_scope();
 					reinterpret_cast<_instance*>(data)->activate();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -539,8 +596,10 @@ namespace streamfx::obs {
 		static void _show(void* data) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					auto memory = reinterpret_cast<_instance*>(data)->memory_scope();
 					reinterpret_cast<_instance*>(data)->show();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -830,13 +889,135 @@ namespace streamfx::obs {
 	};
 
 	class source_instance {
+		public:
+		struct color_info {
+			gs_color_space  space;
+			gs_color_format format;
+			bool            srgb;
+		};
+
 		protected:
 		::streamfx::obs::source _self;
 
+		float _idle_time;
+		float _idle_timeout;
+		bool  _idle;
+		bool  _hidden;
+
+		bool _resources;
+		bool _resources_failed;
+
+		std::shared_ptr<::streamfx::util::memory::owner> _memory;
+
+		color_info                  _color;
+		std::vector<gs_color_space> _color_preferred;
+
+#ifdef ENABLE_PROFILING
+		std::shared_ptr<::streamfx::util::profiler> _profile_cpu;
+		std::shared_ptr<::streamfx::util::profiler> _profile_gpu;
+		std::shared_ptr<::streamfx::obs::gs::timer> _profile_gpu_timer;
+		std::atomic<uint64_t>                       _profile_skipped;
+#endif
+
 		public:
-		source_instance(obs_data_t* settings, obs_source_t* source) : _self(source, false, false) {}
-		virtual ~source_instance(){};
+		source_instance(obs_data_t* settings, obs_source_t* source) : _self(source, false, false), _idle_time(0), _idle_timeout(idle_timeout()), _idle(false), _hidden(false), _resources(false), _resources_failed(false), _color{GS_CS_SRGB, GS_RGBA, false}, _color_preferred{GS_CS_SRGB}
+		{
+			// Set up by the factory while creating us, unless we were created by something else.
+			_memory = ::streamfx::util::memory::owner::current();
+			if (_memory == ::streamfx::util::memory::owner::shared()) {
+				_memory = ::streamfx::util::memory::owner::create(_self.name());
+			}
+
+#ifdef ENABLE_PROFILING
+			_profile_cpu     = ::streamfx::util::profiler::create();
+			_profile_gpu     = ::streamfx::util::profiler::create();
+			_profile_skipped = 0;
+			register_instance(this);
+#endif
+		}
+		virtual ~source_instance()
+		{
+#ifdef ENABLE_PROFILING
+			unregister_instance(this);
+			if (_profile_gpu_timer) {
+				::streamfx::obs::gs::context gctx{};
+				_profile_gpu_timer.reset();
+			}
+#endif
+		};
+
+#ifdef ENABLE_PROFILING
+		public /* Instance > Profiling */:
+		struct render_profile {
+			::streamfx::util::profiler::instance cpu;
+			::streamfx::obs::gs::timer_scope     gpu;
+		};
+
+		/** Measure CPU and GPU time of one video_render call, see profile_cpu() and profile_gpu().
+		 */
+		render_profile profile_render()
+		{
+			if (!_profile_gpu_timer && _profile_gpu) {
+				try {
+					_profile_gpu_timer = std::make_shared<::streamfx::obs::gs::timer>(_profile_gpu, _self.name());
+				} catch (...) {
+					// GPU timing is not supported here, don't try again.
+					_profile_gpu.reset();
+				}
+			}
+			return {_profile_cpu, _profile_gpu_timer};
+		}
+
+		std::shared_ptr<::streamfx::util::profiler> profile_cpu()
+		{
+			return _profile_cpu;
+		}
 
+		std::shared_ptr<::streamfx::util::profiler> profile_gpu()
+		{
+			return _profile_gpu;
+		}
+
+		uint64_t profile_skipped()
+		{
+			return _profile_skipped.load(std::memory_order_relaxed);
+		}
+
+		public /* Profiling > Registry */:
+		struct profile_info {
+			std::string                                 name;
+			std::string                                 type;
+			std::shared_ptr<::streamfx::util::profiler> cpu;
+			std::shared_ptr<::streamfx::util::profiler> gpu;
+			uint64_t                                    skipped;
+			uint64_t                                    memory;
+		};
+
+		/** Take a snapshot of every live instance and its profilers.
+		 *
+		 * The profilers are shared, so the returned data remains valid after the instance is gone.
+		 */
+		static std::vector<profile_info> profile_all();
+
+		private:
+		static void register_instance(source_instance* instance);
+		static void unregister_instance(source_instance* instance);
+#endif
+
+		public /* Instance > Memory */:
+		/** Account everything allocated on this thread to this instance, until the returned scope is gone.
+		 */
+		::streamfx::util::memory::scope memory_scope()
+		{
+			return ::streamfx::util::memory::scope{_memory};
+		}
+
+		std::shared_ptr<::streamfx::util::memory::owner> memory()
+		{
+			return _memory;
+		}
+
+		public:
 		virtual ::streamfx::obs::source get()
 		{
 			return _self;
@@ -844,16 +1025,130 @@ namespace streamfx::obs {
 
 		virtual void filter_remove(obs_source_t* source) {}
 
+		public /* Instance > Deferred Construction */:
+		/** Create what is only needed to render, like effects and render targets.
+		 *
+		 * Called in the graphics thread right before the first video_render, instead of while the instance is created.
+		 * Loading a scene collection then no longer compiles effects for filters that are never shown.
+		 */
+		virtual void create_resources() {}
+
+		/** Create the resources if that has not happened yet.
+		 *
+		 * @return true if they are ready, false if creating them failed before. A failure is only thrown once.
+		 */
+		bool prepare_resources()
+		{
+			if (!_resources && !_resources_failed) {
+				try {
+					create_resources();
+					_resources = true;
+				} catch (...) {
+					_resources_failed = true;
+					throw;
+				}
+			}
+			return _resources;
+		}
+
+		public /* Instance > Idle Eviction */:
+		/** Release GPU resources that can be recreated on the next render.
+		 *
+		 * Called in the graphics thread once the instance has not been rendered for idle_timeout() seconds, which
+		 * happens for filters on hidden or inactive sources. Implementations must recreate what they release lazily.
+		 */
+		virtual void evict() {}
+
+		void idle_tick(float seconds)
+		{
+			if (_idle || (_idle_timeout <= 0)) {
+				return;
+			}
+
+			_idle_time += seconds;
+			if (_idle_time >= _idle_timeout) {
+				_idle = true;
+				evict();
+			}
+		}
+
+		void idle_reset()
+		{
+			_idle_time = 0;
+			_idle      = false;
+		}
+
+		bool is_idle()
+		{
+			return _idle;
+		}
+
+		/** Seconds without a render after which evict() is called, or 0 if eviction is disabled.
+		 */
+		static float idle_timeout();
+
+		public /* Instance > Visibility */:
+		/** Find out whether anything this filter renders could end up being seen, see is_output_hidden().
+		 *
+		 * Called every tick. For performance, scenes are only walked once per frame, no matter how many filters ask.
+		 */
+		void visibility_tick();
+
+		/** Whether the output of this filter can not be seen, as of the last tick.
+		 *
+		 * That is the case if every scene item the parent is shown through is scaled to nothing or cropped away, or if
+		 * a later filter in the chain is a color correction with no opacity left. Sources that are shown in some other
+		 * way, like through a projector, count as visible, as do sources merely covered by something else.
+		 */
+		bool is_output_hidden()
+		{
+			return _hidden;
+		}
+
+		public /* Instance > Color Space */:
+		/** Find out which space 'source' renders in when asked for 'preferred_spaces', and how to hold that.
+		 *
+		 * Only the 16-bit float and extended range spaces get RGBA16F, everything else stays in 8 bits per channel.
+		 */
+		static color_info query_color_space(obs_source_t* source, size_t count, const gs_color_space* preferred_spaces);
+
+		/** Agree on the working space of this instance with 'source', which usually is the filter target.
+		 *
+		 * 'source' is asked for the spaces preferred by whoever rendered this instance last, which are only HDR ones if
+		 * the canvas is HDR. The default video_get_color_space() reports the result back, so in a chain of filters that
+		 * all do this, everyone works in the space of the original source and nothing has to be converted in between.
+		 */
+		color_info const& negotiate_color_space(obs_source_t* source);
+
+		/** The working space from the last negotiate_color_space(), sRGB until then. */
+		color_info const& color_space()
+		{
+			return _color;
+		}
+
 		public /* Instance > Video */:
 		virtual gs_color_space video_get_color_space(size_t count, const gs_color_space* preferred_spaces)
 		{
-			return GS_CS_SRGB;
+			if (count && preferred_spaces) {
+				_color_preferred.assign(preferred_spaces, preferred_spaces + count);
+			}
+			return _color.space;
 		}
 
 		virtual void video_tick(float_t seconds) {}
 
 		virtual void video_render(gs_effect_t* effect) {}
 
+		/** Skip rendering of this filter for the current frame, and count it as skipped.
+		 */
+		void skip_video_filter()
+		{
+#ifdef ENABLE_PROFILING
+			_profile_skipped.fetch_add(1, std::memory_order_relaxed);
+#endif
+			obs_source_skip_video_filter(_self);
+		}
+
 		virtual struct obs_source_frame* filter_video(struct obs_source_frame* frame)
 		{
 			return frame;
@@ -0,0 +1,93 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "obs-source-handoff.hpp"
+
+#include "warning-disable.hpp"
+#include <mutex>
+#include <optional>
+#include <set>
+#include "warning-enable.hpp"
+
+namespace {
+	struct request {
+		obs_source_t*                                 source;
+		uint32_t                                      width;
+		uint32_t                                      height;
+		std::optional<streamfx::obs::handoff::result> value;
+	};
+
+	std::mutex              offers_lock;
+	std::set<obs_source_t*> offers;
+
+	// Filters render the filter below them from within their own render, so requests nest.
+	thread_local request* current = nullptr;
+} // namespace
+
+void streamfx::obs::handoff::offer(obs_source_t* self, bool enabled)
+{
+	std::lock_guard<std::mutex> lock(offers_lock);
+	if (enabled) {
+		offers.insert(self);
+	} else {
+		offers.erase(self);
+	}
+}
+
+bool streamfx::obs::handoff::receive(obs_source_t* source, std::shared_ptr<::streamfx::obs::gs::rendertarget> const& target, uint32_t width, uint32_t height, result& value)
+{
+	{
+		std::lock_guard<std::mutex> lock(offers_lock);
+		if (offers.find(source) == offers.end()) {
+			return false;
+		}
+	}
+
+	request req{source, width, height, std::nullopt};
+	auto    previous = current;
+	current          = &req;
+	{
+		// Anything drawn instead of handed over lands here, as if it had been captured.
+		auto op = target->render(width, height);
+		gs_matrix_push();
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -100., 100.);
+
+		vec4 blank = vec4{0, 0, 0, 0};
+		gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
+
+		gs_blend_state_push();
+		gs_enable_color(true, true, true, true);
+		gs_enable_blending(false);
+		gs_enable_depth_test(false);
+		gs_enable_stencil_test(false);
+		gs_set_cull_mode(GS_NEITHER);
+
+		obs_source_video_render(source);
+
+		gs_blend_state_pop();
+		gs_matrix_pop();
+	}
+	current = previous;
+
+	if (req.value) {
+		value = req.value.value();
+	} else {
+		value.color = target->get_texture();
+		value.alpha = value.color;
+	}
+	return true;
+}
+
+bool streamfx::obs::handoff::provide(obs_source_t* self, result const& value)
+{
+	if (!current || (current->source != self) || !value.color || !value.alpha) {
+		return false;
+	}
+	if ((value.color->get_width() != current->width) || (value.color->get_height() != current->height)) {
+		return false;
+	}
+
+	current->value = value;
+	return true;
+}
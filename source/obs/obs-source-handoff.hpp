@@ -0,0 +1,41 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::handoff {
+	/** Result of a filter, split into the color it produced and the texture its alpha comes from. */
+	struct result {
+		std::shared_ptr<::streamfx::obs::gs::texture> color;
+		std::shared_ptr<::streamfx::obs::gs::texture> alpha;
+	};
+
+	/** Tell filters above this one whether it can hand over its result instead of drawing it.
+	 *
+	 * Filters that offer must call provide() at the end of every render, and only draw if that returned false.
+	 */
+	void offer(obs_source_t* self, bool enabled);
+
+	/** Render the filter below, and take its result directly if it offered to hand it over.
+	 *
+	 * Otherwise the filter below draws into 'target' at the given size, in the same way as a capture without a region
+	 * of interest would, and the result points at that.
+	 *
+	 * @return false if the filter below never offered, in which case nothing was rendered and it must be captured.
+	 */
+	bool receive(obs_source_t* source, std::shared_ptr<::streamfx::obs::gs::rendertarget> const& target, uint32_t width, uint32_t height, result& value);
+
+	/** Hand the result over to the filter above, if it asked for it and the size matches what it expects.
+	 *
+	 * @return true if the result was taken, in which case nothing must be drawn.
+	 */
+	bool provide(obs_source_t* self, result const& value);
+} // namespace streamfx::obs::handoff
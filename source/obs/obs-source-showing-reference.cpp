@@ -3,3 +3,45 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "obs-source-showing-reference.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <mutex>
+#include "warning-enable.hpp"
+
+std::shared_ptr<streamfx::obs::source_showing_reference> streamfx::obs::source_showing_reference::add_showing_reference(::streamfx::obs::source& source)
+{
+	static std::mutex                                                       lock;
+	static std::map<obs_source_t*, std::weak_ptr<source_showing_reference>> references;
+
+	// Sources may be destroyed and another one created at the same address, so check who is actually referenced.
+	auto find = [&source]() -> std::shared_ptr<source_showing_reference> {
+		auto iter = references.find(source.get());
+		if (iter != references.end()) {
+			if (auto ref = iter->second.lock(); ref && (ref->_target == source)) {
+				return ref;
+			}
+		}
+		return nullptr;
+	};
+
+	{
+		std::lock_guard<std::mutex> lg(lock);
+		if (auto ref = find(); ref) {
+			return ref;
+		}
+	}
+
+	// libobs may call back into us while it marks the source, for example from filters on it, so never hold the lock.
+	auto ref = std::make_shared<source_showing_reference>(source);
+
+	std::lock_guard<std::mutex> lg(lock);
+	if (auto other = find(); other) {
+		return other; // Someone else was faster, so ours goes away again.
+	}
+	for (auto iter = references.begin(); iter != references.end();) {
+		iter = iter->second.expired() ? references.erase(iter) : std::next(iter);
+	}
+	references[source.get()] = ref;
+	return ref;
+}
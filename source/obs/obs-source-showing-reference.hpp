@@ -26,9 +26,7 @@ namespace streamfx::obs {
 		}
 
 		public:
-		static FORCE_INLINE std::shared_ptr<source_showing_reference> add_showing_reference(::streamfx::obs::source& source)
-		{
-			return std::make_shared<source_showing_reference>(source);
-		}
+		/** Mark the source as showing, sharing one libobs reference with everyone else who already did. */
+		static std::shared_ptr<source_showing_reference> add_showing_reference(::streamfx::obs::source& source);
 	};
 } // namespace streamfx::obs
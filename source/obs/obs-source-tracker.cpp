@@ -8,6 +8,7 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <mutex>
 #include <stdexcept>
 #include "warning-enable.hpp"
@@ -26,7 +27,7 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
-streamfx::obs::source_tracker::source_tracker() : _sources(), _mutex()
+streamfx::obs::source_tracker::source_tracker() : _sources(), _snapshot(), _mutex(), _pending(), _batching(false), _rename_listeners()
 {
 	auto osi = obs_get_signal_handler();
 	if (osi) {
@@ -57,39 +58,218 @@ streamfx::obs::source_tracker::~source_tracker()
 	}
 
 	this->_sources.clear();
+	this->_pending.clear();
+	this->_snapshot.reset();
 }
 
 void streamfx::obs::source_tracker::enumerate(enumerate_cb_t ecb, filter_cb_t fcb)
 {
-	// Need func-local copy, otherwise we risk corruption if a new source is created or destroyed.
-	decltype(_sources) _clone;
-	{
-		std::lock_guard<decltype(_mutex)> lock(_mutex);
-		_clone = _sources;
+	// The snapshot never changes, so nothing that happens to sources in the meantime can corrupt it.
+	auto view = get_snapshot();
+
+	// The built-in filters already have an index, so they don't need to be called for every source.
+	const std::vector<size_t>* index = nullptr;
+	if (auto cat = category_of(fcb); cat) {
+		index = &view->categories[*cat];
 	}
 
-	for (auto kv : _clone) {
-		auto wsource = kv.second;
+	// Returns true if the enumeration should stop.
+	auto visit = [&](const std::pair<std::string, ::streamfx::obs::weak_source>& kv) {
 		try {
-			auto source = wsource.lock();
+			auto source = kv.second.lock();
 
-			if (fcb) {
+			if (index) {
+				if (!source) {
+					return false;
+				}
+			} else if (fcb) {
 				if (fcb(kv.first, source)) {
-					continue;
+					return false;
 				}
 			}
 
 			if (ecb) {
-				if (ecb(kv.first, source)) {
-					break;
-				}
+				return ecb(kv.first, source);
 			}
 		} catch (...) {
-			continue;
+		}
+		return false;
+	};
+
+	if (index) {
+		for (auto idx : *index) {
+			if (visit(view->sources[idx])) {
+				break;
+			}
+		}
+	} else {
+		for (auto& kv : view->sources) {
+			if (visit(kv)) {
+				break;
+			}
 		}
 	}
 }
 
+void streamfx::obs::source_tracker::populate(obs_property_t* list, filter_cb_t fcb, std::string_view suffix)
+{
+	auto cat = category_of(fcb);
+	if (!cat) {
+		std::string tail = " (" + std::string{suffix} + ")";
+		enumerate(
+			[list, &tail](std::string name, ::streamfx::obs::source) {
+				obs_property_list_add_string(list, (name + tail).c_str(), name.c_str());
+				return false;
+			},
+			fcb);
+		return;
+	}
+
+	// Destroyed sources replace the snapshot, so every name in it still belongs to a source and none need locking.
+	auto view = get_snapshot();
+	auto key  = std::pair<size_t, std::string>{*cat, std::string{suffix}};
+
+	std::lock_guard<decltype(view->labels_lock)> lock(view->labels_lock);
+	auto                                         labels = view->labels.find(key);
+	if (labels == view->labels.end()) {
+		auto const&              index = view->categories[*cat];
+		std::vector<std::string> names;
+		names.reserve(index.size());
+		for (auto idx : index) {
+			names.push_back(view->sources[idx].first + " (" + key.second + ")");
+		}
+		labels = view->labels.emplace(std::move(key), std::move(names)).first;
+	}
+
+	auto const& index = view->categories[*cat];
+	for (size_t idx = 0; idx < index.size(); idx++) {
+		obs_property_list_add_string(list, labels->second[idx].c_str(), view->sources[index[idx]].first.c_str());
+	}
+}
+
+streamfx::obs::weak_source streamfx::obs::source_tracker::find(std::string_view name)
+{
+	std::lock_guard<decltype(_mutex)> lock(_mutex);
+	apply_pending();
+	if (auto kv = _sources.find(std::string{name}); kv != _sources.end()) {
+		return kv->second.source;
+	}
+	return {};
+}
+
+std::shared_ptr<streamfx::obs::source_tracker::rename_cb_t> streamfx::obs::source_tracker::listen_rename(rename_cb_t cb)
+{
+	auto handle = std::make_shared<rename_cb_t>(std::move(cb));
+
+	std::lock_guard<decltype(_mutex)> lock(_mutex);
+	_rename_listeners.remove_if([](std::weak_ptr<rename_cb_t> const& v) { return v.expired(); });
+	_rename_listeners.push_back(handle);
+	return handle;
+}
+
+void streamfx::obs::source_tracker::begin_batch()
+{
+	std::lock_guard<decltype(_mutex)> lock(_mutex);
+	_batching = true;
+}
+
+void streamfx::obs::source_tracker::end_batch()
+{
+	std::lock_guard<decltype(_mutex)> lock(_mutex);
+	_batching = false;
+	apply_pending();
+}
+
+std::shared_ptr<const streamfx::obs::source_tracker::snapshot> streamfx::obs::source_tracker::get_snapshot()
+{
+	std::lock_guard<decltype(_mutex)> lock(_mutex);
+	apply_pending();
+	if (_snapshot) {
+		return _snapshot;
+	}
+
+	// Only rebuilt after sources were created, destroyed or renamed, instead of copied for every enumeration.
+	auto view = std::make_shared<snapshot>();
+	view->sources.reserve(_sources.size());
+	for (auto& kv : _sources) {
+		view->sources.emplace_back(kv.first, kv.second.source);
+	}
+	std::sort(view->sources.begin(), view->sources.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	for (size_t idx = 0; idx < view->sources.size(); idx++) {
+		uint8_t categories = _sources[view->sources[idx].first].categories;
+		for (size_t cat = 0; cat < view->categories.size(); cat++) {
+			if (categories & (1 << cat)) {
+				view->categories[cat].push_back(idx);
+			}
+		}
+	}
+
+	_snapshot = view;
+	return _snapshot;
+}
+
+std::optional<size_t> streamfx::obs::source_tracker::category_of(const filter_cb_t& fcb)
+{
+	if (fcb) {
+		if (auto fn = fcb.target<bool (*)(std::string, ::streamfx::obs::source)>(); fn) {
+			if (*fn == &filter_sources) {
+				return static_cast<size_t>(category::Sources);
+			} else if (*fn == &filter_audio_sources) {
+				return static_cast<size_t>(category::AudioSources);
+			} else if (*fn == &filter_video_sources) {
+				return static_cast<size_t>(category::VideoSources);
+			} else if (*fn == &filter_transitions) {
+				return static_cast<size_t>(category::Transitions);
+			} else if (*fn == &filter_scenes) {
+				return static_cast<size_t>(category::Scenes);
+			}
+		}
+	}
+	return std::nullopt;
+}
+
+uint8_t streamfx::obs::source_tracker::categorize(obs_source_t* source)
+{
+	uint8_t  categories = 0;
+	uint32_t flags      = obs_source_get_output_flags(source);
+	switch (obs_source_get_type(source)) {
+	case OBS_SOURCE_TYPE_INPUT:
+		categories |= 1 << static_cast<uint8_t>(category::Sources);
+		if (flags & OBS_SOURCE_AUDIO) {
+			categories |= 1 << static_cast<uint8_t>(category::AudioSources);
+		}
+		if (flags & OBS_SOURCE_VIDEO) {
+			categories |= 1 << static_cast<uint8_t>(category::VideoSources);
+		}
+		break;
+	case OBS_SOURCE_TYPE_TRANSITION:
+		categories |= 1 << static_cast<uint8_t>(category::Transitions);
+		break;
+	case OBS_SOURCE_TYPE_SCENE:
+		categories |= 1 << static_cast<uint8_t>(category::Scenes);
+		break;
+	default:
+		break;
+	}
+	return categories;
+}
+
+void streamfx::obs::source_tracker::apply_pending()
+{
+	if (_pending.empty()) {
+		return;
+	}
+
+	// Earlier entries win over later ones with the same name, as if they had been inserted one by one.
+	_sources.reserve(_sources.size() + _pending.size());
+	for (auto& kv : _pending) {
+		_sources.emplace(std::move(kv.first), std::move(kv.second));
+	}
+	_pending.clear();
+	_snapshot.reset();
+}
+
 void streamfx::obs::source_tracker::insert_source(obs_source_t* source)
 {
 	const char* name = obs_source_get_name(source);
@@ -101,27 +281,38 @@ void streamfx::obs::source_tracker::insert_source(obs_source_t* source)
 	}
 
 	// Insert the newly tracked source into the map.
+	entry value{::streamfx::obs::weak_source{source}, categorize(source)};
+
 	std::lock_guard<decltype(_mutex)> lock(_mutex);
-	_sources.emplace(std::string{name}, ::streamfx::obs::weak_source{source});
+	if (_batching) {
+		_pending.emplace_back(std::string{name}, std::move(value));
+		return;
+	}
+	if (_sources.emplace(std::string{name}, std::move(value)).second) {
+		_snapshot.reset();
+	}
 }
 
 void streamfx::obs::source_tracker::remove_source(obs_source_t* source)
 {
 	std::lock_guard<decltype(_mutex)> lock(_mutex);
 	const char*                       name = obs_source_get_name(source);
+	apply_pending();
 
 	// Try and find the source by name.
 	if (name) {
 		if (auto kv = _sources.find(std::string{name}); kv != _sources.end()) {
 			_sources.erase(kv);
+			_snapshot.reset();
 			return;
 		}
 	}
 
 	// Try and find the source by pointer.
 	for (auto kv = _sources.begin(); kv != _sources.end(); kv++) {
-		if (kv->second == source) {
+		if (kv->second.source == source) {
 			_sources.erase(kv);
+			_snapshot.reset();
 			return;
 		}
 	}
@@ -139,15 +330,33 @@ void streamfx::obs::source_tracker::rename_source(std::string_view old_name, std
 		throw std::runtime_error("New and old name are identical.");
 	}
 
-	std::lock_guard<decltype(_mutex)> lock(_mutex);
+	entry value{::streamfx::obs::weak_source{source}, categorize(source)};
 
-	// Remove the previously tracked entry.
-	if (auto kv = _sources.find(std::string{old_name}); kv != _sources.end()) {
-		_sources.erase(kv);
+	std::list<std::shared_ptr<rename_cb_t>> listeners;
+	{
+		std::lock_guard<decltype(_mutex)> lock(_mutex);
+		apply_pending();
+
+		// Remove the previously tracked entry.
+		if (auto kv = _sources.find(std::string{old_name}); kv != _sources.end()) {
+			_sources.erase(kv);
+		}
+
+		// And then add the new entry.
+		_sources.emplace(std::string{new_name}, std::move(value));
+		_snapshot.reset();
+
+		for (auto const& weak : _rename_listeners) {
+			if (auto listener = weak.lock(); listener) {
+				listeners.push_back(listener);
+			}
+		}
 	}
 
-	// And then add the new entry.
-	_sources.emplace(std::string{new_name}, ::streamfx::obs::weak_source{source});
+	// Listeners may look up sources themselves, so they are called without holding the lock.
+	for (auto const& listener : listeners) {
+		(*listener)(old_name, new_name);
+	}
 }
 
 bool streamfx::obs::source_tracker::filter_sources(std::string, ::streamfx::obs::source source)
@@ -7,15 +7,50 @@
 #include "obs/obs-weak-source.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
 #include <functional>
+#include <list>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::obs {
 	class source_tracker {
-		std::map<std::string, ::streamfx::obs::weak_source> _sources;
-		std::mutex                                          _mutex;
+		// Categories selected by the built-in filters, which are indexed ahead of time instead of filtered every time.
+		enum class category : uint8_t {
+			Sources,
+			AudioSources,
+			VideoSources,
+			Transitions,
+			Scenes,
+			_COUNT,
+		};
+
+		struct entry {
+			::streamfx::obs::weak_source source;
+			uint8_t                      categories;
+		};
+
+		// Read-only view of all tracked sources sorted by name, shared by every enumeration until something changes.
+		struct snapshot {
+			std::vector<std::pair<std::string, ::streamfx::obs::weak_source>>      sources;
+			std::array<std::vector<size_t>, static_cast<size_t>(category::_COUNT)> categories;
+
+			// Display names for property lists, built on first use per category and suffix.
+			mutable std::mutex                                                      labels_lock;
+			mutable std::map<std::pair<size_t, std::string>, std::vector<std::string>> labels;
+		};
+
+		std::unordered_map<std::string, entry>     _sources;
+		std::shared_ptr<const snapshot>            _snapshot;
+		std::mutex                                 _mutex;
+		std::vector<std::pair<std::string, entry>> _pending;
+		bool                                       _batching;
 
 		public:
 		// Callback function for enumerating sources.
@@ -32,7 +67,15 @@ namespace streamfx::obs {
 		// @return true to skip, false to pass along.
 		typedef std::function<bool(std::string, ::streamfx::obs::source)> filter_cb_t;
 
+		// Callback function for renamed sources.
+		//
+		// @param std::string_view Previous name of the Source
+		// @param std::string_view New name of the Source
+		typedef std::function<void(std::string_view, std::string_view)> rename_cb_t;
+
 		private:
+		std::list<std::weak_ptr<rename_cb_t>> _rename_listeners;
+
 		source_tracker();
 
 		public:
@@ -44,7 +87,40 @@ namespace streamfx::obs {
 		// @param filter_cb Filter function to narrow down results.
 		void enumerate(enumerate_cb_t enumerate_cb, filter_cb_t filter_cb = nullptr);
 
+		//! Add all tracked sources to a property list, as "Name (Suffix)" with the name as the value.
+		//
+		// The built-in filters reuse the names of the current snapshot, so properties dialogs no longer touch every
+		// source each time they are refreshed. Other filters fall back to enumerate().
+		//
+		// @param list The property list to add to.
+		// @param filter_cb Filter function to narrow down results.
+		// @param suffix Shown in parentheses after each name.
+		void populate(obs_property_t* list, filter_cb_t filter_cb, std::string_view suffix);
+
+		//! Find a tracked source by its exact name, without going through libobs.
+		//
+		// @return The source, or an empty reference if there is none by that name.
+		::streamfx::obs::weak_source find(std::string_view name);
+
+		//! Listen for sources being renamed, for as long as the returned handle is kept alive.
+		std::shared_ptr<rename_cb_t> listen_rename(rename_cb_t cb);
+
+		//! Queue created sources instead of indexing them one by one, for while a scene collection loads.
+		//
+		// Queued sources are indexed in one pass by end_batch(), or as soon as anything looks them up.
+		void begin_batch();
+
+		void end_batch();
+
 		protected:
+		std::shared_ptr<const snapshot> get_snapshot();
+
+		static std::optional<size_t> category_of(const filter_cb_t& filter_cb);
+
+		static uint8_t categorize(obs_source_t* source);
+
+		void apply_pending();
+
 		void insert_source(obs_source_t* source);
 		void remove_source(obs_source_t* source);
 		void rename_source(std::string_view old_name, std::string_view new_name, obs_source_t* source);
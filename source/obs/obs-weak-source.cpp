@@ -3,3 +3,36 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "obs-weak-source.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include "warning-enable.hpp"
+
+static std::atomic<uint64_t> generation_counter{1};
+
+static void invalidate_handler(void*, calldata_t*) noexcept
+{
+	generation_counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t streamfx::obs::weak_source::generation() noexcept
+{
+	return generation_counter.load(std::memory_order_relaxed);
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		if (auto osi = obs_get_signal_handler(); osi) {
+			signal_handler_connect(osi, "source_remove", &invalidate_handler, nullptr);
+			signal_handler_connect(osi, "source_destroy", &invalidate_handler, nullptr);
+		}
+	},
+	[]() { // Finalizer
+		if (auto osi = obs_get_signal_handler(); osi) {
+			signal_handler_disconnect(osi, "source_remove", &invalidate_handler, nullptr);
+			signal_handler_disconnect(osi, "source_destroy", &invalidate_handler, nullptr);
+		}
+		invalidate_handler(nullptr, nullptr);
+	},
+	streamfx::loader_priority::HIGHEST); // Does not rely on other critical functionality.
@@ -17,6 +17,11 @@ namespace streamfx::obs {
 	class weak_source {
 		obs_weak_source_t* _ref;
 
+		// Hard reference from the most recent resolve(), see there.
+		mutable ::streamfx::obs::source _cache;
+		mutable uint64_t                _cache_frame;
+		mutable uint64_t                _cache_generation;
+
 		public:
 		FORCE_INLINE ~weak_source() noexcept
 		{
@@ -29,13 +34,13 @@ namespace streamfx::obs {
 		 *
 		 * The weak source will be expired, as it points at nothing.
 		 */
-		FORCE_INLINE weak_source() : _ref(nullptr){};
+		FORCE_INLINE weak_source() : _ref(nullptr), _cache(), _cache_frame(0), _cache_generation(0){};
 
 		/** Create a new weak reference from an existing pointer.
 		 *
 		 * @param duplicate If true, will duplicate the pointer instead of taking ownership.
 		 */
-		FORCE_INLINE weak_source(obs_weak_source_t* source, bool duplicate = true) : _ref(source)
+		FORCE_INLINE weak_source(obs_weak_source_t* source, bool duplicate = true) : _ref(source), _cache(), _cache_frame(0), _cache_generation(0)
 		{
 			if (!_ref)
 				throw std::invalid_argument("Parameter 'source' does not define a valid source.");
@@ -45,7 +50,7 @@ namespace streamfx::obs {
 
 		/** Create a new weak reference from an existing hard reference.
 		 */
-		FORCE_INLINE weak_source(obs_source_t* source)
+		FORCE_INLINE weak_source(obs_source_t* source) : _cache(), _cache_frame(0), _cache_generation(0)
 		{
 			_ref = obs_source_get_weak_source(source);
 			if (!_ref)
@@ -54,7 +59,7 @@ namespace streamfx::obs {
 
 		/** Create a new weak reference from an existing hard reference.
 		 */
-		FORCE_INLINE weak_source(const ::streamfx::obs::source& source)
+		FORCE_INLINE weak_source(const ::streamfx::obs::source& source) : _cache(), _cache_frame(0), _cache_generation(0)
 		{
 			_ref = obs_source_get_weak_source(source.get());
 			if (!_ref)
@@ -65,7 +70,7 @@ namespace streamfx::obs {
 		 *
 		 * Attention: May fail if the name does not exactly match.
 		 */
-		FORCE_INLINE weak_source(std::string_view name)
+		FORCE_INLINE weak_source(std::string_view name) : _cache(), _cache_frame(0), _cache_generation(0)
 		{
 			std::shared_ptr<obs_source_t> ref{obs_get_source_by_name(name.data()), [](obs_source_t* v) { obs_source_release(v); }};
 			if (!ref) {
@@ -78,7 +83,7 @@ namespace streamfx::obs {
 		/** Move Constructor
 		 * 
 		 */
-		FORCE_INLINE weak_source(::streamfx::obs::weak_source&& move) noexcept
+		FORCE_INLINE weak_source(::streamfx::obs::weak_source&& move) noexcept : _cache(), _cache_frame(0), _cache_generation(0)
 		{
 			_ref      = move._ref;
 			move._ref = nullptr;
@@ -87,7 +92,7 @@ namespace streamfx::obs {
 		/** Copy Constructor
 		 * 
 		 */
-		FORCE_INLINE weak_source(const ::streamfx::obs::weak_source& copy) noexcept
+		FORCE_INLINE weak_source(const ::streamfx::obs::weak_source& copy) noexcept : _cache(), _cache_frame(0), _cache_generation(0)
 		{
 			_ref = copy._ref;
 			obs_weak_source_addref(_ref);
@@ -136,6 +141,7 @@ namespace streamfx::obs {
 		 */
 		FORCE_INLINE void reset() noexcept
 		{
+			_cache = {};
 			if (_ref) {
 				obs_weak_source_release(_ref);
 				_ref = nullptr;
@@ -160,6 +166,29 @@ namespace streamfx::obs {
 			return {obs_weak_source_get_source(_ref)};
 		};
 
+		/** Acquire a hard reference, reusing the one acquired earlier in the same frame.
+		 *
+		 * Only the first call in each frame touches the reference count, every other call just reads the cached
+		 * reference. It is thrown away whenever any source is removed or destroyed, and is otherwise kept until the next
+		 * call in a later frame or until this weak reference is reset.
+		 *
+		 * Attention: Not thread-safe, only call this from one thread per instance (usually the graphics thread).
+		 */
+		FORCE_INLINE ::streamfx::obs::source const& resolve() const noexcept
+		{
+			uint64_t frame = obs_get_video_frame_time();
+			uint64_t gen   = generation();
+			if ((_cache_frame != frame) || (_cache_generation != gen) || !_cache) {
+				_cache            = lock();
+				_cache_frame      = frame;
+				_cache_generation = gen;
+			}
+			return _cache;
+		};
+
+		/** Incremented whenever a source is removed or destroyed, invalidating every cached resolve(). */
+		static uint64_t generation() noexcept;
+
 		public /* Type Conversion Operators */:
 		FORCE_INLINE operator obs_weak_source_t*() const noexcept
 		{
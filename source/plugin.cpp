@@ -30,12 +30,18 @@
 static std::shared_ptr<streamfx::gfx::opengl> _streamfx_gfx_opengl;
 
 namespace streamfx {
-	typedef std::list<loader_function_t>               loader_list_t;
-	typedef std::map<loader_priority_t, loader_list_t> loader_map_t;
+	struct loader_entry {
+		loader_function_t preparer;
+		loader_function_t initializer;
+	};
 
-	loader_map_t& get_initializers()
+	typedef std::list<loader_function_t>                         loader_list_t;
+	typedef std::map<loader_priority_t, loader_list_t>           loader_map_t;
+	typedef std::map<loader_priority_t, std::list<loader_entry>> loader_entry_map_t;
+
+	loader_entry_map_t& get_initializers()
 	{
-		static loader_map_t initializers;
+		static loader_entry_map_t initializers;
 		return initializers;
 	}
 
@@ -45,14 +51,11 @@ namespace streamfx {
 		return finalizers;
 	}
 
-	loader::loader(loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority)
+	loader::loader(loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority) : loader(nullptr, initializer, finalizer, priority) {}
+
+	loader::loader(loader_function_t preparer, loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority)
 	{
-		auto init_kv = get_initializers().find(priority);
-		if (init_kv != get_initializers().end()) {
-			init_kv->second.push_back(initializer);
-		} else {
-			get_initializers().emplace(priority, loader_list_t{initializer});
-		}
+		get_initializers()[priority].push_back(loader_entry{preparer, initializer});
 
 		// Invert the order for finalizers.
 		auto ipriority = priority ^ static_cast<loader_priority_t>(0xFFFFFFFFFFFFFFFF);
@@ -88,11 +91,37 @@ MODULE_EXPORT bool obs_module_load(void)
 		}
 #endif
 
-		// Run all initializers.
-		for (auto kv : streamfx::get_initializers()) {
-			for (auto init : kv.second) {
+		// Start all preparers at once, so that slow work like loading libraries overlaps.
+		auto                                                                                       pool = streamfx::threadpool();
+		std::map<const streamfx::loader_entry*, std::shared_ptr<streamfx::util::threadpool::task>> preparations;
+		for (auto& kv : streamfx::get_initializers()) {
+			for (auto& entry : kv.second) {
+				if (!entry.preparer) {
+					continue;
+				}
+
+				const streamfx::loader_entry* ptr = &entry;
+				preparations.emplace(ptr, pool->push([ptr](streamfx::util::threadpool::task_data_t) {
+					try {
+						ptr->preparer();
+					} catch (const std::exception& ex) {
+						DLOG_ERROR("Preparer threw exception: %s", ex.what());
+					} catch (...) {
+						DLOG_ERROR("Preparer threw unknown exception.");
+					}
+				}));
+			}
+		}
+
+		// Run all initializers, each once its preparer is done.
+		for (auto& kv : streamfx::get_initializers()) {
+			for (auto& entry : kv.second) {
+				if (auto task_kv = preparations.find(&entry); task_kv != preparations.end()) {
+					task_kv->second->wait();
+				}
+
 				try {
-					init();
+					entry.initializer();
 				} catch (const std::exception& ex) {
 					DLOG_ERROR("Initializer threw exception: %s", ex.what());
 				} catch (...) {
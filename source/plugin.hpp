@@ -30,8 +30,16 @@ namespace streamfx {
 	struct loader {
 		loader(loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority);
 
+		/** Same as above, with a preparer that runs on the threadpool while the plugin loads.
+		 *
+		 * All preparers start together, and each initializer waits for its own preparer before running in the usual
+		 * order. Preparers must not register anything with OBS or enter the graphics context.
+		 */
+		loader(loader_function_t preparer, loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority);
+
 		// Usage:
 		// auto loader = streamfx::loader([]() { ... }, []() { ... }, 0);
+		// auto loader = streamfx::loader([]() { ... }, []() { ... }, []() { ... }, 0);
 	};
 
 	// Threadpool
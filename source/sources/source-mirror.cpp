@@ -62,37 +62,31 @@ using namespace streamfx::source::mirror;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Source-Mirror";
 
-mirror_audio_data::mirror_audio_data(const audio_data* audio, speaker_layout layout)
+mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _source(), _source_texture(), _signal_rename(), _audio_enabled(false), _audio_layout(SPEAKERS_UNKNOWN), _audio_slots(), _audio_head(0), _audio_tail(0), _audio_waiting(false), _audio_stop(false), _audio_lock(), _audio_cv(), _audio_thread()
 {
-	// Build a clone of a packet.
-	audio_t*                 oad = obs_get_audio();
-	const audio_output_info* aoi = audio_output_get_info(oad);
-	osa.frames                   = audio->frames;
-	osa.timestamp                = audio->timestamp;
-	osa.speakers                 = layout;
-	osa.format                   = aoi->format;
-	osa.samples_per_sec          = aoi->samples_per_sec;
-	data.resize(MAX_AV_PLANES);
-	for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
-		if (!audio->data[idx]) {
-			osa.data[idx] = nullptr;
-			continue;
+	// Preallocate room for the usual packet size, so that the audio callback doesn't have to.
+	for (auto& slot : _audio_slots) {
+		for (auto& plane : slot.data) {
+			plane.reserve(AUDIO_OUTPUT_FRAMES * sizeof(float));
 		}
-
-		data[idx].resize(audio->frames * get_audio_bytes_per_channel(osa.format));
-		memcpy(data[idx].data(), audio->data[idx], data[idx].size());
-		osa.data[idx] = data[idx].data();
 	}
-}
+	_audio_thread = std::thread(&mirror_instance::audio_output, this);
 
-mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _source(), _source_child(), _signal_rename(), _audio_enabled(false), _audio_layout(SPEAKERS_UNKNOWN)
-{
 	update(settings);
 }
 
 mirror_instance::~mirror_instance()
 {
 	release();
+
+	{
+		std::lock_guard<std::mutex> lock(_audio_lock);
+		_audio_stop = true;
+	}
+	_audio_cv.notify_all();
+	if (_audio_thread.joinable()) {
+		_audio_thread.join();
+	}
 }
 
 uint32_t mirror_instance::get_width()
@@ -155,8 +149,24 @@ void mirror_instance::video_render(gs_effect_t* effect)
 
 	_source_size.first  = obs_source_get_width(_source.get());
 	_source_size.second = obs_source_get_height(_source.get());
+	if ((_source_size.first == 0) || (_source_size.second == 0)) {
+		return;
+	}
+
+	// Every mirror of the same source shares one render of it per frame.
+	auto texture = _source_texture->render(_source_size.first, _source_size.second);
+	if (!texture) {
+		return;
+	}
 
-	obs_source_video_render(_source.get());
+	gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+	gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), texture->get_object());
+	while (gs_effect_loop(default_effect, "Draw")) {
+		gs_draw_sprite(nullptr, 0, _source_size.first, _source_size.second);
+	}
+	gs_blend_state_pop();
 }
 
 void mirror_instance::enum_active_sources(obs_source_enum_proc_t cb, void* ptr)
@@ -186,7 +196,7 @@ void mirror_instance::acquire(std::string source_name)
 		}
 
 		// Everything went well, store.
-		_source_child       = std::make_shared<::streamfx::obs::source_active_child>(_self, source);
+		_source_texture     = std::make_shared<::streamfx::gfx::source_texture>(source, ::streamfx::obs::source{_self, false});
 		_source             = std::move(source);
 		_source_size.first  = obs_source_get_width(_source);
 		_source_size.second = obs_source_get_height(_source);
@@ -205,7 +215,7 @@ void mirror_instance::release()
 {
 	_signal_audio.reset();
 	_signal_rename.reset();
-	_source_child.reset();
+	_source_texture.reset();
 	_source.release();
 }
 
@@ -253,21 +263,55 @@ void mirror_instance::on_audio(::streamfx::obs::source, const audio_data* audio,
 		}
 	}
 
-	{
-		std::unique_lock<std::mutex> ul(_audio_queue_lock);
-		_audio_queue.emplace(audio, detected_layout);
+	// Drop the packet if the consumer is too far behind, as blocking the audio thread would be worse.
+	size_t head = _audio_head.load(std::memory_order_relaxed);
+	if ((head - _audio_tail.load(std::memory_order_acquire)) >= _audio_slots.size()) {
+		return;
+	}
+
+	// Build a clone of the packet in the next free slot.
+	auto&                    slot = _audio_slots[head % _audio_slots.size()];
+	audio_t*                 oad  = obs_get_audio();
+	const audio_output_info* aoi  = audio_output_get_info(oad);
+	slot.osa.frames               = audio->frames;
+	slot.osa.timestamp            = audio->timestamp;
+	slot.osa.speakers             = detected_layout;
+	slot.osa.format               = aoi->format;
+	slot.osa.samples_per_sec      = aoi->samples_per_sec;
+	for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+		if (!audio->data[idx]) {
+			slot.osa.data[idx] = nullptr;
+			continue;
+		}
+
+		// Only allocates if a packet is larger than any before it.
+		slot.data[idx].resize(audio->frames * get_audio_bytes_per_channel(slot.osa.format));
+		memcpy(slot.data[idx].data(), audio->data[idx], slot.data[idx].size());
+		slot.osa.data[idx] = slot.data[idx].data();
 	}
+	_audio_head.store(head + 1);
 
-	// Create a clone of the audio data and push it to the thread pool.
-	streamfx::threadpool()->push(std::bind(&mirror_instance::audio_output, this, std::placeholders::_1), nullptr);
+	// Only wake the consumer if it is actually waiting.
+	if (_audio_waiting.load()) {
+		std::lock_guard<std::mutex> lock(_audio_lock);
+		_audio_cv.notify_one();
+	}
 }
 
-void mirror_instance::audio_output(std::shared_ptr<void> data)
+void mirror_instance::audio_output()
 {
-	std::unique_lock<std::mutex> ul(_audio_queue_lock);
-	while (_audio_queue.size() > 0) {
-		obs_source_output_audio(_self, &((_audio_queue.front()).osa));
-		_audio_queue.pop();
+	while (!_audio_stop) {
+		size_t tail = _audio_tail.load(std::memory_order_relaxed);
+		if (tail == _audio_head.load(std::memory_order_acquire)) {
+			std::unique_lock<std::mutex> ul(_audio_lock);
+			_audio_waiting = true;
+			_audio_cv.wait(ul, [this, tail]() { return _audio_stop || (_audio_head.load() != tail); });
+			_audio_waiting = false;
+			continue;
+		}
+
+		obs_source_output_audio(_self, &(_audio_slots[tail % _audio_slots.size()].osa));
+		_audio_tail.store(tail + 1, std::memory_order_release);
 	}
 }
 
@@ -327,22 +371,8 @@ obs_properties_t* mirror_factory::get_properties2(mirror_instance* data)
 		obs_property_set_modified_callback(p, modified_properties);
 
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::instance()->enumerate(
-			[&p](std::string name, ::streamfx::obs::source) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_sources);
-		obs::source_tracker::instance()->enumerate(
-			[&p](std::string name, ::streamfx::obs::source) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_sources, D_TRANSLATE(S_SOURCETYPE_SOURCE));
+		obs::source_tracker::instance()->populate(p, obs::source_tracker::filter_scenes, D_TRANSLATE(S_SOURCETYPE_SCENE));
 	}
 
 	{
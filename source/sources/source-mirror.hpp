@@ -14,34 +14,44 @@
 #include "obs/obs-tools.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::source::mirror {
-	struct mirror_audio_data {
-		mirror_audio_data(const audio_data*, speaker_layout);
+	// Enough for a bit over a second of audio at 48kHz, in case the consumer falls behind.
+	static constexpr size_t audio_slot_count = 64;
 
-		obs_source_audio                  osa;
-		std::vector<std::vector<uint8_t>> data;
+	struct mirror_audio_slot {
+		obs_source_audio                                osa;
+		std::array<std::vector<uint8_t>, MAX_AV_PLANES> data;
 	};
 
 	class mirror_instance : public obs::source_instance {
 		// Source
 		::streamfx::obs::source                               _source;
-		std::shared_ptr<::streamfx::obs::source_active_child> _source_child;
+		std::shared_ptr<::streamfx::gfx::source_texture>      _source_texture;
 		std::shared_ptr<obs::source_signal_handler>           _signal_rename;
 		std::shared_ptr<obs::audio_signal_handler>            _signal_audio;
 		std::pair<uint32_t, uint32_t>                         _source_size;
 
 		// Audio
-		bool                          _audio_enabled;
-		speaker_layout                _audio_layout;
-		std::mutex                    _audio_queue_lock;
-		std::queue<mirror_audio_data> _audio_queue;
+		bool           _audio_enabled;
+		speaker_layout _audio_layout;
+
+		// Audio: Ring buffer with a single producer (the audio callback) and a single consumer (the audio thread).
+		std::array<mirror_audio_slot, audio_slot_count> _audio_slots;
+		std::atomic<size_t>                             _audio_head; // Only written by the producer.
+		std::atomic<size_t>                             _audio_tail; // Only written by the consumer.
+		std::atomic<bool>                               _audio_waiting;
+		std::atomic<bool>                               _audio_stop;
+		std::mutex                                      _audio_lock;
+		std::condition_variable                         _audio_cv;
+		std::thread                                     _audio_thread;
 
 		public:
 		mirror_instance(obs_data_t* settings, obs_source_t* self);
@@ -67,7 +77,7 @@ namespace streamfx::source::mirror {
 
 		void on_audio(::streamfx::obs::source, const struct audio_data*, bool);
 
-		void audio_output(std::shared_ptr<void> data);
+		void audio_output();
 	};
 
 	class mirror_factory : public obs::source_factory<source::mirror::mirror_factory, source::mirror::mirror_instance> {
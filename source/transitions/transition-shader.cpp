@@ -9,6 +9,7 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -27,12 +28,14 @@
 #endif
 
 #define ST_I18N "Transition.Shader"
+#define ST_I18N_INPUTSCALE ST_I18N ".InputScale"
+#define ST_KEY_INPUTSCALE "Transition.InputScale"
 
 using namespace streamfx::transition::shader;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Source-Filter-Transition-Shader";
 
-shader_instance::shader_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self)
+shader_instance::shader_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _input_scale(1.0), _transitioning(false), _scaled(false), _scaled_width(0), _scaled_height(0), _restore_width(0), _restore_height(0), _restore_scale_type(OBS_TRANSITION_SCALE_MAX_ONLY)
 {
 	_fx = std::make_shared<streamfx::gfx::shader::shader>(self, streamfx::gfx::shader::shader_mode::Transition);
 
@@ -64,6 +67,8 @@ void shader_instance::load(obs_data_t* data)
 void shader_instance::update(obs_data_t* data)
 {
 	_fx->update(data);
+
+	_input_scale = std::clamp(static_cast<double_t>(obs_data_get_int(data, ST_KEY_INPUTSCALE)) / 100.0, 0.01, 1.0);
 }
 
 void shader_instance::video_tick(float_t sec_since_last)
@@ -78,6 +83,34 @@ void shader_instance::video_tick(float_t sec_since_last)
 	obs_video_info ovi;
 	obs_get_video_info(&ovi);
 	_fx->set_size(ovi.base_width, ovi.base_height);
+
+	// libobs renders both scenes at the size of the transition, which is changed here on the graphics thread instead of
+	// in transition_start(), as libobs may hold the transition lock while calling that.
+	if (_transitioning && (_input_scale < 1.0)) {
+		uint32_t width  = std::max<uint32_t>(1, static_cast<uint32_t>(ovi.base_width * _input_scale));
+		uint32_t height = std::max<uint32_t>(1, static_cast<uint32_t>(ovi.base_height * _input_scale));
+		if (!_scaled) {
+			obs_transition_get_size(_self, &_restore_width, &_restore_height);
+			_restore_scale_type = obs_transition_get_scale_type(_self);
+			obs_transition_set_scale_type(_self, OBS_TRANSITION_SCALE_STRETCH);
+			_scaled = true;
+		}
+		if ((width != _scaled_width) || (height != _scaled_height)) {
+			obs_transition_set_size(_self, width, height);
+			_scaled_width  = width;
+			_scaled_height = height;
+		}
+	} else if (_scaled) {
+		// Only the transition itself may render at a reduced size, never the scene shown after it.
+		obs_transition_set_size(_self, _restore_width, _restore_height);
+		obs_transition_set_scale_type(_self, _restore_scale_type);
+		_scaled        = false;
+		_scaled_width  = 0;
+		_scaled_height = 0;
+	}
+
+	// Get the first frame of a transition out of the way before it actually runs on stream.
+	_fx->prewarm();
 }
 
 void shader_instance::video_render(gs_effect_t* effect)
@@ -113,10 +146,12 @@ void shader_instance::transition_start()
 {
 	_fx->set_visible(true);
 	_fx->set_active(true);
+	_transitioning = true;
 }
 
 void shader_instance::transition_stop()
 {
+	_transitioning = false;
 	_fx->set_active(false);
 	_fx->set_visible(false);
 }
@@ -142,6 +177,7 @@ const char* shader_factory::get_name()
 void shader_factory::get_defaults2(obs_data_t* data)
 {
 	streamfx::gfx::shader::shader::defaults(data);
+	obs_data_set_default_int(data, ST_KEY_INPUTSCALE, 100);
 }
 
 obs_properties_t* shader_factory::get_properties2(shader::shader_instance* data)
@@ -155,6 +191,14 @@ obs_properties_t* shader_factory::get_properties2(shader::shader_instance* data)
 	}
 #endif
 
+	{
+		auto p = obs_properties_add_list(pr, ST_KEY_INPUTSCALE, D_TRANSLATE(ST_I18N_INPUTSCALE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, "100%", 100);
+		obs_property_list_add_int(p, "75%", 75);
+		obs_property_list_add_int(p, "50%", 50);
+		obs_property_list_add_int(p, "25%", 25);
+	}
+
 	if (data) {
 		reinterpret_cast<shader_instance*>(data)->properties(pr);
 	}
@@ -9,10 +9,26 @@
 #include "obs/obs-source-factory.hpp"
 #include "plugin.hpp"
 
+#include "warning-disable.hpp"
+#include <atomic>
+#include "warning-enable.hpp"
+
 namespace streamfx::transition::shader {
 	class shader_instance : public obs::source_instance {
 		std::shared_ptr<streamfx::gfx::shader::shader> _fx;
 
+		// Scenes A and B are rendered at this fraction of the canvas for as long as the transition runs.
+		double_t          _input_scale;
+		std::atomic<bool> _transitioning;
+
+		// What libobs had configured before the inputs were scaled down, restored once the transition is over.
+		bool                      _scaled;
+		uint32_t                  _scaled_width;
+		uint32_t                  _scaled_height;
+		uint32_t                  _restore_width;
+		uint32_t                  _restore_height;
+		obs_transition_scale_type _restore_scale_type;
+
 		public:
 		shader_instance(obs_data_t* data, obs_source_t* self);
 		virtual ~shader_instance();
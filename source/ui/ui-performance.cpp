@@ -0,0 +1,149 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "ui-performance.hpp"
+#include "strings.hpp"
+#include "obs/obs-source-factory.hpp"
+
+#include "warning-disable.hpp"
+#include <QHeaderView>
+#include "warning-enable.hpp"
+
+// Translation Keys
+constexpr std::string_view _i18n_title        = "UI.Performance";
+constexpr std::string_view _i18n_column_name  = "UI.Performance.Name";
+constexpr std::string_view _i18n_column_type  = "UI.Performance.Type";
+constexpr std::string_view _i18n_column_cpu   = "UI.Performance.CPU";
+constexpr std::string_view _i18n_column_cpu99 = "UI.Performance.CPU99";
+constexpr std::string_view _i18n_column_gpu   = "UI.Performance.GPU";
+constexpr std::string_view _i18n_column_gpu99 = "UI.Performance.GPU99";
+constexpr std::string_view _i18n_column_skip  = "UI.Performance.Skipped";
+constexpr std::string_view _i18n_column_mem   = "UI.Performance.Memory";
+
+// Refresh interval of the table in milliseconds.
+constexpr int _refresh_interval = 1000;
+
+enum column : int {
+	COLUMN_NAME,
+	COLUMN_TYPE,
+	COLUMN_CPU,
+	COLUMN_CPU99,
+	COLUMN_GPU,
+	COLUMN_GPU99,
+	COLUMN_SKIPPED,
+	COLUMN_MEMORY,
+	COLUMN_COUNT,
+};
+
+static QString format_duration(double_t nanoseconds)
+{
+	if (nanoseconds < 0) {
+		return QString::fromUtf8("-");
+	}
+	return QString::number(nanoseconds / 1000000., 'f', 3);
+}
+
+streamfx::ui::performance::performance(QWidget* parent) : QDockWidget(parent), _table(), _timer(), _history()
+{
+	setObjectName(QString::fromUtf8("StreamFXPerformance"));
+	setWindowTitle(QString::fromUtf8(D_TRANSLATE(_i18n_title.data())));
+	setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+	_table = new QTableWidget(0, COLUMN_COUNT, this);
+	_table->setHorizontalHeaderLabels({
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_name.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_type.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_cpu.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_cpu99.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_gpu.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_gpu99.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_skip.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_mem.data())),
+	});
+	_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	_table->setSelectionMode(QAbstractItemView::NoSelection);
+	_table->setSortingEnabled(true);
+	_table->verticalHeader()->setVisible(false);
+	_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+	_table->horizontalHeader()->setSectionResizeMode(COLUMN_NAME, QHeaderView::Stretch);
+	setWidget(_table);
+
+	// Only poll while the dock is actually visible.
+	_timer = new QTimer(this);
+	_timer->setInterval(_refresh_interval);
+	connect(_timer, &QTimer::timeout, this, &streamfx::ui::performance::on_refresh);
+	connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+		if (visible) {
+			on_refresh();
+			_timer->start();
+		} else {
+			_timer->stop();
+		}
+	});
+}
+
+streamfx::ui::performance::~performance() {}
+
+double_t streamfx::ui::performance::average(const std::shared_ptr<streamfx::util::profiler>& profiler, std::map<std::shared_ptr<streamfx::util::profiler>, history>& next)
+{
+	if (!profiler) {
+		return -1.;
+	}
+
+	history now{profiler->count(), profiler->total_duration()};
+	history prev{0, std::chrono::nanoseconds(0)};
+	if (auto iter = _history.find(profiler); iter != _history.end()) {
+		prev = iter->second;
+	}
+	next.emplace(profiler, now);
+
+	if (now.count <= prev.count) {
+		return -1.;
+	}
+	return static_cast<double_t>((now.total - prev.total).count()) / static_cast<double_t>(now.count - prev.count);
+}
+
+void streamfx::ui::performance::on_refresh()
+{
+	auto instances = streamfx::obs::source_instance::profile_all();
+
+	// Rebuild the table, keeping the sort order the user picked.
+	std::map<std::shared_ptr<streamfx::util::profiler>, history> next;
+	_table->setSortingEnabled(false);
+	_table->setRowCount(static_cast<int>(instances.size()));
+	for (size_t idx = 0; idx < instances.size(); idx++) {
+		auto& info = instances[idx];
+		int   row  = static_cast<int>(idx);
+
+		auto set = [this, row](int column, QString text) {
+			auto item = _table->item(row, column);
+			if (!item) {
+				item = new QTableWidgetItem();
+				_table->setItem(row, column, item);
+			}
+			if (column >= COLUMN_CPU) {
+				item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+			}
+			item->setText(text);
+		};
+
+		double_t cpu   = average(info.cpu, next);
+		double_t gpu   = average(info.gpu, next);
+		double_t cpu99 = info.cpu ? static_cast<double_t>(info.cpu->percentile(.99).count()) : -1.;
+		double_t gpu99 = info.gpu ? static_cast<double_t>(info.gpu->percentile(.99).count()) : -1.;
+
+		set(COLUMN_NAME, QString::fromStdString(info.name));
+		set(COLUMN_TYPE, QString::fromStdString(info.type));
+		set(COLUMN_CPU, format_duration(cpu));
+		set(COLUMN_CPU99, format_duration(cpu99));
+		set(COLUMN_GPU, format_duration(gpu));
+		set(COLUMN_GPU99, format_duration(gpu99));
+		set(COLUMN_SKIPPED, QString::number(info.skipped));
+		set(COLUMN_MEMORY, QString::number(static_cast<double_t>(info.memory) / (1024. * 1024.), 'f', 1));
+	}
+	_table->setSortingEnabled(true);
+
+	// Forget about instances that no longer exist.
+	_history.swap(next);
+}
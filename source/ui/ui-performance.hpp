@@ -0,0 +1,48 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "ui-common.hpp"
+#include "util/util-profiler.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <memory>
+#include <QDockWidget>
+#include <QTableWidget>
+#include <QTimer>
+#include "warning-enable.hpp"
+
+namespace streamfx::ui {
+	/** Dock listing every live StreamFX source and filter with its render cost.
+	 *
+	 * Timings are averaged over the refresh interval, the 99th percentile covers the whole lifetime of the instance.
+	 */
+	class performance : public QDockWidget {
+		Q_OBJECT
+
+		struct history {
+			uint64_t                 count;
+			std::chrono::nanoseconds total;
+		};
+
+		private:
+		QTableWidget* _table;
+		QTimer*       _timer;
+
+		std::map<std::shared_ptr<streamfx::util::profiler>, history> _history;
+
+		public:
+		performance(QWidget* parent = nullptr);
+		~performance();
+
+		private:
+		double_t average(const std::shared_ptr<streamfx::util::profiler>& profiler, std::map<std::shared_ptr<streamfx::util::profiler>, history>& next);
+
+		public slots:
+		; // Not having this breaks some linters.
+		void on_refresh();
+	};
+} // namespace streamfx::ui
@@ -7,11 +7,22 @@
 #include "strings.hpp"
 #include "ui-common.hpp"
 #include "configuration.hpp"
+#include "obs/obs-source-tracker.hpp"
 #include "obs/obs-tools.hpp"
 #include "plugin.hpp"
 #include "ui/ui-obs-browser-widget.hpp"
 
+#ifdef ENABLE_PROFILING
+#include "util/util-benchmark.hpp"
+#include "util/util-memory.hpp"
+#include "util/util-trace.hpp"
+#endif
+#if defined(ENABLE_PROFILING) && defined(ENABLE_ENCODER_FFMPEG)
+#include "encoders/ffmpeg/debug.hpp"
+#endif
+
 #include "warning-disable.hpp"
+#include <atomic>
 #include <string_view>
 #include "warning-enable.hpp"
 
@@ -26,6 +37,9 @@ constexpr std::string_view _i18n_menu_youtube = "UI.Menu.YouTube";
 constexpr std::string_view _i18n_menu_twitter = "UI.Menu.Twitter";
 constexpr std::string_view _i18n_menu_github  = "UI.Menu.Github";
 constexpr std::string_view _i18n_menu_about   = "UI.Menu.About";
+constexpr std::string_view _i18n_menu_trace   = "UI.Menu.Trace";
+constexpr std::string_view _i18n_menu_bench   = "UI.Menu.Benchmark";
+constexpr std::string_view _i18n_menu_memory  = "UI.Menu.Memory";
 
 // Configuration
 constexpr std::string_view _cfg_have_shown_about = "UI.HaveShownAboutStreamFX";
@@ -69,15 +83,28 @@ streamfx::ui::handler::handler()
 	: QObject(), _menu_action(), _menu(),
 
 	  _action_support(), _action_wiki(), _action_website(), _action_discord(), _action_twitter(), _action_youtube(),
+#ifdef ENABLE_PROFILING
+	  _action_trace(),
+#endif
+#ifdef ENABLE_PROFILING
+	  _action_benchmark(), _action_memory(),
+#endif
 
 	  _about_action(), _about_dialog(),
 
 	  _translator()
+#ifdef ENABLE_PROFILING
+	  ,
+	  _performance_dock()
+#endif
 #ifdef ENABLE_UPDATER
 	  ,
 	  _updater()
 #endif
 {
+	// The first scene collection is loaded after all modules, so index its sources in one go.
+	streamfx::obs::source_tracker::instance()->begin_batch();
+
 	obs_frontend_add_event_callback(frontend_event_handler, this);
 }
 
@@ -91,8 +118,15 @@ void streamfx::ui::handler::frontend_event_handler(obs_frontend_event event, voi
 	streamfx::ui::handler* ptr = reinterpret_cast<streamfx::ui::handler*>(private_data);
 	switch (event) {
 	case OBS_FRONTEND_EVENT_FINISHED_LOADING:
+		streamfx::obs::source_tracker::instance()->end_batch();
 		ptr->on_obs_loaded();
 		break;
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING:
+		streamfx::obs::source_tracker::instance()->begin_batch();
+		break;
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
+		streamfx::obs::source_tracker::instance()->end_batch();
+		break;
 	case OBS_FRONTEND_EVENT_EXIT:
 		ptr->on_obs_exit();
 		break;
@@ -174,6 +208,25 @@ void streamfx::ui::handler::on_obs_loaded()
 
 		_menu->addSeparator();
 
+#ifdef ENABLE_PROFILING
+		// Performance Trace
+		_action_trace = _menu->addAction(QString::fromUtf8(D_TRANSLATE(_i18n_menu_trace.data())));
+		_action_trace->setMenuRole(QAction::NoRole);
+		_action_trace->setCheckable(true);
+		connect(_action_trace, &QAction::triggered, this, &streamfx::ui::handler::on_action_trace);
+#endif
+#ifdef ENABLE_PROFILING
+		// Benchmark
+		_action_benchmark = _menu->addAction(QString::fromUtf8(D_TRANSLATE(_i18n_menu_bench.data())));
+		_action_benchmark->setMenuRole(QAction::NoRole);
+		connect(_action_benchmark, &QAction::triggered, this, &streamfx::ui::handler::on_action_benchmark);
+
+		// Memory Usage
+		_action_memory = _menu->addAction(QString::fromUtf8(D_TRANSLATE(_i18n_menu_memory.data())));
+		_action_memory->setMenuRole(QAction::NoRole);
+		connect(_action_memory, &QAction::triggered, this, &streamfx::ui::handler::on_action_memory);
+#endif
+
 		// About
 		_about_action = _menu->addAction(QString::fromUtf8(D_TRANSLATE(_i18n_menu_about.data())));
 		_about_action->setMenuRole(QAction::NoRole);
@@ -196,6 +249,13 @@ void streamfx::ui::handler::on_obs_loaded()
 		}
 	}
 
+#ifdef ENABLE_PROFILING
+	{ // Add the performance dock, OBS takes ownership of it.
+		_performance_dock = new streamfx::ui::performance(reinterpret_cast<QWidget*>(obs_frontend_get_main_window()));
+		obs_frontend_add_dock(_performance_dock);
+	}
+#endif
+
 	// Show the 'About StreamFX' dialog if that has not happened yet.
 	if (!have_shown_about_streamfx()) {
 		// Automatically show it if it has not yet been shown.
@@ -252,6 +312,64 @@ void streamfx::ui::handler::on_action_youtube(bool)
 	QDesktopServices::openUrl(QUrl(QString::fromUtf8(_url_youtube.data())));
 }
 
+#ifdef ENABLE_PROFILING
+void streamfx::ui::handler::on_action_trace(bool checked)
+{
+	auto recorder = streamfx::util::trace::recorder::instance();
+	if (checked) {
+		recorder->start();
+	} else {
+		recorder->stop();
+
+		// Write the trace next to the configuration, named after the current time.
+		std::time_t now = std::time(nullptr);
+		char        name[64];
+		std::strftime(name, sizeof(name), "traces/%Y%m%d-%H%M%S.json", std::localtime(&now));
+		recorder->dump(streamfx::config_file_path(name));
+	}
+}
+#endif
+
+#ifdef ENABLE_PROFILING
+void streamfx::ui::handler::on_action_benchmark(bool)
+{
+	// Frames per encoder, about ten seconds of 60 fps video.
+	constexpr std::size_t benchmark_frames = 600;
+
+	// Frames per filter, source and transition, which is enough for GPU timers to settle.
+	constexpr std::size_t benchmark_source_frames = 120;
+
+	static std::atomic<bool> running{false};
+	if (running.exchange(true)) {
+		return;
+	}
+
+	streamfx::threadpool()->push(
+		[](streamfx::util::threadpool::task_data_t) {
+			try {
+				streamfx::util::benchmark::run_all();
+				streamfx::util::benchmark::run_sources(benchmark_source_frames);
+			} catch (std::exception const& ex) {
+				DLOG_ERROR("Benchmark failed: %s", ex.what());
+			}
+#ifdef ENABLE_ENCODER_FFMPEG
+			try {
+				streamfx::encoder::ffmpeg::benchmark::run_all(benchmark_frames);
+			} catch (std::exception const& ex) {
+				DLOG_ERROR("Encoder benchmark failed: %s", ex.what());
+			}
+#endif
+			running = false;
+		},
+		nullptr, streamfx::util::threadpool::priority::BACKGROUND);
+}
+
+void streamfx::ui::handler::on_action_memory(bool)
+{
+	streamfx::util::memory::log();
+}
+#endif
+
 void streamfx::ui::handler::on_action_about(bool checked)
 {
 	_about_dialog->show();
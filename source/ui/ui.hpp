@@ -10,6 +10,10 @@
 #include "ui-updater.hpp"
 #endif
 
+#ifdef ENABLE_PROFILING
+#include "ui-performance.hpp"
+#endif
+
 namespace streamfx::ui {
 	class handler : public QObject {
 		Q_OBJECT
@@ -25,6 +29,13 @@ namespace streamfx::ui {
 		QAction* _action_discord;
 		QAction* _action_twitter;
 		QAction* _action_youtube;
+#ifdef ENABLE_PROFILING
+		QAction* _action_trace;
+#endif
+#ifdef ENABLE_PROFILING
+		QAction* _action_benchmark;
+		QAction* _action_memory;
+#endif
 
 		// About Dialog
 		QAction*   _about_action;
@@ -32,6 +43,10 @@ namespace streamfx::ui {
 
 		QTranslator* _translator;
 
+#ifdef ENABLE_PROFILING
+		ui::performance* _performance_dock;
+#endif
+
 #ifdef ENABLE_UPDATER
 		std::shared_ptr<streamfx::ui::updater> _updater;
 #endif
@@ -60,6 +75,13 @@ namespace streamfx::ui {
 		void on_action_discord(bool);
 		void on_action_twitter(bool);
 		void on_action_youtube(bool);
+#ifdef ENABLE_PROFILING
+		void on_action_trace(bool);
+#endif
+#ifdef ENABLE_PROFILING
+		void on_action_benchmark(bool);
+		void on_action_memory(bool);
+#endif
 
 		// About
 		void on_action_about(bool);
@@ -9,6 +9,8 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <mutex>
 #include <regex>
@@ -30,7 +32,6 @@
 #endif
 
 // TODO:
-// - Cache result in the configuration directory (not as a configuration value).
 // - Move 'autoupdater.last_checked_at' to out of the configuration.
 // - Figure out if nightly updates are viable at all.
 
@@ -39,6 +40,12 @@
 #define ST_CFG_CHANNEL "updater.channel"
 #define ST_CFG_LASTCHECKEDAT "updater.lastcheckedat"
 
+#define ST_DEBUG_FILE "github_release_query_response.json"
+#define ST_CACHE_FILE "updater-releases.json"
+#define ST_CACHE_RELEASES "Releases"
+#define ST_CACHE_ETAG "ETag"
+#define ST_CACHE_LASTMODIFIED "LastModified"
+
 streamfx::version_stage streamfx::stage_from_string(std::string_view str)
 {
 	if (str == "a") {
@@ -220,135 +227,193 @@ streamfx::version_info::operator std::string()
 void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 {
 	try {
-		auto query_fn = [](std::vector<char>& buffer) {
-			static constexpr std::string_view ST_API_URL = "https://api.github.com/repos/Xaymar/obs-StreamFX/releases?per_page=25&page=1";
-
-			streamfx::util::curl curl;
-			size_t               buffer_offset = 0;
-
-			// Set headers (User-Agent is needed so Github can contact us!).
-			curl.set_header("User-Agent", "StreamFX Updater v" STREAMFX_VERSION_STRING);
-			curl.set_header("Accept", "application/vnd.github.v3+json");
-
-			// Set up request.
-			curl.set_option(CURLOPT_HTTPGET, true); // GET
-			curl.set_option(CURLOPT_POST, false); // Not POST
-			curl.set_option(CURLOPT_URL, ST_API_URL);
-			curl.set_option(CURLOPT_TIMEOUT, 30); // 10s until we fail.
-
-			// Callbacks
-			curl.set_write_callback([&buffer, &buffer_offset](void* data, size_t s1, size_t s2) {
-				size_t size = s1 * s2;
-				if (buffer.size() < (size + buffer_offset))
-					buffer.resize(buffer_offset + size);
-
-				memcpy(buffer.data() + buffer_offset, data, size);
-				buffer_offset += size;
-
-				return s1 * s2;
-			});
-			//std::bind(&streamfx::updater::task_write_cb, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)
-
-			// Clear any unknown data and reserve 64KiB of memory.
-			buffer.clear();
-			buffer.reserve(0xFFFF);
-
-			// Finally, execute the request.
-			D_LOG_DEBUG("Querying for latest releases...", "");
-			if (CURLcode res = curl.perform(); res != CURLE_OK) {
-				D_LOG_ERROR("Performing query failed with error: %s", curl_easy_strerror(res));
-				throw std::runtime_error(curl_easy_strerror(res));
-			}
+		// Parse a crafted response instead of asking the API.
+		std::ifstream fs{streamfx::config_file_path(ST_DEBUG_FILE)};
+		process(nlohmann::json::parse(fs));
+	} catch (const std::exception& ex) {
+		// Notify about the error.
+		std::string message = ex.what();
+		events.error.call(*this, message);
+	}
+}
+
+void streamfx::updater::query()
+{
+	static constexpr std::string_view ST_API_URL = "https://api.github.com/repos/Xaymar/obs-StreamFX/releases?per_page=25&page=1";
 
-			int32_t status_code = 0;
-			if (CURLcode res = curl.get_info(CURLINFO_HTTP_CODE, status_code); res != CURLE_OK) {
-				D_LOG_ERROR("Retrieving status code failed with error: %s", curl_easy_strerror(res));
+	// Keep the last response around, so that the API only has to tell us whether anything changed.
+	auto           cache_path = streamfx::config_file_path(ST_CACHE_FILE);
+	nlohmann::json cache;
+	try {
+		if (std::filesystem::exists(cache_path)) {
+			std::ifstream fs{cache_path};
+			cache = nlohmann::json::parse(fs);
+		}
+	} catch (const std::exception& ex) {
+		D_LOG_DEBUG("Ignoring cached releases, error: %s", ex.what());
+		cache = nlohmann::json();
+	}
+	if (!cache.is_object() || !cache.contains(ST_CACHE_RELEASES)) {
+		cache = nlohmann::json();
+	}
+
+	auto request = std::make_shared<streamfx::util::curl>();
+	auto buffer  = std::make_shared<std::vector<char>>();
+	auto headers = std::make_shared<std::map<std::string, std::string>>();
+
+	// Set headers (User-Agent is needed so Github can contact us!).
+	request->set_header("User-Agent", "StreamFX Updater v" STREAMFX_VERSION_STRING);
+	request->set_header("Accept", "application/vnd.github.v3+json");
+	if (!cache.is_null()) {
+		if (auto kv = cache.find(ST_CACHE_ETAG); (kv != cache.end()) && kv->is_string()) {
+			request->set_header("If-None-Match", kv->get<std::string>());
+		}
+		if (auto kv = cache.find(ST_CACHE_LASTMODIFIED); (kv != cache.end()) && kv->is_string()) {
+			request->set_header("If-Modified-Since", kv->get<std::string>());
+		}
+	}
+
+	// Set up request.
+	request->set_option(CURLOPT_HTTPGET, true); // GET
+	request->set_option(CURLOPT_POST, false); // Not POST
+	request->set_option(CURLOPT_URL, ST_API_URL);
+	request->set_option(CURLOPT_TIMEOUT, 30); // 30s until we fail.
+
+	// Callbacks
+	request->set_write_callback([buffer](void* data, size_t s1, size_t s2) {
+		auto ptr = static_cast<const char*>(data);
+		buffer->insert(buffer->end(), ptr, ptr + s1 * s2);
+		return s1 * s2;
+	});
+	request->set_header_callback([headers](void* data, size_t s1, size_t s2) {
+		std::string_view line{static_cast<const char*>(data), s1 * s2};
+		if (auto pos = line.find(':'); pos != std::string_view::npos) {
+			std::string key{line.substr(0, pos)};
+			std::transform(key.begin(), key.end(), key.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+
+			auto value = line.substr(pos + 1);
+			while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) {
+				value.remove_prefix(1);
+			}
+			while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) {
+				value.remove_suffix(1);
+			}
+			headers->insert_or_assign(key, std::string(value));
+		}
+		return s1 * s2;
+	});
+	buffer->reserve(0xFFFF);
+
+	// Finally, start the request. Nothing waits for it, the result arrives in the callback.
+	D_LOG_DEBUG("Querying for latest releases...", "");
+	_request = request;
+	_curl->perform(request, [this, request, buffer, headers, cache, cache_path](CURLcode res) {
+		try {
+			if (res != CURLE_OK) {
+				D_LOG_ERROR("Performing query failed with error: %s", curl_easy_strerror(res));
 				throw std::runtime_error(curl_easy_strerror(res));
 			}
-			D_LOG_DEBUG("API returned status code %d.", status_code);
 
-			if (status_code != 200) {
-				D_LOG_ERROR("API returned unexpected status code %d.", status_code);
-				throw std::runtime_error("Request failed due to one or more reasons.");
-			}
-		};
-		auto parse_fn = [this](nlohmann::json json) {
-			// Check if it was parsed as an object.
-			if (json.type() != nlohmann::json::value_t::array) {
-				throw std::runtime_error("Invalid response from API.");
+			long status_code = 0;
+			if (CURLcode info_res = request->get_info(CURLINFO_HTTP_CODE, status_code); info_res != CURLE_OK) {
+				D_LOG_ERROR("Retrieving status code failed with error: %s", curl_easy_strerror(info_res));
+				throw std::runtime_error(curl_easy_strerror(info_res));
 			}
+			D_LOG_DEBUG("API returned status code %ld.", status_code);
 
-			// Decide on the latest version for all update channels.
-			std::lock_guard<decltype(_lock)> lock(_lock);
-			_updates.clear();
-			for (auto obj : json) {
+			nlohmann::json json;
+			if ((status_code == 304) && !cache.is_null()) {
+				D_LOG_DEBUG("Releases did not change since the last check.", "");
+				json = cache.at(ST_CACHE_RELEASES);
+			} else if (status_code == 200) {
+				json = nlohmann::json::parse(buffer->begin(), buffer->end());
+
+				nlohmann::json entry;
+				entry[ST_CACHE_RELEASES] = json;
+				if (auto kv = headers->find("etag"); kv != headers->end()) {
+					entry[ST_CACHE_ETAG] = kv->second;
+				}
+				if (auto kv = headers->find("last-modified"); kv != headers->end()) {
+					entry[ST_CACHE_LASTMODIFIED] = kv->second;
+				}
 				try {
-					auto info = obj.get<streamfx::version_info>();
-
-					switch (info.stage) {
-					case version_stage::STABLE:
-						if (get_update_info(version_stage::STABLE).is_older_than(info)) {
-							_updates.emplace(version_stage::STABLE, info);
-						}
-						[[fallthrough]];
-					case version_stage::CANDIDATE:
-						if (get_update_info(version_stage::CANDIDATE).is_older_than(info)) {
-							_updates.emplace(version_stage::CANDIDATE, info);
-						}
-						[[fallthrough]];
-					case version_stage::BETA:
-						if (get_update_info(version_stage::BETA).is_older_than(info)) {
-							_updates.emplace(version_stage::BETA, info);
-						}
-						[[fallthrough]];
-					case version_stage::ALPHA:
-						if (get_update_info(version_stage::ALPHA).is_older_than(info)) {
-							_updates.emplace(version_stage::ALPHA, info);
-						}
-					}
-
+					std::ofstream fs{cache_path, std::ios::trunc};
+					fs << entry;
 				} catch (const std::exception& ex) {
-					D_LOG_DEBUG("Failed to parse entry, error: %s", ex.what());
+					D_LOG_WARNING("Failed to cache releases, error: %s", ex.what());
 				}
+			} else {
+				D_LOG_ERROR("API returned unexpected status code %ld.", status_code);
+				throw std::runtime_error("Request failed due to one or more reasons.");
 			}
-		};
 
-		{ // Query and parse the response.
-			nlohmann::json json;
+			process(json);
+		} catch (const std::exception& ex) {
+			// Notify about the error.
+			std::string message = ex.what();
+			events.error.call(*this, message);
+		}
 
-			// Query the API or parse a crafted response.
-			auto debug_path = streamfx::config_file_path("github_release_query_response.json");
-			if (std::filesystem::exists(debug_path)) {
-				std::ifstream fs{debug_path};
-				json = nlohmann::json::parse(fs);
-				fs.close();
-			} else {
-				std::vector<char> buffer;
-				query_fn(buffer);
-				json = nlohmann::json::parse(buffer.begin(), buffer.end());
-			}
+		std::lock_guard<decltype(_lock)> lock(_lock);
+		_request.reset();
+	});
+}
 
-			// Parse the JSON response from the API.
-			parse_fn(json);
+void streamfx::updater::process(nlohmann::json json)
+{
+	{
+		// Check if it was parsed as an object.
+		if (json.type() != nlohmann::json::value_t::array) {
+			throw std::runtime_error("Invalid response from API.");
 		}
 
-		// Print all update information to the log file.
-		D_LOG_INFO("Current Version: %s", static_cast<std::string>(_current_info).c_str());
-		D_LOG_INFO("Latest Stable Version: %s", static_cast<std::string>(get_update_info(version_stage::STABLE)).c_str());
-		D_LOG_INFO("Latest Candidate Version: %s", static_cast<std::string>(get_update_info(version_stage::CANDIDATE)).c_str());
-		D_LOG_INFO("Latest Beta Version: %s", static_cast<std::string>(get_update_info(version_stage::BETA)).c_str());
-		D_LOG_INFO("Latest Alpha Version: %s", static_cast<std::string>(get_update_info(version_stage::ALPHA)).c_str());
-		if (is_update_available()) {
-			D_LOG_INFO("Update is available.", "");
+		// Decide on the latest version for all update channels.
+		std::lock_guard<decltype(_lock)> lock(_lock);
+		_updates.clear();
+		for (auto obj : json) {
+			try {
+				auto info = obj.get<streamfx::version_info>();
+
+				switch (info.stage) {
+				case version_stage::STABLE:
+					if (get_update_info(version_stage::STABLE).is_older_than(info)) {
+						_updates.emplace(version_stage::STABLE, info);
+					}
+					[[fallthrough]];
+				case version_stage::CANDIDATE:
+					if (get_update_info(version_stage::CANDIDATE).is_older_than(info)) {
+						_updates.emplace(version_stage::CANDIDATE, info);
+					}
+					[[fallthrough]];
+				case version_stage::BETA:
+					if (get_update_info(version_stage::BETA).is_older_than(info)) {
+						_updates.emplace(version_stage::BETA, info);
+					}
+					[[fallthrough]];
+				case version_stage::ALPHA:
+					if (get_update_info(version_stage::ALPHA).is_older_than(info)) {
+						_updates.emplace(version_stage::ALPHA, info);
+					}
+				}
+
+			} catch (const std::exception& ex) {
+				D_LOG_DEBUG("Failed to parse entry, error: %s", ex.what());
+			}
 		}
+	}
 
-		// Notify listeners of the update.
-		events.refreshed.call(*this);
-	} catch (const std::exception& ex) {
-		// Notify about the error.
-		std::string message = ex.what();
-		events.error.call(*this, message);
+	// Print all update information to the log file.
+	D_LOG_INFO("Current Version: %s", static_cast<std::string>(_current_info).c_str());
+	D_LOG_INFO("Latest Stable Version: %s", static_cast<std::string>(get_update_info(version_stage::STABLE)).c_str());
+	D_LOG_INFO("Latest Candidate Version: %s", static_cast<std::string>(get_update_info(version_stage::CANDIDATE)).c_str());
+	D_LOG_INFO("Latest Beta Version: %s", static_cast<std::string>(get_update_info(version_stage::BETA)).c_str());
+	D_LOG_INFO("Latest Alpha Version: %s", static_cast<std::string>(get_update_info(version_stage::ALPHA)).c_str());
+	if (is_update_available()) {
+		D_LOG_INFO("Update is available.", "");
 	}
+
+	// Notify listeners of the update.
+	events.refreshed.call(*this);
 }
 
 bool streamfx::updater::can_check()
@@ -394,7 +459,7 @@ void streamfx::updater::save()
 }
 
 streamfx::updater::updater()
-	: _lock(), _task(),
+	: _lock(), _task(), _curl(streamfx::util::curl_multi::instance()), _request(),
 
 	  _data_sharing_allowed(false), _automation(true), _channel(version_stage::STABLE), _lastcheckedat(),
 
@@ -413,6 +478,15 @@ streamfx::updater::updater()
 
 streamfx::updater::~updater()
 {
+	std::shared_ptr<streamfx::util::curl> request;
+	{
+		std::lock_guard<decltype(_lock)> lock(_lock);
+		request = _request;
+	}
+	if (request) {
+		_curl->cancel(request);
+	}
+
 	save();
 }
 
@@ -473,19 +547,25 @@ void streamfx::updater::set_channel(version_stage value)
 
 void streamfx::updater::refresh()
 {
-	if (!_task.expired() || !is_data_sharing_allowed()) {
+	if (!is_data_sharing_allowed()) {
 		return;
 	}
 
 	if (can_check()) {
 		std::lock_guard<decltype(_lock)> lock(_lock);
+		if (!_task.expired() || _request) {
+			return;
+		}
 
 		// Update last checked time.
 		_lastcheckedat = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
 		save();
 
-		// Spawn a new task.
-		_task = streamfx::threadpool()->push(std::bind(&streamfx::updater::task, this, std::placeholders::_1), nullptr);
+		if (std::filesystem::exists(streamfx::config_file_path(ST_DEBUG_FILE))) {
+			_task = streamfx::threadpool()->push(std::bind(&streamfx::updater::task, this, std::placeholders::_1), nullptr, streamfx::util::threadpool::priority::BACKGROUND);
+		} else {
+			query();
+		}
 	} else {
 		events.refreshed(*this);
 	}
@@ -53,6 +53,8 @@ namespace streamfx {
 		// Internal
 		std::recursive_mutex                              _lock;
 		std::weak_ptr<::streamfx::util::threadpool::task> _task;
+		std::shared_ptr<::streamfx::util::curl_multi>     _curl;
+		std::shared_ptr<::streamfx::util::curl>           _request;
 
 		// Options
 		std::atomic_bool     _data_sharing_allowed;
@@ -68,6 +70,9 @@ namespace streamfx {
 		private:
 		void task(streamfx::util::threadpool::task_data_t);
 
+		void query();
+		void process(nlohmann::json json);
+
 		bool can_check();
 
 		void load();
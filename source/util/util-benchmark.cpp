@@ -0,0 +1,430 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-benchmark.hpp"
+#include "strings.hpp"
+#include "gfx/gfx-checksum.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "obs/gs/gs-timer.hpp"
+#include "obs/obs-source-tracker.hpp"
+#include "plugin.hpp"
+#include "util/util-copy.hpp"
+#include "util/util-profiler.hpp"
+#include "util/util-threadpool.hpp"
+
+#ifdef ENABLE_ENCODER_FFMPEG
+#include "ffmpeg/swscale.hpp"
+#endif
+
+#ifdef ENABLE_FILTER_BLUR
+#include "gfx/blur/gfx-blur-box.hpp"
+#include "gfx/blur/gfx-blur-dual-filtering.hpp"
+#include "gfx/blur/gfx-blur-gaussian.hpp"
+#include "gfx/blur/gfx-blur-kawase.hpp"
+#endif
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#ifdef ENABLE_ENCODER_FFMPEG
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::benchmark> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+// Size of the frames used for copies, conversions and effects.
+#define ST_WIDTH 1920
+#define ST_HEIGHT 1080
+
+using namespace streamfx::util;
+
+static benchmark::result summarize(std::string_view name, std::shared_ptr<profiler> profile, std::size_t batch)
+{
+	benchmark::result res;
+	res.name       = name;
+	res.operations = static_cast<size_t>(profile->count()) * batch;
+	res.median     = profile->percentile(.50) / batch;
+	res.p95        = profile->percentile(.95) / batch;
+	res.p99        = profile->percentile(.99) / batch;
+
+	double seconds = std::chrono::duration<double>(profile->total_duration()).count();
+	res.per_second = (seconds > 0.) ? (static_cast<double>(res.operations) / seconds) : 0.;
+	res.checksum   = 0;
+	return res;
+}
+
+static void save(std::vector<benchmark::result> const& results, std::string_view suffix)
+{
+	// Keep a copy for comparing against other releases.
+	try {
+		std::time_t now = std::time(nullptr);
+		char        name[64];
+		std::strftime(name, sizeof(name), "benchmarks/%Y%m%d-%H%M%S-", std::localtime(&now));
+
+		auto path = streamfx::config_file_path(std::string(name) + std::string(suffix) + ".csv");
+		std::filesystem::create_directories(path.parent_path());
+
+		std::ofstream file(path);
+		file << "version,benchmark,operations,per_second,median_us,p95_us,p99_us,checksum\n";
+		for (auto const& res : results) {
+			file << STREAMFX_VERSION_STRING << "," << res.name << "," << res.operations << "," << res.per_second << "," << static_cast<double>(res.median.count()) / 1000. << "," << static_cast<double>(res.p95.count()) / 1000. << "," << static_cast<double>(res.p99.count()) / 1000. << "," << std::hex << res.checksum << std::dec << "\n";
+		}
+	} catch (std::exception const& ex) {
+		D_LOG_WARNING("Failed to save results: %s", ex.what());
+	}
+}
+
+static void report(benchmark::result const& res)
+{
+	D_LOG_INFO("%s: %.0f/s, %.3fus/%.3fus/%.3fus (50th/95th/99th)", res.name.c_str(), res.per_second, static_cast<double>(res.median.count()) / 1000., static_cast<double>(res.p95.count()) / 1000., static_cast<double>(res.p99.count()) / 1000.);
+}
+
+benchmark::result benchmark::measure(std::string_view name, std::size_t samples, std::size_t batch, std::function<void()> function)
+{
+	// Warm caches and lazily created state first, so that they don't end up in the results.
+	function();
+
+	auto profile = profiler::create();
+	for (std::size_t idx = 0; idx < samples; idx++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		function();
+		profile->track(std::chrono::high_resolution_clock::now() - start);
+	}
+
+	return summarize(name, profile, batch);
+}
+
+static void run_cpu(std::vector<benchmark::result>& results)
+{
+	{ // Round trip of a single task, which is what most per-frame work pays.
+		auto pool = streamfx::threadpool();
+		results.push_back(benchmark::measure("Threadpool push and wait", 1000, 1, [pool]() { pool->push([](threadpool::task_data_t) {})->wait(); }));
+	}
+
+	{ // Throughput of many small tasks, using the allocation free path.
+		constexpr std::size_t     batch  = 1000;
+		auto                      pool   = streamfx::threadpool();
+		std::atomic<size_t>       done   = 0;
+		threadpool::task_invoke_t invoke = [](void* context, threadpool::task_data_t) { static_cast<std::atomic<size_t>*>(context)->fetch_add(1, std::memory_order_release); };
+		results.push_back(benchmark::measure("Threadpool throughput", 100, batch, [&]() {
+			done.store(0, std::memory_order_relaxed);
+			for (std::size_t idx = 0; idx < batch; idx++) {
+				pool->push(invoke, &done);
+			}
+			while (done.load(std::memory_order_acquire) < batch) {
+				std::this_thread::yield();
+			}
+		}));
+	}
+
+	{ // Cost of recording a single measurement.
+		constexpr std::size_t batch   = 10000;
+		auto                  profile = profiler::create();
+		results.push_back(benchmark::measure("Profiler track", 100, batch, [profile]() {
+			for (std::size_t idx = 0; idx < batch; idx++) {
+				profile->track(std::chrono::nanoseconds(idx));
+			}
+		}));
+	}
+
+	{ // One full frame of 8-bit RGBA, as the encoders copy it.
+		constexpr std::size_t stride = ST_WIDTH * 4;
+		std::vector<uint8_t>  from(stride * ST_HEIGHT, 0x7F);
+		std::vector<uint8_t>  to(stride * ST_HEIGHT);
+		results.push_back(benchmark::measure("Copy plane", 200, 1, [&]() { copy::plane(to.data(), stride, from.data(), stride, stride, ST_HEIGHT); }));
+		results.push_back(benchmark::measure("Copy plane (parallel)", 200, 1, [&]() { copy::plane_parallel(to.data(), stride, from.data(), stride, stride, ST_HEIGHT); }));
+	}
+
+#ifdef ENABLE_ENCODER_FFMPEG
+	{ // The most common conversion, from what OBS renders to what encoders want.
+		streamfx::ffmpeg::swscale scaler;
+		scaler.set_source_size(ST_WIDTH, ST_HEIGHT);
+		scaler.set_source_color(false, AVCOL_SPC_BT709);
+		scaler.set_source_format(AV_PIX_FMT_BGRA);
+		scaler.set_target_size(ST_WIDTH, ST_HEIGHT);
+		scaler.set_target_color(false, AVCOL_SPC_BT709);
+		scaler.set_target_format(AV_PIX_FMT_NV12);
+		scaler.set_threads(std::max(std::thread::hardware_concurrency() / 2, 1u));
+		if (scaler.initialize(SWS_SINC | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND | SWS_BITEXACT)) {
+			uint8_t* source_data[4];
+			int      source_stride[4];
+			uint8_t* target_data[4];
+			int      target_stride[4];
+			if ((av_image_alloc(source_data, source_stride, ST_WIDTH, ST_HEIGHT, AV_PIX_FMT_BGRA, 32) >= 0)) {
+				if ((av_image_alloc(target_data, target_stride, ST_WIDTH, ST_HEIGHT, AV_PIX_FMT_NV12, 32) >= 0)) {
+					results.push_back(benchmark::measure("Convert BGRA to NV12", 100, 1, [&]() { scaler.convert(source_data, source_stride, 0, ST_HEIGHT, target_data, target_stride); }));
+					av_freep(&target_data[0]);
+				}
+				av_freep(&source_data[0]);
+			}
+		} else {
+			D_LOG_WARNING("Failed to initialize color conversion, skipping it.", nullptr);
+		}
+	}
+#endif
+
+#ifdef ENABLE_FILTER_BLUR
+	// Kernels are generated on construction, while the effect itself comes from the registry.
+	results.push_back(benchmark::measure("Gaussian kernel generation", 20, 1, []() { streamfx::gfx::blur::gaussian_data(); }));
+#endif
+
+	{ // Every source picker walks the tracked sources, usually more than once per refresh.
+		auto   tracker = streamfx::obs::source_tracker::instance();
+		size_t count   = 0;
+		results.push_back(benchmark::measure("Source tracker enumerate", 1000, 1, [&]() {
+			tracker->enumerate([&count](std::string, ::streamfx::obs::source) {
+				count++;
+				return false;
+			});
+		}));
+	}
+}
+
+#ifdef ENABLE_FILTER_BLUR
+static void run_gpu(std::vector<benchmark::result>& results)
+{
+	// Results of GPU timers trickle in a few frames late, so some of the last samples are never counted.
+	constexpr std::size_t samples = 200;
+
+	using namespace streamfx::gfx::blur;
+	std::vector<std::pair<std::string_view, ifactory*>> blurs = {
+		{"Blur Box", &box_factory::get()},
+		{"Blur Gaussian", &gaussian_factory::get()},
+		{"Blur Dual Filtering", &dual_filtering_factory::get()},
+		{"Blur Kawase", &kawase_factory::get()},
+	};
+
+	auto gctx  = streamfx::obs::gs::context();
+	auto input = std::make_shared<streamfx::obs::gs::texture>(ST_WIDTH, ST_HEIGHT, GS_RGBA, 1, nullptr, streamfx::obs::gs::texture::flags::None);
+
+	for (auto const& kv : blurs) {
+		try {
+			auto blur = kv.second->create(type::Area);
+			blur->set_input(input);
+			blur->set_size(16.);
+
+			auto                     profile = profiler::create();
+			streamfx::obs::gs::timer timer(profile);
+			for (std::size_t idx = 0; idx < samples; idx++) {
+				timer.begin();
+				blur->render();
+				timer.end();
+				gs_flush();
+			}
+
+			if (profile->count() == 0) {
+				D_LOG_WARNING("%.*s: GPU timing is not supported by this graphics API.", static_cast<int>(kv.first.size()), kv.first.data());
+				continue;
+			}
+			results.push_back(summarize(kv.first, profile, 1));
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("%.*s: %s", static_cast<int>(kv.first.size()), kv.first.data(), ex.what());
+		}
+	}
+}
+#endif
+
+std::vector<benchmark::result> benchmark::run_all()
+{
+	std::vector<result> results;
+
+	run_cpu(results);
+#ifdef ENABLE_FILTER_BLUR
+	run_gpu(results);
+#endif
+
+	for (auto const& res : results) {
+		report(res);
+	}
+	save(results, "core");
+
+	return results;
+}
+
+static std::shared_ptr<obs_source_t> create_private(const char* id, const char* name, obs_data_t* settings = nullptr)
+{
+	return std::shared_ptr<obs_source_t>{obs_source_create_private(id, name, settings), [](obs_source_t* v) { obs_source_release(v); }};
+}
+
+static std::shared_ptr<obs_source_t> create_color(uint32_t width, uint32_t height, uint32_t color)
+{
+	std::shared_ptr<obs_data_t> settings{obs_data_create(), [](obs_data_t* v) { obs_data_release(v); }};
+	obs_data_set_int(settings.get(), "width", width);
+	obs_data_set_int(settings.get(), "height", height);
+	obs_data_set_int(settings.get(), "color", color);
+	return create_private("color_source_v3", "StreamFX Benchmark Color", settings.get());
+}
+
+/** Render 'target' for a number of frames, while measuring its GPU time and the checksum of the result.
+ *
+ * The graphics context is only held for one frame at a time, so that OBS keeps rendering in between.
+ */
+static benchmark::result render(std::string name, obs_source_t* tick, obs_source_t* target, uint32_t width, uint32_t height, std::size_t frames)
+{
+	std::shared_ptr<profiler>                        profile = profiler::create();
+	std::shared_ptr<streamfx::obs::gs::timer>        timer;
+	std::shared_ptr<streamfx::obs::gs::rendertarget> rt;
+	std::shared_ptr<streamfx::gfx::checksum>         checksum;
+	uint64_t                                         hash = 0;
+	{
+		auto gctx = streamfx::obs::gs::context();
+		timer     = std::make_shared<streamfx::obs::gs::timer>(profile);
+		rt        = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		checksum  = std::make_shared<streamfx::gfx::checksum>();
+	}
+
+	for (std::size_t idx = 0; idx < frames; idx++) {
+		obs_source_video_tick(tick, 1.f / 60.f);
+
+		auto gctx = streamfx::obs::gs::context();
+		{
+			auto op = rt->render(width, height);
+			vec4 black;
+			vec4_zero(&black);
+			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
+			gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+
+			gs_blend_state_push();
+			gs_reset_blend_state();
+			gs_enable_color(true, true, true, true);
+			gs_set_cull_mode(GS_NEITHER);
+			gs_enable_depth_test(false);
+			gs_enable_stencil_test(false);
+			gs_enable_stencil_write(false);
+
+			timer->begin();
+			obs_source_video_render(target);
+			timer->end();
+
+			gs_blend_state_pop();
+		}
+		checksum->update(rt->get_texture(), hash);
+		gs_flush();
+	}
+
+	{
+		auto gctx = streamfx::obs::gs::context();
+		checksum->update(nullptr, hash);
+
+		// Everything has to be destroyed inside the graphics context.
+		checksum.reset();
+		rt.reset();
+		timer.reset();
+	}
+
+	auto res     = summarize(name, profile, 1);
+	res.checksum = hash;
+	return res;
+}
+
+std::vector<benchmark::result> benchmark::run_sources(std::size_t frames)
+{
+	static const std::pair<uint32_t, uint32_t> resolutions[] = {{1920, 1080}, {3840, 2160}};
+
+	// Only StreamFX types that render video and weren't disabled because something they need is missing.
+	auto collect = [](bool (*enumerate)(size_t, const char**)) {
+		std::vector<std::string> ids;
+		const char*              id = nullptr;
+		for (size_t idx = 0; enumerate(idx, &id); idx++) {
+			std::string_view view{id};
+			if (view.substr(0, std::string_view(S_PREFIX).length()) != S_PREFIX) {
+				continue;
+			}
+			uint32_t flags = obs_get_source_output_flags(id);
+			if (((flags & OBS_SOURCE_VIDEO) == 0) || ((flags & OBS_SOURCE_CAP_DISABLED) != 0)) {
+				continue;
+			}
+			ids.emplace_back(view);
+		}
+		return ids;
+	};
+
+	std::vector<result> results;
+	for (auto const& resolution : resolutions) {
+		uint32_t    width  = resolution.first;
+		uint32_t    height = resolution.second;
+		std::string suffix = " @ " + std::to_string(width) + "x" + std::to_string(height);
+
+		auto color_a = create_color(width, height, 0xFF3F7FBF);
+		auto color_b = create_color(width, height, 0xFFBF7F3F);
+		if (!color_a || !color_b) {
+			D_LOG_WARNING("Failed to create color sources, skipping filters and transitions.", nullptr);
+		}
+
+		if (color_a) {
+			for (auto const& id : collect(&obs_enum_filter_types)) {
+				try {
+					auto filter = create_private(id.c_str(), "StreamFX Benchmark");
+					if (!filter) {
+						continue;
+					}
+					obs_source_filter_add(color_a.get(), filter.get());
+					results.push_back(render(id + suffix, color_a.get(), color_a.get(), width, height, frames));
+					obs_source_filter_remove(color_a.get(), filter.get());
+				} catch (std::exception const& ex) {
+					D_LOG_WARNING("%s%s: %s", id.c_str(), suffix.c_str(), ex.what());
+				}
+			}
+		}
+
+		for (auto const& id : collect(&obs_enum_source_types)) {
+			try {
+				auto source = create_private(id.c_str(), "StreamFX Benchmark");
+				if (!source) {
+					continue;
+				}
+				results.push_back(render(id + suffix, source.get(), source.get(), width, height, frames));
+			} catch (std::exception const& ex) {
+				D_LOG_WARNING("%s%s: %s", id.c_str(), suffix.c_str(), ex.what());
+			}
+		}
+
+		if (color_a && color_b) {
+			for (auto const& id : collect(&obs_enum_transition_types)) {
+				try {
+					auto transition = create_private(id.c_str(), "StreamFX Benchmark");
+					if (!transition) {
+						continue;
+					}
+					obs_transition_set_size(transition.get(), width, height);
+					obs_transition_set(transition.get(), color_a.get());
+					obs_transition_start(transition.get(), OBS_TRANSITION_MODE_MANUAL, 0, color_b.get());
+					obs_transition_set_manual_time(transition.get(), .5f);
+					results.push_back(render(id + suffix, transition.get(), transition.get(), width, height, frames));
+					obs_transition_clear(transition.get());
+				} catch (std::exception const& ex) {
+					D_LOG_WARNING("%s%s: %s", id.c_str(), suffix.c_str(), ex.what());
+				}
+			}
+		}
+	}
+
+	for (auto const& res : results) {
+		report(res);
+	}
+	save(results, "sources");
+
+	return results;
+}
@@ -0,0 +1,47 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::benchmark {
+	struct result {
+		std::string              name;
+		std::size_t              operations;
+		double                   per_second;
+		std::chrono::nanoseconds median; // Of a single operation.
+		std::chrono::nanoseconds p95;
+		std::chrono::nanoseconds p99;
+		uint64_t                 checksum; // Of the last rendered frame, or zero if nothing was rendered.
+	};
+
+	/** Time 'samples' calls of 'function', each of which performs 'batch' operations.
+	 *
+	 * Operations that take less than a few microseconds should be batched, as the clock would otherwise dominate.
+	 */
+	result measure(std::string_view name, std::size_t samples, std::size_t batch, std::function<void()> function);
+
+	/** Run the micro-benchmarks of the hot paths in StreamFX, on the CPU and in the graphics context.
+	 *
+	 * Results are logged and written to 'benchmarks/' in the configuration directory, so that releases can be compared
+	 * with each other. Must not be called from the graphics thread.
+	 */
+	std::vector<result> run_all();
+
+	/** Render every filter, source and transition of StreamFX with its default settings at 1080p and 4K.
+	 *
+	 * Each instance renders 'frames' frames in isolation, which measures GPU time per instance. Filters are applied
+	 * to a solid color source, and transitions are held halfway between two of them. Comparing the checksums of two
+	 * runs on the same GPU tells whether an optimization changed the output.
+	 */
+	std::vector<result> run_sources(std::size_t frames);
+} // namespace streamfx::util::benchmark
@@ -0,0 +1,317 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-color.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <emmintrin.h>
+#define ST_SIMD_SSE2
+#elif defined(D_PLATFORM_INSTR_ARM) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define ST_SIMD_NEON
+#endif
+#include "warning-enable.hpp"
+
+// Keeps divisions by chroma finite for grey, same as in color_conversion_rgb_hsv.effect.
+constexpr float epsilon = 1.0e-10f;
+
+namespace {
+	// The conversions are written once against these helpers, and instantiated for a single float and for a vector of
+	// four, so that the SIMD path and the remainder never disagree.
+	inline float vmin(float a, float b)
+	{
+		return std::min(a, b);
+	}
+	inline float vmax(float a, float b)
+	{
+		return std::max(a, b);
+	}
+	inline float vabs(float a)
+	{
+		return std::fabs(a);
+	}
+	inline float vfloor(float a)
+	{
+		return std::floor(a);
+	}
+	inline bool vge(float a, float b)
+	{
+		return a >= b;
+	}
+	inline float vselect(bool mask, float a, float b)
+	{
+		return mask ? a : b;
+	}
+
+#if defined(ST_SIMD_SSE2)
+	struct f32x4 {
+		__m128 v;
+
+		f32x4(__m128 value) : v(value) {}
+		f32x4(float value) : v(_mm_set1_ps(value)) {}
+	};
+	inline f32x4 operator+(f32x4 a, f32x4 b)
+	{
+		return _mm_add_ps(a.v, b.v);
+	}
+	inline f32x4 operator-(f32x4 a, f32x4 b)
+	{
+		return _mm_sub_ps(a.v, b.v);
+	}
+	inline f32x4 operator*(f32x4 a, f32x4 b)
+	{
+		return _mm_mul_ps(a.v, b.v);
+	}
+	inline f32x4 operator/(f32x4 a, f32x4 b)
+	{
+		return _mm_div_ps(a.v, b.v);
+	}
+	inline f32x4 vmin(f32x4 a, f32x4 b)
+	{
+		return _mm_min_ps(a.v, b.v);
+	}
+	inline f32x4 vmax(f32x4 a, f32x4 b)
+	{
+		return _mm_max_ps(a.v, b.v);
+	}
+	inline f32x4 vabs(f32x4 a)
+	{
+		return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v);
+	}
+	inline f32x4 vfloor(f32x4 a)
+	{
+		// SSE2 only truncates, so step down where that rounded up. Hues stay far inside the range of an int.
+		__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+		return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.f)));
+	}
+	inline __m128 vge(f32x4 a, f32x4 b)
+	{
+		return _mm_cmpge_ps(a.v, b.v);
+	}
+	inline f32x4 vselect(__m128 mask, f32x4 a, f32x4 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v));
+	}
+#elif defined(ST_SIMD_NEON)
+	struct f32x4 {
+		float32x4_t v;
+
+		f32x4(float32x4_t value) : v(value) {}
+		f32x4(float value) : v(vdupq_n_f32(value)) {}
+	};
+	inline f32x4 operator+(f32x4 a, f32x4 b)
+	{
+		return vaddq_f32(a.v, b.v);
+	}
+	inline f32x4 operator-(f32x4 a, f32x4 b)
+	{
+		return vsubq_f32(a.v, b.v);
+	}
+	inline f32x4 operator*(f32x4 a, f32x4 b)
+	{
+		return vmulq_f32(a.v, b.v);
+	}
+	inline f32x4 operator/(f32x4 a, f32x4 b)
+	{
+		return vdivq_f32(a.v, b.v);
+	}
+	inline f32x4 vmin(f32x4 a, f32x4 b)
+	{
+		return vminq_f32(a.v, b.v);
+	}
+	inline f32x4 vmax(f32x4 a, f32x4 b)
+	{
+		return vmaxq_f32(a.v, b.v);
+	}
+	inline f32x4 vabs(f32x4 a)
+	{
+		return vabsq_f32(a.v);
+	}
+	inline f32x4 vfloor(f32x4 a)
+	{
+		return vrndmq_f32(a.v);
+	}
+	inline uint32x4_t vge(f32x4 a, f32x4 b)
+	{
+		return vcgeq_f32(a.v, b.v);
+	}
+	inline f32x4 vselect(uint32x4_t mask, f32x4 a, f32x4 b)
+	{
+		return vbslq_f32(mask, a.v, b.v);
+	}
+#endif
+
+	template<typename V>
+	inline V vclamp01(V a)
+	{
+		return vmin(vmax(a, V(0.f)), V(1.f));
+	}
+
+	// Hue, chroma and value, see RGBtoHCV in color_conversion_rgb_hsv.effect.
+	template<typename V>
+	inline void rgb_to_hcv(V& r, V& g, V& b)
+	{
+		auto m1 = vge(g, b);
+		V    px = vselect(m1, g, b);
+		V    py = vselect(m1, b, g);
+		V    pz = vselect(m1, V(0.f), V(-1.f));
+		V    pw = vselect(m1, V(-1.f / 3.f), V(2.f / 3.f));
+
+		auto m2 = vge(r, px);
+		V    qx = vselect(m2, r, px);
+		V    qz = vselect(m2, pz, pw);
+		V    qw = vselect(m2, px, r);
+
+		V c = qx - vmin(qw, py);
+		r   = vabs(qz + (qw - py) / (V(6.f) * c + V(epsilon)));
+		g   = c;
+		b   = qx;
+	}
+
+	template<typename V>
+	inline V hue_to_channel(V h, float offset)
+	{
+		V x = h + V(offset);
+		return vclamp01(vabs((x - vfloor(x)) * V(6.f) - V(3.f)) - V(1.f));
+	}
+
+	template<typename V>
+	inline void rgb_to_hsv(V& r, V& g, V& b)
+	{
+		rgb_to_hcv(r, g, b);
+		g = g / (b + V(epsilon));
+	}
+
+	template<typename V>
+	inline void hsv_to_rgb(V& h, V& s, V& v)
+	{
+		V r = hue_to_channel(h, 1.f);
+		V g = hue_to_channel(h, 2.f / 3.f);
+		V b = hue_to_channel(h, 1.f / 3.f);
+		h   = v * (V(1.f) + (r - V(1.f)) * s);
+		V t = v * (V(1.f) + (g - V(1.f)) * s);
+		v   = v * (V(1.f) + (b - V(1.f)) * s);
+		s   = t;
+	}
+
+	template<typename V>
+	inline void rgb_to_hsl(V& r, V& g, V& b)
+	{
+		rgb_to_hcv(r, g, b);
+		V l = b - g * V(.5f);
+		g   = g / (V(1.f) - vabs(l * V(2.f) - V(1.f)) + V(epsilon));
+		b   = l;
+	}
+
+	template<typename V>
+	inline void hsl_to_rgb(V& h, V& s, V& l)
+	{
+		V k = s * (V(1.f) - vabs(V(2.f) * l - V(1.f)));
+		V r = hue_to_channel(h, 1.f);
+		V g = hue_to_channel(h, 2.f / 3.f);
+		V b = hue_to_channel(h, 1.f / 3.f);
+		h   = l + (r - V(.5f)) * k;
+		s   = l + (g - V(.5f)) * k;
+		l   = l + (b - V(.5f)) * k;
+	}
+
+	template<typename V>
+	inline void multiply(V& x, V& y, V& z, streamfx::util::color::matrix_t const& m, float ox, float oy, float oz)
+	{
+		V a = x + V(ox);
+		V b = y + V(oy);
+		V c = z + V(oz);
+		x   = V(m[0]) * a + V(m[1]) * b + V(m[2]) * c;
+		y   = V(m[3]) * a + V(m[4]) * b + V(m[5]) * c;
+		z   = V(m[6]) * a + V(m[7]) * b + V(m[8]) * c;
+	}
+
+	// Run a conversion over interleaved RGBA, four pixels at a time where possible.
+	template<typename F>
+	void transform(float* to, const float* from, size_t count, F&& fn)
+	{
+		size_t idx = 0;
+#if defined(ST_SIMD_SSE2)
+		for (; (idx + 4) <= count; idx += 4) {
+			__m128 p0 = _mm_loadu_ps(from + idx * 4);
+			__m128 p1 = _mm_loadu_ps(from + idx * 4 + 4);
+			__m128 p2 = _mm_loadu_ps(from + idx * 4 + 8);
+			__m128 p3 = _mm_loadu_ps(from + idx * 4 + 12);
+			_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+			f32x4 x = p0, y = p1, z = p2;
+			fn(x, y, z);
+
+			p0 = x.v;
+			p1 = y.v;
+			p2 = z.v;
+			_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+			_mm_storeu_ps(to + idx * 4, p0);
+			_mm_storeu_ps(to + idx * 4 + 4, p1);
+			_mm_storeu_ps(to + idx * 4 + 8, p2);
+			_mm_storeu_ps(to + idx * 4 + 12, p3);
+		}
+#elif defined(ST_SIMD_NEON)
+		for (; (idx + 4) <= count; idx += 4) {
+			float32x4x4_t px = vld4q_f32(from + idx * 4);
+
+			f32x4 x = px.val[0], y = px.val[1], z = px.val[2];
+			fn(x, y, z);
+
+			px.val[0] = x.v;
+			px.val[1] = y.v;
+			px.val[2] = z.v;
+			vst4q_f32(to + idx * 4, px);
+		}
+#endif
+		for (; idx < count; idx++) {
+			float x = from[idx * 4];
+			float y = from[idx * 4 + 1];
+			float z = from[idx * 4 + 2];
+			float w = from[idx * 4 + 3];
+			fn(x, y, z);
+			to[idx * 4]     = x;
+			to[idx * 4 + 1] = y;
+			to[idx * 4 + 2] = z;
+			to[idx * 4 + 3] = w;
+		}
+	}
+} // namespace
+
+void streamfx::util::color::rgba_to_hsva(float* to, const float* from, size_t count)
+{
+	transform(to, from, count, [](auto& x, auto& y, auto& z) { rgb_to_hsv(x, y, z); });
+}
+
+void streamfx::util::color::hsva_to_rgba(float* to, const float* from, size_t count)
+{
+	transform(to, from, count, [](auto& x, auto& y, auto& z) { hsv_to_rgb(x, y, z); });
+}
+
+void streamfx::util::color::rgba_to_hsla(float* to, const float* from, size_t count)
+{
+	transform(to, from, count, [](auto& x, auto& y, auto& z) { rgb_to_hsl(x, y, z); });
+}
+
+void streamfx::util::color::hsla_to_rgba(float* to, const float* from, size_t count)
+{
+	transform(to, from, count, [](auto& x, auto& y, auto& z) { hsl_to_rgb(x, y, z); });
+}
+
+void streamfx::util::color::rgba_to_yuva(float* to, const float* from, size_t count, matrix_t const& matrix)
+{
+	transform(to, from, count, [&matrix](auto& x, auto& y, auto& z) {
+		multiply(x, y, z, matrix, 0.f, 0.f, 0.f);
+		y = y + .5f;
+		z = z + .5f;
+	});
+}
+
+void streamfx::util::color::yuva_to_rgba(float* to, const float* from, size_t count, matrix_t const& matrix)
+{
+	transform(to, from, count, [&matrix](auto& x, auto& y, auto& z) { multiply(x, y, z, matrix, 0.f, -.5f, -.5f); });
+}
@@ -0,0 +1,37 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <cstddef>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::color {
+	/** Row-major 3x3 matrix from RGB to YUV or back. */
+	typedef std::array<float, 9> matrix_t;
+
+	/** BT.709 with chroma normalized to [-0.5, 0.5], like YUV_709_NORM in color_conversion_rgb_yuv.effect. */
+	static constexpr matrix_t bt709_rgb_to_yuv = {0.2126f, 0.7152f, 0.0722f, -0.1145721060573399f, -0.3854278939426601f, 0.5f, 0.5f, -0.4541529083058166f, -0.0458470916941834f};
+	static constexpr matrix_t bt709_yuv_to_rgb = {1.f, 0.f, 1.5748f, 1.f, -0.187324f, -0.468124f, 1.f, 1.8556f, 0.f};
+
+	/* CPU counterparts to color_conversion.effect, for data that was read back from the GPU.
+	 *
+	 * All of these work on 'count' pixels of four floats each, with alpha passed through untouched, and may convert in
+	 * place. The math is the same as the branchless variants on the GPU, so values round trip between both within
+	 * float precision. SSE2 or NEON is used where available.
+	 */
+
+	void rgba_to_hsva(float* to, const float* from, size_t count);
+	void hsva_to_rgba(float* to, const float* from, size_t count);
+
+	void rgba_to_hsla(float* to, const float* from, size_t count);
+	void hsla_to_rgba(float* to, const float* from, size_t count);
+
+	/** Chroma is offset by 0.5, like RGBtoYUV in color_conversion_rgb_yuv.effect. */
+	void rgba_to_yuva(float* to, const float* from, size_t count, matrix_t const& matrix = bt709_rgb_to_yuv);
+	void yuva_to_rgba(float* to, const float* from, size_t count, matrix_t const& matrix = bt709_yuv_to_rgb);
+} // namespace streamfx::util::color
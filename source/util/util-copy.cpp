@@ -0,0 +1,151 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-copy.hpp"
+#include "plugin.hpp"
+#include "util/util-cpu.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include <thread>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <immintrin.h>
+#elif defined(D_PLATFORM_INSTR_ARM)
+#include <arm_neon.h>
+#endif
+#include "warning-enable.hpp"
+
+// Copies smaller than this stay in the cache, where regular stores are faster.
+constexpr size_t streaming_threshold = 1024 * 1024;
+
+// Copies are only split across the threadpool if each part is at least this large.
+constexpr size_t parallel_threshold = 2 * 1024 * 1024;
+constexpr size_t parallel_max_parts = 8;
+
+typedef void (*kernel_t)(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows);
+
+static void copy_generic(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows)
+{
+	if ((to_stride == from_stride) && (to_stride == bytes)) {
+		std::memcpy(to, from, bytes * rows);
+		return;
+	}
+
+	for (size_t y = 0; y < rows; y++) {
+		std::memcpy(to, from, bytes);
+		to += to_stride;
+		from += from_stride;
+	}
+}
+
+#if defined(D_PLATFORM_INSTR_X86)
+P_CPU_TARGET("avx2")
+static void copy_avx2(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows)
+{
+	for (size_t y = 0; y < rows; y++) {
+		uint8_t*       dst = to + to_stride * y;
+		const uint8_t* src = from + from_stride * y;
+		size_t         len = bytes;
+
+		// Non-temporal stores need an aligned destination, so copy the unaligned head normally.
+		size_t head = (32 - (reinterpret_cast<uintptr_t>(dst) & 31)) & 31;
+		if (head > len) {
+			head = len;
+		}
+		std::memcpy(dst, src, head);
+		dst += head;
+		src += head;
+		len -= head;
+
+		for (; len >= 128; len -= 128, dst += 128, src += 128) {
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+			__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+			__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), c);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), d);
+		}
+		for (; len >= 32; len -= 32, dst += 32, src += 32) {
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+		}
+		std::memcpy(dst, src, len);
+	}
+
+	// Make the streamed data visible to other threads before anyone is told the copy is done.
+	_mm_sfence();
+}
+#elif defined(D_PLATFORM_INSTR_ARM)
+static void copy_neon(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows)
+{
+	for (size_t y = 0; y < rows; y++) {
+		uint8_t*       dst = to + to_stride * y;
+		const uint8_t* src = from + from_stride * y;
+		size_t         len = bytes;
+
+		for (; len >= 64; len -= 64, dst += 64, src += 64) {
+			uint8x16_t a = vld1q_u8(src);
+			uint8x16_t b = vld1q_u8(src + 16);
+			uint8x16_t c = vld1q_u8(src + 32);
+			uint8x16_t d = vld1q_u8(src + 48);
+			vst1q_u8(dst, a);
+			vst1q_u8(dst + 16, b);
+			vst1q_u8(dst + 32, c);
+			vst1q_u8(dst + 48, d);
+		}
+		std::memcpy(dst, src, len);
+	}
+}
+#endif
+
+static kernel_t select_kernel()
+{
+	using namespace streamfx::util::cpu;
+#if defined(D_PLATFORM_INSTR_X86)
+	return select<kernel_t>({{feature::AVX2, copy_avx2}}, copy_generic);
+#elif defined(D_PLATFORM_INSTR_ARM)
+	return select<kernel_t>({{feature::NEON, copy_neon}}, copy_generic);
+#else
+	return copy_generic;
+#endif
+}
+
+void streamfx::util::copy::plane(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows)
+{
+	static const kernel_t kernel = select_kernel();
+
+	if ((bytes * rows) < streaming_threshold) {
+		copy_generic(to, to_stride, from, from_stride, bytes, rows);
+	} else {
+		kernel(to, to_stride, from, from_stride, bytes, rows);
+	}
+}
+
+void streamfx::util::copy::plane_parallel(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows)
+{
+	size_t parts = std::min<size_t>({(bytes * rows) / parallel_threshold, parallel_max_parts, static_cast<size_t>(std::thread::hardware_concurrency())});
+	if (parts <= 1) {
+		plane(to, to_stride, from, from_stride, bytes, rows);
+		return;
+	}
+
+	// Hand all but the first part to the threadpool, and copy the first part on this thread.
+	size_t                                 rows_per_part = (rows + parts - 1) / parts;
+	streamfx::util::threadpool::task_group group{streamfx::threadpool()};
+	for (size_t part = 1; part < parts; part++) {
+		size_t begin = rows_per_part * part;
+		if (begin >= rows) {
+			break;
+		}
+		size_t count = std::min(rows_per_part, rows - begin);
+		group.push(
+			[to, to_stride, from, from_stride, bytes, begin, count](streamfx::util::threadpool::task_data_t) {
+				plane(to + to_stride * begin, to_stride, from + from_stride * begin, from_stride, bytes, count);
+			},
+			nullptr, streamfx::util::threadpool::priority::REALTIME);
+	}
+	plane(to, to_stride, from, from_stride, bytes, std::min(rows_per_part, rows));
+	group.wait_all();
+}
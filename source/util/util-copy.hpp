@@ -0,0 +1,24 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::copy {
+	/** Copy 'rows' rows of 'bytes' each from one strided buffer to another.
+	 *
+	 * Picks the fastest kernel the CPU supports at runtime. Large copies bypass the cache with non-temporal stores, as the
+	 * destination is usually consumed by a different thread or device.
+	 */
+	void plane(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows);
+
+	/** Same as plane(), but splits the rows of large copies across the threadpool and waits for them to finish.
+	 */
+	void plane_parallel(uint8_t* to, size_t to_stride, const uint8_t* from, size_t from_stride, size_t bytes, size_t rows);
+} // namespace streamfx::util::copy
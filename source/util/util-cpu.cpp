@@ -0,0 +1,144 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-cpu.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <utility>
+#if defined(D_PLATFORM_INSTR_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::cpu> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+using namespace streamfx::util::cpu;
+
+static feature detect()
+{
+	feature result = feature::None;
+
+#if defined(D_PLATFORM_INSTR_X86)
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int leaves = info[0];
+
+	__cpuid(info, 1);
+	if (info[3] & (1 << 26)) {
+		result = result | feature::SSE2;
+	}
+	if (info[2] & (1 << 20)) {
+		result = result | feature::SSE4_2;
+	}
+
+	// Anything using YMM or ZMM registers also needs the OS to save them on a context switch.
+	bool     osxsave = (info[2] & (1 << 27)) != 0;
+	uint64_t xcr0    = osxsave ? _xgetbv(0) : 0;
+	bool     ymm     = (xcr0 & 0x06) == 0x06;
+	bool     zmm     = (xcr0 & 0xE6) == 0xE6;
+	if (ymm && (info[2] & (1 << 28))) {
+		result = result | feature::AVX;
+	}
+	if (ymm && (info[2] & (1 << 12))) {
+		result = result | feature::FMA;
+	}
+
+	if (leaves >= 7) {
+		__cpuidex(info, 7, 0);
+		if (ymm && (info[1] & (1 << 5))) {
+			result = result | feature::AVX2;
+		}
+		if (zmm && (info[1] & (1 << 16))) {
+			result = result | feature::AVX512F;
+		}
+		if (zmm && (info[1] & (1 << 30))) {
+			result = result | feature::AVX512BW;
+		}
+	}
+#else
+	// Already takes care of checking what the OS saves.
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		result = result | feature::SSE2;
+	}
+	if (__builtin_cpu_supports("sse4.2")) {
+		result = result | feature::SSE4_2;
+	}
+	if (__builtin_cpu_supports("avx")) {
+		result = result | feature::AVX;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		result = result | feature::AVX2;
+	}
+	if (__builtin_cpu_supports("fma")) {
+		result = result | feature::FMA;
+	}
+	if (__builtin_cpu_supports("avx512f")) {
+		result = result | feature::AVX512F;
+	}
+	if (__builtin_cpu_supports("avx512bw")) {
+		result = result | feature::AVX512BW;
+	}
+#endif
+#elif defined(D_PLATFORM_INSTR_ARM)
+	// NEON is part of every 64-bit ARM CPU, and of every 32-bit one we are compiled for with it.
+#if defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+	result = result | feature::NEON;
+#endif
+#endif
+
+	return result;
+}
+
+feature streamfx::util::cpu::features()
+{
+	static const feature value = detect();
+	return value;
+}
+
+bool streamfx::util::cpu::supports(feature required)
+{
+	return has(features(), required);
+}
+
+std::string streamfx::util::cpu::to_string(feature value)
+{
+	std::pair<feature, const char*> names[] = {
+		{feature::SSE2, "SSE2"}, {feature::SSE4_2, "SSE4.2"}, {feature::AVX, "AVX"}, {feature::AVX2, "AVX2"}, {feature::FMA, "FMA"}, {feature::AVX512F, "AVX-512F"}, {feature::AVX512BW, "AVX-512BW"}, {feature::NEON, "NEON"},
+	};
+
+	std::string result;
+	for (auto const& name : names) {
+		if (has(value, name.first)) {
+			if (!result.empty()) {
+				result += ", ";
+			}
+			result += name.second;
+		}
+	}
+	return result.empty() ? std::string("None") : result;
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		D_LOG_INFO("Detected CPU features: %s", to_string(features()).c_str());
+	},
+	[]() { // Finalizer
+	},
+	streamfx::loader_priority::HIGH); // Logged after logging started, and detected before anything picks a kernel.
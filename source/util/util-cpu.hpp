@@ -0,0 +1,73 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "util/util-bitmask.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include "warning-enable.hpp"
+
+// Compile a single function for a newer instruction set than the rest of the file, to be picked by cpu::select().
+#if defined(__GNUC__) || defined(__clang__)
+#define P_CPU_TARGET(x) __attribute__((target(x)))
+#else
+#define P_CPU_TARGET(x)
+#endif
+
+namespace streamfx::util::cpu {
+	enum class feature : uint32_t {
+		None = 0,
+
+		// x86
+		SSE2     = 1 << 0,
+		SSE4_2   = 1 << 1,
+		AVX      = 1 << 2,
+		AVX2     = 1 << 3,
+		FMA      = 1 << 4,
+		AVX512F  = 1 << 5,
+		AVX512BW = 1 << 6,
+
+		// ARM
+		NEON = 1 << 16,
+	};
+
+	//! Features of the CPU we are running on, including whether the OS saves the registers they need.
+	//
+	// Detected on first use and cached for the lifetime of the process.
+	feature features();
+
+	//! Check if the CPU supports every one of the given features.
+	bool supports(feature required);
+
+	std::string to_string(feature value);
+
+	template<typename T>
+	struct kernel {
+		feature required;
+		T       function;
+	};
+
+	//! Pick the first kernel the CPU supports, or the fallback if it supports none of them.
+	//
+	// Kernels are listed from best to worst, and the fallback must run everywhere. Meant to be stored in a static, so
+	// that the decision is only made once:
+	//
+	//   static const kernel_t kernel = cpu::select<kernel_t>({{cpu::feature::AVX2, scan_avx2}}, scan_generic);
+	template<typename T>
+	inline T select(std::initializer_list<kernel<T>> kernels, T fallback)
+	{
+		for (auto const& candidate : kernels) {
+			if (supports(candidate.required)) {
+				return candidate.function;
+			}
+		}
+		return fallback;
+	}
+} // namespace streamfx::util::cpu
+
+P_ENABLE_BITMASK_OPERATORS(streamfx::util::cpu::feature)
@@ -4,6 +4,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "util-curl.hpp"
+#include "common.hpp"
 
 #include "warning-disable.hpp"
 #include <sstream>
@@ -70,6 +71,15 @@ size_t streamfx::util::curl::write_helper(void* ptr, size_t size, size_t count,
 	}
 }
 
+size_t streamfx::util::curl::header_helper(void* ptr, size_t size, size_t count, streamfx::util::curl* self)
+{
+	if (self->_header_callback) {
+		return self->_header_callback(ptr, size, count);
+	} else {
+		return size * count;
+	}
+}
+
 int32_t streamfx::util::curl::xferinfo_callback(streamfx::util::curl* self, curl_off_t dlt, curl_off_t dln, curl_off_t ult, curl_off_t uln)
 {
 	if (self->_xferinfo_callback) {
@@ -79,11 +89,12 @@ int32_t streamfx::util::curl::xferinfo_callback(streamfx::util::curl* self, curl
 	}
 }
 
-streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _headers()
+streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _header_callback(), _headers(), _header_list(nullptr)
 {
 	_curl = curl_easy_init();
 	set_read_callback(nullptr);
 	set_write_callback(nullptr);
+	set_header_callback(nullptr);
 	set_xferinfo_callback(nullptr);
 	set_debug_callback(nullptr);
 
@@ -91,6 +102,7 @@ streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _he
 	set_option(CURLOPT_NOPROGRESS, false);
 	set_option(CURLOPT_PATH_AS_IS, false);
 	set_option(CURLOPT_CRLF, false);
+	set_option(CURLOPT_ACCEPT_ENCODING, ""); // Anything this build of CURL can decompress.
 #ifdef _DEBUG
 	set_option(CURLOPT_VERBOSE, true);
 #else
@@ -100,6 +112,7 @@ streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _he
 
 streamfx::util::curl::~curl()
 {
+	release_headers();
 	curl_easy_cleanup(_curl);
 }
 
@@ -123,43 +136,36 @@ size_t perform_get_kv_size(std::string_view a, std::string_view b)
 	return a.size() + 2 + b.size() + 1;
 };
 
-CURLcode streamfx::util::curl::perform()
+void streamfx::util::curl::apply_headers()
 {
-	std::vector<char>  buffer;
-	struct curl_slist* headers = nullptr;
-
-	if (_headers.size() > 0) {
-		// Calculate full buffer size.
-		{
-			size_t buffer_size = 0;
-			for (const auto& kv : _headers) {
-				buffer_size += perform_get_kv_size(kv.first, kv.second);
-			}
-			buffer.resize(buffer_size * 2);
-		}
-		// Create HTTP Headers.
-		{
-			size_t buffer_offset = 0;
-			for (const auto& kv : _headers) {
-				size_t size = perform_get_kv_size(kv.first, kv.second);
-
-				snprintf(&buffer.at(buffer_offset), size, "%s: %s", kv.first.c_str(), kv.second.c_str());
-
-				headers = curl_slist_append(headers, &buffer.at(buffer_offset));
-
-				buffer_offset += size;
-			}
-		}
-		set_option<struct curl_slist*>(CURLOPT_HTTPHEADER, headers);
+	release_headers();
+	if (_headers.size() == 0) {
+		return;
 	}
 
-	CURLcode res = curl_easy_perform(_curl);
+	std::string line;
+	for (const auto& kv : _headers) {
+		line.reserve(perform_get_kv_size(kv.first, kv.second));
+		line.assign(kv.first).append(": ").append(kv.second);
+		_header_list = curl_slist_append(_header_list, line.c_str());
+	}
+	set_option<struct curl_slist*>(CURLOPT_HTTPHEADER, _header_list);
+}
 
-	if (headers) {
+void streamfx::util::curl::release_headers()
+{
+	if (_header_list) {
 		set_option<struct curl_slist*>(CURLOPT_HTTPHEADER, nullptr);
-		curl_slist_free_all(headers);
+		curl_slist_free_all(_header_list);
+		_header_list = nullptr;
 	}
+}
 
+CURLcode streamfx::util::curl::perform()
+{
+	apply_headers();
+	CURLcode res = curl_easy_perform(_curl);
+	release_headers();
 	return res;
 }
 
@@ -184,6 +190,14 @@ CURLcode streamfx::util::curl::set_write_callback(curl_io_callback_t cb)
 	return curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, &write_helper);
 }
 
+CURLcode streamfx::util::curl::set_header_callback(curl_io_callback_t cb)
+{
+	_header_callback = std::move(cb);
+	if (CURLcode res = curl_easy_setopt(_curl, CURLOPT_HEADERDATA, this); res != CURLE_OK)
+		return res;
+	return curl_easy_setopt(_curl, CURLOPT_HEADERFUNCTION, &header_helper);
+}
+
 CURLcode streamfx::util::curl::set_xferinfo_callback(curl_xferinfo_callback_t cb)
 {
 	_xferinfo_callback = std::move(cb);
@@ -199,3 +213,144 @@ CURLcode streamfx::util::curl::set_debug_callback(curl_debug_callback_t cb)
 		return res;
 	return curl_easy_setopt(_curl, CURLOPT_DEBUGFUNCTION, &debug_helper);
 }
+
+streamfx::util::curl_multi::curl_multi() : _multi(), _lock(), _changed(), _queued(), _active(), _cancelled(), _current(nullptr), _stop(false), _thread()
+{
+	_multi = curl_multi_init();
+	if (!_multi) {
+		throw std::runtime_error("Failed to create CURL multi handle.");
+	}
+	_thread = std::thread([this]() { run(); });
+}
+
+streamfx::util::curl_multi::~curl_multi()
+{
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		_stop = true;
+	}
+	curl_multi_wakeup(_multi);
+	_thread.join();
+
+	// Anything still running is abandoned without calling back.
+	for (auto& kv : _active) {
+		curl_multi_remove_handle(_multi, kv.first);
+		kv.second.first->release_headers();
+	}
+	_active.clear();
+	_queued.clear();
+	curl_multi_cleanup(_multi);
+}
+
+void streamfx::util::curl_multi::perform(std::shared_ptr<streamfx::util::curl> request, callback_t callback)
+{
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		_queued.emplace_back(std::move(request), std::move(callback));
+	}
+	curl_multi_wakeup(_multi);
+}
+
+void streamfx::util::curl_multi::cancel(std::shared_ptr<streamfx::util::curl> request)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	for (auto iter = _queued.begin(); iter != _queued.end(); iter++) {
+		if (iter->first == request) {
+			_queued.erase(iter);
+			return;
+		}
+	}
+
+	if (_active.find(request->_curl) != _active.end()) {
+		_cancelled.push_back(request);
+		curl_multi_wakeup(_multi);
+	}
+	_changed.wait(lock, [this, &request]() { return _stop || ((_active.find(request->_curl) == _active.end()) && (_current != request.get())); });
+}
+
+void streamfx::util::curl_multi::run()
+{
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			if (_stop) {
+				break;
+			}
+
+			for (auto& entry : _queued) {
+				entry.first->apply_headers();
+				curl_multi_add_handle(_multi, entry.first->_curl);
+				_active.emplace(entry.first->_curl, std::move(entry));
+			}
+			_queued.clear();
+
+			for (auto& request : _cancelled) {
+				if (auto kv = _active.find(request->_curl); kv != _active.end()) {
+					curl_multi_remove_handle(_multi, kv->first);
+					kv->second.first->release_headers();
+					_active.erase(kv);
+				}
+			}
+			_cancelled.clear();
+		}
+		_changed.notify_all();
+
+		int running = 0;
+		curl_multi_perform(_multi, &running);
+
+		int left = 0;
+		while (CURLMsg* msg = curl_multi_info_read(_multi, &left)) {
+			if (msg->msg != CURLMSG_DONE) {
+				continue;
+			}
+
+			// The message does not survive removing the handle, so copy what is needed first.
+			CURL*    handle = msg->easy_handle;
+			CURLcode result = msg->data.result;
+			entry_t  entry;
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+				auto                         kv = _active.find(handle);
+				if (kv == _active.end()) {
+					continue;
+				}
+				entry = std::move(kv->second);
+				_active.erase(kv);
+				curl_multi_remove_handle(_multi, handle);
+				entry.first->release_headers();
+				_current = entry.first.get();
+			}
+
+			try {
+				entry.second(result);
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("<CURL> Callback threw exception: %s", ex.what());
+			} catch (...) {
+				DLOG_ERROR("<CURL> Callback threw unknown exception.");
+			}
+
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+				_current = nullptr;
+			}
+			_changed.notify_all();
+		}
+
+		curl_multi_poll(_multi, nullptr, 0, 1000, nullptr);
+	}
+	_changed.notify_all();
+}
+
+std::shared_ptr<streamfx::util::curl_multi> streamfx::util::curl_multi::instance()
+{
+	static std::weak_ptr<streamfx::util::curl_multi> winst;
+	static std::mutex                                mtx;
+
+	std::unique_lock<std::mutex> lock(mtx);
+	auto                         instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::util::curl_multi>(new streamfx::util::curl_multi());
+		winst    = instance;
+	}
+	return instance;
+}
@@ -6,10 +6,15 @@
 #pragma once
 #include "warning-disable.hpp"
 #include <cinttypes>
+#include <condition_variable>
 #include <cstring>
 #include <functional>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include "warning-enable.hpp"
 
@@ -28,15 +33,23 @@ namespace streamfx::util {
 		CURL*                              _curl;
 		curl_io_callback_t                 _read_callback;
 		curl_io_callback_t                 _write_callback;
+		curl_io_callback_t                 _header_callback;
 		curl_xferinfo_callback_t           _xferinfo_callback;
 		curl_debug_callback_t              _debug_callback;
 		std::map<std::string, std::string> _headers;
+		struct curl_slist*                 _header_list;
 
 		static int32_t debug_helper(CURL* handle, curl_infotype type, char* data, size_t size, streamfx::util::curl* userptr);
 		static size_t  read_helper(void*, size_t, size_t, streamfx::util::curl*);
 		static size_t  write_helper(void*, size_t, size_t, streamfx::util::curl*);
+		static size_t  header_helper(void*, size_t, size_t, streamfx::util::curl*);
 		static int32_t xferinfo_callback(streamfx::util::curl*, curl_off_t, curl_off_t, curl_off_t, curl_off_t);
 
+		void apply_headers();
+		void release_headers();
+
+		friend class curl_multi;
+
 		public:
 		curl();
 		~curl();
@@ -108,8 +121,47 @@ namespace streamfx::util {
 
 		CURLcode set_write_callback(curl_io_callback_t cb);
 
+		/** Called once for every response header line, including the status line. */
+		CURLcode set_header_callback(curl_io_callback_t cb);
+
 		CURLcode set_xferinfo_callback(curl_xferinfo_callback_t cb);
 
 		CURLcode set_debug_callback(curl_debug_callback_t cb);
 	};
+
+	/** Runs transfers in the background on a thread of its own, reusing connections between them.
+	 *
+	 * Callbacks run on that thread once their transfer is done, so they should hand off anything that takes long.
+	 */
+	class curl_multi {
+		typedef std::function<void(CURLcode)>                                callback_t;
+		typedef std::pair<std::shared_ptr<streamfx::util::curl>, callback_t> entry_t;
+
+		CURLM*                                           _multi;
+		std::mutex                                       _lock;
+		std::condition_variable                          _changed;
+		std::list<entry_t>                               _queued;
+		std::map<CURL*, entry_t>                         _active;
+		std::list<std::shared_ptr<streamfx::util::curl>> _cancelled;
+		streamfx::util::curl*                            _current;
+		bool                                             _stop;
+		std::thread                                      _thread;
+
+		public:
+		~curl_multi();
+
+		/** Start a transfer, and call the callback with the result once it is done. */
+		void perform(std::shared_ptr<streamfx::util::curl> request, callback_t callback);
+
+		/** Stop a transfer, and wait until its callback is no longer running. Must not be called from a callback. */
+		void cancel(std::shared_ptr<streamfx::util::curl> request);
+
+		private:
+		curl_multi();
+
+		void run();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::curl_multi> instance();
+	};
 } // namespace streamfx::util
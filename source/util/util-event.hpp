@@ -7,16 +7,26 @@
 #include "common.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <functional>
-#include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::util {
+	/** A list of listeners that can be called at once.
+	 *
+	 * Listeners are kept in an immutable snapshot, which is replaced as a whole whenever one is added or removed. Calling
+	 * the event only has to atomically grab the current snapshot, so it never waits on, or allocates for, anyone that is
+	 * changing the listeners at the same time. Listeners added or removed during a call apply from the next call onward.
+	 */
 	template<typename... _args>
 	class event {
-		std::list<std::function<void(_args...)>> _listeners;
-		std::recursive_mutex                     _lock;
+		typedef std::vector<std::function<void(_args...)>> listeners_t;
+
+		std::shared_ptr<const listeners_t> _listeners;
+		std::recursive_mutex               _lock;
 
 		std::function<void()> _cb_fill;
 		std::function<void()> _cb_clear;
@@ -25,7 +35,6 @@ namespace streamfx::util {
 		event() : _listeners(), _lock(), _cb_fill(), _cb_clear() {}
 		virtual ~event()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
 			this->clear();
 		}
 
@@ -38,7 +47,9 @@ namespace streamfx::util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			std::lock_guard<std::recursive_mutex> lgo(other._lock);
 
-			_listeners.swap(other._listeners);
+			auto listeners = std::atomic_load(&_listeners);
+			std::atomic_store(&_listeners, std::atomic_load(&other._listeners));
+			std::atomic_store(&other._listeners, listeners);
 			_cb_fill.swap(other._cb_fill);
 			_cb_clear.swap(other._cb_clear);
 		}
@@ -53,7 +64,9 @@ namespace streamfx::util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			std::lock_guard<std::recursive_mutex> lgo(other._lock);
 
-			_listeners.swap(other._listeners);
+			auto listeners = std::atomic_load(&_listeners);
+			std::atomic_store(&_listeners, std::atomic_load(&other._listeners));
+			std::atomic_store(&other._listeners, listeners);
 			_cb_fill.swap(other._cb_fill);
 			_cb_clear.swap(other._cb_clear);
 
@@ -70,8 +83,11 @@ namespace streamfx::util {
 		template<typename... _largs>
 		inline void call(_args... args)
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			for (auto& l : _listeners) {
+			auto listeners = std::atomic_load(&_listeners);
+			if (!listeners) {
+				return;
+			}
+			for (auto& l : *listeners) {
 				l(args...);
 			}
 		}
@@ -83,12 +99,18 @@ namespace streamfx::util {
 		inline void add(std::function<void(_args...)> listener)
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
-			if (_listeners.size() == 0) {
+			auto                                  listeners = std::make_shared<listeners_t>();
+			if (auto current = std::atomic_load(&_listeners); current) {
+				listeners->reserve(current->size() + 1);
+				listeners->insert(listeners->end(), current->begin(), current->end());
+			}
+			if (listeners->empty()) {
 				if (_cb_fill) {
 					_cb_fill();
 				}
 			}
-			_listeners.push_back(listener);
+			listeners->push_back(listener);
+			std::atomic_store(&_listeners, std::shared_ptr<const listeners_t>(listeners));
 		}
 		inline event<_args...>& operator+=(std::function<void(_args...)> listener)
 		{
@@ -102,8 +124,14 @@ namespace streamfx::util {
 		inline void remove(std::function<void(_args...)> listener)
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.remove(listener);
-			if (_listeners.size() == 0) {
+			auto                                  current = std::atomic_load(&_listeners);
+			if (!current) {
+				return;
+			}
+			auto listeners = std::make_shared<listeners_t>(*current);
+			listeners->erase(std::remove(listeners->begin(), listeners->end(), listener), listeners->end());
+			std::atomic_store(&_listeners, std::shared_ptr<const listeners_t>(listeners));
+			if (listeners->empty()) {
 				if (_cb_clear) {
 					_cb_clear();
 				}
@@ -120,8 +148,8 @@ namespace streamfx::util {
 		 */
 		inline bool empty()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			return _listeners.empty();
+			auto listeners = std::atomic_load(&_listeners);
+			return !listeners || listeners->empty();
 		}
 		inline operator bool()
 		{
@@ -133,7 +161,7 @@ namespace streamfx::util {
 		inline void clear()
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.clear();
+			std::atomic_store(&_listeners, std::shared_ptr<const listeners_t>());
 			if (_cb_clear) {
 				_cb_clear();
 			}
@@ -0,0 +1,223 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-face-detection.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <emmintrin.h>
+#elif defined(D_PLATFORM_INSTR_ARM) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#endif
+#include "warning-enable.hpp"
+
+// Pixels are merged into square cells of this size, which removes noise and keeps the blob search small.
+constexpr uint32_t cell_size = 4;
+
+// Blobs smaller than this many cells are too small to be a face, or just noise.
+constexpr size_t min_cells = 4;
+
+// BT.601 with full range, as 8.8 fixed point. Skin tones fall into a small box in the Cb/Cr plane regardless of how light
+// or dark the skin is, while very dark pixels have too little color left to judge.
+constexpr int32_t skin_y_min  = 40;
+constexpr int32_t skin_cb_min = 77;
+constexpr int32_t skin_cb_max = 127;
+constexpr int32_t skin_cr_min = 133;
+constexpr int32_t skin_cr_max = 173;
+
+// Most faces are slightly taller than wide, and a blob that continues much further down is a face with its neck.
+constexpr float face_aspect     = 1.25f;
+constexpr float face_aspect_max = 1.5f;
+constexpr float face_aspect_min = 0.6f;
+constexpr float face_fill_min   = 0.35f;
+
+static void classify_generic(const uint8_t* row, uint8_t* out, uint32_t begin, uint32_t end)
+{
+	for (uint32_t x = begin; x < end; x++) {
+		int32_t r  = row[x * 4 + 0];
+		int32_t g  = row[x * 4 + 1];
+		int32_t b  = row[x * 4 + 2];
+		int32_t y  = (77 * r + 150 * g + 29 * b) >> 8;
+		int32_t cb = ((-43 * r - 85 * g + 128 * b) >> 8) + 128;
+		int32_t cr = ((128 * r - 107 * g - 21 * b) >> 8) + 128;
+		out[x]     = (y >= skin_y_min) && (cb >= skin_cb_min) && (cb <= skin_cb_max) && (cr >= skin_cr_min) && (cr <= skin_cr_max);
+	}
+}
+
+#if defined(D_PLATFORM_INSTR_X86)
+// Sums the two halves of each pixel that _mm_madd_epi16 leaves behind, for four pixels spread over two registers.
+static inline __m128i sum_pixels(__m128i lo, __m128i hi)
+{
+	__m128i a = _mm_add_epi32(_mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 3, 1)));
+	__m128i b = _mm_add_epi32(_mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 3, 1)));
+	return _mm_unpacklo_epi64(a, b);
+}
+
+static inline __m128i in_range(__m128i v, int32_t min, int32_t max)
+{
+	return _mm_and_si128(_mm_cmpgt_epi32(v, _mm_set1_epi32(min - 1)), _mm_cmplt_epi32(v, _mm_set1_epi32(max + 1)));
+}
+
+static void classify(const uint8_t* row, uint8_t* out, uint32_t width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ky   = _mm_setr_epi16(77, 150, 29, 0, 77, 150, 29, 0);
+	const __m128i kcb  = _mm_setr_epi16(-43, -85, 128, 0, -43, -85, 128, 0);
+	const __m128i kcr  = _mm_setr_epi16(128, -107, -21, 0, 128, -107, -21, 0);
+	const __m128i bias = _mm_set1_epi32(128);
+
+	uint32_t x = 0;
+	for (; (x + 4) <= width; x += 4) {
+		__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4));
+		__m128i lo = _mm_unpacklo_epi8(px, zero);
+		__m128i hi = _mm_unpackhi_epi8(px, zero);
+
+		__m128i y  = _mm_srai_epi32(sum_pixels(_mm_madd_epi16(lo, ky), _mm_madd_epi16(hi, ky)), 8);
+		__m128i cb = _mm_add_epi32(_mm_srai_epi32(sum_pixels(_mm_madd_epi16(lo, kcb), _mm_madd_epi16(hi, kcb)), 8), bias);
+		__m128i cr = _mm_add_epi32(_mm_srai_epi32(sum_pixels(_mm_madd_epi16(lo, kcr), _mm_madd_epi16(hi, kcr)), 8), bias);
+
+		__m128i mask = _mm_and_si128(_mm_cmpgt_epi32(y, _mm_set1_epi32(skin_y_min - 1)), _mm_and_si128(in_range(cb, skin_cb_min, skin_cb_max), in_range(cr, skin_cr_min, skin_cr_max)));
+
+		// Narrow the four 32-bit masks down to four bytes of 0 or 1.
+		mask       = _mm_packs_epi16(_mm_packs_epi32(mask, zero), zero);
+		int32_t v4 = _mm_cvtsi128_si32(_mm_and_si128(mask, _mm_set1_epi8(1)));
+		std::memcpy(out + x, &v4, sizeof(v4));
+	}
+	classify_generic(row, out, x, width);
+}
+#elif defined(D_PLATFORM_INSTR_ARM) && (defined(__aarch64__) || defined(_M_ARM64))
+static void classify(const uint8_t* row, uint8_t* out, uint32_t width)
+{
+	uint32_t x = 0;
+	for (; (x + 8) <= width; x += 8) {
+		uint8x8x4_t px = vld4_u8(row + x * 4);
+
+		// Luma never goes negative, but needs all 16 bits.
+		uint16x8_t y16 = vmull_u8(px.val[0], vdup_n_u8(77));
+		y16            = vmlal_u8(y16, px.val[1], vdup_n_u8(150));
+		y16            = vmlal_u8(y16, px.val[2], vdup_n_u8(29));
+		uint8x8_t y    = vshrn_n_u16(y16, 8);
+
+		int16x8_t r  = vreinterpretq_s16_u16(vmovl_u8(px.val[0]));
+		int16x8_t g  = vreinterpretq_s16_u16(vmovl_u8(px.val[1]));
+		int16x8_t b  = vreinterpretq_s16_u16(vmovl_u8(px.val[2]));
+		int16x8_t cb = vmlsq_n_s16(vmlsq_n_s16(vmulq_n_s16(b, 128), r, 43), g, 85);
+		int16x8_t cr = vmlsq_n_s16(vmlsq_n_s16(vmulq_n_s16(r, 128), g, 107), b, 21);
+		cb           = vaddq_s16(vshrq_n_s16(cb, 8), vdupq_n_s16(128));
+		cr           = vaddq_s16(vshrq_n_s16(cr, 8), vdupq_n_s16(128));
+
+		uint16x8_t chroma = vandq_u16(vandq_u16(vcgeq_s16(cb, vdupq_n_s16(skin_cb_min)), vcleq_s16(cb, vdupq_n_s16(skin_cb_max))), vandq_u16(vcgeq_s16(cr, vdupq_n_s16(skin_cr_min)), vcleq_s16(cr, vdupq_n_s16(skin_cr_max))));
+		uint8x8_t  mask   = vand_u8(vmovn_u16(chroma), vcge_u8(y, vdup_n_u8(skin_y_min)));
+		vst1_u8(out + x, vand_u8(mask, vdup_n_u8(1)));
+	}
+	classify_generic(row, out, x, width);
+}
+#else
+static void classify(const uint8_t* row, uint8_t* out, uint32_t width)
+{
+	classify_generic(row, out, 0, width);
+}
+#endif
+
+streamfx::util::face_detection::detector::detector() : _row(), _cells(), _labels(), _stack() {}
+
+streamfx::util::face_detection::detector::~detector() = default;
+
+void streamfx::util::face_detection::detector::detect(const uint8_t* data, uint32_t linesize, uint32_t width, uint32_t height, std::vector<face>& faces, size_t limit)
+{
+	faces.clear();
+
+	uint32_t cw = width / cell_size;
+	uint32_t ch = height / cell_size;
+	if ((cw < 2) || (ch < 2) || (limit == 0)) {
+		return;
+	}
+
+	// Count the skin pixels of each cell.
+	_row.resize(width);
+	_cells.assign(static_cast<size_t>(cw) * ch, 0);
+	for (uint32_t y = 0; y < (ch * cell_size); y++) {
+		classify(data + static_cast<size_t>(linesize) * y, _row.data(), width);
+
+		uint16_t* cells = _cells.data() + static_cast<size_t>(y / cell_size) * cw;
+		for (uint32_t x = 0; x < (cw * cell_size); x++) {
+			cells[x / cell_size] += _row[x];
+		}
+	}
+
+	// Group cells that are mostly skin into 4-connected blobs, and judge each blob by its shape.
+	constexpr uint16_t threshold = (cell_size * cell_size) / 2;
+	_labels.assign(_cells.size(), -1);
+	for (uint32_t start = 0; start < _cells.size(); start++) {
+		if ((_labels[start] != -1) || (_cells[start] < threshold)) {
+			continue;
+		}
+
+		uint32_t min_x = cw, min_y = ch, max_x = 0, max_y = 0;
+		size_t   count = 0;
+
+		_stack.clear();
+		_stack.push_back(start);
+		_labels[start] = static_cast<int32_t>(start);
+		while (!_stack.empty()) {
+			uint32_t idx = _stack.back();
+			_stack.pop_back();
+
+			uint32_t x = idx % cw;
+			uint32_t y = idx / cw;
+			min_x      = std::min(min_x, x);
+			max_x      = std::max(max_x, x);
+			min_y      = std::min(min_y, y);
+			max_y      = std::max(max_y, y);
+			count++;
+
+			auto visit = [&](uint32_t next) {
+				if ((_labels[next] == -1) && (_cells[next] >= threshold)) {
+					_labels[next] = static_cast<int32_t>(start);
+					_stack.push_back(next);
+				}
+			};
+			if (x > 0) {
+				visit(idx - 1);
+			}
+			if ((x + 1) < cw) {
+				visit(idx + 1);
+			}
+			if (y > 0) {
+				visit(idx - cw);
+			}
+			if ((y + 1) < ch) {
+				visit(idx + cw);
+			}
+		}
+
+		// Skin filling most of the frame is a wall or a close up of a hand, not a face.
+		float bw = static_cast<float>(max_x - min_x + 1);
+		float bh = static_cast<float>(max_y - min_y + 1);
+		if ((count < min_cells) || (bw > (cw * 0.8f)) || (bh > (ch * 0.9f))) {
+			continue;
+		}
+
+		float fill = static_cast<float>(count) / (bw * bh);
+		if (bh > (bw * face_aspect_max)) {
+			bh = std::ceil(bw * face_aspect);
+		}
+		float aspect = bh / bw;
+		if ((aspect < face_aspect_min) || (fill < face_fill_min)) {
+			continue;
+		}
+
+		float shape = 1.f - std::min(1.f, std::fabs(aspect - face_aspect));
+		faces.push_back({static_cast<float>(min_x * cell_size), static_cast<float>(min_y * cell_size), bw * cell_size, bh * cell_size, std::min(1.f, fill) * .5f + shape * .5f});
+	}
+
+	// The closest faces are the largest ones.
+	std::sort(faces.begin(), faces.end(), [](face const& a, face const& b) { return (a.width * a.height) > (b.width * b.height); });
+	if (faces.size() > limit) {
+		faces.resize(limit);
+	}
+}
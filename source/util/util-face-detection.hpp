@@ -0,0 +1,46 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::face_detection {
+	struct face {
+		float x;
+		float y;
+		float width;
+		float height;
+		float confidence;
+	};
+
+	/** Small face detector that runs entirely on the CPU, for hardware without a vendor SDK.
+	 *
+	 * Classifies skin tones in YCbCr, merges them into 4x4 cells and looks for connected blobs shaped like a head.
+	 * Meant for images about 320 pixels wide, which take well under a millisecond. Far less precise than a trained
+	 * network, but the tracking of the callers smooths over the occasional miss or false hit.
+	 */
+	class detector {
+		std::vector<uint8_t>  _row;
+		std::vector<uint16_t> _cells;
+		std::vector<int32_t>  _labels;
+		std::vector<uint32_t> _stack;
+
+		public:
+		detector();
+		~detector();
+
+		/** Find up to 'limit' faces, largest first.
+		 *
+		 * @param data RGBA pixels with 8 bits per channel.
+		 * @param faces Cleared, then filled with what was found, in pixels.
+		 */
+		void detect(const uint8_t* data, uint32_t linesize, uint32_t width, uint32_t height, std::vector<face>& faces, size_t limit);
+	};
+} // namespace streamfx::util::face_detection
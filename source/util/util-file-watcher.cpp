@@ -0,0 +1,321 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-file-watcher.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <chrono>
+#include <vector>
+#include "warning-enable.hpp"
+
+#include "warning-disable.hpp"
+#if defined(D_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(D_PLATFORM_LINUX)
+#include <poll.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::file_watcher> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+// How long the watcher thread sleeps at most, which is also how quickly it notices new watches and polled changes.
+#define ST_INTERVAL std::chrono::milliseconds(250)
+
+struct streamfx::util::file_watcher::directory {
+	std::filesystem::path             path;
+	std::list<std::shared_ptr<entry>> entries;
+	bool                              native = false;
+
+#if defined(D_PLATFORM_WINDOWS)
+	HANDLE                         handle     = INVALID_HANDLE_VALUE;
+	OVERLAPPED                     overlapped = {};
+	alignas(DWORD) std::array<uint8_t, 16384> buffer;
+
+	bool queue()
+	{
+		return ReadDirectoryChangesW(handle, buffer.data(), static_cast<DWORD>(buffer.size()), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE, nullptr, &overlapped, nullptr) != FALSE;
+	}
+#elif defined(D_PLATFORM_LINUX)
+	int wd = -1;
+#endif
+};
+
+#if defined(D_PLATFORM_LINUX)
+static int inotify_fd = -1;
+#endif
+
+streamfx::util::file_watcher::~file_watcher()
+{
+	_stop = true;
+	if (_worker.joinable()) {
+		_worker.join();
+	}
+
+#if defined(D_PLATFORM_LINUX)
+	if (inotify_fd >= 0) {
+		close(inotify_fd);
+		inotify_fd = -1;
+	}
+#endif
+}
+
+streamfx::util::file_watcher::file_watcher() : _lock(), _directories(), _stop(false), _worker()
+{
+#if defined(D_PLATFORM_LINUX)
+	if (inotify_fd < 0) {
+		inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (inotify_fd < 0) {
+			D_LOG_WARNING("inotify is unavailable, falling back to polling.", nullptr);
+		}
+	}
+#endif
+
+	_worker = std::thread([this]() { work(); });
+}
+
+std::shared_ptr<streamfx::util::file_watcher::watch> streamfx::util::file_watcher::add(const std::filesystem::path& file, callback_t callback)
+{
+	std::error_code ec;
+
+	auto instance      = std::make_shared<entry>();
+	instance->file     = std::filesystem::absolute(file, ec).lexically_normal();
+	instance->callback = std::move(callback);
+	instance->time     = std::filesystem::last_write_time(instance->file, ec);
+
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		auto  parent = instance->file.parent_path();
+		auto& dir    = _directories[parent];
+		if (!dir) {
+			dir       = std::make_shared<directory>();
+			dir->path = parent;
+		}
+		dir->entries.push_back(instance);
+	}
+
+	return std::make_shared<watch>(shared_from_this(), instance);
+}
+
+void streamfx::util::file_watcher::remove(std::shared_ptr<entry> instance)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// Empty directories are cleaned up by the watcher thread, which owns the native watches.
+	if (auto kv = _directories.find(instance->file.parent_path()); kv != _directories.end()) {
+		kv->second->entries.remove(instance);
+	}
+}
+
+void streamfx::util::file_watcher::work()
+{
+#if defined(D_PLATFORM_WINDOWS)
+	SetThreadDescription(GetCurrentThread(), L"StreamFX File Watcher");
+#elif defined(D_PLATFORM_LINUX)
+	pthread_setname_np(pthread_self(), "StreamFX File Watcher");
+#endif
+
+	while (!_stop) {
+		synchronize();
+
+#if defined(D_PLATFORM_WINDOWS)
+		std::vector<HANDLE>                     events;
+		std::vector<std::shared_ptr<directory>> owners;
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			for (auto& kv : _directories) {
+				if (kv.second->native) {
+					events.push_back(kv.second->overlapped.hEvent);
+					owners.push_back(kv.second);
+				}
+			}
+		}
+
+		if (events.empty()) {
+			std::this_thread::sleep_for(ST_INTERVAL);
+		} else if (DWORD res = WaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(), FALSE, static_cast<DWORD>(ST_INTERVAL.count())); (res >= WAIT_OBJECT_0) && (res < (WAIT_OBJECT_0 + events.size()))) {
+			std::lock_guard<std::mutex> lock(_lock);
+
+			auto& dir   = *owners[res - WAIT_OBJECT_0];
+			DWORD bytes = 0;
+			if (GetOverlappedResult(dir.handle, &dir.overlapped, &bytes, FALSE) && (bytes > 0)) {
+				for (size_t offset = 0;;) {
+					auto info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(dir.buffer.data() + offset);
+					notify(dir, std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+					if (info->NextEntryOffset == 0) {
+						break;
+					}
+					offset += info->NextEntryOffset;
+				}
+			} else {
+				// The buffer overflowed, so anything in this directory may have changed.
+				for (auto& instance : dir.entries) {
+					instance->callback();
+				}
+			}
+
+			ResetEvent(dir.overlapped.hEvent);
+			if (!dir.queue()) {
+				dir.native = false; // Falls back to polling afterwards.
+			}
+		}
+#elif defined(D_PLATFORM_LINUX)
+		if (inotify_fd < 0) {
+			std::this_thread::sleep_for(ST_INTERVAL);
+		} else {
+			pollfd pfd = {inotify_fd, POLLIN, 0};
+			if (poll(&pfd, 1, static_cast<int>(ST_INTERVAL.count())) > 0) {
+				alignas(inotify_event) std::array<char, 16384> buffer;
+				for (ssize_t length; (length = read(inotify_fd, buffer.data(), buffer.size())) > 0;) {
+					std::lock_guard<std::mutex> lock(_lock);
+					for (ssize_t offset = 0; offset < length;) {
+						auto event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+						if (event->len > 0) {
+							for (auto& kv : _directories) {
+								if (kv.second->native && (kv.second->wd == event->wd)) {
+									notify(*kv.second, std::string(event->name));
+									break;
+								}
+							}
+						}
+						offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+					}
+				}
+			}
+		}
+#else
+		std::this_thread::sleep_for(ST_INTERVAL);
+#endif
+
+		// Everything without a native watch is polled instead.
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			for (auto& kv : _directories) {
+				if (kv.second->native) {
+					continue;
+				}
+
+				for (auto& instance : kv.second->entries) {
+					std::error_code ec;
+					if (auto time = std::filesystem::last_write_time(instance->file, ec); !ec && (time != instance->time)) {
+						instance->time = time;
+						instance->callback();
+					}
+				}
+			}
+		}
+	}
+
+	// Release all native watches.
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		for (auto& kv : _directories) {
+			kv.second->entries.clear();
+		}
+	}
+	synchronize();
+}
+
+void streamfx::util::file_watcher::synchronize()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+#if defined(D_PLATFORM_WINDOWS)
+	// A single wait can only cover so many directories, all others are polled.
+	size_t natives = 0;
+	for (auto& kv : _directories) {
+		natives += kv.second->native ? 1 : 0;
+	}
+#endif
+
+	for (auto kv = _directories.begin(); kv != _directories.end();) {
+		auto& dir = *kv->second;
+
+		if (dir.entries.empty()) {
+#if defined(D_PLATFORM_WINDOWS)
+			if (dir.handle != INVALID_HANDLE_VALUE) {
+				DWORD bytes = 0;
+				CancelIoEx(dir.handle, &dir.overlapped);
+				GetOverlappedResult(dir.handle, &dir.overlapped, &bytes, TRUE);
+				CloseHandle(dir.handle);
+			}
+			if (dir.overlapped.hEvent) {
+				CloseHandle(dir.overlapped.hEvent);
+			}
+#elif defined(D_PLATFORM_LINUX)
+			if (dir.wd >= 0) {
+				inotify_rm_watch(inotify_fd, dir.wd);
+			}
+#endif
+			kv = _directories.erase(kv);
+			continue;
+		}
+
+#if defined(D_PLATFORM_WINDOWS)
+		if ((dir.handle == INVALID_HANDLE_VALUE) && (natives < MAXIMUM_WAIT_OBJECTS)) {
+			dir.handle = CreateFileW(dir.path.wstring().c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+			if (dir.handle != INVALID_HANDLE_VALUE) {
+				dir.overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+				dir.native            = dir.overlapped.hEvent && dir.queue();
+				natives += dir.native ? 1 : 0;
+			}
+		}
+#elif defined(D_PLATFORM_LINUX)
+		if ((dir.wd < 0) && (inotify_fd >= 0)) {
+			// Editors either write the file in place, or write a new one and move it over the old one.
+			dir.wd     = inotify_add_watch(inotify_fd, dir.path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			dir.native = (dir.wd >= 0);
+		}
+#endif
+
+		kv++;
+	}
+}
+
+void streamfx::util::file_watcher::notify(directory& dir, const std::filesystem::path& name)
+{
+	for (auto& instance : dir.entries) {
+		if (instance->file.filename() == name) {
+			instance->callback();
+		}
+	}
+}
+
+std::shared_ptr<streamfx::util::file_watcher> streamfx::util::file_watcher::instance()
+{
+	static std::weak_ptr<streamfx::util::file_watcher> winst;
+	static std::mutex                                  mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::util::file_watcher>(new streamfx::util::file_watcher());
+		winst    = instance;
+	}
+	return instance;
+}
+
+streamfx::util::file_watcher::watch::watch(std::shared_ptr<file_watcher> parent, std::shared_ptr<file_watcher::entry> entry) : _parent(std::move(parent)), _entry(std::move(entry)) {}
+
+streamfx::util::file_watcher::watch::~watch()
+{
+	_parent->remove(_entry);
+}
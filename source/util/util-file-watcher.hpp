@@ -0,0 +1,83 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "warning-enable.hpp"
+
+namespace streamfx::util {
+	/** Watches files for changes on one shared background thread, and only notifies those that watch a changed file.
+	 *
+	 * Uses ReadDirectoryChangesW on Windows and inotify on Linux, which both watch the directory containing the file.
+	 * Where neither is available, the background thread compares modification times instead, which still keeps the
+	 * file system away from the graphics thread.
+	 */
+	class file_watcher : public std::enable_shared_from_this<file_watcher> {
+		public:
+		typedef std::function<void()> callback_t;
+
+		class watch;
+
+		private:
+		struct entry {
+			std::filesystem::path           file;
+			callback_t                      callback;
+			std::filesystem::file_time_type time;
+		};
+
+		struct directory;
+
+		std::mutex                                                    _lock;
+		std::map<std::filesystem::path, std::shared_ptr<directory>> _directories;
+
+		std::atomic<bool> _stop;
+		std::thread       _worker;
+
+		public:
+		~file_watcher();
+
+		private:
+		file_watcher();
+
+		public:
+		/** Watch a file until the returned handle is destroyed.
+		 *
+		 * The callback is called on the watcher thread while it holds its lock, so it must be quick and must neither add
+		 * nor remove watches. Setting a flag that is checked later is the intended use.
+		 */
+		std::shared_ptr<watch> add(const std::filesystem::path& file, callback_t callback);
+
+		private:
+		void remove(std::shared_ptr<entry> entry);
+
+		void work();
+
+		/** Start and stop native watches, on the watcher thread only. */
+		void synchronize();
+
+		void notify(directory& dir, const std::filesystem::path& name);
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::file_watcher> instance();
+	};
+
+	class file_watcher::watch {
+		std::shared_ptr<file_watcher>        _parent;
+		std::shared_ptr<file_watcher::entry> _entry;
+
+		public:
+		watch(std::shared_ptr<file_watcher> parent, std::shared_ptr<file_watcher::entry> entry);
+		~watch();
+	};
+} // namespace streamfx::util
@@ -0,0 +1,61 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-hash.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include "warning-enable.hpp"
+
+// Primes from xxHash64, which mix well with a multiply and rotate.
+constexpr uint64_t prime_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t prime_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t prime_3 = 0x165667B19E3779F9ull;
+
+static inline uint64_t rotl(uint64_t v, int bits)
+{
+	return (v << bits) | (v >> (64 - bits));
+}
+
+static inline uint64_t load(const uint8_t* ptr)
+{
+	uint64_t v;
+	std::memcpy(&v, ptr, sizeof(v));
+	return v;
+}
+
+static inline uint64_t accumulate(uint64_t acc, uint64_t v)
+{
+	return rotl(acc + v * prime_2, 31) * prime_1;
+}
+
+uint64_t streamfx::util::hash::plane(const uint8_t* data, size_t stride, size_t bytes, size_t rows, uint64_t seed)
+{
+	// Four independent lanes, so that the compiler can keep them in vector registers.
+	uint64_t lanes[4] = {seed + prime_1 + prime_2, seed + prime_2, seed, seed - prime_1};
+	uint64_t tail     = seed ^ prime_3;
+
+	for (size_t y = 0; y < rows; y++) {
+		const uint8_t* ptr = data + stride * y;
+		size_t         len = bytes;
+
+		for (; len >= 32; len -= 32, ptr += 32) {
+			lanes[0] = accumulate(lanes[0], load(ptr));
+			lanes[1] = accumulate(lanes[1], load(ptr + 8));
+			lanes[2] = accumulate(lanes[2], load(ptr + 16));
+			lanes[3] = accumulate(lanes[3], load(ptr + 24));
+		}
+		for (; len > 0; len--, ptr++) {
+			tail = rotl(tail ^ (*ptr * prime_3), 11) * prime_1;
+		}
+	}
+
+	uint64_t acc = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18) + tail;
+	acc ^= acc >> 33;
+	acc *= prime_2;
+	acc ^= acc >> 29;
+	acc *= prime_3;
+	acc ^= acc >> 32;
+	return acc;
+}
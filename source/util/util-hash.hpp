@@ -0,0 +1,20 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::hash {
+	/** Hash 'rows' rows of 'bytes' each from a strided buffer, ignoring any padding between rows.
+	 *
+	 * Not cryptographic, only meant to tell whether image data changed. Chain planes by passing the previous result
+	 * as the seed.
+	 */
+	uint64_t plane(const uint8_t* data, size_t stride, size_t bytes, size_t rows, uint64_t seed = 0);
+} // namespace streamfx::util::hash
@@ -0,0 +1,100 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-kalman.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <emmintrin.h>
+#elif defined(D_PLATFORM_INSTR_ARM) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#endif
+#include "warning-enable.hpp"
+
+streamfx::util::math::kalman_bank::kalman_bank() : _q_process_noise_covariance(), _r_measurement_noise_covariance(), _x_value_of_interest(), _p_estimation_error_covariance() {}
+
+streamfx::util::math::kalman_bank::~kalman_bank() = default;
+
+size_t streamfx::util::math::kalman_bank::size() const
+{
+	return _x_value_of_interest.size();
+}
+
+void streamfx::util::math::kalman_bank::clear()
+{
+	_q_process_noise_covariance.clear();
+	_r_measurement_noise_covariance.clear();
+	_x_value_of_interest.clear();
+	_p_estimation_error_covariance.clear();
+}
+
+size_t streamfx::util::math::kalman_bank::push(float pnc, float mnc, float eec, float value)
+{
+	_q_process_noise_covariance.push_back(pnc);
+	_r_measurement_noise_covariance.push_back(mnc);
+	_x_value_of_interest.push_back(value);
+	_p_estimation_error_covariance.push_back(eec);
+	return _x_value_of_interest.size() - 1;
+}
+
+void streamfx::util::math::kalman_bank::erase(size_t index, size_t count)
+{
+	for (auto* v : {&_q_process_noise_covariance, &_r_measurement_noise_covariance, &_x_value_of_interest, &_p_estimation_error_covariance}) {
+		v->erase(v->begin() + static_cast<ptrdiff_t>(index), v->begin() + static_cast<ptrdiff_t>(index + count));
+	}
+}
+
+void streamfx::util::math::kalman_bank::configure(float pnc, float mnc, float eec)
+{
+	std::fill(_q_process_noise_covariance.begin(), _q_process_noise_covariance.end(), pnc);
+	std::fill(_r_measurement_noise_covariance.begin(), _r_measurement_noise_covariance.end(), mnc);
+	std::fill(_p_estimation_error_covariance.begin(), _p_estimation_error_covariance.end(), eec);
+}
+
+void streamfx::util::math::kalman_bank::filter(const float* measurements)
+{
+	float*       q   = _q_process_noise_covariance.data();
+	float*       r   = _r_measurement_noise_covariance.data();
+	float*       x   = _x_value_of_interest.data();
+	float*       p   = _p_estimation_error_covariance.data();
+	size_t       len = _x_value_of_interest.size();
+	size_t       idx = 0;
+	const float* m   = measurements;
+
+#if defined(D_PLATFORM_INSTR_X86)
+	const __m128 one = _mm_set1_ps(1.f);
+	for (; (idx + 4) <= len; idx += 4) {
+		__m128 vp = _mm_add_ps(_mm_loadu_ps(p + idx), _mm_loadu_ps(q + idx));
+		__m128 vk = _mm_div_ps(vp, _mm_add_ps(vp, _mm_loadu_ps(r + idx)));
+		__m128 vx = _mm_loadu_ps(x + idx);
+		vx        = _mm_add_ps(vx, _mm_mul_ps(vk, _mm_sub_ps(_mm_loadu_ps(m + idx), vx)));
+		_mm_storeu_ps(x + idx, vx);
+		_mm_storeu_ps(p + idx, _mm_mul_ps(_mm_sub_ps(one, vk), vp));
+	}
+#elif defined(D_PLATFORM_INSTR_ARM) && (defined(__aarch64__) || defined(_M_ARM64))
+	const float32x4_t one = vdupq_n_f32(1.f);
+	for (; (idx + 4) <= len; idx += 4) {
+		float32x4_t vp = vaddq_f32(vld1q_f32(p + idx), vld1q_f32(q + idx));
+		float32x4_t vk = vdivq_f32(vp, vaddq_f32(vp, vld1q_f32(r + idx)));
+		float32x4_t vx = vld1q_f32(x + idx);
+		vx             = vaddq_f32(vx, vmulq_f32(vk, vsubq_f32(vld1q_f32(m + idx), vx)));
+		vst1q_f32(x + idx, vx);
+		vst1q_f32(p + idx, vmulq_f32(vsubq_f32(one, vk), vp));
+	}
+#endif
+
+	// Whatever does not fill a full vector, or everything if there is no SIMD kernel.
+	for (; idx < len; idx++) {
+		p[idx] += q[idx];
+		float k = p[idx] / (p[idx] + r[idx]);
+		x[idx] += k * (m[idx] - x[idx]);
+		p[idx] = (1 - k) * p[idx];
+	}
+}
+
+float streamfx::util::math::kalman_bank::get(size_t index) const
+{
+	return _x_value_of_interest[index];
+}
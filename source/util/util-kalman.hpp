@@ -0,0 +1,47 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::math {
+	/** A bank of independent one dimensional Kalman filters, stored as a structure of arrays.
+	 *
+	 * Each slot behaves exactly like a 'kalman1D<float>', but all slots are filtered together in one pass over
+	 * contiguous memory, which the compiler and SIMD kernels can chew through without chasing any pointers.
+	 */
+	class kalman_bank {
+		std::vector<float> _q_process_noise_covariance;
+		std::vector<float> _r_measurement_noise_covariance;
+		std::vector<float> _x_value_of_interest;
+		std::vector<float> _p_estimation_error_covariance;
+
+		public:
+		kalman_bank();
+		~kalman_bank();
+
+		size_t size() const;
+
+		void clear();
+
+		/** Append a slot, and return its index. */
+		size_t push(float pnc, float mnc, float eec, float value);
+
+		/** Remove 'count' slots starting at 'index', moving all later slots down. */
+		void erase(size_t index, size_t count = 1);
+
+		/** Change the noise of every slot while keeping their values, like reassigning a 'kalman1D'. */
+		void configure(float pnc, float mnc, float eec);
+
+		/** Filter every slot with the matching entry of 'measurements', which must hold 'size()' values. */
+		void filter(const float* measurements);
+
+		float get(size_t index) const;
+	};
+} // namespace streamfx::util::math
@@ -5,20 +5,197 @@
 
 #include "util-logging.hpp"
 #include "common.hpp"
+#include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <atomic>
+#include <chrono>
 #include <stdarg.h>
+#include <string>
+#include <thread>
 #include "warning-enable.hpp"
 
+// Messages waiting for the writer, beyond which new ones are dropped instead of growing the queue forever.
+#define ST_MAX_PENDING 4096
+
+// How often a message that keeps repeating is still reported.
+#define ST_REPEAT_INTERVAL std::chrono::seconds(1)
+
+namespace {
+	int32_t to_obs(streamfx::util::logging::level lvl)
+	{
+		switch (lvl) {
+		case streamfx::util::logging::level::LEVEL_DEBUG:
+			return LOG_DEBUG;
+		case streamfx::util::logging::level::LEVEL_INFO:
+			return LOG_INFO;
+		case streamfx::util::logging::level::LEVEL_WARN:
+			return LOG_WARNING;
+		default:
+			return LOG_ERROR;
+		}
+	}
+
+	/** Hands messages to libOBS from a thread of its own, so that logging never waits on anything.
+	 *
+	 * Any thread pushes onto a lock-free stack, which the writer takes as a whole and reverses back into the order
+	 * the messages were logged in.
+	 */
+	class writer {
+		struct message {
+			message*    next;
+			int32_t     level;
+			std::string text;
+		};
+
+		std::atomic<message*> _head;
+		std::atomic<size_t>   _pending;
+		std::atomic<size_t>   _dropped;
+		std::atomic<size_t>   _producers;
+		std::atomic<bool>     _running;
+		std::thread           _thread;
+
+		// Only used by whoever is writing.
+		int32_t                               _last_level;
+		std::string                           _last_text;
+		size_t                                _repeats;
+		std::chrono::steady_clock::time_point _repeats_reported;
+
+		public:
+		writer() : _head(nullptr), _pending(0), _dropped(0), _producers(0), _running(false), _thread(), _last_level(0), _last_text(), _repeats(0), _repeats_reported() {}
+
+		~writer()
+		{
+			stop();
+		}
+
+		void start()
+		{
+			if (_running.exchange(true)) {
+				return;
+			}
+			_thread = std::thread([this]() {
+				while (_running.load(std::memory_order_acquire)) {
+					if (!drain()) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(5));
+					}
+				}
+			});
+		}
+
+		void stop()
+		{
+			_running.store(false, std::memory_order_release);
+			if (_thread.joinable()) {
+				_thread.join();
+			}
+
+			// Whoever still saw the writer running is about to push, so wait for them before writing what is left.
+			while (_producers.load(std::memory_order_acquire) != 0) {
+				std::this_thread::yield();
+			}
+			drain();
+			report_repeats();
+		}
+
+		void push(int32_t level, const char* text, size_t length)
+		{
+			_producers.fetch_add(1, std::memory_order_acq_rel);
+			if (!_running.load(std::memory_order_acquire)) {
+				_producers.fetch_sub(1, std::memory_order_acq_rel);
+				blog(level, "[" S_PLUGIN_NAME "] %s", text);
+				return;
+			}
+
+			if (_pending.fetch_add(1, std::memory_order_relaxed) >= ST_MAX_PENDING) {
+				_pending.fetch_sub(1, std::memory_order_relaxed);
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+			} else {
+				auto msg  = new message{nullptr, level, std::string(text, length)};
+				msg->next = _head.load(std::memory_order_relaxed);
+				while (!_head.compare_exchange_weak(msg->next, msg, std::memory_order_release, std::memory_order_relaxed)) {
+				}
+			}
+
+			_producers.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		private:
+		bool drain()
+		{
+			message* list = _head.exchange(nullptr, std::memory_order_acquire);
+			if (!list) {
+				if (_repeats > 0 && ((std::chrono::steady_clock::now() - _repeats_reported) >= ST_REPEAT_INTERVAL)) {
+					report_repeats();
+				}
+				return false;
+			}
+
+			// Newest first, so reverse it.
+			message* ordered = nullptr;
+			while (list) {
+				message* next = list->next;
+				list->next    = ordered;
+				ordered       = list;
+				list          = next;
+			}
+
+			while (ordered) {
+				message* next = ordered->next;
+				write(ordered->level, ordered->text);
+				delete ordered;
+				_pending.fetch_sub(1, std::memory_order_relaxed);
+				ordered = next;
+			}
+
+			if (size_t dropped = _dropped.exchange(0, std::memory_order_relaxed); dropped > 0) {
+				report_repeats();
+				blog(LOG_WARNING, "[" S_PLUGIN_NAME "] Dropped %zu messages, logging is falling behind.", dropped);
+			}
+			return true;
+		}
+
+		void write(int32_t level, std::string& text)
+		{
+			auto now = std::chrono::steady_clock::now();
+
+			// Something stuck in a loop would otherwise drown out everything else.
+			if ((level == _last_level) && (text == _last_text)) {
+				_repeats++;
+				if ((now - _repeats_reported) >= ST_REPEAT_INTERVAL) {
+					report_repeats();
+				}
+				return;
+			}
+
+			report_repeats();
+			blog(level, "[" S_PLUGIN_NAME "] %s", text.c_str());
+			_last_level = level;
+			_last_text.swap(text);
+			_repeats_reported = now;
+		}
+
+		void report_repeats()
+		{
+			if (_repeats > 0) {
+				blog(_last_level, "[" S_PLUGIN_NAME "] Last message repeated %zu times.", _repeats);
+				_repeats = 0;
+			}
+			_repeats_reported = std::chrono::steady_clock::now();
+		}
+
+		public:
+		static writer& instance()
+		{
+			static writer instance;
+			return instance;
+		}
+	};
+} // namespace
+
 void streamfx::util::logging::log(level lvl, const char* format, ...)
 {
-	const static std::map<level, int32_t> level_map = {
-		{level::LEVEL_DEBUG, LOG_DEBUG},
-		{level::LEVEL_INFO, LOG_INFO},
-		{level::LEVEL_WARN, LOG_WARNING},
-		{level::LEVEL_ERROR, LOG_ERROR},
-	};
-	thread_local static std::vector<char> buffer;
+	thread_local static std::vector<char> buffer(1024);
 
 	va_list vargs;
 	va_start(vargs, format);
@@ -26,11 +203,25 @@ void streamfx::util::logging::log(level lvl, const char* format, ...)
 	va_list vargs_copy;
 	va_copy(vargs_copy, vargs);
 	int32_t ret = vsnprintf(buffer.data(), buffer.size(), format, vargs);
-	buffer.resize(static_cast<size_t>(ret) + 1);
-	ret = vsnprintf(buffer.data(), buffer.size(), format, vargs_copy);
+	if ((ret >= 0) && (static_cast<size_t>(ret) >= buffer.size())) {
+		buffer.resize(static_cast<size_t>(ret) + 1);
+		ret = vsnprintf(buffer.data(), buffer.size(), format, vargs_copy);
+	}
 
 	va_end(vargs);
 	va_end(vargs_copy);
 
-	blog(level_map.at(lvl), "[StreamFX] %s", buffer.data());
+	if (ret < 0) {
+		return;
+	}
+	writer::instance().push(to_obs(lvl), buffer.data(), static_cast<size_t>(ret));
 }
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		writer::instance().start();
+	},
+	[]() { // Finalizer
+		writer::instance().stop();
+	},
+	streamfx::loader_priority::HIGHEST);
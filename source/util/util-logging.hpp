@@ -41,5 +41,10 @@ namespace streamfx::util::logging {
 		LEVEL_ERROR, // Errors that must be fixed.
 	};
 
+	/** Format a message and queue it for libOBS.
+	 *
+	 * Messages are written by a thread of their own while the plugin is loaded, so this is safe to call from real
+	 * time threads. Identical messages in a row are collapsed into a count.
+	 */
 	void log(level lvl, const char* format, ...);
 } // namespace streamfx::util::logging
@@ -0,0 +1,192 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-memory.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::memory> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+using namespace streamfx::util::memory;
+
+namespace {
+	struct registry {
+		std::mutex                      lock;
+		std::list<std::weak_ptr<owner>> owners;
+	};
+
+	registry& get_registry()
+	{
+		static registry instance;
+		return instance;
+	}
+
+	// Raw, as scopes never outlive the owner they were given.
+	thread_local owner* current_owner = nullptr;
+
+	struct record {
+		std::shared_ptr<owner> target;
+		kind                   type;
+		int64_t                bytes;
+
+		~record()
+		{
+			target->add(type, -bytes);
+		}
+	};
+
+	const char* kind_names[kinds] = {"Textures", "Render Targets", "Vertex Buffers", "CUDA", "CV"};
+} // namespace
+
+owner::owner(std::string_view name) : _name(name), _bytes() {}
+
+owner::~owner() {}
+
+std::string_view owner::name()
+{
+	return _name;
+}
+
+uint64_t owner::bytes(kind kind)
+{
+	return static_cast<uint64_t>(std::max<int64_t>(_bytes[static_cast<size_t>(kind)].load(std::memory_order_relaxed), 0));
+}
+
+uint64_t owner::total()
+{
+	uint64_t total = 0;
+	for (size_t idx = 0; idx < kinds; idx++) {
+		total += bytes(static_cast<kind>(idx));
+	}
+	return total;
+}
+
+void owner::add(kind kind, int64_t bytes)
+{
+	_bytes[static_cast<size_t>(kind)].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+std::shared_ptr<owner> owner::create(std::string_view name)
+{
+	auto instance = std::shared_ptr<owner>(new owner(name));
+
+	auto&                       reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.lock);
+	reg.owners.remove_if([](std::weak_ptr<owner> const& v) { return v.expired(); });
+	reg.owners.push_back(instance);
+	return instance;
+}
+
+std::shared_ptr<owner> owner::current()
+{
+	if (current_owner) {
+		return current_owner->shared_from_this();
+	}
+	return shared();
+}
+
+std::shared_ptr<owner> owner::shared()
+{
+	static std::shared_ptr<owner> instance = create("Shared");
+	return instance;
+}
+
+scope::scope(std::shared_ptr<owner> const& target) : _previous(current_owner)
+{
+	current_owner = target.get();
+}
+
+scope::~scope()
+{
+	current_owner = _previous;
+}
+
+allocation::allocation() : _record() {}
+
+allocation::allocation(kind kind, uint64_t bytes) : allocation(kind, bytes, owner::current()) {}
+
+allocation::allocation(kind kind, uint64_t bytes, std::shared_ptr<owner> target) : _record()
+{
+	if ((bytes == 0) || !target) {
+		return;
+	}
+
+	target->add(kind, static_cast<int64_t>(bytes));
+	_record = std::shared_ptr<record>(new record{target, kind, static_cast<int64_t>(bytes)});
+}
+
+void allocation::reset()
+{
+	_record.reset();
+}
+
+std::vector<usage> streamfx::util::memory::snapshot()
+{
+	std::vector<usage> result;
+	{
+		auto&                       reg = get_registry();
+		std::lock_guard<std::mutex> lock(reg.lock);
+		for (auto const& weak : reg.owners) {
+			auto instance = weak.lock();
+			if (!instance) {
+				continue;
+			}
+
+			usage info;
+			info.name  = instance->name();
+			info.total = 0;
+			for (size_t idx = 0; idx < kinds; idx++) {
+				info.bytes[idx] = instance->bytes(static_cast<kind>(idx));
+				info.total += info.bytes[idx];
+			}
+			if (info.total > 0) {
+				result.push_back(std::move(info));
+			}
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](usage const& a, usage const& b) { return a.total > b.total; });
+	return result;
+}
+
+void streamfx::util::memory::log()
+{
+	constexpr double mebibyte = 1024. * 1024.;
+
+	auto     usages = snapshot();
+	uint64_t total  = 0;
+	for (auto const& info : usages) {
+		total += info.total;
+	}
+
+	D_LOG_INFO("%.1f MiB in total, held by %zu owners.", static_cast<double>(total) / mebibyte, usages.size());
+	for (auto const& info : usages) {
+		std::string text;
+		for (size_t idx = 0; idx < kinds; idx++) {
+			if (info.bytes[idx] > 0) {
+				char buffer[64];
+				snprintf(buffer, sizeof(buffer), ", %s %.1f MiB", kind_names[idx], static_cast<double>(info.bytes[idx]) / mebibyte);
+				text += buffer;
+			}
+		}
+		D_LOG_INFO("  '%s': %.1f MiB%s", info.name.c_str(), static_cast<double>(info.total) / mebibyte, text.c_str());
+	}
+}
@@ -0,0 +1,101 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::memory {
+	enum class kind : uint8_t {
+		Texture,
+		RenderTarget,
+		VertexBuffer,
+		CUDA,
+		CV,
+	};
+	static constexpr size_t kinds = 5;
+
+	/** Something that memory is accounted to, usually one source, filter or transition.
+	 *
+	 * Everything allocated while no owner is current goes to the shared owner, which covers caches and other state that
+	 * is used by many instances at once.
+	 */
+	class owner : public std::enable_shared_from_this<owner> {
+		std::string                             _name;
+		std::array<std::atomic<int64_t>, kinds> _bytes;
+
+		owner(std::string_view name);
+
+		public:
+		~owner();
+
+		std::string_view name();
+
+		uint64_t bytes(kind kind);
+
+		uint64_t total();
+
+		void add(kind kind, int64_t bytes);
+
+		public:
+		static std::shared_ptr<owner> create(std::string_view name);
+
+		/** The owner of everything that is allocated on this thread right now. */
+		static std::shared_ptr<owner> current();
+
+		/** The owner of everything that is allocated outside of any scope. */
+		static std::shared_ptr<owner> shared();
+	};
+
+	/** Makes an owner current on this thread for the lifetime of this object.
+	 */
+	class scope {
+		owner* _previous;
+
+		public:
+		scope(std::shared_ptr<owner> const& target);
+		~scope();
+
+		scope(scope const&)            = delete;
+		scope& operator=(scope const&) = delete;
+	};
+
+	/** Accounts a number of bytes to an owner until the last copy of it is destroyed or replaced.
+	 *
+	 * Copies share the same record, so objects that copy their handles around don't count the memory twice.
+	 */
+	class allocation {
+		std::shared_ptr<void> _record;
+
+		public:
+		allocation();
+
+		/** Account to whichever owner is current on this thread. */
+		allocation(kind kind, uint64_t bytes);
+
+		allocation(kind kind, uint64_t bytes, std::shared_ptr<owner> target);
+
+		void reset();
+	};
+
+	struct usage {
+		std::string                 name;
+		std::array<uint64_t, kinds> bytes;
+		uint64_t                    total;
+	};
+
+	/** Memory of every owner that currently holds any, largest first. */
+	std::vector<usage> snapshot();
+
+	/** Write the memory of every owner to the log, largest first. */
+	void log();
+} // namespace streamfx::util::memory
@@ -0,0 +1,447 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-metrics.hpp"
+#include "configuration.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+#include "util/util-memory.hpp"
+
+#ifdef ENABLE_PROFILING
+#include "obs/obs-source-factory.hpp"
+#include "util/util-profiler.hpp"
+#ifdef ENABLE_ENCODER_FFMPEG
+#include "encoders/encoder-ffmpeg.hpp"
+#endif
+#endif
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <locale>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <media-io/video-io.h>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::metrics> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_PATH "Metrics.Path"
+#define ST_CFG_INTERVAL "Metrics.Interval"
+
+#define ST_INTERVAL_DEFAULT 10 // Seconds.
+
+namespace {
+	const char* kind_labels[streamfx::util::memory::kinds] = {"texture", "render_target", "vertex_buffer", "cuda", "cv"};
+
+	constexpr double quantiles[] = {.50, .95, .99};
+
+	struct timing {
+		uint64_t count;
+		double   total;
+		double   quantile[std::size(quantiles)];
+	};
+
+#ifdef ENABLE_PROFILING
+	std::optional<timing> get_timing(std::shared_ptr<streamfx::util::profiler> const& profiler)
+	{
+		if (!profiler) {
+			return {};
+		}
+
+		timing result;
+		result.count = profiler->count();
+		result.total = std::chrono::duration<double>(profiler->total_duration()).count();
+		for (size_t idx = 0; idx < std::size(quantiles); idx++) {
+			result.quantile[idx] = std::chrono::duration<double>(profiler->percentile(quantiles[idx])).count();
+		}
+		return result;
+	}
+#endif
+
+	/** Everything that is written out, gathered once per interval. */
+	struct snapshot {
+		uint64_t timestamp;
+
+		uint64_t frames_total;
+		uint64_t frames_skipped;
+		uint64_t frames_lagged;
+
+		std::vector<streamfx::util::memory::usage> memory;
+
+		struct source {
+			std::string           name;
+			std::string           type;
+			std::optional<timing> cpu;
+			std::optional<timing> gpu;
+			uint64_t              skipped;
+			uint64_t              memory;
+		};
+		std::vector<source> sources;
+
+		struct encoder {
+			std::string                                 name;
+			std::string                                 codec;
+			std::vector<std::pair<const char*, timing>> stages;
+			size_t                                      queue_depth;
+			uint64_t                                    dropped;
+			uint64_t                                    bytes;
+		};
+		std::vector<encoder> encoders;
+	};
+
+	snapshot gather()
+	{
+		snapshot result;
+		result.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+		if (video_t* video = obs_get_video(); video) {
+			result.frames_total   = video_output_get_total_frames(video);
+			result.frames_skipped = video_output_get_skipped_frames(video);
+		} else {
+			result.frames_total   = 0;
+			result.frames_skipped = 0;
+		}
+		result.frames_lagged = obs_get_lagged_frames();
+
+		result.memory = streamfx::util::memory::snapshot();
+
+#ifdef ENABLE_PROFILING
+		for (auto const& info : streamfx::obs::source_instance::profile_all()) {
+			result.sources.push_back({info.name, info.type, get_timing(info.cpu), get_timing(info.gpu), info.skipped, info.memory});
+		}
+
+#ifdef ENABLE_ENCODER_FFMPEG
+		for (auto const& info : streamfx::encoder::ffmpeg::ffmpeg_instance::telemetry_all()) {
+			snapshot::encoder encoder{info.name, info.codec, {}, info.queue_depth, info.dropped, info.bytes};
+
+			std::pair<const char*, std::shared_ptr<streamfx::util::profiler>> stages[] = {
+				{"latency", info.latency}, {"convert", info.convert}, {"copy", info.copy}, {"prepare", info.prepare}, {"queue", info.queue}, {"encode", info.encode},
+			};
+			for (auto const& [stage, profiler] : stages) {
+				if (auto value = get_timing(profiler); value) {
+					encoder.stages.emplace_back(stage, value.value());
+				}
+			}
+			result.encoders.push_back(std::move(encoder));
+		}
+#endif
+#endif
+
+		return result;
+	}
+
+	/** Escape a label value of the Prometheus text format. */
+	std::string escape_label(std::string_view text)
+	{
+		std::string result;
+		result.reserve(text.size());
+		for (char chr : text) {
+			switch (chr) {
+			case '\\':
+				result += "\\\\";
+				break;
+			case '"':
+				result += "\\\"";
+				break;
+			case '\n':
+				result += "\\n";
+				break;
+			default:
+				result += chr;
+			}
+		}
+		return result;
+	}
+
+	/** Escape a string of JSON, without the surrounding quotes. */
+	std::string escape_json(std::string_view text)
+	{
+		std::string result;
+		result.reserve(text.size());
+		for (char chr : text) {
+			switch (chr) {
+			case '\\':
+				result += "\\\\";
+				break;
+			case '"':
+				result += "\\\"";
+				break;
+			case '\n':
+				result += "\\n";
+				break;
+			case '\r':
+				result += "\\r";
+				break;
+			case '\t':
+				result += "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(chr) < 0x20) {
+					char buffer[8];
+					snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(chr));
+					result += buffer;
+				} else {
+					result += chr;
+				}
+			}
+		}
+		return result;
+	}
+
+	void write_summary(std::ostream& out, std::string_view name, std::string const& labels, timing const& value)
+	{
+		for (size_t idx = 0; idx < std::size(quantiles); idx++) {
+			out << name << "{" << labels << ",quantile=\"" << quantiles[idx] << "\"} " << value.quantile[idx] << "\n";
+		}
+		out << name << "_sum{" << labels << "} " << value.total << "\n";
+		out << name << "_count{" << labels << "} " << value.count << "\n";
+	}
+
+	void write_timing(std::ostream& out, timing const& value)
+	{
+		out << "{\"count\":" << value.count << ",\"total\":" << value.total;
+		for (size_t idx = 0; idx < std::size(quantiles); idx++) {
+			out << ",\"p" << std::lround(quantiles[idx] * 100.) << "\":" << value.quantile[idx];
+		}
+		out << "}";
+	}
+} // namespace
+
+streamfx::util::metrics::~metrics()
+{
+	if (_worker.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_stop = true;
+		}
+		_cv.notify_all();
+		_worker.join();
+	}
+}
+
+streamfx::util::metrics::metrics() : _path(), _json(false), _interval(std::chrono::seconds(ST_INTERVAL_DEFAULT)), _lock(), _cv(), _stop(false), _worker()
+{
+	if (auto config = streamfx::configuration::instance(); config) {
+		auto dataptr = config->get();
+		if (const char* path = obs_data_get_string(dataptr.get(), ST_CFG_PATH); path && (path[0] != '\0')) {
+			_path = std::filesystem::u8path(path);
+		}
+		if (obs_data_has_user_value(dataptr.get(), ST_CFG_INTERVAL)) {
+			_interval = std::chrono::seconds(std::max<long long>(obs_data_get_int(dataptr.get(), ST_CFG_INTERVAL), 1));
+		}
+	}
+	if (_path.empty()) {
+		return;
+	}
+
+	auto extension = _path.extension().u8string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char v) { return static_cast<char>(tolower(v)); });
+	_json = (extension == ".json");
+
+	D_LOG_INFO("Writing metrics to '%s' every %lld seconds.", _path.u8string().c_str(), static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(_interval).count()));
+	_worker = std::thread(&metrics::work, this);
+}
+
+void streamfx::util::metrics::work()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	while (!_stop) {
+		lock.unlock();
+		try {
+			write();
+		} catch (const std::exception& ex) {
+			D_LOG_WARNING("Failed to write metrics: %s", ex.what());
+		}
+		lock.lock();
+
+		_cv.wait_for(lock, _interval, [this]() { return _stop; });
+	}
+}
+
+void streamfx::util::metrics::write()
+{
+	auto text = _json ? render_json() : render_prometheus();
+
+	// Readers must never see a partially written file, so write a copy and swap it in.
+	auto temporary = _path;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Unable to open file for writing.");
+		}
+		file.write(text.data(), static_cast<std::streamsize>(text.size()));
+		if (!file) {
+			throw std::runtime_error("Unable to write file.");
+		}
+	}
+	std::filesystem::rename(temporary, _path);
+}
+
+std::string streamfx::util::metrics::render_prometheus()
+{
+	auto               data = gather();
+	std::ostringstream out;
+	out.imbue(std::locale::classic());
+
+	out << "# HELP streamfx_obs_frames_total Frames rendered by OBS.\n";
+	out << "# TYPE streamfx_obs_frames_total counter\n";
+	out << "streamfx_obs_frames_total " << data.frames_total << "\n";
+	out << "# HELP streamfx_obs_frames_skipped_total Frames skipped by the video output, usually due to encoder lag.\n";
+	out << "# TYPE streamfx_obs_frames_skipped_total counter\n";
+	out << "streamfx_obs_frames_skipped_total " << data.frames_skipped << "\n";
+	out << "# HELP streamfx_obs_frames_lagged_total Frames missed due to rendering lag.\n";
+	out << "# TYPE streamfx_obs_frames_lagged_total counter\n";
+	out << "streamfx_obs_frames_lagged_total " << data.frames_lagged << "\n";
+
+	out << "# HELP streamfx_memory_bytes Memory held by each owner.\n";
+	out << "# TYPE streamfx_memory_bytes gauge\n";
+	for (auto const& usage : data.memory) {
+		for (size_t idx = 0; idx < memory::kinds; idx++) {
+			if (usage.bytes[idx] > 0) {
+				out << "streamfx_memory_bytes{owner=\"" << escape_label(usage.name) << "\",kind=\"" << kind_labels[idx] << "\"} " << usage.bytes[idx] << "\n";
+			}
+		}
+	}
+
+	if (!data.sources.empty()) {
+		out << "# HELP streamfx_render_seconds Time spent rendering each instance.\n";
+		out << "# TYPE streamfx_render_seconds summary\n";
+		for (auto const& source : data.sources) {
+			std::string labels = "name=\"" + escape_label(source.name) + "\",type=\"" + escape_label(source.type) + "\"";
+			if (source.cpu) {
+				write_summary(out, "streamfx_render_seconds", labels + ",device=\"cpu\"", source.cpu.value());
+			}
+			if (source.gpu) {
+				write_summary(out, "streamfx_render_seconds", labels + ",device=\"gpu\"", source.gpu.value());
+			}
+		}
+		out << "# HELP streamfx_render_skipped_total Renders of each instance that were skipped.\n";
+		out << "# TYPE streamfx_render_skipped_total counter\n";
+		for (auto const& source : data.sources) {
+			out << "streamfx_render_skipped_total{name=\"" << escape_label(source.name) << "\",type=\"" << escape_label(source.type) << "\"} " << source.skipped << "\n";
+		}
+	}
+
+	if (!data.encoders.empty()) {
+		out << "# HELP streamfx_encoder_seconds Time each frame spends in each stage of an encoder.\n";
+		out << "# TYPE streamfx_encoder_seconds summary\n";
+		for (auto const& encoder : data.encoders) {
+			std::string labels = "name=\"" + escape_label(encoder.name) + "\",codec=\"" + escape_label(encoder.codec) + "\"";
+			for (auto const& [stage, value] : encoder.stages) {
+				write_summary(out, "streamfx_encoder_seconds", labels + ",stage=\"" + stage + "\"", value);
+			}
+		}
+		out << "# HELP streamfx_encoder_queue_frames Frames waiting in an encoder.\n";
+		out << "# TYPE streamfx_encoder_queue_frames gauge\n";
+		for (auto const& encoder : data.encoders) {
+			out << "streamfx_encoder_queue_frames{name=\"" << escape_label(encoder.name) << "\",codec=\"" << escape_label(encoder.codec) << "\"} " << encoder.queue_depth << "\n";
+		}
+		out << "# HELP streamfx_encoder_dropped_frames_total Frames dropped by an encoder.\n";
+		out << "# TYPE streamfx_encoder_dropped_frames_total counter\n";
+		for (auto const& encoder : data.encoders) {
+			out << "streamfx_encoder_dropped_frames_total{name=\"" << escape_label(encoder.name) << "\",codec=\"" << escape_label(encoder.codec) << "\"} " << encoder.dropped << "\n";
+		}
+		out << "# HELP streamfx_encoder_bytes_total Bytes produced by an encoder.\n";
+		out << "# TYPE streamfx_encoder_bytes_total counter\n";
+		for (auto const& encoder : data.encoders) {
+			out << "streamfx_encoder_bytes_total{name=\"" << escape_label(encoder.name) << "\",codec=\"" << escape_label(encoder.codec) << "\"} " << encoder.bytes << "\n";
+		}
+	}
+
+	return out.str();
+}
+
+std::string streamfx::util::metrics::render_json()
+{
+	auto               data = gather();
+	std::ostringstream out;
+	out.imbue(std::locale::classic());
+
+	out << "{\"timestamp\":" << data.timestamp;
+	out << ",\"frames\":{\"total\":" << data.frames_total << ",\"skipped\":" << data.frames_skipped << ",\"lagged\":" << data.frames_lagged << "}";
+
+	out << ",\"memory\":[";
+	for (size_t idx = 0; idx < data.memory.size(); idx++) {
+		auto const& usage = data.memory[idx];
+		out << (idx > 0 ? "," : "") << "{\"owner\":\"" << escape_json(usage.name) << "\",\"total\":" << usage.total << ",\"bytes\":{";
+		for (size_t kdx = 0; kdx < memory::kinds; kdx++) {
+			out << (kdx > 0 ? "," : "") << "\"" << kind_labels[kdx] << "\":" << usage.bytes[kdx];
+		}
+		out << "}}";
+	}
+	out << "]";
+
+	out << ",\"sources\":[";
+	for (size_t idx = 0; idx < data.sources.size(); idx++) {
+		auto const& source = data.sources[idx];
+		out << (idx > 0 ? "," : "") << "{\"name\":\"" << escape_json(source.name) << "\",\"type\":\"" << escape_json(source.type) << "\",\"skipped\":" << source.skipped << ",\"memory\":" << source.memory;
+		if (source.cpu) {
+			out << ",\"cpu\":";
+			write_timing(out, source.cpu.value());
+		}
+		if (source.gpu) {
+			out << ",\"gpu\":";
+			write_timing(out, source.gpu.value());
+		}
+		out << "}";
+	}
+	out << "]";
+
+	out << ",\"encoders\":[";
+	for (size_t idx = 0; idx < data.encoders.size(); idx++) {
+		auto const& encoder = data.encoders[idx];
+		out << (idx > 0 ? "," : "") << "{\"name\":\"" << escape_json(encoder.name) << "\",\"codec\":\"" << escape_json(encoder.codec) << "\",\"queue\":" << encoder.queue_depth << ",\"dropped\":" << encoder.dropped << ",\"bytes\":" << encoder.bytes << ",\"stages\":{";
+		for (size_t sdx = 0; sdx < encoder.stages.size(); sdx++) {
+			out << (sdx > 0 ? "," : "") << "\"" << encoder.stages[sdx].first << "\":";
+			write_timing(out, encoder.stages[sdx].second);
+		}
+		out << "}}";
+	}
+	out << "]}\n";
+
+	return out.str();
+}
+
+std::shared_ptr<streamfx::util::metrics> streamfx::util::metrics::instance()
+{
+	static std::weak_ptr<streamfx::util::metrics> winst;
+	static std::mutex                             mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::util::metrics>(new streamfx::util::metrics());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::util::metrics> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance = streamfx::util::metrics::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::LOW); // Everything it reports on should exist by now.
@@ -0,0 +1,55 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "warning-enable.hpp"
+
+namespace streamfx::util {
+	/** Periodically write what StreamFX knows about itself to a file, for machines that nobody watches.
+	 *
+	 * Covers the memory of every owner, and with profiling enabled also the render times of every instance and the
+	 * telemetry of every FFmpeg encoder. Files ending in '.json' are written as JSON, anything else in the Prometheus
+	 * text format, which the textfile collector of node_exporter picks up as is. The file is replaced in one step, so
+	 * readers never see a partial one.
+	 *
+	 * Only runs if "Metrics.Path" is set in the configuration, with "Metrics.Interval" in seconds.
+	 */
+	class metrics {
+		std::filesystem::path     _path;
+		bool                      _json;
+		std::chrono::milliseconds _interval;
+
+		std::mutex              _lock;
+		std::condition_variable _cv;
+		bool                    _stop;
+		std::thread             _worker;
+
+		public:
+		~metrics();
+
+		private:
+		metrics();
+
+		void work();
+
+		void write();
+
+		std::string render_prometheus();
+
+		std::string render_json();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::metrics> instance();
+	};
+} // namespace streamfx::util
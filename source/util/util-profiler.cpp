@@ -3,12 +3,32 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "util-profiler.hpp"
+#include "util-trace.hpp"
 
 #include "warning-disable.hpp"
-#include <iterator>
+#include <algorithm>
 #include "warning-enable.hpp"
 
-streamfx::util::profiler::profiler() {}
+static size_t get_shard_index()
+{
+	static std::atomic<size_t> next_index{0};
+	static thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % streamfx::util::profiler::shard_count;
+	return index;
+}
+
+static size_t find_magnitude(uint64_t value)
+{
+	size_t magnitude = 0;
+	while (value >>= 1) {
+		++magnitude;
+	}
+	return magnitude;
+}
+
+streamfx::util::profiler::profiler(std::string_view name) : _shards(new shard[shard_count]), _name(name)
+{
+	reset();
+}
 
 streamfx::util::profiler::~profiler() {}
 
@@ -19,117 +39,146 @@ std::shared_ptr<streamfx::util::profiler::instance> streamfx::util::profiler::tr
 
 void streamfx::util::profiler::track(std::chrono::nanoseconds duration)
 {
-	std::unique_lock<std::mutex> ul(_timings_lock);
-	auto                         itr = _timings.find(duration);
-	if (itr == _timings.end()) {
-		_timings.emplace(duration, 1u);
-	} else {
-		itr->second++;
+	uint64_t value = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+	shard&   sh    = _shards[get_shard_index()];
+
+	sh.buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+	sh.count.fetch_add(1, std::memory_order_relaxed);
+	sh.total.fetch_add(value, std::memory_order_relaxed);
+
+	for (uint64_t cur = sh.minimum.load(std::memory_order_relaxed); (value < cur) && !sh.minimum.compare_exchange_weak(cur, value, std::memory_order_relaxed);) {
+	}
+	for (uint64_t cur = sh.maximum.load(std::memory_order_relaxed); (value > cur) && !sh.maximum.compare_exchange_weak(cur, value, std::memory_order_relaxed);) {
 	}
 }
 
 uint64_t streamfx::util::profiler::count()
 {
 	uint64_t count = 0;
-
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
+	for (size_t idx = 0; idx < shard_count; idx++) {
+		count += _shards[idx].count.load(std::memory_order_relaxed);
 	}
-
-	for (auto kv : copy_timings) {
-		count += kv.second;
-	}
-
 	return count;
 }
 
 std::chrono::nanoseconds streamfx::util::profiler::total_duration()
 {
-	std::chrono::nanoseconds duration{0};
-
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
+	uint64_t total = 0;
+	for (size_t idx = 0; idx < shard_count; idx++) {
+		total += _shards[idx].total.load(std::memory_order_relaxed);
 	}
+	return std::chrono::nanoseconds(total);
+}
 
-	for (auto kv : copy_timings) {
-		duration += kv.first * kv.second;
+double_t streamfx::util::profiler::average_duration()
+{
+	uint64_t total = 0;
+	uint64_t count = 0;
+	for (size_t idx = 0; idx < shard_count; idx++) {
+		total += _shards[idx].total.load(std::memory_order_relaxed);
+		count += _shards[idx].count.load(std::memory_order_relaxed);
 	}
 
-	return duration;
+	return double_t(total) / double_t(count);
 }
 
-double_t streamfx::util::profiler::average_duration()
+std::chrono::nanoseconds streamfx::util::profiler::percentile(double_t percentile, bool by_time)
 {
-	std::chrono::nanoseconds duration{0};
-	uint64_t                 count = 0;
+	std::array<uint64_t, bucket_count> buckets;
+	uint64_t                           calls, smallest, largest;
+	merge(buckets, calls, smallest, largest);
 
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
+	if (calls == 0) {
+		return std::chrono::nanoseconds(-1);
 	}
+	percentile = std::clamp<double_t>(percentile, 0., 1.);
 
-	for (auto kv : copy_timings) {
-		duration += kv.first * kv.second;
-		count += kv.second;
+	if (by_time) { // Return by time percentile.
+		// Find the first bucket at or above the requested point between the smallest and largest time.
+		uint64_t target = smallest + static_cast<uint64_t>(double_t(largest - smallest) * percentile);
+		for (size_t idx = bucket_index(target); idx < bucket_count; idx++) {
+			if (buckets[idx] > 0) {
+				return std::chrono::nanoseconds(std::clamp(bucket_value(idx), smallest, largest));
+			}
+		}
+	} else { // Return by call percentile.
+		// Find the first bucket where the accumulated number of calls reaches the requested percentile.
+		uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(double_t(calls) * percentile)), 1);
+		uint64_t accu   = 0;
+		for (size_t idx = 0; idx < bucket_count; idx++) {
+			accu += buckets[idx];
+			if (accu >= target) {
+				return std::chrono::nanoseconds(std::clamp(bucket_value(idx), smallest, largest));
+			}
+		}
 	}
 
-	return double_t(duration.count()) / double_t(count);
+	return std::chrono::nanoseconds(largest);
 }
 
-template<typename T>
-inline bool is_equal(T a, T b, T c)
+void streamfx::util::profiler::reset()
 {
-	return (a == b) || ((a >= (b - c)) && (a <= (b + c)));
+	for (size_t idx = 0; idx < shard_count; idx++) {
+		shard& sh = _shards[idx];
+		sh.count.store(0, std::memory_order_relaxed);
+		sh.total.store(0, std::memory_order_relaxed);
+		sh.minimum.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+		sh.maximum.store(0, std::memory_order_relaxed);
+		for (auto& bucket : sh.buckets) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
 }
 
-std::chrono::nanoseconds streamfx::util::profiler::percentile(double_t percentile, bool by_time)
+std::string_view streamfx::util::profiler::name()
 {
-	constexpr double_t edge  = 0.00005;
-	uint64_t           calls = count();
+	return _name;
+}
 
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), inserter(copy_timings, copy_timings.end()));
-	}
-	if (by_time) { // Return by time percentile.
-		// Find largest and smallest time.
-		std::chrono::nanoseconds smallest = copy_timings.begin()->first;
-		std::chrono::nanoseconds largest  = copy_timings.rbegin()->first;
-		std::chrono::nanoseconds variance = largest - smallest;
-
-		for (auto kv : copy_timings) {
-			double_t kv_pct = double_t((kv.first - smallest).count()) / double_t(variance.count());
-			if (is_equal<double_t>(kv_pct, percentile, edge) || (kv_pct > percentile)) {
-				return std::chrono::nanoseconds(kv.first);
-			}
-		}
-	} else { // Return by call percentile.
-		if (percentile == 0.0) {
-			return copy_timings.begin()->first;
+void streamfx::util::profiler::merge(std::array<uint64_t, bucket_count>& buckets, uint64_t& count, uint64_t& minimum, uint64_t& maximum)
+{
+	buckets.fill(0);
+	count   = 0;
+	minimum = std::numeric_limits<uint64_t>::max();
+	maximum = 0;
+
+	for (size_t idx = 0; idx < shard_count; idx++) {
+		shard& sh = _shards[idx];
+		for (size_t bdx = 0; bdx < bucket_count; bdx++) {
+			uint64_t value = sh.buckets[bdx].load(std::memory_order_relaxed);
+			buckets[bdx] += value;
+			count += value;
 		}
+		minimum = std::min(minimum, sh.minimum.load(std::memory_order_relaxed));
+		maximum = std::max(maximum, sh.maximum.load(std::memory_order_relaxed));
+	}
+}
 
-		uint64_t accu_calls_now = 0;
-		for (auto kv : copy_timings) {
-			uint64_t accu_calls_last = accu_calls_now;
-			accu_calls_now += kv.second;
+size_t streamfx::util::profiler::bucket_index(uint64_t value)
+{
+	// Values below 2^(precision+1) are stored exactly, everything else keeps only 'precision' bits of mantissa.
+	size_t magnitude = find_magnitude(value);
+	if (magnitude <= precision) {
+		return static_cast<size_t>(value);
+	}
 
-			double_t percentile_last = double_t(accu_calls_last) / double_t(calls);
-			double_t percentile_now  = double_t(accu_calls_now) / double_t(calls);
+	size_t shift = std::min(magnitude, max_magnitude) - precision;
+	if (magnitude > max_magnitude) {
+		return bucket_count - 1;
+	}
+	return (shift << precision) + static_cast<size_t>(value >> shift);
+}
 
-			if (is_equal<double_t>(percentile, percentile_now, edge)
-				|| ((percentile_last < percentile) && (percentile_now > percentile))) {
-				return std::chrono::nanoseconds(kv.first);
-			}
-		}
+uint64_t streamfx::util::profiler::bucket_value(size_t index)
+{
+	if (index < (sub_buckets * 2)) {
+		return index;
 	}
 
-	return std::chrono::nanoseconds(-1);
+	// Report the center of the bucket to halve the error.
+	size_t   shift = (index >> precision) - 1;
+	uint64_t lower = static_cast<uint64_t>(index - (shift << precision)) << shift;
+	return lower + ((uint64_t(1) << shift) >> 1);
 }
 
 streamfx::util::profiler::instance::instance(std::shared_ptr<streamfx::util::profiler> parent)
@@ -142,6 +191,11 @@ streamfx::util::profiler::instance::~instance()
 	auto dur = end - _start;
 	if (_parent) {
 		_parent->track(dur);
+
+		if (!_parent->name().empty()) {
+			static auto recorder = streamfx::util::trace::recorder::instance();
+			recorder->record(_parent->name(), "profiler", _start, end);
+		}
 	}
 }
 
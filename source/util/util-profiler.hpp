@@ -6,15 +6,41 @@
 #include "common.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <map>
-#include <mutex>
+#include <memory>
+#include <new>
 #include "warning-enable.hpp"
 
 namespace streamfx::util {
+	/** Lock-free duration histogram.
+	 *
+	 * Timings are stored in logarithmically sized buckets, with 2^precision linear sub-buckets per power of two, which
+	 * keeps the relative error below 2^-precision regardless of magnitude. Every thread writes into one of a fixed
+	 * number of shards using relaxed atomics, the shards are only merged when reading.
+	 */
 	class profiler : public std::enable_shared_from_this<streamfx::util::profiler> {
-		std::map<std::chrono::nanoseconds, size_t> _timings;
-		std::mutex                                 _timings_lock;
+		public:
+		static constexpr size_t precision     = 5;
+		static constexpr size_t sub_buckets   = size_t(1) << precision;
+		static constexpr size_t max_magnitude = 42; // 2^42ns is a bit over an hour.
+		static constexpr size_t bucket_count  = (max_magnitude - precision + 1) * sub_buckets + sub_buckets;
+		static constexpr size_t shard_count   = 8;
+
+		private:
+		struct shard {
+#if __cpp_lib_hardware_interference_size >= 201603
+			alignas(std::hardware_destructive_interference_size)
+#endif
+				std::atomic<uint64_t> count;
+			std::atomic<uint64_t>                           total;
+			std::atomic<uint64_t>                           minimum;
+			std::atomic<uint64_t>                           maximum;
+			std::array<std::atomic<uint64_t>, bucket_count> buckets;
+		};
+		std::unique_ptr<shard[]> _shards;
+		std::string              _name;
 
 		public:
 		class instance {
@@ -32,7 +58,7 @@ namespace streamfx::util {
 		};
 
 		private:
-		profiler();
+		profiler(std::string_view name);
 
 		public:
 		~profiler();
@@ -49,10 +75,26 @@ namespace streamfx::util {
 
 		std::chrono::nanoseconds percentile(double_t percentile, bool by_time = false);
 
+		void reset();
+
+		std::string_view name();
+
+		private:
+		void merge(std::array<uint64_t, bucket_count>& buckets, uint64_t& count, uint64_t& minimum, uint64_t& maximum);
+
+		public:
+		static size_t bucket_index(uint64_t value);
+
+		static uint64_t bucket_value(size_t index);
+
 		public:
-		static std::shared_ptr<streamfx::util::profiler> create()
+		/** Create a new profiler.
+		 *
+		 * @param name If not empty, every tracked instance is also recorded by the trace recorder under this name.
+		 */
+		static std::shared_ptr<streamfx::util::profiler> create(std::string_view name = {})
 		{
-			return std::shared_ptr<streamfx::util::profiler>{new profiler()};
+			return std::shared_ptr<streamfx::util::profiler>{new profiler(name)};
 		}
 	};
 } // namespace streamfx::util
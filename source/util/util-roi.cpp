@@ -0,0 +1,56 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-roi.hpp"
+
+// Regions older than this are treated as gone, which covers producers that are hidden or stalled.
+constexpr std::chrono::milliseconds max_region_age{500};
+
+streamfx::util::roi::channel::~channel() {}
+
+streamfx::util::roi::channel::channel() : _lock(), _regions() {}
+
+void streamfx::util::roi::channel::publish(const void* producer, std::vector<region> regions)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_regions.insert_or_assign(producer, std::pair{std::chrono::steady_clock::now(), std::move(regions)});
+}
+
+void streamfx::util::roi::channel::withdraw(const void* producer)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_regions.erase(producer);
+}
+
+std::vector<streamfx::util::roi::region> streamfx::util::roi::channel::collect()
+{
+	std::vector<region> result;
+	auto                now = std::chrono::steady_clock::now();
+
+	std::unique_lock<std::mutex> ul(_lock);
+	for (auto iter = _regions.begin(); iter != _regions.end();) {
+		if ((now - iter->second.first) > max_region_age) {
+			iter = _regions.erase(iter);
+			continue;
+		}
+		result.insert(result.end(), iter->second.second.begin(), iter->second.second.end());
+		iter++;
+	}
+
+	return result;
+}
+
+std::shared_ptr<streamfx::util::roi::channel> streamfx::util::roi::channel::instance()
+{
+	static std::weak_ptr<streamfx::util::roi::channel> winst;
+	static std::mutex                                  mtx;
+
+	std::unique_lock<std::mutex> lock(mtx);
+	auto                         instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::util::roi::channel>(new streamfx::util::roi::channel());
+		winst    = instance;
+	}
+	return instance;
+}
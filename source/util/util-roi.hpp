@@ -0,0 +1,46 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::roi {
+	/** A region of interest in normalized coordinates (0..1) of the producer's output.
+	 */
+	struct region {
+		float left;
+		float top;
+		float right;
+		float bottom;
+	};
+
+	/** Hands regions of interest from producers (e.g. face tracking) to consumers (e.g. encoders).
+	 *
+	 * Producers republish every tick, so regions from producers that stopped publishing expire on their own.
+	 */
+	class channel {
+		std::mutex                                                                                   _lock;
+		std::map<const void*, std::pair<std::chrono::steady_clock::time_point, std::vector<region>>> _regions;
+
+		public:
+		~channel();
+		channel();
+
+		void publish(const void* producer, std::vector<region> regions);
+		void withdraw(const void* producer);
+
+		std::vector<region> collect();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::roi::channel> instance();
+	};
+} // namespace streamfx::util::roi
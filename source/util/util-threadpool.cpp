@@ -6,11 +6,15 @@
 
 #include "util-threadpool.hpp"
 #include "common.hpp"
+#include "configuration.hpp"
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <cstddef>
+#include <fstream>
+#include <string>
 #include "warning-enable.hpp"
 
 #include "warning-disable.hpp"
@@ -18,6 +22,11 @@
 #include <Windows.h>
 #elif defined(D_PLATFORM_LINUX)
 #include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+#if defined(D_PLATFORM_INSTR_X86)
+#include <emmintrin.h>
 #endif
 #include "warning-enable.hpp"
 
@@ -35,34 +44,410 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
-streamfx::util::threadpool::task::task(task_callback_t callback, task_data_t data) : _callback(callback), _data(data), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
+#define ST_CFG_AFFINITY "Threading.Affinity"
+#define ST_CFG_IDLE_SPIN "Threading.IdleSpin"
+
+#define ST_IDLE_SPIN_DEFAULT 50 // Microseconds.
+
+namespace {
+	/** Recycling storage for fixed-size blocks.
+	 *
+	 * Every thread keeps a small cache of free blocks, which is refilled from or flushed to a shared list in batches.
+	 * Blocks are never returned to the system, so once the pool has grown to the peak number of tasks in flight, no
+	 * further heap allocations happen.
+	 */
+	template<size_t Size, size_t Align>
+	class block_pool {
+		union block {
+			block* next;
+			alignas(Align) std::byte storage[Size];
+		};
+
+		static constexpr size_t batch_size = 32;
+
+		struct cache {
+			block* head  = nullptr;
+			size_t count = 0;
+
+			~cache()
+			{
+				block_pool::instance().release(head, count);
+			}
+		};
+
+		std::mutex _lock;
+		block*     _head;
+		size_t     _count;
+
+		block_pool() : _lock(), _head(nullptr), _count(0) {}
+
+		static cache& local()
+		{
+			static thread_local cache local_cache;
+			return local_cache;
+		}
+
+		void release(block* head, size_t count)
+		{
+			if (!head) {
+				return;
+			}
+
+			block* tail = head;
+			while (tail->next) {
+				tail = tail->next;
+			}
+
+			std::lock_guard<std::mutex> lg(_lock);
+			tail->next = _head;
+			_head      = head;
+			_count += count;
+		}
+
+		public:
+		static block_pool& instance()
+		{
+			static block_pool pool;
+			return pool;
+		}
+
+		void* allocate()
+		{
+			cache& lc = local();
+			if (!lc.head) { // Refill the local cache from the shared list.
+				std::lock_guard<std::mutex> lg(_lock);
+				for (size_t idx = 0; (idx < batch_size) && _head; idx++) {
+					block* blk = _head;
+					_head      = blk->next;
+					blk->next  = lc.head;
+					lc.head    = blk;
+					--_count;
+					++lc.count;
+				}
+			}
+
+			if (lc.head) {
+				block* blk = lc.head;
+				lc.head    = blk->next;
+				--lc.count;
+				return blk->storage;
+			}
+
+			return new block;
+		}
+
+		void free(void* ptr)
+		{
+			cache& lc  = local();
+			block* blk = reinterpret_cast<block*>(ptr);
+			blk->next  = lc.head;
+			lc.head    = blk;
+			++lc.count;
+
+			if (lc.count > (batch_size * 2)) { // Flush half of the local cache to the shared list.
+				block* head = lc.head;
+				block* tail = lc.head;
+				for (size_t idx = 1; idx < batch_size; idx++) {
+					tail = tail->next;
+				}
+				lc.head    = tail->next;
+				tail->next = nullptr;
+				lc.count -= batch_size;
+				release(head, batch_size);
+			}
+		}
+	};
+
+	template<typename T>
+	struct pool_allocator {
+		typedef T value_type;
+
+		pool_allocator() noexcept = default;
+		template<typename U>
+		pool_allocator(const pool_allocator<U>&) noexcept
+		{}
+
+		T* allocate(size_t count)
+		{
+			if (count != 1) {
+				return static_cast<T*>(::operator new(sizeof(T) * count));
+			}
+			return static_cast<T*>(block_pool<sizeof(T), alignof(T)>::instance().allocate());
+		}
+
+		void deallocate(T* ptr, size_t count) noexcept
+		{
+			if (count != 1) {
+				::operator delete(ptr);
+				return;
+			}
+			block_pool<sizeof(T), alignof(T)>::instance().free(ptr);
+		}
+
+		template<typename U>
+		bool operator==(const pool_allocator<U>&) const noexcept
+		{
+			return true;
+		}
+		template<typename U>
+		bool operator!=(const pool_allocator<U>&) const noexcept
+		{
+			return false;
+		}
+	};
+
+	/** Logical processors the process may run on, by class of core.
+	 *
+	 * On CPUs with only one class of core, 'performance' and 'efficiency' are both empty.
+	 */
+	struct core_classes {
+		std::vector<uint32_t> any;
+		std::vector<uint32_t> performance;
+		std::vector<uint32_t> efficiency;
+	};
+
+#if defined(D_PLATFORM_LINUX)
+	/** Parse a list of processors like "0-7,16,18-19", as used throughout sysfs. */
+	std::vector<uint32_t> parse_cpu_list(std::string const& list)
+	{
+		std::vector<uint32_t> result;
+		for (size_t pos = 0; pos < list.size();) {
+			size_t end   = std::min(list.find(',', pos), list.size());
+			auto   range = list.substr(pos, end - pos);
+			pos          = end + 1;
+
+			try {
+				size_t dash  = range.find('-');
+				auto   first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+				auto   last  = (dash != std::string::npos) ? static_cast<uint32_t>(std::stoul(range.substr(dash + 1))) : first;
+				for (uint32_t cpu = first; cpu <= last; cpu++) {
+					result.push_back(cpu);
+				}
+			} catch (...) {
+			}
+		}
+		return result;
+	}
+
+	std::string read_line(std::string const& path)
+	{
+		std::ifstream file(path);
+		std::string   line;
+		std::getline(file, line);
+		return line;
+	}
+#endif
+
+	core_classes const& detect_core_classes()
+	{
+		static core_classes classes = []() {
+			core_classes result;
+#if defined(D_PLATFORM_WINDOWS)
+			// Only the processors of the group the process runs in are considered, which are up to 64.
+			DWORD_PTR process_mask = 0;
+			DWORD_PTR system_mask  = 0;
+			USHORT    group        = 0;
+			USHORT    group_count  = 1;
+			if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+				return result;
+			}
+			GetProcessGroupAffinity(GetCurrentProcess(), &group_count, &group);
+			for (uint32_t cpu = 0; cpu < (sizeof(DWORD_PTR) * 8); cpu++) {
+				if (process_mask & (DWORD_PTR(1) << cpu)) {
+					result.any.push_back(cpu);
+				}
+			}
+
+			DWORD length = 0;
+			GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+			std::vector<uint8_t> buffer(length);
+			if (!GetLogicalProcessorInformationEx(RelationProcessorCore, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length)) {
+				return result;
+			}
+
+			// Higher efficiency classes are faster, despite the name.
+			std::vector<std::pair<BYTE, KAFFINITY>> cores;
+			BYTE                                    lowest  = 0xFF;
+			BYTE                                    highest = 0;
+			for (DWORD offset = 0; offset < length;) {
+				auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+				offset += info->Size;
+				if ((info->Relationship != RelationProcessorCore) || (info->Processor.GroupMask[0].Group != group)) {
+					continue;
+				}
+				cores.emplace_back(info->Processor.EfficiencyClass, info->Processor.GroupMask[0].Mask & process_mask);
+				lowest  = std::min(lowest, info->Processor.EfficiencyClass);
+				highest = std::max(highest, info->Processor.EfficiencyClass);
+			}
+			if (lowest >= highest) {
+				return result;
+			}
+
+			for (auto [efficiency, mask] : cores) {
+				for (uint32_t cpu = 0; cpu < (sizeof(KAFFINITY) * 8); cpu++) {
+					if (mask & (KAFFINITY(1) << cpu)) {
+						if (efficiency == highest) {
+							result.performance.push_back(cpu);
+						} else if (efficiency == lowest) {
+							result.efficiency.push_back(cpu);
+						}
+					}
+				}
+			}
+#elif defined(D_PLATFORM_LINUX)
+			// The main thread still has the affinity the process was started with, unlike the thread we may be on.
+			cpu_set_t process_set;
+			CPU_ZERO(&process_set);
+			if (sched_getaffinity(getpid(), sizeof(process_set), &process_set) != 0) {
+				return result;
+			}
+			for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+				if (CPU_ISSET(cpu, &process_set)) {
+					result.any.push_back(cpu);
+				}
+			}
+			auto allowed = [&process_set](std::vector<uint32_t> cpus) {
+				cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [&process_set](uint32_t cpu) { return (cpu >= CPU_SETSIZE) || !CPU_ISSET(cpu, &process_set); }), cpus.end());
+				return cpus;
+			};
+
+			if (auto core = read_line("/sys/devices/cpu_core/cpus"), atom = read_line("/sys/devices/cpu_atom/cpus"); !core.empty() && !atom.empty()) {
+				// Intel hybrid CPUs list each class of core as its own PMU.
+				result.performance = allowed(parse_cpu_list(core));
+				result.efficiency  = allowed(parse_cpu_list(atom));
+			} else {
+				// Everything else, like big.LITTLE, reports the relative capacity of each processor.
+				std::vector<std::pair<uint32_t, uint32_t>> capacities;
+				uint32_t                                   lowest  = UINT32_MAX;
+				uint32_t                                   highest = 0;
+				for (auto cpu : result.any) {
+					auto line = read_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpu_capacity");
+					if (line.empty()) {
+						capacities.clear();
+						break;
+					}
+					try {
+						auto capacity = static_cast<uint32_t>(std::stoul(line));
+						capacities.emplace_back(cpu, capacity);
+						lowest  = std::min(lowest, capacity);
+						highest = std::max(highest, capacity);
+					} catch (...) {
+						capacities.clear();
+						break;
+					}
+				}
+				if (!capacities.empty() && (lowest < highest)) {
+					for (auto [cpu, capacity] : capacities) {
+						if (capacity == highest) {
+							result.performance.push_back(cpu);
+						} else if (capacity == lowest) {
+							result.efficiency.push_back(cpu);
+						}
+					}
+				}
+			}
+#endif
+			if (result.performance.empty() || result.efficiency.empty()) {
+				result.performance.clear();
+				result.efficiency.clear();
+			}
+			D_LOG_INFO("Found %zu processors, of which %zu are performance and %zu are efficiency cores.", result.any.size(), result.performance.size(), result.efficiency.size());
+			return result;
+		}();
+		return classes;
+	}
+
+	void set_thread_affinity(std::vector<uint32_t> const& cpus)
+	{
+		if (cpus.empty()) {
+			return;
+		}
+#if defined(D_PLATFORM_WINDOWS)
+		DWORD_PTR mask = 0;
+		for (auto cpu : cpus) {
+			mask |= DWORD_PTR(1) << cpu;
+		}
+		SetThreadAffinityMask(GetCurrentThread(), mask);
+#elif defined(D_PLATFORM_LINUX)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (auto cpu : cpus) {
+			CPU_SET(cpu, &set);
+		}
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+	}
+
+	inline void spin_pause()
+	{
+#if defined(D_PLATFORM_INSTR_X86)
+		_mm_pause();
+#else
+		std::this_thread::yield();
+#endif
+	}
+} // namespace
+
+streamfx::util::threadpool::task::task(task_callback_t callback, task_data_t data, priority priority) : _callback(callback), _invoke(nullptr), _context(nullptr), _data(data), _priority(priority), _pool(nullptr), _observers(), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
+
+streamfx::util::threadpool::task::task(task_invoke_t invoke, void* context, task_data_t data, priority priority) : _callback(), _invoke(invoke), _context(context), _data(data), _priority(priority), _pool(nullptr), _observers(), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
 
 streamfx::util::threadpool::task::~task() {}
 
 void streamfx::util::threadpool::task::run()
 {
-	std::lock_guard<std::mutex> lg(_lock);
-	if (!_cancelled) {
-		try {
-			_callback(_data);
-		} catch (const std::exception& ex) {
-			D_LOG_ERROR("Unhandled exception in Task: %s.", ex.what());
-			_failed = false;
-		} catch (...) {
-			D_LOG_ERROR("Unhandled exception in Task.", nullptr);
-			_failed = true;
+	std::list<std::function<void(bool)>> observers;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (!_cancelled) {
+			try {
+				if (_invoke) {
+					_invoke(_context, _data);
+				} else {
+					_callback(_data);
+				}
+			} catch (const std::exception& ex) {
+				D_LOG_ERROR("Unhandled exception in Task: %s.", ex.what());
+				_failed = true;
+			} catch (...) {
+				D_LOG_ERROR("Unhandled exception in Task.", nullptr);
+				_failed = true;
+			}
 		}
+		_completed = true;
+		_status_changed.notify_all();
+
+		// Release the callback as soon as possible, as the task itself may be kept alive for much longer by whoever
+		// pushed it.
+		_callback = nullptr;
+		observers.swap(_observers);
+	}
+
+	// Observers may queue further work, so they must be called without holding the lock.
+	for (auto& observer : observers) {
+		observer(!_cancelled && !_failed);
 	}
-	_completed = true;
-	_status_changed.notify_all();
 }
 
 void streamfx::util::threadpool::task::cancel()
 {
-	std::lock_guard<std::mutex> lg(_lock);
-	_cancelled = true;
-	_completed = true;
-	_status_changed.notify_all();
+	std::list<std::function<void(bool)>> observers;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		_cancelled = true;
+		_completed = true;
+		_status_changed.notify_all();
+		observers.swap(_observers);
+	}
+
+	for (auto& observer : observers) {
+		observer(false);
+	}
+}
+
+streamfx::util::threadpool::priority streamfx::util::threadpool::task::get_priority()
+{
+	return _priority;
 }
 
 bool streamfx::util::threadpool::task::is_cancelled()
@@ -93,64 +478,363 @@ void streamfx::util::threadpool::task::await_completion()
 	wait();
 }
 
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::task::then(task_callback_t callback, task_data_t data, priority priority)
+{
+	if (!_pool) {
+		throw std::logic_error("Continuations require a task that was pushed to a threadpool.");
+	}
+
+	auto        continuation = _pool->create(callback, data, priority);
+	threadpool* pool         = _pool;
+	observe([this, pool, continuation](bool success) {
+		if (!success) {
+			continuation->cancel();
+			return;
+		}
+
+		if (!continuation->_data) {
+			continuation->_data = _data;
+		}
+		pool->enqueue(continuation);
+		pool->balance(continuation->_priority);
+	});
+
+	return continuation;
+}
+
+void streamfx::util::threadpool::task::observe(std::function<void(bool)> observer)
+{
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (!_completed) {
+			_observers.emplace_back(observer);
+			return;
+		}
+	}
+
+	observer(!_cancelled && !_failed);
+}
+
+streamfx::util::threadpool::task_group::~task_group()
+{
+	cancel();
+}
+
+streamfx::util::threadpool::task_group::task_group(std::shared_ptr<threadpool> pool) : _pool(pool), _lock(), _cv(), _tasks(), _continuations(), _pending(0), _dispatching(0), _failed(false) {}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::task_group::push(task_callback_t callback, task_data_t data, priority priority)
+{
+	// Track the task before it is queued, so that it can't complete before we observe it.
+	auto task = _pool->create(callback, data, priority);
+	add(task);
+	_pool->enqueue(task);
+	_pool->balance(priority);
+	return task;
+}
+
+void streamfx::util::threadpool::task_group::add(std::shared_ptr<task> task)
+{
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		_tasks.emplace_back(task);
+		++_pending;
+	}
+
+	task->observe([this](bool success) {
+		std::unique_lock<std::mutex> ul(_lock);
+		_failed = _failed || !success;
+		if (--_pending == 0) {
+			// Keep waiters blocked until continuations are dispatched, as the group may be destroyed right after.
+			++_dispatching;
+			bool failed = _failed;
+			ul.unlock();
+			dispatch(!failed);
+			ul.lock();
+			--_dispatching;
+			_cv.notify_all();
+		}
+	});
+}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::task_group::then(task_callback_t callback, task_data_t data, priority priority)
+{
+	auto continuation = _pool->create(callback, data, priority);
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		_continuations.emplace_back(continuation);
+		if (_pending > 0) {
+			return continuation;
+		}
+	}
+
+	dispatch(!_failed);
+	return continuation;
+}
+
+void streamfx::util::threadpool::task_group::wait_all()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_cv.wait(ul, [this]() { return (_pending == 0) && (_dispatching == 0); });
+}
+
+bool streamfx::util::threadpool::task_group::is_completed()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _pending == 0;
+}
+
+bool streamfx::util::threadpool::task_group::has_failed()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _failed;
+}
+
+void streamfx::util::threadpool::task_group::cancel()
+{
+	std::list<std::shared_ptr<task>> tasks;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		tasks = _tasks;
+	}
+
+	for (auto task : tasks) {
+		_pool->pop(task);
+	}
+
+	// Tasks that were already running can't be cancelled, so wait for them to finish.
+	wait_all();
+}
+
+void streamfx::util::threadpool::task_group::dispatch(bool success)
+{
+	std::list<std::shared_ptr<task>> continuations;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		continuations.swap(_continuations);
+		_tasks.clear();
+	}
+
+	for (auto continuation : continuations) {
+		if (success) {
+			_pool->enqueue(continuation);
+			_pool->balance(continuation->get_priority());
+		} else {
+			continuation->cancel();
+		}
+	}
+}
+
+// Worker that the current thread belongs to, used to keep work submitted from inside a task local to that worker.
+static thread_local struct {
+	streamfx::util::threadpool::threadpool*  pool;
+	streamfx::util::threadpool::worker_info* worker;
+} local_worker = {nullptr, nullptr};
+
 streamfx::util::threadpool::threadpool::~threadpool()
 {
+	std::list<std::shared_ptr<worker_info>> workers;
+	{
+		std::lock_guard<std::mutex> lg(_workers_lock);
+		workers = _workers;
+	}
+
 	{ // Terminate all remaining tasks.
-		std::lock_guard<std::mutex> lg(_tasks_lock);
-		for (auto task : _tasks) {
-			task->cancel();
+		for (auto worker : workers) {
+			std::lock_guard<std::mutex> lg(worker->tasks_lock);
+			for (auto& queue : worker->tasks) {
+				for (auto task : queue) {
+					task->cancel();
+				}
+				queue.clear();
+			}
+			worker->retired = true;
 		}
-		_tasks.clear();
+		_tasks_pending = 0;
 	}
 
 	{ // Notify workers to stop working.
-		{
-			std::lock_guard<std::mutex> lg(_workers_lock);
-			for (auto worker : _workers) {
-				worker->stop = true;
-			}
+		for (auto worker : workers) {
+			worker->stop = true;
 		}
 		{
-			std::lock_guard<std::mutex> lg(_tasks_lock);
-			_tasks_cv.notify_all();
+			std::lock_guard<std::mutex> lg(_idle_lock);
+			_idle_cv.notify_all();
 		}
-		for (auto worker : _workers) {
+		for (auto worker : workers) {
 			std::lock_guard<std::mutex> lg(worker->lifeline);
 		}
 	}
 }
 
-streamfx::util::threadpool::threadpool::threadpool(size_t minimum, size_t maximum) : _limits{minimum, maximum}, _workers_lock(), _worker_count(0), _workers(), _tasks_lock(), _tasks_cv(), _tasks()
+streamfx::util::threadpool::threadpool::threadpool(size_t minimum, size_t maximum) : _limits{minimum, maximum}, _workers_lock(), _workers(), _queues(), _worker_count(0), _last_worker_death(), _tasks_pending(0), _next_queue(0), _idle_lock(), _idle_cv(), _idle_count(0), _affinity(affinity_policy::None), _idle_spin(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::microseconds(ST_IDLE_SPIN_DEFAULT)).count())
 {
+	// Always keep at least one worker, otherwise queued work would never run.
+	_limits.first  = std::max<size_t>(_limits.first, 1);
+	_limits.second = std::max<size_t>(_limits.second, _limits.first);
+
 	// Spawn the minimum number of threads.
 	spawn(_limits.first);
 }
 
-std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push(task_callback_t callback, task_data_t data /*= nullptr*/)
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push(task_callback_t callback, task_data_t data /*= nullptr*/, priority priority /*= priority::NORMAL*/)
 {
-	std::lock_guard<std::mutex> lg(_tasks_lock);
-	constexpr size_t            threshold = 3;
 
 	// Enqueue the new task.
-	auto task = std::make_shared<streamfx::util::threadpool::task>(callback, data);
-	_tasks.emplace_back(task);
+	auto task = create(callback, data, priority);
+	enqueue(task);
+	balance(priority);
 
-	// Spawn additional workers if the number of queued tasks exceeds a threshold.
-	if (_tasks.size() > (threshold * _worker_count)) {
-		spawn(_tasks.size() / threshold);
-	}
+	// Return handle to caller.
+	return task;
+}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push(task_invoke_t invoke, void* context, task_data_t data /*= nullptr*/, priority priority /*= priority::NORMAL*/)
+{
+	// Enqueue the new task.
+	auto task   = std::allocate_shared<streamfx::util::threadpool::task>(pool_allocator<streamfx::util::threadpool::task>(), invoke, context, data, priority);
+	task->_pool = this;
+	enqueue(task);
+	balance(priority);
 
 	// Return handle to caller.
 	return task;
 }
 
+void streamfx::util::threadpool::threadpool::set_affinity(affinity_policy policy)
+{
+	_affinity.store(policy, std::memory_order_relaxed);
+}
+
+void streamfx::util::threadpool::threadpool::set_idle_spin(std::chrono::nanoseconds duration)
+{
+	_idle_spin.store(std::max<int64_t>(duration.count(), 0), std::memory_order_relaxed);
+}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::create(task_callback_t callback, task_data_t data, priority priority)
+{
+	auto task   = std::allocate_shared<streamfx::util::threadpool::task>(pool_allocator<streamfx::util::threadpool::task>(), callback, data, priority);
+	task->_pool = this;
+	return task;
+}
+
+void streamfx::util::threadpool::threadpool::balance(priority priority)
+{
+	constexpr size_t threshold = 3;
+
+	// Spawn additional workers if the number of queued tasks exceeds a threshold.
+	size_t pending = _tasks_pending.load(std::memory_order_relaxed);
+	if (_worker_count.load(std::memory_order_relaxed) < _limits.second) {
+		if (pending > (threshold * _worker_count.load(std::memory_order_relaxed))) {
+			spawn(pending / threshold);
+		} else if ((priority == priority::REALTIME) && (_idle_count == 0)) {
+			// Realtime work should not have to wait for a busy worker to finish.
+			spawn(1);
+		}
+	}
+}
+
 void streamfx::util::threadpool::threadpool::pop(std::shared_ptr<task> task)
 {
-	if (task) {
-		task->cancel();
+	if (!task) {
+		return;
+	}
+	task->cancel();
+
+	// Remove the task from whichever queue it is still waiting in.
+	auto queues = std::atomic_load(&_queues);
+	for (auto& worker : *queues) {
+		std::lock_guard<std::mutex> lg(worker->tasks_lock);
+		auto&                       queue = worker->tasks[static_cast<size_t>(task->get_priority())];
+		auto                        itr   = std::find(queue.begin(), queue.end(), task);
+		if (itr != queue.end()) {
+			queue.erase(itr);
+			--_tasks_pending;
+			break;
+		}
+	}
+}
+
+void streamfx::util::threadpool::threadpool::enqueue(std::shared_ptr<task> task)
+{
+	size_t queue = static_cast<size_t>(task->get_priority());
+	for (size_t attempts = 0;; attempts++) {
+		std::shared_ptr<worker_info> target;
+		auto                         queues = std::atomic_load(&_queues);
+		if (attempts > queues->size()) {
+			// Every worker is retired, which only happens while the threadpool is shutting down.
+			task->cancel();
+			return;
+		}
+
+		if (local_worker.pool == this) {
+			// Work submitted from one of our own workers stays local, where it is most likely to be cache-hot.
+			std::lock_guard<std::mutex> lg(local_worker.worker->tasks_lock);
+			if (!local_worker.worker->retired) {
+				local_worker.worker->tasks[queue].emplace_back(task);
+				break;
+			}
+		}
+
+		// Otherwise distribute work across all workers in a round-robin fashion.
+		target = queues->at(_next_queue.fetch_add(1, std::memory_order_relaxed) % queues->size());
+		{
+			std::lock_guard<std::mutex> lg(target->tasks_lock);
+			if (!target->retired) {
+				target->tasks[queue].emplace_back(task);
+				break;
+			}
+		}
+	}
+	++_tasks_pending;
+
+	// Wake up one idle worker, if there are any.
+	if (_idle_count > 0) {
+		std::lock_guard<std::mutex> lg(_idle_lock);
+		_idle_cv.notify_one();
+	}
+}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::acquire(std::shared_ptr<worker_info> wi)
+{
+	auto   queues = std::atomic_load(&_queues);
+	size_t offset = _next_queue.load(std::memory_order_relaxed);
+
+	for (size_t queue = 0; queue < priority_count; queue++) {
+		{ // Try our own queue first.
+			std::lock_guard<std::mutex> lg(wi->tasks_lock);
+			if (!wi->tasks[queue].empty()) {
+				auto task = wi->tasks[queue].front();
+				wi->tasks[queue].pop_front();
+				--_tasks_pending;
+				return task;
+			}
+		}
+
+		// Then try to steal from other workers, starting at a different worker each time.
+		for (size_t idx = 0, edx = queues->size(); idx < edx; idx++) {
+			auto& victim = queues->at((offset + idx) % edx);
+			if (victim == wi) {
+				continue;
+			}
+
+			std::unique_lock<std::mutex> ul(victim->tasks_lock, std::try_to_lock);
+			if (ul.owns_lock() && !victim->tasks[queue].empty()) {
+				auto task = victim->tasks[queue].back();
+				victim->tasks[queue].pop_back();
+				--_tasks_pending;
+				return task;
+			}
+		}
 	}
-	std::lock_guard<std::mutex> lg(_tasks_lock);
-	_tasks.remove(task);
+
+	return nullptr;
+}
+
+void streamfx::util::threadpool::threadpool::publish()
+{
+	// Requires _workers_lock to be held by the caller.
+	auto queues = std::make_shared<std::vector<std::shared_ptr<worker_info>>>(_workers.begin(), _workers.end());
+	std::atomic_store(&_queues, std::shared_ptr<const std::vector<std::shared_ptr<worker_info>>>(queues));
 }
 
 void streamfx::util::threadpool::threadpool::spawn(size_t count)
@@ -159,10 +843,14 @@ void streamfx::util::threadpool::threadpool::spawn(size_t count)
 	for (size_t n = 0; (n < count) && (_worker_count < _limits.second); n++) {
 		auto wi            = std::make_shared<worker_info>();
 		wi->stop           = false;
+		wi->retired        = false;
 		wi->last_work_time = std::chrono::high_resolution_clock::now();
-		wi->thread         = std::thread(std::bind(&streamfx::util::threadpool::threadpool::work, this, wi));
-		wi->thread.detach();
+		wi->placement      = priority::_COUNT;
 		_workers.emplace_back(wi);
+		publish();
+
+		wi->thread = std::thread(std::bind(&streamfx::util::threadpool::threadpool::work, this, wi));
+		wi->thread.detach();
 		++_worker_count;
 		D_LOG_DEBUG("Spawning new worker thread (%zu < %zu < %zu).", _limits.first, _worker_count.load(), _limits.second);
 	}
@@ -172,24 +860,78 @@ bool streamfx::util::threadpool::threadpool::die(std::shared_ptr<worker_info> wi
 {
 	constexpr std::chrono::seconds delay{1};
 
-	std::lock_guard<std::mutex> lg(_workers_lock);
-	bool                        result = false;
+	bool                               result = false;
+	std::vector<std::shared_ptr<task>> orphans;
+	{
+		std::lock_guard<std::mutex> lg(_workers_lock);
+
+		if (_worker_count > _limits.first) {
+			auto now = std::chrono::high_resolution_clock::now();
+			result   = ((wi->last_work_time + delay) <= now) && ((_last_worker_death + delay) <= now);
+
+			if (result) {
+				_last_worker_death = now;
+				--_worker_count;
+				_workers.remove(wi);
+				publish();
 
-	if (_worker_count > _limits.first) {
-		auto now = std::chrono::high_resolution_clock::now();
-		result   = ((wi->last_work_time + delay) <= now) && ((_last_worker_death + delay) <= now);
+				// Ensure nothing can be queued here any more, and hand off anything that arrived in the meantime.
+				std::lock_guard<std::mutex> tlg(wi->tasks_lock);
+				wi->retired = true;
+				for (auto& queue : wi->tasks) {
+					orphans.insert(orphans.end(), queue.begin(), queue.end());
+					queue.clear();
+				}
+				_tasks_pending -= orphans.size();
 
-		if (result) {
-			_last_worker_death = now;
-			--_worker_count;
-			_workers.remove(wi);
-			D_LOG_DEBUG("Terminated idle worker thread (%zu < %zu < %zu).", _limits.first, _worker_count.load(), _limits.second);
+				D_LOG_DEBUG("Terminated idle worker thread (%zu < %zu < %zu).", _limits.first, _worker_count.load(), _limits.second);
+			}
 		}
 	}
 
+	for (auto task : orphans) {
+		enqueue(task);
+	}
+
 	return result;
 }
 
+void streamfx::util::threadpool::threadpool::place(std::shared_ptr<worker_info> wi, priority priority)
+{
+	// Requires to be called from the worker itself.
+	auto const& classes = detect_core_classes();
+	switch (priority) {
+	case priority::REALTIME:
+		set_thread_affinity(classes.performance.empty() ? classes.any : classes.performance);
+		break;
+	case priority::BACKGROUND:
+		set_thread_affinity(classes.efficiency.empty() ? classes.any : classes.efficiency);
+		break;
+	default:
+		set_thread_affinity(classes.any);
+		break;
+	}
+
+	// Background scheduling would otherwise keep realtime work off the cores chosen above, or delay it indefinitely.
+	bool was_realtime = (wi->placement == priority::REALTIME);
+	bool is_realtime  = (priority == priority::REALTIME);
+	if (was_realtime != is_realtime) {
+#if defined(D_PLATFORM_WINDOWS)
+		if (is_realtime) {
+			SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+		} else {
+			SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN | THREAD_PRIORITY_BELOW_NORMAL);
+		}
+#elif defined(D_PLATFORM_LINUX)
+		struct sched_param param;
+		param.sched_priority = 0;
+		pthread_setschedparam(pthread_self(), is_realtime ? SCHED_OTHER : SCHED_IDLE, &param);
+#endif
+	}
+
+	wi->placement = priority;
+}
+
 void streamfx::util::threadpool::threadpool::work(std::shared_ptr<worker_info> wi)
 {
 	std::shared_ptr<streamfx::util::threadpool::task> task{};
@@ -205,36 +947,62 @@ void streamfx::util::threadpool::threadpool::work(std::shared_ptr<worker_info> w
 	pthread_setname_np(pthread_self(), "StreamFX Worker Thread");
 #endif
 
+	local_worker.pool   = this;
+	local_worker.worker = wi.get();
+
+	bool worked = false;
 	while (!wi->stop) {
-		{ // Try and acquire new work.
-			std::unique_lock<std::mutex> ul(_tasks_lock);
+		// Try and acquire new work, either from our own queue or from another worker.
+		task = acquire(wi);
 
-			// Is there any work available right now?
-			if (_tasks.size() == 0) { // If not:
-				// Block this thread until it is notified of a change.
-				_tasks_cv.wait_until(ul, std::chrono::time_point(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(250)), [this, wi]() { return wi->stop || _tasks.size() > 0; });
+		if (!task && worked) {
+			// Work tends to arrive in bursts, so look for more for a little while before going to sleep.
+			worked     = false;
+			auto until = std::chrono::high_resolution_clock::now() + std::chrono::nanoseconds(_idle_spin.load(std::memory_order_relaxed));
+			while (!wi->stop && (_tasks_pending.load(std::memory_order_relaxed) == 0) && (std::chrono::high_resolution_clock::now() < until)) {
+				spin_pause();
 			}
+			continue;
+		}
+
+		if (!task) {
+			// Block this thread until it is notified of new work.
+			std::unique_lock<std::mutex> ul(_idle_lock);
+			++_idle_count;
+			_idle_cv.wait_until(ul, std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(250), [this, wi]() { return wi->stop || _tasks_pending > 0; });
+			--_idle_count;
+			bool had_work = _tasks_pending > 0;
+			ul.unlock();
 
 			// If we were asked to stop, skip everything.
 			if (wi->stop) {
 				continue;
 			}
 
-			// If there is work to be done, take it.
-			if (_tasks.size() > 0) {
-				wi->last_work_time = std::chrono::high_resolution_clock::now();
-				task               = _tasks.front();
-				_tasks.pop_front();
-			} else if (die(wi)) { // Is the threadpool requesting less threads?
+			// Is the threadpool requesting less threads?
+			if (!had_work && die(wi)) {
 				break;
 			}
+			continue;
 		}
 
-		if (task) {
-			task->run();
-			task.reset();
+		if (_affinity.load(std::memory_order_relaxed) == affinity_policy::CoreClass) {
+			if (wi->placement != task->get_priority()) {
+				place(wi, task->get_priority());
+			}
+		} else if (wi->placement != priority::_COUNT) {
+			place(wi, priority::NORMAL);
+			wi->placement = priority::_COUNT;
 		}
+
+		wi->last_work_time = std::chrono::high_resolution_clock::now();
+		task->run();
+		task.reset();
+		worked = true;
 	}
+
+	local_worker.pool   = nullptr;
+	local_worker.worker = nullptr;
 }
 
 std::shared_ptr<streamfx::util::threadpool::threadpool> streamfx::util::threadpool::threadpool::instance()
@@ -261,3 +1029,25 @@ static auto loader = streamfx::loader(
 		loader_instance.reset();
 	},
 	streamfx::loader_priority::HIGHEST);
+
+static auto loader_configuration = streamfx::loader(
+	[]() { // Initalizer
+		// The threadpool is needed long before the configuration is available, so this is applied afterwards.
+		auto pool   = streamfx::util::threadpool::threadpool::instance();
+		auto policy = streamfx::util::threadpool::affinity_policy::CoreClass;
+		auto spin   = static_cast<long long>(ST_IDLE_SPIN_DEFAULT);
+		if (auto config = streamfx::configuration::instance(); config) {
+			auto dataptr = config->get();
+			if (obs_data_has_user_value(dataptr.get(), ST_CFG_AFFINITY)) {
+				policy = static_cast<streamfx::util::threadpool::affinity_policy>(std::clamp<long long>(obs_data_get_int(dataptr.get(), ST_CFG_AFFINITY), 0, 1));
+			}
+			if (obs_data_has_user_value(dataptr.get(), ST_CFG_IDLE_SPIN)) {
+				spin = std::max<long long>(obs_data_get_int(dataptr.get(), ST_CFG_IDLE_SPIN), 0);
+			}
+		}
+		pool->set_affinity(policy);
+		pool->set_idle_spin(std::chrono::microseconds(spin));
+	},
+	[]() { // Finalizer
+	},
+	streamfx::loader_priority::NORMAL);
@@ -6,9 +6,11 @@
 #include "warning-disable.hpp"
 #include <atomic>
 #include <chrono>
+#include <array>
 #include <cinttypes>
 #include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <list>
 #include <memory>
@@ -16,11 +18,39 @@
 #include <new>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::util::threadpool {
 	typedef std::shared_ptr<void>            task_data_t;
 	typedef std::function<void(task_data_t)> task_callback_t;
+	typedef void (*task_invoke_t)(void* context, task_data_t data);
+
+	/** Dispatch class of a task.
+	 *
+	 * Workers always drain higher priority classes (across all workers) before touching lower ones, so per-frame and
+	 * audio work never waits behind bulk jobs like model loads, disk I/O or network requests.
+	 */
+	enum class priority : uint8_t {
+		REALTIME,   // Latency sensitive work, like audio forwarding or per-frame processing.
+		NORMAL,     // Default class for everything else.
+		BACKGROUND, // Bulk work that may be delayed, like network requests, model loading or saving to disk.
+		_COUNT,
+	};
+	constexpr size_t priority_count = static_cast<size_t>(priority::_COUNT);
+
+	/** Where workers run while they work on a task.
+	 *
+	 * Cores outside of the affinity OBS was started with are never used, even if the thread that spawned a worker was
+	 * pinned somewhere else.
+	 */
+	enum class affinity_policy : uint8_t {
+		None,      // Leave placement to the operating system.
+		CoreClass, // Realtime work runs on the fastest cores, background work on the most efficient ones.
+	};
+
+	class task;
+	class threadpool;
 
 	struct worker_info {
 #if __cpp_lib_hardware_interference_size >= 201603
@@ -35,33 +65,47 @@ namespace streamfx::util::threadpool {
 
 		std::chrono::high_resolution_clock::time_point last_work_time;
 
+		// Class of the work this thread was last placed for, or priority::_COUNT if it was never placed.
+		priority placement;
+
 		std::thread thread;
+
+		/** Local task queues of this worker, one per priority class.
+		 *
+		 * The owning worker takes work from the front, while other workers steal from the back. Once a worker is
+		 * retired, 'retired' is set and no further tasks may be queued here.
+		 */
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::mutex tasks_lock;
+		std::array<std::deque<std::shared_ptr<task>>, priority_count> tasks;
+		bool                                                          retired;
 	};
 
 	class task {
 		task_callback_t _callback;
-		task_data_t     _data;
-		std::mutex      _lock;
+		// Allocation-free alternative to _callback, used by the member function overload of threadpool::push.
+		task_invoke_t _invoke;
+		void*         _context;
+		task_data_t   _data;
+		priority      _priority;
+		threadpool*   _pool;
 
-#if __cpp_lib_hardware_interference_size >= 201603
-		alignas(std::hardware_destructive_interference_size)
-#endif
-			std::condition_variable _status_changed;
-#if __cpp_lib_hardware_interference_size >= 201603
-		alignas(std::hardware_destructive_interference_size)
-#endif
-			std::atomic<bool> _cancelled;
-#if __cpp_lib_hardware_interference_size >= 201603
-		alignas(std::hardware_destructive_interference_size)
-#endif
-			std::atomic<bool> _completed;
-#if __cpp_lib_hardware_interference_size >= 201603
-		alignas(std::hardware_destructive_interference_size)
-#endif
-			std::atomic<bool> _failed;
+		// Called exactly once when the task completes, with 'true' if it ran successfully.
+		std::list<std::function<void(bool)>> _observers;
+
+		// Tasks are recycled through a pool and rarely shared between more than two threads, so these are kept
+		// together instead of on separate cache lines to keep every task as small as possible.
+		std::mutex              _lock;
+		std::condition_variable _status_changed;
+		std::atomic<bool>       _cancelled;
+		std::atomic<bool>       _completed;
+		std::atomic<bool>       _failed;
 
 		public:
-		task(task_callback_t callback, task_data_t data);
+		task(task_callback_t callback, task_data_t data, priority priority = priority::NORMAL);
+		task(task_invoke_t invoke, void* context, task_data_t data, priority priority = priority::NORMAL);
 
 		public:
 		~task();
@@ -72,6 +116,9 @@ namespace streamfx::util::threadpool {
 		public:
 		void cancel();
 
+		public:
+		priority get_priority();
+
 		public:
 		bool is_cancelled();
 
@@ -86,6 +133,80 @@ namespace streamfx::util::threadpool {
 
 		public:
 		void await_completion();
+
+		/** Queue follow-up work that runs once this task completed successfully.
+		 *
+		 * The continuation is pushed to the same threadpool as this task. If no data is given, it receives the data
+		 * of this task, which allows multi-step pipelines to pass state along. If this task fails or is cancelled,
+		 * the continuation is cancelled as well.
+		 */
+		public:
+		std::shared_ptr<task> then(task_callback_t callback, task_data_t data = nullptr, priority priority = priority::NORMAL);
+
+		/** Register a callback that is invoked once this task completes, fails or is cancelled.
+		 *
+		 * The callback runs on whichever thread completed the task, or immediately if it already completed.
+		 */
+		public:
+		void observe(std::function<void(bool)> observer);
+
+		private:
+		void notify(bool success);
+
+		friend class threadpool;
+	};
+
+	/** Tracks a number of tasks as one unit of work.
+	 *
+	 * Allows waiting for all of them at once, or queuing continuations that run after all of them completed, without
+	 * ever having to block the calling thread.
+	 */
+	class task_group {
+		std::shared_ptr<threadpool> _pool;
+
+		std::mutex                       _lock;
+		std::condition_variable          _cv;
+		std::list<std::shared_ptr<task>> _tasks;
+		std::list<std::shared_ptr<task>> _continuations;
+		size_t                           _pending;
+		size_t                           _dispatching;
+		bool                             _failed;
+
+		public:
+		~task_group();
+
+		public:
+		task_group(std::shared_ptr<threadpool> pool);
+
+		public:
+		std::shared_ptr<task> push(task_callback_t callback, task_data_t data = nullptr, priority priority = priority::NORMAL);
+
+		/** Track an already existing task as part of this group.
+		 */
+		public:
+		void add(std::shared_ptr<task> task);
+
+		/** Queue work that runs once every task currently in the group has completed.
+		 *
+		 * If any of the tasks failed or was cancelled, the continuation is cancelled instead.
+		 */
+		public:
+		std::shared_ptr<task> then(task_callback_t callback, task_data_t data = nullptr, priority priority = priority::NORMAL);
+
+		public:
+		void wait_all();
+
+		public:
+		bool is_completed();
+
+		public:
+		bool has_failed();
+
+		public:
+		void cancel();
+
+		private:
+		void dispatch(bool success);
 	};
 
 	class threadpool {
@@ -96,6 +217,8 @@ namespace streamfx::util::threadpool {
 #endif
 			std::mutex _workers_lock;
 		std::list<std::shared_ptr<worker_info>> _workers;
+		// Immutable snapshot of _workers, replaced on every spawn/die so that push() and stealing never need _workers_lock.
+		std::shared_ptr<const std::vector<std::shared_ptr<worker_info>>> _queues;
 #if __cpp_lib_hardware_interference_size >= 201603
 		alignas(std::hardware_destructive_interference_size)
 #endif
@@ -105,12 +228,24 @@ namespace streamfx::util::threadpool {
 #if __cpp_lib_hardware_interference_size >= 201603
 		alignas(std::hardware_destructive_interference_size)
 #endif
-			std::mutex _tasks_lock;
+			std::atomic<size_t> _tasks_pending;
 #if __cpp_lib_hardware_interference_size >= 201603
 		alignas(std::hardware_destructive_interference_size)
 #endif
-			std::condition_variable _tasks_cv;
-		std::list<std::shared_ptr<task>> _tasks;
+			std::atomic<size_t> _next_queue;
+
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::mutex _idle_lock;
+		std::condition_variable _idle_cv;
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::atomic<size_t> _idle_count;
+
+		std::atomic<affinity_policy> _affinity;
+		std::atomic<int64_t>         _idle_spin; // In nanoseconds.
 
 		public:
 		~threadpool();
@@ -119,21 +254,74 @@ namespace streamfx::util::threadpool {
 		threadpool(size_t minimum = 2, size_t maximum = std::thread::hardware_concurrency());
 
 		public:
-		std::shared_ptr<task> push(task_callback_t callback, task_data_t data = nullptr);
+		std::shared_ptr<task> push(task_callback_t callback, task_data_t data = nullptr, priority priority = priority::NORMAL);
+
+		/** Push a member function call without any heap allocation in steady state.
+		 *
+		 * Unlike the std::function overload, this never needs to allocate for the callback itself, and the task is
+		 * taken from a pool of recycled task objects. Prefer this for work that is submitted at audio or frame rate.
+		 *
+		 * Usage: threadpool->push<&my_class::my_function>(this, data, priority::REALTIME);
+		 */
+		template<auto Function, typename T>
+		std::shared_ptr<task> push(T* self, task_data_t data = nullptr, priority priority = priority::NORMAL)
+		{
+			return push(
+				[](void* context, task_data_t data) {
+					(static_cast<T*>(context)->*Function)(data);
+				},
+				self, data, priority);
+		}
+
+		std::shared_ptr<task> push(task_invoke_t invoke, void* context, task_data_t data = nullptr, priority priority = priority::NORMAL);
 
 		public:
 		void pop(std::shared_ptr<task> task);
 
+		/** Change where workers run, which takes effect with the next task each worker picks up.
+		 */
+		public:
+		void set_affinity(affinity_policy policy);
+
+		/** How long a worker that just finished a task keeps looking for more before it goes to sleep.
+		 *
+		 * Spinning avoids the wake-up latency of the operating system for work that arrives in quick succession, at
+		 * the cost of keeping a core busy for that long. Zero disables it.
+		 */
+		public:
+		void set_idle_spin(std::chrono::nanoseconds duration);
+
+		private:
+		std::shared_ptr<task> create(task_callback_t callback, task_data_t data, priority priority);
+
+		private:
+		void enqueue(std::shared_ptr<task> task);
+
+		private:
+		void balance(priority priority);
+
+		private:
+		std::shared_ptr<task> acquire(std::shared_ptr<worker_info> wi);
+
+		private:
+		void publish();
+
 		private:
 		void spawn(size_t count = 1);
 
 		private:
 		bool die(std::shared_ptr<worker_info>);
 
+		private:
+		void place(std::shared_ptr<worker_info> wi, priority priority);
+
 		private:
 		void work(std::shared_ptr<worker_info>);
 
 		public /* Singleton */:
 		static std::shared_ptr<streamfx::util::threadpool::threadpool> instance();
+
+		friend class task;
+		friend class task_group;
 	};
 } // namespace streamfx::util::threadpool
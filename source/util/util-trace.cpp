@@ -0,0 +1,202 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-trace.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::trace> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+// Number of events kept, which is enough for several seconds of a busy scene.
+constexpr size_t default_capacity = 1 << 17;
+
+static std::shared_ptr<streamfx::util::trace::recorder> loader_instance;
+
+static void copy_truncated(char* destination, size_t size, std::string_view source)
+{
+	size_t length = std::min(source.size(), size - 1);
+	memcpy(destination, source.data(), length);
+	destination[length] = '\0';
+}
+
+static void write_escaped(std::ofstream& stream, const char* text)
+{
+	for (; *text; text++) {
+		char chr = *text;
+		if ((chr == '"') || (chr == '\\')) {
+			stream << '\\' << chr;
+		} else if (static_cast<unsigned char>(chr) < 0x20) {
+			stream << ' ';
+		} else {
+			stream << chr;
+		}
+	}
+}
+
+streamfx::util::trace::recorder::~recorder() {}
+
+streamfx::util::trace::recorder::recorder(size_t capacity) : _events(new event[capacity]), _capacity(capacity), _head(0), _recording(false), _epoch(std::chrono::high_resolution_clock::now())
+{
+	for (size_t idx = 0; idx < _capacity; idx++) {
+		_events[idx].sequence = 0;
+	}
+}
+
+void streamfx::util::trace::recorder::start()
+{
+	_recording = false;
+	for (size_t idx = 0; idx < _capacity; idx++) {
+		_events[idx].sequence.store(0, std::memory_order_relaxed);
+	}
+	_head  = 0;
+	_epoch = std::chrono::high_resolution_clock::now();
+	_recording.store(true, std::memory_order_release);
+	D_LOG_INFO("Started recording a trace with up to %zu events.", _capacity);
+}
+
+void streamfx::util::trace::recorder::stop()
+{
+	_recording = false;
+	D_LOG_INFO("Stopped recording, captured %" PRIu64 " events.", _head.load());
+}
+
+bool streamfx::util::trace::recorder::is_recording()
+{
+	return _recording.load(std::memory_order_relaxed);
+}
+
+void streamfx::util::trace::recorder::record(std::string_view name, std::string_view category, time_point_t begin, time_point_t end, uint64_t thread)
+{
+	if (!_recording.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	uint64_t idx = _head.fetch_add(1, std::memory_order_relaxed);
+	event&   ev  = _events[idx % _capacity];
+
+	// Mark the slot as being written, so that a concurrent dump skips it.
+	ev.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	copy_truncated(ev.name, sizeof(ev.name), name);
+	copy_truncated(ev.category, sizeof(ev.category), category);
+	ev.thread   = thread;
+	ev.begin    = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - _epoch).count();
+	ev.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+	ev.sequence.store(idx + 1, std::memory_order_release);
+}
+
+bool streamfx::util::trace::recorder::dump(std::filesystem::path path)
+{
+	try {
+		if (path.has_parent_path()) {
+			std::filesystem::create_directories(path.parent_path());
+		}
+
+		std::ofstream stream(path, std::ios::out | std::ios::trunc);
+		if (!stream.is_open()) {
+			throw std::runtime_error("Failed to open file for writing.");
+		}
+
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool first = true;
+		for (size_t idx = 0; idx < _capacity; idx++) {
+			event&   ev       = _events[idx];
+			uint64_t sequence = ev.sequence.load(std::memory_order_acquire);
+			if (sequence == 0) {
+				continue;
+			}
+
+			event copy;
+			memcpy(copy.name, ev.name, sizeof(copy.name));
+			memcpy(copy.category, ev.category, sizeof(copy.category));
+			copy.thread   = ev.thread;
+			copy.begin    = ev.begin;
+			copy.duration = ev.duration;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (ev.sequence.load(std::memory_order_relaxed) != sequence) {
+				continue; // Overwritten while reading.
+			}
+			copy.name[sizeof(copy.name) - 1]         = '\0';
+			copy.category[sizeof(copy.category) - 1] = '\0';
+
+			stream << (first ? "" : ",") << "{\"name\":\"";
+			write_escaped(stream, copy.name);
+			stream << "\",\"cat\":\"";
+			write_escaped(stream, copy.category);
+			stream << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << copy.thread;
+			stream << ",\"ts\":" << (double_t(copy.begin) / 1000.) << ",\"dur\":" << (double_t(copy.duration) / 1000.) << "}";
+			first = false;
+		}
+		stream << "]}";
+
+		D_LOG_INFO("Wrote trace to '%s'.", path.u8string().c_str());
+		return true;
+	} catch (const std::exception& ex) {
+		D_LOG_ERROR("Failed to write trace to '%s': %s", path.u8string().c_str(), ex.what());
+		return false;
+	}
+}
+
+uint64_t streamfx::util::trace::recorder::current_thread()
+{
+	static thread_local uint64_t id = static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFFFFFF);
+	return id;
+}
+
+std::shared_ptr<streamfx::util::trace::recorder> streamfx::util::trace::recorder::instance()
+{
+	static std::weak_ptr<streamfx::util::trace::recorder> winst;
+	static std::mutex                                     mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::util::trace::recorder>(new streamfx::util::trace::recorder(default_capacity));
+		winst    = instance;
+	}
+	return instance;
+}
+
+streamfx::util::trace::scope::scope(std::string_view name, std::string_view category) : _name(name), _category(category), _begin(), _active(false)
+{
+	if (loader_instance && loader_instance->is_recording()) {
+		_active = true;
+		_begin  = std::chrono::high_resolution_clock::now();
+	}
+}
+
+streamfx::util::trace::scope::~scope()
+{
+	if (_active && loader_instance) {
+		loader_instance->record(_name, _category, _begin, std::chrono::high_resolution_clock::now());
+	}
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance = streamfx::util::trace::recorder::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGHEST);
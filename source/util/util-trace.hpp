@@ -0,0 +1,82 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::trace {
+	typedef std::chrono::high_resolution_clock::time_point time_point_t;
+
+	/** Records begin/end events into a fixed size ring buffer, and writes them out as Chrome trace JSON.
+	 *
+	 * Recording is lock-free: every event claims a slot with a single atomic increment, and the oldest events are
+	 * overwritten once the buffer is full. The result can be loaded into chrome://tracing or ui.perfetto.dev.
+	 */
+	class recorder {
+		struct event {
+			std::atomic<uint64_t> sequence;
+			char                  name[64];
+			char                  category[16];
+			uint64_t              thread;
+			int64_t               begin;
+			int64_t               duration;
+		};
+
+		std::unique_ptr<event[]> _events;
+		size_t                   _capacity;
+		std::atomic<uint64_t>    _head;
+		std::atomic<bool>        _recording;
+		time_point_t             _epoch;
+
+		public:
+		~recorder();
+
+		private:
+		recorder(size_t capacity);
+
+		public:
+		void start();
+
+		void stop();
+
+		bool is_recording();
+
+		/** Record a single complete event.
+		 *
+		 * @param thread Thread the event happened on. Use current_thread() for CPU events, or a fixed, distinct value
+		 *               for timelines that don't belong to a thread, like GPU timestamps.
+		 */
+		void record(std::string_view name, std::string_view category, time_point_t begin, time_point_t end, uint64_t thread = current_thread());
+
+		bool dump(std::filesystem::path path);
+
+		public:
+		static uint64_t current_thread();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::trace::recorder> instance();
+	};
+
+	/** Records the lifetime of this object as one event, if the recorder is currently recording.
+	 */
+	class scope {
+		std::string_view _name;
+		std::string_view _category;
+		time_point_t     _begin;
+		bool             _active;
+
+		public:
+		scope(std::string_view name, std::string_view category = "cpu");
+		~scope();
+	};
+} // namespace streamfx::util::trace
@@ -7,6 +7,7 @@
 #include "warning-disable.hpp"
 #include <cinttypes>
 #include <cstddef>
+#include <limits>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -158,7 +159,7 @@ namespace streamfx::util {
 		}
 
 		template<typename T, typename C>
-		inline bool is_equal(T target, C value)
+		constexpr bool is_equal(T target, C value)
 		{
 			return (target > (value - std::numeric_limits<T>::epsilon())) && (target < (value + std::numeric_limits<T>::epsilon()));
 		}
@@ -202,6 +203,52 @@ namespace streamfx::util {
 			return T(final);
 		}
 
+		/** Exponential function that can be evaluated at compile time.
+		 *
+		 * Halves the argument until the Taylor series converges quickly, and squares the result back up afterwards.
+		 * Prefer std::exp at runtime, this only exists because std::exp is not constexpr.
+		 */
+		template<typename T>
+		constexpr T exp_constexpr(T x)
+		{
+			if (x < T(0)) {
+				return T(1) / exp_constexpr<T>(-x);
+			} else if (x > T(1024)) {
+				return std::numeric_limits<T>::infinity();
+			}
+
+			size_t squarings = 0;
+			for (; x > T(0.5); squarings++) {
+				x /= T(2);
+			}
+
+			T sum  = T(1);
+			T term = T(1);
+			for (size_t n = 1; n < 24; n++) {
+				term *= x / T(n);
+				sum += term;
+			}
+
+			for (; squarings > 0; squarings--) {
+				sum *= sum;
+			}
+			return sum;
+		}
+
+		/** Same as gaussian(), but usable in constant expressions, such as generating kernel tables at compile time. */
+		template<typename T>
+		constexpr T gaussian_constexpr(T x, T o /*, T u = 0*/)
+		{
+			if (is_equal<double_t>(0, o)) {
+				return T(std::numeric_limits<double_t>::infinity());
+			}
+
+			double_t left_e      = 1. / (o * S_PI2_SQROOT);
+			double_t mid_right_e = ((x /* - u*/) / o);
+			double_t right_e     = -0.5 * mid_right_e * mid_right_e;
+			return T(left_e * exp_constexpr<double_t>(right_e));
+		}
+
 		template<typename T>
 		inline T lerp(T a, T b, double_t v)
 		{
@@ -217,11 +264,11 @@ namespace streamfx::util {
 			T _k_kalman_gain;
 
 			public:
-			kalman1D() : _q_process_noise_covariance(0), _r_measurement_noise_covariance(0), _x_value_of_interest(0), _p_estimation_error_covariance(0), _k_kalman_gain(0.0) {}
-			kalman1D(T pnc, T mnc, T eec, T value) : _q_process_noise_covariance(pnc), _r_measurement_noise_covariance(mnc), _x_value_of_interest(value), _p_estimation_error_covariance(eec), _k_kalman_gain(0.0) {}
+			constexpr kalman1D() : _q_process_noise_covariance(0), _r_measurement_noise_covariance(0), _x_value_of_interest(0), _p_estimation_error_covariance(0), _k_kalman_gain(0.0) {}
+			constexpr kalman1D(T pnc, T mnc, T eec, T value) : _q_process_noise_covariance(pnc), _r_measurement_noise_covariance(mnc), _x_value_of_interest(value), _p_estimation_error_covariance(eec), _k_kalman_gain(0.0) {}
 			~kalman1D() = default;
 
-			T filter(T measurement)
+			constexpr T filter(T measurement)
 			{
 				_p_estimation_error_covariance += _q_process_noise_covariance;
 				_k_kalman_gain = _p_estimation_error_covariance / (_p_estimation_error_covariance + _r_measurement_noise_covariance);
@@ -230,7 +277,7 @@ namespace streamfx::util {
 				return _x_value_of_interest;
 			}
 
-			T get()
+			constexpr T get() const
 			{
 				return _x_value_of_interest;
 			}